@@ -0,0 +1,738 @@
+/* Engine benchmark suite.
+ *
+ * Runs fixed-seed, fixed-timestep scenes through the real renderer and
+ * appends one CSV row per scene: CPU frame time and update time percentiles,
+ * GPU frame time percentiles (timestamp queries), draw submissions and peak
+ * resident memory. Nothing depends on wall-clock time, so two engine
+ * versions see exactly the same frames on the same machine.
+ *
+ *   engine_bench [--scene all|cubes|skinned|particles|collision|text]
+ *                [--frames N] [--warmup N] [--count N] [--bloom]
+ *                [--instances euler|quat|matrix] [--label NAME] [--out FILE]
+ *
+ * --count overrides the scene's object count; --instances picks the GPU 3D
+ * instance format (RendererConfig.instance_format_3d); --label tags the rows
+ * (e.g. a commit hash) so results from several versions can share one file. CPU
+ * times include any wait for vsync, so compare the GPU columns, or run with
+ * the driver's vsync forced off, when the scene is faster than the display. */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L   /* getrusage */
+#endif
+
+#include "core/common.h"
+#include "core/log.h"
+#include "core/jobs.h"
+#include "platform/window.h"
+#include "platform/input.h"
+#include "renderer/renderer.h"
+#include "renderer/animation.h"
+#include "renderer/anim_graph.h"
+#include "gameplay/particles.h"
+#include "gameplay/collision.h"
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#define BENCH_SEED          0x5EEDu
+#define BENCH_DT            (1.0f / 60.0f)   /* fixed simulation step */
+#define BENCH_WIDTH         1280
+#define BENCH_HEIGHT        720
+#define BENCH_VIEW_HALF_H   10.0f            /* 2D scenes: Camera2D default */
+
+/* --------------------------------------------------------------------------
+ * Helpers
+ * ------------------------------------------------------------------------ */
+
+/* xorshift32: the same sequence on every platform, unlike rand() */
+static u32 s_rng = BENCH_SEED;
+
+static f32 rng_f32(f32 lo, f32 hi) {
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return lo + (hi - lo) * (f32)(s_rng >> 8) * (1.0f / 16777216.0f);
+}
+
+static u64 peak_rss_kb(void) {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return 0;
+    return (u64)pmc.PeakWorkingSetSize / 1024;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return (u64)usage.ru_maxrss / 1024;   /* bytes on macOS */
+#else
+    return (u64)usage.ru_maxrss;          /* kilobytes on Linux */
+#endif
+#endif
+}
+
+static int cmp_f32(const void *a, const void *b) {
+    f32 x = *(const f32 *)a, y = *(const f32 *)b;
+    return (x > y) - (x < y);
+}
+
+typedef struct {
+    f32 mean, p50, p95, p99, max;
+} Percentiles;
+
+/* Nearest-rank percentiles; sorts `samples` in place */
+static Percentiles percentiles(f32 *samples, u32 count) {
+    Percentiles p = {0};
+    if (count == 0) return p;
+    qsort(samples, count, sizeof(f32), cmp_f32);
+
+    f64 sum = 0.0;
+    for (u32 i = 0; i < count; i++) sum += samples[i];
+    p.mean = (f32)(sum / count);
+    p.p50  = samples[(u32)ceil(0.50 * count) - 1];
+    p.p95  = samples[(u32)ceil(0.95 * count) - 1];
+    p.p99  = samples[(u32)ceil(0.99 * count) - 1];
+    p.max  = samples[count - 1];
+    return p;
+}
+
+/* --------------------------------------------------------------------------
+ * Scenes
+ * ------------------------------------------------------------------------ */
+
+typedef struct {
+    Renderer   *renderer;
+    u32         count;          /* objects in the scene */
+    u32         frame;          /* simulation frame, warmup included */
+    u32         draw_submits;   /* renderer draw calls issued this frame */
+    u32         instances;      /* instances passed to them */
+    MeshHandle  mesh;
+    void       *state;
+} BenchScene;
+
+typedef struct {
+    const char   *name;
+    u32           default_count;
+    EngineResult (*init)(BenchScene *scene);
+    void         (*update)(BenchScene *scene);   /* timed: simulation only */
+    void         (*draw)(BenchScene *scene);     /* between begin/end_frame */
+    void         (*shutdown)(BenchScene *scene);
+} BenchDef;
+
+static const Vertex s_quad_verts[] = {
+    { .position = { -0.5f, -0.5f }, .uv = { 0.0f, 0.0f }, .color = { 1.0f, 1.0f, 1.0f } },
+    { .position = {  0.5f, -0.5f }, .uv = { 1.0f, 0.0f }, .color = { 1.0f, 1.0f, 1.0f } },
+    { .position = {  0.5f,  0.5f }, .uv = { 1.0f, 1.0f }, .color = { 1.0f, 1.0f, 1.0f } },
+    { .position = { -0.5f, -0.5f }, .uv = { 0.0f, 0.0f }, .color = { 1.0f, 1.0f, 1.0f } },
+    { .position = {  0.5f,  0.5f }, .uv = { 1.0f, 1.0f }, .color = { 1.0f, 1.0f, 1.0f } },
+    { .position = { -0.5f,  0.5f }, .uv = { 0.0f, 1.0f }, .color = { 1.0f, 1.0f, 1.0f } },
+};
+
+static void set_scene_light(Renderer *renderer) {
+    DirectionalLight light = {
+        .direction = { 0.3f, -1.0f, 0.5f },
+        .color     = { 1.0f,  0.95f, 0.9f },
+        .ambient   = { 0.15f, 0.15f, 0.2f },
+        .shininess = 32.0f,
+    };
+    renderer_set_light(renderer, &light);
+}
+
+/* ---- cubes: N instanced cubes on a grid ---- */
+
+typedef struct {
+    InstanceData3D *instances;
+    u32             side;
+} CubesState;
+
+static EngineResult cubes_init(BenchScene *s) {
+    CubesState *st = calloc(1, sizeof(CubesState));
+    if (!st) return ENGINE_ERROR_OUT_OF_MEMORY;
+    s->state = st;
+
+    st->instances = malloc(sizeof(InstanceData3D) * s->count);
+    if (!st->instances) return ENGINE_ERROR_OUT_OF_MEMORY;
+
+    EngineResult res = renderer_create_cube(s->renderer, &s->mesh);
+    if (res != ENGINE_SUCCESS) return res;
+
+    st->side = (u32)ceilf(sqrtf((f32)s->count));
+    f32 half = (f32)st->side * 0.75f;
+    for (u32 i = 0; i < s->count; i++) {
+        InstanceData3D *inst = &st->instances[i];
+        *inst = (InstanceData3D){
+            .position = { (f32)(i % st->side) * 1.5f - half, 0.0f,
+                          (f32)(i / st->side) * 1.5f - half },
+            .rotation = { rng_f32(0.0f, 6.28f), rng_f32(0.0f, 6.28f), 0.0f },
+            .scale    = { 1.0f, 1.0f, 1.0f },
+            .color    = { rng_f32(0.2f, 1.0f), rng_f32(0.2f, 1.0f), rng_f32(0.2f, 1.0f) },
+        };
+    }
+    return ENGINE_SUCCESS;
+}
+
+static void cubes_update(BenchScene *s) {
+    CubesState *st = s->state;
+    for (u32 i = 0; i < s->count; i++) {
+        st->instances[i].rotation[0] += BENCH_DT * 0.5f;
+        st->instances[i].rotation[1] += BENCH_DT * 0.7f;
+    }
+}
+
+static void cubes_draw(BenchScene *s) {
+    CubesState *st = s->state;
+    f32 extent = (f32)st->side * 1.5f;
+    Camera3D camera = {
+        .position   = { 0.0f, extent * 0.6f, extent * 0.9f },
+        .target     = { 0.0f, 0.0f, 0.0f },
+        .up         = { 0.0f, 1.0f, 0.0f },
+        .fov        = 60.0f,
+        .near_plane = 0.1f,
+        .far_plane  = extent * 4.0f,
+    };
+    renderer_set_camera_3d(s->renderer, &camera);
+    set_scene_light(s->renderer);
+
+    renderer_draw_mesh_3d(s->renderer, s->mesh, st->instances, s->count);
+    s->draw_submits += 1;
+    s->instances    += s->count;
+}
+
+static void cubes_shutdown(BenchScene *s) {
+    CubesState *st = s->state;
+    if (st) free(st->instances);
+    free(st);
+}
+
+/* ---- skinned: M characters, one animation graph each ---- */
+
+typedef struct {
+    SkinnedModel        model;
+    bool                has_model;
+    AnimGraphDef       *def;
+    AnimGraphInstance **insts;
+    const SkinnedModel **models;
+    InstanceData3D     *placements;
+    u32                 side;
+} SkinnedState;
+
+static EngineResult skinned_init(BenchScene *s) {
+    SkinnedState *st = calloc(1, sizeof(SkinnedState));
+    if (!st) return ENGINE_ERROR_OUT_OF_MEMORY;
+    s->state = st;
+
+    EngineResult res = renderer_load_skinned_model_file(s->renderer, "assets/cesiumman.glb",
+                                                        &st->model);
+    if (res != ENGINE_SUCCESS) return res;
+    st->has_model = true;
+    if (st->model.clip_count == 0) return ENGINE_ERROR_GENERIC;
+
+    st->def = anim_graph_def_create();
+    if (!st->def) return ENGINE_ERROR_OUT_OF_MEMORY;
+    i32 layer = anim_graph_def_add_layer(st->def, "base", ANIM_LAYER_OVERRIDE, 1.0f, NULL);
+    i32 state = anim_graph_def_add_state_clip(st->def, (u32)layer, "loop", 0, 1.0f, true);
+    anim_graph_def_set_default_state(st->def, (u32)layer, (u32)state);
+
+    st->insts      = calloc(s->count, sizeof(AnimGraphInstance *));
+    st->models     = calloc(s->count, sizeof(SkinnedModel *));
+    st->placements = calloc(s->count, sizeof(InstanceData3D));
+    if (!st->insts || !st->models || !st->placements) return ENGINE_ERROR_OUT_OF_MEMORY;
+
+    st->side = (u32)ceilf(sqrtf((f32)s->count));
+    f32 half = (f32)st->side * 0.5f;
+    for (u32 i = 0; i < s->count; i++) {
+        st->insts[i] = anim_graph_instance_create(st->def, &st->model);
+        if (!st->insts[i]) return ENGINE_ERROR_OUT_OF_MEMORY;
+        st->models[i] = &st->model;
+        st->placements[i] = (InstanceData3D){
+            .position = { (f32)(i % st->side) - half, 0.0f, (f32)(i / st->side) - half },
+            .rotation = { 0.0f, rng_f32(0.0f, 6.28f), 0.0f },
+            .scale    = { 1.0f, 1.0f, 1.0f },
+            .color    = { 1.0f, 1.0f, 1.0f },
+        };
+    }
+
+    /* Spread the characters across the clip so they don't move in lockstep */
+    for (u32 i = 0; i < s->count; i++) {
+        anim_graph_update_batch(&st->insts[i], &st->models[i], 1,
+                                rng_f32(0.0f, st->model.clips[0].duration));
+    }
+    return ENGINE_SUCCESS;
+}
+
+static void skinned_update(BenchScene *s) {
+    SkinnedState *st = s->state;
+    anim_graph_update_batch(st->insts, st->models, s->count, BENCH_DT);
+}
+
+static void skinned_draw(BenchScene *s) {
+    SkinnedState *st = s->state;
+    f32 extent = (f32)st->side;
+    Camera3D camera = {
+        .position   = { 0.0f, extent * 0.5f + 1.5f, extent * 0.8f + 3.0f },
+        .target     = { 0.0f, 0.8f, 0.0f },
+        .up         = { 0.0f, 1.0f, 0.0f },
+        .fov        = 60.0f,
+        .near_plane = 0.1f,
+        .far_plane  = extent * 4.0f + 10.0f,
+    };
+    renderer_set_camera_3d(s->renderer, &camera);
+    set_scene_light(s->renderer);
+
+    for (u32 i = 0; i < s->count; i++) {
+        const AnimGraphInstance *inst = st->insts[i];
+        renderer_draw_skinned(s->renderer, st->model.mesh_handle, &st->placements[i],
+                              (const f32 (*)[16])inst->joint_matrices, inst->joint_count);
+    }
+    s->draw_submits += s->count;
+    s->instances    += s->count;
+}
+
+static void skinned_shutdown(BenchScene *s) {
+    SkinnedState *st = s->state;
+    if (!st) return;
+    if (st->insts) {
+        for (u32 i = 0; i < s->count; i++) {
+            if (st->insts[i]) anim_graph_instance_destroy(st->insts[i]);
+        }
+    }
+    if (st->def) anim_graph_def_destroy(st->def);
+    if (st->has_model) skinned_model_destroy(&st->model);
+    free(st->insts);
+    free(st->models);
+    free(st->placements);
+    free(st);
+}
+
+/* ---- particles: about P live particles, re-emitted in bursts ---- */
+
+#define PARTICLE_BURSTS_PER_FRAME 8
+#define PARTICLE_MEAN_LIFETIME    1.0f
+
+typedef struct {
+    Particle     *particles;
+    i32           live;
+} ParticlesState;
+
+static EngineResult particles_init(BenchScene *s) {
+    ParticlesState *st = calloc(1, sizeof(ParticlesState));
+    if (!st) return ENGINE_ERROR_OUT_OF_MEMORY;
+    s->state = st;
+
+    st->particles = malloc(sizeof(Particle) * s->count);
+    if (!st->particles) return ENGINE_ERROR_OUT_OF_MEMORY;
+
+    /* particles_emit draws from rand() */
+    srand(BENCH_SEED);
+    return renderer_upload_mesh(s->renderer, s_quad_verts, ENGINE_ARRAY_LEN(s_quad_verts),
+                                &s->mesh);
+}
+
+static void particles_bench_update(BenchScene *s) {
+    ParticlesState *st = s->state;
+
+    /* Emit at the rate that keeps count particles alive on average */
+    i32 per_burst = (i32)((f32)s->count * BENCH_DT / PARTICLE_MEAN_LIFETIME /
+                          PARTICLE_BURSTS_PER_FRAME) + 1;
+    f32 half_w = BENCH_VIEW_HALF_H * (f32)BENCH_WIDTH / (f32)BENCH_HEIGHT;
+    for (u32 b = 0; b < PARTICLE_BURSTS_PER_FRAME; b++) {
+        ParticleEmitter emitter = {
+            .position             = { rng_f32(-half_w, half_w),
+                                      rng_f32(-BENCH_VIEW_HALF_H, BENCH_VIEW_HALF_H) },
+            .color                = { rng_f32(0.5f, 2.0f), rng_f32(0.5f, 2.0f), 1.0f },
+            .count                = per_burst,
+            .speed_min            = 1.0f,
+            .speed_max            = 6.0f,
+            .lifetime_min         = PARTICLE_MEAN_LIFETIME * 0.5f,
+            .lifetime_max         = PARTICLE_MEAN_LIFETIME * 1.5f,
+            .scale                = 0.15f,
+            .angular_velocity_min = -4.0f,
+            .angular_velocity_max = 4.0f,
+        };
+        st->live += particles_emit(&emitter, st->particles, st->live, (i32)s->count);
+    }
+
+    st->live = particles_update(st->particles, st->live, BENCH_DT);
+}
+
+static void particles_draw(BenchScene *s) {
+    ParticlesState *st = s->state;
+    if (st->live <= 0) return;
+
+    /* Instances are written straight into the frame's instance buffer */
+    InstanceData *instances = renderer_alloc_instances(s->renderer, s->mesh, (u32)st->live);
+    if (!instances) return;
+    i32 n = particles_to_instances(st->particles, st->live, instances, st->live);
+    s->draw_submits += 1;
+    s->instances    += (u32)n;
+}
+
+static void particles_shutdown(BenchScene *s) {
+    ParticlesState *st = s->state;
+    if (st) {
+        free(st->particles);
+    }
+    free(st);
+}
+
+/* ---- collision: Q bouncing bodies in two groups, tested A vs B ---- */
+
+#define COLLISION_RADIUS 0.2f
+
+typedef struct {
+    InstanceData  *bodies;       /* [0, half) group A, [half, count) group B */
+    f32          (*velocity)[2];
+    CollisionPair *pairs;
+    i32            max_pairs;
+    i32            hits;
+} CollisionState;
+
+static EngineResult collision_init(BenchScene *s) {
+    CollisionState *st = calloc(1, sizeof(CollisionState));
+    if (!st) return ENGINE_ERROR_OUT_OF_MEMORY;
+    s->state = st;
+
+    st->max_pairs = (i32)s->count * 4;
+    st->bodies    = calloc(s->count, sizeof(InstanceData));
+    st->velocity  = calloc(s->count, sizeof(*st->velocity));
+    st->pairs     = malloc(sizeof(CollisionPair) * (size_t)st->max_pairs);
+    if (!st->bodies || !st->velocity || !st->pairs) return ENGINE_ERROR_OUT_OF_MEMORY;
+
+    f32 half_w = BENCH_VIEW_HALF_H * (f32)BENCH_WIDTH / (f32)BENCH_HEIGHT;
+    for (u32 i = 0; i < s->count; i++) {
+        InstanceData *b = &st->bodies[i];
+        b->position[0] = rng_f32(-half_w, half_w);
+        b->position[1] = rng_f32(-BENCH_VIEW_HALF_H, BENCH_VIEW_HALF_H);
+        b->scale[0] = b->scale[1] = COLLISION_RADIUS * 2.0f;
+        st->velocity[i][0] = rng_f32(-3.0f, 3.0f);
+        st->velocity[i][1] = rng_f32(-3.0f, 3.0f);
+    }
+
+    return renderer_upload_mesh(s->renderer, s_quad_verts, ENGINE_ARRAY_LEN(s_quad_verts),
+                                &s->mesh);
+}
+
+static void collision_update(BenchScene *s) {
+    CollisionState *st = s->state;
+    f32 half_w = BENCH_VIEW_HALF_H * (f32)BENCH_WIDTH / (f32)BENCH_HEIGHT;
+    f32 bound[2] = { half_w, BENCH_VIEW_HALF_H };
+
+    for (u32 i = 0; i < s->count; i++) {
+        InstanceData *b = &st->bodies[i];
+        for (u32 a = 0; a < 2; a++) {
+            b->position[a] += st->velocity[i][a] * BENCH_DT;
+            if (fabsf(b->position[a]) > bound[a]) st->velocity[i][a] = -st->velocity[i][a];
+        }
+        b->color[0] = 0.3f; b->color[1] = 0.6f; b->color[2] = 1.0f;
+    }
+
+    i32 half = (i32)s->count / 2;
+    st->hits = collision_instances_vs_instances(st->bodies, half, COLLISION_RADIUS,
+                                                st->bodies + half, (i32)s->count - half,
+                                                COLLISION_RADIUS, st->pairs, st->max_pairs);
+    for (i32 p = 0; p < st->hits; p++) {
+        st->bodies[st->pairs[p].index_a].color[0] = 2.0f;
+        st->bodies[half + st->pairs[p].index_b].color[0] = 2.0f;
+    }
+}
+
+static void collision_draw(BenchScene *s) {
+    CollisionState *st = s->state;
+    renderer_draw_mesh(s->renderer, s->mesh, st->bodies, s->count);
+    s->draw_submits += 1;
+    s->instances    += s->count;
+}
+
+static void collision_shutdown(BenchScene *s) {
+    CollisionState *st = s->state;
+    if (st) {
+        free(st->bodies);
+        free(st->velocity);
+        free(st->pairs);
+    }
+    free(st);
+}
+
+/* ---- text: T retained labels plus a block of per-frame changing lines ---- */
+
+#define TEXT_IMMEDIATE_LINES 256   /* ~10 chars each, inside TEXT_MAX_CHARS */
+
+static EngineResult text_init_scene(BenchScene *s) {
+    ENGINE_UNUSED(s);
+    return ENGINE_SUCCESS;
+}
+
+static void text_update(BenchScene *s) {
+    ENGINE_UNUSED(s);
+}
+
+static void text_draw_scene(BenchScene *s) {
+    char buf[32];
+    u32 columns = BENCH_WIDTH / 160;
+    u32 rows    = BENCH_HEIGHT / 14;
+
+    for (u32 i = 0; i < s->count; i++) {
+        snprintf(buf, sizeof(buf), "label %04u", i);
+        f32 x = (f32)((i % columns) * 160);
+        f32 y = (f32)(((i / columns) % rows) * 14);
+        renderer_draw_text_cached(s->renderer, buf, x, y, 0.5f, 0.8f, 0.8f, 1.0f);
+    }
+    for (u32 i = 0; i < TEXT_IMMEDIATE_LINES; i++) {
+        snprintf(buf, sizeof(buf), "v %7u", s->frame * 31u + i);
+        f32 x = (f32)((i % columns) * 160 + 80);
+        f32 y = (f32)(((i / columns) % rows) * 14);
+        renderer_draw_text(s->renderer, buf, x, y, 0.5f, 1.0f, 0.9f, 0.4f);
+    }
+    s->draw_submits += s->count + TEXT_IMMEDIATE_LINES;
+}
+
+static void text_shutdown_scene(BenchScene *s) {
+    ENGINE_UNUSED(s);
+}
+
+static const BenchDef s_benches[] = {
+    { "cubes",     20000, cubes_init,      cubes_update,           cubes_draw,      cubes_shutdown },
+    { "skinned",   64,    skinned_init,    skinned_update,         skinned_draw,    skinned_shutdown },
+    { "particles", 50000, particles_init,  particles_bench_update, particles_draw,  particles_shutdown },
+    { "collision", 2000,  collision_init,  collision_update,       collision_draw,  collision_shutdown },
+    { "text",      512,   text_init_scene, text_update,            text_draw_scene, text_shutdown_scene },
+};
+
+/* --------------------------------------------------------------------------
+ * Runner
+ * ------------------------------------------------------------------------ */
+
+typedef struct {
+    const char *scene;
+    const char *label;
+    const char *out_path;
+    u32         frames;
+    u32         warmup;
+    u32         count;     /* 0 = scene default */
+    bool        bloom;
+    InstanceFormat3D instance_format;
+} BenchOptions;
+
+static void write_csv_row(const BenchOptions *opt, const BenchDef *def, u32 count,
+                          u32 frames, Percentiles cpu, Percentiles update, Percentiles gpu,
+                          u32 gpu_frames, u32 draw_submits, u32 instances) {
+    FILE *probe  = fopen(opt->out_path, "rb");
+    bool  header = (probe == NULL);
+    if (probe) fclose(probe);
+
+    FILE *f = fopen(opt->out_path, "ab");
+    if (!f) {
+        LOG_ERROR("Cannot open %s for writing", opt->out_path);
+        return;
+    }
+    if (header) {
+        fprintf(f, "label,scene,count,frames,bloom,"
+                   "cpu_mean_ms,cpu_p50_ms,cpu_p95_ms,cpu_p99_ms,cpu_max_ms,"
+                   "update_p50_ms,update_p95_ms,update_p99_ms,"
+                   "gpu_frames,gpu_mean_ms,gpu_p50_ms,gpu_p95_ms,gpu_p99_ms,"
+                   "draw_submits,instances,peak_rss_kb\n");
+    }
+    fprintf(f, "%s,%s,%u,%u,%d,"
+               "%.3f,%.3f,%.3f,%.3f,%.3f,"
+               "%.3f,%.3f,%.3f,"
+               "%u,%.3f,%.3f,%.3f,%.3f,"
+               "%u,%u,%llu\n",
+            opt->label, def->name, count, frames, opt->bloom ? 1 : 0,
+            (double)cpu.mean, (double)cpu.p50, (double)cpu.p95, (double)cpu.p99,
+            (double)cpu.max,
+            (double)update.p50, (double)update.p95, (double)update.p99,
+            gpu_frames, (double)gpu.mean, (double)gpu.p50, (double)gpu.p95, (double)gpu.p99,
+            draw_submits, instances, (unsigned long long)peak_rss_kb());
+    fclose(f);
+}
+
+static EngineResult run_bench(Window *window, Renderer *renderer, const BenchDef *def,
+                              const BenchOptions *opt) {
+    BenchScene scene = {
+        .renderer = renderer,
+        .count    = opt->count ? opt->count : def->default_count,
+        .mesh     = MESH_HANDLE_INVALID,
+    };
+    s_rng = BENCH_SEED;
+
+    f32 *cpu_ms    = malloc(sizeof(f32) * opt->frames);
+    f32 *update_ms = malloc(sizeof(f32) * opt->frames);
+    f32 *gpu_ms    = malloc(sizeof(f32) * opt->frames);
+    EngineResult res = (cpu_ms && update_ms && gpu_ms) ? def->init(&scene)
+                                                        : ENGINE_ERROR_OUT_OF_MEMORY;
+    if (res != ENGINE_SUCCESS) {
+        LOG_WARN("Benchmark '%s' skipped (setup failed: %d)", def->name, res);
+        goto done;
+    }
+
+    LOG_INFO("Benchmark '%s': count %u, %u + %u frames", def->name, scene.count,
+             opt->warmup, opt->frames);
+
+    u32 total      = opt->warmup + opt->frames;
+    u32 measured   = 0;
+    u32 gpu_frames = 0;
+    u64 last_gpu   = UINT64_MAX;
+    u32 draw_submits = 0, instances = 0;
+
+    for (scene.frame = 0; scene.frame < total && !window_should_close(window); scene.frame++) {
+        window_poll_events();
+
+        f64 t0 = glfwGetTime();
+        def->update(&scene);
+        f64 t1 = glfwGetTime();
+
+        scene.draw_submits = 0;
+        scene.instances    = 0;
+        if (renderer_begin_frame(renderer) != ENGINE_SUCCESS) continue;
+        def->draw(&scene);
+        renderer_end_frame(renderer);
+        f64 t2 = glfwGetTime();
+
+        if (scene.frame < opt->warmup) continue;
+        cpu_ms[measured]    = (f32)((t2 - t0) * 1000.0);
+        update_ms[measured] = (f32)((t1 - t0) * 1000.0);
+        measured++;
+        draw_submits = scene.draw_submits;
+        instances    = scene.instances;
+
+        /* Timings lag a couple of frames; count each measured frame once */
+        GpuTimings gpu;
+        if (renderer_get_gpu_timings(renderer, &gpu) && gpu.frame_number != last_gpu) {
+            last_gpu = gpu.frame_number;
+            gpu_ms[gpu_frames++] = gpu.frame_ms;
+        }
+    }
+
+    Percentiles cpu    = percentiles(cpu_ms, measured);
+    Percentiles update = percentiles(update_ms, measured);
+    Percentiles gpu    = percentiles(gpu_ms, gpu_frames);
+
+    LOG_INFO("  cpu p50 %.2f / p99 %.2f ms, gpu p50 %.2f / p99 %.2f ms",
+             (double)cpu.p50, (double)cpu.p99, (double)gpu.p50, (double)gpu.p99);
+    write_csv_row(opt, def, scene.count, measured, cpu, update, gpu, gpu_frames,
+                  draw_submits, instances);
+
+done:
+    def->shutdown(&scene);
+    free(cpu_ms);
+    free(update_ms);
+    free(gpu_ms);
+    return res;
+}
+
+static bool parse_u32(const char *s, u32 *out) {
+    char *end = NULL;
+    unsigned long v = strtoul(s, &end, 10);
+    if (!end || *end != '\0') return false;
+    *out = (u32)v;
+    return true;
+}
+
+static bool parse_instance_format(const char *s, InstanceFormat3D *out) {
+    if      (!strcmp(s, "euler"))  *out = INSTANCE_FORMAT_3D_EULER;
+    else if (!strcmp(s, "quat"))   *out = INSTANCE_FORMAT_3D_QUAT;
+    else if (!strcmp(s, "matrix")) *out = INSTANCE_FORMAT_3D_MATRIX;
+    else return false;
+    return true;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: engine_bench [--scene all|cubes|skinned|particles|collision|text]\n"
+            "                    [--frames N] [--warmup N] [--count N] [--bloom]\n"
+            "                    [--instances euler|quat|matrix] [--label NAME] [--out FILE]\n");
+}
+
+int main(int argc, char **argv) {
+    log_init(LOG_LEVEL_INFO);
+
+    BenchOptions opt = {
+        .scene    = "all",
+        .label    = "dev",
+        .out_path = "bench_results.csv",
+        .frames   = 600,
+        .warmup   = 60,
+    };
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        bool ok = true;
+        if      (!strcmp(arg, "--bloom"))           opt.bloom = true;
+        else if (!strcmp(arg, "--scene")  && val) { opt.scene = val; i++; }
+        else if (!strcmp(arg, "--label")  && val) { opt.label = val; i++; }
+        else if (!strcmp(arg, "--out")    && val) { opt.out_path = val; i++; }
+        else if (!strcmp(arg, "--frames") && val) { ok = parse_u32(val, &opt.frames); i++; }
+        else if (!strcmp(arg, "--warmup") && val) { ok = parse_u32(val, &opt.warmup); i++; }
+        else if (!strcmp(arg, "--count")  && val) { ok = parse_u32(val, &opt.count); i++; }
+        else if (!strcmp(arg, "--instances") && val) {
+            ok = parse_instance_format(val, &opt.instance_format);
+            i++;
+        }
+        else ok = false;
+        if (!ok || opt.frames == 0) {
+            usage();
+            return 2;
+        }
+    }
+
+    if (jobs_init(0) != ENGINE_SUCCESS) {
+        LOG_WARN("Failed to start job system — running single-threaded");
+    }
+
+    WindowConfig win_config = {
+        .title     = "Engine Benchmark",
+        .width     = BENCH_WIDTH,
+        .height    = BENCH_HEIGHT,
+        .resizable = false,
+    };
+    Window *window = NULL;
+    if (window_create(&win_config, &window) != ENGINE_SUCCESS) {
+        LOG_FATAL("Failed to create window");
+        return 1;
+    }
+    input_init(window);
+
+    RendererConfig render_config = {
+        .font_path   = "assets/consolas.ttf",
+        .font_size   = 24.0f,
+        .clear_color = { 0.05f, 0.05f, 0.08f, 1.0f },
+        .instance_format_3d = opt.instance_format,
+    };
+    Renderer *renderer = NULL;
+    if (renderer_create(window, &render_config, &renderer) != ENGINE_SUCCESS) {
+        LOG_FATAL("Failed to create renderer");
+        window_destroy(window);
+        return 1;
+    }
+    if (opt.bloom) renderer_set_bloom(renderer, true, 0.8f, 1.2f);
+
+    u32 ran = 0;
+    for (u32 b = 0; b < ENGINE_ARRAY_LEN(s_benches); b++) {
+        if (strcmp(opt.scene, "all") != 0 && strcmp(opt.scene, s_benches[b].name) != 0) continue;
+        run_bench(window, renderer, &s_benches[b], &opt);
+        ran++;
+    }
+    if (ran == 0) {
+        LOG_ERROR("Unknown scene '%s'", opt.scene);
+        usage();
+    } else {
+        LOG_INFO("Results appended to %s", opt.out_path);
+    }
+
+    renderer_destroy(renderer);
+    window_destroy(window);
+    jobs_shutdown();
+    return ran ? 0 : 2;
+}
@@ -0,0 +1,830 @@
+/* CPU-only microbenchmarks.
+ *
+ * Times the hot animation, blending, collision, particle and ECS kernels in
+ * isolation on synthetic, fixed-seed data. No window or Vulkan device is
+ * created, so it runs anywhere the engine library links (CI, headless
+ * machines). Every size option takes a comma-separated list and each kernel
+ * runs once per value, so scaling is visible in one run:
+ *
+ *   micro_bench [--kernel all|NAME] [--joints 16,64,128] [--keys 32]
+ *               [--bodies 500,2000] [--particles 10000,50000]
+ *               [--entities 10000,50000]
+ *               [--repeats N] [--min-ms N] [--label NAME] [--out FILE]
+ *
+ * Each repeat runs a kernel for at least --min-ms (the iteration count is
+ * calibrated once per case); the median and minimum ns per call over the
+ * repeats are printed and appended to --out as CSV. */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L   /* clock_gettime */
+#endif
+
+#include "core/common.h"
+#include "core/log.h"
+#include "core/arena.h"
+#include "renderer/animation.h"
+#include "renderer/anim_blend.h"
+#include "renderer/anim_compress.h"
+#include "renderer/anim_graph.h"
+#include "gameplay/particles.h"
+#include "gameplay/particle_system.h"
+#include "gameplay/collision.h"
+#include "gameplay/gameobject.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define MICRO_SEED          0x5EEDu
+#define MICRO_MAX_SIZES     16
+#define MICRO_MAX_REPEATS   64
+#define MICRO_DT            (1.0f / 60.0f)
+#define MICRO_TIME_TABLE    256               /* pre-drawn random sample times */
+#define MICRO_SCRATCH_BYTES (64 * 1024)
+
+#define BLEND_CLIPS         5                 /* idle + four directions */
+#define COLLISION_RADIUS    0.25f
+
+/* --------------------------------------------------------------------------
+ * Helpers
+ * ------------------------------------------------------------------------ */
+
+/* xorshift32: the same sequence on every platform, unlike rand() */
+static u32 s_rng = MICRO_SEED;
+
+static f32 rng_f32(f32 lo, f32 hi) {
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return lo + (hi - lo) * (f32)(s_rng >> 8) * (1.0f / 16777216.0f);
+}
+
+static f64 now_seconds(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (f64)now.QuadPart / (f64)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (f64)ts.tv_sec + (f64)ts.tv_nsec * 1e-9;
+#endif
+}
+
+/* Results feed this so the compiler can't drop a kernel's work */
+static volatile f32 s_sink;
+
+static int cmp_f64(const void *a, const void *b) {
+    f64 x = *(const f64 *)a, y = *(const f64 *)b;
+    return (x > y) - (x < y);
+}
+
+/* --------------------------------------------------------------------------
+ * Animation fixture: synthetic skeleton and clips
+ * ------------------------------------------------------------------------ */
+
+typedef struct {
+    SkinnedModel  model;        /* BLEND_CLIPS clips; clip 0 drives the single-clip kernels */
+    SkinnedModel  compressed;   /* one clip built like clip 0, then resampled */
+    BlendSpace2D  space;
+    BoneMask     *mask;         /* upper half of the tree */
+
+    AnimPose     *pose_a, *pose_b, *pose_ref, *pose_out;
+    AnimCursor    cursor;
+    u16           cursor_keys[ANIM_CURSOR_MAX_CHANNELS];
+    AnimCursorSet cursor_set;
+    u16           set_keys[ANIM_CURSOR_SET_SIZE][ANIM_CURSOR_MAX_CHANNELS];
+
+    f32         (*matrices)[16];
+    f32         (*affine)[JOINT_AFFINE_FLOATS];
+    u8           *pose_buf;
+    u8           *scratch_buf;
+    Arena         poses;        /* long-lived poses above */
+    Arena         scratch;      /* reset before every call */
+
+    f32           times[MICRO_TIME_TABLE];
+    f32           time;         /* playback time for the sequential kernels */
+    u32           step;
+} AnimFixture;
+
+/* Binary-ish tree in glTF order (every parent precedes its children) */
+static void make_skeleton(Skeleton *skel, u32 joint_count) {
+    memset(skel, 0, sizeof(*skel));
+    skel->joint_count = joint_count;
+    for (u32 j = 0; j < joint_count; j++) {
+        skel->parent_indices[j] = (j == 0) ? -1 : (i32)((j - 1) / 2);
+        skel->rest_translations[j][1] = 0.1f;
+        skel->rest_rotations[j][3]    = 1.0f;
+        skel->rest_scales[j][0] = skel->rest_scales[j][1] = skel->rest_scales[j][2] = 1.0f;
+        for (u32 k = 0; k < 4; k++) skel->inverse_bind_matrices[j][k * 5] = 1.0f;
+    }
+    for (u32 k = 0; k < 4; k++) skel->root_transform[k * 5] = 1.0f;
+}
+
+/* One T, R and S channel per joint, `keys` evenly spaced linear keyframes
+ * over one second. Returns false on allocation failure (the caller frees the
+ * partially built clip through skinned_model_destroy). */
+static bool make_clip(AnimClip *clip, u32 joint_count, u32 keys, u32 seed) {
+    s_rng = seed;
+    snprintf(clip->name, sizeof(clip->name), "synthetic_%u", seed);
+    clip->duration = 1.0f;
+    clip->channels = calloc(joint_count * 3, sizeof(AnimChannel));
+    if (!clip->channels) return false;
+
+    for (u32 j = 0; j < joint_count; j++) {
+        for (u32 p = 0; p < 3; p++) {
+            AnimChannel *ch = &clip->channels[clip->channel_count++];
+            u32 comps = (p == ANIM_PATH_ROTATION) ? 4 : 3;
+            ch->target_joint   = j;
+            ch->path           = (AnimPathType)p;
+            ch->interpolation  = ANIM_INTERP_LINEAR;
+            ch->keyframe_count = keys;
+            ch->timestamps     = malloc(sizeof(f32) * keys);
+            ch->values         = malloc(sizeof(f32) * keys * comps);
+            if (!ch->timestamps || !ch->values) return false;
+
+            for (u32 k = 0; k < keys; k++) {
+                f32 *v = &ch->values[k * comps];
+                ch->timestamps[k] = (f32)k / (f32)(keys - 1);
+                if (p == ANIM_PATH_ROTATION) {
+                    f32 len = 0.0f;
+                    for (u32 c = 0; c < 4; c++) { v[c] = rng_f32(-1.0f, 1.0f); len += v[c] * v[c]; }
+                    len = sqrtf(len > 1e-6f ? len : 1.0f);
+                    for (u32 c = 0; c < 4; c++) v[c] /= len;
+                } else if (p == ANIM_PATH_SCALE) {
+                    for (u32 c = 0; c < 3; c++) v[c] = rng_f32(0.9f, 1.1f);
+                } else {
+                    for (u32 c = 0; c < 3; c++) v[c] = rng_f32(-0.2f, 0.2f);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static void anim_fixture_destroy(AnimFixture *fx) {
+    if (!fx) return;
+    skinned_model_destroy(&fx->model);
+    skinned_model_destroy(&fx->compressed);
+    bone_mask_destroy(fx->mask);
+    free(fx->matrices);
+    free(fx->affine);
+    free(fx->pose_buf);
+    free(fx->scratch_buf);
+    free(fx);
+}
+
+static AnimFixture *anim_fixture_create(u32 joint_count, u32 keys) {
+    AnimFixture *fx = calloc(1, sizeof(AnimFixture));
+    if (!fx) return NULL;
+
+    make_skeleton(&fx->model.skeleton, joint_count);
+    fx->compressed.skeleton = fx->model.skeleton;
+
+    fx->model.clips      = calloc(BLEND_CLIPS, sizeof(AnimClip));
+    fx->compressed.clips = calloc(1, sizeof(AnimClip));
+    if (!fx->model.clips || !fx->compressed.clips) goto fail;
+    fx->model.clip_count      = BLEND_CLIPS;
+    fx->compressed.clip_count = 1;
+    for (u32 c = 0; c < BLEND_CLIPS; c++) {
+        if (!make_clip(&fx->model.clips[c], joint_count, keys, MICRO_SEED + c)) goto fail;
+    }
+    if (!make_clip(&fx->compressed.clips[0], joint_count, keys, MICRO_SEED)) goto fail;
+    if (anim_clip_compress(&fx->compressed.clips[0], &fx->compressed.skeleton, 0.0f)
+            != ENGINE_SUCCESS) goto fail;
+
+    /* Locomotion-style layout: idle in the centre, one clip per direction */
+    static const f32 positions[BLEND_CLIPS][2] = {
+        { 0.0f, 0.0f }, { 0.0f, 1.0f }, { 1.0f, 0.0f }, { 0.0f, -1.0f }, { -1.0f, 0.0f },
+    };
+    for (u32 c = 0; c < BLEND_CLIPS; c++) {
+        fx->space.entries[c].position[0] = positions[c][0];
+        fx->space.entries[c].position[1] = positions[c][1];
+        fx->space.entries[c].clip_index  = c;
+    }
+    fx->space.entry_count = BLEND_CLIPS;
+
+    fx->mask = bone_mask_create_from_joint(&fx->model.skeleton, joint_count > 1 ? 1 : 0, 1.0f);
+
+    size_t pose_bytes = ANIM_POSE_MAX_BYTES * 4;
+    fx->pose_buf    = malloc(pose_bytes);
+    fx->scratch_buf = malloc(MICRO_SCRATCH_BYTES);
+    fx->matrices    = malloc(sizeof(f32) * 16 * MAX_JOINTS);
+    fx->affine      = malloc(sizeof(f32) * JOINT_AFFINE_FLOATS * MAX_JOINTS);
+    if (!fx->mask || !fx->pose_buf || !fx->scratch_buf || !fx->matrices || !fx->affine) goto fail;
+    arena_init(&fx->poses, fx->pose_buf, pose_bytes);
+    arena_init(&fx->scratch, fx->scratch_buf, MICRO_SCRATCH_BYTES);
+
+    fx->pose_a   = pose_alloc(&fx->poses, joint_count);
+    fx->pose_b   = pose_alloc(&fx->poses, joint_count);
+    fx->pose_ref = pose_alloc(&fx->poses, joint_count);
+    fx->pose_out = pose_alloc(&fx->poses, joint_count);
+    if (!fx->pose_a || !fx->pose_b || !fx->pose_ref || !fx->pose_out) goto fail;
+    animation_evaluate_pose(&fx->model.skeleton, &fx->model.clips[0], 0.3f, NULL, fx->pose_a);
+    animation_evaluate_pose(&fx->model.skeleton, &fx->model.clips[1], 0.6f, NULL, fx->pose_b);
+    pose_from_rest(&fx->model.skeleton, fx->pose_ref);
+    pose_copy(fx->pose_a, joint_count, fx->pose_out);
+
+    fx->cursor.keys     = fx->cursor_keys;
+    fx->cursor.capacity = ANIM_CURSOR_MAX_CHANNELS;
+    for (u32 c = 0; c < ANIM_CURSOR_SET_SIZE; c++) {
+        fx->cursor_set.cursors[c].keys     = fx->set_keys[c];
+        fx->cursor_set.cursors[c].capacity = ANIM_CURSOR_MAX_CHANNELS;
+    }
+
+    s_rng = MICRO_SEED;
+    for (u32 i = 0; i < MICRO_TIME_TABLE; i++) fx->times[i] = rng_f32(0.0f, 1.0f);
+    return fx;
+
+fail:
+    LOG_ERROR("Animation fixture setup failed (%u joints, %u keys)", joint_count, keys);
+    anim_fixture_destroy(fx);
+    return NULL;
+}
+
+/* Playback time advancing one frame per call, as a playing clip would */
+static f32 anim_next_time(AnimFixture *fx) {
+    fx->time += MICRO_DT;
+    if (fx->time >= 1.0f) fx->time -= 1.0f;
+    return fx->time;
+}
+
+/* Random time per call: defeats the keyframe hints (scrubbing, seeking) */
+static f32 anim_random_time(AnimFixture *fx) {
+    return fx->times[fx->step++ % MICRO_TIME_TABLE];
+}
+
+/* --------------------------------------------------------------------------
+ * Animation kernels
+ * ------------------------------------------------------------------------ */
+
+static void run_sample_channel(void *data, u32 iterations) {
+    AnimFixture *fx = data;
+    const AnimChannel *ch = &fx->model.clips[0].channels[1];   /* joint 0 rotation */
+    f32 out[4], acc = 0.0f;
+    for (u32 i = 0; i < iterations; i++) {
+        animation_sample_channel(ch, anim_random_time(fx), out);
+        acc += out[3];
+    }
+    s_sink = acc;
+}
+
+static void run_evaluate_pose(void *data, u32 iterations) {
+    AnimFixture *fx = data;
+    for (u32 i = 0; i < iterations; i++) {
+        animation_evaluate_pose(&fx->model.skeleton, &fx->model.clips[0], anim_next_time(fx),
+                                &fx->cursor, fx->pose_out);
+    }
+    s_sink = fx->pose_out->rw[0];
+}
+
+static void run_evaluate_pose_seek(void *data, u32 iterations) {
+    AnimFixture *fx = data;
+    for (u32 i = 0; i < iterations; i++) {
+        animation_evaluate_pose(&fx->model.skeleton, &fx->model.clips[0], anim_random_time(fx),
+                                NULL, fx->pose_out);
+    }
+    s_sink = fx->pose_out->rw[0];
+}
+
+static void run_evaluate_pose_compressed(void *data, u32 iterations) {
+    AnimFixture *fx = data;
+    for (u32 i = 0; i < iterations; i++) {
+        animation_evaluate_pose(&fx->compressed.skeleton, &fx->compressed.clips[0],
+                                anim_next_time(fx), NULL, fx->pose_out);
+    }
+    s_sink = fx->pose_out->rw[0];
+}
+
+static void run_pose_blend(void *data, u32 iterations) {
+    AnimFixture *fx = data;
+    u32 jc = fx->model.skeleton.joint_count;
+    for (u32 i = 0; i < iterations; i++) {
+        pose_blend(fx->pose_a, fx->pose_b, jc, (f32)(i & 7) * 0.125f, fx->pose_out);
+    }
+    s_sink = fx->pose_out->rw[0];
+}
+
+static void run_pose_blend_masked(void *data, u32 iterations) {
+    AnimFixture *fx = data;
+    u32 jc = fx->model.skeleton.joint_count;
+    for (u32 i = 0; i < iterations; i++) {
+        pose_blend_masked(fx->pose_a, fx->pose_b, jc, fx->mask, (f32)(i & 7) * 0.125f,
+                          fx->pose_out);
+    }
+    s_sink = fx->pose_out->rw[0];
+}
+
+static void run_pose_blend_additive(void *data, u32 iterations) {
+    AnimFixture *fx = data;
+    u32 jc = fx->model.skeleton.joint_count;
+    for (u32 i = 0; i < iterations; i++) {
+        pose_blend_additive(fx->pose_a, fx->pose_b, fx->pose_ref, jc, NULL,
+                            (f32)(i & 7) * 0.125f, fx->pose_out);
+    }
+    s_sink = fx->pose_out->rw[0];
+}
+
+static void run_blend_space_2d(void *data, u32 iterations) {
+    AnimFixture *fx = data;
+    for (u32 i = 0; i < iterations; i++) {
+        /* Parameter circles the origin, crossing every triangle of the space */
+        f32 angle = (f32)(i & 63) * (6.2831853f / 64.0f);
+        arena_reset(&fx->scratch);
+        blend_space_2d_evaluate(&fx->space, 0.8f * cosf(angle), 0.8f * sinf(angle), &fx->model,
+                                anim_next_time(fx), &fx->scratch, &fx->cursor_set, NULL,
+                                fx->pose_out);
+    }
+    s_sink = fx->pose_out->rw[0];
+}
+
+static void run_pose_to_matrices(void *data, u32 iterations) {
+    AnimFixture *fx = data;
+    for (u32 i = 0; i < iterations; i++) {
+        arena_reset(&fx->scratch);
+        animation_pose_to_matrices(fx->pose_a, &fx->model.skeleton, fx->matrices, &fx->scratch);
+    }
+    s_sink = fx->matrices[0][0];
+}
+
+static void run_pose_to_affine(void *data, u32 iterations) {
+    AnimFixture *fx = data;
+    for (u32 i = 0; i < iterations; i++) {
+        arena_reset(&fx->scratch);
+        animation_pose_to_affine(fx->pose_a, &fx->model.skeleton, fx->affine, &fx->scratch);
+    }
+    s_sink = fx->affine[0][0];
+}
+
+/* --------------------------------------------------------------------------
+ * Collision and particle fixtures
+ * ------------------------------------------------------------------------ */
+
+typedef struct {
+    InstanceData  *bodies;      /* first half is group A, second half group B */
+    CollisionPair *pairs;
+    i32            count;
+    i32            max_pairs;
+    u8            *grid_buf;
+    Arena          grid_arena;  /* broadphase storage, reset before every call */
+    f32           *x, *y;       /* SoA copy of the positions */
+} CollisionFixture;
+
+static void collision_fixture_destroy(CollisionFixture *fx) {
+    if (!fx) return;
+    free(fx->bodies);
+    free(fx->pairs);
+    free(fx->grid_buf);
+    free(fx->x);
+    free(fx->y);
+    free(fx);
+}
+
+/* Constant density (one body per square unit) so the pair count grows
+ * linearly with the body count, as in a larger level */
+static CollisionFixture *collision_fixture_create(u32 count) {
+    CollisionFixture *fx = calloc(1, sizeof(CollisionFixture));
+    if (!fx) return NULL;
+    fx->count     = (i32)count;
+    fx->max_pairs = (i32)count * 4;
+    fx->bodies    = calloc(count, sizeof(InstanceData));
+    fx->pairs     = malloc(sizeof(CollisionPair) * (size_t)fx->max_pairs);
+    size_t grid_bytes = collision_grid_memory_size((i32)count);
+    fx->grid_buf  = malloc(grid_bytes);
+    fx->x         = malloc(sizeof(f32) * count);
+    fx->y         = malloc(sizeof(f32) * count);
+    if (!fx->bodies || !fx->pairs || !fx->grid_buf || !fx->x || !fx->y) {
+        collision_fixture_destroy(fx);
+        return NULL;
+    }
+
+    s_rng = MICRO_SEED;
+    f32 half = 0.5f * sqrtf((f32)count);
+    for (u32 i = 0; i < count; i++) {
+        fx->bodies[i].position[0] = rng_f32(-half, half);
+        fx->bodies[i].position[1] = rng_f32(-half, half);
+        fx->bodies[i].scale[0] = fx->bodies[i].scale[1] = COLLISION_RADIUS * 2.0f;
+    }
+    arena_init(&fx->grid_arena, fx->grid_buf, grid_bytes);
+    collision_circles_from_instances(fx->bodies, fx->count, fx->x, fx->y);
+    return fx;
+}
+
+static void run_collision(void *data, u32 iterations) {
+    CollisionFixture *fx = data;
+    i32 half = fx->count / 2, hits = 0;
+    for (u32 i = 0; i < iterations; i++) {
+        hits += collision_instances_vs_instances(fx->bodies, half, COLLISION_RADIUS,
+                                                 fx->bodies + half, fx->count - half,
+                                                 COLLISION_RADIUS, fx->pairs, fx->max_pairs);
+    }
+    s_sink = (f32)hits;
+}
+
+static void run_collision_soa(void *data, u32 iterations) {
+    CollisionFixture *fx = data;
+    i32 half = fx->count / 2, hits = 0;
+    CollisionCircles a = { fx->x, fx->y, NULL, COLLISION_RADIUS, half };
+    CollisionCircles b = { fx->x + half, fx->y + half, NULL, COLLISION_RADIUS, fx->count - half };
+    for (u32 i = 0; i < iterations; i++) {
+        hits += collision_circles_vs_circles(&a, &b, fx->pairs, fx->max_pairs);
+    }
+    s_sink = (f32)hits;
+}
+
+static void run_collision_grid(void *data, u32 iterations) {
+    CollisionFixture *fx = data;
+    i32 half = fx->count / 2, hits = 0;
+    for (u32 i = 0; i < iterations; i++) {
+        arena_reset(&fx->grid_arena);
+        hits += collision_instances_vs_instances_grid(fx->bodies, half, COLLISION_RADIUS,
+                                                      fx->bodies + half, fx->count - half,
+                                                      COLLISION_RADIUS, fx->pairs, fx->max_pairs,
+                                                      &fx->grid_arena);
+    }
+    s_sink = (f32)hits;
+}
+
+typedef struct {
+    Particle       *particles;
+    i32             count;
+    ParticleSystem *system;     /* same particles, SoA (CPU mode) */
+} ParticleFixture;
+
+static void particle_fixture_destroy(ParticleFixture *fx) {
+    if (!fx) return;
+    particle_system_destroy(fx->system);
+    free(fx->particles);
+    free(fx);
+}
+
+/* Lifetimes far beyond any run, so the live count (the work per call) stays
+ * fixed; the swap-remove path is exercised by engine_bench instead */
+static ParticleFixture *particle_fixture_create(u32 count) {
+    ParticleFixture *fx = calloc(1, sizeof(ParticleFixture));
+    if (!fx) return NULL;
+    fx->count     = (i32)count;
+    fx->particles = calloc(count, sizeof(Particle));
+    if (!fx->particles) {
+        particle_fixture_destroy(fx);
+        return NULL;
+    }
+
+    s_rng = MICRO_SEED;
+    for (u32 i = 0; i < count; i++) {
+        Particle *p = &fx->particles[i];
+        p->velocity[0]      = rng_f32(-4.0f, 4.0f);
+        p->velocity[1]      = rng_f32(-4.0f, 4.0f);
+        p->color[0] = p->color[1] = p->color[2] = 1.0f;
+        p->max_lifetime     = 1.0e9f;
+        p->lifetime         = p->max_lifetime;
+        p->angular_velocity = rng_f32(-3.0f, 3.0f);
+        p->scale            = 0.2f;
+    }
+
+    ParticleSystemConfig config = {
+        .capacity = (i32)count,
+        .mode     = PARTICLE_SIM_CPU,
+        .mesh     = MESH_HANDLE_INVALID,
+        .texture  = TEXTURE_HANDLE_INVALID,
+        .seed     = MICRO_SEED,
+    };
+    ParticleEmitter burst = {
+        .color        = { 1.0f, 1.0f, 1.0f },
+        .count        = (i32)count,
+        .speed_min    = 0.0f,  .speed_max    = 5.0f,
+        .lifetime_min = 1.0e9f, .lifetime_max = 1.0e9f,
+        .scale        = 0.2f,
+        .angular_velocity_min = -3.0f, .angular_velocity_max = 3.0f,
+    };
+    if (particle_system_create(&config, NULL, &fx->system) != ENGINE_SUCCESS) {
+        particle_fixture_destroy(fx);
+        return NULL;
+    }
+    particle_system_burst(fx->system, &burst);
+    return fx;
+}
+
+static void run_particles_update(void *data, u32 iterations) {
+    ParticleFixture *fx = data;
+    for (u32 i = 0; i < iterations; i++) {
+        fx->count = particles_update(fx->particles, fx->count, MICRO_DT);
+    }
+    s_sink = fx->particles[0].position[0];
+}
+
+static void run_particle_system_update(void *data, u32 iterations) {
+    ParticleFixture *fx = data;
+    for (u32 i = 0; i < iterations; i++) {
+        particle_system_update(fx->system, MICRO_DT);
+    }
+    s_sink = (f32)particle_system_count(fx->system);
+}
+
+typedef struct {
+    World          *world;
+    GameObjectTypes types;
+} EntityFixture;
+
+static void entity_fixture_destroy(EntityFixture *fx) {
+    if (!fx) return;
+    world_destroy(fx->world);
+    free(fx);
+}
+
+/* Moving objects, a quarter of them also carrying a (never expiring)
+ * lifetime, so the query spans two archetypes like a real scene */
+static EntityFixture *entity_fixture_create(u32 count) {
+    EntityFixture *fx = calloc(1, sizeof(EntityFixture));
+    if (!fx) return NULL;
+    if (world_create(&fx->world) != ENGINE_SUCCESS ||
+        gameobject_register(fx->world, &fx->types) != ENGINE_SUCCESS) {
+        entity_fixture_destroy(fx);
+        return NULL;
+    }
+
+    s_rng = MICRO_SEED;
+    for (u32 i = 0; i < count; i++) {
+        GameObjectDesc desc = {
+            .transform  = { { rng_f32(-50.0f, 50.0f), rng_f32(-50.0f, 50.0f) }, 0.0f,
+                            { 1.0f, 1.0f } },
+            .renderable = { MESH_HANDLE_INVALID, TEXTURE_HANDLE_INVALID, { 1.0f, 1.0f, 1.0f },
+                            { 0.0f, 0.0f }, { 0.0f, 0.0f } },
+            .velocity   = { { rng_f32(-4.0f, 4.0f), rng_f32(-4.0f, 4.0f) },
+                            rng_f32(-3.0f, 3.0f) },
+            .moving     = true,
+            .lifetime   = (i % 4 == 0) ? 1.0e9f : 0.0f,
+        };
+        if (gameobject_spawn(fx->world, &fx->types, &desc) == ENTITY_INVALID) {
+            entity_fixture_destroy(fx);
+            return NULL;
+        }
+    }
+    return fx;
+}
+
+static void run_world_integrate(void *data, u32 iterations) {
+    EntityFixture *fx = data;
+    for (u32 i = 0; i < iterations; i++) {
+        gameobject_integrate(fx->world, &fx->types, MICRO_DT);
+    }
+    s_sink = (f32)world_entity_count(fx->world);
+}
+
+/* --------------------------------------------------------------------------
+ * Kernel table
+ * ------------------------------------------------------------------------ */
+
+typedef enum {
+    FIXTURE_ANIM,        /* sized by --joints x --keys */
+    FIXTURE_COLLISION,   /* sized by --bodies */
+    FIXTURE_PARTICLES,   /* sized by --particles */
+    FIXTURE_ENTITIES,    /* sized by --entities */
+} FixtureKind;
+
+typedef struct {
+    const char  *name;
+    FixtureKind  fixture;
+    bool         per_call;   /* one item per call (not per joint / body) */
+    void       (*run)(void *fixture, u32 iterations);
+} MicroKernel;
+
+static const MicroKernel s_kernels[] = {
+    { "sample_channel",           FIXTURE_ANIM,      true,  run_sample_channel },
+    { "evaluate_pose",            FIXTURE_ANIM,      false, run_evaluate_pose },
+    { "evaluate_pose_seek",       FIXTURE_ANIM,      false, run_evaluate_pose_seek },
+    { "evaluate_pose_compressed", FIXTURE_ANIM,      false, run_evaluate_pose_compressed },
+    { "pose_blend",               FIXTURE_ANIM,      false, run_pose_blend },
+    { "pose_blend_masked",        FIXTURE_ANIM,      false, run_pose_blend_masked },
+    { "pose_blend_additive",      FIXTURE_ANIM,      false, run_pose_blend_additive },
+    { "blend_space_2d",           FIXTURE_ANIM,      false, run_blend_space_2d },
+    { "pose_to_matrices",         FIXTURE_ANIM,      false, run_pose_to_matrices },
+    { "pose_to_affine",           FIXTURE_ANIM,      false, run_pose_to_affine },
+    { "collision",                FIXTURE_COLLISION, false, run_collision },
+    { "collision_soa",            FIXTURE_COLLISION, false, run_collision_soa },
+    { "collision_grid",           FIXTURE_COLLISION, false, run_collision_grid },
+    { "particles_update",         FIXTURE_PARTICLES, false, run_particles_update },
+    { "particle_system_update",   FIXTURE_PARTICLES, false, run_particle_system_update },
+    { "world_integrate",          FIXTURE_ENTITIES,  false, run_world_integrate },
+};
+
+/* --------------------------------------------------------------------------
+ * Runner
+ * ------------------------------------------------------------------------ */
+
+typedef struct {
+    u32 values[MICRO_MAX_SIZES];
+    u32 count;
+} SizeList;
+
+typedef struct {
+    const char *kernel;
+    const char *label;
+    const char *out_path;
+    SizeList    joints;
+    SizeList    keys;
+    SizeList    bodies;
+    SizeList    particles;
+    SizeList    entities;
+    u32         repeats;
+    u32         min_ms;
+} MicroOptions;
+
+typedef struct {
+    f64 median_ns;
+    f64 min_ns;
+    u32 iterations;
+} MicroResult;
+
+/* Grow the iteration count until one batch takes min_ms, then time
+ * `repeats` batches of that size */
+static MicroResult time_kernel(const MicroKernel *k, void *fixture, const MicroOptions *opt) {
+    f64 target = (f64)opt->min_ms * 1e-3;
+    u32 iterations = 1;
+    for (;;) {
+        f64 t0 = now_seconds();
+        k->run(fixture, iterations);
+        f64 dt = now_seconds() - t0;
+        if (dt >= target || iterations >= (1u << 30)) break;
+        f64 grow = (dt > 0.0) ? 1.2 * target / dt : 10.0;
+        grow = ENGINE_CLAMP(grow, 2.0, 10.0);
+        iterations = (u32)ENGINE_MIN((f64)(1u << 30), iterations * grow);
+    }
+
+    f64 samples[MICRO_MAX_REPEATS];
+    for (u32 r = 0; r < opt->repeats; r++) {
+        f64 t0 = now_seconds();
+        k->run(fixture, iterations);
+        samples[r] = (now_seconds() - t0) * 1e9 / iterations;
+    }
+    qsort(samples, opt->repeats, sizeof(f64), cmp_f64);
+
+    return (MicroResult){
+        .median_ns  = samples[opt->repeats / 2],
+        .min_ns     = samples[0],
+        .iterations = iterations,
+    };
+}
+
+static void report(const MicroOptions *opt, const MicroKernel *k, u32 count, u32 keys,
+                   MicroResult res, FILE *csv) {
+    f64 per_item = k->per_call ? res.median_ns : res.median_ns / count;
+    printf("%-26s %7u %5u %12.1f %12.1f %10.2f %10u\n", k->name, count, keys,
+           res.median_ns, res.min_ns, per_item, res.iterations);
+    if (csv) {
+        fprintf(csv, "%s,%s,%u,%u,%u,%u,%.1f,%.1f,%.3f\n", opt->label, k->name, count, keys,
+                res.iterations, opt->repeats, res.median_ns, res.min_ns, per_item);
+    }
+}
+
+static bool run_kernel(const MicroOptions *opt, const MicroKernel *k, FILE *csv) {
+    switch (k->fixture) {
+    case FIXTURE_ANIM:
+        for (u32 j = 0; j < opt->joints.count; j++) {
+            for (u32 n = 0; n < opt->keys.count; n++) {
+                AnimFixture *fx = anim_fixture_create(opt->joints.values[j], opt->keys.values[n]);
+                if (!fx) return false;
+                report(opt, k, opt->joints.values[j], opt->keys.values[n],
+                       time_kernel(k, fx, opt), csv);
+                anim_fixture_destroy(fx);
+            }
+        }
+        return true;
+    case FIXTURE_COLLISION:
+        for (u32 i = 0; i < opt->bodies.count; i++) {
+            CollisionFixture *fx = collision_fixture_create(opt->bodies.values[i]);
+            if (!fx) return false;
+            report(opt, k, opt->bodies.values[i], 0, time_kernel(k, fx, opt), csv);
+            collision_fixture_destroy(fx);
+        }
+        return true;
+    case FIXTURE_PARTICLES:
+        for (u32 i = 0; i < opt->particles.count; i++) {
+            ParticleFixture *fx = particle_fixture_create(opt->particles.values[i]);
+            if (!fx) return false;
+            report(opt, k, opt->particles.values[i], 0, time_kernel(k, fx, opt), csv);
+            particle_fixture_destroy(fx);
+        }
+        return true;
+    case FIXTURE_ENTITIES:
+        for (u32 i = 0; i < opt->entities.count; i++) {
+            EntityFixture *fx = entity_fixture_create(opt->entities.values[i]);
+            if (!fx) return false;
+            report(opt, k, opt->entities.values[i], 0, time_kernel(k, fx, opt), csv);
+            entity_fixture_destroy(fx);
+        }
+        return true;
+    }
+    return false;
+}
+
+static bool parse_u32(const char *s, u32 *out) {
+    char *end = NULL;
+    unsigned long v = strtoul(s, &end, 10);
+    if (!end || *end != '\0') return false;
+    *out = (u32)v;
+    return true;
+}
+
+/* "16,64,128" -> values in [lo, hi] */
+static bool parse_sizes(const char *s, SizeList *out, u32 lo, u32 hi) {
+    out->count = 0;
+    while (*s) {
+        char *end = NULL;
+        unsigned long v = strtoul(s, &end, 10);
+        if (end == s || v < lo || v > hi || out->count == MICRO_MAX_SIZES) return false;
+        out->values[out->count++] = (u32)v;
+        if (*end == ',') end++;
+        else if (*end != '\0') return false;
+        s = end;
+    }
+    return out->count > 0;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: micro_bench [--kernel all|NAME] [--joints LIST] [--keys LIST]\n"
+            "                   [--bodies LIST] [--particles LIST] [--entities LIST]\n"
+            "                   [--repeats N] [--min-ms N] [--label NAME] [--out FILE]\n"
+            "  LIST is comma separated, e.g. --joints 16,64,128\n"
+            "  kernels:");
+    for (u32 k = 0; k < ENGINE_ARRAY_LEN(s_kernels); k++) fprintf(stderr, " %s", s_kernels[k].name);
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char **argv) {
+    log_init(LOG_LEVEL_INFO);
+
+    MicroOptions opt = {
+        .kernel    = "all",
+        .label     = "dev",
+        .out_path  = "micro_results.csv",
+        .joints    = { { 16, 64, MAX_JOINTS }, 3 },
+        .keys      = { { 32 }, 1 },
+        .bodies    = { { 500, 2000 }, 2 },
+        .particles = { { 10000, 50000 }, 2 },
+        .entities  = { { 10000, 50000 }, 2 },
+        .repeats   = 9,
+        .min_ms    = 20,
+    };
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        bool ok = true;
+        if      (!strcmp(arg, "--kernel")    && val) { opt.kernel = val; i++; }
+        else if (!strcmp(arg, "--label")     && val) { opt.label = val; i++; }
+        else if (!strcmp(arg, "--out")       && val) { opt.out_path = val; i++; }
+        else if (!strcmp(arg, "--joints")    && val) { ok = parse_sizes(val, &opt.joints, 1, MAX_JOINTS); i++; }
+        else if (!strcmp(arg, "--keys")      && val) { ok = parse_sizes(val, &opt.keys, 2, UINT16_MAX); i++; }
+        else if (!strcmp(arg, "--bodies")    && val) { ok = parse_sizes(val, &opt.bodies, 2, 1u << 24); i++; }
+        else if (!strcmp(arg, "--particles") && val) { ok = parse_sizes(val, &opt.particles, 1, 1u << 26); i++; }
+        else if (!strcmp(arg, "--entities")  && val) { ok = parse_sizes(val, &opt.entities, 1, WORLD_MAX_ENTITIES); i++; }
+        else if (!strcmp(arg, "--repeats")   && val) { ok = parse_u32(val, &opt.repeats); i++; }
+        else if (!strcmp(arg, "--min-ms")    && val) { ok = parse_u32(val, &opt.min_ms); i++; }
+        else ok = false;
+        if (!ok || opt.repeats == 0 || opt.repeats > MICRO_MAX_REPEATS) {
+            usage();
+            return 2;
+        }
+    }
+
+    FILE *probe  = fopen(opt.out_path, "rb");
+    bool  header = (probe == NULL);
+    if (probe) fclose(probe);
+    FILE *csv = fopen(opt.out_path, "ab");
+    if (!csv) {
+        LOG_ERROR("Cannot open %s for writing", opt.out_path);
+    } else if (header) {
+        fprintf(csv, "label,kernel,count,keys,iterations,repeats,"
+                     "ns_median,ns_min,ns_per_item\n");
+    }
+
+    printf("%-26s %7s %5s %12s %12s %10s %10s\n", "kernel", "count", "keys",
+           "ns/call p50", "ns/call min", "ns/item", "iters");
+
+    u32 ran = 0;
+    bool ok = true;
+    for (u32 k = 0; k < ENGINE_ARRAY_LEN(s_kernels); k++) {
+        if (strcmp(opt.kernel, "all") != 0 && strcmp(opt.kernel, s_kernels[k].name) != 0) continue;
+        ok &= run_kernel(&opt, &s_kernels[k], csv);
+        ran++;
+    }
+    if (csv) fclose(csv);
+
+    if (ran == 0) {
+        LOG_ERROR("Unknown kernel '%s'", opt.kernel);
+        usage();
+        return 2;
+    }
+    if (csv) LOG_INFO("Results appended to %s", opt.out_path);
+    return ok ? 0 : 1;
+}
@@ -1,5 +1,6 @@
 #include "core/common.h"
 #include "core/log.h"
+#include "core/jobs.h"
 #include "core/arena.h"
 #include "platform/window.h"
 #include "platform/input.h"
@@ -31,6 +32,11 @@ int main(void) {
     log_init(LOG_LEVEL_INFO);
 #endif
 
+    /* Worker threads for engine-side parallel work (runs inline on failure) */
+    if (jobs_init(0) != ENGINE_SUCCESS) {
+        LOG_WARN("Failed to start job system — running single-threaded");
+    }
+
     LOG_INFO("Animation Graph Demo starting...");
 
     /* ---- Create window ---- */
@@ -295,6 +301,7 @@ int main(void) {
     if (has_model)  skinned_model_destroy(&model);
     renderer_destroy(renderer);
     window_destroy(window);
+    jobs_shutdown();
 
     LOG_INFO("Animation Graph Demo finished");
     return 0;
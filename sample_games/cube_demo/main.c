@@ -1,5 +1,6 @@
 #include "core/common.h"
 #include "core/log.h"
+#include "core/jobs.h"
 #include "platform/window.h"
 #include "platform/input.h"
 #include "renderer/renderer.h"
@@ -22,6 +23,11 @@ int main(void) {
     log_init(LOG_LEVEL_INFO);
 #endif
 
+    /* Worker threads for engine-side parallel work (runs inline on failure) */
+    if (jobs_init(0) != ENGINE_SUCCESS) {
+        LOG_WARN("Failed to start job system — running single-threaded");
+    }
+
     LOG_INFO("Cube Demo starting...");
 
     /* ---- Create window ---- */
@@ -45,6 +51,7 @@ int main(void) {
         .font_path   = "assets/consolas.ttf",
         .font_size   = 24.0f,
         .clear_color = { 0.05f, 0.05f, 0.08f, 1.0f },
+        .shadow_map_size = 2048,
     };
 
     Renderer *renderer = NULL;
@@ -60,6 +67,14 @@ int main(void) {
     renderer_create_sphere(renderer, 32, 16, &mesh_sphere);
     renderer_create_cylinder(renderer, 24, &mesh_cylinder);
 
+    /* Cascaded shadows out to 30 units, cast onto a floor slab */
+    renderer_set_shadows(renderer, true, 30.0f);
+    InstanceData3D floor_inst = {
+        .position = { 0.0f, -1.5f, 0.0f },
+        .scale    = { 20.0f, 0.1f, 20.0f },
+        .color    = { 0.4f, 0.4f, 0.45f },
+    };
+
     /* ---- Load glTF model ---- */
     MeshHandle mesh_duck;
     bool has_duck = (renderer_load_model(renderer, "assets/duck.glb", &mesh_duck) == ENGINE_SUCCESS);
@@ -132,12 +147,39 @@ int main(void) {
             .color    = { 0.9f, 0.8f, 0.2f }, /* yellow */
         };
 
+        /* ---- Point lights circling the primitives, plus a spot on the duck ---- */
+        PointLight lights[7];
+        static const f32 light_colors[6][3] = {
+            { 1.0f, 0.2f, 0.1f }, { 1.0f, 0.7f, 0.1f }, { 0.2f, 1.0f, 0.3f },
+            { 0.1f, 0.6f, 1.0f }, { 0.6f, 0.2f, 1.0f }, { 1.0f, 0.3f, 0.7f },
+        };
+        for (u32 i = 0; i < 6; i++) {
+            f32 a = total_time * 0.8f + (f32)i * (2.0f * 3.14159265f / 6.0f);
+            lights[i] = (PointLight){
+                .position  = { sinf(a) * 4.5f, 0.6f + 0.4f * sinf(total_time + (f32)i), cosf(a) * 2.5f },
+                .radius    = 4.0f,
+                .color     = { light_colors[i][0], light_colors[i][1], light_colors[i][2] },
+                .intensity = 3.0f,
+            };
+        }
+        lights[6] = (PointLight){
+            .position   = { 4.0f, 4.0f, 0.0f },
+            .radius     = 8.0f,
+            .color      = { 1.0f, 1.0f, 0.9f },
+            .intensity  = 12.0f,
+            .direction  = { 0.0f, -1.0f, 0.0f },
+            .spot_inner = 0.25f,
+            .spot_outer = 0.4f,
+        };
+
         /* ---- Render ---- */
         if (renderer_begin_frame(renderer) != ENGINE_SUCCESS) continue;
 
         renderer_set_camera_3d(renderer, &camera);
         renderer_set_light(renderer, &light);
+        renderer_draw_lights(renderer, lights, (u32)ENGINE_ARRAY_LEN(lights));
 
+        renderer_draw_mesh_3d(renderer, mesh_cube, &floor_inst, 1);
         renderer_draw_mesh_3d(renderer, mesh_cube, &cube_inst, 1);
         renderer_draw_mesh_3d(renderer, mesh_sphere, &sphere_inst, 1);
         renderer_draw_mesh_3d(renderer, mesh_cylinder, &cylinder_inst, 1);
@@ -160,6 +202,7 @@ int main(void) {
     /* ---- Cleanup ---- */
     renderer_destroy(renderer);
     window_destroy(window);
+    jobs_shutdown();
 
     LOG_INFO("Cube Demo finished");
     return 0;
@@ -1,10 +1,12 @@
 #include "core/common.h"
 #include "core/log.h"
+#include "core/jobs.h"
 #include "platform/window.h"
 #include "platform/input.h"
 #include "renderer/renderer.h"
 #include "gameplay/collision.h"
 #include "gameplay/particles.h"
+#include "gameplay/fixed_step.h"
 #include "audio/audio.h"
 
 #define GLFW_INCLUDE_VULKAN
@@ -25,6 +27,7 @@
 #define BULLET_RADIUS  0.15f    /* collision radius for bullets (tiny) */
 #define PLAYER_RADIUS  0.7f     /* collision radius for player ship */
 #define MAX_PARTICLES  1024     /* particle budget for explosions */
+#define SIM_HZ         60.0     /* fixed simulation rate; rendering interpolates */
 
 int main(void) {
     /* ---- Init logging ---- */
@@ -34,6 +37,11 @@ int main(void) {
     log_init(LOG_LEVEL_INFO);
 #endif
 
+    /* Worker threads for engine-side parallel work (runs inline on failure) */
+    if (jobs_init(0) != ENGINE_SUCCESS) {
+        LOG_WARN("Failed to start job system — running single-threaded");
+    }
+
     LOG_INFO("SHMUP starting...");
 
     /* ---- Create window ---- */
@@ -56,7 +64,11 @@ int main(void) {
     RendererConfig render_config = {
         .font_path = "assets/consolas.ttf",
         .font_size = 24.0f,
-        .clear_color = {0, 0, 0, 1}
+        .clear_color = {0, 0, 0, 1},
+        /* Input-to-photon latency: VSync without queueing, and never more
+         * than one frame waiting on the display */
+        .present_mode = PRESENT_MODE_MAILBOX,
+        .present_wait = true,
     };
 
     Renderer *renderer = NULL;
@@ -82,16 +94,17 @@ int main(void) {
             LOG_WARN("Could not load shoot.wav");
         if (audio_load_sound(audio, "assets/explosion.wav", &snd_explosion) != ENGINE_SUCCESS)
             LOG_WARN("Could not load explosion.wav");
-        if (audio_load_sound(audio, "assets/menu_song.wav", &snd_menu_song) != ENGINE_SUCCESS)
-            LOG_WARN("Could not load shoot.wav");
+        if (audio_load_stream(audio, "assets/menu_song.wav", &snd_menu_song) != ENGINE_SUCCESS)
+            LOG_WARN("Could not load menu_song.wav");
     }
 
     if (has_audio) audio_play_sound(audio, snd_menu_song, true, 0.5f);
 
-    // Load main spritesheet
-    TextureHandle texSpriteSheet;
-    renderer_load_texture(renderer, "assets/8bit_shmup_spritesheet.png",
-                          TEXTURE_FILTER_PIXELART, &texSpriteSheet);
+    // Load main spritesheet (atlas-packed sprite; tiles picked via uv_offset/uv_scale)
+    SpriteHandle sprSheet;
+    renderer_load_sprite(renderer, "assets/8bit_shmup_spritesheet.png",
+                         TEXTURE_FILTER_PIXELART, &sprSheet);
+    renderer_build_sprite_atlas(renderer);
 
     // Load some textures:
     TextureHandle  heroTexture;
@@ -243,8 +256,22 @@ int main(void) {
     /* ---- Particle pool ---- */
     Particle particles[MAX_PARTICLES];
     i32 num_particles = 0;
-    InstanceData particle_instances[MAX_PARTICLES];
-    memset(particle_instances, 0, sizeof(particle_instances));
+
+    /* ---- Interpolation state ----
+     * Gameplay runs in fixed SIM_HZ steps; each step first copies the
+     * current state to *_prev, and rendering blends the two. Removals
+     * mirror every swap-remove into the prev arrays so indices keep
+     * matching. */
+    InstanceData player_prev = player;
+    InstanceData enemies_prev[MAX_ENEMIES];
+    InstanceData bullets_prev[MAX_BULLETS];
+    memcpy(enemies_prev, enemies, sizeof(enemies));
+    InstanceData player_draw;
+    InstanceData enemies_draw[MAX_ENEMIES];
+
+    FixedStep sim;
+    fixed_step_init(&sim, SIM_HZ, 0);
+    bool shoot_requested = false;  /* click latched until the next step */
 
     /* ---- Main loop ---- */
     LOG_INFO("Entering main loop");
@@ -254,7 +281,8 @@ int main(void) {
     while (!window_should_close(window)) {
         /* Frame timing */
         f64 current_time = glfwGetTime();
-        f32 delta_time = (f32)(current_time - last_time);
+        f64 frame_seconds = current_time - last_time;
+        f32 delta_time = (f32)frame_seconds;
         last_time = current_time;
 
         input_update();
@@ -264,150 +292,172 @@ int main(void) {
         if (input_key_pressed(GLFW_KEY_ESCAPE)) {
             break;
         }
-
-        // Player input
-        if (input_key_down(GLFW_KEY_A)) {
-            player.position[0] -= SHIP_SPEED * delta_time;
-        }
-        if (input_key_down(GLFW_KEY_D)) {
-            player.position[0] += SHIP_SPEED * delta_time;
-        }
-        if (input_key_down(GLFW_KEY_W)) {
-            player.position[1] += SHIP_SPEED * delta_time;
-        }
-        if (input_key_down(GLFW_KEY_S)) {
-            player.position[1] -= SHIP_SPEED * delta_time;
-        }
-        /* Shoot on left click */
-        if (input_mouse_pressed(GLFW_MOUSE_BUTTON_LEFT) && num_bullets < MAX_BULLETS) {
-            InstanceData *b = &bullets[num_bullets++];
-            /* Spawn at the tip of the player triangle (top of the scaled mesh) */
-            b->position[0] = player.position[0];
-            b->position[1] = player.position[1] + player.scale[1] * 0.5f;
-            b->rotation    = 0.0f;
-            b->scale[0]    = 0.15f;  /* narrow */
-            b->scale[1]    = 0.6f;   /* elongated */
-            b->color[0]    = 2.5f;   /* bright yellow-white HDR glow */
-            b->color[1]    = 2.0f;
-            b->color[2]    = 0.5f;
-            if (has_audio) audio_play_sound(audio, snd_shoot, false, 0.5f);
+        if (input_mouse_pressed(GLFW_MOUSE_BUTTON_LEFT)) {
+            shoot_requested = true;
         }
 
-        /* Move bullets upward, remove ones that go off screen */
-        for (int i = 0; i < num_bullets; ) {
-            bullets[i].position[1] += BULLET_SPEED * delta_time;
-            /* Remove if way above visible area (half_height/zoom ≈ 15) */
-            if (bullets[i].position[1] > 20.0f) {
-                bullets[i] = bullets[--num_bullets]; /* swap-remove */
-            } else {
-                i++;
-            }
+        /* Handle resize */
+        if (window_was_resized(window)) {
+            window_reset_resized(window);
+            renderer_handle_resize(renderer);
         }
 
-        /* ---- Collision: bullets vs enemies ---- */
-        {
-            i32 num_hits = collision_instances_vs_instances(
-                bullets, num_bullets, BULLET_RADIUS,
-                enemies, num_enemies, ENEMY_RADIUS,
-                hit_pairs, MAX_HIT_PAIRS);
-
-            /* Mark hit bullets and enemies for removal (flag with NaN position) */
-            bool bullet_dead[MAX_BULLETS] = {false};
-            bool enemy_dead[MAX_ENEMIES]  = {false};
-            for (i32 h = 0; h < num_hits; h++) {
-                bullet_dead[hit_pairs[h].index_a] = true;
-                enemy_dead[hit_pairs[h].index_b]  = true;
-                score += 100;
+        /* ---- Simulation (fixed steps) ---- */
+        u32 steps = fixed_step_advance(&sim, frame_seconds);
+        for (u32 step = 0; step < steps; step++) {
+            const f32 dt = (f32)sim.step;
+            player_prev = player;
+            memcpy(enemies_prev, enemies, sizeof(InstanceData) * (size_t)num_enemies);
+            memcpy(bullets_prev, bullets, sizeof(InstanceData) * (size_t)num_bullets);
+
+            // Player input
+            if (input_key_down(GLFW_KEY_A)) {
+                player.position[0] -= SHIP_SPEED * dt;
             }
-
-            /* Spawn explosions at dead enemies, then swap-remove them */
-            for (int i = num_enemies - 1; i >= 0; i--) {
-                if (enemy_dead[i]) {
-                    ParticleEmitter explosion = {
-                        .position = { enemies[i].position[0], enemies[i].position[1] },
-                        .color    = { enemies[i].color[0] * 6.0f, enemies[i].color[1] * 6.0f, enemies[i].color[2] * 6.0f },
-                        .count              = 24,
-                        .speed_min          = 3.0f,
-                        .speed_max          = 10.0f,
-                        .lifetime_min       = 0.3f,
-                        .lifetime_max       = 0.8f,
-                        .scale              = 0.4f,
-                        .angular_velocity_min = -5.0f,
-                        .angular_velocity_max =  5.0f,
-                    };
-                    i32 emitted = particles_emit(&explosion, particles, num_particles, MAX_PARTICLES);
-                    num_particles += emitted;
-
-                    if (has_audio) audio_play_sound(audio, snd_explosion, false, 0.7f);
-
-                    enemies[i] = enemies[--num_enemies];
+            if (input_key_down(GLFW_KEY_D)) {
+                player.position[0] += SHIP_SPEED * dt;
+            }
+            if (input_key_down(GLFW_KEY_W)) {
+                player.position[1] += SHIP_SPEED * dt;
+            }
+            if (input_key_down(GLFW_KEY_S)) {
+                player.position[1] -= SHIP_SPEED * dt;
+            }
+            /* Shoot on left click */
+            if (shoot_requested && num_bullets < MAX_BULLETS) {
+                InstanceData *b = &bullets[num_bullets++];
+                /* Spawn at the tip of the player triangle (top of the scaled mesh) */
+                b->position[0] = player.position[0];
+                b->position[1] = player.position[1] + player.scale[1] * 0.5f;
+                b->rotation    = 0.0f;
+                b->scale[0]    = 0.15f;  /* narrow */
+                b->scale[1]    = 0.6f;   /* elongated */
+                b->color[0]    = 2.5f;   /* bright yellow-white HDR glow */
+                b->color[1]    = 2.0f;
+                b->color[2]    = 0.5f;
+                bullets_prev[num_bullets - 1] = *b;  /* no motion to blend from */
+                if (has_audio) audio_play_sound(audio, snd_shoot, false, 0.5f);
+            }
+            shoot_requested = false;
+
+            /* Move bullets upward, remove ones that go off screen */
+            for (int i = 0; i < num_bullets; ) {
+                bullets[i].position[1] += BULLET_SPEED * dt;
+                /* Remove if way above visible area (half_height/zoom ≈ 15) */
+                if (bullets[i].position[1] > 20.0f) {
+                    bullets_prev[i] = bullets_prev[num_bullets - 1];
+                    bullets[i] = bullets[--num_bullets]; /* swap-remove */
+                } else {
+                    i++;
                 }
             }
 
-            /* Swap-remove dead bullets */
-            for (int i = num_bullets - 1; i >= 0; i--) {
-                if (bullet_dead[i]) {
-                    bullets[i] = bullets[--num_bullets];
+            /* ---- Collision: bullets vs enemies ---- */
+            {
+                i32 num_hits = collision_instances_vs_instances(
+                    bullets, num_bullets, BULLET_RADIUS,
+                    enemies, num_enemies, ENEMY_RADIUS,
+                    hit_pairs, MAX_HIT_PAIRS);
+
+                /* Mark hit bullets and enemies for removal (flag with NaN position) */
+                bool bullet_dead[MAX_BULLETS] = {false};
+                bool enemy_dead[MAX_ENEMIES]  = {false};
+                for (i32 h = 0; h < num_hits; h++) {
+                    bullet_dead[hit_pairs[h].index_a] = true;
+                    enemy_dead[hit_pairs[h].index_b]  = true;
+                    score += 100;
+                }
+
+                /* Spawn explosions at dead enemies, then swap-remove them */
+                for (int i = num_enemies - 1; i >= 0; i--) {
+                    if (enemy_dead[i]) {
+                        ParticleEmitter explosion = {
+                            .position = { enemies[i].position[0], enemies[i].position[1] },
+                            .color    = { enemies[i].color[0] * 6.0f, enemies[i].color[1] * 6.0f, enemies[i].color[2] * 6.0f },
+                            .count              = 24,
+                            .speed_min          = 3.0f,
+                            .speed_max          = 10.0f,
+                            .lifetime_min       = 0.3f,
+                            .lifetime_max       = 0.8f,
+                            .scale              = 0.4f,
+                            .angular_velocity_min = -5.0f,
+                            .angular_velocity_max =  5.0f,
+                        };
+                        i32 emitted = particles_emit(&explosion, particles, num_particles, MAX_PARTICLES);
+                        num_particles += emitted;
+
+                        if (has_audio) audio_play_sound(audio, snd_explosion, false, 0.7f);
+
+                        enemies_prev[i] = enemies_prev[num_enemies - 1];
+                        enemies[i] = enemies[--num_enemies];
+                    }
+                }
+
+                /* Swap-remove dead bullets */
+                for (int i = num_bullets - 1; i >= 0; i--) {
+                    if (bullet_dead[i]) {
+                        bullets_prev[i] = bullets_prev[num_bullets - 1];
+                        bullets[i] = bullets[--num_bullets];
+                    }
                 }
             }
-        }
 
-        /* ---- Collision: enemies vs player ---- */
-        if (!player_hit) {
-            i32 hit_idx = collision_circle_vs_instances(
-                player.position[0], player.position[1], PLAYER_RADIUS,
-                enemies, num_enemies, ENEMY_RADIUS);
+            /* ---- Collision: enemies vs player ---- */
+            if (!player_hit) {
+                i32 hit_idx = collision_circle_vs_instances(
+                    player.position[0], player.position[1], PLAYER_RADIUS,
+                    enemies, num_enemies, ENEMY_RADIUS);
 
-            if (hit_idx >= 0) {
-                player_hit = true;
-                hit_flash_timer = 0.5f; /* flash for 0.5 seconds */
-                LOG_INFO("Player hit by enemy %d!", hit_idx);
+                if (hit_idx >= 0) {
+                    player_hit = true;
+                    hit_flash_timer = 0.5f; /* flash for 0.5 seconds */
+                    LOG_INFO("Player hit by enemy %d!", hit_idx);
+                }
             }
-        }
 
-        /* Flash timer countdown */
-        if (hit_flash_timer > 0.0f) {
-            hit_flash_timer -= delta_time;
-            if (hit_flash_timer <= 0.0f) {
-                hit_flash_timer = 0.0f;
-                player_hit = false;
-                /* Restore player color */
-                player.color[0] = 1.0f;
-                player.color[1] = 1.0f;
-                player.color[2] = 1.0f;
-            } else {
-                /* Flash red/white */
-                f32 flash = (hit_flash_timer * 10.0f);
-                int blink = (int)flash % 2;
-                player.color[0] = blink ? 3.0f : 0.5f;
-                player.color[1] = blink ? 0.3f : 0.5f;
-                player.color[2] = blink ? 0.3f : 0.5f;
+            /* Flash timer countdown */
+            if (hit_flash_timer > 0.0f) {
+                hit_flash_timer -= dt;
+                if (hit_flash_timer <= 0.0f) {
+                    hit_flash_timer = 0.0f;
+                    player_hit = false;
+                    /* Restore player color */
+                    player.color[0] = 1.0f;
+                    player.color[1] = 1.0f;
+                    player.color[2] = 1.0f;
+                } else {
+                    /* Flash red/white */
+                    f32 flash = (hit_flash_timer * 10.0f);
+                    int blink = (int)flash % 2;
+                    player.color[0] = blink ? 3.0f : 0.5f;
+                    player.color[1] = blink ? 0.3f : 0.5f;
+                    player.color[2] = blink ? 0.3f : 0.5f;
+                }
             }
-        }
 
-        /* Update particles */
-        num_particles = particles_update(particles, num_particles, delta_time);
+            /* Update particles */
+            num_particles = particles_update(particles, num_particles, dt);
 
-        /* Handle resize */
-        if (window_was_resized(window)) {
-            window_reset_resized(window);
-            renderer_handle_resize(renderer);
-        }
+            /* Spin enemies */
+            for (int i = 0; i < num_enemies; i++) {
+                enemies[i].rotation += 1.5f * dt; /* ~90 deg/sec */
+            }
 
-        /* Spin enemies */
-        for (int i = 0; i < num_enemies; i++) {
-            enemies[i].rotation += 1.5f * delta_time; /* ~90 deg/sec */
+            /* Record player position into trail ring buffer (time-gated) */
+            trail_timer += dt;
+            while (trail_timer >= trail_interval) {
+                trail_timer -= trail_interval;
+                trail_pos[trail_head][0] = player.position[0];
+                trail_pos[trail_head][1] = player.position[1];
+                trail_head = (trail_head + 1) % TRAIL_LENGTH;
+                if (trail_count < TRAIL_LENGTH) trail_count++;
+            }
         }
 
-        /* Record player position into trail ring buffer (time-gated) */
-        trail_timer += delta_time;
-        while (trail_timer >= trail_interval) {
-            trail_timer -= trail_interval;
-            trail_pos[trail_head][0] = player.position[0];
-            trail_pos[trail_head][1] = player.position[1];
-            trail_head = (trail_head + 1) % TRAIL_LENGTH;
-            if (trail_count < TRAIL_LENGTH) trail_count++;
-        }
+        /* ---- Interpolated render state ---- */
+        f32 alpha = fixed_step_alpha(&sim);
+        fixed_step_lerp_instances(&player_draw, &player_prev, &player, 1, alpha);
+        fixed_step_lerp_instances(enemies_draw, enemies_prev, enemies, (u32)num_enemies, alpha);
 
         /* Build ghost trail instances — oldest first, fading out */
         int trail_draw_count = 0;
@@ -442,26 +492,34 @@ int main(void) {
            // renderer_draw_mesh(renderer, mesh_quad, trail_instances, (u32)trail_draw_count);
         }
         if (num_enemies > 0) {
-            renderer_draw_mesh_textured(renderer, mesh_quad, texSpriteSheet, enemies, (u32)num_enemies);
+            renderer_draw_sprites(renderer, sprSheet, enemies_draw, (u32)num_enemies);
         }
-        renderer_draw_mesh_textured(renderer, mesh_quad, texSpriteSheet, &player, 1);
+        renderer_draw_sprites(renderer, sprSheet, &player_draw, 1);
+        renderer_flush_sprites(renderer);  /* bullets and particles draw on top */
 
+        /* Bullets, interpolated straight into the instance buffer */
         if (num_bullets > 0) {
-            renderer_draw_mesh(renderer, mesh_bullet, bullets, (u32)num_bullets);
+            InstanceData *bullet_instances =
+                renderer_alloc_instances(renderer, mesh_bullet, (u32)num_bullets);
+            if (bullet_instances) {
+                fixed_step_lerp_instances(bullet_instances, bullets_prev, bullets,
+                                          (u32)num_bullets, alpha);
+            }
         }
 
-        /* Particles (explosions) */
+        /* Particles (explosions), converted straight into the instance buffer */
         if (num_particles > 0) {
-            i32 num_p_inst = particles_to_instances(particles, num_particles,
-                                                    particle_instances, MAX_PARTICLES);
-            if (num_p_inst > 0) {
-                renderer_draw_mesh(renderer, mesh_quad, particle_instances, (u32)num_p_inst);
+            InstanceData *particle_instances =
+                renderer_alloc_instances(renderer, mesh_quad, (u32)num_particles);
+            if (particle_instances) {
+                particles_to_instances(particles, num_particles,
+                                       particle_instances, num_particles);
             }
         }
 
-        /* Title text */
-        renderer_draw_text(renderer, "SCORE", 10.0f, 10.0f, 1.0f,
-                           1.0f, 1.0f, 1.0f);
+        /* Title text (static labels and the score go through the text cache) */
+        renderer_draw_text_cached(renderer, "SCORE", 10.0f, 10.0f, 1.0f,
+                                  1.0f, 1.0f, 1.0f);
 
         // Render score
         {
@@ -478,11 +536,11 @@ int main(void) {
             f32 ft_x = (f32)300.0f;
             f32 ft_y = 10.0f;
 
-            renderer_draw_text(renderer, ft_buf, ft_x, ft_y, 1.0f,
-                               1.0f, 1.0f, 1.0f);
+            renderer_draw_text_cached(renderer, ft_buf, ft_x, ft_y, 1.0f,
+                                      1.0f, 1.0f, 1.0f);
         }
-        renderer_draw_text(renderer, "Press ESC to quit", 10.0f, 40.0f, 1.0f,
-                           0.7f, 0.7f, 0.7f);
+        renderer_draw_text_cached(renderer, "Press ESC to quit", 10.0f, 40.0f, 1.0f,
+                                  0.7f, 0.7f, 0.7f);
 
         /* Frametime display (11px, top-right corner) */
         {
@@ -512,6 +570,7 @@ int main(void) {
     if (has_audio) audio_shutdown(audio);
     renderer_destroy(renderer);
     window_destroy(window);
+    jobs_shutdown();
 
     LOG_INFO("Goodbye!");
     return 0;
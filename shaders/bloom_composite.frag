@@ -1,6 +1,7 @@
 #version 450
 
-/* Bloom composite — combines scene with bloom, then applies:
+/* Bloom composite — combines scene with bloom (upscaling the render-scaled
+ * scene to the swapchain), then applies:
  *   1. Additive bloom
  *   2. Reinhard tonemapping
  *   3. Scanlines
@@ -19,8 +20,17 @@ layout(push_constant) uniform PushConstants {
     float scanline_count;     /* lines across screen height */
     float aberration;         /* chromatic offset in pixels */
     vec2  screen_size;        /* width, height in pixels */
+    vec2  scene_uv_scale;     /* live fraction of scene_tex (render scale) */
+    vec2  scene_uv_max;       /* last live scene texel centre */
+    vec2  bloom_uv_max;       /* last live bloom texel centre */
 } pc;
 
+/* Screen UV -> scene-image UV, clamped so bilinear taps never reach the
+ * stale texels outside the live region */
+vec3 scene_at(vec2 uv) {
+    return texture(scene_tex, min(uv * pc.scene_uv_scale, pc.scene_uv_max)).rgb;
+}
+
 /* Reinhard tone mapping */
 vec3 tonemap(vec3 color) {
     return color / (color + vec3(1.0));
@@ -35,13 +45,13 @@ void main() {
     vec2 dir = center_offset / (dist + 0.0001);
     vec2 aberration_offset = dir * pc.aberration / pc.screen_size;
 
-    float r = texture(scene_tex, uv + aberration_offset).r;
-    float g = texture(scene_tex, uv).g;
-    float b = texture(scene_tex, uv - aberration_offset).b;
+    float r = scene_at(uv + aberration_offset).r;
+    float g = scene_at(uv).g;
+    float b = scene_at(uv - aberration_offset).b;
     vec3 scene_color = vec3(r, g, b);
 
     /* --- Additive bloom --- */
-    vec3 bloom_color = texture(bloom_tex, uv).rgb;
+    vec3 bloom_color = texture(bloom_tex, min(uv * pc.scene_uv_scale, pc.bloom_uv_max)).rgb;
     vec3 color = scene_color + bloom_color * pc.intensity;
 
     /* --- Reinhard tonemap (HDR -> LDR) --- */
@@ -7,28 +7,140 @@ layout(location = 3) in vec3 frag_pos_world;
 
 layout(location = 0) out vec4 out_color;
 
-layout(set = 0, binding = 0) uniform sampler2D tex;
+/* Bindless texture table (set 0); slot 0 is the dummy texture. The array size
+ * is specialized to the device's descriptor limit at pipeline creation. */
+layout(constant_id = 1) const uint TEXTURE_SLOTS = 1;
+layout(set = 0, binding = 0) uniform sampler2D textures[TEXTURE_SLOTS];
 
 layout(push_constant) uniform PushConstants {
     mat4 vp;
-    uint use_texture;
+    uint texture_index;   /* 0 = untextured */
 } pc;
 
-/* Directional light (set 1, binding 0) */
+/* Directional light and its shadow cascades (set 1, binding 0); mirrors
+ * LightUniforms in vk_types.h */
+#define SHADOW_CASCADES 4
 layout(set = 1, binding = 0) uniform LightUBO {
     vec4 light_dir;    /* xyz = direction (normalized, FROM light), w = unused */
     vec4 light_color;  /* xyz = color, w = unused */
     vec4 ambient;      /* xyz = ambient color, w = unused */
     vec4 view_pos;     /* xyz = camera position, w = unused */
     vec4 shininess;    /* x = specular exponent, yzw = unused */
+    mat4 cascade_vp[SHADOW_CASCADES];
+    vec4 cascade_splits;  /* far view depth of each cascade */
+    vec4 cascade_texel;   /* world size of one shadow texel per cascade */
+    vec4 view_dir;        /* xyz = camera forward */
+    vec4 shadow_params;   /* x = shadows on, y = 1 / map size */
+    mat4 cluster_vp;      /* camera view-projection the lights were binned in */
+    vec4 cluster_params;  /* x = near plane, y = slices / ln(far / near), z = lights on */
 } light;
 
+/* Cascaded shadow map, one layer per cascade (set 1, binding 1) */
+layout(set = 1, binding = 1) uniform sampler2DArrayShadow shadow_map;
+
+/* Point and spot lights (set 1, binding 2) and the froxel grid they were
+ * binned into (binding 3): per cluster a count, then up to MAX_LIGHTS light
+ * indices. Mirrors GpuLight and LIGHT_CLUSTER_* in vk_types.h. */
+#define CLUSTER_X  16
+#define CLUSTER_Y  9
+#define CLUSTER_Z  24
+#define MAX_LIGHTS 63
+
+struct Light {
+    vec4 position_radius;
+    vec4 color_spot_scale;       /* rgb premultiplied by intensity */
+    vec4 direction_spot_offset;  /* cone = saturate(cos * scale + offset) */
+};
+
+layout(std430, set = 1, binding = 2) readonly buffer LightBuffer {
+    Light lights[];
+};
+
+layout(std430, set = 1, binding = 3) readonly buffer ClusterBuffer {
+    uint clusters[];
+};
+
+/* Fraction of the light reaching the fragment: 3x3 taps of hardware 2x2 PCF
+ * in the cascade its view depth falls in. The position is pushed along the
+ * normal by about a texel, more at grazing angles, against acne. */
+float shadow_factor(vec3 N, vec3 L) {
+    if (light.shadow_params.x == 0.0)
+        return 1.0;
+
+    float depth = dot(frag_pos_world - light.view_pos.xyz, light.view_dir.xyz);
+    int cascade = 0;
+    while (cascade < SHADOW_CASCADES - 1 && depth > light.cascade_splits[cascade])
+        cascade++;
+    if (depth > light.cascade_splits[SHADOW_CASCADES - 1])
+        return 1.0;
+
+    float n_dot_l = clamp(dot(N, L), 0.0, 1.0);
+    vec3 pos = frag_pos_world + N * light.cascade_texel[cascade] * (1.5 - n_dot_l);
+
+    vec4 clip = light.cascade_vp[cascade] * vec4(pos, 1.0);
+    vec3 ndc = clip.xyz / clip.w;
+    vec2 uv = ndc.xy * 0.5 + 0.5;
+
+    float texel = light.shadow_params.y;
+    float lit = 0.0;
+    for (int y = -1; y <= 1; y++) {
+        for (int x = -1; x <= 1; x++) {
+            lit += texture(shadow_map, vec4(uv + vec2(x, y) * texel, float(cascade), ndc.z));
+        }
+    }
+    return lit / 9.0;
+}
+
+/* Diffuse + specular of the lights binned into this fragment's cluster. The
+ * cluster is found the same way light_cluster.comp built it: screen tile from
+ * the binning camera's NDC, slice from the log of the view depth (clip w). */
+vec3 local_lights(vec3 N, vec3 V, vec3 base_color) {
+    if (light.cluster_params.z == 0.0)
+        return vec3(0.0);
+
+    vec4 clip = light.cluster_vp * vec4(frag_pos_world, 1.0);
+    if (clip.w <= 0.0)
+        return vec3(0.0);
+
+    vec2 tile = clamp((clip.xy / clip.w * 0.5 + 0.5) * vec2(CLUSTER_X, CLUSTER_Y),
+                      vec2(0.0), vec2(CLUSTER_X - 1, CLUSTER_Y - 1));
+    int slice = clamp(int(log(clip.w / light.cluster_params.x) * light.cluster_params.y),
+                      0, CLUSTER_Z - 1);
+    uint cluster = (uint(slice) * uint(CLUSTER_Y) + uint(tile.y)) * uint(CLUSTER_X) + uint(tile.x);
+    uint base = cluster * uint(MAX_LIGHTS + 1);
+
+    vec3 sum = vec3(0.0);
+    uint count = clusters[base];
+    for (uint i = 0u; i < count; i++) {
+        Light l = lights[clusters[base + 1u + i]];
+        vec3 to_light = l.position_radius.xyz - frag_pos_world;
+        float dist2 = dot(to_light, to_light);
+        float r2 = l.position_radius.w * l.position_radius.w;
+        if (dist2 >= r2)
+            continue;
+
+        /* Inverse square, windowed to reach zero at the radius */
+        vec3 L = to_light * inversesqrt(max(dist2, 1e-8));
+        float window = clamp(1.0 - (dist2 * dist2) / (r2 * r2), 0.0, 1.0);
+        float atten = window * window / (dist2 + 1.0);
+
+        float cone = clamp(dot(-L, l.direction_spot_offset.xyz) * l.color_spot_scale.w +
+                           l.direction_spot_offset.w, 0.0, 1.0);
+        atten *= cone * cone;
+
+        float diff = max(dot(N, L), 0.0);
+        float spec = pow(max(dot(V, reflect(-L, N)), 0.0), light.shininess.x);
+        sum += (diff * base_color + spec) * l.color_spot_scale.xyz * atten;
+    }
+    return sum;
+}
+
 void main() {
     vec3 base_color = frag_color;
     float alpha = 1.0;
 
-    if (pc.use_texture != 0u) {
-        vec4 tex_sample = texture(tex, frag_uv);
+    if (pc.texture_index != 0u) {
+        vec4 tex_sample = texture(textures[pc.texture_index], frag_uv);
         base_color *= tex_sample.rgb;
         alpha = tex_sample.a;
     }
@@ -56,6 +168,7 @@ void main() {
     float spec = pow(max(dot(V, R), 0.0), light.shininess.x);
     vec3 specular = spec * light.light_color.xyz;
 
-    vec3 result = ambient + diffuse + specular;
+    vec3 result = ambient + shadow_factor(N, L) * (diffuse + specular) +
+                  local_lights(N, V, base_color);
     out_color = vec4(result, alpha);
 }
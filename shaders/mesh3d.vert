@@ -6,16 +6,19 @@ layout(location = 1) in vec3 in_normal;
 layout(location = 2) in vec2 in_uv;
 layout(location = 3) in vec3 in_color;
 
-/* Per-instance (binding 1) */
-layout(location = 4) in vec3 inst_position;
-layout(location = 5) in vec3 inst_rotation;  /* pitch, yaw, roll (radians) */
-layout(location = 6) in vec3 inst_scale;
-layout(location = 7) in vec3 inst_color;
+/* Per-instance (binding 1), laid out per INSTANCE_FORMAT:
+ *   EULER:  position, rotation (pitch, yaw, roll radians), scale, color
+ *   QUAT:   position, quaternion, (scale.xyz, color.r), color.gb
+ *   MATRIX: model row 0, row 1, row 2, color */
+layout(location = 4) in vec4 inst_0;
+layout(location = 5) in vec4 inst_1;
+layout(location = 6) in vec4 inst_2;
+layout(location = 7) in vec4 inst_3;
 
 /* View-projection matrix + texture flag */
 layout(push_constant) uniform PushConstants {
     mat4 vp;
-    uint use_texture;
+    uint texture_index;
 } pc;
 
 layout(location = 0) out vec3 frag_color;
@@ -23,17 +26,63 @@ layout(location = 1) out vec2 frag_uv;
 layout(location = 2) out vec3 frag_normal_world;
 layout(location = 3) out vec3 frag_pos_world;
 
-void main() {
-    /* Build rotation matrix from Euler angles: R = Ry * Rx * Rz */
-    float cp = cos(inst_rotation.x); float sp = sin(inst_rotation.x); /* pitch (X) */
-    float cy = cos(inst_rotation.y); float sy = sin(inst_rotation.y); /* yaw   (Y) */
-    float cr = cos(inst_rotation.z); float sr = sin(inst_rotation.z); /* roll  (Z) */
+/* Packed vertex formats (PackedVertex3D): in_normal.xy holds an octahedral
+ * encoded normal; uv/color arrive already widened by the fetch formats */
+layout(constant_id = 0) const bool PACKED_VERTICES = false;
+
+/* InstanceFormat3D: 0 = InstanceData3D, 1 = PackedInstanceData3D,
+ * 2 = MatrixInstanceData3D. The unused branches fold away. */
+layout(constant_id = 2) const uint INSTANCE_FORMAT = 0u;
+
+vec3 oct_decode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
 
-    mat3 rot = mat3(
+/* Instance rotation and scale; the translation goes to out_position */
+mat3 instance_basis(out vec3 out_scale, out vec3 out_position, out vec3 out_color) {
+    if (INSTANCE_FORMAT == 2u) {
+        /* Precomputed rows: rotation * scale is already baked in */
+        out_scale    = vec3(1.0);
+        out_position = vec3(inst_0.w, inst_1.w, inst_2.w);
+        out_color    = inst_3.rgb;
+        return transpose(mat3(inst_0.xyz, inst_1.xyz, inst_2.xyz));
+    }
+    if (INSTANCE_FORMAT == 1u) {
+        vec4 q = normalize(inst_1);
+        vec3 q2 = q.xyz * 2.0;
+        float xx = q.x * q2.x, yy = q.y * q2.y, zz = q.z * q2.z;
+        float xy = q.x * q2.y, xz = q.x * q2.z, yz = q.y * q2.z;
+        float wx = q.w * q2.x, wy = q.w * q2.y, wz = q.w * q2.z;
+        out_scale    = inst_2.xyz;
+        out_position = inst_0.xyz;
+        out_color    = vec3(inst_2.w, inst_3.xy);
+        return mat3(
+            vec3(1.0 - (yy + zz), xy + wz,         xz - wy),
+            vec3(xy - wz,         1.0 - (xx + zz), yz + wx),
+            vec3(xz + wy,         yz - wx,         1.0 - (xx + yy))
+        );
+    }
+
+    /* Build rotation matrix from Euler angles: R = Ry * Rx * Rz */
+    float cp = cos(inst_1.x); float sp = sin(inst_1.x); /* pitch (X) */
+    float cy = cos(inst_1.y); float sy = sin(inst_1.y); /* yaw   (Y) */
+    float cr = cos(inst_1.z); float sr = sin(inst_1.z); /* roll  (Z) */
+    out_scale    = inst_2.xyz;
+    out_position = inst_0.xyz;
+    out_color    = inst_3.rgb;
+    return mat3(
         vec3( cy*cr + sy*sp*sr,   cp*sr,  -sy*cr + cy*sp*sr),
         vec3(-cy*sr + sy*sp*cr,   cp*cr,   sy*sr + cy*sp*cr),
         vec3( sy*cp,             -sp,      cy*cp            )
     );
+}
+
+void main() {
+    vec3 inst_scale, inst_position, inst_color;
+    mat3 rot = instance_basis(inst_scale, inst_position, inst_color);
 
     /* Scale, rotate, translate */
     vec3 scaled   = in_position * inst_scale;
@@ -43,7 +92,8 @@ void main() {
     gl_Position = pc.vp * vec4(world_pos, 1.0);
 
     /* Transform normal (rotation only — correct for uniform scale) */
-    frag_normal_world = normalize(rot * in_normal);
+    vec3 normal = PACKED_VERTICES ? oct_decode(in_normal.xy) : in_normal;
+    frag_normal_world = normalize(rot * normal);
     frag_pos_world    = world_pos;
 
     /* Color tinting */
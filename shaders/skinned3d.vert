@@ -8,23 +8,31 @@ layout(location = 3) in vec3 in_color;
 layout(location = 4) in uvec4 in_joints;
 layout(location = 5) in vec4 in_weights;
 
-/* Per-instance (binding 1) — InstanceData3D (reused from non-skinned) */
-layout(location = 6) in vec3 inst_position;
-layout(location = 7) in vec3 inst_rotation;  /* pitch, yaw, roll (radians) */
-layout(location = 8) in vec3 inst_scale;
-layout(location = 9) in vec3 inst_color;
+/* Per-instance (binding 1) — same INSTANCE_FORMAT layouts as mesh3d.vert */
+layout(location = 6) in vec4 inst_0;
+layout(location = 7) in vec4 inst_1;
+layout(location = 8) in vec4 inst_2;
+layout(location = 9) in vec4 inst_3;
 
 /* Push constants */
 layout(push_constant) uniform PushConstants {
     mat4 vp;
-    uint use_texture;
+    uint texture_index;
     uint joint_offset;   /* byte offset into SSBO for this draw's joint matrices */
-    uint joint_count;    /* number of joints */
+    uint joint_count;    /* joints per instance palette */
+    uint first_instance; /* firstInstance of the draw (palettes are per instance) */
 } pc;
 
-/* Joint matrices SSBO (set 2, binding 0) */
+/* Joint matrices SSBO (set 2, binding 0) — 3x4 affine rows, 48 bytes each.
+ * The last row is implicitly (0, 0, 0, 1). */
+struct JointAffine {
+    vec4 row0;
+    vec4 row1;
+    vec4 row2;
+};
+
 layout(std430, set = 2, binding = 0) readonly buffer JointBuffer {
-    mat4 joint_matrices[];
+    JointAffine joint_matrices[];
 } joints;
 
 layout(location = 0) out vec3 frag_color;
@@ -32,32 +40,86 @@ layout(location = 1) out vec2 frag_uv;
 layout(location = 2) out vec3 frag_normal_world;
 layout(location = 3) out vec3 frag_pos_world;
 
-void main() {
-    /* ---- Skeletal skinning ---- */
-    /* joint_offset is in bytes; divide by sizeof(mat4)=64 to get matrix index */
-    uint base = pc.joint_offset / 64u;
+/* Packed vertex formats (PackedSkinnedVertex3D): in_normal.xy holds an octahedral
+ * encoded normal; uv, color, joints and weights arrive already widened by
+ * the fetch formats */
+layout(constant_id = 0) const bool PACKED_VERTICES = false;
 
-    mat4 skin_mat =
-        in_weights.x * joints.joint_matrices[base + in_joints.x] +
-        in_weights.y * joints.joint_matrices[base + in_joints.y] +
-        in_weights.z * joints.joint_matrices[base + in_joints.z] +
-        in_weights.w * joints.joint_matrices[base + in_joints.w];
+/* InstanceFormat3D, as mesh3d.vert */
+layout(constant_id = 2) const uint INSTANCE_FORMAT = 0u;
 
-    vec4 skinned_pos    = skin_mat * vec4(in_position, 1.0);
-    vec3 skinned_normal = mat3(skin_mat) * in_normal;
+vec3 oct_decode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
 
-    /* ---- Instance transform (same as mesh3d.vert) ---- */
-    float cp = cos(inst_rotation.x); float sp = sin(inst_rotation.x); /* pitch (X) */
-    float cy = cos(inst_rotation.y); float sy = sin(inst_rotation.y); /* yaw   (Y) */
-    float cr = cos(inst_rotation.z); float sr = sin(inst_rotation.z); /* roll  (Z) */
+/* Instance rotation and scale; the translation goes to out_position */
+mat3 instance_basis(out vec3 out_scale, out vec3 out_position, out vec3 out_color) {
+    if (INSTANCE_FORMAT == 2u) {
+        /* Precomputed rows: rotation * scale is already baked in */
+        out_scale    = vec3(1.0);
+        out_position = vec3(inst_0.w, inst_1.w, inst_2.w);
+        out_color    = inst_3.rgb;
+        return transpose(mat3(inst_0.xyz, inst_1.xyz, inst_2.xyz));
+    }
+    if (INSTANCE_FORMAT == 1u) {
+        vec4 q = normalize(inst_1);
+        vec3 q2 = q.xyz * 2.0;
+        float xx = q.x * q2.x, yy = q.y * q2.y, zz = q.z * q2.z;
+        float xy = q.x * q2.y, xz = q.x * q2.z, yz = q.y * q2.z;
+        float wx = q.w * q2.x, wy = q.w * q2.y, wz = q.w * q2.z;
+        out_scale    = inst_2.xyz;
+        out_position = inst_0.xyz;
+        out_color    = vec3(inst_2.w, inst_3.xy);
+        return mat3(
+            vec3(1.0 - (yy + zz), xy + wz,         xz - wy),
+            vec3(xy - wz,         1.0 - (xx + zz), yz + wx),
+            vec3(xz + wy,         yz - wx,         1.0 - (xx + yy))
+        );
+    }
 
-    mat3 rot = mat3(
+    /* Build rotation matrix from Euler angles: R = Ry * Rx * Rz */
+    float cp = cos(inst_1.x); float sp = sin(inst_1.x); /* pitch (X) */
+    float cy = cos(inst_1.y); float sy = sin(inst_1.y); /* yaw   (Y) */
+    float cr = cos(inst_1.z); float sr = sin(inst_1.z); /* roll  (Z) */
+    out_scale    = inst_2.xyz;
+    out_position = inst_0.xyz;
+    out_color    = inst_3.rgb;
+    return mat3(
         vec3( cy*cr + sy*sp*sr,   cp*sr,  -sy*cr + cy*sp*sr),
         vec3(-cy*sr + sy*sp*cr,   cp*cr,   sy*sr + cy*sp*cr),
         vec3( sy*cp,             -sp,      cy*cp            )
     );
+}
+
+void main() {
+    /* ---- Skeletal skinning ---- */
+    /* joint_offset is in bytes; divide by sizeof(JointAffine)=48 to get matrix index.
+     * Instanced draws store one palette per instance, back to back. */
+    uint base = pc.joint_offset / 48u +
+                (uint(gl_InstanceIndex) - pc.first_instance) * pc.joint_count;
+
+    JointAffine j0 = joints.joint_matrices[base + in_joints.x];
+    JointAffine j1 = joints.joint_matrices[base + in_joints.y];
+    JointAffine j2 = joints.joint_matrices[base + in_joints.z];
+    JointAffine j3 = joints.joint_matrices[base + in_joints.w];
+
+    vec4 r0 = in_weights.x * j0.row0 + in_weights.y * j1.row0 + in_weights.z * j2.row0 + in_weights.w * j3.row0;
+    vec4 r1 = in_weights.x * j0.row1 + in_weights.y * j1.row1 + in_weights.z * j2.row1 + in_weights.w * j3.row1;
+    vec4 r2 = in_weights.x * j0.row2 + in_weights.y * j1.row2 + in_weights.z * j2.row2 + in_weights.w * j3.row2;
+
+    vec4 p = vec4(in_position, 1.0);
+    vec3 skinned_pos    = vec3(dot(r0, p), dot(r1, p), dot(r2, p));
+    vec3 normal         = PACKED_VERTICES ? oct_decode(in_normal.xy) : in_normal;
+    vec3 skinned_normal = vec3(dot(r0.xyz, normal), dot(r1.xyz, normal), dot(r2.xyz, normal));
+
+    /* ---- Instance transform (same as mesh3d.vert) ---- */
+    vec3 inst_scale, inst_position, inst_color;
+    mat3 rot = instance_basis(inst_scale, inst_position, inst_color);
 
-    vec3 scaled   = skinned_pos.xyz * inst_scale;
+    vec3 scaled   = skinned_pos * inst_scale;
     vec3 rotated  = rot * scaled;
     vec3 world_pos = rotated + inst_position;
 
@@ -6,6 +6,7 @@ layout(location = 2) in vec3 in_color;
 
 layout(push_constant) uniform PushConstants {
     vec2 screen_size; /* width, height in pixels */
+    vec2 origin;      /* pixel offset (cached runs are laid out at 0,0) */
 } pc;
 
 layout(location = 0) out vec2 frag_uv;
@@ -13,7 +14,7 @@ layout(location = 1) out vec3 frag_color;
 
 void main() {
     /* Convert pixel coordinates to NDC: [0,W] -> [-1,1], [0,H] -> [-1,1] */
-    vec2 ndc = (in_position / pc.screen_size) * 2.0 - 1.0;
+    vec2 ndc = ((in_position + pc.origin) / pc.screen_size) * 2.0 - 1.0;
     gl_Position = vec4(ndc, 0.0, 1.0);
     frag_uv    = in_uv;
     frag_color = in_color;
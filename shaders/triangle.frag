@@ -4,19 +4,22 @@ layout(location = 0) in  vec3 frag_color;
 layout(location = 1) in  vec2 frag_uv;
 layout(location = 0) out vec4 out_color;
 
-layout(set = 0, binding = 0) uniform sampler2D tex;
+/* Bindless texture table (set 0); slot 0 is the dummy texture. The array size
+ * is specialized to the device's descriptor limit at pipeline creation. */
+layout(constant_id = 1) const uint TEXTURE_SLOTS = 1;
+layout(set = 0, binding = 0) uniform sampler2D textures[TEXTURE_SLOTS];
 
 layout(push_constant) uniform PushConstants {
     mat4 vp;
-    uint use_texture;
+    uint texture_index;   /* 0 = untextured */
 } pc;
 
 void main() {
     vec3 color = frag_color;
     float alpha = 1.0;
 
-    if (pc.use_texture != 0u) {
-        vec4 tex_sample = texture(tex, frag_uv);
+    if (pc.texture_index != 0u) {
+        vec4 tex_sample = texture(textures[pc.texture_index], frag_uv);
         color *= tex_sample.rgb;
         alpha = tex_sample.a;
     }
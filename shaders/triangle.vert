@@ -16,7 +16,7 @@ layout(location = 8) in vec2 inst_uv_scale;
 /* View-projection matrix + texture flag from camera */
 layout(push_constant) uniform PushConstants {
     mat4 vp;
-    uint use_texture;
+    uint texture_index;
 } pc;
 
 layout(location = 0) out vec3 frag_color;
@@ -2,8 +2,11 @@
 #include "miniaudio/miniaudio.h"
 
 #include "audio/audio.h"
+#include "core/atomic.h"
+#include "core/jobs.h"
 #include "core/log.h"
 
+#include <stdio.h>   /* fopen */
 #include <stdlib.h>  /* malloc, free */
 #include <string.h>  /* memset */
 
@@ -12,40 +15,103 @@
  * ------------------------------------------------------------------------ */
 
 #define AUDIO_MAX_SOUNDS  64   /* max loaded sound assets */
-#define AUDIO_MAX_VOICES  16   /* max simultaneous plays per sound */
+#define AUDIO_MAX_VOICES  64   /* simultaneous plays, shared by all sounds */
+#define AUDIO_MAX_COMMANDS 256 /* game -> audio thread queue (power of two) */
+
+/* Flags shared by every sound: no 3D positioning, no pitch processing */
+#define AUDIO_SOUND_FLAGS (MA_SOUND_FLAG_NO_SPATIALIZATION | MA_SOUND_FLAG_NO_PITCH)
 
 /* --------------------------------------------------------------------------
- * Voice: one playback instance of a sound
+ * Voice: one playback instance from the global pool
+ * Every voice is initialized once in audio_init over its own buffer ref.
+ * Playing a sound points the ref at that sound's decoded PCM, so a play
+ * never allocates or initializes anything. Voices belong to the audio
+ * thread: the game thread only reaches them through the command queue.
  * ------------------------------------------------------------------------ */
 
 typedef struct {
-    ma_sound sound;     /* miniaudio sound (cloned from source data) */
-    bool     active;    /* true if this voice is currently initialized */
+    ma_sound            sound;     /* miniaudio sound, reads from ref */
+    ma_audio_buffer_ref ref;       /* view of the playing sound's PCM */
+    u32                 sound_id;  /* slot being played */
+    u32                 priority;  /* slot priority at play time */
+    u64                 start;     /* play sequence number (older = smaller) */
+    bool                active;    /* true while playing (not on the free stack) */
 } Voice;
 
 /* --------------------------------------------------------------------------
  * Internal sound slot (one per loaded file)
- * Each slot holds the source data node and a pool of voice instances
- * that can play simultaneously.
+ * A decoded sound is one PCM buffer in the engine's format, shared by every
+ * voice that plays it. A stream has no voices: its source is the one
+ * playing instance, decoded from disk a page at a time.
  * ------------------------------------------------------------------------ */
 
+/* A decode started by audio_load_sound_async. The job only writes into
+ * this struct; audio_poll_loads moves the result into the slot. */
+typedef struct {
+    JobCounter   done;
+    char         path[256];
+    ma_uint32    channels;      /* engine format, read on the game thread */
+    ma_uint32    sample_rate;
+    void        *pcm;           /* job output */
+    ma_uint64    frames;
+    ma_result    result;
+    AssetLoadCallback callback;
+    void        *user;
+} AudioLoad;
+
 typedef struct {
-    ma_sound   source;                   /* base sound (used as data source for copies) */
-    Voice      voices[AUDIO_MAX_VOICES]; /* fire-and-forget voice pool */
-    bool       loaded;                   /* true if this slot has a valid sound */
-    char       path[256];                /* file path (for logging) */
+    ma_sound   source;     /* the stream (streams only) */
+    f32       *pcm;        /* decoded frames, engine format (decoded sounds only) */
+    u64        frames;     /* frame count of pcm */
+    u32        priority;   /* voice stealing priority, AUDIO_PRIORITY_DEFAULT */
+    bool       loaded;     /* true if this slot has a valid sound */
+    bool       stream;     /* streamed from disk, played through source */
+    AudioLoad *pending;    /* async decode in progress (not loaded yet) */
+    char       path[256];  /* file path (for logging) */
 } SoundSlot;
 
+/* --------------------------------------------------------------------------
+ * Command queue (game thread -> audio thread)
+ * Single producer, single consumer ring: the game thread writes a command
+ * and publishes it by advancing tail, the audio thread drains up to tail
+ * and hands the slots back by advancing head.
+ * ------------------------------------------------------------------------ */
+
+typedef enum {
+    AUDIO_CMD_PLAY,
+    AUDIO_CMD_STOP,
+} AudioCommandType;
+
+typedef struct {
+    AudioCommandType type;
+    u32              sound_id;
+    f32              volume;
+    bool             loop;
+} AudioCommand;
+
 /* --------------------------------------------------------------------------
  * AudioEngine (opaque struct, hidden from public header)
  * ------------------------------------------------------------------------ */
 
 struct AudioEngine {
-    ma_engine   engine;                    /* miniaudio high-level engine */
-    SoundSlot   sounds[AUDIO_MAX_SOUNDS];  /* loaded sound pool */
-    u32         sound_count;               /* number of sounds loaded so far */
+    ma_engine    engine;                        /* miniaudio high-level engine */
+    SoundSlot    sounds[AUDIO_MAX_SOUNDS];      /* loaded sound pool */
+    u32          sound_count;                   /* number of sounds loaded so far */
+
+    AudioCommand commands[AUDIO_MAX_COMMANDS];  /* command ring */
+    volatile i32 command_head;                  /* next command to run (audio thread) */
+    volatile i32 command_tail;                  /* next free command (game thread) */
+
+    /* Audio thread only */
+    Voice        voices[AUDIO_MAX_VOICES];      /* global voice pool */
+    u32          voice_count;                   /* voices successfully initialized */
+    u32          free_voices[AUDIO_MAX_VOICES]; /* stack of idle voice indices */
+    u32          free_count;
+    u64          play_seq;                      /* start counter for oldest-first stealing */
 };
 
+static void audio_thread_process(void *user, float *frames_out, ma_uint64 frame_count);
+
 /* --------------------------------------------------------------------------
  * Lifecycle
  * ------------------------------------------------------------------------ */
@@ -60,7 +126,11 @@ EngineResult audio_init(AudioEngine **out_engine)
     memset(ae, 0, sizeof(*ae));
 
     ma_engine_config config = ma_engine_config_init();
-    /* Default device, default sample rate, default channel count */
+    /* Default device, default sample rate, default channel count.
+     * Start explicitly once the voices exist: the process callback uses them. */
+    config.noAutoStart       = MA_TRUE;
+    config.onProcess         = audio_thread_process;
+    config.pProcessUserData  = ae;
 
     ma_result result = ma_engine_init(&config, &ae->engine);
     if (result != MA_SUCCESS) {
@@ -69,7 +139,34 @@ EngineResult audio_init(AudioEngine **out_engine)
         return ENGINE_ERROR_GENERIC;
     }
 
-    LOG_INFO("Audio engine initialized (miniaudio)");
+    /* Pre-initialize the voice pool in the engine's format, the format every
+     * decoded sound is converted to at load */
+    ma_uint32 channels    = ma_engine_get_channels(&ae->engine);
+    ma_uint32 sample_rate = ma_engine_get_sample_rate(&ae->engine);
+    for (u32 v = 0; v < AUDIO_MAX_VOICES; v++) {
+        Voice *voice = &ae->voices[ae->voice_count];
+        if (ma_audio_buffer_ref_init(ma_format_f32, channels, NULL, 0, &voice->ref) != MA_SUCCESS)
+            break;
+        voice->ref.sampleRate = sample_rate;
+        if (ma_sound_init_from_data_source(&ae->engine, &voice->ref, AUDIO_SOUND_FLAGS,
+                                           NULL, &voice->sound) != MA_SUCCESS) {
+            ma_audio_buffer_ref_uninit(&voice->ref);
+            break;
+        }
+        ae->free_voices[ae->free_count++] = ae->voice_count;
+        ae->voice_count++;
+    }
+    if (ae->voice_count < AUDIO_MAX_VOICES)
+        LOG_WARN("audio_init: only %u of %d voices initialized", ae->voice_count, AUDIO_MAX_VOICES);
+
+    result = ma_engine_start(&ae->engine);
+    if (result != MA_SUCCESS) {
+        LOG_ERROR("audio_init: ma_engine_start failed (error %d)", result);
+        audio_shutdown(ae);
+        return ENGINE_ERROR_GENERIC;
+    }
+
+    LOG_INFO("Audio engine initialized (miniaudio, %u voices)", ae->voice_count);
     *out_engine = ae;
     return ENGINE_SUCCESS;
 }
@@ -78,18 +175,29 @@ void audio_shutdown(AudioEngine *engine)
 {
     if (!engine) return;
 
-    /* Uninit all voices and source sounds */
+    /* Stop the device first so the audio thread no longer touches voices */
+    ma_engine_stop(&engine->engine);
+
+    for (u32 v = 0; v < engine->voice_count; v++) {
+        ma_sound_uninit(&engine->voices[v].sound);
+        ma_audio_buffer_ref_uninit(&engine->voices[v].ref);
+    }
+
     for (u32 i = 0; i < engine->sound_count; i++) {
         SoundSlot *slot = &engine->sounds[i];
+        if (slot->pending) {
+            /* Wait for the decode and drop it; no callback fires */
+            jobs_wait(&slot->pending->done);
+            ma_free(slot->pending->pcm, NULL);
+            free(slot->pending);
+            slot->pending = NULL;
+        }
         if (!slot->loaded) continue;
 
-        for (i32 v = 0; v < AUDIO_MAX_VOICES; v++) {
-            if (slot->voices[v].active) {
-                ma_sound_uninit(&slot->voices[v].sound);
-                slot->voices[v].active = false;
-            }
-        }
-        ma_sound_uninit(&slot->source);
+        if (slot->stream)
+            ma_sound_uninit(&slot->source);
+        else
+            ma_free(slot->pcm, NULL);
         slot->loaded = false;
     }
 
@@ -102,95 +210,271 @@ void audio_shutdown(AudioEngine *engine)
  * Loading
  * ------------------------------------------------------------------------ */
 
+/* Claim the next slot and record its path; loaded is set by the caller */
+static SoundSlot *claim_slot(AudioEngine *engine, const char *file_path)
+{
+    if (engine->sound_count >= AUDIO_MAX_SOUNDS) {
+        LOG_ERROR("audio: max sounds reached (%d), '%s' not loaded", AUDIO_MAX_SOUNDS, file_path);
+        return NULL;
+    }
+
+    SoundSlot *slot = &engine->sounds[engine->sound_count];
+    memset(slot, 0, sizeof(*slot));
+    slot->priority = AUDIO_PRIORITY_DEFAULT;
+    /* Safe copy — ensure null-terminated */
+    size_t len = strlen(file_path);
+    if (len >= sizeof(slot->path)) len = sizeof(slot->path) - 1;
+    memcpy(slot->path, file_path, len);
+    slot->path[len] = '\0';
+    return slot;
+}
+
 EngineResult audio_load_sound(AudioEngine *engine, const char *file_path,
                               SoundHandle *out_handle)
 {
-    if (engine->sound_count >= AUDIO_MAX_SOUNDS) {
-        LOG_ERROR("audio_load_sound: max sounds reached (%d)", AUDIO_MAX_SOUNDS);
+    SoundSlot *slot = claim_slot(engine, file_path);
+    if (!slot) return ENGINE_ERROR_GENERIC;
+
+    /* Decode the whole file once, converted to the engine's format so any
+     * voice can play it without resampling or channel conversion */
+    ma_decoder_config config = ma_decoder_config_init(ma_format_f32,
+                                                      ma_engine_get_channels(&engine->engine),
+                                                      ma_engine_get_sample_rate(&engine->engine));
+    void *pcm = NULL;
+    ma_uint64 frames = 0;
+    ma_result result = ma_decode_file(file_path, &config, &frames, &pcm);
+    if (result != MA_SUCCESS) {
+        LOG_ERROR("audio: failed to load '%s' (error %d)", file_path, result);
+        return ENGINE_ERROR_FILE_NOT_FOUND;
+    }
+
+    slot->pcm    = (f32 *)pcm;
+    slot->frames = frames;
+    slot->loaded = true;
+
+    u32 idx = engine->sound_count++;
+    out_handle->id = idx;
+    LOG_INFO("Loaded sound [%u]: %s", idx, file_path);
+    return ENGINE_SUCCESS;
+}
+
+static void decode_job(void *arg)
+{
+    AudioLoad *load = (AudioLoad *)arg;
+    ma_decoder_config config = ma_decoder_config_init(ma_format_f32, load->channels,
+                                                      load->sample_rate);
+    load->result = ma_decode_file(load->path, &config, &load->frames, &load->pcm);
+}
+
+EngineResult audio_load_sound_async(AudioEngine *engine, const char *file_path,
+                                    AssetLoadCallback callback, void *user,
+                                    SoundHandle *out_handle)
+{
+    AudioLoad *load = (AudioLoad *)calloc(1, sizeof(AudioLoad));
+    if (!load) return ENGINE_ERROR_OUT_OF_MEMORY;
+
+    SoundSlot *slot = claim_slot(engine, file_path);
+    if (!slot) {
+        free(load);
         return ENGINE_ERROR_GENERIC;
     }
 
-    u32 idx = engine->sound_count;
-    SoundSlot *slot = &engine->sounds[idx];
+    memcpy(load->path, slot->path, sizeof(load->path));
+    load->channels    = ma_engine_get_channels(&engine->engine);
+    load->sample_rate = ma_engine_get_sample_rate(&engine->engine);
+    load->callback    = callback;
+    load->user        = user;
+    slot->pending     = load;
+
+    u32 idx = engine->sound_count++;
+    out_handle->id = idx;
+
+    Job job = { decode_job, load, NULL };
+    jobs_run_background(&job, 1, &load->done);
+    return ENGINE_SUCCESS;
+}
+
+u32 audio_poll_loads(AudioEngine *engine)
+{
+    u32 pending = 0;
+    for (u32 i = 0; i < engine->sound_count; i++) {
+        SoundSlot *slot = &engine->sounds[i];
+        AudioLoad *load = slot->pending;
+        if (!load) continue;
+        if (!jobs_done(&load->done)) {
+            pending++;
+            continue;
+        }
+
+        /* Plays are only queued once loaded is set, so the audio thread
+         * never sees the slot before its PCM */
+        EngineResult res = ENGINE_SUCCESS;
+        if (load->result == MA_SUCCESS) {
+            slot->pcm    = (f32 *)load->pcm;
+            slot->frames = load->frames;
+            slot->loaded = true;
+            LOG_INFO("Loaded sound [%u]: %s", i, slot->path);
+        } else {
+            LOG_ERROR("audio: failed to load '%s' (error %d)", slot->path, load->result);
+            res = ENGINE_ERROR_FILE_NOT_FOUND;
+        }
+        slot->pending = NULL;
+        if (load->callback) load->callback(load->user, res);
+        free(load);
+    }
+    return pending;
+}
+
+EngineResult audio_load_stream(AudioEngine *engine, const char *file_path,
+                               SoundHandle *out_handle)
+{
+    /* With MA_SOUND_FLAG_ASYNC even the first pages are decoded on the
+     * resource manager's job thread, so a load error would only surface as
+     * silence. Opening the file here keeps a bad path a load failure. */
+    FILE *f = fopen(file_path, "rb");
+    if (!f) {
+        LOG_ERROR("audio_load_stream: failed to open '%s'", file_path);
+        return ENGINE_ERROR_FILE_NOT_FOUND;
+    }
+    fclose(f);
 
-    /* Load from file — MA_SOUND_FLAG_DECODE forces full decode into memory
-     * for low-latency playback (fire-and-forget sounds).
-     * MA_SOUND_FLAG_NO_PITCH disables pitch processing for performance.
-     * We don't start this source directly — it's a template for voices. */
+    SoundSlot *slot = claim_slot(engine, file_path);
+    if (!slot) return ENGINE_ERROR_GENERIC;
+
+    /* MA_SOUND_FLAG_STREAM keeps two pages of decoded audio in memory and
+     * refills them from disk on the resource manager's job thread as they
+     * play out */
     ma_result result = ma_sound_init_from_file(
         &engine->engine, file_path,
-        MA_SOUND_FLAG_DECODE | MA_SOUND_FLAG_NO_SPATIALIZATION | MA_SOUND_FLAG_NO_PITCH,
+        MA_SOUND_FLAG_STREAM | MA_SOUND_FLAG_ASYNC | AUDIO_SOUND_FLAGS,
         NULL, NULL, &slot->source);
-
     if (result != MA_SUCCESS) {
-        LOG_ERROR("audio_load_sound: failed to load '%s' (error %d)", file_path, result);
+        LOG_ERROR("audio: failed to load '%s' (error %d)", file_path, result);
         return ENGINE_ERROR_FILE_NOT_FOUND;
     }
 
+    slot->stream = true;
     slot->loaded = true;
-    /* Safe copy — ensure null-terminated */
-    {
-        size_t len = strlen(file_path);
-        if (len >= sizeof(slot->path)) len = sizeof(slot->path) - 1;
-        memcpy(slot->path, file_path, len);
-        slot->path[len] = '\0';
-    }
-    engine->sound_count++;
 
+    u32 idx = engine->sound_count++;
     out_handle->id = idx;
-    LOG_INFO("Loaded sound [%u]: %s", idx, file_path);
+    LOG_INFO("Loaded stream [%u]: %s", idx, file_path);
     return ENGINE_SUCCESS;
 }
 
 /* --------------------------------------------------------------------------
- * Playback — voice pool for overlapping sounds
+ * Audio thread — drains the command queue and manages the voice pool.
+ * Runs from ma_engine's process callback, after each mix, so no voice is
+ * being read while it is retargeted.
  * ------------------------------------------------------------------------ */
 
-/* Find an idle voice (not playing), or steal the oldest one */
-static Voice *find_voice(SoundSlot *slot, ma_engine *engine)
-{
-    /* First pass: find an uninitialized slot */
-    for (i32 v = 0; v < AUDIO_MAX_VOICES; v++) {
-        if (!slot->voices[v].active) {
-            /* Initialize a new voice by copying from the source */
-            ma_result r = ma_sound_init_copy(
-                engine, &slot->source,
-                MA_SOUND_FLAG_DECODE | MA_SOUND_FLAG_NO_SPATIALIZATION | MA_SOUND_FLAG_NO_PITCH,
-                NULL, &slot->voices[v].sound);
-            if (r == MA_SUCCESS) {
-                slot->voices[v].active = true;
-                return &slot->voices[v];
-            }
-            /* If copy failed, try next slot */
-            continue;
-        }
+static void release_voice(AudioEngine *engine, u32 v)
+{
+    Voice *voice = &engine->voices[v];
+    ma_sound_stop(&voice->sound);
+    voice->active = false;
+    engine->free_voices[engine->free_count++] = v;
+}
+
+/* Pop an idle voice, or steal the lowest priority one (one-shots before
+ * looping, then oldest first). Returns false when every voice outranks
+ * the new play, which is then dropped. */
+static bool acquire_voice(AudioEngine *engine, u32 priority, u32 *out_voice)
+{
+    if (engine->free_count > 0) {
+        *out_voice = engine->free_voices[--engine->free_count];
+        return true;
     }
 
-    /* Second pass: find a voice that's finished playing */
-    for (i32 v = 0; v < AUDIO_MAX_VOICES; v++) {
-        if (slot->voices[v].active && ma_sound_at_end(&slot->voices[v].sound)) {
-            ma_sound_seek_to_pcm_frame(&slot->voices[v].sound, 0);
-            return &slot->voices[v];
+    u32  victim = UINT32_MAX;
+    u32  victim_priority = 0;
+    bool victim_loops = false;
+    u64  victim_start = 0;
+    for (u32 v = 0; v < engine->voice_count; v++) {
+        Voice *voice = &engine->voices[v];
+        bool loops = ma_sound_is_looping(&voice->sound) != MA_FALSE;
+        bool lower = victim == UINT32_MAX ||
+                     voice->priority < victim_priority ||
+                     (voice->priority == victim_priority &&
+                      ((victim_loops && !loops) ||
+                       (loops == victim_loops && voice->start < victim_start)));
+        if (lower) {
+            victim = v;
+            victim_priority = voice->priority;
+            victim_loops = loops;
+            victim_start = voice->start;
         }
     }
+    if (victim == UINT32_MAX || victim_priority > priority) return false;
+
+    ma_sound_stop(&engine->voices[victim].sound);
+    *out_voice = victim;
+    return true;
+}
 
-    /* Third pass: steal the first non-looping voice (oldest by index) */
-    for (i32 v = 0; v < AUDIO_MAX_VOICES; v++) {
-        if (slot->voices[v].active && !ma_sound_is_looping(&slot->voices[v].sound)) {
-            ma_sound_stop(&slot->voices[v].sound);
-            ma_sound_seek_to_pcm_frame(&slot->voices[v].sound, 0);
-            return &slot->voices[v];
+static void run_command(AudioEngine *engine, const AudioCommand *cmd)
+{
+    SoundSlot *slot = &engine->sounds[cmd->sound_id];
+
+    if (cmd->type == AUDIO_CMD_STOP) {
+        for (u32 v = 0; v < engine->voice_count; v++) {
+            if (engine->voices[v].active && engine->voices[v].sound_id == cmd->sound_id)
+                release_voice(engine, v);
         }
+        return;
     }
 
-    /* All voices busy with looping sounds — steal first anyway */
-    if (slot->voices[0].active) {
-        ma_sound_stop(&slot->voices[0].sound);
-        ma_sound_seek_to_pcm_frame(&slot->voices[0].sound, 0);
-        return &slot->voices[0];
+    u32 v;
+    if (!acquire_voice(engine, slot->priority, &v)) return;
+
+    Voice *voice = &engine->voices[v];
+    voice->sound_id = cmd->sound_id;
+    voice->priority = slot->priority;
+    voice->start    = engine->play_seq++;
+    voice->active   = true;
+
+    ma_audio_buffer_ref_set_data(&voice->ref, slot->pcm, slot->frames);
+    ma_sound_set_looping(&voice->sound, cmd->loop ? MA_TRUE : MA_FALSE);
+    ma_sound_set_volume(&voice->sound, cmd->volume);
+    ma_sound_start(&voice->sound);
+}
+
+static void audio_thread_process(void *user, float *frames_out, ma_uint64 frame_count)
+{
+    (void)frames_out;
+    (void)frame_count;
+    AudioEngine *engine = (AudioEngine *)user;
+
+    /* Return voices that played out to the free stack */
+    for (u32 v = 0; v < engine->voice_count; v++) {
+        if (engine->voices[v].active && ma_sound_at_end(&engine->voices[v].sound))
+            release_voice(engine, v);
     }
 
-    return NULL;  /* should never happen */
+    i32 head = engine->command_head;
+    i32 tail = atomic_load_i32(&engine->command_tail);
+    while (head != tail) {
+        run_command(engine, &engine->commands[(u32)head & (AUDIO_MAX_COMMANDS - 1)]);
+        head = (i32)((u32)head + 1);
+    }
+    atomic_store_i32(&engine->command_head, head);
+}
+
+/* --------------------------------------------------------------------------
+ * Playback
+ * ------------------------------------------------------------------------ */
+
+static void push_command(AudioEngine *engine, const AudioCommand *cmd)
+{
+    i32 tail = engine->command_tail;
+    i32 head = atomic_load_i32(&engine->command_head);
+    if ((u32)tail - (u32)head >= AUDIO_MAX_COMMANDS) {
+        LOG_WARN("audio: command queue full, sound %u dropped", cmd->sound_id);
+        return;
+    }
+
+    engine->commands[(u32)tail & (AUDIO_MAX_COMMANDS - 1)] = *cmd;
+    atomic_store_i32(&engine->command_tail, (i32)((u32)tail + 1));
 }
 
 void audio_play_sound(AudioEngine *engine, SoundHandle handle,
@@ -202,21 +486,28 @@ void audio_play_sound(AudioEngine *engine, SoundHandle handle,
     }
 
     SoundSlot *slot = &engine->sounds[handle.id];
+    if (slot->pending) return;  /* still decoding: the play is skipped */
     if (!slot->loaded) {
         LOG_WARN("audio_play_sound: sound %u not loaded", handle.id);
         return;
     }
 
-    Voice *voice = find_voice(slot, &engine->engine);
-    if (!voice) {
-        LOG_WARN("audio_play_sound: no free voice for sound %u", handle.id);
+    /* A stream can't be copied: restart the one instance */
+    if (slot->stream) {
+        ma_sound_set_looping(&slot->source, loop ? MA_TRUE : MA_FALSE);
+        ma_sound_set_volume(&slot->source, volume);
+        ma_sound_seek_to_pcm_frame(&slot->source, 0);
+        ma_sound_start(&slot->source);
         return;
     }
 
-    ma_sound_set_looping(&voice->sound, loop ? MA_TRUE : MA_FALSE);
-    ma_sound_set_volume(&voice->sound, volume);
-    ma_sound_seek_to_pcm_frame(&voice->sound, 0);
-    ma_sound_start(&voice->sound);
+    AudioCommand cmd = {
+        .type     = AUDIO_CMD_PLAY,
+        .sound_id = handle.id,
+        .volume   = volume,
+        .loop     = loop,
+    };
+    push_command(engine, &cmd);
 }
 
 void audio_stop_sound(AudioEngine *engine, SoundHandle handle)
@@ -229,12 +520,25 @@ void audio_stop_sound(AudioEngine *engine, SoundHandle handle)
     SoundSlot *slot = &engine->sounds[handle.id];
     if (!slot->loaded) return;
 
+    if (slot->stream) {
+        ma_sound_stop(&slot->source);
+        return;
+    }
+
     /* Stop ALL voices for this sound */
-    for (i32 v = 0; v < AUDIO_MAX_VOICES; v++) {
-        if (slot->voices[v].active) {
-            ma_sound_stop(&slot->voices[v].sound);
-        }
+    AudioCommand cmd = { .type = AUDIO_CMD_STOP, .sound_id = handle.id };
+    push_command(engine, &cmd);
+}
+
+void audio_set_sound_priority(AudioEngine *engine, SoundHandle handle, u32 priority)
+{
+    if (handle.id >= engine->sound_count) {
+        LOG_WARN("audio_set_sound_priority: invalid handle %u", handle.id);
+        return;
     }
+
+    /* Read by the audio thread when the next play command runs */
+    engine->sounds[handle.id].priority = priority;
 }
 
 /* --------------------------------------------------------------------------
@@ -13,6 +13,9 @@ typedef struct {
     u32 id;  /* internal index into loaded sounds array */
 } SoundHandle;
 
+/* Voice stealing priority a sound starts with (see audio_set_sound_priority) */
+#define AUDIO_PRIORITY_DEFAULT 128
+
 /* ---- Lifecycle ---- */
 
 /* Initialize the audio engine (creates device, starts audio thread).
@@ -25,23 +28,52 @@ void audio_shutdown(AudioEngine *engine);
 /* ---- Loading ---- */
 
 /* Load a sound file from disk (WAV, MP3, FLAC, OGG).
- * The file is decoded in memory for low-latency playback.
- * Returns ENGINE_SUCCESS on success. */
+ * The file is decoded once, in the output format, into a buffer shared by
+ * every play of it. Returns ENGINE_SUCCESS on success. */
 EngineResult audio_load_sound(AudioEngine *engine, const char *file_path,
                               SoundHandle *out_handle);
 
+/* Same as audio_load_sound, but returns at once and decodes on a background
+ * job. The handle is valid immediately; plays of it are skipped until the
+ * decode finishes. Completion is reported by audio_poll_loads, which runs
+ * the callback (may be NULL) with the result. */
+EngineResult audio_load_sound_async(AudioEngine *engine, const char *file_path,
+                                    AssetLoadCallback callback, void *user,
+                                    SoundHandle *out_handle);
+
+/* Finish async loads whose decode is done and run their callbacks. Call
+ * once per frame from the thread that plays sounds. Returns how many loads
+ * are still decoding. */
+u32 audio_poll_loads(AudioEngine *engine);
+
+/* Open a long sound (music, ambience) for streaming. Returns at once; the
+ * file is decoded a page at a time on miniaudio's resource manager thread,
+ * so memory stays at a couple of seconds of audio whatever its length. A
+ * stream plays as a single instance: playing it again restarts it.
+ * Returns ENGINE_SUCCESS on success. */
+EngineResult audio_load_stream(AudioEngine *engine, const char *file_path,
+                               SoundHandle *out_handle);
+
 /* ---- Playback ---- */
 
 /* Play a loaded sound.
  *   loop   — true to loop indefinitely, false for one-shot
  *   volume — 0.0 = silent, 1.0 = full volume (can exceed 1.0 for gain)
- * Each call restarts the sound from the beginning. */
+ * Each call starts a new overlapping play from a voice pool shared by all
+ * sounds (a stream restarts instead). The call only queues a command for
+ * the audio thread: it never allocates or blocks, and the sound starts
+ * within one device period. Play and stop must come from a single thread. */
 void audio_play_sound(AudioEngine *engine, SoundHandle handle,
                       bool loop, f32 volume);
 
-/* Stop a currently playing sound immediately. */
+/* Stop every play of a sound. */
 void audio_stop_sound(AudioEngine *engine, SoundHandle handle);
 
+/* When every voice is busy, a new play steals the lowest priority voice
+ * (looping plays outlast one-shots, then oldest goes first); a play is
+ * dropped if all voices outrank it. Defaults to AUDIO_PRIORITY_DEFAULT. */
+void audio_set_sound_priority(AudioEngine *engine, SoundHandle handle, u32 priority);
+
 /* ---- Global controls ---- */
 
 /* Set the master volume (scales all sounds). Default is 1.0. */
@@ -1,26 +1,117 @@
 #include "core/arena.h"
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
+/* Header of a chained block; the data follows it. Holds the position the
+ * arena was at in the previous block, restored when this one is popped. */
+struct ArenaBlock {
+    ArenaBlock *prev;
+    u8         *prev_buf;
+    size_t      prev_capacity;
+    size_t      prev_offset;
+    size_t      capacity;
+    size_t      pad;        /* keeps the data 16-byte aligned */
+};
+
+_Static_assert(sizeof(ArenaBlock) % 16 == 0, "block data must stay 16-byte aligned");
+
+#define BLOCK_DATA(b) ((u8 *)(b) + sizeof(ArenaBlock))
+
 void arena_init(Arena *arena, void *buf, size_t capacity) {
-    arena->buf      = (u8 *)buf;
-    arena->capacity = capacity;
+    arena_init_growable(arena, buf, capacity, 0);
+}
+
+void arena_init_growable(Arena *arena, void *buf, size_t capacity, size_t block_size) {
+    arena->buf        = (u8 *)buf;
+    arena->capacity   = capacity;
+    arena->offset     = 0;
+    arena->block      = NULL;
+    arena->spare      = NULL;
+    arena->block_size = block_size;
+}
+
+void arena_release(Arena *arena) {
+    arena_reset(arena);
+    while (arena->spare) {
+        ArenaBlock *next = arena->spare->prev;
+        free(arena->spare);
+        arena->spare = next;
+    }
+}
+
+/* Move to a chained block with room for `size` bytes at `align`: a spare
+ * one if any is large enough, else a new one */
+static bool arena_grow(Arena *arena, size_t size, size_t align) {
+    size_t need = size + align;
+
+    ArenaBlock **link = &arena->spare;
+    while (*link && (*link)->capacity < need) link = &(*link)->prev;
+
+    ArenaBlock *b = *link;
+    if (b) {
+        *link = b->prev;
+    } else {
+        size_t capacity = need > arena->block_size ? need : arena->block_size;
+        b = malloc(sizeof(ArenaBlock) + capacity);
+        if (!b) return false;
+        b->capacity = capacity;
+    }
+
+    b->prev          = arena->block;
+    b->prev_buf      = arena->buf;
+    b->prev_capacity = arena->capacity;
+    b->prev_offset   = arena->offset;
+
+    arena->block    = b;
+    arena->buf      = BLOCK_DATA(b);
+    arena->capacity = b->capacity;
     arena->offset   = 0;
+    return true;
 }
 
-void *arena_alloc(Arena *arena, size_t size, size_t align) {
-    /* Align the current offset upward */
-    size_t aligned = (arena->offset + (align - 1)) & ~(align - 1);
+void *arena_alloc_nozero(Arena *arena, size_t size, size_t align) {
+    for (;;) {
+        /* Align the current address upward */
+        uintptr_t base    = (uintptr_t)arena->buf;
+        size_t    aligned = (size_t)(((base + arena->offset + (align - 1)) & ~(uintptr_t)(align - 1))
+                                     - base);
 
-    if (aligned + size > arena->capacity) {
-        return NULL; /* out of space */
+        if (arena->buf && aligned + size <= arena->capacity) {
+            void *ptr = arena->buf + aligned;
+            arena->offset = aligned + size;
+            return ptr;
+        }
+        if (arena->block_size == 0 || !arena_grow(arena, size, align)) {
+            return NULL; /* out of space */
+        }
     }
+}
 
-    void *ptr = arena->buf + aligned;
-    arena->offset = aligned + size;
-    memset(ptr, 0, size);
+void *arena_alloc(Arena *arena, size_t size, size_t align) {
+    void *ptr = arena_alloc_nozero(arena, size, align);
+    if (ptr) memset(ptr, 0, size);
     return ptr;
 }
 
+ArenaMark arena_mark(const Arena *arena) {
+    return (ArenaMark){ arena->block, arena->offset };
+}
+
+void arena_pop_to(Arena *arena, ArenaMark mark) {
+    while (arena->block != mark.block) {
+        ArenaBlock *b = arena->block;
+        arena->block    = b->prev;
+        arena->buf      = b->prev_buf;
+        arena->capacity = b->prev_capacity;
+        arena->offset   = b->prev_offset;
+
+        b->prev      = arena->spare;
+        arena->spare = b;
+    }
+    arena->offset = mark.offset;
+}
+
 void arena_reset(Arena *arena) {
-    arena->offset = 0;
+    arena_pop_to(arena, (ArenaMark){ NULL, 0 });
 }
@@ -3,22 +3,53 @@
 
 #include "core/common.h"
 
-/* Simple linear (bump) allocator. Allocates from a fixed-size block.
- * Free all at once with arena_reset(). No individual frees. */
+/* Linear (bump) allocator. Allocates from a caller-provided block; a
+ * growable arena chains further blocks from malloc when that runs out.
+ * Free all at once with arena_reset(), or roll back to an arena_mark().
+ * No individual frees. */
+
+typedef struct ArenaBlock ArenaBlock;
 
 typedef struct {
-    u8    *buf;
-    size_t capacity;
-    size_t offset;
+    u8         *buf;        /* block being allocated from */
+    size_t      capacity;
+    size_t      offset;
+    ArenaBlock *block;      /* current chained block, NULL while in the initial buffer */
+    ArenaBlock *spare;      /* chained blocks rolled back, kept for reuse */
+    size_t      block_size; /* minimum chained block size, 0 = fixed (never grows) */
 } Arena;
 
+/* Position to roll back to; valid until the arena is reset past it */
+typedef struct {
+    ArenaBlock *block;
+    size_t      offset;
+} ArenaMark;
+
 /* Initialize arena with a pre-allocated buffer. */
 void   arena_init(Arena *arena, void *buf, size_t capacity);
 
-/* Allocate `size` bytes aligned to `align`. Returns NULL if out of space. */
+/* Same, but chain blocks of at least block_size bytes when the buffer is
+ * full instead of failing. buf may be NULL (capacity 0): everything then
+ * comes from chained blocks. Free them with arena_release. */
+void   arena_init_growable(Arena *arena, void *buf, size_t capacity, size_t block_size);
+
+/* Free the chained blocks (not the initial buffer) and reset the arena. */
+void   arena_release(Arena *arena);
+
+/* Allocate `size` bytes aligned to `align`. Returns NULL if out of space
+ * (a growable arena only when malloc fails). */
 void  *arena_alloc(Arena *arena, size_t size, size_t align);
 
-/* Reset arena to empty (does not free the backing buffer). */
+/* Same as arena_alloc but leaves the memory uninitialized. For buffers the
+ * caller overwrites completely before reading. */
+void  *arena_alloc_nozero(Arena *arena, size_t size, size_t align);
+
+/* Scoped scratch: everything allocated after arena_mark is released by
+ * arena_pop_to. Scopes nest; chained blocks are kept for the next growth. */
+ArenaMark arena_mark(const Arena *arena);
+void      arena_pop_to(Arena *arena, ArenaMark mark);
+
+/* Reset arena to empty (does not free the backing buffer or chained blocks). */
 void   arena_reset(Arena *arena);
 
 /* Convenience: allocate with default alignment. */
@@ -28,4 +59,7 @@ void   arena_reset(Arena *arena);
 #define arena_push_array(arena, type, count) \
     ((type *)arena_alloc((arena), sizeof(type) * (count), _Alignof(type)))
 
+#define arena_push_array_nozero(arena, type, count) \
+    ((type *)arena_alloc_nozero((arena), sizeof(type) * (count), _Alignof(type)))
+
 #endif /* ENGINE_ARENA_H */
@@ -0,0 +1,102 @@
+#ifndef ENGINE_ATOMIC_H
+#define ENGINE_ATOMIC_H
+
+#include "core/common.h"
+
+/* Minimal atomics for the job system and other lock-free code.
+ *
+ * GCC/Clang use the __atomic builtins; MSVC (whose C11 <stdatomic.h> is still
+ * experimental) uses Interlocked intrinsics, relying on x86/x64 plain loads
+ * and stores being acquire/release. Values are plain integers/pointers so the
+ * structs holding them stay ordinary C. */
+
+#if defined(_MSC_VER) && !defined(__clang__)
+
+#include <intrin.h>
+
+static inline i32 atomic_load_i32(const volatile i32 *p) {
+    i32 v = *p; _ReadWriteBarrier(); return v;
+}
+static inline void atomic_store_i32(volatile i32 *p, i32 v) {
+    _ReadWriteBarrier(); *p = v;
+}
+static inline i32 atomic_fetch_add_i32(volatile i32 *p, i32 v) {
+    return (i32)_InterlockedExchangeAdd((volatile long *)p, (long)v);
+}
+static inline bool atomic_cas_i32(volatile i32 *p, i32 expected, i32 desired) {
+    return _InterlockedCompareExchange((volatile long *)p, (long)desired, (long)expected) == (long)expected;
+}
+
+static inline i64 atomic_load_i64(const volatile i64 *p) {
+    i64 v = *p; _ReadWriteBarrier(); return v;
+}
+static inline void atomic_store_i64(volatile i64 *p, i64 v) {
+    _ReadWriteBarrier(); *p = v;
+}
+static inline i64 atomic_fetch_add_i64(volatile i64 *p, i64 v) {
+    return _InterlockedExchangeAdd64(p, v);
+}
+static inline bool atomic_cas_i64(volatile i64 *p, i64 expected, i64 desired) {
+    return _InterlockedCompareExchange64(p, desired, expected) == expected;
+}
+
+static inline void *atomic_load_ptr(void *const volatile *p) {
+    void *v = *p; _ReadWriteBarrier(); return v;
+}
+static inline void atomic_store_ptr(void *volatile *p, void *v) {
+    _ReadWriteBarrier(); *p = v;
+}
+
+static inline void atomic_fence(void) { __faststorefence(); }
+static inline void atomic_pause(void) { _mm_pause(); }
+
+#else
+
+static inline i32 atomic_load_i32(const volatile i32 *p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+static inline void atomic_store_i32(volatile i32 *p, i32 v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+static inline i32 atomic_fetch_add_i32(volatile i32 *p, i32 v) {
+    return __atomic_fetch_add(p, v, __ATOMIC_SEQ_CST);
+}
+static inline bool atomic_cas_i32(volatile i32 *p, i32 expected, i32 desired) {
+    return __atomic_compare_exchange_n(p, &expected, desired, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+
+static inline i64 atomic_load_i64(const volatile i64 *p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+static inline void atomic_store_i64(volatile i64 *p, i64 v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+static inline i64 atomic_fetch_add_i64(volatile i64 *p, i64 v) {
+    return __atomic_fetch_add(p, v, __ATOMIC_SEQ_CST);
+}
+static inline bool atomic_cas_i64(volatile i64 *p, i64 expected, i64 desired) {
+    return __atomic_compare_exchange_n(p, &expected, desired, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+
+static inline void *atomic_load_ptr(void *const volatile *p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+static inline void atomic_store_ptr(void *volatile *p, void *v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+static inline void atomic_fence(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+
+static inline void atomic_pause(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+#endif
+
+#endif /* ENGINE_ATOMIC_H */
@@ -31,6 +31,11 @@ typedef enum {
     ENGINE_ERROR_WINDOW_INIT,
 } EngineResult;
 
+/* ---- Async load completion (renderer_*_async, audio_load_sound_async) ----
+ * Called on the thread that polls the loads, once per load, with the load's
+ * result. */
+typedef void (*AssetLoadCallback)(void *user, EngineResult result);
+
 /* ---- Utility macros ---- */
 #define ENGINE_ARRAY_LEN(arr) (sizeof(arr) / sizeof((arr)[0]))
 
@@ -0,0 +1,506 @@
+#include "core/jobs.h"
+#include "core/atomic.h"
+#include "core/log.h"
+#include "core/profile.h"
+#include "platform/thread.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define JOBS_DEQUE_SIZE    4096   /* per thread, power of two */
+#define JOBS_SPIN_COUNT    256    /* idle polls before a worker parks */
+#define JOBS_NO_THREAD     UINT32_MAX
+#define JOBS_MAX_FALLBACKS JOBS_MAX_THREADS  /* scratch arenas for outside threads */
+
+typedef struct {
+    Job         job;
+    JobCounter *counter;
+} JobEntry;
+
+/* Chase-Lev deque. The owner pushes/pops at bottom, thieves take from top.
+ * top and bottom sit on separate cache lines; they are hammered by different
+ * threads. */
+typedef struct {
+    volatile i64 top;
+    u8           pad0[56];
+    volatile i64 bottom;
+    u8           pad1[56];
+    JobEntry     entries[JOBS_DEQUE_SIZE];
+} JobDeque;
+
+typedef struct {
+    JobDeque deque;
+    Arena    scratch;
+    Thread  *thread;
+    u32      index;
+    u32      rng;     /* victim selection */
+} JobThread;
+
+static struct {
+    JobThread   *threads;     /* [0] = init thread */
+    u32          thread_count;  /* threads actually running */
+    u32          allocated;     /* entries in `threads` */
+    Semaphore   *wake;
+    Mutex       *background_lock;
+    JobEntry     background[JOBS_BACKGROUND_SIZE];  /* FIFO ring, under the lock */
+    u32          background_head;
+    volatile i32 background_count;  /* also read without the lock as a hint */
+    volatile i32 sleeping;
+    volatile i32 quit;
+    bool         running;
+} s_jobs;
+
+static ENGINE_THREAD_LOCAL u32 tls_index = JOBS_NO_THREAD;
+
+/* Scratch arenas of threads outside the job system, heap-allocated so they
+ * outlive their thread and are released by jobs_shutdown. A thread notices
+ * the release by its epoch going stale and creates a fresh one. Kept apart
+ * from s_jobs: they exist with or without jobs_init. */
+static struct {
+    Arena *volatile arenas[JOBS_MAX_FALLBACKS];
+    volatile i32    count;   /* slots claimed (may pass JOBS_MAX_FALLBACKS) */
+    volatile i32    epoch;
+} s_fallback;
+
+/* --------------------------------------------------------------------------
+ * Deque
+ * ------------------------------------------------------------------------ */
+
+static bool deque_push(JobDeque *d, const JobEntry *e) {
+    i64 b = d->bottom;
+    i64 t = atomic_load_i64(&d->top);
+    if (b - t >= JOBS_DEQUE_SIZE) return false; /* full */
+
+    d->entries[b & (JOBS_DEQUE_SIZE - 1)] = *e;
+    atomic_store_i64(&d->bottom, b + 1);
+    return true;
+}
+
+static bool deque_pop(JobDeque *d, JobEntry *out) {
+    i64 b = d->bottom - 1;
+    atomic_store_i64(&d->bottom, b);
+    atomic_fence();
+    i64 t = atomic_load_i64(&d->top);
+
+    if (t > b) {
+        atomic_store_i64(&d->bottom, b + 1); /* empty */
+        return false;
+    }
+
+    *out = d->entries[b & (JOBS_DEQUE_SIZE - 1)];
+    if (t == b) {
+        /* Last entry: race thieves for it */
+        bool won = atomic_cas_i64(&d->top, t, t + 1);
+        atomic_store_i64(&d->bottom, b + 1);
+        return won;
+    }
+    return true;
+}
+
+static bool deque_steal(JobDeque *d, JobEntry *out) {
+    i64 t = atomic_load_i64(&d->top);
+    atomic_fence();
+    i64 b = atomic_load_i64(&d->bottom);
+    if (t >= b) return false;
+
+    /* Copy before claiming: the CAS fails if the owner or another thief got
+     * to this entry first, and the slot can't be reused until top moves. */
+    JobEntry e = d->entries[t & (JOBS_DEQUE_SIZE - 1)];
+    if (!atomic_cas_i64(&d->top, t, t + 1)) return false;
+    *out = e;
+    return true;
+}
+
+/* --------------------------------------------------------------------------
+ * Execution
+ * ------------------------------------------------------------------------ */
+
+static void execute(JobThread *self, const JobEntry *e) {
+    if (e->job.after) jobs_wait(e->job.after);
+
+    /* Scratch is stacked: nested jobs (run while this one waits) allocate
+     * above it and are rolled back before control returns here */
+    ArenaMark mark = arena_mark(&self->scratch);
+    e->job.fn(e->job.data);
+    arena_pop_to(&self->scratch, mark);
+
+    if (e->counter) atomic_fetch_add_i32(&e->counter->pending, -1);
+}
+
+static u32 next_random(JobThread *self) {
+    u32 x = self->rng; /* xorshift32 */
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    self->rng = x;
+    return x;
+}
+
+static bool try_run_one(JobThread *self) {
+    JobEntry e;
+    if (deque_pop(&self->deque, &e)) {
+        execute(self, &e);
+        return true;
+    }
+
+    u32 n = s_jobs.thread_count;
+    u32 start = next_random(self) % n;
+    for (u32 i = 0; i < n; i++) {
+        u32 victim = (start + i) % n;
+        if (victim == self->index) continue;
+        if (deque_steal(&s_jobs.threads[victim].deque, &e)) {
+            execute(self, &e);
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Background jobs are only taken here, from the worker loop: never by a
+ * thread that is waiting on a counter */
+static bool try_run_background(JobThread *self) {
+    if (atomic_load_i32(&s_jobs.background_count) == 0) return false;
+
+    JobEntry e;
+    bool found = false;
+    mutex_lock(s_jobs.background_lock);
+    if (s_jobs.background_count > 0) {
+        e = s_jobs.background[s_jobs.background_head];
+        s_jobs.background_head = (s_jobs.background_head + 1) % JOBS_BACKGROUND_SIZE;
+        atomic_fetch_add_i32(&s_jobs.background_count, -1);
+        found = true;
+    }
+    mutex_unlock(s_jobs.background_lock);
+
+    if (found) execute(self, &e);
+    return found;
+}
+
+static void worker_main(void *arg) {
+    JobThread *self = arg;
+    tls_index = self->index;
+
+#ifdef ENGINE_PROFILE
+    char name[16];
+    snprintf(name, sizeof(name), "worker %u", self->index);
+    PROFILE_THREAD_NAME(name);
+#endif
+
+    u32 idle = 0;
+    while (!atomic_load_i32(&s_jobs.quit)) {
+        if (try_run_one(self) || try_run_background(self)) {
+            idle = 0;
+            continue;
+        }
+        if (++idle < JOBS_SPIN_COUNT) {
+            atomic_pause();
+            continue;
+        }
+
+        /* Announce we're about to sleep, then look once more so a job pushed
+         * before the announcement can't be missed */
+        atomic_fetch_add_i32(&s_jobs.sleeping, 1);
+        atomic_fence();
+        if (try_run_one(self) || try_run_background(self) ||
+            atomic_load_i32(&s_jobs.quit)) {
+            atomic_fetch_add_i32(&s_jobs.sleeping, -1);
+            idle = 0;
+            continue;
+        }
+        semaphore_wait(s_jobs.wake);
+        atomic_fetch_add_i32(&s_jobs.sleeping, -1);
+        idle = 0;
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * ------------------------------------------------------------------------ */
+
+EngineResult jobs_init(u32 worker_count) {
+    if (s_jobs.running) return ENGINE_SUCCESS;
+
+    if (worker_count == 0) {
+        u32 hw = thread_hardware_concurrency();
+        worker_count = hw > 1 ? hw - 1 : 0;
+    }
+    if (worker_count > JOBS_MAX_THREADS - 1) worker_count = JOBS_MAX_THREADS - 1;
+
+    memset(&s_jobs, 0, sizeof(s_jobs));
+    s_jobs.thread_count = worker_count + 1;
+    s_jobs.allocated    = s_jobs.thread_count;
+    s_jobs.threads = calloc(s_jobs.allocated, sizeof(JobThread));
+    if (!s_jobs.threads) return ENGINE_ERROR_OUT_OF_MEMORY;
+
+    for (u32 i = 0; i < s_jobs.allocated; i++) {
+        JobThread *t = &s_jobs.threads[i];
+        void *buf = malloc(JOBS_SCRATCH_SIZE);
+        if (!buf) goto fail;
+        arena_init_growable(&t->scratch, buf, JOBS_SCRATCH_SIZE, JOBS_SCRATCH_SIZE);
+        t->index = i;
+        t->rng   = 0x9E3779B9u * (i + 1);
+    }
+
+    if (semaphore_create(0, &s_jobs.wake) != ENGINE_SUCCESS) goto fail;
+    if (mutex_create(&s_jobs.background_lock) != ENGINE_SUCCESS) {
+        semaphore_destroy(s_jobs.wake);
+        goto fail;
+    }
+
+    tls_index = 0;
+    s_jobs.running = true;
+    PROFILE_THREAD_NAME("main");
+
+    for (u32 i = 1; i < s_jobs.thread_count; i++) {
+        if (thread_create(worker_main, &s_jobs.threads[i], &s_jobs.threads[i].thread) != ENGINE_SUCCESS) {
+            /* Run with the workers we have; their deques stay empty */
+            LOG_WARN("Job system: started %u of %u workers", i - 1, worker_count);
+            s_jobs.thread_count = i;
+            break;
+        }
+    }
+
+    LOG_INFO("Job system: %u worker threads", s_jobs.thread_count - 1);
+    return ENGINE_SUCCESS;
+
+fail:
+    for (u32 i = 0; i < s_jobs.allocated; i++) {
+        free(s_jobs.threads[i].scratch.buf);
+    }
+    free(s_jobs.threads);
+    memset(&s_jobs, 0, sizeof(s_jobs));
+    return ENGINE_ERROR_OUT_OF_MEMORY;
+}
+
+/* Free the outside threads' arenas; none may be in use */
+static void release_fallbacks(void) {
+    i32 n = atomic_load_i32(&s_fallback.count);
+    if (n > JOBS_MAX_FALLBACKS) n = JOBS_MAX_FALLBACKS;
+    for (i32 i = 0; i < n; i++) {
+        Arena *a = s_fallback.arenas[i];
+        if (!a) continue;
+        arena_release(a);
+        free(a->buf);
+        free(a);
+        s_fallback.arenas[i] = NULL;
+    }
+    atomic_store_i32(&s_fallback.count, 0);
+    atomic_fetch_add_i32(&s_fallback.epoch, 1);
+}
+
+void jobs_shutdown(void) {
+    release_fallbacks();
+    if (!s_jobs.running) return;
+
+    /* Drain whatever is still queued before stopping the workers. Callers
+     * should have waited on their counters; this only catches stragglers. */
+    JobThread *self = &s_jobs.threads[0];
+    while (try_run_one(self) || try_run_background(self)) {}
+
+    atomic_store_i32(&s_jobs.quit, 1);
+    semaphore_post(s_jobs.wake, s_jobs.thread_count);
+    for (u32 i = 1; i < s_jobs.thread_count; i++) {
+        thread_join(s_jobs.threads[i].thread);
+    }
+
+    for (u32 i = 0; i < s_jobs.allocated; i++) {
+        Arena *scratch = &s_jobs.threads[i].scratch;
+        arena_release(scratch);
+        free(scratch->buf);
+    }
+    semaphore_destroy(s_jobs.wake);
+    mutex_destroy(s_jobs.background_lock);
+    free(s_jobs.threads);
+    memset(&s_jobs, 0, sizeof(s_jobs));
+    tls_index = JOBS_NO_THREAD;
+}
+
+bool jobs_running(void) {
+    return s_jobs.running;
+}
+
+u32 jobs_thread_count(void) {
+    return s_jobs.running ? s_jobs.thread_count : 1;
+}
+
+u32 jobs_thread_index(void) {
+    return tls_index == JOBS_NO_THREAD ? 0 : tls_index;
+}
+
+void jobs_run(const Job *jobs, u32 count, JobCounter *counter) {
+    if (count == 0) return;
+
+    if (!s_jobs.running || tls_index == JOBS_NO_THREAD) {
+        for (u32 i = 0; i < count; i++) {
+            if (jobs[i].after) jobs_wait(jobs[i].after);
+            jobs[i].fn(jobs[i].data);
+        }
+        return;
+    }
+
+    JobThread *self = &s_jobs.threads[tls_index];
+    if (counter) atomic_fetch_add_i32(&counter->pending, (i32)count);
+
+    for (u32 i = 0; i < count; i++) {
+        JobEntry e = { jobs[i], counter };
+        if (!deque_push(&self->deque, &e)) {
+            execute(self, &e); /* deque full: run it here */
+        }
+    }
+
+    /* Pairs with the fence after a worker announces sleep: either it sees
+     * the new bottom on its last look, or we see it counted as sleeping.
+     * Without it the load can pass the push and the wakeup is lost. */
+    atomic_fence();
+    i32 sleeping = atomic_load_i32(&s_jobs.sleeping);
+    if (sleeping > 0) {
+        semaphore_post(s_jobs.wake, (u32)sleeping < count ? (u32)sleeping : count);
+    }
+}
+
+void jobs_run_background(const Job *jobs, u32 count, JobCounter *counter) {
+    if (count == 0) return;
+
+    bool to_workers = s_jobs.running && s_jobs.thread_count > 1;
+    u32  queued     = 0;
+    if (to_workers) {
+        if (counter) atomic_fetch_add_i32(&counter->pending, (i32)count);
+
+        mutex_lock(s_jobs.background_lock);
+        while (queued < count && s_jobs.background_count < JOBS_BACKGROUND_SIZE) {
+            u32 at = (s_jobs.background_head + (u32)s_jobs.background_count) % JOBS_BACKGROUND_SIZE;
+            s_jobs.background[at] = (JobEntry){ jobs[queued], counter };
+            atomic_fetch_add_i32(&s_jobs.background_count, 1);
+            queued++;
+        }
+        mutex_unlock(s_jobs.background_lock);
+
+        atomic_fence();  /* as in jobs_run: publish before reading sleepers */
+        i32 sleeping = atomic_load_i32(&s_jobs.sleeping);
+        if (queued > 0 && sleeping > 0) {
+            semaphore_post(s_jobs.wake, (u32)sleeping < queued ? (u32)sleeping : queued);
+        }
+        if (queued < count) {
+            LOG_WARN("Job system: background queue full, running %u jobs inline", count - queued);
+        }
+    }
+
+    /* No workers to hand them to (or no room): run the rest here */
+    for (u32 i = queued; i < count; i++) {
+        if (jobs[i].after) jobs_wait(jobs[i].after);
+        jobs[i].fn(jobs[i].data);
+        if (counter && to_workers) atomic_fetch_add_i32(&counter->pending, -1);
+    }
+}
+
+void jobs_wait(JobCounter *counter) {
+    if (!counter) return;
+
+    if (!s_jobs.running || tls_index == JOBS_NO_THREAD) {
+        /* Jobs ran inline, or another thread is finishing them */
+        while (atomic_load_i32(&counter->pending) > 0) thread_yield();
+        return;
+    }
+
+    JobThread *self = &s_jobs.threads[tls_index];
+    u32 idle = 0;
+    while (atomic_load_i32(&counter->pending) > 0) {
+        if (try_run_one(self)) {
+            idle = 0;
+        } else if (++idle < JOBS_SPIN_COUNT) {
+            atomic_pause();
+        } else {
+            thread_yield();
+        }
+    }
+}
+
+bool jobs_done(const JobCounter *counter) {
+    return atomic_load_i32(&counter->pending) <= 0;
+}
+
+/* ---- parallel_for: one job per thread, each claiming chunks dynamically ---- */
+
+typedef struct {
+    JobRangeFunc  fn;
+    void         *data;
+    u32           count;
+    u32           grain;
+    volatile i32  next;  /* next chunk start */
+} ParallelFor;
+
+static void parallel_for_job(void *arg) {
+    ParallelFor *pf = arg;
+    for (;;) {
+        i32 begin = atomic_fetch_add_i32(&pf->next, (i32)pf->grain);
+        if ((u32)begin >= pf->count) break;
+        u32 end = (u32)begin + pf->grain;
+        if (end > pf->count) end = pf->count;
+        pf->fn(pf->data, (u32)begin, end);
+    }
+}
+
+void jobs_parallel_for(u32 count, u32 grain, JobRangeFunc fn, void *data) {
+    if (count == 0) return;
+
+    u32 threads = jobs_thread_count();
+    if (grain == 0) {
+        /* ~4 chunks per thread balances uneven items without much overhead */
+        grain = count / (threads * 4);
+        if (grain == 0) grain = 1;
+    }
+
+    u32 chunks = (count + grain - 1) / grain;
+    if (threads == 1 || chunks == 1 || tls_index == JOBS_NO_THREAD) {
+        fn(data, 0, count);
+        return;
+    }
+
+    ParallelFor pf = { fn, data, count, grain, 0 };
+    u32 job_count = chunks < threads ? chunks : threads;
+
+    Job jobs[JOBS_MAX_THREADS];
+    for (u32 i = 0; i < job_count; i++) {
+        jobs[i] = (Job){ parallel_for_job, &pf, NULL };
+    }
+
+    /* Queue all but one; the calling thread takes its share directly */
+    JobCounter counter = {0};
+    jobs_run(jobs, job_count - 1, &counter);
+    parallel_for_job(&pf);
+    jobs_wait(&counter);
+}
+
+Arena *jobs_scratch(void) {
+    static ENGINE_THREAD_LOCAL Arena *fallback = NULL;
+    static ENGINE_THREAD_LOCAL i32    fallback_epoch;
+
+    if (s_jobs.running && tls_index != JOBS_NO_THREAD) {
+        return &s_jobs.threads[tls_index].scratch;
+    }
+
+    /* Threads outside the job system get a lazily created arena of their
+     * own, registered for jobs_shutdown to release */
+    i32 epoch = atomic_load_i32(&s_fallback.epoch);
+    if (fallback && fallback_epoch == epoch) return fallback;
+
+    i32 slot = atomic_fetch_add_i32(&s_fallback.count, 1);
+    if (slot >= JOBS_MAX_FALLBACKS) {
+        LOG_ERROR("Job system: more than %d threads outside the job system use scratch",
+                  JOBS_MAX_FALLBACKS);
+        return NULL;
+    }
+    Arena *a   = malloc(sizeof(Arena));
+    void  *buf = malloc(JOBS_SCRATCH_SIZE);
+    if (!a || !buf) {
+        free(a);
+        free(buf);
+        return NULL;
+    }
+    arena_init_growable(a, buf, JOBS_SCRATCH_SIZE, JOBS_SCRATCH_SIZE);
+    s_fallback.arenas[slot] = a;
+    fallback       = a;
+    fallback_epoch = epoch;
+    return fallback;
+}
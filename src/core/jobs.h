@@ -0,0 +1,86 @@
+#ifndef ENGINE_JOBS_H
+#define ENGINE_JOBS_H
+
+#include "core/common.h"
+#include "core/arena.h"
+
+/* Work-stealing job system.
+ *
+ * jobs_init() starts N worker threads; the thread that calls it becomes
+ * thread 0 and takes part whenever it waits. Each thread owns a deque: it pushes
+ * and pops its own jobs LIFO, idle threads steal FIFO from the others.
+ *
+ * Completion is tracked with JobCounters: jobs_run() adds the number of jobs
+ * to a counter and each finished job subtracts one. jobs_wait() runs other
+ * jobs until the counter reaches zero, so it may be called from inside a job
+ * (nested parallelism) without deadlocking. A job with `after` set waits for
+ * that counter before running, which expresses simple dependencies.
+ *
+ * Long-running work (asset decoding) goes through jobs_run_background
+ * instead: a shared FIFO that only idle workers take from, so a thread
+ * waiting in jobs_wait mid-frame never picks up a job that runs for
+ * milliseconds.
+ *
+ * When the system is not running (or from a thread it doesn't know about)
+ * every call degrades to running the work inline. */
+
+#define JOBS_MAX_THREADS   32                /* including the main thread */
+#define JOBS_SCRATCH_SIZE  (1024 * 1024)     /* per-thread scratch arena (and growth block) */
+#define JOBS_BACKGROUND_SIZE 256             /* queued background jobs */
+
+typedef void (*JobFunc)(void *data);
+
+/* Zero-initialize before first use. */
+typedef struct {
+    volatile i32 pending;
+} JobCounter;
+
+typedef struct {
+    JobFunc     fn;
+    void       *data;
+    JobCounter *after;  /* optional: wait for this to reach zero first */
+} Job;
+
+/* Range callback for jobs_parallel_for: process items [begin, end). */
+typedef void (*JobRangeFunc)(void *data, u32 begin, u32 end);
+
+/* Start the scheduler. worker_count 0 = one per hardware thread minus one. */
+EngineResult jobs_init(u32 worker_count);
+
+/* Finish queued jobs and stop the workers. Call from the init thread. */
+void         jobs_shutdown(void);
+
+bool         jobs_running(void);
+
+/* Threads that execute jobs (workers + init thread); 1 when not running. */
+u32          jobs_thread_count(void);
+
+/* 0 on the init thread, 1..N on workers. Stable index for per-thread data. */
+u32          jobs_thread_index(void);
+
+/* Queue `count` jobs; `counter` (may be NULL) is incremented by count. */
+void         jobs_run(const Job *jobs, u32 count, JobCounter *counter);
+
+/* Queue `count` low-priority jobs, run by worker threads when they have
+ * nothing else to do. May be called from any thread. Without workers (or
+ * with the queue full) the jobs run inline. */
+void         jobs_run_background(const Job *jobs, u32 count, JobCounter *counter);
+
+/* Run jobs until the counter reaches zero. */
+void         jobs_wait(JobCounter *counter);
+
+bool         jobs_done(const JobCounter *counter);
+
+/* Call fn over [0, count) split into chunks of `grain` items (0 = pick one)
+ * spread across all threads. Blocks until every chunk is done. */
+void         jobs_parallel_for(u32 count, u32 grain, JobRangeFunc fn, void *data);
+
+/* The calling thread's scratch arena. Anything a job allocates from it is
+ * released when that job returns. Outside jobs the owner resets it, or
+ * scopes its use with arena_mark / arena_pop_to. It chains more blocks
+ * when full, so large transient allocations succeed. Threads outside the
+ * job system get one of their own (up to JOBS_MAX_THREADS such threads,
+ * else NULL), freed by jobs_shutdown, which must not race their use. */
+Arena       *jobs_scratch(void);
+
+#endif /* ENGINE_JOBS_H */
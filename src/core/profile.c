@@ -0,0 +1,256 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L   /* clock_gettime */
+#endif
+
+#include "core/profile.h"
+
+#ifdef ENGINE_PROFILE
+
+#include "core/atomic.h"
+#include "core/log.h"
+#include "platform/thread.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PROFILE_USE_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILE_USE_TSC 1
+#endif
+
+#define PROFILE_RING_MASK        (PROFILE_RING_EVENTS - 1)
+#define PROFILE_CALIBRATE_NS     10000000ull   /* min span for the TSC rate */
+
+typedef struct {
+    const char *name;
+    u64         start;
+    u64         end;
+} ProfileEvent;
+
+typedef struct {
+    const char *name;
+    u64         start;
+} ProfileOpenZone;
+
+typedef struct {
+    volatile i64    head;                   /* events ever written; owner only */
+    u32             depth;
+    u32             tid;
+    char            thread_name[32];
+    ProfileOpenZone stack[PROFILE_MAX_DEPTH];
+    ProfileEvent    events[PROFILE_RING_EVENTS];
+} ProfileThread;
+
+static struct {
+    ProfileThread *volatile threads[PROFILE_MAX_THREADS];
+    volatile i32            thread_count;   /* slots claimed */
+    volatile i32            started;
+    u64                     start_ticks;    /* reference pair for calibration */
+    u64                     start_ns;
+} s_profile;
+
+static ENGINE_THREAD_LOCAL ProfileThread *tls_thread;
+static ENGINE_THREAD_LOCAL bool           tls_failed;   /* out of slots or memory */
+
+/* --------------------------------------------------------------------------
+ * Clock
+ * ------------------------------------------------------------------------ */
+
+static u64 os_ns(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (u64)((double)now.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000000000ull + (u64)ts.tv_nsec;
+#endif
+}
+
+static inline u64 profile_ticks(void) {
+#ifdef PROFILE_USE_TSC
+    return __rdtsc();
+#else
+    return os_ns();
+#endif
+}
+
+/* Ticks per microsecond, measured over everything since the first zone */
+static double ticks_per_us(void) {
+#ifdef PROFILE_USE_TSC
+    u64 ns = os_ns();
+    while (ns - s_profile.start_ns < PROFILE_CALIBRATE_NS) {
+        thread_yield();
+        ns = os_ns();
+    }
+    u64 ticks = profile_ticks();
+    return (double)(ticks - s_profile.start_ticks) * 1000.0 /
+           (double)(ns - s_profile.start_ns);
+#else
+    return 1000.0;
+#endif
+}
+
+/* --------------------------------------------------------------------------
+ * Recording
+ * ------------------------------------------------------------------------ */
+
+static ProfileThread *register_thread(void) {
+    if (atomic_cas_i32(&s_profile.started, 0, 1)) {
+        s_profile.start_ns    = os_ns();
+        s_profile.start_ticks = profile_ticks();
+    }
+
+    i32 slot = atomic_fetch_add_i32(&s_profile.thread_count, 1);
+    if (slot >= PROFILE_MAX_THREADS) {
+        tls_failed = true;
+        return NULL;
+    }
+
+    ProfileThread *t = calloc(1, sizeof(ProfileThread));
+    if (!t) {
+        tls_failed = true;
+        return NULL;
+    }
+    t->tid = (u32)slot;
+    snprintf(t->thread_name, sizeof(t->thread_name), "thread %d", slot);
+
+    atomic_store_ptr((void *volatile *)&s_profile.threads[slot], t);
+    tls_thread = t;
+    return t;
+}
+
+static inline ProfileThread *this_thread(void) {
+    ProfileThread *t = tls_thread;
+    if (t) return t;
+    return tls_failed ? NULL : register_thread();
+}
+
+void profile_begin(const char *name) {
+    ProfileThread *t = this_thread();
+    if (!t) return;
+    if (t->depth < PROFILE_MAX_DEPTH) {
+        t->stack[t->depth] = (ProfileOpenZone){ name, profile_ticks() };
+    }
+    t->depth++;
+}
+
+void profile_end(void) {
+    ProfileThread *t = this_thread();
+    if (!t || t->depth == 0) return;
+    if (--t->depth >= PROFILE_MAX_DEPTH) return;
+
+    const ProfileOpenZone *z = &t->stack[t->depth];
+    i64 head = t->head;
+    t->events[head & PROFILE_RING_MASK] = (ProfileEvent){ z->name, z->start, profile_ticks() };
+    atomic_store_i64(&t->head, head + 1);
+}
+
+void profile_set_thread_name(const char *name) {
+    ProfileThread *t = this_thread();
+    if (!t) return;
+    snprintf(t->thread_name, sizeof(t->thread_name), "%s", name);
+}
+
+/* --------------------------------------------------------------------------
+ * Chrome trace export
+ * ------------------------------------------------------------------------ */
+
+/* Names are code literals; escape just enough to keep the JSON valid */
+static void write_json_string(FILE *f, const char *s) {
+    fputc('"', f);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', f);
+        if ((unsigned char)*s >= 0x20) fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+EngineResult profile_dump_chrome_trace(const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        LOG_ERROR("Profiler: cannot open '%s' for writing", path);
+        return ENGINE_ERROR_FILE_NOT_FOUND;
+    }
+
+    ProfileEvent *copy = malloc(sizeof(ProfileEvent) * PROFILE_RING_EVENTS);
+    if (!copy) {
+        fclose(f);
+        return ENGINE_ERROR_OUT_OF_MEMORY;
+    }
+
+    double per_us = ticks_per_us();
+    u64 origin    = s_profile.start_ticks;
+    u64 written   = 0;
+    bool first    = true;
+
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", f);
+
+    i32 count = ENGINE_MIN(atomic_load_i32(&s_profile.thread_count), PROFILE_MAX_THREADS);
+    for (i32 i = 0; i < count; i++) {
+        ProfileThread *t = atomic_load_ptr((void *const volatile *)&s_profile.threads[i]);
+        if (!t) continue;
+
+        /* Copy the ring, then drop whatever the owner overwrote meanwhile */
+        i64 head  = atomic_load_i64(&t->head);
+        i64 begin = ENGINE_MAX(head - PROFILE_RING_EVENTS, (i64)0);
+        for (i64 e = begin; e < head; e++) {
+            copy[e - begin] = t->events[e & PROFILE_RING_MASK];
+        }
+        i64 after = atomic_load_i64(&t->head);
+        i64 valid = ENGINE_MAX(after - PROFILE_RING_EVENTS, begin);
+
+        fprintf(f, "%s{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_name\","
+                   "\"args\":{\"name\":", first ? "" : ",\n", t->tid);
+        write_json_string(f, t->thread_name);
+        fputs("}}", f);
+        first = false;
+
+        for (i64 e = valid; e < head; e++) {
+            const ProfileEvent *ev = &copy[e - begin];
+            if (ev->start < origin) continue;
+            fputs(",\n{\"ph\":\"X\",\"pid\":1,\"tid\":", f);
+            fprintf(f, "%u,\"name\":", t->tid);
+            write_json_string(f, ev->name);
+            fprintf(f, ",\"ts\":%.3f,\"dur\":%.3f}",
+                    (double)(ev->start - origin) / per_us,
+                    (double)(ev->end - ev->start) / per_us);
+            written++;
+        }
+    }
+
+    fputs("\n]}\n", f);
+    free(copy);
+
+    bool ok = (ferror(f) == 0);
+    if (fclose(f) != 0) ok = false;
+    if (!ok) {
+        LOG_ERROR("Profiler: failed writing '%s'", path);
+        return ENGINE_ERROR_GENERIC;
+    }
+
+    LOG_INFO("Profiler: wrote %llu zones from %d threads to %s",
+             (unsigned long long)written, count, path);
+    return ENGINE_SUCCESS;
+}
+
+#else
+
+/* ENGINE_PROFILE off: the header's macros expand to nothing. ISO C needs at
+ * least one declaration per translation unit. */
+typedef int profile_disabled;
+
+#endif /* ENGINE_PROFILE */
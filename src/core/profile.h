@@ -0,0 +1,62 @@
+#ifndef ENGINE_PROFILE_H
+#define ENGINE_PROFILE_H
+
+#include "core/common.h"
+
+/* CPU frame profiler.
+ *
+ * Zones are recorded into a per-thread ring of PROFILE_RING_EVENTS completed
+ * events: only the owning thread writes its ring and publishes the head with
+ * a release store, so recording takes no locks. Time is read from the TSC on
+ * x86/x64 (calibrated against the OS clock at dump time), QPC on other
+ * Windows targets and CLOCK_MONOTONIC elsewhere.
+ *
+ * profile_dump_chrome_trace() writes what the rings hold as Chrome trace
+ * event JSON (chrome://tracing, ui.perfetto.dev). When a ring wraps the
+ * oldest events are overwritten.
+ *
+ * Everything compiles away unless ENGINE_PROFILE is defined (CMake option
+ * ENGINE_PROFILE, never on in Release builds). Zone names must outlive the
+ * dump; string literals and __func__ are fine. */
+
+#define PROFILE_RING_EVENTS  16384   /* per thread, power of two */
+#define PROFILE_MAX_THREADS  64
+#define PROFILE_MAX_DEPTH    32      /* deeper zones are dropped */
+
+#ifdef ENGINE_PROFILE
+
+void profile_begin(const char *name);
+void profile_end(void);
+
+/* Label the calling thread in the trace (copied, truncated to 31 chars). */
+void profile_set_thread_name(const char *name);
+
+/* Write every thread's ring to `path`. Safe to call while other threads
+ * record; events overwritten during the dump are left out. */
+EngineResult profile_dump_chrome_trace(const char *path);
+
+#define PROFILE_ZONE_BEGIN(name)   profile_begin(name)
+#define PROFILE_ZONE_END()         profile_end()
+#define PROFILE_THREAD_NAME(name)  profile_set_thread_name(name)
+
+/* Scoped zone around the following statement or block. Leaving the block
+ * with return, break or goto skips the end; use BEGIN/END there. */
+#define PROFILE_ZONE(name) \
+    for (int profile_once_ = (profile_begin(name), 1); profile_once_; \
+         profile_once_ = 0, profile_end())
+
+#else
+
+#define PROFILE_ZONE_BEGIN(name)   ((void)0)
+#define PROFILE_ZONE_END()         ((void)0)
+#define PROFILE_THREAD_NAME(name)  ((void)0)
+#define PROFILE_ZONE(name)
+
+static inline EngineResult profile_dump_chrome_trace(const char *path) {
+    (void)path;
+    return ENGINE_ERROR_GENERIC;
+}
+
+#endif /* ENGINE_PROFILE */
+
+#endif /* ENGINE_PROFILE_H */
@@ -0,0 +1,159 @@
+#ifndef ENGINE_SIMD_H
+#define ENGINE_SIMD_H
+
+#include "core/common.h"
+
+/* Minimal float SIMD layer for structure-of-arrays kernels.
+ *
+ * simd_f32 holds SIMD_WIDTH lanes: 8 with AVX2 (build with ENGINE_SIMD_AVX2),
+ * 4 with SSE2 or NEON, 1 in the scalar fallback. Kernels loop in steps of
+ * SIMD_WIDTH over arrays padded to SIMD_MAX_WIDTH, so every path can use
+ * whole-vector loads and stores. Loads and stores are unaligned-safe. */
+
+#define SIMD_MAX_WIDTH 8
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define SIMD_AVX2 1
+    #define SIMD_WIDTH 8
+    typedef __m256 simd_f32;
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define SIMD_SSE2 1
+    #define SIMD_WIDTH 4
+    typedef __m128 simd_f32;
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define SIMD_NEON 1
+    #define SIMD_WIDTH 4
+    typedef float32x4_t simd_f32;
+#else
+    #include <math.h>
+    #define SIMD_SCALAR 1
+    #define SIMD_WIDTH 1
+    typedef f32 simd_f32;
+#endif
+
+/* Round n up to a whole number of SIMD_MAX_WIDTH lanes */
+#define SIMD_PAD(n) (((n) + SIMD_MAX_WIDTH - 1) & ~(u32)(SIMD_MAX_WIDTH - 1))
+
+#if defined(SIMD_AVX2)
+
+static inline simd_f32 simd_load(const f32 *p)          { return _mm256_loadu_ps(p); }
+static inline void     simd_store(f32 *p, simd_f32 v)   { _mm256_storeu_ps(p, v); }
+static inline simd_f32 simd_set1(f32 x)                 { return _mm256_set1_ps(x); }
+static inline simd_f32 simd_add(simd_f32 a, simd_f32 b) { return _mm256_add_ps(a, b); }
+static inline simd_f32 simd_sub(simd_f32 a, simd_f32 b) { return _mm256_sub_ps(a, b); }
+static inline simd_f32 simd_mul(simd_f32 a, simd_f32 b) { return _mm256_mul_ps(a, b); }
+#if defined(__FMA__)
+static inline simd_f32 simd_madd(simd_f32 a, simd_f32 b, simd_f32 c) { return _mm256_fmadd_ps(a, b, c); }
+#else
+static inline simd_f32 simd_madd(simd_f32 a, simd_f32 b, simd_f32 c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+#endif
+static inline simd_f32 simd_rsqrt_est(simd_f32 x)       { return _mm256_rsqrt_ps(x); }
+static inline simd_f32 simd_sign_of(simd_f32 s) {
+    return _mm256_and_ps(s, _mm256_set1_ps(-0.0f));
+}
+static inline simd_f32 simd_xor(simd_f32 a, simd_f32 b) { return _mm256_xor_ps(a, b); }
+static inline u32      simd_le_mask(simd_f32 a, simd_f32 b) {
+    return (u32)_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LE_OQ));
+}
+
+#elif defined(SIMD_SSE2)
+
+static inline simd_f32 simd_load(const f32 *p)          { return _mm_loadu_ps(p); }
+static inline void     simd_store(f32 *p, simd_f32 v)   { _mm_storeu_ps(p, v); }
+static inline simd_f32 simd_set1(f32 x)                 { return _mm_set1_ps(x); }
+static inline simd_f32 simd_add(simd_f32 a, simd_f32 b) { return _mm_add_ps(a, b); }
+static inline simd_f32 simd_sub(simd_f32 a, simd_f32 b) { return _mm_sub_ps(a, b); }
+static inline simd_f32 simd_mul(simd_f32 a, simd_f32 b) { return _mm_mul_ps(a, b); }
+static inline simd_f32 simd_madd(simd_f32 a, simd_f32 b, simd_f32 c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+static inline simd_f32 simd_rsqrt_est(simd_f32 x)       { return _mm_rsqrt_ps(x); }
+static inline simd_f32 simd_sign_of(simd_f32 s)         { return _mm_and_ps(s, _mm_set1_ps(-0.0f)); }
+static inline simd_f32 simd_xor(simd_f32 a, simd_f32 b) { return _mm_xor_ps(a, b); }
+static inline u32      simd_le_mask(simd_f32 a, simd_f32 b) { return (u32)_mm_movemask_ps(_mm_cmple_ps(a, b)); }
+
+#elif defined(SIMD_NEON)
+
+static inline simd_f32 simd_load(const f32 *p)          { return vld1q_f32(p); }
+static inline void     simd_store(f32 *p, simd_f32 v)   { vst1q_f32(p, v); }
+static inline simd_f32 simd_set1(f32 x)                 { return vdupq_n_f32(x); }
+static inline simd_f32 simd_add(simd_f32 a, simd_f32 b) { return vaddq_f32(a, b); }
+static inline simd_f32 simd_sub(simd_f32 a, simd_f32 b) { return vsubq_f32(a, b); }
+static inline simd_f32 simd_mul(simd_f32 a, simd_f32 b) { return vmulq_f32(a, b); }
+static inline simd_f32 simd_madd(simd_f32 a, simd_f32 b, simd_f32 c) { return vmlaq_f32(c, a, b); }
+static inline simd_f32 simd_rsqrt_est(simd_f32 x)       { return vrsqrteq_f32(x); }
+static inline simd_f32 simd_sign_of(simd_f32 s) {
+    return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(s), vdupq_n_u32(0x80000000u)));
+}
+static inline simd_f32 simd_xor(simd_f32 a, simd_f32 b) {
+    return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+}
+static inline u32      simd_le_mask(simd_f32 a, simd_f32 b) {
+    static const u32 lane_bits[4] = { 1, 2, 4, 8 };
+    uint32x4_t m = vandq_u32(vcleq_f32(a, b), vld1q_u32(lane_bits));
+#if defined(__aarch64__) || defined(_M_ARM64)
+    return vaddvq_u32(m);
+#else
+    uint32x2_t h = vorr_u32(vget_low_u32(m), vget_high_u32(m));
+    return vget_lane_u32(h, 0) | vget_lane_u32(h, 1);
+#endif
+}
+
+#else /* SIMD_SCALAR */
+
+static inline simd_f32 simd_load(const f32 *p)          { return *p; }
+static inline void     simd_store(f32 *p, simd_f32 v)   { *p = v; }
+static inline simd_f32 simd_set1(f32 x)                 { return x; }
+static inline simd_f32 simd_add(simd_f32 a, simd_f32 b) { return a + b; }
+static inline simd_f32 simd_sub(simd_f32 a, simd_f32 b) { return a - b; }
+static inline simd_f32 simd_mul(simd_f32 a, simd_f32 b) { return a * b; }
+static inline simd_f32 simd_madd(simd_f32 a, simd_f32 b, simd_f32 c) { return a * b + c; }
+static inline simd_f32 simd_rsqrt_est(simd_f32 x)       { return 1.0f / sqrtf(x); }
+static inline simd_f32 simd_sign_of(simd_f32 s)         { return (s < 0.0f) ? -1.0f : 1.0f; }
+static inline simd_f32 simd_xor(simd_f32 a, simd_f32 b) { return a * b; }
+static inline u32      simd_le_mask(simd_f32 a, simd_f32 b) { return a <= b; }
+
+#endif
+
+/* Bit i of a simd_le_mask result is lane i. Index of the lowest set bit;
+ * mask must be non-zero. */
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+static inline u32 simd_mask_first(u32 mask) {
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (u32)index;
+}
+#else
+static inline u32 simd_mask_first(u32 mask) { return (u32)__builtin_ctz(mask); }
+#endif
+
+/* a + (b - a) * t */
+static inline simd_f32 simd_lerp(simd_f32 a, simd_f32 b, simd_f32 t) {
+    return simd_madd(simd_sub(b, a), t, a);
+}
+
+/* x with its sign flipped in the lanes where s is negative */
+static inline simd_f32 simd_flip_sign(simd_f32 x, simd_f32 s) {
+    return simd_xor(x, simd_sign_of(s));
+}
+
+/* 1/sqrt(x): hardware estimate refined by Newton-Raphson to ~22 bits,
+ * plenty for renormalizing quaternions */
+static inline simd_f32 simd_rsqrt(simd_f32 x) {
+#if defined(SIMD_SCALAR)
+    return simd_rsqrt_est(x);
+#elif defined(SIMD_NEON)
+    /* The NEON estimate is only ~8 bits; vrsqrtsq does one step each */
+    simd_f32 y = simd_rsqrt_est(x);
+    y = vmulq_f32(y, vrsqrtsq_f32(vmulq_f32(x, y), y));
+    return vmulq_f32(y, vrsqrtsq_f32(vmulq_f32(x, y), y));
+#else
+    simd_f32 y = simd_rsqrt_est(x);
+    simd_f32 yyx = simd_mul(simd_mul(y, y), x);
+    return simd_mul(simd_mul(simd_set1(0.5f), y), simd_sub(simd_set1(3.0f), yyx));
+#endif
+}
+
+#endif /* ENGINE_SIMD_H */
@@ -1,4 +1,9 @@
 #include "gameplay/collision.h"
+#include "core/profile.h"
+#include "core/simd.h"
+
+#include <math.h>
+#include <string.h>
 
 /* --------------------------------------------------------------------------
  * Circle vs circle (squared-distance, no sqrt)
@@ -47,6 +52,7 @@ i32 collision_instances_vs_instances(const InstanceData *a, i32 a_count, f32 a_r
     f32 radii_sq = radii * radii;
     i32 num_hits = 0;
 
+    PROFILE_ZONE_BEGIN("collision_instances_vs_instances");
     for (i32 i = 0; i < a_count && num_hits < max_pairs; i++) {
         f32 ax = a[i].position[0];
         f32 ay = a[i].position[1];
@@ -61,5 +67,271 @@ i32 collision_instances_vs_instances(const InstanceData *a, i32 a_count, f32 a_r
             }
         }
     }
+    PROFILE_ZONE_END();
+    return num_hits;
+}
+
+/* --------------------------------------------------------------------------
+ * Structure-of-arrays kernels
+ *
+ * The inner loop tests SIMD_WIDTH circles of B at once; the lanes that hit
+ * come out of the compare as a bitmask and are written lowest-first, which
+ * keeps the scalar loop's pair order.
+ * ------------------------------------------------------------------------ */
+
+void collision_circles_from_instances(const InstanceData *instances, i32 count,
+                                      f32 *out_x, f32 *out_y)
+{
+    for (i32 i = 0; i < count; i++) {
+        out_x[i] = instances[i].position[0];
+        out_y[i] = instances[i].position[1];
+    }
+}
+
+static inline f32 circle_radius(const CollisionCircles *c, i32 i) {
+    return c->radius ? c->radius[i] : c->uniform_radius;
+}
+
+/* Bitmask of the circles j..j+SIMD_WIDTH-1 of c overlapping (cx, cy, r) */
+static inline u32 circles_hit_mask(const CollisionCircles *c, i32 j,
+                                   simd_f32 cx, simd_f32 cy, simd_f32 r)
+{
+    simd_f32 dx = simd_sub(simd_load(c->x + j), cx);
+    simd_f32 dy = simd_sub(simd_load(c->y + j), cy);
+    simd_f32 d2 = simd_madd(dy, dy, simd_mul(dx, dx));
+    simd_f32 radii = c->radius ? simd_add(simd_load(c->radius + j), r)
+                               : simd_add(simd_set1(c->uniform_radius), r);
+    return simd_le_mask(d2, simd_mul(radii, radii));
+}
+
+i32 collision_circle_vs_circles(f32 cx, f32 cy, f32 radius, const CollisionCircles *circles)
+{
+    simd_f32 vx = simd_set1(cx), vy = simd_set1(cy), vr = simd_set1(radius);
+    i32 n = circles->count;
+    i32 j = 0;
+
+    for (; j + SIMD_WIDTH <= n; j += SIMD_WIDTH) {
+        u32 mask = circles_hit_mask(circles, j, vx, vy, vr);
+        if (mask) return j + (i32)simd_mask_first(mask);
+    }
+    for (; j < n; j++) {
+        if (collision_circle_circle(cx, cy, radius, circles->x[j], circles->y[j],
+                                    circle_radius(circles, j))) {
+            return j;
+        }
+    }
+    return -1;
+}
+
+i32 collision_circles_vs_circles(const CollisionCircles *a, const CollisionCircles *b,
+                                 CollisionPair *out_pairs, i32 max_pairs)
+{
+    i32 num_hits = 0;
+    i32 n = b->count;
+
+    PROFILE_ZONE_BEGIN("collision_circles_vs_circles");
+    for (i32 i = 0; i < a->count && num_hits < max_pairs; i++) {
+        f32 ax = a->x[i], ay = a->y[i], ar = circle_radius(a, i);
+        simd_f32 vx = simd_set1(ax), vy = simd_set1(ay), vr = simd_set1(ar);
+        i32 j = 0;
+
+        for (; j + SIMD_WIDTH <= n && num_hits < max_pairs; j += SIMD_WIDTH) {
+            u32 mask = circles_hit_mask(b, j, vx, vy, vr);
+            while (mask && num_hits < max_pairs) {
+                out_pairs[num_hits].index_a = i;
+                out_pairs[num_hits].index_b = j + (i32)simd_mask_first(mask);
+                num_hits++;
+                mask &= mask - 1;
+            }
+        }
+        for (; j < n && num_hits < max_pairs; j++) {
+            if (collision_circle_circle(ax, ay, ar, b->x[j], b->y[j], circle_radius(b, j))) {
+                out_pairs[num_hits].index_a = i;
+                out_pairs[num_hits].index_b = j;
+                num_hits++;
+            }
+        }
+    }
+    PROFILE_ZONE_END();
+    return num_hits;
+}
+
+/* --------------------------------------------------------------------------
+ * Spatial hash broadphase
+ * ------------------------------------------------------------------------ */
+
+#define GRID_MIN_BUCKETS 16u
+#define GRID_COORD_LIMIT ((f32)(1 << 30))   /* keeps far-off or NaN positions in i32 */
+
+static u32 grid_bucket_count(i32 count) {
+    u32 buckets = GRID_MIN_BUCKETS;
+    while (buckets < (u32)count * 2u && buckets < (1u << 30)) buckets <<= 1;
+    return buckets;
+}
+
+static i32 grid_cell_coord(f32 v, f32 inv_cell_size) {
+    f32 c = floorf(v * inv_cell_size);
+    if (!(c > -GRID_COORD_LIMIT)) c = -GRID_COORD_LIMIT;
+    if (c > GRID_COORD_LIMIT) c = GRID_COORD_LIMIT;
+    return (i32)c;
+}
+
+static u32 grid_cell_hash(i32 cx, i32 cy, u32 mask) {
+    return ((u32)cx * 73856093u ^ (u32)cy * 19349663u) & mask;
+}
+
+size_t collision_grid_memory_size(i32 count) {
+    size_t n = (count > 0) ? (size_t)count : 0;
+    size_t buckets = grid_bucket_count(count > 0 ? count : 0);
+    /* bucket_start + visit, then bucket scratch + entries + points, plus
+     * alignment padding for each of the five allocations */
+    return sizeof(u32) * (2 * buckets + 1) + n * (2 * sizeof(u32) + 2 * sizeof(f32)) + 5 * 16;
+}
+
+EngineResult collision_grid_build(CollisionGrid *grid, Arena *arena,
+                                  const InstanceData *instances, i32 count,
+                                  f32 radius, f32 cell_size)
+{
+    memset(grid, 0, sizeof(*grid));
+    if (count < 0) count = 0;
+    if (cell_size <= 0.0f) cell_size = 2.0f * radius;
+    if (cell_size <= 0.0f) cell_size = 1.0f;
+
+    PROFILE_ZONE_BEGIN("collision_grid_build");
+    u32 buckets  = grid_bucket_count(count);
+    u32 *bucket_of    = arena_push_array_nozero(arena, u32, count ? count : 1);
+    u32 *bucket_start = arena_push_array(arena, u32, buckets + 1);
+    u32 *visit        = arena_push_array(arena, u32, buckets);
+    u32 *entries      = arena_push_array_nozero(arena, u32, count ? count : 1);
+    f32 (*points)[2]  = (f32 (*)[2])arena_alloc_nozero(arena, sizeof(f32) * 2 * (count ? count : 1),
+                                                       _Alignof(f32));
+    if (!bucket_of || !bucket_start || !visit || !entries || !points) {
+        PROFILE_ZONE_END();
+        return ENGINE_ERROR_OUT_OF_MEMORY;
+    }
+
+    grid->inv_cell_size = 1.0f / cell_size;
+    grid->bucket_mask   = buckets - 1;
+    grid->bucket_start  = bucket_start;
+    grid->entries       = entries;
+    grid->points        = points;
+    grid->visit         = visit;
+    grid->count         = count;
+    grid->radius        = radius;
+
+    /* Counting sort by bucket; filling in index order keeps each bucket's
+     * entries ascending, which the query relies on for ordered output */
+    for (i32 i = 0; i < count; i++) {
+        i32 cx = grid_cell_coord(instances[i].position[0], grid->inv_cell_size);
+        i32 cy = grid_cell_coord(instances[i].position[1], grid->inv_cell_size);
+        bucket_of[i] = grid_cell_hash(cx, cy, grid->bucket_mask);
+        bucket_start[bucket_of[i] + 1]++;
+    }
+    for (u32 b = 0; b < buckets; b++) bucket_start[b + 1] += bucket_start[b];
+
+    for (i32 i = 0; i < count; i++) {
+        u32 b    = bucket_of[i];
+        u32 slot = bucket_start[b] + visit[b]++;   /* visit doubles as fill cursor */
+        entries[slot]   = (u32)i;
+        points[slot][0] = instances[i].position[0];
+        points[slot][1] = instances[i].position[1];
+    }
+    memset(visit, 0, sizeof(u32) * buckets);
+    PROFILE_ZONE_END();
+    return ENGINE_SUCCESS;
+}
+
+/* Insert into one A instance's run of hits, kept sorted by index_b. A full
+ * run drops its largest index_b so the result matches the brute-force
+ * loop's first-max_pairs cut. */
+static void grid_insert_hit(CollisionPair *run, i32 *len, i32 cap, i32 index_a, i32 index_b) {
+    i32 n = *len;
+    if (n == cap) {
+        if (index_b > run[n - 1].index_b) return;
+        n--;
+    }
+    i32 k = n;
+    while (k > 0 && run[k - 1].index_b > index_b) {
+        run[k] = run[k - 1];
+        k--;
+    }
+    run[k].index_a = index_a;
+    run[k].index_b = index_b;
+    *len = n + 1;
+}
+
+static void grid_scan(const CollisionGrid *grid, u32 first, u32 end, f32 ax, f32 ay,
+                      f32 radii_sq, i32 index_a, CollisionPair *run, i32 *len, i32 cap)
+{
+    for (u32 e = first; e < end; e++) {
+        f32 dx = grid->points[e][0] - ax;
+        f32 dy = grid->points[e][1] - ay;
+        if (dx * dx + dy * dy <= radii_sq) {
+            grid_insert_hit(run, len, cap, index_a, (i32)grid->entries[e]);
+        }
+    }
+}
+
+i32 collision_grid_query_pairs(CollisionGrid *grid,
+                               const InstanceData *a, i32 a_count, f32 a_radius,
+                               CollisionPair *out_pairs, i32 max_pairs)
+{
+    if (grid->count == 0 || max_pairs <= 0) return 0;
+
+    f32 reach    = a_radius + grid->radius;
+    f32 radii_sq = reach * reach;
+    u32 buckets  = grid->bucket_mask + 1;
+    i32 num_hits = 0;
+
+    PROFILE_ZONE_BEGIN("collision_grid_query_pairs");
+    for (i32 i = 0; i < a_count && num_hits < max_pairs; i++) {
+        f32 ax = a[i].position[0];
+        f32 ay = a[i].position[1];
+        CollisionPair *run = out_pairs + num_hits;
+        i32 cap = max_pairs - num_hits;
+        i32 len = 0;
+
+        i32 x0 = grid_cell_coord(ax - reach, grid->inv_cell_size);
+        i32 x1 = grid_cell_coord(ax + reach, grid->inv_cell_size);
+        i32 y0 = grid_cell_coord(ay - reach, grid->inv_cell_size);
+        i32 y1 = grid_cell_coord(ay + reach, grid->inv_cell_size);
+        u64 cells = (u64)((i64)x1 - x0 + 1) * (u64)((i64)y1 - y0 + 1);
+
+        if (cells >= buckets) {
+            /* Query covers at least as many cells as there are buckets */
+            grid_scan(grid, 0, (u32)grid->count, ax, ay, radii_sq, i, run, &len, cap);
+        } else {
+            /* Several cells can hash to one bucket; visit each once */
+            if (++grid->stamp == 0) {
+                memset(grid->visit, 0, sizeof(u32) * buckets);
+                grid->stamp = 1;
+            }
+            for (i32 cy = y0; cy <= y1; cy++) {
+                for (i32 cx = x0; cx <= x1; cx++) {
+                    u32 b = grid_cell_hash(cx, cy, grid->bucket_mask);
+                    if (grid->visit[b] == grid->stamp) continue;
+                    grid->visit[b] = grid->stamp;
+                    grid_scan(grid, grid->bucket_start[b], grid->bucket_start[b + 1],
+                              ax, ay, radii_sq, i, run, &len, cap);
+                }
+            }
+        }
+        num_hits += len;
+    }
+    PROFILE_ZONE_END();
     return num_hits;
 }
+
+i32 collision_instances_vs_instances_grid(const InstanceData *a, i32 a_count, f32 a_radius,
+                                          const InstanceData *b, i32 b_count, f32 b_radius,
+                                          CollisionPair *out_pairs, i32 max_pairs,
+                                          Arena *scratch)
+{
+    CollisionGrid grid;
+    if (collision_grid_build(&grid, scratch, b, b_count, b_radius, a_radius + b_radius)
+            != ENGINE_SUCCESS) {
+        return collision_instances_vs_instances(a, a_count, a_radius, b, b_count, b_radius,
+                                                out_pairs, max_pairs);
+    }
+    return collision_grid_query_pairs(&grid, a, a_count, a_radius, out_pairs, max_pairs);
+}
@@ -2,6 +2,7 @@
 #define ENGINE_COLLISION_H
 
 #include "core/common.h"
+#include "core/arena.h"
 #include "renderer/renderer_types.h"
 
 /* ---- Collision pair (returned by batch checks) ---- */
@@ -37,4 +38,76 @@ i32 collision_instances_vs_instances(const InstanceData *a, i32 a_count, f32 a_r
                                      const InstanceData *b, i32 b_count, f32 b_radius,
                                      CollisionPair *out_pairs, i32 max_pairs);
 
+/* ---- Structure-of-arrays input ----
+ * Positions as separate x[] / y[] arrays, so the narrowphase streams only
+ * the floats it tests and checks SIMD_WIDTH circles per instruction (AVX2,
+ * SSE2 or NEON, see core/simd.h). Arrays need no padding or alignment. */
+
+typedef struct {
+    const f32 *x;
+    const f32 *y;
+    const f32 *radius;          /* per-circle radii, or NULL for uniform_radius */
+    f32        uniform_radius;
+    i32        count;
+} CollisionCircles;
+
+/* Copy instance positions into caller-owned x[] / y[] arrays (count each) */
+void collision_circles_from_instances(const InstanceData *instances, i32 count,
+                                      f32 *out_x, f32 *out_y);
+
+/* SoA collision_circle_vs_instances: index of the FIRST circle overlapping
+ * (cx, cy, radius), or -1 */
+i32 collision_circle_vs_circles(f32 cx, f32 cy, f32 radius, const CollisionCircles *circles);
+
+/* SoA collision_instances_vs_instances: same pair order and max_pairs cut */
+i32 collision_circles_vs_circles(const CollisionCircles *a, const CollisionCircles *b,
+                                 CollisionPair *out_pairs, i32 max_pairs);
+
+/* ---- Spatial hash broadphase ----
+ * Bins one instance array into a hashed uniform grid, rebuilt from scratch
+ * each frame (O(n) counting sort, no per-cell lists). Cells are stored
+ * contiguously per bucket with a packed copy of each position, so a query
+ * touches a few short runs instead of the whole array. All storage comes
+ * from the caller's arena. */
+
+typedef struct {
+    f32        inv_cell_size;
+    u32        bucket_mask;     /* bucket count - 1 (power of two) */
+    u32       *bucket_start;    /* [bucket count + 1] offsets into entries */
+    u32       *entries;         /* [count] instance indices, ascending per bucket */
+    f32      (*points)[2];      /* [count] positions in entries order */
+    u32       *visit;           /* [bucket count] query stamps (dedupes buckets) */
+    u32        stamp;
+    i32        count;
+    f32        radius;          /* uniform radius of the binned instances */
+} CollisionGrid;
+
+/* Arena bytes collision_grid_build needs for `count` instances */
+size_t collision_grid_memory_size(i32 count);
+
+/* Bin `instances` (uniform `radius`) into cells of `cell_size`. A cell size
+ * of about the largest query radius + radius keeps queries at 3x3 cells; 0
+ * picks 2 * radius. Returns ENGINE_ERROR_OUT_OF_MEMORY if the arena is too
+ * small (grid left empty). */
+EngineResult collision_grid_build(CollisionGrid *grid, Arena *arena,
+                                  const InstanceData *instances, i32 count,
+                                  f32 radius, f32 cell_size);
+
+/* Test every a[i] against the binned instances. Same output as
+ * collision_instances_vs_instances with the binned array as B: pairs sorted
+ * by index_a then index_b, and when max_pairs is reached the first
+ * max_pairs of that order are kept. Updates the grid's query stamps, so one
+ * grid must not be queried from several threads at once. */
+i32 collision_grid_query_pairs(CollisionGrid *grid,
+                               const InstanceData *a, i32 a_count, f32 a_radius,
+                               CollisionPair *out_pairs, i32 max_pairs);
+
+/* Drop-in for collision_instances_vs_instances: builds a grid over B in
+ * `scratch` (caller resets it) and queries A. Falls back to the brute-force
+ * loop if the arena is too small. */
+i32 collision_instances_vs_instances_grid(const InstanceData *a, i32 a_count, f32 a_radius,
+                                          const InstanceData *b, i32 b_count, f32 b_radius,
+                                          CollisionPair *out_pairs, i32 max_pairs,
+                                          Arena *scratch);
+
 #endif /* ENGINE_COLLISION_H */
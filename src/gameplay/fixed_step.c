@@ -0,0 +1,88 @@
+#include "gameplay/fixed_step.h"
+
+#include <math.h>
+
+#define PI      3.14159265f
+#define TWO_PI  6.28318530f
+
+void fixed_step_init(FixedStep *fs, f64 hz, u32 max_steps) {
+    fs->step        = hz > 0.0 ? 1.0 / hz : 1.0 / 60.0;
+    fs->accumulator = 0.0;
+    fs->max_steps   = max_steps ? max_steps : FIXED_STEP_DEFAULT_MAX_STEPS;
+    fs->steps       = 0;
+    fs->dropped     = 0.0;
+}
+
+u32 fixed_step_advance(FixedStep *fs, f64 frame_seconds) {
+    /* A clock going backwards (or NaN) adds nothing */
+    if (frame_seconds > 0.0) fs->accumulator += frame_seconds;
+
+    f64 due = floor(fs->accumulator / fs->step);
+    u32 steps = due < (f64)fs->max_steps ? (u32)due : fs->max_steps;
+    if (due > (f64)steps) fs->dropped += (due - (f64)steps) * fs->step;
+
+    /* Keep only the fraction of a step: the dropped backlog is gone, but
+     * the phase within the step (and so alpha) stays continuous */
+    fs->accumulator -= due * fs->step;
+    if (fs->accumulator < 0.0) fs->accumulator = 0.0;
+
+    fs->steps += steps;
+    return steps;
+}
+
+f32 fixed_step_alpha(const FixedStep *fs) {
+    f32 alpha = (f32)(fs->accumulator / fs->step);
+    return ENGINE_CLAMP(alpha, 0.0f, 1.0f);
+}
+
+f64 fixed_step_time(const FixedStep *fs) {
+    return (f64)fs->steps * fs->step;
+}
+
+/* ---- Interpolation ---- */
+
+static inline f32 lerp(f32 a, f32 b, f32 t) {
+    return a + (b - a) * t;
+}
+
+/* Angles are unbounded (spins accumulate), so only the wrapped difference
+ * is interpolated */
+static inline f32 lerp_angle(f32 a, f32 b, f32 t) {
+    f32 d = b - a;
+    if (d > PI || d < -PI) d -= TWO_PI * floorf((d + PI) / TWO_PI);
+    return a + d * t;
+}
+
+void fixed_step_lerp_instances(InstanceData *dst, const InstanceData *prev,
+                               const InstanceData *curr, u32 count, f32 alpha) {
+    for (u32 i = 0; i < count; i++) {
+        const InstanceData *a = &prev[i];
+        const InstanceData *b = &curr[i];
+        InstanceData       *d = &dst[i];
+        d->position[0]  = lerp(a->position[0], b->position[0], alpha);
+        d->position[1]  = lerp(a->position[1], b->position[1], alpha);
+        d->rotation     = lerp_angle(a->rotation, b->rotation, alpha);
+        d->scale[0]     = lerp(a->scale[0], b->scale[0], alpha);
+        d->scale[1]     = lerp(a->scale[1], b->scale[1], alpha);
+        d->color[0]     = b->color[0];
+        d->color[1]     = b->color[1];
+        d->color[2]     = b->color[2];
+        d->uv_offset[0] = b->uv_offset[0];
+        d->uv_offset[1] = b->uv_offset[1];
+        d->uv_scale[0]  = b->uv_scale[0];
+        d->uv_scale[1]  = b->uv_scale[1];
+    }
+}
+
+void fixed_step_lerp_instances_3d(InstanceData3D *dst, const InstanceData3D *prev,
+                                  const InstanceData3D *curr, u32 count, f32 alpha) {
+    for (u32 i = 0; i < count; i++) {
+        const InstanceData3D *a = &prev[i];
+        const InstanceData3D *b = &curr[i];
+        InstanceData3D       *d = &dst[i];
+        for (u32 k = 0; k < 3; k++) d->position[k] = lerp(a->position[k], b->position[k], alpha);
+        for (u32 k = 0; k < 3; k++) d->rotation[k] = lerp_angle(a->rotation[k], b->rotation[k], alpha);
+        for (u32 k = 0; k < 3; k++) d->scale[k]    = lerp(a->scale[k], b->scale[k], alpha);
+        for (u32 k = 0; k < 3; k++) d->color[k]    = b->color[k];
+    }
+}
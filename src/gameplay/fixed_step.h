@@ -0,0 +1,57 @@
+#ifndef ENGINE_FIXED_STEP_H
+#define ENGINE_FIXED_STEP_H
+
+#include "core/common.h"
+#include "renderer/renderer_types.h"
+
+/* ---- Fixed-timestep simulation ----
+ * Runs gameplay at a fixed rate independent of the render rate. Each frame
+ * feeds its elapsed time to fixed_step_advance, simulates the returned
+ * number of steps of fs.step seconds each, then renders the state blended
+ * between the last two steps by fixed_step_alpha:
+ *
+ *   u32 steps = fixed_step_advance(&fs, frame_seconds);
+ *   for (u32 i = 0; i < steps; i++) {
+ *       memcpy(prev, curr, sizeof(curr));
+ *       simulate(curr, (f32)fs.step);
+ *   }
+ *   fixed_step_lerp_instances(draw, prev, curr, count, fixed_step_alpha(&fs));
+ *
+ * Rendering therefore trails the simulation by up to one step. After a
+ * long stall only max_steps run and the rest of the backlog is dropped, so
+ * a slow frame never schedules an even slower one. */
+
+#define FIXED_STEP_DEFAULT_MAX_STEPS 8
+
+typedef struct {
+    f64 step;          /* seconds per simulation step */
+    f64 accumulator;   /* time not yet simulated, in [0, step) */
+    u32 max_steps;     /* per advance */
+    u64 steps;         /* steps handed out so far */
+    f64 dropped;       /* seconds discarded by the max_steps clamp */
+} FixedStep;
+
+/* hz: simulation rate (e.g. 60). max_steps 0 = FIXED_STEP_DEFAULT_MAX_STEPS. */
+void fixed_step_init(FixedStep *fs, f64 hz, u32 max_steps);
+
+/* Add a frame's elapsed time; returns how many steps to simulate now */
+u32  fixed_step_advance(FixedStep *fs, f64 frame_seconds);
+
+/* How far rendering sits between the previous step (0) and the latest (1) */
+f32  fixed_step_alpha(const FixedStep *fs);
+
+/* Simulated time: steps * step, free of frame-rate jitter */
+f64  fixed_step_time(const FixedStep *fs);
+
+/* ---- Interpolation ----
+ * dst = prev + (curr - prev) * alpha for position, rotation and scale;
+ * rotations take the shorter way around. Color and UVs are discrete state
+ * (flashes, sprite frames) and come from curr. dst may be memory from
+ * renderer_alloc_instances: every field is written once, in order. */
+
+void fixed_step_lerp_instances(InstanceData *dst, const InstanceData *prev,
+                               const InstanceData *curr, u32 count, f32 alpha);
+void fixed_step_lerp_instances_3d(InstanceData3D *dst, const InstanceData3D *prev,
+                                  const InstanceData3D *curr, u32 count, f32 alpha);
+
+#endif /* ENGINE_FIXED_STEP_H */
@@ -0,0 +1,219 @@
+#include "gameplay/gameobject.h"
+#include "core/jobs.h"
+#include "core/log.h"
+#include "core/profile.h"
+
+#include <string.h>
+
+#define NO_KEY 0xFFFF
+
+/* ---- Setup ---- */
+
+EngineResult gameobject_register(World *world, GameObjectTypes *out_types) {
+    GameObjectTypes t;
+    t.transform  = WORLD_REGISTER(world, Transform2D);
+    t.velocity   = WORLD_REGISTER(world, Velocity2D);
+    t.renderable = WORLD_REGISTER(world, Renderable2D);
+    t.lifetime   = WORLD_REGISTER(world, Lifetime);
+    if (t.transform == COMPONENT_INVALID || t.velocity == COMPONENT_INVALID ||
+        t.renderable == COMPONENT_INVALID || t.lifetime == COMPONENT_INVALID) {
+        return ENGINE_ERROR_GENERIC;
+    }
+    *out_types = t;
+    return ENGINE_SUCCESS;
+}
+
+Entity gameobject_spawn(World *world, const GameObjectTypes *types,
+                        const GameObjectDesc *desc) {
+    ComponentMask mask = COMPONENT_BIT(types->transform) | COMPONENT_BIT(types->renderable);
+    if (desc->moving)         mask |= COMPONENT_BIT(types->velocity);
+    if (desc->lifetime > 0.0f) mask |= COMPONENT_BIT(types->lifetime);
+
+    Entity e = world_spawn(world, mask);
+    if (e == ENTITY_INVALID) return e;
+
+    *(Transform2D *)world_get(world, e, types->transform)   = desc->transform;
+    *(Renderable2D *)world_get(world, e, types->renderable) = desc->renderable;
+    if (desc->moving) {
+        *(Velocity2D *)world_get(world, e, types->velocity) = desc->velocity;
+    }
+    if (desc->lifetime > 0.0f) {
+        ((Lifetime *)world_get(world, e, types->lifetime))->remaining = desc->lifetime;
+    }
+    return e;
+}
+
+/* ---- Systems ---- */
+
+typedef struct {
+    const GameObjectTypes *types;
+    f32                    dt;
+} StepParams;
+
+static void expire_chunk(const WorldChunk *chunk, void *user) {
+    const StepParams *p = user;
+    Lifetime *life = WORLD_COLUMN(chunk, Lifetime, p->types->lifetime);
+
+    for (u32 i = 0; i < chunk->count; i++) {
+        life[i].remaining -= p->dt;
+        if (life[i].remaining <= 0.0f) world_defer_despawn(chunk->world, chunk->entities[i]);
+    }
+}
+
+void gameobject_expire(World *world, const GameObjectTypes *types, f32 dt) {
+    PROFILE_ZONE_BEGIN("gameobject_expire");
+    StepParams p = { types, dt };
+    world_each_parallel(world, (WorldQuery){ COMPONENT_BIT(types->lifetime), 0 },
+                        expire_chunk, &p);
+    world_flush(world);
+    PROFILE_ZONE_END();
+}
+
+static void integrate_chunk(const WorldChunk *chunk, void *user) {
+    const StepParams *p = user;
+    Transform2D      *xf  = WORLD_COLUMN(chunk, Transform2D, p->types->transform);
+    const Velocity2D *vel = WORLD_COLUMN(chunk, Velocity2D, p->types->velocity);
+    f32 dt = p->dt;
+
+    for (u32 i = 0; i < chunk->count; i++) {
+        xf[i].position[0] += vel[i].linear[0] * dt;
+        xf[i].position[1] += vel[i].linear[1] * dt;
+        xf[i].rotation    += vel[i].angular   * dt;
+    }
+}
+
+void gameobject_integrate(World *world, const GameObjectTypes *types, f32 dt) {
+    PROFILE_ZONE_BEGIN("gameobject_integrate");
+    StepParams p = { types, dt };
+    WorldQuery q = { COMPONENT_BIT(types->transform) | COMPONENT_BIT(types->velocity), 0 };
+    world_each_parallel(world, q, integrate_chunk, &p);
+    PROFILE_ZONE_END();
+}
+
+/* ---- Drawing ----
+ * Two passes over the matching chunks. The first tags every row with its
+ * (mesh, texture) batch and counts the batches; the second allocates each
+ * batch from the renderer and writes its rows straight into the instance
+ * buffer. An allocation is only valid until the next one, so batches are
+ * filled one after another, each scanning just the rows between its first
+ * and last member (objects spawned together are usually contiguous). */
+
+typedef struct {
+    MeshHandle    mesh;
+    TextureHandle texture;
+    u32           count;
+    u32           first_row;  /* global row index across the chunk list */
+    u32           last_row;
+    u32           first_chunk;
+} DrawKey;
+
+static void write_instance(InstanceData *dst, const Transform2D *xf, const Renderable2D *r) {
+    /* Field order matches InstanceData: the destination is write-combined */
+    dst->position[0]  = xf->position[0];
+    dst->position[1]  = xf->position[1];
+    dst->rotation     = xf->rotation;
+    dst->scale[0]     = xf->scale[0];
+    dst->scale[1]     = xf->scale[1];
+    dst->color[0]     = r->color[0];
+    dst->color[1]     = r->color[1];
+    dst->color[2]     = r->color[2];
+    dst->uv_offset[0] = r->uv_offset[0];
+    dst->uv_offset[1] = r->uv_offset[1];
+    dst->uv_scale[0]  = r->uv_scale[0];
+    dst->uv_scale[1]  = r->uv_scale[1];
+}
+
+void gameobject_draw(World *world, const GameObjectTypes *types, Renderer *renderer) {
+    PROFILE_ZONE_BEGIN("gameobject_draw");
+    WorldQuery q = { COMPONENT_BIT(types->transform) | COMPONENT_BIT(types->renderable), 0 };
+
+    Arena     *scratch     = jobs_scratch();
+    ArenaMark  mark        = arena_mark(scratch);
+    u32        chunk_count = world_collect_chunks(world, q, NULL, 0);
+    u32        row_count   = world_query_count(world, q);
+    WorldChunk *chunks     = arena_push_array_nozero(scratch, WorldChunk, chunk_count);
+    u32        *chunk_rows = arena_push_array_nozero(scratch, u32, chunk_count);  /* first row */
+    u16        *row_key    = arena_push_array_nozero(scratch, u16, row_count);
+    if (row_count == 0 || !chunks || !chunk_rows || !row_key) {
+        arena_pop_to(scratch, mark);
+        PROFILE_ZONE_END();
+        return;
+    }
+    world_collect_chunks(world, q, chunks, chunk_count);
+
+    DrawKey keys[GAMEOBJECT_DRAW_KEYS];
+    u32     key_count = 0;
+    u32     overflow  = 0;
+
+    /* Pass 1: assign rows to batches */
+    u32 row = 0;
+    u32 hit = 0;  /* last batch found: runs of one batch are the common case */
+    for (u32 c = 0; c < chunk_count; c++) {
+        const Renderable2D *rend = WORLD_COLUMN(&chunks[c], Renderable2D, types->renderable);
+        chunk_rows[c] = row;
+
+        for (u32 i = 0; i < chunks[c].count; i++, row++) {
+            MeshHandle    mesh    = rend[i].mesh;
+            TextureHandle texture = rend[i].texture;
+            if (hit >= key_count || keys[hit].mesh != mesh || keys[hit].texture != texture) {
+                for (hit = 0; hit < key_count; hit++) {
+                    if (keys[hit].mesh == mesh && keys[hit].texture == texture) break;
+                }
+                if (hit == key_count) {
+                    if (key_count == GAMEOBJECT_DRAW_KEYS) {
+                        row_key[row] = NO_KEY;
+                        overflow++;
+                        continue;
+                    }
+                    keys[key_count++] = (DrawKey){ mesh, texture, 0, row, row, c };
+                }
+            }
+            keys[hit].count++;
+            keys[hit].last_row = row;
+            row_key[row] = (u16)hit;
+        }
+    }
+
+    /* Pass 2: one in-place draw per batch */
+    for (u32 k = 0; k < key_count; k++) {
+        const DrawKey *key = &keys[k];
+        InstanceData *dst = renderer_alloc_instances_textured(renderer, key->mesh, key->texture,
+                                                              key->count);
+        if (!dst) continue;
+
+        for (u32 c = key->first_chunk; c < chunk_count && chunk_rows[c] <= key->last_row; c++) {
+            const Transform2D  *xf   = WORLD_COLUMN(&chunks[c], Transform2D, types->transform);
+            const Renderable2D *rend = WORLD_COLUMN(&chunks[c], Renderable2D, types->renderable);
+            const u16          *tags = row_key + chunk_rows[c];
+
+            for (u32 i = 0; i < chunks[c].count; i++) {
+                if (tags[i] == k) write_instance(dst++, &xf[i], &rend[i]);
+            }
+        }
+    }
+
+    /* Batches beyond the table go out one draw per object */
+    if (overflow > 0) {
+        static bool warned = false;
+        if (!warned) {
+            LOG_WARN("gameobject_draw: more than %d (mesh, texture) pairs; "
+                     "extra objects are drawn individually", GAMEOBJECT_DRAW_KEYS);
+            warned = true;
+        }
+        for (u32 c = 0; c < chunk_count; c++) {
+            const Transform2D  *xf   = WORLD_COLUMN(&chunks[c], Transform2D, types->transform);
+            const Renderable2D *rend = WORLD_COLUMN(&chunks[c], Renderable2D, types->renderable);
+            const u16          *tags = row_key + chunk_rows[c];
+
+            for (u32 i = 0; i < chunks[c].count; i++) {
+                if (tags[i] != NO_KEY) continue;
+                InstanceData *dst = renderer_alloc_instances_textured(renderer, rend[i].mesh,
+                                                                      rend[i].texture, 1);
+                if (dst) write_instance(dst, &xf[i], &rend[i]);
+            }
+        }
+    }
+
+    arena_pop_to(scratch, mark);
+    PROFILE_ZONE_END();
+}
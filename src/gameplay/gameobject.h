@@ -0,0 +1,76 @@
+#ifndef ENGINE_GAMEOBJECT_H
+#define ENGINE_GAMEOBJECT_H
+
+#include "core/common.h"
+#include "gameplay/world.h"
+#include "renderer/renderer.h"
+
+/* ---- Standard 2D game objects ----
+ * Common components and the systems that drive them, on top of World.
+ * A game registers them once, spawns objects from a GameObjectDesc and each
+ * frame runs expire -> integrate -> draw. Games add their own components
+ * (health, AI state, ...) to the same world and query them alongside. */
+
+#define GAMEOBJECT_DRAW_KEYS 256  /* distinct (mesh, texture) pairs batched per draw */
+
+typedef struct {
+    f32 position[2];
+    f32 rotation;     /* radians */
+    f32 scale[2];
+} Transform2D;
+
+typedef struct {
+    f32 linear[2];    /* units per second */
+    f32 angular;      /* radians per second */
+} Velocity2D;
+
+/* How the object is drawn: one instance of `mesh`, sampling `texture`
+ * (TEXTURE_HANDLE_INVALID = untextured) */
+typedef struct {
+    MeshHandle    mesh;
+    TextureHandle texture;
+    f32           color[3];
+    f32           uv_offset[2];
+    f32           uv_scale[2];   /* 0,0 = full texture */
+} Renderable2D;
+
+/* Despawned once `remaining` seconds have passed */
+typedef struct {
+    f32 remaining;
+} Lifetime;
+
+typedef struct {
+    ComponentId transform;
+    ComponentId velocity;
+    ComponentId renderable;
+    ComponentId lifetime;
+} GameObjectTypes;
+
+typedef struct {
+    Transform2D  transform;
+    Renderable2D renderable;
+    Velocity2D   velocity;
+    bool         moving;     /* attach velocity */
+    f32          lifetime;   /* seconds; 0 = until despawned */
+} GameObjectDesc;
+
+/* Register the components above in `world` */
+EngineResult gameobject_register(World *world, GameObjectTypes *out_types);
+
+/* Spawn an object with a transform and renderable, plus velocity and
+ * lifetime when the desc asks for them */
+Entity       gameobject_spawn(World *world, const GameObjectTypes *types,
+                              const GameObjectDesc *desc);
+
+/* Advance lifetimes and despawn expired objects (parallel over chunks) */
+void         gameobject_expire(World *world, const GameObjectTypes *types, f32 dt);
+
+/* Move every object with a velocity (parallel over chunks) */
+void         gameobject_integrate(World *world, const GameObjectTypes *types, f32 dt);
+
+/* Queue every renderable object, one instanced draw per (mesh, texture)
+ * written in place into the frame's instance buffer. Call between
+ * begin_frame and end_frame. */
+void         gameobject_draw(World *world, const GameObjectTypes *types, Renderer *renderer);
+
+#endif /* ENGINE_GAMEOBJECT_H */
@@ -0,0 +1,310 @@
+#include "gameplay/particle_system.h"
+#include "core/simd.h"
+#include "core/log.h"
+#include "core/profile.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#define TWO_PI            6.28318530f
+#define MAX_STEP_SPAWN    65536  /* cap on particles one emitter spawns per update */
+
+typedef struct {
+    ParticleEmitter shape;
+    f32             rate;         /* particles per second */
+    f32             accumulator;  /* fractional particles owed */
+    bool            in_use;
+} ContinuousEmitter;
+
+/* Structure-of-arrays pool: each array holds SIMD_PAD(capacity) floats so
+ * the update loop can run whole vectors past the live count */
+struct ParticleSystem {
+    ParticleSimMode    mode;
+    i32                capacity;
+    i32                count;
+    MeshHandle         mesh;
+    TextureHandle      texture;
+    u32                rng;
+
+    f32 *pos_x, *pos_y;
+    f32 *vel_x, *vel_y;
+    f32 *color_r, *color_g, *color_b;
+    f32 *lifetime, *max_lifetime;
+    f32 *rotation, *angular_velocity;
+    f32 *scale;
+    f32 *storage;
+
+    Renderer          *renderer;   /* GPU mode */
+    GpuParticlesHandle gpu;
+
+    ContinuousEmitter  emitters[PARTICLE_SYSTEM_MAX_EMITTERS];
+};
+
+/* --------------------------------------------------------------------------
+ * Helpers
+ * ------------------------------------------------------------------------ */
+
+/* xorshift32: per-system and reproducible, unlike rand() */
+static f32 rand_range(ParticleSystem *ps, f32 min, f32 max) {
+    u32 x = ps->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    ps->rng = x;
+    return min + (f32)(x >> 8) * (1.0f / 16777216.0f) * (max - min);
+}
+
+static ContinuousEmitter *get_emitter(ParticleSystem *ps, ParticleEmitterHandle h) {
+    if (h >= PARTICLE_SYSTEM_MAX_EMITTERS || !ps->emitters[h].in_use) return NULL;
+    return &ps->emitters[h];
+}
+
+/* Append num particles from `e` on the CPU. With spread, directions are
+ * evenly spaced around the circle as in particles_emit; otherwise random. */
+static i32 spawn_cpu(ParticleSystem *ps, const ParticleEmitter *e, i32 num, bool spread) {
+    i32 space = ps->capacity - ps->count;
+    if (num > space) num = space;
+    if (num <= 0) return 0;
+
+    f32 angle_step = TWO_PI / (f32)num;
+    for (i32 k = 0; k < num; k++) {
+        i32 i = ps->count + k;
+
+        f32 angle = spread ? (f32)k * angle_step + rand_range(ps, -0.15f, 0.15f)
+                           : rand_range(ps, 0.0f, TWO_PI);
+        f32 speed = rand_range(ps, e->speed_min, e->speed_max);
+
+        ps->pos_x[i]   = e->position[0];
+        ps->pos_y[i]   = e->position[1];
+        ps->vel_x[i]   = cosf(angle) * speed;
+        ps->vel_y[i]   = sinf(angle) * speed;
+        ps->color_r[i] = e->color[0];
+        ps->color_g[i] = e->color[1];
+        ps->color_b[i] = e->color[2];
+
+        ps->lifetime[i]         = rand_range(ps, e->lifetime_min, e->lifetime_max);
+        ps->max_lifetime[i]     = ps->lifetime[i];
+        ps->rotation[i]         = rand_range(ps, 0.0f, TWO_PI);
+        ps->angular_velocity[i] = rand_range(ps, e->angular_velocity_min,
+                                             e->angular_velocity_max);
+        ps->scale[i] = e->scale;
+    }
+
+    ps->count += num;
+    return num;
+}
+
+static i32 spawn(ParticleSystem *ps, const ParticleEmitter *e, i32 num, bool spread) {
+    if (ps->mode == PARTICLE_SIM_CPU) return spawn_cpu(ps, e, num, spread);
+    if (num <= 0) return 0;
+
+    GpuParticleBurst burst = {
+        .position             = { e->position[0], e->position[1] },
+        .color                = { e->color[0], e->color[1], e->color[2] },
+        .count                = (u32)num,
+        .speed_min            = e->speed_min,
+        .speed_max            = e->speed_max,
+        .lifetime_min         = e->lifetime_min,
+        .lifetime_max         = e->lifetime_max,
+        .scale                = e->scale,
+        .angular_velocity_min = e->angular_velocity_min,
+        .angular_velocity_max = e->angular_velocity_max,
+    };
+    return renderer_emit_gpu_particles(ps->renderer, ps->gpu, &burst) ? num : 0;
+}
+
+/* Move the last live particle into slot i */
+static void swap_remove(ParticleSystem *ps, i32 i) {
+    i32 last = --ps->count;
+    f32 *arrays[] = {
+        ps->pos_x, ps->pos_y, ps->vel_x, ps->vel_y,
+        ps->color_r, ps->color_g, ps->color_b,
+        ps->lifetime, ps->max_lifetime, ps->rotation, ps->angular_velocity, ps->scale,
+    };
+    for (u32 a = 0; a < ENGINE_ARRAY_LEN(arrays); a++) arrays[a][i] = arrays[a][last];
+}
+
+static void update_cpu(ParticleSystem *ps, f32 delta_time) {
+    i32 n = ps->count;
+
+    /* Integrate whole vectors; the padding lanes past n hold stale data that
+     * is never read back */
+    simd_f32 dt = simd_set1(delta_time);
+    for (i32 i = 0; i < n; i += SIMD_WIDTH) {
+        simd_store(ps->lifetime + i, simd_sub(simd_load(ps->lifetime + i), dt));
+        simd_store(ps->pos_x + i,    simd_madd(simd_load(ps->vel_x + i), dt, simd_load(ps->pos_x + i)));
+        simd_store(ps->pos_y + i,    simd_madd(simd_load(ps->vel_y + i), dt, simd_load(ps->pos_y + i)));
+        simd_store(ps->rotation + i, simd_madd(simd_load(ps->angular_velocity + i), dt,
+                                               simd_load(ps->rotation + i)));
+    }
+
+    /* Swap-remove the dead, skipping vectors with none */
+    simd_f32 zero = simd_set1(0.0f);
+    for (i32 i = 0; i < ps->count; ) {
+        if (i + SIMD_WIDTH <= ps->count && simd_le_mask(simd_load(ps->lifetime + i), zero) == 0) {
+            i += SIMD_WIDTH;
+            continue;
+        }
+        if (ps->lifetime[i] <= 0.0f) swap_remove(ps, i);
+        else i++;
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Lifecycle
+ * ------------------------------------------------------------------------ */
+
+EngineResult particle_system_create(const ParticleSystemConfig *config, Renderer *renderer,
+                                    ParticleSystem **out_system) {
+    *out_system = NULL;
+    if (config->capacity <= 0) {
+        LOG_ERROR("Particle system capacity must be positive (got %d)", config->capacity);
+        return ENGINE_ERROR_GENERIC;
+    }
+    if (config->mode == PARTICLE_SIM_GPU && !renderer) {
+        LOG_ERROR("GPU particle systems need a renderer");
+        return ENGINE_ERROR_GENERIC;
+    }
+
+    ParticleSystem *ps = calloc(1, sizeof(*ps));
+    if (!ps) return ENGINE_ERROR_OUT_OF_MEMORY;
+
+    ps->mode     = config->mode;
+    ps->capacity = config->capacity;
+    ps->mesh     = config->mesh;
+    ps->texture  = config->texture;
+    ps->rng      = config->seed ? config->seed : 0x2545F491u;
+    ps->renderer = renderer;
+    ps->gpu      = GPU_PARTICLES_HANDLE_INVALID;
+
+    if (ps->mode == PARTICLE_SIM_GPU) {
+        EngineResult res = renderer_create_gpu_particles(renderer, (u32)config->capacity,
+                                                         config->mesh, &ps->gpu);
+        if (res != ENGINE_SUCCESS) {
+            free(ps);
+            return res;
+        }
+        *out_system = ps;
+        return ENGINE_SUCCESS;
+    }
+
+    size_t stride = SIMD_PAD((u32)config->capacity);
+    ps->storage = calloc(stride * 12, sizeof(f32));
+    if (!ps->storage) {
+        free(ps);
+        return ENGINE_ERROR_OUT_OF_MEMORY;
+    }
+
+    f32 **arrays[] = {
+        &ps->pos_x, &ps->pos_y, &ps->vel_x, &ps->vel_y,
+        &ps->color_r, &ps->color_g, &ps->color_b,
+        &ps->lifetime, &ps->max_lifetime, &ps->rotation, &ps->angular_velocity, &ps->scale,
+    };
+    for (u32 a = 0; a < ENGINE_ARRAY_LEN(arrays); a++) *arrays[a] = ps->storage + stride * a;
+
+    *out_system = ps;
+    return ENGINE_SUCCESS;
+}
+
+void particle_system_destroy(ParticleSystem *ps) {
+    if (!ps) return;
+    if (ps->gpu != GPU_PARTICLES_HANDLE_INVALID)
+        renderer_destroy_gpu_particles(ps->renderer, ps->gpu);
+    free(ps->storage);
+    free(ps);
+}
+
+/* --------------------------------------------------------------------------
+ * Emission
+ * ------------------------------------------------------------------------ */
+
+ParticleEmitterHandle particle_system_add_emitter(ParticleSystem *ps,
+                                                  const ParticleEmitter *emitter, f32 rate) {
+    for (u32 i = 0; i < PARTICLE_SYSTEM_MAX_EMITTERS; i++) {
+        ContinuousEmitter *ce = &ps->emitters[i];
+        if (ce->in_use) continue;
+        *ce = (ContinuousEmitter){ .shape = *emitter, .rate = rate, .in_use = true };
+        return i;
+    }
+    LOG_WARN("Particle emitter limit reached (%d)", PARTICLE_SYSTEM_MAX_EMITTERS);
+    return PARTICLE_EMITTER_INVALID;
+}
+
+void particle_system_set_emitter_position(ParticleSystem *ps, ParticleEmitterHandle emitter,
+                                          f32 x, f32 y) {
+    ContinuousEmitter *ce = get_emitter(ps, emitter);
+    if (!ce) return;
+    ce->shape.position[0] = x;
+    ce->shape.position[1] = y;
+}
+
+void particle_system_set_emitter_rate(ParticleSystem *ps, ParticleEmitterHandle emitter,
+                                      f32 rate) {
+    ContinuousEmitter *ce = get_emitter(ps, emitter);
+    if (ce) ce->rate = rate;
+}
+
+void particle_system_remove_emitter(ParticleSystem *ps, ParticleEmitterHandle emitter) {
+    ContinuousEmitter *ce = get_emitter(ps, emitter);
+    if (ce) ce->in_use = false;
+}
+
+i32 particle_system_burst(ParticleSystem *ps, const ParticleEmitter *emitter) {
+    return spawn(ps, emitter, emitter->count, true);
+}
+
+/* --------------------------------------------------------------------------
+ * Per frame
+ * ------------------------------------------------------------------------ */
+
+void particle_system_update(ParticleSystem *ps, f32 delta_time) {
+    PROFILE_ZONE_BEGIN("particle_system_update");
+
+    /* Existing particles step first so new ones start at their emitter */
+    if (ps->mode == PARTICLE_SIM_CPU) update_cpu(ps, delta_time);
+    else renderer_simulate_gpu_particles(ps->renderer, ps->gpu, delta_time);
+
+    for (u32 i = 0; i < PARTICLE_SYSTEM_MAX_EMITTERS; i++) {
+        ContinuousEmitter *ce = &ps->emitters[i];
+        if (!ce->in_use || ce->rate <= 0.0f) continue;
+
+        ce->accumulator += ce->rate * delta_time;
+        f32 owed = floorf(ce->accumulator);
+        if (owed < 1.0f) continue;
+        ce->accumulator -= owed;
+
+        /* Particles that don't fit are dropped, not carried over */
+        spawn(ps, &ce->shape, (i32)ENGINE_MIN(owed, (f32)MAX_STEP_SPAWN), false);
+    }
+
+    PROFILE_ZONE_END();
+}
+
+i32 particle_system_count(const ParticleSystem *ps) {
+    return (ps->mode == PARTICLE_SIM_CPU) ? ps->count : -1;
+}
+
+void particle_system_draw(ParticleSystem *ps, Renderer *renderer) {
+    if (ps->mode == PARTICLE_SIM_GPU) {
+        renderer_draw_gpu_particles(renderer, ps->gpu, ps->texture);
+        return;
+    }
+
+    if (ps->count == 0) return;
+    InstanceData *out = renderer_alloc_instances_textured(renderer, ps->mesh, ps->texture,
+                                                          (u32)ps->count);
+    if (!out) return;
+
+    /* Written straight into the frame's instance buffer, each instance
+     * whole. Same fade as particles_to_instances: linear color, quadratic scale */
+    for (i32 i = 0; i < ps->count; i++) {
+        f32 t = ps->lifetime[i] / ps->max_lifetime[i];
+        f32 s = ps->scale[i] * t * t;
+        out[i] = (InstanceData){
+            .position = { ps->pos_x[i], ps->pos_y[i] },
+            .rotation = ps->rotation[i],
+            .scale    = { s, s },
+            .color    = { ps->color_r[i] * t, ps->color_g[i] * t, ps->color_b[i] * t },
+        };
+    }
+}
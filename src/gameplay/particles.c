@@ -1,4 +1,5 @@
 #include "gameplay/particles.h"
+#include "core/profile.h"
 
 #include <math.h>    /* sinf, cosf */
 #include <stdlib.h>  /* rand, RAND_MAX */
@@ -61,6 +62,7 @@ i32 particles_emit(const ParticleEmitter *emitter,
 
 i32 particles_update(Particle *particles, i32 count, f32 delta_time)
 {
+    PROFILE_ZONE_BEGIN("particles_update");
     for (i32 i = 0; i < count; ) {
         Particle *p = &particles[i];
 
@@ -81,6 +83,7 @@ i32 particles_update(Particle *particles, i32 count, f32 delta_time)
 
         i++;
     }
+    PROFILE_ZONE_END();
 
     return count;
 }
@@ -0,0 +1,522 @@
+#include "gameplay/world.h"
+#include "core/jobs.h"
+#include "core/log.h"
+#include "core/profile.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define INDEX_BITS       22
+#define INDEX_MASK       ((1u << INDEX_BITS) - 1)
+#define GEN_MASK         ((1u << (32 - INDEX_BITS)) - 1)
+#define ENTITY_MAKE(i, g) ((Entity)((i) | ((g) << INDEX_BITS)))
+#define ENTITY_INDEX(e)  ((e) & INDEX_MASK)
+#define ENTITY_GEN(e)    ((e) >> INDEX_BITS)
+
+#define NO_COLUMN        0xFF
+#define NO_ARCHETYPE     0xFFFFFFFF
+#define COLUMN_ALIGN     16    /* column alignment (SIMD loads); also the maximum */
+
+typedef struct {
+    char   name[32];
+    size_t size;
+    size_t align;
+} ComponentInfo;
+
+/* Every chunk is one allocation: `capacity` entity ids, then one column per
+ * component at column_offset. Rows [0, count) of the archetype fill the
+ * chunks in order, so every chunk but the last is full. */
+typedef struct {
+    ComponentMask mask;
+    u32           column_count;
+    u8            column_of[WORLD_MAX_COMPONENTS];  /* component -> column or NO_COLUMN */
+    ComponentId   column_component[WORLD_MAX_COMPONENTS];
+    size_t        column_offset[WORLD_MAX_COMPONENTS];
+    size_t        column_size[WORLD_MAX_COMPONENTS];
+    size_t        chunk_bytes;
+    u32           chunk_capacity;                   /* rows per chunk */
+
+    u8          **chunks;       /* chunks stay allocated once created, for reuse */
+    u32           chunk_count;
+    u32           chunk_alloc;
+    u32           count;        /* live rows */
+} Archetype;
+
+typedef struct {
+    u32 archetype;  /* NO_ARCHETYPE while the index is free */
+    u32 row;
+    u32 generation;
+} EntityRecord;
+
+/* Per-thread despawn queue, padded so threads don't share cache lines */
+typedef struct {
+    Entity *items;
+    u32     count;
+    u32     capacity;
+    u8      pad[64 - sizeof(Entity *) - 2 * sizeof(u32)];
+} DeferList;
+
+struct World {
+    ComponentInfo components[WORLD_MAX_COMPONENTS];
+    u32           component_count;
+
+    Archetype    *archetypes[WORLD_MAX_ARCHETYPES];
+    u32           archetype_count;
+
+    EntityRecord *records;
+    u32           record_count;     /* indices ever handed out */
+    u32           record_capacity;
+    u32          *free_indices;     /* despawned indices, reused LIFO */
+    u32           free_count;
+    u32           live_count;
+
+    DeferList     deferred[JOBS_MAX_THREADS];
+    bool          iterating;        /* a query is running: no structural changes */
+};
+
+/* ---- Helpers ---- */
+
+static size_t align_up(size_t v, size_t a) {
+    return (v + a - 1) & ~(a - 1);
+}
+
+static bool grow_array(void **ptr, u32 *capacity, u32 needed, size_t elem_size) {
+    if (needed <= *capacity) return true;
+    u32 cap = *capacity ? *capacity : 64;
+    while (cap < needed) cap *= 2;
+    void *p = realloc(*ptr, (size_t)cap * elem_size);
+    if (!p) return false;
+    *ptr      = p;
+    *capacity = cap;
+    return true;
+}
+
+static bool structural_allowed(const World *world, const char *op) {
+    if (world->iterating) {
+        LOG_ERROR("world_%s during a query; use world_defer_despawn instead", op);
+        return false;
+    }
+    return true;
+}
+
+/* Lay out `capacity` rows; returns the chunk size in bytes */
+static size_t archetype_layout(Archetype *a, const World *world, u32 capacity) {
+    size_t offset = sizeof(Entity) * (size_t)capacity;
+    for (u32 c = 0; c < a->column_count; c++) {
+        const ComponentInfo *info = &world->components[a->column_component[c]];
+        offset = align_up(offset, COLUMN_ALIGN);
+        a->column_offset[c] = offset;
+        offset += info->size * capacity;
+    }
+    return offset;
+}
+
+/* ---- Archetypes ---- */
+
+static u32 archetype_find(World *world, ComponentMask mask) {
+    for (u32 i = 0; i < world->archetype_count; i++) {
+        if (world->archetypes[i]->mask == mask) return i;
+    }
+
+    if (world->archetype_count == WORLD_MAX_ARCHETYPES) {
+        LOG_ERROR("World archetype limit reached (%d)", WORLD_MAX_ARCHETYPES);
+        return NO_ARCHETYPE;
+    }
+    Archetype *a = calloc(1, sizeof(Archetype));
+    if (!a) return NO_ARCHETYPE;
+
+    a->mask = mask;
+    memset(a->column_of, NO_COLUMN, sizeof(a->column_of));
+    size_t row_bytes = sizeof(Entity);
+    for (u32 id = 0; id < world->component_count; id++) {
+        if (!(mask & COMPONENT_BIT(id))) continue;
+        a->column_of[id] = (u8)a->column_count;
+        a->column_component[a->column_count] = id;
+        a->column_size[a->column_count]      = world->components[id].size;
+        a->column_count++;
+        row_bytes += world->components[id].size;
+    }
+
+    /* As many rows as fit the chunk budget once columns are aligned */
+    u32 capacity = (u32)(WORLD_CHUNK_BYTES / row_bytes);
+    if (capacity == 0) capacity = 1;
+    while (capacity > 1 && archetype_layout(a, world, capacity) > WORLD_CHUNK_BYTES) {
+        capacity--;
+    }
+    a->chunk_capacity = capacity;
+    a->chunk_bytes    = archetype_layout(a, world, capacity);
+
+    world->archetypes[world->archetype_count] = a;
+    return world->archetype_count++;
+}
+
+static inline u8 *archetype_chunk(const Archetype *a, u32 row) {
+    return a->chunks[row / a->chunk_capacity];
+}
+
+static inline void *archetype_cell(const Archetype *a, u32 column, u32 row) {
+    u8 *chunk = archetype_chunk(a, row);
+    return chunk + a->column_offset[column] + a->column_size[column] * (row % a->chunk_capacity);
+}
+
+static inline Entity *archetype_entity(const Archetype *a, u32 row) {
+    return (Entity *)archetype_chunk(a, row) + row % a->chunk_capacity;
+}
+
+/* Append a row (components uninitialized); returns it or UINT32_MAX */
+static u32 archetype_push(Archetype *a, Entity entity) {
+    u32 row = a->count;
+    if (row == a->chunk_count * a->chunk_capacity) {
+        if (!grow_array((void **)&a->chunks, &a->chunk_alloc, a->chunk_count + 1,
+                        sizeof(u8 *))) {
+            return UINT32_MAX;
+        }
+        u8 *chunk = malloc(a->chunk_bytes);
+        if (!chunk) return UINT32_MAX;
+        a->chunks[a->chunk_count++] = chunk;
+    }
+    *archetype_entity(a, row) = entity;
+    a->count++;
+    return row;
+}
+
+/* Remove `row` by moving the last row into it. Returns the entity that
+ * moved (ENTITY_INVALID if `row` was the last). */
+static Entity archetype_swap_remove(Archetype *a, u32 row) {
+    u32 last = --a->count;
+    if (row == last) return ENTITY_INVALID;
+
+    for (u32 c = 0; c < a->column_count; c++) {
+        memcpy(archetype_cell(a, c, row), archetype_cell(a, c, last), a->column_size[c]);
+    }
+    Entity moved = *archetype_entity(a, last);
+    *archetype_entity(a, row) = moved;
+    return moved;
+}
+
+/* ---- Lifecycle ---- */
+
+EngineResult world_create(World **out_world) {
+    World *world = calloc(1, sizeof(World));
+    if (!world) return ENGINE_ERROR_OUT_OF_MEMORY;
+    *out_world = world;
+    return ENGINE_SUCCESS;
+}
+
+void world_destroy(World *world) {
+    if (!world) return;
+    for (u32 i = 0; i < world->archetype_count; i++) {
+        Archetype *a = world->archetypes[i];
+        for (u32 c = 0; c < a->chunk_count; c++) free(a->chunks[c]);
+        free(a->chunks);
+        free(a);
+    }
+    for (u32 t = 0; t < JOBS_MAX_THREADS; t++) free(world->deferred[t].items);
+    free(world->records);
+    free(world->free_indices);
+    free(world);
+}
+
+ComponentId world_register_component(World *world, const char *name, size_t size,
+                                     size_t align) {
+    if (world->component_count == WORLD_MAX_COMPONENTS) {
+        LOG_ERROR("World component limit reached (%d)", WORLD_MAX_COMPONENTS);
+        return COMPONENT_INVALID;
+    }
+    if (align == 0 || (align & (align - 1)) != 0) align = sizeof(void *);
+    if (align > COLUMN_ALIGN) {
+        /* Chunks come from malloc, which only guarantees 16 */
+        LOG_ERROR("Component '%s' needs %zu-byte alignment (max %d)", name, align,
+                  COLUMN_ALIGN);
+        return COMPONENT_INVALID;
+    }
+
+    ComponentId id = world->component_count++;
+    ComponentInfo *info = &world->components[id];
+    strncpy(info->name, name ? name : "", sizeof(info->name) - 1);
+    info->size  = size;
+    info->align = align;
+    return id;
+}
+
+
+/* ---- Entities ---- */
+
+static EntityRecord *record_of(const World *world, Entity entity) {
+    if (entity == ENTITY_INVALID) return NULL;
+    u32 index = ENTITY_INDEX(entity);
+    if (index >= world->record_count) return NULL;
+    EntityRecord *r = &world->records[index];
+    if (r->archetype == NO_ARCHETYPE || r->generation != ENTITY_GEN(entity)) return NULL;
+    return r;
+}
+
+/* A fresh entity index. free_indices is kept as large as records, so
+ * despawning never has to allocate. */
+static u32 index_acquire(World *world) {
+    if (world->free_count > 0) return world->free_indices[--world->free_count];
+
+    if (world->record_count == WORLD_MAX_ENTITIES) {
+        LOG_ERROR("World entity limit reached (%u)", WORLD_MAX_ENTITIES);
+        return UINT32_MAX;
+    }
+    if (world->record_count == world->record_capacity) {
+        u32 cap = world->record_capacity ? world->record_capacity * 2 : 256;
+        /* A successful realloc frees the old block, so each pointer is kept
+         * as soon as it moves; the capacity only grows once both have */
+        EntityRecord *records = realloc(world->records, (size_t)cap * sizeof(EntityRecord));
+        if (records) world->records = records;
+        u32 *free_indices = records ? realloc(world->free_indices, (size_t)cap * sizeof(u32)) : NULL;
+        if (free_indices) world->free_indices = free_indices;
+        if (!records || !free_indices) return UINT32_MAX;
+        world->record_capacity = cap;
+    }
+    u32 index = world->record_count++;
+    world->records[index].generation = 0;
+    world->records[index].archetype  = NO_ARCHETYPE;
+    return index;
+}
+
+static void index_release(World *world, u32 index) {
+    EntityRecord *r = &world->records[index];
+    r->archetype  = NO_ARCHETYPE;
+    r->generation = (r->generation + 1) & GEN_MASK;
+    world->free_indices[world->free_count++] = index;
+}
+
+Entity world_spawn(World *world, ComponentMask mask) {
+    if (!structural_allowed(world, "spawn")) return ENTITY_INVALID;
+    if (world->component_count < WORLD_MAX_COMPONENTS &&
+        (mask >> world->component_count) != 0) {
+        LOG_ERROR("world_spawn: mask names unregistered components");
+        return ENTITY_INVALID;
+    }
+
+    u32 arch = archetype_find(world, mask);
+    if (arch == NO_ARCHETYPE) return ENTITY_INVALID;
+    u32 index = index_acquire(world);
+    if (index == UINT32_MAX) return ENTITY_INVALID;
+
+    EntityRecord *r = &world->records[index];
+    Entity entity = ENTITY_MAKE(index, r->generation);
+    Archetype *a = world->archetypes[arch];
+    u32 row = archetype_push(a, entity);
+    if (row == UINT32_MAX) {
+        index_release(world, index);
+        return ENTITY_INVALID;
+    }
+    for (u32 c = 0; c < a->column_count; c++) {
+        memset(archetype_cell(a, c, row), 0, a->column_size[c]);
+    }
+
+    r->archetype = arch;
+    r->row       = row;
+    world->live_count++;
+    return entity;
+}
+
+void world_despawn(World *world, Entity entity) {
+    if (!structural_allowed(world, "despawn")) return;
+    EntityRecord *r = record_of(world, entity);
+    if (!r) return;
+
+    Entity moved = archetype_swap_remove(world->archetypes[r->archetype], r->row);
+    if (moved != ENTITY_INVALID) world->records[ENTITY_INDEX(moved)].row = r->row;
+
+    index_release(world, ENTITY_INDEX(entity));
+    world->live_count--;
+}
+
+bool world_alive(const World *world, Entity entity) {
+    return record_of(world, entity) != NULL;
+}
+
+u32 world_entity_count(const World *world) {
+    return world->live_count;
+}
+
+void *world_get(World *world, Entity entity, ComponentId component) {
+    EntityRecord *r = record_of(world, entity);
+    if (!r || component >= WORLD_MAX_COMPONENTS) return NULL;
+    const Archetype *a = world->archetypes[r->archetype];
+    u8 c = a->column_of[component];
+    return c == NO_COLUMN ? NULL : archetype_cell(a, c, r->row);
+}
+
+/* Move an entity to the archetype for `mask`, carrying over the components
+ * both share and zeroing the new ones */
+static bool entity_move(World *world, EntityRecord *r, Entity entity, ComponentMask mask) {
+    u32 dst_index = archetype_find(world, mask);
+    if (dst_index == NO_ARCHETYPE) return false;
+    Archetype *src = world->archetypes[r->archetype];
+    Archetype *dst = world->archetypes[dst_index];
+
+    u32 row = archetype_push(dst, entity);
+    if (row == UINT32_MAX) return false;
+    for (u32 c = 0; c < dst->column_count; c++) {
+        u8 from = src->column_of[dst->column_component[c]];
+        if (from != NO_COLUMN) {
+            memcpy(archetype_cell(dst, c, row), archetype_cell(src, from, r->row),
+                   dst->column_size[c]);
+        } else {
+            memset(archetype_cell(dst, c, row), 0, dst->column_size[c]);
+        }
+    }
+
+    Entity moved = archetype_swap_remove(src, r->row);
+    if (moved != ENTITY_INVALID) world->records[ENTITY_INDEX(moved)].row = r->row;
+
+    r->archetype = dst_index;
+    r->row       = row;
+    return true;
+}
+
+void *world_add(World *world, Entity entity, ComponentId component) {
+    if (!structural_allowed(world, "add")) return NULL;
+    EntityRecord *r = record_of(world, entity);
+    if (!r || component >= world->component_count) return NULL;
+
+    ComponentMask mask = world->archetypes[r->archetype]->mask;
+    if (!(mask & COMPONENT_BIT(component)) &&
+        !entity_move(world, r, entity, mask | COMPONENT_BIT(component))) {
+        return NULL;
+    }
+    return world_get(world, entity, component);
+}
+
+void world_remove(World *world, Entity entity, ComponentId component) {
+    if (!structural_allowed(world, "remove")) return;
+    EntityRecord *r = record_of(world, entity);
+    if (!r || component >= world->component_count) return;
+
+    ComponentMask mask = world->archetypes[r->archetype]->mask;
+    if (mask & COMPONENT_BIT(component)) {
+        entity_move(world, r, entity, mask & ~COMPONENT_BIT(component));
+    }
+}
+
+void world_defer_despawn(World *world, Entity entity) {
+    DeferList *list = &world->deferred[jobs_thread_index()];
+    if (!grow_array((void **)&list->items, &list->capacity, list->count + 1,
+                    sizeof(Entity))) {
+        LOG_ERROR("world_defer_despawn: out of memory");
+        return;
+    }
+    list->items[list->count++] = entity;
+}
+
+void world_flush(World *world) {
+    for (u32 t = 0; t < JOBS_MAX_THREADS; t++) {
+        DeferList *list = &world->deferred[t];
+        for (u32 i = 0; i < list->count; i++) world_despawn(world, list->items[i]);
+        list->count = 0;
+    }
+}
+
+/* ---- Queries ---- */
+
+static bool archetype_matches(const Archetype *a, WorldQuery query) {
+    return (a->mask & query.all) == query.all && (a->mask & query.none) == 0;
+}
+
+/* Chunks holding rows; trailing chunks emptied by removals are skipped */
+static u32 archetype_used_chunks(const Archetype *a) {
+    return (a->count + a->chunk_capacity - 1) / a->chunk_capacity;
+}
+
+static void chunk_view(World *world, u32 archetype, u32 chunk, WorldChunk *out) {
+    const Archetype *a = world->archetypes[archetype];
+    u32 rows = a->count - chunk * a->chunk_capacity;
+
+    out->world     = world;
+    out->archetype = archetype;
+    out->data      = a->chunks[chunk];
+    out->entities  = (const Entity *)out->data;
+    out->count     = rows < a->chunk_capacity ? rows : a->chunk_capacity;
+}
+
+void *world_chunk_column(const WorldChunk *chunk, ComponentId component) {
+    if (component >= WORLD_MAX_COMPONENTS) return NULL;
+    const Archetype *a = chunk->world->archetypes[chunk->archetype];
+    u8 c = a->column_of[component];
+    return c == NO_COLUMN ? NULL : chunk->data + a->column_offset[c];
+}
+
+u32 world_collect_chunks(World *world, WorldQuery query, WorldChunk *out, u32 max) {
+    u32 total = 0;
+    for (u32 i = 0; i < world->archetype_count; i++) {
+        const Archetype *a = world->archetypes[i];
+        if (!archetype_matches(a, query)) continue;
+
+        u32 used = archetype_used_chunks(a);
+        for (u32 c = 0; c < used; c++, total++) {
+            if (out && total < max) chunk_view(world, i, c, &out[total]);
+        }
+    }
+    return total;
+}
+
+void world_each(World *world, WorldQuery query, WorldSystemFunc fn, void *user) {
+    bool outer = world->iterating;
+    world->iterating = true;
+
+    for (u32 i = 0; i < world->archetype_count; i++) {
+        const Archetype *a = world->archetypes[i];
+        if (!archetype_matches(a, query)) continue;
+
+        u32 used = archetype_used_chunks(a);
+        for (u32 c = 0; c < used; c++) {
+            WorldChunk view;
+            chunk_view(world, i, c, &view);
+            fn(&view, user);
+        }
+    }
+
+    world->iterating = outer;
+}
+
+typedef struct {
+    const WorldChunk *chunks;
+    WorldSystemFunc   fn;
+    void             *user;
+} ParallelQuery;
+
+static void each_chunk_range(void *data, u32 begin, u32 end) {
+    const ParallelQuery *q = data;
+    for (u32 i = begin; i < end; i++) q->fn(&q->chunks[i], q->user);
+}
+
+void world_each_parallel(World *world, WorldQuery query, WorldSystemFunc fn, void *user) {
+    PROFILE_ZONE_BEGIN("world_each_parallel");
+
+    /* Flatten the matching chunks so the job system can split them evenly
+     * however they are spread across archetypes */
+    Arena     *scratch = jobs_scratch();
+    ArenaMark  mark    = arena_mark(scratch);
+    u32        total   = world_collect_chunks(world, query, NULL, 0);
+    WorldChunk *chunks = total ? arena_push_array_nozero(scratch, WorldChunk, total) : NULL;
+
+    if (chunks) {
+        world_collect_chunks(world, query, chunks, total);
+
+        bool outer = world->iterating;
+        world->iterating = true;
+        ParallelQuery q = { chunks, fn, user };
+        jobs_parallel_for(total, 1, each_chunk_range, &q);
+        world->iterating = outer;
+    } else if (total) {
+        world_each(world, query, fn, user);
+    }
+
+    arena_pop_to(scratch, mark);
+    PROFILE_ZONE_END();
+}
+
+u32 world_query_count(const World *world, WorldQuery query) {
+    u32 total = 0;
+    for (u32 i = 0; i < world->archetype_count; i++) {
+        const Archetype *a = world->archetypes[i];
+        if (archetype_matches(a, query)) total += a->count;
+    }
+    return total;
+}
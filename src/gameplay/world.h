@@ -0,0 +1,117 @@
+#ifndef ENGINE_WORLD_H
+#define ENGINE_WORLD_H
+
+#include "core/common.h"
+
+/* ---- Entity / component world ----
+ * Archetype storage: every distinct set of components is an archetype, and
+ * its entities live in fixed-size chunks (about WORLD_CHUNK_BYTES each) with
+ * one dense column per component. A query walks only the archetypes whose
+ * set matches, chunk by chunk, so a system streams through exactly the
+ * columns it uses. Chunks are the unit of parallel work: world_each_parallel
+ * hands them to the job system.
+ *
+ * Removing an entity moves the archetype's last row into its place, so rows
+ * stay dense. Structural changes (spawn, despawn, add, remove) must not
+ * happen while a query runs; inside systems use world_defer_despawn and
+ * apply it with world_flush. */
+
+#define WORLD_MAX_COMPONENTS  64
+#define WORLD_MAX_ARCHETYPES  256
+#define WORLD_CHUNK_BYTES     (16 * 1024)
+
+typedef struct World World;
+
+/* Entity id: 22-bit index + 10-bit generation, so a stale id never matches
+ * the entity that later reuses its index. The last index is never handed
+ * out: at generation 1023 it would encode as ENTITY_INVALID. */
+typedef u32 Entity;
+#define ENTITY_INVALID     ((Entity)0xFFFFFFFF)
+#define WORLD_MAX_ENTITIES ((1u << 22) - 1)
+
+typedef u32 ComponentId;
+#define COMPONENT_INVALID  ((ComponentId)0xFFFFFFFF)
+
+typedef u64 ComponentMask;
+#define COMPONENT_BIT(id)  ((ComponentMask)1 << (id))
+
+/* Entities with every component in `all` and none in `none` */
+typedef struct {
+    ComponentMask all;
+    ComponentMask none;
+} WorldQuery;
+
+/* The rows of one chunk matching a query, as handed to a system */
+typedef struct {
+    World        *world;
+    const Entity *entities;
+    u32           count;
+    u32           archetype;  /* internal */
+    u8           *data;       /* internal */
+} WorldChunk;
+
+typedef void (*WorldSystemFunc)(const WorldChunk *chunk, void *user);
+
+/* ---- Lifecycle ---- */
+
+EngineResult world_create(World **out_world);
+void         world_destroy(World *world);
+
+/* Register a component type (alignment up to 16). Returns
+ * COMPONENT_INVALID once WORLD_MAX_COMPONENTS exist. */
+ComponentId  world_register_component(World *world, const char *name, size_t size,
+                                      size_t align);
+
+#define WORLD_REGISTER(world, type) \
+    world_register_component((world), #type, sizeof(type), _Alignof(type))
+
+/* ---- Entities ---- */
+
+/* New entity with the components in `mask`, zero-initialized. Returns
+ * ENTITY_INVALID when out of memory or entity ids. */
+Entity       world_spawn(World *world, ComponentMask mask);
+void         world_despawn(World *world, Entity entity);
+bool         world_alive(const World *world, Entity entity);
+u32          world_entity_count(const World *world);
+
+/* Component of an entity, or NULL if it is dead or lacks the component.
+ * Valid until the next structural change. */
+void        *world_get(World *world, Entity entity, ComponentId component);
+
+/* Add a (zeroed) component, moving the entity to its new archetype, and
+ * return it; an existing component is returned as is. */
+void        *world_add(World *world, Entity entity, ComponentId component);
+void         world_remove(World *world, Entity entity, ComponentId component);
+
+/* Queue a despawn from inside a system (any job thread); applied, in no
+ * particular order, by world_flush. Despawning twice is harmless. */
+void         world_defer_despawn(World *world, Entity entity);
+void         world_flush(World *world);
+
+/* ---- Queries ---- */
+
+/* Column of `component` in a chunk (NULL if the chunk's archetype lacks it,
+ * e.g. an optional component outside the query's `all` set) */
+void        *world_chunk_column(const WorldChunk *chunk, ComponentId component);
+
+#define WORLD_COLUMN(chunk, type, component) \
+    ((type *)world_chunk_column((chunk), (component)))
+
+/* Run `fn` over every matching chunk on the calling thread */
+void         world_each(World *world, WorldQuery query, WorldSystemFunc fn, void *user);
+
+/* Same, with chunks spread across the job system; returns when all are done.
+ * `fn` runs concurrently on different chunks, so it may write the chunk's
+ * columns but nothing shared without synchronization. */
+void         world_each_parallel(World *world, WorldQuery query, WorldSystemFunc fn,
+                                 void *user);
+
+/* Fill `out` with views of up to `max` matching chunks (out may be NULL);
+ * returns how many match. The views stay valid until the next structural
+ * change, for callers that walk the same chunks more than once. */
+u32          world_collect_chunks(World *world, WorldQuery query, WorldChunk *out, u32 max);
+
+/* Entities matching a query */
+u32          world_query_count(const World *world, WorldQuery query);
+
+#endif /* ENGINE_WORLD_H */
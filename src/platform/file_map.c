@@ -0,0 +1,107 @@
+#include "platform/file_map.h"
+#include "core/log.h"
+
+#include <stdlib.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+struct FileMap {
+    const void *data;
+    size_t      size;
+#ifdef _WIN32
+    HANDLE      file;
+    HANDLE      mapping;
+#endif
+};
+
+#ifdef _WIN32
+
+EngineResult file_map_open(const char *path, FileMap **out_map) {
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) return ENGINE_ERROR_FILE_NOT_FOUND;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return ENGINE_ERROR_GENERIC;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    const void *data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    FileMap *map = data ? malloc(sizeof(FileMap)) : NULL;
+    if (!map) {
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        LOG_ERROR("file_map_open: failed to map %s", path);
+        return ENGINE_ERROR_GENERIC;
+    }
+
+    map->data    = data;
+    map->size    = (size_t)size.QuadPart;
+    map->file    = file;
+    map->mapping = mapping;
+    *out_map = map;
+    return ENGINE_SUCCESS;
+}
+
+void file_map_close(FileMap *map) {
+    if (!map) return;
+    UnmapViewOfFile(map->data);
+    CloseHandle(map->mapping);
+    CloseHandle(map->file);
+    free(map);
+}
+
+#else
+
+EngineResult file_map_open(const char *path, FileMap **out_map) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return ENGINE_ERROR_FILE_NOT_FOUND;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return ENGINE_ERROR_GENERIC;
+    }
+
+    /* The mapping keeps the file referenced, so the descriptor can go now */
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    FileMap *map = (data != MAP_FAILED) ? malloc(sizeof(FileMap)) : NULL;
+    if (!map) {
+        if (data != MAP_FAILED) munmap(data, (size_t)st.st_size);
+        LOG_ERROR("file_map_open: failed to map %s", path);
+        return ENGINE_ERROR_GENERIC;
+    }
+
+    map->data = data;
+    map->size = (size_t)st.st_size;
+    *out_map = map;
+    return ENGINE_SUCCESS;
+}
+
+void file_map_close(FileMap *map) {
+    if (!map) return;
+    munmap((void *)map->data, map->size);
+    free(map);
+}
+
+#endif
+
+const void *file_map_data(const FileMap *map) {
+    return map->data;
+}
+
+size_t file_map_size(const FileMap *map) {
+    return map->size;
+}
@@ -0,0 +1,19 @@
+#ifndef ENGINE_FILE_MAP_H
+#define ENGINE_FILE_MAP_H
+
+#include "core/common.h"
+
+/* Read-only memory-mapped file (MapViewOfFile on Windows, mmap elsewhere).
+ * The handle is opaque and heap-allocated; the data pointer is page aligned
+ * and stays valid until file_map_close. */
+typedef struct FileMap FileMap;
+
+/* ENGINE_ERROR_FILE_NOT_FOUND if the file can't be opened, ENGINE_ERROR_GENERIC
+ * if it is empty or can't be mapped. */
+EngineResult file_map_open(const char *path, FileMap **out_map);
+void         file_map_close(FileMap *map);
+
+const void  *file_map_data(const FileMap *map);
+size_t       file_map_size(const FileMap *map);
+
+#endif /* ENGINE_FILE_MAP_H */
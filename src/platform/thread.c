@@ -0,0 +1,292 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L   /* clock_gettime, nanosleep */
+#endif
+
+#include "platform/thread.h"
+#include "core/log.h"
+
+#include <stdlib.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+struct Thread {
+#ifdef _WIN32
+    HANDLE     handle;
+#else
+    pthread_t  handle;
+#endif
+    ThreadFunc fn;
+    void      *arg;
+};
+
+struct Mutex {
+#ifdef _WIN32
+    SRWLOCK         lock;
+#else
+    pthread_mutex_t lock;
+#endif
+};
+
+/* macOS has no unnamed POSIX semaphores, so build one from a mutex + condvar */
+struct Semaphore {
+#ifdef _WIN32
+    HANDLE          handle;
+#else
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    u32             count;
+#endif
+};
+
+/* ---- Threads ---- */
+
+#ifdef _WIN32
+static DWORD WINAPI thread_entry(LPVOID param) {
+    Thread *t = (Thread *)param;
+    t->fn(t->arg);
+    return 0;
+}
+#else
+static void *thread_entry(void *param) {
+    Thread *t = (Thread *)param;
+    t->fn(t->arg);
+    return NULL;
+}
+#endif
+
+EngineResult thread_create(ThreadFunc fn, void *arg, Thread **out_thread) {
+    Thread *t = malloc(sizeof(Thread));
+    if (!t) return ENGINE_ERROR_OUT_OF_MEMORY;
+    t->fn  = fn;
+    t->arg = arg;
+
+#ifdef _WIN32
+    t->handle = CreateThread(NULL, 0, thread_entry, t, 0, NULL);
+    if (!t->handle) {
+#else
+    if (pthread_create(&t->handle, NULL, thread_entry, t) != 0) {
+#endif
+        LOG_ERROR("Failed to create thread");
+        free(t);
+        return ENGINE_ERROR_GENERIC;
+    }
+
+    *out_thread = t;
+    return ENGINE_SUCCESS;
+}
+
+void thread_join(Thread *thread) {
+    if (!thread) return;
+#ifdef _WIN32
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+#else
+    pthread_join(thread->handle, NULL);
+#endif
+    free(thread);
+}
+
+u32 thread_hardware_concurrency(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (u32)info.dwNumberOfProcessors : 1;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (u32)n : 1;
+#endif
+}
+
+void thread_yield(void) {
+#ifdef _WIN32
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+/* ---- Clock and sleep ---- */
+
+u64 thread_clock_ns(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    if (freq.QuadPart == 0) QueryPerformanceFrequency(&freq);
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    u64 f = (u64)freq.QuadPart, t = (u64)now.QuadPart;
+    return t / f * 1000000000ull + t % f * 1000000000ull / f;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000000000ull + (u64)ts.tv_nsec;
+#endif
+}
+
+#ifdef _WIN32
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+/* High-resolution waitable timer (Windows 10 1803+), one per thread; NULL
+ * if unavailable, in which case Sleep's coarse tick is all there is */
+static HANDLE sleep_timer(void) {
+    static ENGINE_THREAD_LOCAL HANDLE timer;
+    static ENGINE_THREAD_LOCAL bool   tried;
+    if (!tried) {
+        tried = true;
+        timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+                                       TIMER_ALL_ACCESS);
+    }
+    return timer;
+}
+#endif
+
+void thread_sleep_until(u64 deadline_ns) {
+    /* The OS sleep can overshoot by a scheduler tick, so it stops short of
+     * the deadline and the rest is spent yielding */
+#ifdef _WIN32
+    HANDLE timer = sleep_timer();
+    u64 margin = timer ? 500000ull : 2000000ull;
+#else
+    u64 margin = 200000ull;
+#endif
+
+    u64 now = thread_clock_ns();
+    if (deadline_ns > now + margin) {
+        u64 ns = deadline_ns - now - margin;
+#ifdef _WIN32
+        if (timer) {
+            LARGE_INTEGER due = { .QuadPart = -(LONGLONG)(ns / 100) }; /* relative, 100 ns units */
+            if (SetWaitableTimer(timer, &due, 0, NULL, NULL, FALSE))
+                WaitForSingleObject(timer, INFINITE);
+        } else {
+            Sleep((DWORD)(ns / 1000000ull));
+        }
+#else
+        struct timespec ts = {
+            .tv_sec  = (time_t)(ns / 1000000000ull),
+            .tv_nsec = (long)(ns % 1000000000ull),
+        };
+        nanosleep(&ts, NULL);
+#endif
+    }
+
+    while (thread_clock_ns() < deadline_ns) thread_yield();
+}
+
+/* ---- Mutex ---- */
+
+EngineResult mutex_create(Mutex **out_mutex) {
+    Mutex *m = malloc(sizeof(Mutex));
+    if (!m) return ENGINE_ERROR_OUT_OF_MEMORY;
+
+#ifdef _WIN32
+    InitializeSRWLock(&m->lock);
+#else
+    if (pthread_mutex_init(&m->lock, NULL) != 0) {
+        free(m);
+        return ENGINE_ERROR_GENERIC;
+    }
+#endif
+
+    *out_mutex = m;
+    return ENGINE_SUCCESS;
+}
+
+void mutex_destroy(Mutex *mutex) {
+    if (!mutex) return;
+#ifndef _WIN32
+    pthread_mutex_destroy(&mutex->lock);
+#endif
+    free(mutex);
+}
+
+void mutex_lock(Mutex *mutex) {
+#ifdef _WIN32
+    AcquireSRWLockExclusive(&mutex->lock);
+#else
+    pthread_mutex_lock(&mutex->lock);
+#endif
+}
+
+void mutex_unlock(Mutex *mutex) {
+#ifdef _WIN32
+    ReleaseSRWLockExclusive(&mutex->lock);
+#else
+    pthread_mutex_unlock(&mutex->lock);
+#endif
+}
+
+/* ---- Semaphore ---- */
+
+EngineResult semaphore_create(u32 initial, Semaphore **out_sem) {
+    Semaphore *sem = malloc(sizeof(Semaphore));
+    if (!sem) return ENGINE_ERROR_OUT_OF_MEMORY;
+
+#ifdef _WIN32
+    sem->handle = CreateSemaphoreA(NULL, (LONG)initial, 0x7fffffff, NULL);
+    if (!sem->handle) {
+        free(sem);
+        return ENGINE_ERROR_GENERIC;
+    }
+#else
+    if (pthread_mutex_init(&sem->lock, NULL) != 0) {
+        free(sem);
+        return ENGINE_ERROR_GENERIC;
+    }
+    if (pthread_cond_init(&sem->cond, NULL) != 0) {
+        pthread_mutex_destroy(&sem->lock);
+        free(sem);
+        return ENGINE_ERROR_GENERIC;
+    }
+    sem->count = initial;
+#endif
+
+    *out_sem = sem;
+    return ENGINE_SUCCESS;
+}
+
+void semaphore_destroy(Semaphore *sem) {
+    if (!sem) return;
+#ifdef _WIN32
+    CloseHandle(sem->handle);
+#else
+    pthread_cond_destroy(&sem->cond);
+    pthread_mutex_destroy(&sem->lock);
+#endif
+    free(sem);
+}
+
+void semaphore_wait(Semaphore *sem) {
+#ifdef _WIN32
+    WaitForSingleObject(sem->handle, INFINITE);
+#else
+    pthread_mutex_lock(&sem->lock);
+    while (sem->count == 0) {
+        pthread_cond_wait(&sem->cond, &sem->lock);
+    }
+    sem->count--;
+    pthread_mutex_unlock(&sem->lock);
+#endif
+}
+
+void semaphore_post(Semaphore *sem, u32 count) {
+    if (count == 0) return;
+#ifdef _WIN32
+    ReleaseSemaphore(sem->handle, (LONG)count, NULL);
+#else
+    pthread_mutex_lock(&sem->lock);
+    sem->count += count;
+    if (count == 1) pthread_cond_signal(&sem->cond);
+    else            pthread_cond_broadcast(&sem->cond);
+    pthread_mutex_unlock(&sem->lock);
+#endif
+}
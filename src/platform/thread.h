@@ -0,0 +1,52 @@
+#ifndef ENGINE_THREAD_H
+#define ENGINE_THREAD_H
+
+#include "core/common.h"
+
+/* Thin OS thread wrapper (Win32 threads on Windows, pthreads elsewhere).
+ * Handles are opaque and heap-allocated, like Window. */
+typedef struct Thread    Thread;
+typedef struct Mutex     Mutex;
+typedef struct Semaphore Semaphore;
+
+/* Thread-local storage qualifier (C11 _Thread_local, MSVC __declspec) */
+#if defined(_MSC_VER) && !defined(__clang__)
+#define ENGINE_THREAD_LOCAL __declspec(thread)
+#else
+#define ENGINE_THREAD_LOCAL _Thread_local
+#endif
+
+typedef void (*ThreadFunc)(void *arg);
+
+/* Start a thread running fn(arg). */
+EngineResult thread_create(ThreadFunc fn, void *arg, Thread **out_thread);
+
+/* Wait for the thread to finish and free its handle. */
+void         thread_join(Thread *thread);
+
+/* Number of hardware threads available to the process (at least 1). */
+u32          thread_hardware_concurrency(void);
+
+/* Give up the rest of the calling thread's time slice. */
+void         thread_yield(void);
+
+/* Monotonic clock in nanoseconds (QPC on Windows, CLOCK_MONOTONIC elsewhere). */
+u64          thread_clock_ns(void);
+
+/* Sleep until thread_clock_ns() reaches deadline_ns. The OS sleep covers all
+ * but the last fraction of a millisecond, which is spun with thread_yield,
+ * so wake-up is accurate to well under a millisecond. */
+void         thread_sleep_until(u64 deadline_ns);
+
+EngineResult mutex_create(Mutex **out_mutex);
+void         mutex_destroy(Mutex *mutex);
+void         mutex_lock(Mutex *mutex);
+void         mutex_unlock(Mutex *mutex);
+
+/* Counting semaphore, used to park idle worker threads. */
+EngineResult semaphore_create(u32 initial, Semaphore **out_sem);
+void         semaphore_destroy(Semaphore *sem);
+void         semaphore_wait(Semaphore *sem);
+void         semaphore_post(Semaphore *sem, u32 count);
+
+#endif /* ENGINE_THREAD_H */
@@ -1,135 +1,205 @@
 #include "renderer/anim_blend.h"
 #include "renderer/anim_graph_types.h"
-
-#include <cglm/quat.h>
-#include <cglm/vec3.h>
+#include "core/simd.h"
 
 #include <string.h>
 
+/* Kernels run over whole vectors, reading and writing the padding lanes.
+ * Bone mask weights are MAX_JOINTS long, so they must cover every lane. */
+_Static_assert(MAX_JOINTS % SIMD_MAX_WIDTH == 0, "MAX_JOINTS must be a multiple of SIMD_MAX_WIDTH");
+
+#define LANE_COUNT(joint_count) (((joint_count) + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH)
+
 /* --------------------------------------------------------------------------
- * pose_blend — blend two poses by factor (0.0 = a, 1.0 = b)
- * Translations/scales: vec3 lerp.  Rotations: quaternion slerp.
+ * Lane helpers
  * ------------------------------------------------------------------------ */
 
-void pose_blend(const AnimPose *a, const AnimPose *b, u32 joint_count,
-                f32 factor, AnimPose *out) {
-    f32 inv = 1.0f - factor;
-    for (u32 j = 0; j < joint_count; j++) {
-        /* Translation: lerp */
-        for (u32 i = 0; i < 3; i++)
-            out->translations[j][i] = a->translations[j][i] * inv + b->translations[j][i] * factor;
-
-        /* Rotation: slerp with shortest-path correction */
-        f32 qa[4], qb[4];
-        memcpy(qa, a->rotations[j], sizeof(f32) * 4);
-        memcpy(qb, b->rotations[j], sizeof(f32) * 4);
-
-        /* Ensure shortest path */
-        f32 dot = qa[0]*qb[0] + qa[1]*qb[1] + qa[2]*qb[2] + qa[3]*qb[3];
-        if (dot < 0.0f) {
-            qb[0] = -qb[0]; qb[1] = -qb[1]; qb[2] = -qb[2]; qb[3] = -qb[3];
-        }
-        glm_quat_slerp(qa, qb, factor, out->rotations[j]);
+typedef struct { simd_f32 x, y, z, w; } QuatLanes;
 
-        /* Scale: lerp */
-        for (u32 i = 0; i < 3; i++)
-            out->scales[j][i] = a->scales[j][i] * inv + b->scales[j][i] * factor;
-    }
+static inline QuatLanes load_quat(const AnimPose *p, u32 j) {
+    return (QuatLanes){ simd_load(&p->rx[j]), simd_load(&p->ry[j]),
+                        simd_load(&p->rz[j]), simd_load(&p->rw[j]) };
+}
+
+static inline void store_quat(AnimPose *p, u32 j, QuatLanes q) {
+    simd_store(&p->rx[j], q.x);
+    simd_store(&p->ry[j], q.y);
+    simd_store(&p->rz[j], q.z);
+    simd_store(&p->rw[j], q.w);
+}
+
+static inline simd_f32 quat_dot(QuatLanes a, QuatLanes b) {
+    simd_f32 d = simd_mul(a.x, b.x);
+    d = simd_madd(a.y, b.y, d);
+    d = simd_madd(a.z, b.z, d);
+    return simd_madd(a.w, b.w, d);
+}
+
+static inline QuatLanes quat_normalize(QuatLanes q) {
+    simd_f32 inv_len = simd_rsqrt(quat_dot(q, q));
+    return (QuatLanes){ simd_mul(q.x, inv_len), simd_mul(q.y, inv_len),
+                        simd_mul(q.z, inv_len), simd_mul(q.w, inv_len) };
+}
+
+/* Shortest-path normalized lerp from a to b */
+static inline QuatLanes quat_nlerp(QuatLanes a, QuatLanes b, simd_f32 t) {
+    simd_f32 d = quat_dot(a, b);
+    b.x = simd_flip_sign(b.x, d);
+    b.y = simd_flip_sign(b.y, d);
+    b.z = simd_flip_sign(b.z, d);
+    b.w = simd_flip_sign(b.w, d);
+    return quat_normalize((QuatLanes){ simd_lerp(a.x, b.x, t), simd_lerp(a.y, b.y, t),
+                                       simd_lerp(a.z, b.z, t), simd_lerp(a.w, b.w, t) });
+}
+
+/* Hamilton product a * b */
+static inline QuatLanes quat_mul(QuatLanes a, QuatLanes b) {
+    QuatLanes r;
+    r.x = simd_sub(simd_madd(a.w, b.x, simd_madd(a.x, b.w, simd_mul(a.y, b.z))), simd_mul(a.z, b.y));
+    r.y = simd_add(simd_sub(simd_madd(a.w, b.y, simd_mul(a.y, b.w)), simd_mul(a.x, b.z)), simd_mul(a.z, b.x));
+    r.z = simd_add(simd_sub(simd_madd(a.w, b.z, simd_mul(a.x, b.y)), simd_mul(a.y, b.x)), simd_mul(a.z, b.w));
+    r.w = simd_sub(simd_sub(simd_sub(simd_mul(a.w, b.w), simd_mul(a.x, b.x)), simd_mul(a.y, b.y)), simd_mul(a.z, b.z));
+    return r;
+}
+
+static inline void lerp_lane(const f32 *a, const f32 *b, f32 *out, u32 j, simd_f32 t) {
+    simd_store(&out[j], simd_lerp(simd_load(&a[j]), simd_load(&b[j]), t));
+}
+
+/* out = base + (add - ref) * w */
+static inline void additive_lane(const f32 *base, const f32 *add, const f32 *ref,
+                                 f32 *out, u32 j, simd_f32 w) {
+    simd_f32 delta = simd_sub(simd_load(&add[j]), simd_load(&ref[j]));
+    simd_store(&out[j], simd_madd(delta, w, simd_load(&base[j])));
 }
 
 /* --------------------------------------------------------------------------
- * pose_blend_masked — blend with per-joint weights from bone mask
+ * blend_kernel — out = lerp(a, b, factor * weights[j]); weights may be NULL
  * ------------------------------------------------------------------------ */
 
-void pose_blend_masked(const AnimPose *base, const AnimPose *overlay,
-                        u32 joint_count, const BoneMask *mask,
-                        f32 factor, AnimPose *out) {
-    for (u32 j = 0; j < joint_count; j++) {
-        f32 w = mask->weights[j] * factor;
-        if (w < 1e-6f) {
-            /* No influence — copy base */
-            memcpy(out->translations[j], base->translations[j], sizeof(f32) * 3);
-            memcpy(out->rotations[j],    base->rotations[j],    sizeof(f32) * 4);
-            memcpy(out->scales[j],       base->scales[j],       sizeof(f32) * 3);
-            continue;
-        }
+static void blend_kernel(const AnimPose *a, const AnimPose *b, u32 joint_count,
+                         const f32 *weights, f32 factor, AnimPose *out) {
+    simd_f32 f = simd_set1(factor);
+    u32 lanes = LANE_COUNT(joint_count);
 
-        f32 inv = 1.0f - w;
+    for (u32 j = 0; j < lanes; j += SIMD_WIDTH) {
+        simd_f32 t = weights ? simd_mul(simd_load(&weights[j]), f) : f;
 
-        /* Translation: lerp */
-        for (u32 i = 0; i < 3; i++)
-            out->translations[j][i] = base->translations[j][i] * inv + overlay->translations[j][i] * w;
+        lerp_lane(a->tx, b->tx, out->tx, j, t);
+        lerp_lane(a->ty, b->ty, out->ty, j, t);
+        lerp_lane(a->tz, b->tz, out->tz, j, t);
 
-        /* Rotation: slerp with shortest-path */
-        f32 qa[4], qb[4];
-        memcpy(qa, base->rotations[j], sizeof(f32) * 4);
-        memcpy(qb, overlay->rotations[j], sizeof(f32) * 4);
+        store_quat(out, j, quat_nlerp(load_quat(a, j), load_quat(b, j), t));
 
-        f32 dot = qa[0]*qb[0] + qa[1]*qb[1] + qa[2]*qb[2] + qa[3]*qb[3];
-        if (dot < 0.0f) {
-            qb[0] = -qb[0]; qb[1] = -qb[1]; qb[2] = -qb[2]; qb[3] = -qb[3];
-        }
-        glm_quat_slerp(qa, qb, w, out->rotations[j]);
-
-        /* Scale: lerp */
-        for (u32 i = 0; i < 3; i++)
-            out->scales[j][i] = base->scales[j][i] * inv + overlay->scales[j][i] * w;
+        lerp_lane(a->sx, b->sx, out->sx, j, t);
+        lerp_lane(a->sy, b->sy, out->sy, j, t);
+        lerp_lane(a->sz, b->sz, out->sz, j, t);
     }
 }
 
+/* --------------------------------------------------------------------------
+ * pose_blend — blend two poses by factor (0.0 = a, 1.0 = b)
+ * Translations/scales: vec3 lerp.  Rotations: quaternion nlerp.
+ * ------------------------------------------------------------------------ */
+
+void pose_blend(const AnimPose *a, const AnimPose *b, u32 joint_count,
+                f32 factor, AnimPose *out) {
+    blend_kernel(a, b, joint_count, NULL, factor, out);
+}
+
+/* --------------------------------------------------------------------------
+ * pose_blend_masked — blend with per-joint weights from bone mask.
+ * A zero weight reproduces base, so no per-joint branch is needed.
+ * ------------------------------------------------------------------------ */
+
+void pose_blend_masked(const AnimPose *base, const AnimPose *overlay,
+                        u32 joint_count, const BoneMask *mask,
+                        f32 factor, AnimPose *out) {
+    blend_kernel(base, overlay, joint_count, mask->weights, factor, out);
+}
+
 /* --------------------------------------------------------------------------
  * pose_blend_additive — add pose delta on top of base
  *   out_t = base_t + (additive_t - reference_t) * weight
- *   out_r = base_r * slerp(identity, inv(ref_r) * additive_r, weight)
+ *   out_r = base_r * nlerp(identity, inv(ref_r) * additive_r, weight)
  *   out_s = base_s + (additive_s - reference_s) * weight
  * ------------------------------------------------------------------------ */
 
 void pose_blend_additive(const AnimPose *base, const AnimPose *additive,
                           const AnimPose *reference, u32 joint_count,
                           const BoneMask *mask, f32 weight, AnimPose *out) {
-    f32 identity_q[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
-
-    for (u32 j = 0; j < joint_count; j++) {
-        f32 w = weight;
-        if (mask) w *= mask->weights[j];
-        if (w < 1e-6f) {
-            memcpy(out->translations[j], base->translations[j], sizeof(f32) * 3);
-            memcpy(out->rotations[j],    base->rotations[j],    sizeof(f32) * 4);
-            memcpy(out->scales[j],       base->scales[j],       sizeof(f32) * 3);
-            continue;
-        }
+    simd_f32 wv    = simd_set1(weight);
+    simd_f32 zero  = simd_set1(0.0f);
+    simd_f32 one   = simd_set1(1.0f);
+    u32      lanes = LANE_COUNT(joint_count);
+
+    for (u32 j = 0; j < lanes; j += SIMD_WIDTH) {
+        simd_f32 w = mask ? simd_mul(simd_load(&mask->weights[j]), wv) : wv;
 
         /* Translation: additive delta */
-        for (u32 i = 0; i < 3; i++)
-            out->translations[j][i] = base->translations[j][i]
-                + (additive->translations[j][i] - reference->translations[j][i]) * w;
-
-        /* Rotation: q_delta = inv(ref) * additive, then base * slerp(id, delta, w) */
-        f32 ref_inv[4];
-        glm_quat_inv((f32 *)reference->rotations[j], ref_inv);
-
-        f32 q_delta[4];
-        glm_quat_mul(ref_inv, (f32 *)additive->rotations[j], q_delta);
-
-        /* Ensure shortest path for delta */
-        f32 dot = q_delta[0]*identity_q[0] + q_delta[1]*identity_q[1]
-                + q_delta[2]*identity_q[2] + q_delta[3]*identity_q[3];
-        if (dot < 0.0f) {
-            q_delta[0] = -q_delta[0]; q_delta[1] = -q_delta[1];
-            q_delta[2] = -q_delta[2]; q_delta[3] = -q_delta[3];
-        }
+        additive_lane(base->tx, additive->tx, reference->tx, out->tx, j, w);
+        additive_lane(base->ty, additive->ty, reference->ty, out->ty, j, w);
+        additive_lane(base->tz, additive->tz, reference->tz, out->tz, j, w);
 
-        f32 q_delta_weighted[4];
-        glm_quat_slerp(identity_q, q_delta, w, q_delta_weighted);
+        /* Rotation: q_delta = conj(ref) * additive (reference quats are unit) */
+        QuatLanes ref = load_quat(reference, j);
+        QuatLanes ref_inv = { simd_sub(zero, ref.x), simd_sub(zero, ref.y),
+                              simd_sub(zero, ref.z), ref.w };
+        QuatLanes delta = quat_mul(ref_inv, load_quat(additive, j));
 
-        glm_quat_mul((f32 *)base->rotations[j], q_delta_weighted, out->rotations[j]);
-        glm_quat_normalize(out->rotations[j]);
+        /* nlerp(identity, delta, w) with the shortest path taken on delta.w */
+        QuatLanes identity = { zero, zero, zero, one };
+        QuatLanes weighted = quat_nlerp(identity, delta, w);
+
+        store_quat(out, j, quat_normalize(quat_mul(load_quat(base, j), weighted)));
 
         /* Scale: additive delta */
-        for (u32 i = 0; i < 3; i++)
-            out->scales[j][i] = base->scales[j][i]
-                + (additive->scales[j][i] - reference->scales[j][i]) * w;
+        additive_lane(base->sx, additive->sx, reference->sx, out->sx, j, w);
+        additive_lane(base->sy, additive->sy, reference->sy, out->sy, j, w);
+        additive_lane(base->sz, additive->sz, reference->sz, out->sz, j, w);
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * pose_alloc — small header plus ten contiguous lanes. Joints are left
+ * uninitialized for the caller to write; the padding past joint_count is
+ * never written by anyone but is read by the kernels, so it is set once to
+ * the identity transform (a zero quaternion would normalize to NaN).
+ * ------------------------------------------------------------------------ */
+
+AnimPose *pose_alloc(Arena *arena, u32 joint_count) {
+    u32 lanes = SIMD_PAD(joint_count);
+    if (lanes == 0) lanes = SIMD_MAX_WIDTH;
+
+    AnimPose *pose = arena_push(arena, AnimPose);
+    f32 *data = (f32 *)arena_alloc_nozero(arena, sizeof(f32) * ANIM_POSE_LANES * lanes,
+                                          sizeof(f32) * SIMD_MAX_WIDTH);
+    if (!pose || !data) return NULL;
+
+    pose->tx = data + 0 * lanes;
+    pose->ty = data + 1 * lanes;
+    pose->tz = data + 2 * lanes;
+    pose->rx = data + 3 * lanes;
+    pose->ry = data + 4 * lanes;
+    pose->rz = data + 5 * lanes;
+    pose->rw = data + 6 * lanes;
+    pose->sx = data + 7 * lanes;
+    pose->sy = data + 8 * lanes;
+    pose->sz = data + 9 * lanes;
+    pose->lane_count = lanes;
+
+    u32 tail = lanes - joint_count;
+    if (tail > 0) {
+        f32 *zero_lanes[] = { pose->tx, pose->ty, pose->tz, pose->rx, pose->ry, pose->rz };
+        f32 *one_lanes[]  = { pose->rw, pose->sx, pose->sy, pose->sz };
+        for (u32 l = 0; l < ENGINE_ARRAY_LEN(zero_lanes); l++) {
+            memset(zero_lanes[l] + joint_count, 0, sizeof(f32) * tail);
+        }
+        for (u32 l = 0; l < ENGINE_ARRAY_LEN(one_lanes); l++) {
+            for (u32 j = joint_count; j < lanes; j++) one_lanes[l][j] = 1.0f;
+        }
     }
+    return pose;
 }
 
 /* --------------------------------------------------------------------------
@@ -138,20 +208,26 @@ void pose_blend_additive(const AnimPose *base, const AnimPose *additive,
 
 void pose_from_rest(const Skeleton *skel, AnimPose *out) {
     for (u32 j = 0; j < skel->joint_count; j++) {
-        memcpy(out->translations[j], skel->rest_translations[j], sizeof(f32) * 3);
-        memcpy(out->rotations[j],    skel->rest_rotations[j],    sizeof(f32) * 4);
-        memcpy(out->scales[j],       skel->rest_scales[j],       sizeof(f32) * 3);
+        pose_set_translation(out, j, skel->rest_translations[j]);
+        pose_set_rotation(out, j, skel->rest_rotations[j]);
+        pose_set_scale(out, j, skel->rest_scales[j]);
     }
 }
 
 /* --------------------------------------------------------------------------
- * pose_copy — copy pose data
+ * pose_copy — copy pose data (each component lane is contiguous)
  * ------------------------------------------------------------------------ */
 
 void pose_copy(const AnimPose *src, u32 joint_count, AnimPose *dst) {
-    for (u32 j = 0; j < joint_count; j++) {
-        memcpy(dst->translations[j], src->translations[j], sizeof(f32) * 3);
-        memcpy(dst->rotations[j],    src->rotations[j],    sizeof(f32) * 4);
-        memcpy(dst->scales[j],       src->scales[j],       sizeof(f32) * 3);
-    }
+    size_t bytes = sizeof(f32) * joint_count;
+    memcpy(dst->tx, src->tx, bytes);
+    memcpy(dst->ty, src->ty, bytes);
+    memcpy(dst->tz, src->tz, bytes);
+    memcpy(dst->rx, src->rx, bytes);
+    memcpy(dst->ry, src->ry, bytes);
+    memcpy(dst->rz, src->rz, bytes);
+    memcpy(dst->rw, src->rw, bytes);
+    memcpy(dst->sx, src->sx, bytes);
+    memcpy(dst->sy, src->sy, bytes);
+    memcpy(dst->sz, src->sz, bytes);
 }
@@ -10,7 +10,7 @@ typedef struct BoneMask BoneMask;
 
 /* Blend two poses: out = lerp(a, b, factor).
  * Translations/scales: vec3 lerp.
- * Rotations: quaternion slerp (shortest-path). */
+ * Rotations: normalized lerp (shortest-path). */
 void pose_blend(const AnimPose *a, const AnimPose *b, u32 joint_count,
                 f32 factor, AnimPose *out);
 
@@ -21,16 +21,54 @@ void pose_blend_masked(const AnimPose *base, const AnimPose *overlay,
                         f32 factor, AnimPose *out);
 
 /* Additive blend: out = base + (additive - reference) * weight.
- * For rotations: out = base * slerp(identity, inv(ref) * additive, weight).
+ * For rotations: out = base * nlerp(identity, inv(ref) * additive, weight).
  * mask: optional (NULL = all joints). */
 void pose_blend_additive(const AnimPose *base, const AnimPose *additive,
                           const AnimPose *reference, u32 joint_count,
                           const BoneMask *mask, f32 weight, AnimPose *out);
 
+/* Floats per pose: 10 lanes (T xyz, R xyzw, S xyz) */
+#define ANIM_POSE_LANES 10
+
+/* Upper bound on the arena bytes pose_alloc() takes for any skeleton */
+#define ANIM_POSE_MAX_BYTES \
+    (sizeof(AnimPose) + 64 + sizeof(f32) * ANIM_POSE_LANES * MAX_JOINTS)
+
+/* Allocate an uninitialized pose for `joint_count` joints from the arena
+ * (no zero-fill: every user writes the joints before reading them).
+ * Returns NULL if the arena is out of space. */
+AnimPose *pose_alloc(Arena *arena, u32 joint_count);
+
 /* Copy rest pose from skeleton into an AnimPose buffer. */
 void pose_from_rest(const Skeleton *skel, AnimPose *out);
 
 /* Copy one pose to another. */
 void pose_copy(const AnimPose *src, u32 joint_count, AnimPose *dst);
 
+/* ---- Per-joint access to the SoA lanes ---- */
+
+static inline void pose_set_translation(AnimPose *p, u32 j, const f32 t[3]) {
+    p->tx[j] = t[0]; p->ty[j] = t[1]; p->tz[j] = t[2];
+}
+
+static inline void pose_set_rotation(AnimPose *p, u32 j, const f32 q[4]) {
+    p->rx[j] = q[0]; p->ry[j] = q[1]; p->rz[j] = q[2]; p->rw[j] = q[3];
+}
+
+static inline void pose_set_scale(AnimPose *p, u32 j, const f32 s[3]) {
+    p->sx[j] = s[0]; p->sy[j] = s[1]; p->sz[j] = s[2];
+}
+
+static inline void pose_get_translation(const AnimPose *p, u32 j, f32 out[3]) {
+    out[0] = p->tx[j]; out[1] = p->ty[j]; out[2] = p->tz[j];
+}
+
+static inline void pose_get_rotation(const AnimPose *p, u32 j, f32 out[4]) {
+    out[0] = p->rx[j]; out[1] = p->ry[j]; out[2] = p->rz[j]; out[3] = p->rw[j];
+}
+
+static inline void pose_get_scale(const AnimPose *p, u32 j, f32 out[3]) {
+    out[0] = p->sx[j]; out[1] = p->sy[j]; out[2] = p->sz[j];
+}
+
 #endif /* ENGINE_ANIM_BLEND_H */
@@ -1,4 +1,4 @@
-#include "renderer/anim_graph_types.h"
+#include "renderer/anim_graph.h"
 #include "renderer/anim_blend.h"
 #include "renderer/animation.h"
 #include "core/log.h"
@@ -18,6 +18,8 @@ void blend_space_1d_evaluate(const BlendSpace1D *space,
                               const SkinnedModel *model,
                               f32 normalized_time,
                               Arena *scratch,
+                              AnimCursorSet *cursors,
+                              const BoneMask *joint_mask,
                               AnimPose *out_pose) {
     if (space->entry_count == 0) {
         pose_from_rest(&model->skeleton, out_pose);
@@ -36,7 +38,9 @@ void blend_space_1d_evaluate(const BlendSpace1D *space,
         u32 ci = space->entries[0].clip_index;
         if (ci < model->clip_count) {
             f32 t = normalized_time * model->clips[ci].duration;
-            animation_evaluate_pose(&model->skeleton, &model->clips[ci], t, out_pose);
+            animation_evaluate_pose_masked(&model->skeleton, &model->clips[ci], t,
+                                           anim_cursor_set_get(cursors, &model->clips[ci]),
+                                           joint_mask, out_pose);
         } else {
             pose_from_rest(&model->skeleton, out_pose);
         }
@@ -61,8 +65,8 @@ void blend_space_1d_evaluate(const BlendSpace1D *space,
     u32 ci_a = space->entries[lo].clip_index;
     u32 ci_b = space->entries[hi].clip_index;
 
-    AnimPose *pose_a = arena_push(scratch, AnimPose);
-    AnimPose *pose_b = arena_push(scratch, AnimPose);
+    AnimPose *pose_a = pose_alloc(scratch, model->skeleton.joint_count);
+    AnimPose *pose_b = pose_alloc(scratch, model->skeleton.joint_count);
 
     if (!pose_a || !pose_b) {
         pose_from_rest(&model->skeleton, out_pose);
@@ -71,14 +75,18 @@ void blend_space_1d_evaluate(const BlendSpace1D *space,
 
     if (ci_a < model->clip_count) {
         f32 t = normalized_time * model->clips[ci_a].duration;
-        animation_evaluate_pose(&model->skeleton, &model->clips[ci_a], t, pose_a);
+        animation_evaluate_pose_masked(&model->skeleton, &model->clips[ci_a], t,
+                                       anim_cursor_set_get(cursors, &model->clips[ci_a]),
+                                       joint_mask, pose_a);
     } else {
         pose_from_rest(&model->skeleton, pose_a);
     }
 
     if (ci_b < model->clip_count) {
         f32 t = normalized_time * model->clips[ci_b].duration;
-        animation_evaluate_pose(&model->skeleton, &model->clips[ci_b], t, pose_b);
+        animation_evaluate_pose_masked(&model->skeleton, &model->clips[ci_b], t,
+                                       anim_cursor_set_get(cursors, &model->clips[ci_b]),
+                                       joint_mask, pose_b);
     } else {
         pose_from_rest(&model->skeleton, pose_b);
     }
@@ -99,6 +107,8 @@ void blend_space_2d_evaluate(const BlendSpace2D *space,
                               const SkinnedModel *model,
                               f32 normalized_time,
                               Arena *scratch,
+                              AnimCursorSet *cursors,
+                              const BoneMask *joint_mask,
                               AnimPose *out_pose) {
     if (space->entry_count == 0) {
         pose_from_rest(&model->skeleton, out_pose);
@@ -110,7 +120,9 @@ void blend_space_2d_evaluate(const BlendSpace2D *space,
         u32 ci = space->entries[0].clip_index;
         if (ci < model->clip_count) {
             f32 t = normalized_time * model->clips[ci].duration;
-            animation_evaluate_pose(&model->skeleton, &model->clips[ci], t, out_pose);
+            animation_evaluate_pose_masked(&model->skeleton, &model->clips[ci], t,
+                                           anim_cursor_set_get(cursors, &model->clips[ci]),
+                                           joint_mask, out_pose);
         } else {
             pose_from_rest(&model->skeleton, out_pose);
         }
@@ -128,19 +140,23 @@ void blend_space_2d_evaluate(const BlendSpace2D *space,
         if (t_proj < 0.0f) t_proj = 0.0f;
         if (t_proj > 1.0f) t_proj = 1.0f;
 
-        AnimPose *pa = arena_push(scratch, AnimPose);
-        AnimPose *pb = arena_push(scratch, AnimPose);
+        AnimPose *pa = pose_alloc(scratch, model->skeleton.joint_count);
+        AnimPose *pb = pose_alloc(scratch, model->skeleton.joint_count);
         if (!pa || !pb) { pose_from_rest(&model->skeleton, out_pose); return; }
 
         u32 ci_a = space->entries[0].clip_index;
         u32 ci_b = space->entries[1].clip_index;
         if (ci_a < model->clip_count) {
             f32 ct = normalized_time * model->clips[ci_a].duration;
-            animation_evaluate_pose(&model->skeleton, &model->clips[ci_a], ct, pa);
+            animation_evaluate_pose_masked(&model->skeleton, &model->clips[ci_a], ct,
+                                           anim_cursor_set_get(cursors, &model->clips[ci_a]),
+                                           joint_mask, pa);
         } else { pose_from_rest(&model->skeleton, pa); }
         if (ci_b < model->clip_count) {
             f32 ct = normalized_time * model->clips[ci_b].duration;
-            animation_evaluate_pose(&model->skeleton, &model->clips[ci_b], ct, pb);
+            animation_evaluate_pose_masked(&model->skeleton, &model->clips[ci_b], ct,
+                                           anim_cursor_set_get(cursors, &model->clips[ci_b]),
+                                           joint_mask, pb);
         } else { pose_from_rest(&model->skeleton, pb); }
 
         pose_blend(pa, pb, model->skeleton.joint_count, t_proj, out_pose);
@@ -206,10 +222,10 @@ void blend_space_2d_evaluate(const BlendSpace2D *space,
     }
 
     /* Sample the 3 clips */
-    AnimPose *p0 = arena_push(scratch, AnimPose);
-    AnimPose *p1 = arena_push(scratch, AnimPose);
-    AnimPose *p2 = arena_push(scratch, AnimPose);
-    AnimPose *tmp = arena_push(scratch, AnimPose);
+    AnimPose *p0 = pose_alloc(scratch, model->skeleton.joint_count);
+    AnimPose *p1 = pose_alloc(scratch, model->skeleton.joint_count);
+    AnimPose *p2 = pose_alloc(scratch, model->skeleton.joint_count);
+    AnimPose *tmp = pose_alloc(scratch, model->skeleton.joint_count);
     if (!p0 || !p1 || !p2 || !tmp) {
         pose_from_rest(&model->skeleton, out_pose);
         return;
@@ -220,7 +236,9 @@ void blend_space_2d_evaluate(const BlendSpace2D *space,
         u32 ci = space->entries[idx[i]].clip_index;
         if (ci < model->clip_count) {
             f32 t = normalized_time * model->clips[ci].duration;
-            animation_evaluate_pose(&model->skeleton, &model->clips[ci], t, dst);
+            animation_evaluate_pose_masked(&model->skeleton, &model->clips[ci], t,
+                                           anim_cursor_set_get(cursors, &model->clips[ci]),
+                                           joint_mask, dst);
         } else {
             pose_from_rest(&model->skeleton, dst);
         }
@@ -0,0 +1,358 @@
+#include "renderer/anim_compress.h"
+#include "renderer/anim_blend.h"
+#include "renderer/animation.h"
+#include "core/log.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Tolerances for treating a channel as constant / equal to the rest pose */
+#define CONST_EPS_LINEAR    1e-5f   /* translation & scale, absolute */
+#define CONST_EPS_ROTATION  1e-7f   /* 1 - |dot| between quaternions */
+
+/* Smallest-three: the three kept components lie in [-1/sqrt2, 1/sqrt2] */
+#define QUAT_RANGE      0.70710678f
+#define QUAT_MAX_Q      32767.0f
+
+/* Slot of each kept component, indexed by the dropped (largest) one */
+static const u8 s_kept_slot[4][3] = {
+    { 1, 2, 3 }, { 0, 2, 3 }, { 0, 1, 3 }, { 0, 1, 2 },
+};
+
+/* --------------------------------------------------------------------------
+ * Quantization helpers
+ * ------------------------------------------------------------------------ */
+
+static void quat_encode(const f32 q_in[4], u16 out[3]) {
+    f32 q[4];
+    memcpy(q, q_in, sizeof(q));
+
+    f32 len = sqrtf(q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3]);
+    f32 inv = (len > 1e-12f) ? 1.0f / len : 0.0f;
+
+    u32 largest = 0;
+    for (u32 i = 0; i < 4; i++) {
+        q[i] *= inv;
+        if (fabsf(q[i]) > fabsf(q[largest])) largest = i;
+    }
+    /* q and -q are the same rotation; keep the dropped component positive */
+    f32 sign = (q[largest] < 0.0f) ? -1.0f : 1.0f;
+
+    for (u32 i = 0; i < 3; i++) {
+        f32 c = q[s_kept_slot[largest][i]] * sign;
+        f32 n = (c + QUAT_RANGE) / (2.0f * QUAT_RANGE);
+        n = ENGINE_CLAMP(n, 0.0f, 1.0f);
+        out[i] = (u16)lrintf(n * QUAT_MAX_Q);
+    }
+    out[0] |= (u16)((largest & 1u) << 15);
+    out[1] |= (u16)((largest >> 1) << 15);
+}
+
+static inline void quat_decode(const u16 in[3], f32 q[4]) {
+    u32 largest = (u32)(in[0] >> 15) | ((u32)(in[1] >> 15) << 1);
+    const f32 k = 2.0f * QUAT_RANGE / QUAT_MAX_Q;
+
+    f32 a = (f32)(in[0] & 0x7FFF) * k - QUAT_RANGE;
+    f32 b = (f32)(in[1] & 0x7FFF) * k - QUAT_RANGE;
+    f32 c = (f32)(in[2] & 0x7FFF) * k - QUAT_RANGE;
+
+    f32 rest = 1.0f - (a*a + b*b + c*c);
+    q[s_kept_slot[largest][0]] = a;
+    q[s_kept_slot[largest][1]] = b;
+    q[s_kept_slot[largest][2]] = c;
+    q[largest] = sqrtf(rest > 0.0f ? rest : 0.0f);
+}
+
+static inline void vec3_decode(const AnimQuantTrack *tr, const u16 in[3], f32 v[3]) {
+    for (u32 i = 0; i < 3; i++) {
+        v[i] = tr->min[i] + (f32)in[i] * tr->scale[i];
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Constant / redundant channel detection
+ * ------------------------------------------------------------------------ */
+
+static bool values_equal(AnimPathType path, const f32 *a, const f32 *b) {
+    if (path == ANIM_PATH_ROTATION) {
+        f32 dot = a[0]*b[0] + a[1]*b[1] + a[2]*b[2] + a[3]*b[3];
+        return 1.0f - fabsf(dot) < CONST_EPS_ROTATION;
+    }
+    return fabsf(a[0] - b[0]) < CONST_EPS_LINEAR &&
+           fabsf(a[1] - b[1]) < CONST_EPS_LINEAR &&
+           fabsf(a[2] - b[2]) < CONST_EPS_LINEAR;
+}
+
+static const f32 *rest_value(const Skeleton *skel, u32 joint, AnimPathType path) {
+    switch (path) {
+    case ANIM_PATH_TRANSLATION: return skel->rest_translations[joint];
+    case ANIM_PATH_ROTATION:    return skel->rest_rotations[joint];
+    case ANIM_PATH_SCALE:       return skel->rest_scales[joint];
+    }
+    return skel->rest_translations[joint];
+}
+
+/* A later channel on the same joint and path overrides this one at
+ * evaluation time, so this one never contributes */
+static bool channel_is_shadowed(const AnimClip *clip, u32 index) {
+    const AnimChannel *ch = &clip->channels[index];
+    for (u32 c = index + 1; c < clip->channel_count; c++) {
+        const AnimChannel *later = &clip->channels[c];
+        if (later->target_joint == ch->target_joint && later->path == ch->path &&
+            later->keyframe_count > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* --------------------------------------------------------------------------
+ * anim_clip_compress
+ * ------------------------------------------------------------------------ */
+
+EngineResult anim_clip_compress(AnimClip *clip, const Skeleton *skel, f32 sample_rate) {
+    if (clip->compressed) return ENGINE_SUCCESS;
+    if (sample_rate <= 0.0f) sample_rate = ANIM_COMPRESS_DEFAULT_RATE;
+
+    /* Uniform frames spanning [0, duration] exactly */
+    u32 frame_count = 2;
+    if (clip->duration > 0.0f) {
+        frame_count = ENGINE_MAX(2u, (u32)ceilf(clip->duration * sample_rate) + 1);
+    }
+    f32 rate = (clip->duration > 0.0f) ? (f32)(frame_count - 1) / clip->duration : 0.0f;
+
+    AnimCompressedClip *cc = calloc(1, sizeof(AnimCompressedClip));
+    f32 *samples = malloc(sizeof(f32) * 4 * frame_count);
+    u8  *kind    = calloc(clip->channel_count ? clip->channel_count : 1, 1);
+    if (!cc || !samples || !kind) goto oom;
+
+    /* Pass 1: classify each channel: 0 = dropped, 1 = constant, 2 = animated */
+    for (u32 c = 0; c < clip->channel_count; c++) {
+        const AnimChannel *ch = &clip->channels[c];
+        if (ch->keyframe_count == 0 || ch->target_joint >= skel->joint_count) continue;
+        if (channel_is_shadowed(clip, c)) continue;
+
+        f32 first[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        animation_sample_channel(ch, 0.0f, first);
+
+        bool constant = true;
+        for (u32 f = 1; f < frame_count && constant; f++) {
+            f32 v[4];
+            animation_sample_channel(ch, ENGINE_MIN((f32)f / rate, clip->duration), v);
+            constant = values_equal(ch->path, first, v);
+        }
+
+        if (!constant) {
+            kind[c] = 2;
+            cc->track_count++;
+        } else if (!values_equal(ch->path, first, rest_value(skel, ch->target_joint, ch->path))) {
+            kind[c] = 1;
+            cc->constant_count++;
+        }
+    }
+
+    cc->sample_rate  = rate;
+    cc->frame_count  = frame_count;
+    cc->frame_stride = cc->track_count * 3;
+
+    if (cc->track_count > 0) {
+        cc->tracks = calloc(cc->track_count, sizeof(AnimQuantTrack));
+        cc->frames = malloc(sizeof(u16) * cc->frame_stride * frame_count);
+        if (!cc->tracks || !cc->frames) goto oom;
+    }
+    if (cc->constant_count > 0) {
+        cc->constants = calloc(cc->constant_count, sizeof(AnimConstTrack));
+        if (!cc->constants) goto oom;
+    }
+
+    /* Pass 2: sample, measure ranges and quantize */
+    u32 ti = 0, ci = 0;
+    for (u32 c = 0; c < clip->channel_count; c++) {
+        const AnimChannel *ch = &clip->channels[c];
+
+        if (kind[c] == 1) {
+            AnimConstTrack *ct = &cc->constants[ci++];
+            ct->joint = (u16)ch->target_joint;
+            ct->path  = (u16)ch->path;
+            ct->value[3] = 1.0f;
+            animation_sample_channel(ch, 0.0f, ct->value);
+            continue;
+        }
+        if (kind[c] != 2) continue;
+
+        AnimQuantTrack *tr = &cc->tracks[ti];
+        tr->joint  = (u16)ch->target_joint;
+        tr->path   = (u16)ch->path;
+        tr->offset = ti * 3;
+        ti++;
+
+        for (u32 f = 0; f < frame_count; f++) {
+            f32 t = (f == 0) ? 0.0f : ENGINE_MIN((f32)f / rate, clip->duration);
+            animation_sample_channel(ch, t, &samples[f * 4]);
+        }
+
+        if (ch->path == ANIM_PATH_ROTATION) {
+            for (u32 f = 0; f < frame_count; f++) {
+                quat_encode(&samples[f * 4], &cc->frames[f * cc->frame_stride + tr->offset]);
+            }
+            continue;
+        }
+
+        f32 lo[3], hi[3];
+        for (u32 i = 0; i < 3; i++) lo[i] = hi[i] = samples[i];
+        for (u32 f = 1; f < frame_count; f++) {
+            for (u32 i = 0; i < 3; i++) {
+                lo[i] = fminf(lo[i], samples[f * 4 + i]);
+                hi[i] = fmaxf(hi[i], samples[f * 4 + i]);
+            }
+        }
+        for (u32 i = 0; i < 3; i++) {
+            tr->min[i]   = lo[i];
+            tr->scale[i] = (hi[i] - lo[i]) / 65535.0f;
+        }
+        for (u32 f = 0; f < frame_count; f++) {
+            u16 *dst = &cc->frames[f * cc->frame_stride + tr->offset];
+            for (u32 i = 0; i < 3; i++) {
+                f32 n = (tr->scale[i] > 0.0f) ? (samples[f * 4 + i] - lo[i]) / tr->scale[i] : 0.0f;
+                dst[i] = (u16)lrintf(ENGINE_CLAMP(n, 0.0f, 65535.0f));
+            }
+        }
+    }
+
+    free(samples);
+    free(kind);
+
+    /* The raw channels are no longer needed */
+    for (u32 c = 0; c < clip->channel_count; c++) {
+        free(clip->channels[c].timestamps);
+        free(clip->channels[c].values);
+    }
+    free(clip->channels);
+    clip->channels      = NULL;
+    clip->channel_count = 0;
+    clip->compressed    = cc;
+    return ENGINE_SUCCESS;
+
+oom:
+    LOG_ERROR("Out of memory compressing clip '%s'", clip->name);
+    free(samples);
+    free(kind);
+    anim_compressed_destroy(cc);
+    return ENGINE_ERROR_OUT_OF_MEMORY;
+}
+
+/* --------------------------------------------------------------------------
+ * skinned_model_compress_clips
+ * ------------------------------------------------------------------------ */
+
+static size_t raw_clip_bytes(const AnimClip *clip) {
+    size_t bytes = sizeof(AnimChannel) * clip->channel_count;
+    for (u32 c = 0; c < clip->channel_count; c++) {
+        const AnimChannel *ch = &clip->channels[c];
+        u32 components = (ch->path == ANIM_PATH_ROTATION) ? 4 : 3;
+        u32 per_key    = (ch->interpolation == ANIM_INTERP_CUBICSPLINE) ? 3 : 1;
+        bytes += sizeof(f32) * ch->keyframe_count * (1 + components * per_key);
+    }
+    return bytes;
+}
+
+static size_t compressed_clip_bytes(const AnimCompressedClip *cc) {
+    return sizeof(*cc) +
+           sizeof(AnimQuantTrack) * cc->track_count +
+           sizeof(AnimConstTrack) * cc->constant_count +
+           sizeof(u16) * cc->frame_stride * cc->frame_count;
+}
+
+EngineResult skinned_model_compress_clips(SkinnedModel *model, f32 sample_rate) {
+    size_t before = 0, after = 0;
+    EngineResult result = ENGINE_SUCCESS;
+
+    for (u32 c = 0; c < model->clip_count; c++) {
+        AnimClip *clip = &model->clips[c];
+        if (!clip->compressed) before += raw_clip_bytes(clip);
+
+        EngineResult res = anim_clip_compress(clip, &model->skeleton, sample_rate);
+        if (res != ENGINE_SUCCESS) {
+            result = res;
+            after += raw_clip_bytes(clip);
+            continue;
+        }
+        after += compressed_clip_bytes(clip->compressed);
+    }
+
+    LOG_INFO("Compressed %u animation clips: %zu KB -> %zu KB",
+             model->clip_count, before / 1024, after / 1024);
+    return result;
+}
+
+/* --------------------------------------------------------------------------
+ * anim_compressed_evaluate — two frames, one lerp per track, no searching
+ * ------------------------------------------------------------------------ */
+
+void anim_compressed_evaluate(const AnimCompressedClip *cc, f32 duration,
+                              f32 time, const f32 *joint_weights, AnimPose *out_pose) {
+    for (u32 i = 0; i < cc->constant_count; i++) {
+        const AnimConstTrack *ct = &cc->constants[i];
+        if (joint_weights && joint_weights[ct->joint] <= 0.0f) continue;
+        switch ((AnimPathType)ct->path) {
+        case ANIM_PATH_TRANSLATION: pose_set_translation(out_pose, ct->joint, ct->value); break;
+        case ANIM_PATH_ROTATION:    pose_set_rotation(out_pose, ct->joint, ct->value);    break;
+        case ANIM_PATH_SCALE:       pose_set_scale(out_pose, ct->joint, ct->value);       break;
+        }
+    }
+    if (cc->track_count == 0) return;
+
+    f32 f = ENGINE_CLAMP(time, 0.0f, duration) * cc->sample_rate;
+    u32 i0 = ENGINE_MIN((u32)f, cc->frame_count - 2);
+    f32 alpha = ENGINE_CLAMP(f - (f32)i0, 0.0f, 1.0f);
+
+    const u16 *fa = cc->frames + (size_t)i0 * cc->frame_stride;
+    const u16 *fb = fa + cc->frame_stride;
+
+    for (u32 i = 0; i < cc->track_count; i++) {
+        const AnimQuantTrack *tr = &cc->tracks[i];
+        if (joint_weights && joint_weights[tr->joint] <= 0.0f) continue;
+        const u16 *qa = fa + tr->offset;
+        const u16 *qb = fb + tr->offset;
+
+        if (tr->path == ANIM_PATH_ROTATION) {
+            f32 a[4], b[4], q[4];
+            quat_decode(qa, a);
+            quat_decode(qb, b);
+
+            /* Shortest-path nlerp between adjacent frames */
+            f32 dot = a[0]*b[0] + a[1]*b[1] + a[2]*b[2] + a[3]*b[3];
+            f32 wb = (dot < 0.0f) ? -alpha : alpha;
+            f32 wa = 1.0f - alpha;
+            f32 len2 = 0.0f;
+            for (u32 k = 0; k < 4; k++) {
+                q[k] = a[k] * wa + b[k] * wb;
+                len2 += q[k] * q[k];
+            }
+            f32 inv = 1.0f / sqrtf(len2);
+            for (u32 k = 0; k < 4; k++) q[k] *= inv;
+            pose_set_rotation(out_pose, tr->joint, q);
+            continue;
+        }
+
+        f32 a[3], b[3], v[3];
+        vec3_decode(tr, qa, a);
+        vec3_decode(tr, qb, b);
+        for (u32 k = 0; k < 3; k++) v[k] = a[k] + (b[k] - a[k]) * alpha;
+
+        if (tr->path == ANIM_PATH_TRANSLATION) {
+            pose_set_translation(out_pose, tr->joint, v);
+        } else {
+            pose_set_scale(out_pose, tr->joint, v);
+        }
+    }
+}
+
+void anim_compressed_destroy(AnimCompressedClip *cc) {
+    if (!cc) return;
+    free(cc->tracks);
+    free(cc->constants);
+    free(cc->frames);
+    free(cc);
+}
@@ -0,0 +1,27 @@
+#ifndef ENGINE_ANIM_COMPRESS_H
+#define ENGINE_ANIM_COMPRESS_H
+
+#include "core/common.h"
+#include "renderer/animation_types.h"
+
+#define ANIM_COMPRESS_DEFAULT_RATE 30.0f
+
+/* Convert every clip of a loaded model to the compressed representation
+ * (see AnimCompressedClip) and free the raw f32 channels. Optional: call once
+ * after renderer_load_skinned_model(). sample_rate 0 = default (30 Hz).
+ * Clips that fail to convert keep their raw channels. */
+EngineResult skinned_model_compress_clips(SkinnedModel *model, f32 sample_rate);
+
+/* Resample one clip. On success clip->compressed is set and the raw channels
+ * are freed. */
+EngineResult anim_clip_compress(AnimClip *clip, const Skeleton *skel, f32 sample_rate);
+
+/* Write the clip's animated joints at `time` into the pose (untouched joints
+ * keep whatever the caller put there, normally the rest pose).
+ * joint_weights: optional per-joint weights; joints at 0 are not written. */
+void anim_compressed_evaluate(const AnimCompressedClip *cc, f32 duration,
+                              f32 time, const f32 *joint_weights, AnimPose *out_pose);
+
+void anim_compressed_destroy(AnimCompressedClip *cc);
+
+#endif /* ENGINE_ANIM_COMPRESS_H */
@@ -2,18 +2,16 @@
 #include "renderer/anim_blend.h"
 #include "renderer/animation.h"
 #include "core/log.h"
+#include "core/jobs.h"
+#include "core/profile.h"
 
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 
-/* Forward declarations for blend space functions (in anim_blend_space.c) */
-void blend_space_1d_evaluate(const BlendSpace1D *space, f32 param_value,
-                              const SkinnedModel *model, f32 normalized_time,
-                              Arena *scratch, AnimPose *out_pose);
-void blend_space_2d_evaluate(const BlendSpace2D *space, f32 param_x, f32 param_y,
-                              const SkinnedModel *model, f32 normalized_time,
-                              Arena *scratch, AnimPose *out_pose);
+/* Spreads reduced-rate updates of instances created back to back over
+ * different frames */
+static u32 lod_stagger;
 
 /* ================================================================
  * GRAPH DEFINITION — creation, configuration, destruction
@@ -296,6 +294,7 @@ AnimGraphInstance *anim_graph_instance_create(const AnimGraphDef *def,
 
     inst->def = def;
     inst->joint_count = model->skeleton.joint_count;
+    inst->lod_tick = lod_stagger++;
 
     /* Initialize parameters with defaults */
     for (u32 i = 0; i < def->param_count; i++) {
@@ -305,11 +304,31 @@ AnimGraphInstance *anim_graph_instance_create(const AnimGraphDef *def,
             inst->params.values[i].b = def->params[i].default_value.b;
     }
 
+    /* Cursor keys: one run per cursor, sized for the model's longest clip */
+    u32 channels = 0;
+    for (u32 c = 0; c < model->clip_count; c++) {
+        channels = ENGINE_MAX(channels, model->clips[c].channel_count);
+    }
+    u32 cursors = def->layer_count * ANIM_CURSOR_SET_SIZE;
+    if (channels > 0 && cursors > 0) {
+        inst->cursor_keys = calloc((size_t)cursors * channels, sizeof(u16));
+        if (!inst->cursor_keys) {
+            free(inst);
+            return NULL;
+        }
+    }
+
     /* Initialize layer states */
     for (u32 l = 0; l < def->layer_count; l++) {
         AnimLayerState *ls = &inst->layer_states[l];
         ls->current_state = def->layers[l].default_state;
         ls->state_time = 0.0f;
+
+        for (u32 c = 0; c < ANIM_CURSOR_SET_SIZE && inst->cursor_keys; c++) {
+            ls->cursors.cursors[c].keys =
+                inst->cursor_keys + ((size_t)l * ANIM_CURSOR_SET_SIZE + c) * channels;
+            ls->cursors.cursors[c].capacity = channels;
+        }
     }
 
     /* Identity joint matrices */
@@ -325,6 +344,8 @@ AnimGraphInstance *anim_graph_instance_create(const AnimGraphDef *def,
 }
 
 void anim_graph_instance_destroy(AnimGraphInstance *instance) {
+    if (!instance) return;
+    free(instance->cursor_keys);
     free(instance);
 }
 
@@ -444,15 +465,18 @@ static f32 get_state_duration(const AnimStateNode *state, const SkinnedModel *mo
  * ================================================================ */
 
 static void evaluate_state(const AnimStateNode *state, const SkinnedModel *model,
-                            const AnimParamValues *params,
-                            f32 state_time, Arena *scratch, AnimPose *out_pose) {
+                            const AnimParamValues *params, f32 state_time,
+                            Arena *scratch, AnimCursorSet *cursors,
+                            const BoneMask *joint_mask, AnimPose *out_pose) {
     const Skeleton *skel = &model->skeleton;
 
     switch (state->type) {
     case ANIM_STATE_CLIP: {
         u32 ci = state->data.clip_index;
         if (ci < model->clip_count) {
-            animation_evaluate_pose(skel, &model->clips[ci], state_time, out_pose);
+            animation_evaluate_pose_masked(skel, &model->clips[ci], state_time,
+                                           anim_cursor_set_get(cursors, &model->clips[ci]),
+                                           joint_mask, out_pose);
         } else {
             pose_from_rest(skel, out_pose);
         }
@@ -463,7 +487,7 @@ static void evaluate_state(const AnimStateNode *state, const SkinnedModel *model
         f32 norm_t = (dur > 1e-6f) ? state_time / dur : 0.0f;
         blend_space_1d_evaluate(&state->data.blend1d,
                                  params->values[state->data.blend1d.param_index].f,
-                                 model, norm_t, scratch, out_pose);
+                                 model, norm_t, scratch, cursors, joint_mask, out_pose);
         break;
     }
     case ANIM_STATE_BLEND2D: {
@@ -472,7 +496,7 @@ static void evaluate_state(const AnimStateNode *state, const SkinnedModel *model
         blend_space_2d_evaluate(&state->data.blend2d,
                                  params->values[state->data.blend2d.param_x_index].f,
                                  params->values[state->data.blend2d.param_y_index].f,
-                                 model, norm_t, scratch, out_pose);
+                                 model, norm_t, scratch, cursors, joint_mask, out_pose);
         break;
     }
     }
@@ -482,10 +506,20 @@ static void evaluate_state(const AnimStateNode *state, const SkinnedModel *model
  * INTERNAL: fire events that were crossed between prev_time and curr_time
  * ================================================================ */
 
-static void fire_events(const AnimEventList *events, f32 prev_time, f32 curr_time,
-                         f32 duration, bool looping,
-                         AnimEventCallback callback, void *user_data) {
-    if (!events || !callback || events->event_count == 0) return;
+static void emit_event(AnimGraphInstance *inst, const AnimEvent *ev, bool defer) {
+    if (!defer) {
+        inst->event_callback(inst->event_user_data, ev->event_id, ev->name);
+    } else if (inst->pending_event_count < ANIM_MAX_PENDING_EVENTS) {
+        inst->pending_events[inst->pending_event_count++] = ev;
+    }
+}
+
+/* Fire (or, when deferring, queue on the instance) every event crossed
+ * between prev_time and curr_time */
+static void fire_events(AnimGraphInstance *inst, const AnimEventList *events,
+                         f32 prev_time, f32 curr_time,
+                         f32 duration, bool looping, bool defer) {
+    if (!events || !inst->event_callback || events->event_count == 0) return;
     (void)duration;  /* duration implicitly bounded by curr_time wrap */
 
     if (!looping || curr_time >= prev_time) {
@@ -493,8 +527,7 @@ static void fire_events(const AnimEventList *events, f32 prev_time, f32 curr_tim
         for (u32 i = 0; i < events->event_count; i++) {
             f32 et = events->events[i].time;
             if (et > prev_time && et <= curr_time) {
-                callback(user_data, events->events[i].event_id,
-                         events->events[i].name);
+                emit_event(inst, &events->events[i], defer);
             }
         }
     } else {
@@ -502,27 +535,84 @@ static void fire_events(const AnimEventList *events, f32 prev_time, f32 curr_tim
         for (u32 i = 0; i < events->event_count; i++) {
             f32 et = events->events[i].time;
             if (et > prev_time || et <= curr_time) {
-                callback(user_data, events->events[i].event_id,
-                         events->events[i].name);
+                emit_event(inst, &events->events[i], defer);
             }
         }
     }
 }
 
+/* ================================================================
+ * ANIMATION LOD
+ * ================================================================ */
+
+void anim_lod_policy_default(AnimLodPolicy *policy) {
+    memset(policy, 0, sizeof(*policy));
+    policy->level_count = 3;
+
+    policy->levels[0].update_interval = 1;
+    policy->min_screen_size[0]        = 0.25f;
+
+    policy->levels[1].update_interval = 2;
+    policy->min_screen_size[1]        = 0.08f;
+
+    policy->levels[2].update_interval     = 4;
+    policy->levels[2].skip_overlay_layers = true;
+    policy->min_screen_size[2]            = 0.0f;
+}
+
+f32 anim_lod_screen_size(f32 radius, f32 distance, f32 fov_y) {
+    f32 half = distance * tanf(fov_y * 0.5f);
+    return (half > 1e-6f) ? radius / half : 1.0f;
+}
+
+u32 anim_lod_select(const AnimLodPolicy *policy, f32 screen_size) {
+    if (!policy || policy->level_count == 0) return 0;
+    for (u32 i = 0; i + 1 < policy->level_count; i++) {
+        if (screen_size >= policy->min_screen_size[i]) return i;
+    }
+    return policy->level_count - 1;
+}
+
+void anim_graph_set_lod(AnimGraphInstance *inst, const AnimLodPolicy *policy, u32 level) {
+    inst->lod_policy = policy;
+    inst->lod_level  = level;
+}
+
+static bool lod_skips_layer(const AnimLodLevel *lod, const AnimGraphDef *def, u32 layer) {
+    if (!lod || !lod->skip_overlay_layers || layer == 0) return false;
+    const AnimLayerDef *ld = &def->layers[layer];
+    return ld->blend_mode == ANIM_LAYER_ADDITIVE || ld->bone_mask != NULL;
+}
+
 /* ================================================================
  * anim_graph_update — the main per-frame entry point
  * ================================================================ */
 
-void anim_graph_update(AnimGraphInstance *inst, const SkinnedModel *model,
-                        f32 delta_time, Arena *scratch) {
+static void graph_update(AnimGraphInstance *inst, const SkinnedModel *model,
+                         f32 delta_time, Arena *scratch, bool defer_events) {
     const AnimGraphDef *def = inst->def;
     const Skeleton *skel = &model->skeleton;
     u32 jc = skel->joint_count;
 
+    /* LOD: reduced-rate levels keep the previous joint matrices and bank the
+     * time, so the next real update (and its events) covers the whole gap */
+    const AnimLodLevel *lod = NULL;
+    if (inst->lod_policy && inst->lod_policy->level_count > 0) {
+        lod = &inst->lod_policy->levels[ENGINE_MIN(inst->lod_level,
+                                                   inst->lod_policy->level_count - 1)];
+        u32 interval = ENGINE_MAX(lod->update_interval, 1u);
+        inst->lod_pending_dt += delta_time;
+        u32 tick = inst->lod_tick++;
+        if (inst->lod_evaluated && tick % interval != 0) return;
+        delta_time = inst->lod_pending_dt;
+        inst->lod_pending_dt = 0.0f;
+    }
+    const BoneMask *joint_mask = lod ? lod->joint_mask : NULL;
+
     /* We need one pose per layer, plus a final composite pose */
     AnimPose *layer_poses[ANIM_MAX_LAYERS];
     for (u32 l = 0; l < def->layer_count; l++) {
-        layer_poses[l] = arena_push(scratch, AnimPose);
+        layer_poses[l] = pose_alloc(scratch, jc);
         if (!layer_poses[l]) {
             LOG_ERROR("anim_graph_update: scratch arena out of memory");
             return;
@@ -577,10 +667,26 @@ void anim_graph_update(AnimGraphInstance *inst, const SkinnedModel *model,
         }
         ls->state_normalized = (cur_duration > 1e-6f) ? ls->state_time / cur_duration : 0.0f;
 
+        /* Overlay layer dropped by LOD: keep its clock and events running so
+         * it resumes in step, but don't sample or composite it */
+        if (lod_skips_layer(lod, def, l)) {
+            if (ls->transitioning) {
+                ls->transition_elapsed += delta_time;
+                if (ls->transition_elapsed >= ls->transition_duration) ls->transitioning = false;
+            }
+            if (cur_state->events && inst->event_callback) {
+                fire_events(inst, cur_state->events, prev_time, ls->state_time,
+                             cur_duration, cur_state->looping, defer_events);
+            }
+            ls->prev_event_time = ls->state_time;
+            continue;
+        }
+
         /* 3. Evaluate current state */
-        AnimPose *cur_pose = arena_push(scratch, AnimPose);
+        AnimPose *cur_pose = pose_alloc(scratch, jc);
         if (!cur_pose) { pose_from_rest(skel, layer_poses[l]); continue; }
-        evaluate_state(cur_state, model, &inst->params, ls->state_time, scratch, cur_pose);
+        evaluate_state(cur_state, model, &inst->params, ls->state_time,
+                       scratch, &ls->cursors, joint_mask, cur_pose);
 
         /* 4. If transitioning, evaluate previous state and blend */
         if (ls->transitioning) {
@@ -596,10 +702,10 @@ void anim_graph_update(AnimGraphInstance *inst, const SkinnedModel *model,
                 if (ls->prev_state_time > prev_dur) ls->prev_state_time = prev_dur;
             }
 
-            AnimPose *prev_pose = arena_push(scratch, AnimPose);
+            AnimPose *prev_pose = pose_alloc(scratch, jc);
             if (prev_pose) {
-                evaluate_state(prev_state, model, &inst->params,
-                               ls->prev_state_time, scratch, prev_pose);
+                evaluate_state(prev_state, model, &inst->params, ls->prev_state_time,
+                               scratch, &ls->cursors, joint_mask, prev_pose);
 
                 ls->transition_elapsed += delta_time;
                 f32 blend_factor = (ls->transition_duration > 1e-6f)
@@ -621,9 +727,8 @@ void anim_graph_update(AnimGraphInstance *inst, const SkinnedModel *model,
 
         /* 5. Fire events */
         if (cur_state->events && inst->event_callback) {
-            fire_events(cur_state->events, prev_time, ls->state_time,
-                         cur_duration, cur_state->looping,
-                         inst->event_callback, inst->event_user_data);
+            fire_events(inst, cur_state->events, prev_time, ls->state_time,
+                         cur_duration, cur_state->looping, defer_events);
         }
         ls->prev_event_time = ls->state_time;
     }
@@ -631,10 +736,15 @@ void anim_graph_update(AnimGraphInstance *inst, const SkinnedModel *model,
     /* Composite layers */
     if (def->layer_count == 0) {
         /* No layers: rest pose */
-        AnimPose rest;
-        pose_from_rest(skel, &rest);
-        animation_pose_to_matrices(&rest, skel, inst->joint_matrices, scratch);
+        AnimPose *rest = pose_alloc(scratch, jc);
+        if (!rest) {
+            LOG_ERROR("anim_graph_update: scratch arena out of memory");
+            return;
+        }
+        pose_from_rest(skel, rest);
+        animation_pose_to_matrices(rest, skel, inst->joint_matrices, scratch);
         inst->joint_count = jc;
+        inst->lod_evaluated = true;
         return;
     }
 
@@ -642,7 +752,8 @@ void anim_graph_update(AnimGraphInstance *inst, const SkinnedModel *model,
 
     for (u32 l = 1; l < def->layer_count; l++) {
         const AnimLayerDef *layer_def = &def->layers[l];
-        AnimPose *composite = arena_push(scratch, AnimPose);
+        if (lod_skips_layer(lod, def, l)) continue;
+        AnimPose *composite = pose_alloc(scratch, jc);
         if (!composite) break;
 
         if (layer_def->blend_mode == ANIM_LAYER_OVERRIDE) {
@@ -653,7 +764,7 @@ void anim_graph_update(AnimGraphInstance *inst, const SkinnedModel *model,
                 pose_blend(final_pose, layer_poses[l], jc, layer_def->weight, composite);
             }
         } else { /* ANIM_LAYER_ADDITIVE */
-            AnimPose *ref = arena_push(scratch, AnimPose);
+            AnimPose *ref = pose_alloc(scratch, jc);
             if (ref) {
                 pose_from_rest(skel, ref);
                 pose_blend_additive(final_pose, layer_poses[l], ref, jc,
@@ -669,4 +780,62 @@ void anim_graph_update(AnimGraphInstance *inst, const SkinnedModel *model,
     /* Convert final pose to skinning matrices */
     animation_pose_to_matrices(final_pose, skel, inst->joint_matrices, scratch);
     inst->joint_count = jc;
+    inst->lod_evaluated = true;
+}
+
+void anim_graph_update(AnimGraphInstance *inst, const SkinnedModel *model,
+                        f32 delta_time, Arena *scratch) {
+    PROFILE_ZONE_BEGIN("anim_graph_update");
+    graph_update(inst, model, delta_time, scratch, false);
+    PROFILE_ZONE_END();
+}
+
+/* ================================================================
+ * anim_graph_update_batch — many instances across the job system
+ * ================================================================ */
+
+/* Instances per job chunk: one update is tens of microseconds, so a few per
+ * chunk keeps the claim overhead small without starving idle threads. */
+#define ANIM_BATCH_GRAIN 4
+
+typedef struct {
+    AnimGraphInstance        **insts;
+    const SkinnedModel *const *models;
+    f32                        delta_time;
+} AnimBatch;
+
+static void anim_batch_range(void *data, u32 begin, u32 end) {
+    const AnimBatch *batch = data;
+    Arena *scratch = jobs_scratch();
+
+    PROFILE_ZONE_BEGIN("anim_batch_range");
+    for (u32 i = begin; i < end; i++) {
+        /* Every instance starts from the same scratch mark */
+        ArenaMark mark = arena_mark(scratch);
+        graph_update(batch->insts[i], batch->models[i], batch->delta_time, scratch, true);
+        arena_pop_to(scratch, mark);
+    }
+    PROFILE_ZONE_END();
+}
+
+void anim_graph_update_batch(AnimGraphInstance **insts, const SkinnedModel *const *models,
+                              u32 count, f32 delta_time) {
+    PROFILE_ZONE_BEGIN("anim_graph_update_batch");
+    for (u32 i = 0; i < count; i++) {
+        insts[i]->pending_event_count = 0;
+    }
+
+    AnimBatch batch = { insts, models, delta_time };
+    jobs_parallel_for(count, ANIM_BATCH_GRAIN, anim_batch_range, &batch);
+
+    /* Flush deferred events here, in instance order, on the calling thread */
+    for (u32 i = 0; i < count; i++) {
+        AnimGraphInstance *inst = insts[i];
+        for (u32 e = 0; e < inst->pending_event_count; e++) {
+            const AnimEvent *ev = inst->pending_events[e];
+            inst->event_callback(inst->event_user_data, ev->event_id, ev->name);
+        }
+        inst->pending_event_count = 0;
+    }
+    PROFILE_ZONE_END();
 }
@@ -74,6 +74,19 @@ BoneMask *bone_mask_create_excluding_joint(const Skeleton *skeleton,
                                             u32 exclude_root_index);
 void bone_mask_destroy(BoneMask *mask);
 
+/* ---- Blend spaces (anim_blend_space.c) ----
+ * Sample the clips around the parameter position at normalized_time (0..1 of
+ * each clip) and blend them into out_pose. scratch holds the intermediate
+ * poses; cursors and joint_mask may be NULL. */
+void blend_space_1d_evaluate(const BlendSpace1D *space, f32 param_value,
+                              const SkinnedModel *model, f32 normalized_time,
+                              Arena *scratch, AnimCursorSet *cursors,
+                              const BoneMask *joint_mask, AnimPose *out_pose);
+void blend_space_2d_evaluate(const BlendSpace2D *space, f32 param_x, f32 param_y,
+                              const SkinnedModel *model, f32 normalized_time,
+                              Arena *scratch, AnimCursorSet *cursors,
+                              const BoneMask *joint_mask, AnimPose *out_pose);
+
 /* ================================================================
  * GRAPH INSTANCE — per-entity runtime (create, update, destroy)
  * ================================================================ */
@@ -92,8 +105,32 @@ void anim_graph_set_param_bool_by_name(AnimGraphInstance *inst, const char *name
 void anim_graph_set_event_callback(AnimGraphInstance *inst,
                                     AnimEventCallback callback, void *user_data);
 
+/* ---- Animation LOD ---- */
+
+/* Three levels: full rate, every 2nd update, every 4th update without
+ * overlay layers. Joint masks are left NULL (skeleton specific). */
+void anim_lod_policy_default(AnimLodPolicy *policy);
+
+/* Projected size of a bounding sphere as a fraction of the viewport height */
+f32  anim_lod_screen_size(f32 radius, f32 distance, f32 fov_y);
+
+/* Level of `policy` for a projected screen size */
+u32  anim_lod_select(const AnimLodPolicy *policy, f32 screen_size);
+
+/* Attach a policy (NULL = always full quality) and pick a level. Reduced rate
+ * levels reuse the last joint matrices between updates; updates are staggered
+ * across instances so the per-frame cost stays flat. */
+void anim_graph_set_lod(AnimGraphInstance *inst, const AnimLodPolicy *policy, u32 level);
+
 /* ---- Update (the main entry point each frame) ---- */
 void anim_graph_update(AnimGraphInstance *inst, const SkinnedModel *model,
                         f32 delta_time, Arena *scratch);
 
+/* Update `count` instances (insts[i] animates models[i]) spread across the
+ * job system, each thread using its own scratch arena. Event callbacks are
+ * deferred and fired on the calling thread before this returns, so they may
+ * touch game state freely. Instances must be distinct. */
+void anim_graph_update_batch(AnimGraphInstance **insts, const SkinnedModel *const *models,
+                              u32 count, f32 delta_time);
+
 #endif /* ENGINE_ANIM_GRAPH_H */
@@ -186,6 +186,7 @@ typedef struct {
  * ================================================================ */
 
 #define ANIM_MAX_LAYERS 4
+#define ANIM_MAX_PENDING_EVENTS 16  /* deferred events per instance per batch */
 
 typedef struct {
     AnimParamDef    params[ANIM_MAX_PARAMS];
@@ -213,8 +214,32 @@ typedef struct {
 
     /* Event tracking */
     f32   prev_event_time;      /* last time at which events were checked */
+
+    /* Keyframe hints for the clips this layer samples */
+    AnimCursorSet cursors;
 } AnimLayerState;
 
+/* ================================================================
+ * ANIMATION LOD — cheaper updates for distant / small instances
+ * ================================================================ */
+
+#define ANIM_LOD_MAX_LEVELS 4
+
+typedef struct {
+    u32             update_interval;     /* evaluate every Nth update (1 = every frame) */
+    bool            skip_overlay_layers; /* drop additive and masked layers above layer 0 */
+    const BoneMask *joint_mask;          /* joints at weight 0 stay at rest and are not
+                                            sampled; NULL = full skeleton (not owned) */
+} AnimLodLevel;
+
+/* Level i is used while the projected screen size is >= min_screen_size[i];
+ * levels go from most to least detailed, the last one catching everything. */
+typedef struct {
+    AnimLodLevel levels[ANIM_LOD_MAX_LEVELS];
+    f32          min_screen_size[ANIM_LOD_MAX_LEVELS];
+    u32          level_count;
+} AnimLodPolicy;
+
 /* ================================================================
  * GRAPH INSTANCE — per-entity runtime state
  * ================================================================ */
@@ -228,6 +253,21 @@ typedef struct {
     AnimEventCallback     event_callback;
     void                 *event_user_data;
 
+    /* Backing store for every layer's cursor keys (owned) */
+    u16                  *cursor_keys;
+
+    /* Events crossed during anim_graph_update_batch, fired on the calling
+     * thread once every instance has been evaluated */
+    const AnimEvent      *pending_events[ANIM_MAX_PENDING_EVENTS];
+    u32                   pending_event_count;
+
+    /* Animation LOD (policy NULL = full update every frame) */
+    const AnimLodPolicy  *lod_policy;     /* not owned */
+    u32                   lod_level;
+    u32                   lod_tick;       /* staggered per instance at create */
+    f32                   lod_pending_dt; /* time accumulated over skipped updates */
+    bool                  lod_evaluated;  /* joint_matrices hold a real pose */
+
     /* Output */
     f32   joint_matrices[MAX_JOINTS][16];
     u32   joint_count;
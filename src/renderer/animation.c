@@ -1,4 +1,7 @@
 #include "renderer/animation.h"
+#include "renderer/anim_blend.h"
+#include "renderer/anim_compress.h"
+#include "renderer/anim_graph_types.h"
 #include "core/log.h"
 
 #include <cglm/mat4.h>
@@ -27,13 +30,60 @@ static u32 find_keyframe(const f32 *timestamps, u32 count, f32 time) {
     return lo;
 }
 
+/* --------------------------------------------------------------------------
+ * Cursor lookup: try the hinted pair and the one after it before falling back
+ * to binary search. Same result as find_keyframe for first < time < last.
+ * ------------------------------------------------------------------------ */
+
+static u32 find_keyframe_hinted(const f32 *timestamps, u32 count, f32 time, u16 *hint) {
+    if (!hint) return find_keyframe(timestamps, count, time);
+
+    u32 k = *hint;
+    if (k + 1 < count && timestamps[k] <= time) {
+        if (time < timestamps[k + 1]) return k;
+        if (k + 2 < count && time < timestamps[k + 2]) {
+            *hint = (u16)(k + 1);
+            return k + 1;
+        }
+    }
+
+    k = find_keyframe(timestamps, count, time);
+    if (k <= UINT16_MAX) *hint = (u16)k;
+    return k;
+}
+
+static void anim_cursor_reset(AnimCursor *cursor, const AnimClip *clip) {
+    cursor->clip = clip;
+    if (cursor->keys) memset(cursor->keys, 0, sizeof(u16) * cursor->capacity);
+}
+
+AnimCursor *anim_cursor_set_get(AnimCursorSet *set, const AnimClip *clip) {
+    if (!set) return NULL;
+
+    u32 stamp = ++set->tick;
+    AnimCursor *lru = &set->cursors[0];
+    for (u32 i = 0; i < ANIM_CURSOR_SET_SIZE; i++) {
+        AnimCursor *c = &set->cursors[i];
+        if (c->clip == clip) {
+            c->last_used = stamp;
+            return c;
+        }
+        if (c->last_used < lru->last_used) lru = c;
+    }
+
+    anim_cursor_reset(lru, clip);
+    lru->last_used = stamp;
+    return lru;
+}
+
 /* --------------------------------------------------------------------------
  * Sample a single animation channel at the given time.
  * Writes the interpolated value to `out`.
  * For TRANSLATION/SCALE: 3 floats. For ROTATION: 4 floats (quaternion xyzw).
+ * hint: optional cursor slot for this channel.
  * ------------------------------------------------------------------------ */
 
-static void sample_channel(const AnimChannel *ch, f32 time, f32 *out) {
+static void sample_channel(const AnimChannel *ch, f32 time, u16 *hint, f32 *out) {
     u32 components = (ch->path == ANIM_PATH_ROTATION) ? 4 : 3;
 
     if (ch->keyframe_count == 0) return;
@@ -62,7 +112,7 @@ static void sample_channel(const AnimChannel *ch, f32 time, f32 *out) {
     }
 
     /* Find bracketing keyframes */
-    u32 k0 = find_keyframe(ch->timestamps, ch->keyframe_count, time);
+    u32 k0 = find_keyframe_hinted(ch->timestamps, ch->keyframe_count, time, hint);
     u32 k1 = k0 + 1;
     f32 t0 = ch->timestamps[k0];
     f32 t1 = ch->timestamps[k1];
@@ -123,6 +173,10 @@ static void sample_channel(const AnimChannel *ch, f32 time, f32 *out) {
     }
 }
 
+void animation_sample_channel(const AnimChannel *ch, f32 time, f32 *out) {
+    sample_channel(ch, time, NULL, out);
+}
+
 /* --------------------------------------------------------------------------
  * animation_evaluate_pose — public function.
  * Evaluate all channels in a clip at time t to produce per-joint local TRS.
@@ -130,103 +184,173 @@ static void sample_channel(const AnimChannel *ch, f32 time, f32 *out) {
  * ------------------------------------------------------------------------ */
 
 void animation_evaluate_pose(const Skeleton *skel, const AnimClip *clip,
-                              f32 time, AnimPose *out_pose) {
-    /* Start from rest pose */
-    for (u32 j = 0; j < skel->joint_count; j++) {
-        memcpy(out_pose->translations[j], skel->rest_translations[j], sizeof(f32) * 3);
-        memcpy(out_pose->rotations[j],    skel->rest_rotations[j],    sizeof(f32) * 4);
-        memcpy(out_pose->scales[j],       skel->rest_scales[j],       sizeof(f32) * 3);
+                              f32 time, AnimCursor *cursor, AnimPose *out_pose) {
+    animation_evaluate_pose_masked(skel, clip, time, cursor, NULL, out_pose);
+}
+
+/* Joints with mask weight 0 are skipped entirely (left at rest) so a reduced
+ * LOD joint set costs proportionally less to sample. */
+void animation_evaluate_pose_masked(const Skeleton *skel, const AnimClip *clip,
+                                     f32 time, AnimCursor *cursor,
+                                     const BoneMask *joint_mask, AnimPose *out_pose) {
+    const f32 *joint_weights = joint_mask ? joint_mask->weights : NULL;
+
+    if (clip->compressed) {
+        pose_from_rest(skel, out_pose);
+        anim_compressed_evaluate(clip->compressed, clip->duration, time,
+                                 joint_weights, out_pose);
+        return;
     }
 
+    if (cursor && cursor->clip != clip) anim_cursor_reset(cursor, clip);
+    u32 hinted = (cursor && cursor->keys) ? ENGINE_MIN(cursor->capacity, clip->channel_count) : 0;
+
+    /* Start from rest pose */
+    pose_from_rest(skel, out_pose);
+
     /* Override with animated channels */
     for (u32 c = 0; c < clip->channel_count; c++) {
         const AnimChannel *ch = &clip->channels[c];
         u32 j = ch->target_joint;
-        if (j >= skel->joint_count) continue;
+        if (j >= skel->joint_count || ch->keyframe_count == 0) continue;
+        if (joint_weights && joint_weights[j] <= 0.0f) continue;
 
+        u16 *hint = (c < hinted) ? &cursor->keys[c] : NULL;
+        f32 v[4];
         switch (ch->path) {
         case ANIM_PATH_TRANSLATION:
-            sample_channel(ch, time, out_pose->translations[j]);
+            sample_channel(ch, time, hint, v);
+            pose_set_translation(out_pose, j, v);
             break;
         case ANIM_PATH_ROTATION:
-            sample_channel(ch, time, out_pose->rotations[j]);
+            sample_channel(ch, time, hint, v);
+            pose_set_rotation(out_pose, j, v);
             break;
         case ANIM_PATH_SCALE:
-            sample_channel(ch, time, out_pose->scales[j]);
+            sample_channel(ch, time, hint, v);
+            pose_set_scale(out_pose, j, v);
             break;
         }
     }
 }
 
 /* --------------------------------------------------------------------------
- * animation_pose_to_matrices — public function.
- * Convert a local-space AnimPose to final joint skinning matrices.
- * Builds T*R*S -> parent chain -> inverse bind.
- * Uses scratch arena for temporary mat4 arrays.
+ * Affine 3x4 helpers (row-major, implicit last row 0 0 0 1)
  * ------------------------------------------------------------------------ */
 
-void animation_pose_to_matrices(const AnimPose *pose, const Skeleton *skel,
-                                 f32 out_joint_matrices[][16], Arena *scratch) {
-    u32 jc = skel->joint_count;
+/* T * R * S written straight into a 3x4: rotation columns scaled by s */
+static inline void affine_from_trs(const f32 t[3], const f32 q[4], const f32 s[3],
+                                   f32 m[JOINT_AFFINE_FLOATS]) {
+    f32 n2 = q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3];
+    f32 k  = (n2 > 0.0f) ? 2.0f / n2 : 0.0f;
 
-    /* Allocate temp arrays from arena */
-    mat4 *local_transforms  = arena_push_array(scratch, mat4, jc);
-    mat4 *global_transforms = arena_push_array(scratch, mat4, jc);
+    f32 xx = q[0]*q[0]*k, yy = q[1]*q[1]*k, zz = q[2]*q[2]*k;
+    f32 xy = q[0]*q[1]*k, xz = q[0]*q[2]*k, yz = q[1]*q[2]*k;
+    f32 wx = q[3]*q[0]*k, wy = q[3]*q[1]*k, wz = q[3]*q[2]*k;
 
-    if (!local_transforms || !global_transforms) {
-        LOG_ERROR("animation_pose_to_matrices: scratch arena out of memory");
-        for (u32 j = 0; j < jc; j++)
-            glm_mat4_identity((vec4 *)out_joint_matrices[j]);
-        return;
+    m[0] = (1.0f - yy - zz) * s[0]; m[1] = (xy - wz) * s[1];        m[2]  = (xz + wy) * s[2];        m[3]  = t[0];
+    m[4] = (xy + wz) * s[0];        m[5] = (1.0f - xx - zz) * s[1]; m[6]  = (yz - wx) * s[2];        m[7]  = t[1];
+    m[8] = (xz - wy) * s[0];        m[9] = (yz + wx) * s[1];        m[10] = (1.0f - xx - yy) * s[2]; m[11] = t[2];
+}
+
+/* c = a * b; c must not alias a or b */
+static inline void affine_mul(const f32 a[JOINT_AFFINE_FLOATS], const f32 b[JOINT_AFFINE_FLOATS],
+                              f32 c[JOINT_AFFINE_FLOATS]) {
+    for (u32 r = 0; r < 3; r++) {
+        const f32 *ar = &a[r * 4];
+        for (u32 col = 0; col < 3; col++) {
+            c[r * 4 + col] = ar[0] * b[col] + ar[1] * b[4 + col] + ar[2] * b[8 + col];
+        }
+        c[r * 4 + 3] = ar[0] * b[3] + ar[1] * b[7] + ar[2] * b[11] + ar[3];
     }
+}
 
-    /* Build local transform for each joint: T * R * S */
-    for (u32 j = 0; j < jc; j++) {
-        mat4 T, R, S, TR;
+/* Column-major mat4 -> 3x4 (the projective row is dropped) */
+static inline void affine_from_mat4(const f32 m[16], f32 out[JOINT_AFFINE_FLOATS]) {
+    for (u32 r = 0; r < 3; r++) {
+        for (u32 col = 0; col < 4; col++) out[r * 4 + col] = m[col * 4 + r];
+    }
+}
 
-        glm_mat4_identity(T);
-        glm_translate(T, (f32 *)pose->translations[j]);
+static inline void affine_to_mat4(const f32 a[JOINT_AFFINE_FLOATS], f32 out[16]) {
+    for (u32 col = 0; col < 4; col++) {
+        out[col * 4 + 0] = a[col];
+        out[col * 4 + 1] = a[4 + col];
+        out[col * 4 + 2] = a[8 + col];
+        out[col * 4 + 3] = (col == 3) ? 1.0f : 0.0f;
+    }
+}
 
-        glm_quat_mat4((f32 *)pose->rotations[j], R);
+/* --------------------------------------------------------------------------
+ * animation_pose_to_affine — public function.
+ * TRS -> 3x4 local, affine parent chain, then * inverse bind. Parents come
+ * before children in the joint order, so locals are built inline in one walk.
+ * ------------------------------------------------------------------------ */
 
-        glm_mat4_identity(S);
-        glm_scale(S, (f32 *)pose->scales[j]);
+void animation_pose_to_affine(const AnimPose *pose, const Skeleton *skel,
+                               f32 out_joint_affine[][JOINT_AFFINE_FLOATS], Arena *scratch) {
+    u32 jc = skel->joint_count;
 
-        glm_mat4_mul(T, R, TR);
-        glm_mat4_mul(TR, S, local_transforms[j]);
+    f32 (*global)[JOINT_AFFINE_FLOATS] =
+        arena_alloc_nozero(scratch, sizeof(f32) * JOINT_AFFINE_FLOATS * jc, 16);
+    if (!global) {
+        LOG_ERROR("animation_pose_to_affine: scratch arena out of memory");
+        static const f32 identity[JOINT_AFFINE_FLOATS] = { 1, 0, 0, 0,  0, 1, 0, 0,  0, 0, 1, 0 };
+        for (u32 j = 0; j < jc; j++) memcpy(out_joint_affine[j], identity, sizeof(identity));
+        return;
     }
 
-    /* Skeleton root transform */
-    mat4 root_xform;
-    memcpy(root_xform, skel->root_transform, sizeof(mat4));
+    f32 root[JOINT_AFFINE_FLOATS];
+    affine_from_mat4(skel->root_transform, root);
 
-    /* Compute global transforms via parent chain */
     for (u32 j = 0; j < jc; j++) {
+        f32 t[3], q[4], s[3], local[JOINT_AFFINE_FLOATS];
+        pose_get_translation(pose, j, t);
+        pose_get_rotation(pose, j, q);
+        pose_get_scale(pose, j, s);
+        affine_from_trs(t, q, s, local);
+
         i32 parent = skel->parent_indices[j];
-        if (parent < 0) {
-            glm_mat4_mul(root_xform, local_transforms[j], global_transforms[j]);
-        } else {
-            glm_mat4_mul(global_transforms[parent], local_transforms[j],
-                         global_transforms[j]);
-        }
+        affine_mul(parent < 0 ? root : global[parent], local, global[j]);
     }
 
     /* Final skinning matrix = global_transform * inverse_bind_matrix */
     for (u32 j = 0; j < jc; j++) {
-        mat4 inv_bind;
-        memcpy(inv_bind, skel->inverse_bind_matrices[j], sizeof(mat4));
-        glm_mat4_mul(global_transforms[j], inv_bind,
-                     (vec4 *)out_joint_matrices[j]);
+        f32 inv_bind[JOINT_AFFINE_FLOATS];
+        affine_from_mat4(skel->inverse_bind_matrices[j], inv_bind);
+        affine_mul(global[j], inv_bind, out_joint_affine[j]);
     }
 }
 
+/* --------------------------------------------------------------------------
+ * animation_pose_to_matrices — public function.
+ * The affine path, widened to column-major mat4 for existing callers.
+ * ------------------------------------------------------------------------ */
+
+void animation_pose_to_matrices(const AnimPose *pose, const Skeleton *skel,
+                                 f32 out_joint_matrices[][16], Arena *scratch) {
+    u32 jc = skel->joint_count;
+
+    f32 (*affine)[JOINT_AFFINE_FLOATS] =
+        arena_alloc_nozero(scratch, sizeof(f32) * JOINT_AFFINE_FLOATS * jc, 16);
+    if (!affine) {
+        LOG_ERROR("animation_pose_to_matrices: scratch arena out of memory");
+        for (u32 j = 0; j < jc; j++)
+            glm_mat4_identity((vec4 *)out_joint_matrices[j]);
+        return;
+    }
+
+    animation_pose_to_affine(pose, skel, affine, scratch);
+    for (u32 j = 0; j < jc; j++) affine_to_mat4(affine[j], out_joint_matrices[j]);
+}
+
 /* --------------------------------------------------------------------------
  * animation_sample — core function: sample clip, build bone chain, produce
  * final joint matrices = global_transform * inverse_bind_matrix
  * ------------------------------------------------------------------------ */
 
-void animation_sample(const SkinnedModel *model, u32 clip_index, f32 time,
-                      f32 out_joint_matrices[][16]) {
+static void sample_clip(const SkinnedModel *model, u32 clip_index, f32 time,
+                        AnimCursor *cursor, f32 out_joint_matrices[][16]) {
     const Skeleton *skel = &model->skeleton;
 
     if (clip_index >= model->clip_count || skel->joint_count == 0) {
@@ -239,13 +363,18 @@ void animation_sample(const SkinnedModel *model, u32 clip_index, f32 time,
 
     /* Evaluate into a pose, then convert to matrices.
      * Uses a stack-based arena for backward compat (no arena param). */
-    AnimPose pose;
-    animation_evaluate_pose(skel, clip, time, &pose);
-
-    u8 scratch_buf[sizeof(mat4) * MAX_JOINTS * 2 + 64];
+    _Alignas(16) u8 scratch_buf[sizeof(mat4) * MAX_JOINTS * 2 + ANIM_POSE_MAX_BYTES + 64];
     Arena scratch;
     arena_init(&scratch, scratch_buf, sizeof(scratch_buf));
-    animation_pose_to_matrices(&pose, skel, out_joint_matrices, &scratch);
+
+    AnimPose *pose = pose_alloc(&scratch, skel->joint_count);
+    animation_evaluate_pose(skel, clip, time, cursor, pose);
+    animation_pose_to_matrices(pose, skel, out_joint_matrices, &scratch);
+}
+
+void animation_sample(const SkinnedModel *model, u32 clip_index, f32 time,
+                      f32 out_joint_matrices[][16]) {
+    sample_clip(model, clip_index, time, NULL, out_joint_matrices);
 }
 
 /* --------------------------------------------------------------------------
@@ -284,9 +413,13 @@ void animation_update(AnimState *state, const SkinnedModel *model, f32 delta_tim
         state->current_time = ENGINE_CLAMP(state->current_time, 0.0f, clip->duration);
     }
 
+    /* The state may have been copied since the last update */
+    state->cursor.keys     = state->cursor_keys;
+    state->cursor.capacity = ANIM_CURSOR_MAX_CHANNELS;
+
     state->joint_count = model->skeleton.joint_count;
-    animation_sample(model, state->current_clip, state->current_time,
-                     state->joint_matrices);
+    sample_clip(model, state->current_clip, state->current_time,
+                &state->cursor, state->joint_matrices);
 }
 
 /* --------------------------------------------------------------------------
@@ -318,6 +451,7 @@ void skinned_model_destroy(SkinnedModel *model) {
             free(clip->channels[ch].values);
         }
         free(clip->channels);
+        anim_compressed_destroy(clip->compressed);
     }
     free(model->clips);
 
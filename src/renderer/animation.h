@@ -5,6 +5,8 @@
 #include "core/arena.h"
 #include "renderer/animation_types.h"
 
+typedef struct BoneMask BoneMask;
+
 /* Initialize an AnimState for a given skinned model.
  * Sets current_clip=0, time=0, looping=true, speed=1.0. */
 void animation_state_init(AnimState *state, const SkinnedModel *model);
@@ -27,16 +29,38 @@ void animation_blend(const f32 pose_a[][16], const f32 pose_b[][16],
                      f32 out_joint_matrices[][16]);
 
 /* Evaluate a clip into a local-space AnimPose (T, R, S per joint).
- * Building block for the animation graph system. */
+ * Building block for the animation graph system.
+ * cursor: optional keyframe hints bound to this clip (NULL = binary search
+ * every channel). */
 void animation_evaluate_pose(const Skeleton *skel, const AnimClip *clip,
-                              f32 time, AnimPose *out_pose);
+                              f32 time, AnimCursor *cursor, AnimPose *out_pose);
+
+/* Same, sampling only joints whose joint_mask weight is > 0; the others keep
+ * the rest pose. Used by animation LOD. joint_mask NULL = every joint. */
+void animation_evaluate_pose_masked(const Skeleton *skel, const AnimClip *clip,
+                                     f32 time, AnimCursor *cursor,
+                                     const BoneMask *joint_mask, AnimPose *out_pose);
+
+/* Sample one channel at `time` (binary search, no hint). Writes 3 floats for
+ * translation/scale, 4 for rotation. Used by the clip compressor. */
+void animation_sample_channel(const AnimChannel *ch, f32 time, f32 *out);
+
+/* Cursor for `clip` from a set, recycling the least recently used one (hints
+ * reset) on a miss. Returns NULL when set is NULL. */
+AnimCursor *anim_cursor_set_get(AnimCursorSet *set, const AnimClip *clip);
 
 /* Convert a local-space AnimPose to final joint skinning matrices.
  * Builds T*R*S -> parent chain -> inverse bind.
- * scratch: arena for temporary mat4 arrays (needs ~16KB). */
+ * scratch: arena for temporary matrix arrays (needs ~16KB). */
 void animation_pose_to_matrices(const AnimPose *pose, const Skeleton *skel,
                                  f32 out_joint_matrices[][16], Arena *scratch);
 
+/* Same, writing 3x4 affine matrices (JOINT_AFFINE_FLOATS per joint) — the
+ * joint SSBO layout, for renderer_draw_skinned_affine(). Cheaper than the
+ * mat4 variant, which is built on top of it. */
+void animation_pose_to_affine(const AnimPose *pose, const Skeleton *skel,
+                               f32 out_joint_affine[][JOINT_AFFINE_FLOATS], Arena *scratch);
+
 /* Destroy a skinned model's animation data (clips, channels).
  * Does NOT destroy the mesh handle (renderer owns that). */
 void skinned_model_destroy(SkinnedModel *model);
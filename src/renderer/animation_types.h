@@ -34,15 +34,80 @@ typedef struct {
     u32               keyframe_count;
 } AnimChannel;
 
+/* ---- Compressed clip (anim_compress.c) ----
+ * All tracks are resampled onto one uniform time base and stored
+ * frame-major, three u16 words per track per frame:
+ *   rotation:           smallest-three quaternion, 15 bits per component,
+ *                       the dropped component's index in the top bits
+ *   translation/scale:  16 bits per component over the track's range
+ * Channels that never change become constants; constants equal to the rest
+ * pose are dropped. */
+
+typedef struct {
+    u16   joint;
+    u16   path;          /* AnimPathType */
+    u32   offset;        /* first u16 word of this track within a frame */
+    f32   min[3];        /* translation/scale: value = min + q * scale */
+    f32   scale[3];
+} AnimQuantTrack;
+
+typedef struct {
+    u16   joint;
+    u16   path;          /* AnimPathType */
+    f32   value[4];
+} AnimConstTrack;
+
+typedef struct {
+    f32              sample_rate;    /* frames per second */
+    u32              frame_count;    /* >= 2 */
+    u32              frame_stride;   /* u16 words per frame */
+    AnimQuantTrack  *tracks;
+    u32              track_count;
+    AnimConstTrack  *constants;
+    u32              constant_count;
+    u16             *frames;         /* [frame_count * frame_stride] */
+} AnimCompressedClip;
+
 /* ---- Animation clip (one cgltf_animation) ---- */
 
 typedef struct {
     char             name[64];       /* animation name from glTF */
     f32              duration;       /* max timestamp across all channels */
-    AnimChannel     *channels;       /* array of channels */
+    AnimChannel     *channels;       /* array of channels (NULL once compressed) */
     u32              channel_count;
+    AnimCompressedClip *compressed;  /* non-NULL: sampled from this instead */
 } AnimClip;
 
+/* ---- Keyframe cursor: per-channel sampling hints for one clip ----
+ * Playback is nearly always monotonic, so the keyframe pair found last frame
+ * is usually still right or one step behind. keys[c] remembers channel c's
+ * lower keyframe; a stale hint falls back to binary search, so a cursor never
+ * changes the sampled result. */
+
+#define ANIM_CURSOR_MAX_CHANNELS (MAX_JOINTS * 3)  /* T, R, S per joint */
+
+typedef struct {
+    const AnimClip *clip;       /* clip the hints belong to (NULL = unused) */
+    u16            *keys;       /* [capacity] lower keyframe per channel */
+    u32             capacity;   /* channels past this are sampled without a hint */
+    u32             last_used;  /* LRU stamp within an AnimCursorSet */
+} AnimCursor;
+
+/* Cursors for every clip one layer may sample per update: a transition
+ * between two 2D blend spaces touches up to six */
+#define ANIM_CURSOR_SET_SIZE 6
+
+typedef struct {
+    AnimCursor cursors[ANIM_CURSOR_SET_SIZE];
+    u32        tick;
+} AnimCursorSet;
+
+/* ---- Affine joint matrix: 3x4 row-major, implicit last row (0 0 0 1) ----
+ * The joint SSBO layout (48 bytes per joint). Element [r * 4 + c]. */
+
+#define JOINT_AFFINE_FLOATS 12
+#define JOINT_AFFINE_BYTES  (JOINT_AFFINE_FLOATS * 4)
+
 /* ---- Skeleton: bone hierarchy from a glTF skin ---- */
 
 typedef struct {
@@ -55,12 +120,18 @@ typedef struct {
     f32   root_transform[16];                       /* world transform of skeleton root node */
 } Skeleton;
 
-/* ---- Local-space pose: intermediate format for blending ---- */
+/* ---- Local-space pose: intermediate format for blending ----
+ * Structure of arrays: one lane array per component so the blend kernels
+ * (anim_blend.c) process 4-8 joints per instruction. Lanes are sized for the
+ * skeleton's joint count rounded up to the widest SIMD width, and are
+ * allocated with pose_alloc(). Use the pose_get_* / pose_set_* helpers in
+ * anim_blend.h for per-joint access. */
 
 typedef struct {
-    f32   translations[MAX_JOINTS][3];
-    f32   rotations[MAX_JOINTS][4];      /* quaternion [x, y, z, w] */
-    f32   scales[MAX_JOINTS][3];
+    f32  *tx, *ty, *tz;
+    f32  *rx, *ry, *rz, *rw;   /* quaternion */
+    f32  *sx, *sy, *sz;
+    u32   lane_count;          /* floats per lane (padded joint count) */
 } AnimPose;
 
 /* ---- Runtime animation state (owned by game, one per animated instance) ---- */
@@ -71,6 +142,10 @@ typedef struct {
     bool  looping;                   /* wrap time at clip duration? */
     u32   current_clip;              /* index into the model's clip array */
 
+    /* Keyframe hints for current_clip (keys re-pointed at cursor_keys on use) */
+    AnimCursor cursor;
+    u16        cursor_keys[ANIM_CURSOR_MAX_CHANNELS];
+
     /* Output: computed joint matrices ready for GPU upload */
     f32   joint_matrices[MAX_JOINTS][16];  /* mat4 per joint, column-major */
     u32   joint_count;                      /* active joint count from skeleton */
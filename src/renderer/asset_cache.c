@@ -0,0 +1,386 @@
+#include "renderer/asset_cache.h"
+#include "platform/file_map.h"
+#include "core/log.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ASSET_CACHE_MAGIC   0x43414B56u   /* "VKAC" */
+#define ASSET_CACHE_SUFFIX  ".cache"
+#define ASSET_CACHE_ALIGN   16            /* section alignment within the file */
+
+/* File layout: header, vertex blob, index blob, then (skinned) the Skeleton
+ * struct followed by one ClipRecord per clip, each followed by its
+ * ChannelRecords and their timestamp / value floats. */
+
+typedef struct {
+    u32 magic;
+    u32 version;
+    u32 kind;             /* AssetCacheKind */
+    u32 vertex_stride;    /* sizeof the vertex struct at bake time */
+    u64 source_hash;
+    u64 file_size;        /* catches truncated writes */
+    u32 vertex_count;
+    u32 index_count;
+    u32 skeleton_size;    /* sizeof(Skeleton) at bake time, 0 for static meshes */
+    u32 clip_count;
+    u64 vertex_offset;
+    u64 index_offset;
+    u64 anim_offset;
+    u64 anim_size;
+} CacheHeader;
+
+typedef struct {
+    char name[64];
+    f32  duration;
+    u32  channel_count;
+} ClipRecord;
+
+typedef struct {
+    u32 target_joint;
+    u32 path;             /* AnimPathType */
+    u32 interpolation;    /* AnimInterpolation */
+    u32 keyframe_count;
+    u32 value_count;      /* floats in values[] */
+} ChannelRecord;
+
+/* --------------------------------------------------------------------------
+ * Helpers
+ * ------------------------------------------------------------------------ */
+
+static bool cache_path(const char *source_path, char *out, size_t out_size) {
+    int n = snprintf(out, out_size, "%s" ASSET_CACHE_SUFFIX, source_path);
+    return n > 0 && (size_t)n < out_size;
+}
+
+static u64 align_offset(u64 v) {
+    return (v + ASSET_CACHE_ALIGN - 1) / ASSET_CACHE_ALIGN * ASSET_CACHE_ALIGN;
+}
+
+/* Floats per keyframe block of a channel (cubic splines store in/value/out) */
+static u32 channel_value_count(const AnimChannel *ch) {
+    u32 components = (ch->path == ANIM_PATH_ROTATION) ? 4 : 3;
+    u32 per_key    = (ch->interpolation == ANIM_INTERP_CUBICSPLINE) ? 3 : 1;
+    return ch->keyframe_count * components * per_key;
+}
+
+/* The pose and skinning loops walk joint_count joints and read a parent's
+ * global transform before its children's, so parents must come first */
+static bool skeleton_valid(const Skeleton *skel) {
+    if (skel->joint_count > MAX_JOINTS) return false;
+    for (u32 j = 0; j < skel->joint_count; j++) {
+        i32 parent = skel->parent_indices[j];
+        if (parent < -1 || parent >= (i32)j) return false;
+    }
+    return true;
+}
+
+/* Bounds-checked sequential reader over the animation section */
+typedef struct {
+    const u8 *data;
+    size_t    size;
+    size_t    at;
+} CacheReader;
+
+static const void *reader_take(CacheReader *r, size_t n) {
+    if (n > r->size - r->at) return NULL;
+    const void *p = r->data + r->at;
+    r->at += n;
+    return p;
+}
+
+/* --------------------------------------------------------------------------
+ * asset_cache_hash_file
+ * ------------------------------------------------------------------------ */
+
+EngineResult asset_cache_hash_file(const char *source_path, u64 *out_hash) {
+    FILE *f = fopen(source_path, "rb");
+    if (!f) return ENGINE_ERROR_FILE_NOT_FOUND;
+
+    u8 *buf = malloc(64 * 1024);
+    if (!buf) {
+        fclose(f);
+        return ENGINE_ERROR_OUT_OF_MEMORY;
+    }
+
+    u64 h = 14695981039346656037ull;
+    size_t n;
+    while ((n = fread(buf, 1, 64 * 1024, f)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            h ^= buf[i];
+            h *= 1099511628211ull;
+        }
+    }
+    bool failed = ferror(f) != 0;
+
+    free(buf);
+    fclose(f);
+    if (failed) return ENGINE_ERROR_FILE_NOT_FOUND;
+
+    *out_hash = h;
+    return ENGINE_SUCCESS;
+}
+
+/* --------------------------------------------------------------------------
+ * Reading
+ * ------------------------------------------------------------------------ */
+
+EngineResult asset_cache_open(const char *source_path, u64 source_hash,
+                              AssetCacheKind kind, u32 vertex_stride,
+                              AssetCacheView *out_view) {
+    memset(out_view, 0, sizeof(*out_view));
+
+    char path[1024];
+    if (!cache_path(source_path, path, sizeof(path))) return ENGINE_ERROR_FILE_NOT_FOUND;
+
+    FileMap *map = NULL;
+    if (file_map_open(path, &map) != ENGINE_SUCCESS) return ENGINE_ERROR_FILE_NOT_FOUND;
+
+    const u8 *base = file_map_data(map);
+    size_t    size = file_map_size(map);
+    CacheHeader hdr;
+    if (size < sizeof(hdr)) goto stale;
+    memcpy(&hdr, base, sizeof(hdr));
+
+    u32 skeleton_size = (kind == ASSET_CACHE_SKINNED) ? (u32)sizeof(Skeleton) : 0;
+    if (hdr.magic != ASSET_CACHE_MAGIC || hdr.version != ASSET_CACHE_VERSION ||
+        hdr.kind != (u32)kind || hdr.vertex_stride != vertex_stride ||
+        hdr.skeleton_size != skeleton_size || hdr.source_hash != source_hash ||
+        hdr.file_size != size) {
+        goto stale;
+    }
+
+    u64 vert_bytes = (u64)hdr.vertex_count * vertex_stride;
+    u64 idx_bytes  = (u64)hdr.index_count * sizeof(u32);
+    if (hdr.vertex_offset > size || vert_bytes > size - hdr.vertex_offset ||
+        hdr.index_offset > size || idx_bytes > size - hdr.index_offset ||
+        hdr.index_offset % sizeof(u32) != 0 ||
+        hdr.anim_offset > size || hdr.anim_size > size - hdr.anim_offset) {
+        goto stale;
+    }
+
+    /* Indices go to the GPU as they are: one past the vertices would read
+     * outside this mesh's range of the shared vertex buffer */
+    const u32 *indices = (const u32 *)(base + hdr.index_offset);
+    for (u32 i = 0; i < hdr.index_count; i++) {
+        if (indices[i] >= hdr.vertex_count) goto stale;
+    }
+
+    out_view->map          = map;
+    out_view->vertices     = base + hdr.vertex_offset;
+    out_view->vertex_count = hdr.vertex_count;
+    out_view->indices      = indices;
+    out_view->index_count  = hdr.index_count;
+    out_view->anim_data    = base + hdr.anim_offset;
+    out_view->anim_size    = (size_t)hdr.anim_size;
+    return ENGINE_SUCCESS;
+
+stale:
+    LOG_INFO("Asset cache %s is stale, rebuilding", path);
+    file_map_close(map);
+    return ENGINE_ERROR_FILE_NOT_FOUND;
+}
+
+void asset_cache_close(AssetCacheView *view) {
+    file_map_close(view->map);
+    memset(view, 0, sizeof(*view));
+}
+
+EngineResult asset_cache_read_animation(const AssetCacheView *view, Skeleton *out_skeleton,
+                                        AnimClip **out_clips, u32 *out_clip_count) {
+    CacheReader r = { view->anim_data, view->anim_size, 0 };
+    CacheHeader hdr;
+    memcpy(&hdr, file_map_data(view->map), sizeof(hdr));
+
+    const void *skel = reader_take(&r, sizeof(Skeleton));
+    if (!skel) return ENGINE_ERROR_GENERIC;
+    memcpy(out_skeleton, skel, sizeof(Skeleton));
+    if (!skeleton_valid(out_skeleton)) {
+        LOG_WARN("Asset cache: corrupt skeleton, rebuilding");
+        return ENGINE_ERROR_GENERIC;
+    }
+
+    *out_clips = NULL;
+    *out_clip_count = 0;
+    if (hdr.clip_count == 0) return ENGINE_SUCCESS;
+
+    AnimClip *clips = calloc(hdr.clip_count, sizeof(AnimClip));
+    if (!clips) return ENGINE_ERROR_OUT_OF_MEMORY;
+
+    /* Clips are filled in order, so on failure clips [0, c] are freed */
+    EngineResult res = ENGINE_SUCCESS;
+    u32 c = 0;
+    for (; c < hdr.clip_count; c++) {
+        ClipRecord rec;
+        const void *p = reader_take(&r, sizeof(rec));
+        if (!p) { res = ENGINE_ERROR_GENERIC; break; }
+        memcpy(&rec, p, sizeof(rec));
+
+        AnimClip *clip = &clips[c];
+        memcpy(clip->name, rec.name, sizeof(clip->name));
+        clip->name[sizeof(clip->name) - 1] = '\0';
+        clip->duration = rec.duration;
+        clip->channels = calloc(ENGINE_MAX(rec.channel_count, 1u), sizeof(AnimChannel));
+        if (!clip->channels) { res = ENGINE_ERROR_OUT_OF_MEMORY; break; }
+
+        for (u32 ci = 0; ci < rec.channel_count && res == ENGINE_SUCCESS; ci++) {
+            ChannelRecord crec;
+            const void *cp = reader_take(&r, sizeof(crec));
+            if (!cp) { res = ENGINE_ERROR_GENERIC; break; }
+            memcpy(&crec, cp, sizeof(crec));
+            if (crec.path > ANIM_PATH_SCALE || crec.interpolation > ANIM_INTERP_CUBICSPLINE) {
+                res = ENGINE_ERROR_GENERIC;
+                break;
+            }
+
+            AnimChannel *ch = &clip->channels[ci];
+            ch->target_joint   = crec.target_joint;
+            ch->path           = (AnimPathType)crec.path;
+            ch->interpolation  = (AnimInterpolation)crec.interpolation;
+            ch->keyframe_count = crec.keyframe_count;
+            clip->channel_count = ci + 1;
+
+            const void *ts = reader_take(&r, sizeof(f32) * crec.keyframe_count);
+            const void *vs = reader_take(&r, sizeof(f32) * crec.value_count);
+            /* The samplers index values[] by keyframe, so the count must be
+             * exactly what path and interpolation imply */
+            if (!ts || !vs || crec.target_joint >= MAX_JOINTS ||
+                crec.value_count != channel_value_count(ch)) {
+                res = ENGINE_ERROR_GENERIC;
+                break;
+            }
+
+            ch->timestamps = malloc(sizeof(f32) * ENGINE_MAX(crec.keyframe_count, 1u));
+            ch->values     = malloc(sizeof(f32) * ENGINE_MAX(crec.value_count, 1u));
+            if (!ch->timestamps || !ch->values) { res = ENGINE_ERROR_OUT_OF_MEMORY; break; }
+            memcpy(ch->timestamps, ts, sizeof(f32) * crec.keyframe_count);
+            memcpy(ch->values, vs, sizeof(f32) * crec.value_count);
+        }
+        if (res != ENGINE_SUCCESS) break;
+    }
+
+    if (res != ENGINE_SUCCESS) {
+        for (u32 i = 0; i <= c && i < hdr.clip_count; i++) {
+            for (u32 ci = 0; ci < clips[i].channel_count; ci++) {
+                free(clips[i].channels[ci].timestamps);
+                free(clips[i].channels[ci].values);
+            }
+            free(clips[i].channels);
+        }
+        free(clips);
+        LOG_WARN("Asset cache: corrupt animation data, rebuilding");
+        return res;
+    }
+
+    *out_clips = clips;
+    *out_clip_count = hdr.clip_count;
+    return ENGINE_SUCCESS;
+}
+
+/* --------------------------------------------------------------------------
+ * Writing
+ * ------------------------------------------------------------------------ */
+
+static bool write_at(FILE *f, u64 offset, const void *data, size_t size) {
+    if (size == 0) return true;
+    return fseek(f, (long)offset, SEEK_SET) == 0 && fwrite(data, 1, size, f) == size;
+}
+
+static bool write_animation(FILE *f, const Skeleton *skeleton,
+                            const AnimClip *clips, u32 clip_count) {
+    if (fwrite(skeleton, sizeof(Skeleton), 1, f) != 1) return false;
+
+    for (u32 c = 0; c < clip_count; c++) {
+        const AnimClip *clip = &clips[c];
+        ClipRecord rec = {0};
+        memcpy(rec.name, clip->name, sizeof(rec.name));
+        rec.duration      = clip->duration;
+        rec.channel_count = clip->channel_count;
+        if (fwrite(&rec, sizeof(rec), 1, f) != 1) return false;
+
+        for (u32 ci = 0; ci < clip->channel_count; ci++) {
+            const AnimChannel *ch = &clip->channels[ci];
+            bool complete = ch->timestamps && ch->values;   /* loader OOM leaves holes */
+            ChannelRecord crec = {
+                .target_joint   = ch->target_joint,
+                .path           = (u32)ch->path,
+                .interpolation  = (u32)ch->interpolation,
+                .keyframe_count = complete ? ch->keyframe_count : 0,
+                .value_count    = complete ? channel_value_count(ch) : 0,
+            };
+            if (fwrite(&crec, sizeof(crec), 1, f) != 1) return false;
+            if (crec.keyframe_count &&
+                fwrite(ch->timestamps, sizeof(f32), crec.keyframe_count, f) != crec.keyframe_count)
+                return false;
+            if (crec.value_count &&
+                fwrite(ch->values, sizeof(f32), crec.value_count, f) != crec.value_count)
+                return false;
+        }
+    }
+    return true;
+}
+
+EngineResult asset_cache_write(const char *source_path, u64 source_hash,
+                               AssetCacheKind kind, u32 vertex_stride,
+                               const void *vertices, u32 vertex_count,
+                               const u32 *indices, u32 index_count,
+                               const Skeleton *skeleton,
+                               const AnimClip *clips, u32 clip_count) {
+    char path[1024], tmp_path[1024 + 4];
+    if (!cache_path(source_path, path, sizeof(path))) return ENGINE_ERROR_GENERIC;
+    if (kind == ASSET_CACHE_SKINNED && !skeleton_valid(skeleton)) {
+        /* The reader would reject it and rebake on every load */
+        LOG_WARN("Asset cache: %s has joints before their parents, not cached", source_path);
+        return ENGINE_ERROR_GENERIC;
+    }
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    FILE *f = fopen(tmp_path, "wb");
+    if (!f) {
+        LOG_WARN("Asset cache: can't write %s", tmp_path);
+        return ENGINE_ERROR_FILE_NOT_FOUND;
+    }
+
+    CacheHeader hdr = {
+        .magic         = ASSET_CACHE_MAGIC,
+        .version       = ASSET_CACHE_VERSION,
+        .kind          = (u32)kind,
+        .vertex_stride = vertex_stride,
+        .source_hash   = source_hash,
+        .vertex_count  = vertex_count,
+        .index_count   = index_count,
+        .skeleton_size = (kind == ASSET_CACHE_SKINNED) ? (u32)sizeof(Skeleton) : 0,
+        .clip_count    = (kind == ASSET_CACHE_SKINNED) ? clip_count : 0,
+    };
+    hdr.vertex_offset = align_offset(sizeof(CacheHeader));
+    hdr.index_offset  = align_offset(hdr.vertex_offset + (u64)vertex_count * vertex_stride);
+    hdr.anim_offset   = (kind == ASSET_CACHE_SKINNED)
+                      ? align_offset(hdr.index_offset + (u64)index_count * sizeof(u32)) : 0;
+
+    bool ok = write_at(f, hdr.vertex_offset, vertices, (size_t)vertex_count * vertex_stride) &&
+              write_at(f, hdr.index_offset, indices, sizeof(u32) * index_count);
+    if (ok && kind == ASSET_CACHE_SKINNED) {
+        ok = fseek(f, (long)hdr.anim_offset, SEEK_SET) == 0 &&
+             write_animation(f, skeleton, clips, clip_count);
+    }
+    if (ok) {
+        long end = ftell(f);
+        ok = end >= 0;
+        hdr.file_size = (u64)end;
+        hdr.anim_size = (kind == ASSET_CACHE_SKINNED) ? hdr.file_size - hdr.anim_offset : 0;
+    }
+    /* Header last: a cache is only valid once everything before it landed */
+    ok = ok && write_at(f, 0, &hdr, sizeof(hdr));
+    ok = (fclose(f) == 0) && ok;
+
+    remove(path);
+    if (!ok || rename(tmp_path, path) != 0) {
+        remove(tmp_path);
+        LOG_WARN("Asset cache: failed to write %s", path);
+        return ENGINE_ERROR_GENERIC;
+    }
+
+    LOG_INFO("Asset cache written: %s (%llu bytes)", path, (unsigned long long)hdr.file_size);
+    return ENGINE_SUCCESS;
+}
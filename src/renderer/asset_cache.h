@@ -0,0 +1,63 @@
+#ifndef ENGINE_ASSET_CACHE_H
+#define ENGINE_ASSET_CACHE_H
+
+#include "core/common.h"
+#include "renderer/animation_types.h"
+
+/* Baked model cache: "<asset>.cache" next to the source file, holding the
+ * final (optimized) vertex and index arrays and, for skinned models, the
+ * Skeleton and raw animation clips. Keyed by a hash of the source bytes plus
+ * a format version and the vertex/skeleton struct sizes, so editing the
+ * asset or changing the engine's layouts invalidates it. The file is
+ * memory-mapped and geometry is uploaded straight from the mapping. */
+
+#define ASSET_CACHE_VERSION 1
+
+typedef enum {
+    ASSET_CACHE_MESH    = 1,   /* Vertex3D + indices */
+    ASSET_CACHE_SKINNED = 2,   /* SkinnedVertex3D + indices + Skeleton + clips */
+} AssetCacheKind;
+
+typedef struct FileMap FileMap;
+
+/* An opened cache file. Pointers reference the mapping and are valid until
+ * asset_cache_close. */
+typedef struct {
+    FileMap    *map;
+    const void *vertices;
+    u32         vertex_count;
+    const u32  *indices;
+    u32         index_count;
+    const u8   *anim_data;      /* skeleton + clip records (skinned only) */
+    size_t      anim_size;
+} AssetCacheView;
+
+/* 64-bit FNV-1a over the whole source file */
+EngineResult asset_cache_hash_file(const char *source_path, u64 *out_hash);
+
+/* Open the cache for source_path if it exists and matches hash, kind and
+ * vertex_stride. Any mismatch or truncation is reported as
+ * ENGINE_ERROR_FILE_NOT_FOUND (cache miss). */
+EngineResult asset_cache_open(const char *source_path, u64 source_hash,
+                              AssetCacheKind kind, u32 vertex_stride,
+                              AssetCacheView *out_view);
+void         asset_cache_close(AssetCacheView *view);
+
+/* Copy the skeleton and clips out of a skinned cache. Clips are heap
+ * allocated exactly like the glTF loader's, so skinned_model_destroy frees
+ * them. A skeleton or channel record that fails validation returns an error,
+ * and the caller re-imports the source. */
+EngineResult asset_cache_read_animation(const AssetCacheView *view, Skeleton *out_skeleton,
+                                        AnimClip **out_clips, u32 *out_clip_count);
+
+/* Write (replace) the cache for source_path. skeleton/clips are only used for
+ * ASSET_CACHE_SKINNED; a skeleton the reader would reject is not cached.
+ * Failure leaves no partial cache behind. */
+EngineResult asset_cache_write(const char *source_path, u64 source_hash,
+                               AssetCacheKind kind, u32 vertex_stride,
+                               const void *vertices, u32 vertex_count,
+                               const u32 *indices, u32 index_count,
+                               const Skeleton *skeleton,
+                               const AnimClip *clips, u32 clip_count);
+
+#endif /* ENGINE_ASSET_CACHE_H */
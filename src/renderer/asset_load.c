@@ -0,0 +1,420 @@
+#include "renderer/asset_load.h"
+#include "renderer/model.h"
+#include "renderer/skinned_model.h"
+#include "renderer/vk_buffer.h"
+#include "renderer/resource_table.h"
+#include "core/jobs.h"
+#include "core/log.h"
+#include "core/profile.h"
+
+#include "stb/stb_image.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* --------------------------------------------------------------------------
+ * Texture decode
+ *
+ * DDS / KTX2 containers upload their pre-built levels straight from the
+ * file mapping. If the device cannot sample the container's format, or it
+ * holds Basis data (no transcoder is bundled), the loader falls back to the
+ * uncompressed source next to it (same name, .png), which like every stb
+ * image gets a generated mip chain.
+ * ------------------------------------------------------------------------ */
+
+static VkFormat texture_file_vk_format(TextureFileFormat format) {
+    switch (format) {
+    case TEXTURE_FILE_FORMAT_RGBA8:          return VK_FORMAT_R8G8B8A8_UNORM;
+    case TEXTURE_FILE_FORMAT_RGBA8_SRGB:     return VK_FORMAT_R8G8B8A8_SRGB;
+    case TEXTURE_FILE_FORMAT_BC1:            return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+    case TEXTURE_FILE_FORMAT_BC1_SRGB:       return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+    case TEXTURE_FILE_FORMAT_BC3:            return VK_FORMAT_BC3_UNORM_BLOCK;
+    case TEXTURE_FILE_FORMAT_BC3_SRGB:       return VK_FORMAT_BC3_SRGB_BLOCK;
+    case TEXTURE_FILE_FORMAT_BC4:            return VK_FORMAT_BC4_UNORM_BLOCK;
+    case TEXTURE_FILE_FORMAT_BC5:            return VK_FORMAT_BC5_UNORM_BLOCK;
+    case TEXTURE_FILE_FORMAT_BC7:            return VK_FORMAT_BC7_UNORM_BLOCK;
+    case TEXTURE_FILE_FORMAT_BC7_SRGB:       return VK_FORMAT_BC7_SRGB_BLOCK;
+    case TEXTURE_FILE_FORMAT_ASTC_4X4:       return VK_FORMAT_ASTC_4x4_UNORM_BLOCK;
+    case TEXTURE_FILE_FORMAT_ASTC_4X4_SRGB:  return VK_FORMAT_ASTC_4x4_SRGB_BLOCK;
+    default:                                 return VK_FORMAT_UNDEFINED;
+    }
+}
+
+static EngineResult decode_container(const VulkanContext *vk, const char *path,
+                                     TextureData *out_data) {
+    EngineResult res = texture_file_open(path, &out_data->file);
+    if (res != ENGINE_SUCCESS) return res;
+
+    VkFormat format = texture_file_vk_format(out_data->file.format);
+    if (!vk_texture_format_supported(vk, format)) {
+        LOG_WARN("Device cannot sample %s (VkFormat %d)", path, (int)format);
+        texture_file_close(&out_data->file);
+        return ENGINE_ERROR_GENERIC;
+    }
+
+    out_data->container = true;
+    out_data->format    = format;
+    out_data->width     = out_data->file.width;
+    out_data->height    = out_data->file.height;
+    return ENGINE_SUCCESS;
+}
+
+static EngineResult decode_image(const char *path, TextureData *out_data) {
+    /* Decode image file with stb_image */
+    int width, height, channels;
+    stbi_uc *pixels = stbi_load(path, &width, &height, &channels, STBI_rgb_alpha);
+    if (!pixels) {
+        LOG_ERROR("Failed to load texture: %s", path);
+        return ENGINE_ERROR_VULKAN_INIT;
+    }
+
+    out_data->pixels = pixels;
+    out_data->width  = (u32)width;
+    out_data->height = (u32)height;
+    return ENGINE_SUCCESS;
+}
+
+/* "<dir>/name.ktx2" -> "<dir>/name.png" */
+static bool fallback_image_path(const char *path, char *out, size_t out_size) {
+    const char *dot = strrchr(path, '.');
+    size_t stem = dot ? (size_t)(dot - path) : strlen(path);
+    if (stem + sizeof(".png") > out_size) return false;
+    memcpy(out, path, stem);
+    memcpy(out + stem, ".png", sizeof(".png"));
+    return true;
+}
+
+EngineResult texture_decode(const VulkanContext *vk, const char *path, TextureData *out_data) {
+    memset(out_data, 0, sizeof(*out_data));
+
+    PROFILE_ZONE_BEGIN("texture_decode");
+    EngineResult res = ENGINE_ERROR_GENERIC;
+    const char *image_path = path;
+    char fallback_path[1024];
+    if (texture_file_is_container(path)) {
+        res = decode_container(vk, path, out_data);
+        if (res != ENGINE_SUCCESS) {
+            if (fallback_image_path(path, fallback_path, sizeof(fallback_path))) {
+                LOG_WARN("Falling back to uncompressed %s", fallback_path);
+                image_path = fallback_path;
+            } else {
+                image_path = NULL;
+            }
+        }
+    }
+    if (res != ENGINE_SUCCESS && image_path) {
+        res = decode_image(image_path, out_data);
+    }
+    PROFILE_ZONE_END();
+    return res;
+}
+
+EngineResult texture_create(VulkanContext *vk, const TextureData *data, VkFilter filter,
+                            VulkanTexture *out_tex) {
+    if (!data->container) {
+        return vk_create_texture(vk, data->pixels, data->width, data->height,
+                                 VK_FORMAT_R8G8B8A8_SRGB, filter, true, out_tex);
+    }
+
+    const TextureFile *file = &data->file;
+    const void *levels[TEXTURE_FILE_MAX_LEVELS];
+    for (u32 i = 0; i < file->level_count; i++) levels[i] = file->levels[i];
+
+    return vk_create_texture_levels(vk, data->format, file->width, file->height,
+                                    texture_file_block_dim(file->format),
+                                    texture_file_block_bytes(file->format),
+                                    file->level_count, levels, filter, out_tex);
+}
+
+void texture_data_free(TextureData *data) {
+    if (data->container) texture_file_close(&data->file);
+    if (data->pixels) stbi_image_free(data->pixels);
+    memset(data, 0, sizeof(*data));
+}
+
+/* --------------------------------------------------------------------------
+ * Async loads
+ *
+ * A load owns its decoded data until it is finished on the main thread.
+ * Decoding runs as a background job (workers only, so it never lands on a
+ * thread waiting mid-frame); everything touching the VulkanContext tables
+ * or the upload ring happens in asset_load_poll.
+ * ------------------------------------------------------------------------ */
+
+typedef enum {
+    ASSET_LOAD_MODEL,
+    ASSET_LOAD_SKINNED,
+    ASSET_LOAD_TEXTURE,
+} AssetLoadKind;
+
+struct AssetLoad {
+    AssetLoadKind        kind;
+    char                 path[256];
+    const VulkanContext *vk;          /* format queries during texture decode */
+    JobCounter           decoded;
+    EngineResult         result;      /* decode result, written by the job */
+    AssetLoadCallback    callback;
+    void                *user;
+
+    MeshHandle           mesh;        /* model: reserved slot */
+    TextureHandle        texture;     /* texture: reserved handle */
+    VkFilter             filter;
+    SkinnedModel        *skinned;     /* skinned: caller's model */
+
+    union {
+        ModelData        model;
+        SkinnedModelData skinned;
+        TextureData      texture;
+    } data;
+};
+
+static void decode_job(void *arg) {
+    AssetLoad *load = arg;
+    switch (load->kind) {
+    case ASSET_LOAD_MODEL:
+        load->result = model_decode(load->path, &load->data.model);
+        break;
+    case ASSET_LOAD_SKINNED:
+        load->result = skinned_model_decode(load->path, &load->data.skinned);
+        break;
+    case ASSET_LOAD_TEXTURE:
+        load->result = texture_decode(load->vk, load->path, &load->data.texture);
+        break;
+    }
+}
+
+static void free_load_data(AssetLoad *load) {
+    if (load->result != ENGINE_SUCCESS) return;  /* failed decodes clean up after themselves */
+    switch (load->kind) {
+    case ASSET_LOAD_MODEL:   model_data_free(&load->data.model);           break;
+    case ASSET_LOAD_SKINNED: skinned_model_data_free(&load->data.skinned); break;
+    case ASSET_LOAD_TEXTURE: texture_data_free(&load->data.texture);       break;
+    }
+}
+
+/* Bytes the load stages into the upload ring when finished */
+static size_t load_upload_bytes(const AssetLoad *load) {
+    if (load->result != ENGINE_SUCCESS) return 0;
+    switch (load->kind) {
+    case ASSET_LOAD_MODEL:
+        return sizeof(Vertex3D) * load->data.model.vertex_count +
+               sizeof(u32) * load->data.model.index_count;
+    case ASSET_LOAD_SKINNED:
+        return sizeof(SkinnedVertex3D) * load->data.skinned.vertex_count +
+               sizeof(u32) * load->data.skinned.index_count;
+    case ASSET_LOAD_TEXTURE:
+        if (!load->data.texture.container) {
+            return (size_t)load->data.texture.width * load->data.texture.height * 4;
+        }
+        size_t bytes = 0;
+        for (u32 i = 0; i < load->data.texture.file.level_count; i++) {
+            bytes += load->data.texture.file.level_sizes[i];
+        }
+        return bytes;
+    }
+    return 0;
+}
+
+/* Allocate a load, queue it and start its decode */
+static EngineResult start_load(VulkanContext *vk, AssetLoadKind kind, const char *path,
+                               AssetLoadCallback callback, void *user, AssetLoad **out_load) {
+    AssetLoadContext *ctx = &vk->asset_loads;
+
+    size_t len = strlen(path);
+    if (len >= sizeof(((AssetLoad *)0)->path)) {
+        LOG_ERROR("Async load: path too long: %s", path);
+        return ENGINE_ERROR_GENERIC;
+    }
+
+    if (ctx->count == ctx->capacity) {
+        u32 capacity = ctx->capacity ? ctx->capacity * 2 : 16;
+        AssetLoad **loads = realloc(ctx->loads, sizeof(AssetLoad *) * capacity);
+        if (!loads) return ENGINE_ERROR_OUT_OF_MEMORY;
+        ctx->loads    = loads;
+        ctx->capacity = capacity;
+    }
+
+    AssetLoad *load = calloc(1, sizeof(AssetLoad));
+    if (!load) return ENGINE_ERROR_OUT_OF_MEMORY;
+    load->kind     = kind;
+    load->vk       = vk;
+    load->callback = callback;
+    load->user     = user;
+    memcpy(load->path, path, len + 1);
+
+    ctx->loads[ctx->count++] = load;
+    *out_load = load;
+    return ENGINE_SUCCESS;
+}
+
+static void run_decode(AssetLoad *load) {
+    Job job = { decode_job, load, NULL };
+    jobs_run_background(&job, 1, &load->decoded);
+}
+
+void asset_load_init(VulkanContext *vk) {
+    memset(&vk->asset_loads, 0, sizeof(vk->asset_loads));
+    vk->asset_loads.placeholder_mesh = MESH_HANDLE_INVALID;
+}
+
+void asset_load_shutdown(VulkanContext *vk) {
+    AssetLoadContext *ctx = &vk->asset_loads;
+    for (u32 i = 0; i < ctx->count; i++) {
+        AssetLoad *load = ctx->loads[i];
+        jobs_wait(&load->decoded);
+        free_load_data(load);
+        free(load);
+    }
+    free(ctx->loads);
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+EngineResult asset_load_model(VulkanContext *vk, const char *path,
+                              AssetLoadCallback callback, void *user,
+                              MeshHandle *out_handle) {
+    u32 placeholder = mesh_lookup(vk, vk->asset_loads.placeholder_mesh);
+    if (placeholder == HANDLE_SLOT_NONE) {
+        LOG_ERROR("Async model load needs a live placeholder mesh");
+        return ENGINE_ERROR_GENERIC;
+    }
+
+    MeshHandle handle;
+    EngineResult res = mesh_reserve(vk, &handle);
+    if (res != ENGINE_SUCCESS) return res;
+
+    AssetLoad *load;
+    if ((res = start_load(vk, ASSET_LOAD_MODEL, path, callback, user, &load)) != ENGINE_SUCCESS) {
+        mesh_cancel(vk, handle);
+        return res;
+    }
+
+    /* Draws of the handle show the placeholder until the geometry lands.
+     * The copy does not own its ranges: unloading it frees nothing. */
+    vk->meshes[HANDLE_SLOT(handle)] = vk->meshes[placeholder];
+    vk->meshes[HANDLE_SLOT(handle)].borrowed = true;
+    load->mesh = handle;
+
+    run_decode(load);
+    *out_handle = handle;
+    return ENGINE_SUCCESS;
+}
+
+EngineResult asset_load_skinned_model(VulkanContext *vk, const char *path,
+                                      SkinnedModel *out_model,
+                                      AssetLoadCallback callback, void *user) {
+    memset(out_model, 0, sizeof(*out_model));
+    out_model->mesh_handle = MESH_HANDLE_INVALID;  /* skinned draws skip it */
+
+    AssetLoad *load;
+    EngineResult res = start_load(vk, ASSET_LOAD_SKINNED, path, callback, user, &load);
+    if (res != ENGINE_SUCCESS) return res;
+
+    load->skinned = out_model;
+    run_decode(load);
+    return ENGINE_SUCCESS;
+}
+
+EngineResult asset_load_texture(VulkanContext *vk, const char *path, VkFilter filter,
+                                AssetLoadCallback callback, void *user,
+                                TextureHandle *out_handle) {
+    TextureHandle handle;
+    EngineResult res = texture_reserve(vk, &handle);
+    if (res != ENGINE_SUCCESS) return res;
+
+    AssetLoad *load;
+    if ((res = start_load(vk, ASSET_LOAD_TEXTURE, path, callback, user, &load)) != ENGINE_SUCCESS) {
+        texture_cancel(vk, handle);
+        return res;
+    }
+
+    /* The table slot is written with the dummy until the image lands */
+    vk->textures[HANDLE_SLOT(handle)].placeholder = true;
+    load->texture = handle;
+    load->filter  = filter;
+
+    run_decode(load);
+    *out_handle = handle;
+    return ENGINE_SUCCESS;
+}
+
+/* Replace a placeholder texture. Table sets that already hold the dummy in
+ * its slot are rewritten by texture_table_sync; frames in flight never read
+ * that slot, they were recorded with the dummy's slot 0. */
+static void publish_texture(VulkanContext *vk, u32 slot, const VulkanTexture *tex) {
+    vk->textures[slot] = *tex;
+    texture_mark_stale(vk, slot);
+}
+
+static EngineResult finish_load(VulkanContext *vk, AssetLoad *load) {
+    if (load->result != ENGINE_SUCCESS) return load->result;
+
+    /* The handle was unloaded while decoding: drop the result */
+    if ((load->kind == ASSET_LOAD_MODEL && mesh_lookup(vk, load->mesh) == HANDLE_SLOT_NONE) ||
+        (load->kind == ASSET_LOAD_TEXTURE &&
+         texture_lookup(vk, load->texture) == HANDLE_SLOT_NONE)) {
+        return ENGINE_ERROR_GENERIC;
+    }
+
+    EngineResult res = ENGINE_ERROR_GENERIC;
+    switch (load->kind) {
+    case ASSET_LOAD_MODEL: {
+        const ModelData *data = &load->data.model;
+        res = vk_upload_mesh_3d_at(vk, load->mesh, data->vertices, data->vertex_count,
+                                   data->indices, data->index_count);
+        break;
+    }
+    case ASSET_LOAD_SKINNED:
+        res = skinned_model_upload(vk, &load->data.skinned, load->skinned);
+        break;
+    case ASSET_LOAD_TEXTURE: {
+        VulkanTexture tex = {0};
+        res = texture_create(vk, &load->data.texture, load->filter, &tex);
+        if (res == ENGINE_SUCCESS) publish_texture(vk, HANDLE_SLOT(load->texture), &tex);
+        break;
+    }
+    }
+    return res;
+}
+
+void asset_load_poll(VulkanContext *vk) {
+    AssetLoadContext *ctx = &vk->asset_loads;
+    if (ctx->count == 0) return;
+
+    PROFILE_ZONE_BEGIN("asset_load_poll");
+    size_t budget = ASSET_LOAD_FRAME_BUDGET;
+    bool   first  = true;
+    u32    kept   = 0;
+    for (u32 i = 0; i < ctx->count; i++) {
+        AssetLoad *load = ctx->loads[i];
+
+        size_t bytes = 0;
+        bool   ready = jobs_done(&load->decoded);
+        if (ready) {
+            bytes = load_upload_bytes(load);
+            ready = first || bytes <= budget;
+        }
+        if (!ready) {
+            ctx->loads[kept++] = load;
+            continue;
+        }
+        first   = false;
+        budget -= ENGINE_MIN(bytes, budget);
+
+        EngineResult res = finish_load(vk, load);
+        if (res == ENGINE_SUCCESS) {
+            LOG_INFO("Async load done: %s", load->path);
+        } else {
+            LOG_ERROR("Async load failed: %s (error %d), keeping the placeholder",
+                      load->path, (int)res);
+        }
+        free_load_data(load);
+        if (load->callback) load->callback(load->user, res);
+        free(load);
+    }
+    ctx->count = kept;
+    PROFILE_ZONE_END();
+}
+
+u32 asset_load_pending(const VulkanContext *vk) {
+    return vk->asset_loads.count;
+}
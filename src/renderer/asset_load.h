@@ -0,0 +1,70 @@
+#ifndef ENGINE_ASSET_LOAD_H
+#define ENGINE_ASSET_LOAD_H
+
+#include "renderer/vk_types.h"
+#include "renderer/texture_file.h"
+#include "core/common.h"
+
+/* ---- Texture decode (shared by renderer_load_texture and async loads) ---- */
+
+/* A decoded texture: a mapped DDS / KTX2 container whose format the device
+ * can sample, or RGBA8 pixels from stb_image. */
+typedef struct {
+    TextureFile file;       /* container only */
+    bool        container;
+    VkFormat    format;     /* container format */
+    u8         *pixels;     /* stb_image RGBA8, NULL for a container */
+    u32         width;
+    u32         height;
+} TextureData;
+
+/* Map a container, or decode an image file. A container the device cannot
+ * sample (or that holds Basis data) falls back to the .png next to it.
+ * Only queries device format support, so it runs on any thread. */
+EngineResult texture_decode(const VulkanContext *vk, const char *path, TextureData *out_data);
+
+/* Create the image and stage its levels (mip 0 + generated chain for
+ * images, the pre-built levels for containers) into the upload batch */
+EngineResult texture_create(VulkanContext *vk, const TextureData *data, VkFilter filter,
+                            VulkanTexture *out_tex);
+
+void         texture_data_free(TextureData *data);
+
+/* ---- Async loads (called from renderer.c) ---- */
+
+/* Bytes of decoded data a frame uploads for finished loads (at least one
+ * load always goes through) */
+#define ASSET_LOAD_FRAME_BUDGET (16u * 1024u * 1024u)
+
+void         asset_load_init(VulkanContext *vk);
+
+/* Waits for decodes still running and drops their results; no callbacks
+ * fire. Call before the mesh and texture tables are torn down. */
+void         asset_load_shutdown(VulkanContext *vk);
+
+/* Reserve a mesh slot showing the placeholder mesh and start decoding. The
+ * placeholder must be set first (renderer.c creates a cube on first use). */
+EngineResult asset_load_model(VulkanContext *vk, const char *path,
+                              AssetLoadCallback callback, void *user,
+                              MeshHandle *out_handle);
+
+/* Start decoding a skinned model; out_model is zeroed now and filled when
+ * the load completes, so it must stay valid until then */
+EngineResult asset_load_skinned_model(VulkanContext *vk, const char *path,
+                                      SkinnedModel *out_model,
+                                      AssetLoadCallback callback, void *user);
+
+/* Reserve a texture handle that samples the dummy and start decoding */
+EngineResult asset_load_texture(VulkanContext *vk, const char *path, VkFilter filter,
+                                AssetLoadCallback callback, void *user,
+                                TextureHandle *out_handle);
+
+/* Finish loads whose decode is done, oldest first, until
+ * ASSET_LOAD_FRAME_BUDGET bytes have been staged: upload into the reserved
+ * handle, then run the callback. Call once per frame, on the main thread. */
+void         asset_load_poll(VulkanContext *vk);
+
+/* Loads started and not yet finished */
+u32          asset_load_pending(const VulkanContext *vk);
+
+#endif /* ENGINE_ASSET_LOAD_H */
@@ -0,0 +1,205 @@
+#include "renderer/async_compute.h"
+#include "renderer/vk_upload.h"
+#include "core/log.h"
+
+#include <string.h>
+
+/* --------------------------------------------------------------------------
+ * Lifecycle
+ * ------------------------------------------------------------------------ */
+
+EngineResult async_compute_init(VulkanContext *vk) {
+    AsyncComputeContext *ac = &vk->compute;
+    memset(ac, 0, sizeof(*ac));
+
+    /* Compute of frame n must be ordered after the graphics work of an
+     * earlier frame, which the graphics queue signals once per frame: that
+     * takes a timeline semaphore */
+    if (!vk->has_compute_queue || vk->compute_family == vk->graphics_family) {
+        LOG_INFO("Async compute: no compute-only queue family, compute runs on graphics");
+        return ENGINE_SUCCESS;
+    }
+    if (!vk->timeline_semaphores) {
+        LOG_INFO("Async compute: needs timeline semaphores, compute runs on graphics");
+        return ENGINE_SUCCESS;
+    }
+
+    EngineResult res = ENGINE_ERROR_VULKAN_INIT;
+
+    VkCommandPoolCreateInfo pool_info = {
+        .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+        .queueFamilyIndex = vk->compute_family,
+    };
+    if (vkCreateCommandPool(vk->device, &pool_info, NULL, &ac->command_pool) != VK_SUCCESS) {
+        LOG_FATAL("Async compute: failed to create command pool");
+        goto fail;
+    }
+
+    VkCommandBufferAllocateInfo alloc_info = {
+        .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .commandPool        = ac->command_pool,
+        .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = vk->frames_in_flight,
+    };
+    if (vkAllocateCommandBuffers(vk->device, &alloc_info, ac->command_buffers) != VK_SUCCESS) {
+        LOG_FATAL("Async compute: failed to allocate command buffers");
+        goto fail;
+    }
+
+    VkSemaphoreCreateInfo sem_info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+    };
+    for (u32 i = 0; i < vk->frames_in_flight; i++) {
+        if (vkCreateSemaphore(vk->device, &sem_info, NULL, &ac->done[i]) != VK_SUCCESS) {
+            LOG_FATAL("Async compute: failed to create semaphore for frame %u", i);
+            goto fail;
+        }
+    }
+
+    VkSemaphoreTypeCreateInfo type_info = {
+        .sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue  = 0,
+    };
+    VkSemaphoreCreateInfo timeline_info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &type_info,
+    };
+    if (vkCreateSemaphore(vk->device, &timeline_info, NULL,
+                          &ac->graphics_timeline) != VK_SUCCESS) {
+        LOG_FATAL("Async compute: failed to create graphics timeline semaphore");
+        goto fail;
+    }
+
+    ac->queue   = vk->compute_queue;
+    ac->family  = vk->compute_family;
+    ac->enabled = true;
+    LOG_INFO("Async compute: queue family %u (skinning, particles, light binning)",
+             ac->family);
+    return ENGINE_SUCCESS;
+
+fail:
+    async_compute_shutdown(vk);
+    return res;
+}
+
+void async_compute_shutdown(VulkanContext *vk) {
+    AsyncComputeContext *ac = &vk->compute;
+
+    for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        if (ac->done[i]) vkDestroySemaphore(vk->device, ac->done[i], NULL);
+    }
+    if (ac->graphics_timeline)
+        vkDestroySemaphore(vk->device, ac->graphics_timeline, NULL);
+    if (ac->command_pool)
+        vkDestroyCommandPool(vk->device, ac->command_pool, NULL);
+
+    memset(ac, 0, sizeof(*ac));
+}
+
+/* --------------------------------------------------------------------------
+ * Per frame
+ * ------------------------------------------------------------------------ */
+
+EngineResult async_compute_begin(VulkanContext *vk, VkCommandBuffer *out_cmd) {
+    AsyncComputeContext *ac = &vk->compute;
+    VkCommandBuffer cmd = ac->command_buffers[vk->current_frame];
+
+    /* The slot's fence has signaled, and its graphics submit waited on this
+     * buffer's previous submit */
+    vkResetCommandBuffer(cmd, 0);
+
+    VkCommandBufferBeginInfo begin_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    };
+    if (vkBeginCommandBuffer(cmd, &begin_info) != VK_SUCCESS) {
+        LOG_ERROR("Async compute: failed to begin command buffer");
+        return ENGINE_ERROR_VULKAN_INIT;
+    }
+
+    *out_cmd = cmd;
+    return ENGINE_SUCCESS;
+}
+
+EngineResult async_compute_end(VulkanContext *vk) {
+    AsyncComputeContext *ac = &vk->compute;
+    if (vkEndCommandBuffer(ac->command_buffers[vk->current_frame]) != VK_SUCCESS) {
+        LOG_ERROR("Async compute: failed to record command buffer");
+        return ENGINE_ERROR_VULKAN_INIT;
+    }
+    ac->recorded = true;
+    return ENGINE_SUCCESS;
+}
+
+EngineResult async_compute_submit(VulkanContext *vk, bool wait_previous) {
+    AsyncComputeContext *ac = &vk->compute;
+    ac->submitted = false;
+    if (!ac->recorded) return ENGINE_SUCCESS;
+    ac->recorded = false;
+
+    /* Frame n's graphics work signals n + 1. Everything written here is
+     * either per frame slot or one of two halves, so by default only the
+     * frame before last can still be reading it. */
+    u64 frame = vk->frame_number;
+    u64 after = wait_previous ? frame : (frame > 0 ? frame - 1 : 0);
+
+    VkSemaphore wait_sems[2]            = { ac->graphics_timeline };
+    u64 wait_values[2]                  = { after };
+    VkPipelineStageFlags wait_stages[2] = {
+        VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+    };
+    u32 wait_count = 1;
+
+    /* Skinning reads uploaded vertices, particles their uploaded args */
+    if (vk_upload_frame_wait(vk, &wait_sems[1], &wait_values[1])) {
+        wait_stages[1] = VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        wait_count = 2;
+    }
+
+    /* The binary done semaphore ignores its signal value */
+    u64 signal_value = 0;
+    VkTimelineSemaphoreSubmitInfo timeline_info = {
+        .sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .waitSemaphoreValueCount   = wait_count,
+        .pWaitSemaphoreValues      = wait_values,
+        .signalSemaphoreValueCount = 1,
+        .pSignalSemaphoreValues    = &signal_value,
+    };
+
+    VkSubmitInfo submit_info = {
+        .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext                = &timeline_info,
+        .waitSemaphoreCount   = wait_count,
+        .pWaitSemaphores      = wait_sems,
+        .pWaitDstStageMask    = wait_stages,
+        .commandBufferCount   = 1,
+        .pCommandBuffers      = &ac->command_buffers[vk->current_frame],
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores    = &ac->done[vk->current_frame],
+    };
+
+    if (vkQueueSubmit(ac->queue, 1, &submit_info, VK_NULL_HANDLE) != VK_SUCCESS) {
+        LOG_ERROR("Async compute: failed to submit command buffer");
+        return ENGINE_ERROR_VULKAN_INIT;
+    }
+
+    ac->submitted = true;
+    return ENGINE_SUCCESS;
+}
+
+bool async_compute_frame_wait(const VulkanContext *vk, VkSemaphore *out_sem) {
+    const AsyncComputeContext *ac = &vk->compute;
+    if (!ac->submitted) return false;
+    *out_sem = ac->done[vk->current_frame];
+    return true;
+}
+
+bool async_compute_frame_signal(const VulkanContext *vk, VkSemaphore *out_sem, u64 *out_value) {
+    const AsyncComputeContext *ac = &vk->compute;
+    if (!ac->enabled) return false;
+    *out_sem   = ac->graphics_timeline;
+    *out_value = vk->frame_number + 1;
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef ENGINE_ASYNC_COMPUTE_H
+#define ENGINE_ASYNC_COMPUTE_H
+
+#include "renderer/vk_types.h"
+#include "core/common.h"
+
+/* ---- Lifecycle (called from renderer.c) ---- */
+
+/* Command buffers and semaphores for the compute-only queue. Call after the
+ * logical device exists and before any buffer is created, since storage
+ * buffers are shared with the compute family once this enables it. Leaves
+ * async compute off and still succeeds without a compute-only family or
+ * timeline semaphores. */
+EngineResult async_compute_init(VulkanContext *vk);
+void         async_compute_shutdown(VulkanContext *vk);
+
+/* ---- Per frame ---- */
+
+/* Begin this frame slot's compute command buffer. Barriers recorded into
+ * it may only name compute and transfer stages. */
+EngineResult async_compute_begin(VulkanContext *vk, VkCommandBuffer *out_cmd);
+EngineResult async_compute_end(VulkanContext *vk);
+
+/* Submit what was recorded this frame, if anything. With wait_previous it
+ * overwrites data the previous frame still draws and waits for all of that
+ * frame's graphics work; otherwise only for the frame before. Call after
+ * vk_upload_flush so uploads the passes read are waited on. */
+EngineResult async_compute_submit(VulkanContext *vk, bool wait_previous);
+
+/* The graphics submit's extra wait: this frame's compute finishing.
+ * False if nothing was submitted. */
+bool async_compute_frame_wait(const VulkanContext *vk, VkSemaphore *out_sem);
+
+/* The graphics submit's extra signal: the graphics timeline value the next
+ * compute submits wait on. False with async compute off. */
+bool async_compute_frame_signal(const VulkanContext *vk, VkSemaphore *out_sem, u64 *out_value);
+
+#endif /* ENGINE_ASYNC_COMPUTE_H */
@@ -0,0 +1,96 @@
+#include "renderer/atlas_pack.h"
+
+#include <string.h>
+
+void atlas_pack_init(AtlasPacker *packer, u32 width, u32 height) {
+    packer->width       = width;
+    packer->height      = height;
+    packer->used_height = 0;
+    packer->used_area   = 0;
+    packer->node_count  = 1;
+    packer->nodes[0]    = (AtlasSkylineNode){ .x = 0, .y = 0, .width = width };
+}
+
+/* Lowest y at which a rectangle of `width` can sit with its left edge on node
+ * i, or UINT32_MAX if it runs off the right side */
+static u32 skyline_fit(const AtlasPacker *packer, u32 i, u32 width) {
+    u32 x = packer->nodes[i].x;
+    if (x + width > packer->width) return UINT32_MAX;
+
+    u32 y = 0;
+    u32 remaining = width;
+    for (; i < packer->node_count && remaining > 0; i++) {
+        const AtlasSkylineNode *n = &packer->nodes[i];
+        if (n->y > y) y = n->y;
+        remaining = (n->width >= remaining) ? 0 : remaining - n->width;
+    }
+    return y;
+}
+
+bool atlas_pack_insert(AtlasPacker *packer, u32 width, u32 height,
+                       u32 *out_x, u32 *out_y) {
+    if (width == 0 || height == 0) return false;
+    /* Inserting can split one node into two */
+    if (packer->node_count + 1 > ATLAS_PACK_MAX_NODES) return false;
+
+    u32 best = UINT32_MAX, best_top = UINT32_MAX, best_width = UINT32_MAX, best_y = 0;
+    for (u32 i = 0; i < packer->node_count; i++) {
+        u32 y = skyline_fit(packer, i, width);
+        if (y == UINT32_MAX || y + height > packer->height) continue;
+        u32 top = y + height;
+        if (top < best_top || (top == best_top && packer->nodes[i].width < best_width)) {
+            best       = i;
+            best_top   = top;
+            best_width = packer->nodes[i].width;
+            best_y     = y;
+        }
+    }
+    if (best == UINT32_MAX) return false;
+
+    u32 x = packer->nodes[best].x;
+
+    /* New segment for the rectangle's top edge, then trim or drop the
+     * segments it now covers */
+    memmove(&packer->nodes[best + 1], &packer->nodes[best],
+            (packer->node_count - best) * sizeof(AtlasSkylineNode));
+    packer->nodes[best] = (AtlasSkylineNode){ .x = x, .y = best_top, .width = width };
+    packer->node_count++;
+
+    u32 right = x + width;
+    u32 i = best + 1;
+    while (i < packer->node_count && packer->nodes[i].x < right) {
+        AtlasSkylineNode *n = &packer->nodes[i];
+        u32 n_right = n->x + n->width;
+        if (n_right <= right) {
+            memmove(n, n + 1, (packer->node_count - i - 1) * sizeof(AtlasSkylineNode));
+            packer->node_count--;
+        } else {
+            n->width = n_right - right;
+            n->x = right;
+            break;
+        }
+    }
+
+    /* Merge neighbours of equal height */
+    for (i = 0; i + 1 < packer->node_count; ) {
+        if (packer->nodes[i].y == packer->nodes[i + 1].y) {
+            packer->nodes[i].width += packer->nodes[i + 1].width;
+            memmove(&packer->nodes[i + 1], &packer->nodes[i + 2],
+                    (packer->node_count - i - 2) * sizeof(AtlasSkylineNode));
+            packer->node_count--;
+        } else {
+            i++;
+        }
+    }
+
+    if (best_top > packer->used_height) packer->used_height = best_top;
+    packer->used_area += (u64)width * height;
+    *out_x = x;
+    *out_y = best_y;
+    return true;
+}
+
+f32 atlas_pack_occupancy(const AtlasPacker *packer) {
+    u64 area = (u64)packer->width * packer->used_height;
+    return area ? (f32)((double)packer->used_area / (double)area) : 0.0f;
+}
@@ -0,0 +1,38 @@
+#ifndef ENGINE_ATLAS_PACK_H
+#define ENGINE_ATLAS_PACK_H
+
+#include "core/common.h"
+
+/* Skyline bottom-left rectangle packer (CPU only). The packed area is kept
+ * as a list of horizontal segments ("the skyline"); each rectangle goes where
+ * its top edge ends lowest, ties broken by the narrowest segment. Feeding
+ * rectangles sorted by decreasing height packs noticeably tighter. */
+
+#define ATLAS_PACK_MAX_NODES 1024
+
+typedef struct {
+    u32 x;
+    u32 y;          /* height of the skyline over [x, x + width) */
+    u32 width;
+} AtlasSkylineNode;
+
+typedef struct {
+    u32              width;
+    u32              height;
+    u32              used_height;   /* highest point of the skyline */
+    u64              used_area;     /* sum of inserted rectangle areas */
+    u32              node_count;
+    AtlasSkylineNode nodes[ATLAS_PACK_MAX_NODES];
+} AtlasPacker;
+
+void atlas_pack_init(AtlasPacker *packer, u32 width, u32 height);
+
+/* Place a width x height rectangle. Returns false (packer unchanged) if it
+ * doesn't fit. */
+bool atlas_pack_insert(AtlasPacker *packer, u32 width, u32 height,
+                       u32 *out_x, u32 *out_y);
+
+/* Fraction of the area below used_height covered by rectangles */
+f32  atlas_pack_occupancy(const AtlasPacker *packer);
+
+#endif /* ENGINE_ATLAS_PACK_H */
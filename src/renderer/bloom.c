@@ -2,6 +2,8 @@
 #include "renderer/bloom.h"
 #include "renderer/vk_pipeline.h"
 #include "renderer/vk_buffer.h"
+#include "renderer/render_graph.h"
+#include "renderer/gpu_profiler.h"
 #include "core/log.h"
 
 #include <stdlib.h>
@@ -10,97 +12,77 @@
 /* HDR format for the offscreen scene image */
 #define BLOOM_HDR_FORMAT VK_FORMAT_R16G16B16A16_SFLOAT
 
-/* Half-res format for the bloom ping-pong images */
-#define BLOOM_BLUR_FORMAT VK_FORMAT_R16G16B16A16_SFLOAT
+/* Format for the bloom mip pyramid (also written as a storage image) */
+#define BLOOM_PYRAMID_FORMAT VK_FORMAT_R16G16B16A16_SFLOAT
 
-/* --------------------------------------------------------------------------
- * Helper: find suitable memory type
- * ------------------------------------------------------------------------ */
-
-static u32 find_memory_type(VulkanContext *vk, u32 type_filter, VkMemoryPropertyFlags props) {
-    VkPhysicalDeviceMemoryProperties mem_props;
-    vkGetPhysicalDeviceMemoryProperties(vk->physical_device, &mem_props);
-
-    for (u32 i = 0; i < mem_props.memoryTypeCount; i++) {
-        if ((type_filter & (1 << i)) &&
-            (mem_props.memoryTypes[i].propertyFlags & props) == props) {
-            return i;
-        }
-    }
-    LOG_FATAL("Bloom: failed to find suitable memory type");
-    return UINT32_MAX;
-}
+/* Workgroup size of bloom_down.comp / bloom_up.comp */
+#define BLOOM_GROUP_SIZE 8
 
 /* --------------------------------------------------------------------------
- * Helper: create an image + memory + view + sampler
+ * Targets: the scene image and mip pyramid are transient render graph images;
+ * bloom owns only their views
  * ------------------------------------------------------------------------ */
 
-static EngineResult create_bloom_image(VulkanContext *vk, u32 width, u32 height,
-                                        VkFormat format, VkImageUsageFlags usage,
-                                        VkImage *out_image, VkDeviceMemory *out_memory,
-                                        VkImageView *out_view, VkSampler *out_sampler) {
-    VkImageCreateInfo img_info = {
-        .sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-        .imageType     = VK_IMAGE_TYPE_2D,
-        .extent        = { width, height, 1 },
-        .mipLevels     = 1,
-        .arrayLayers   = 1,
-        .format        = format,
-        .tiling        = VK_IMAGE_TILING_OPTIMAL,
-        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-        .usage         = usage,
-        .sharingMode   = VK_SHARING_MODE_EXCLUSIVE,
-        .samples       = VK_SAMPLE_COUNT_1_BIT,
-    };
-
-    if (vkCreateImage(vk->device, &img_info, NULL, out_image) != VK_SUCCESS) {
-        LOG_FATAL("Bloom: failed to create image (%ux%u)", width, height);
-        return ENGINE_ERROR_VULKAN_INIT;
-    }
+/* Size the pyramid for the current swapchain, stopping before a level would
+ * drop below one texel, and describe both targets to the graph */
+static void describe_targets(VulkanContext *vk, RgImageDesc *scene, RgImageDesc *pyramid) {
+    BloomContext *b = &vk->bloom;
 
-    VkMemoryRequirements mem_reqs;
-    vkGetImageMemoryRequirements(vk->device, *out_image, &mem_reqs);
+    u32 w = vk->swapchain_extent.width;
+    u32 h = vk->swapchain_extent.height;
+    b->bloom_extent.width  = ENGINE_MAX(w / 2, 1);
+    b->bloom_extent.height = ENGINE_MAX(h / 2, 1);
 
-    u32 mem_type = find_memory_type(vk, mem_reqs.memoryTypeBits,
-                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-    if (mem_type == UINT32_MAX) {
-        vkDestroyImage(vk->device, *out_image, NULL);
-        return ENGINE_ERROR_VULKAN_INIT;
+    u32 mw = b->bloom_extent.width, mh = b->bloom_extent.height;
+    b->mip_count = 0;
+    while (b->mip_count < BLOOM_MAX_MIPS) {
+        b->mip_extents[b->mip_count++] = (VkExtent2D){ mw, mh };
+        if (mw < 2 || mh < 2) break;
+        mw /= 2;
+        mh /= 2;
     }
 
-    VkMemoryAllocateInfo alloc = {
-        .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .allocationSize  = mem_reqs.size,
-        .memoryTypeIndex = mem_type,
+    *scene = (RgImageDesc){
+        .format       = BLOOM_HDR_FORMAT,
+        .extent       = { w, h },
+        .mip_levels   = 1,
+        .array_layers = 1,
+        .usage        = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        .aspect       = VK_IMAGE_ASPECT_COLOR_BIT,
     };
+    *pyramid = (RgImageDesc){
+        .format       = BLOOM_PYRAMID_FORMAT,
+        .extent       = b->bloom_extent,
+        .mip_levels   = b->mip_count,
+        .array_layers = 1,
+        .usage        = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        .aspect       = VK_IMAGE_ASPECT_COLOR_BIT,
+    };
+}
 
-    if (vkAllocateMemory(vk->device, &alloc, NULL, out_memory) != VK_SUCCESS) {
-        vkDestroyImage(vk->device, *out_image, NULL);
-        return ENGINE_ERROR_OUT_OF_MEMORY;
-    }
-
-    vkBindImageMemory(vk->device, *out_image, *out_memory, 0);
-
+static EngineResult create_mip_view(VulkanContext *vk, VkImage image, VkFormat format,
+                                    u32 mip, VkImageView *out) {
     VkImageViewCreateInfo view_info = {
         .sType    = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-        .image    = *out_image,
+        .image    = image,
         .viewType = VK_IMAGE_VIEW_TYPE_2D,
         .format   = format,
         .subresourceRange = {
             .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-            .baseMipLevel   = 0,
+            .baseMipLevel   = mip,
             .levelCount     = 1,
             .baseArrayLayer = 0,
             .layerCount     = 1,
         },
     };
 
-    if (vkCreateImageView(vk->device, &view_info, NULL, out_view) != VK_SUCCESS) {
-        vkFreeMemory(vk->device, *out_memory, NULL);
-        vkDestroyImage(vk->device, *out_image, NULL);
+    if (vkCreateImageView(vk->device, &view_info, NULL, out) != VK_SUCCESS)
         return ENGINE_ERROR_VULKAN_INIT;
-    }
+    return ENGINE_SUCCESS;
+}
 
+static EngineResult create_linear_sampler(VulkanContext *vk, VkSamplerMipmapMode mip_mode,
+                                          VkSampler *out) {
     VkSamplerCreateInfo sampler_info = {
         .sType        = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
         .magFilter    = VK_FILTER_LINEAR,
@@ -108,85 +90,11 @@ static EngineResult create_bloom_image(VulkanContext *vk, u32 width, u32 height,
         .addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
         .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
         .addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
-        .mipmapMode   = VK_SAMPLER_MIPMAP_MODE_LINEAR,
-    };
-
-    if (vkCreateSampler(vk->device, &sampler_info, NULL, out_sampler) != VK_SUCCESS) {
-        vkDestroyImageView(vk->device, *out_view, NULL);
-        vkFreeMemory(vk->device, *out_memory, NULL);
-        vkDestroyImage(vk->device, *out_image, NULL);
-        return ENGINE_ERROR_VULKAN_INIT;
-    }
-
-    return ENGINE_SUCCESS;
-}
-
-static void destroy_bloom_image(VulkanContext *vk, VkImage *image, VkDeviceMemory *memory,
-                                 VkImageView *view, VkSampler *sampler) {
-    if (*sampler)  { vkDestroySampler(vk->device, *sampler, NULL);    *sampler = VK_NULL_HANDLE; }
-    if (*view)     { vkDestroyImageView(vk->device, *view, NULL);     *view = VK_NULL_HANDLE; }
-    if (*image)    { vkDestroyImage(vk->device, *image, NULL);        *image = VK_NULL_HANDLE; }
-    if (*memory)   { vkFreeMemory(vk->device, *memory, NULL);         *memory = VK_NULL_HANDLE; }
-}
-
-/* --------------------------------------------------------------------------
- * Helper: create depth buffer for bloom scene
- * ------------------------------------------------------------------------ */
-
-static EngineResult create_bloom_depth(VulkanContext *vk) {
-    BloomContext *b = &vk->bloom;
-
-    VkImageCreateInfo img_info = {
-        .sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-        .imageType     = VK_IMAGE_TYPE_2D,
-        .extent        = { vk->swapchain_extent.width, vk->swapchain_extent.height, 1 },
-        .mipLevels     = 1,
-        .arrayLayers   = 1,
-        .format        = VK_FORMAT_D32_SFLOAT,
-        .tiling        = VK_IMAGE_TILING_OPTIMAL,
-        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-        .usage         = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-        .sharingMode   = VK_SHARING_MODE_EXCLUSIVE,
-        .samples       = VK_SAMPLE_COUNT_1_BIT,
-    };
-
-    if (vkCreateImage(vk->device, &img_info, NULL, &b->depth_image) != VK_SUCCESS)
-        return ENGINE_ERROR_VULKAN_INIT;
-
-    VkMemoryRequirements mem_reqs;
-    vkGetImageMemoryRequirements(vk->device, b->depth_image, &mem_reqs);
-    u32 mem_type = find_memory_type(vk, mem_reqs.memoryTypeBits,
-                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-    if (mem_type == UINT32_MAX) return ENGINE_ERROR_VULKAN_INIT;
-
-    VkMemoryAllocateInfo alloc = {
-        .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .allocationSize  = mem_reqs.size,
-        .memoryTypeIndex = mem_type,
-    };
-
-    if (vkAllocateMemory(vk->device, &alloc, NULL, &b->depth_memory) != VK_SUCCESS)
-        return ENGINE_ERROR_OUT_OF_MEMORY;
-
-    vkBindImageMemory(vk->device, b->depth_image, b->depth_memory, 0);
-
-    VkImageViewCreateInfo view_info = {
-        .sType    = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-        .image    = b->depth_image,
-        .viewType = VK_IMAGE_VIEW_TYPE_2D,
-        .format   = VK_FORMAT_D32_SFLOAT,
-        .subresourceRange = {
-            .aspectMask     = VK_IMAGE_ASPECT_DEPTH_BIT,
-            .baseMipLevel   = 0,
-            .levelCount     = 1,
-            .baseArrayLayer = 0,
-            .layerCount     = 1,
-        },
+        .mipmapMode   = mip_mode,
     };
 
-    if (vkCreateImageView(vk->device, &view_info, NULL, &b->depth_view) != VK_SUCCESS)
+    if (vkCreateSampler(vk->device, &sampler_info, NULL, out) != VK_SUCCESS)
         return ENGINE_ERROR_VULKAN_INIT;
-
     return ENGINE_SUCCESS;
 }
 
@@ -200,15 +108,15 @@ static EngineResult create_render_passes(VulkanContext *vk) {
     /* --- Pass 1: Scene render pass (HDR color + depth) --- */
     {
         VkAttachmentDescription attachments[] = {
-            { /* HDR color */
+            { /* HDR color (the render graph transitions it around the pass) */
                 .format         = BLOOM_HDR_FORMAT,
                 .samples        = VK_SAMPLE_COUNT_1_BIT,
                 .loadOp         = VK_ATTACHMENT_LOAD_OP_CLEAR,
                 .storeOp        = VK_ATTACHMENT_STORE_OP_STORE,
                 .stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
                 .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-                .initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED,
-                .finalLayout    = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                .initialLayout  = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                .finalLayout    = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
             },
             { /* Depth */
                 .format         = VK_FORMAT_D32_SFLOAT,
@@ -260,52 +168,6 @@ static EngineResult create_render_passes(VulkanContext *vk) {
         }
     }
 
-    /* --- Post-process render pass (single HDR color, shared by extract + blur) --- */
-    {
-        VkAttachmentDescription attachment = {
-            .format         = BLOOM_BLUR_FORMAT,
-            .samples        = VK_SAMPLE_COUNT_1_BIT,
-            .loadOp         = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
-            .storeOp        = VK_ATTACHMENT_STORE_OP_STORE,
-            .stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
-            .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-            .initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED,
-            .finalLayout    = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-        };
-
-        VkAttachmentReference color_ref = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
-
-        VkSubpassDescription subpass = {
-            .pipelineBindPoint    = VK_PIPELINE_BIND_POINT_GRAPHICS,
-            .colorAttachmentCount = 1,
-            .pColorAttachments    = &color_ref,
-        };
-
-        VkSubpassDependency dep = {
-            .srcSubpass    = VK_SUBPASS_EXTERNAL,
-            .dstSubpass    = 0,
-            .srcStageMask  = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-            .srcAccessMask = VK_ACCESS_SHADER_READ_BIT,
-            .dstStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-            .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-        };
-
-        VkRenderPassCreateInfo rp_info = {
-            .sType           = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
-            .attachmentCount = 1,
-            .pAttachments    = &attachment,
-            .subpassCount    = 1,
-            .pSubpasses      = &subpass,
-            .dependencyCount = 1,
-            .pDependencies   = &dep,
-        };
-
-        if (vkCreateRenderPass(vk->device, &rp_info, NULL, &b->postprocess_render_pass) != VK_SUCCESS) {
-            LOG_FATAL("Bloom: failed to create postprocess render pass");
-            return ENGINE_ERROR_VULKAN_PIPELINE;
-        }
-    }
-
     /* --- Composite render pass (single swapchain color) --- */
     {
         VkAttachmentDescription attachment = {
@@ -363,23 +225,31 @@ static EngineResult create_render_passes(VulkanContext *vk) {
 static EngineResult create_descriptors(VulkanContext *vk) {
     BloomContext *b = &vk->bloom;
 
-    /* Single sampler layout (extract, blur) */
+    /* Mip pass layout (down/up compute: sampled source + storage destination) */
     {
-        VkDescriptorSetLayoutBinding binding = {
-            .binding         = 0,
-            .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-            .descriptorCount = 1,
-            .stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT,
+        VkDescriptorSetLayoutBinding bindings[] = {
+            {
+                .binding         = 0,
+                .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                .descriptorCount = 1,
+                .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+            },
+            {
+                .binding         = 1,
+                .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                .descriptorCount = 1,
+                .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+            },
         };
 
         VkDescriptorSetLayoutCreateInfo info = {
             .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-            .bindingCount = 1,
-            .pBindings    = &binding,
+            .bindingCount = 2,
+            .pBindings    = bindings,
         };
 
         if (vkCreateDescriptorSetLayout(vk->device, &info, NULL,
-                                         &b->single_sampler_layout) != VK_SUCCESS) {
+                                         &b->mip_set_layout) != VK_SUCCESS) {
             return ENGINE_ERROR_VULKAN_PIPELINE;
         }
     }
@@ -413,18 +283,20 @@ static EngineResult create_descriptors(VulkanContext *vk) {
         }
     }
 
-    /* Descriptor pool: 3 single-sampler sets + 1 dual-sampler set = 5 samplers total, 4 sets */
+    /* Descriptor pool: a down and an up set per mip (sampler + storage each),
+     * plus the composite set (2 samplers). Sets are allocated for
+     * BLOOM_MAX_MIPS up front so a resize never reallocates them. */
     {
-        VkDescriptorPoolSize pool_size = {
-            .type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-            .descriptorCount = 5,
+        VkDescriptorPoolSize pool_sizes[] = {
+            { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2 * BLOOM_MAX_MIPS + 2 },
+            { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,          2 * BLOOM_MAX_MIPS },
         };
 
         VkDescriptorPoolCreateInfo info = {
             .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-            .maxSets       = 4,
-            .poolSizeCount = 1,
-            .pPoolSizes    = &pool_size,
+            .maxSets       = 2 * BLOOM_MAX_MIPS + 1,
+            .poolSizeCount = 2,
+            .pPoolSizes    = pool_sizes,
         };
 
         if (vkCreateDescriptorPool(vk->device, &info, NULL, &b->desc_pool) != VK_SUCCESS) {
@@ -434,27 +306,25 @@ static EngineResult create_descriptors(VulkanContext *vk) {
 
     /* Allocate descriptor sets */
     {
-        VkDescriptorSetLayout single_layouts[] = {
-            b->single_sampler_layout,
-            b->single_sampler_layout,
-            b->single_sampler_layout,
-        };
+        VkDescriptorSetLayout mip_layouts[2 * BLOOM_MAX_MIPS];
+        for (u32 i = 0; i < 2 * BLOOM_MAX_MIPS; i++) mip_layouts[i] = b->mip_set_layout;
 
         VkDescriptorSetAllocateInfo alloc = {
             .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
             .descriptorPool     = b->desc_pool,
-            .descriptorSetCount = 3,
-            .pSetLayouts        = single_layouts,
+            .descriptorSetCount = 2 * BLOOM_MAX_MIPS,
+            .pSetLayouts        = mip_layouts,
         };
 
-        VkDescriptorSet sets[3];
+        VkDescriptorSet sets[2 * BLOOM_MAX_MIPS];
         if (vkAllocateDescriptorSets(vk->device, &alloc, sets) != VK_SUCCESS) {
             return ENGINE_ERROR_VULKAN_INIT;
         }
 
-        b->extract_desc_set = sets[0];
-        b->blur_h_desc_set  = sets[1];
-        b->blur_v_desc_set  = sets[2];
+        for (u32 i = 0; i < BLOOM_MAX_MIPS; i++) {
+            b->down_desc_sets[i] = sets[i];
+            b->up_desc_sets[i]   = sets[BLOOM_MAX_MIPS + i];
+        }
     }
 
     {
@@ -481,79 +351,167 @@ static EngineResult create_descriptors(VulkanContext *vk) {
 static void update_descriptor_sets(VulkanContext *vk) {
     BloomContext *b = &vk->bloom;
 
-    /* extract_desc_set: binding 0 = scene_image */
+    /* The pyramid stays in GENERAL for both sampling and storage while the
+     * down/up chain runs; the graph moves it to SHADER_READ_ONLY for the
+     * composite */
     VkDescriptorImageInfo scene_info = {
         .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
         .imageView   = b->scene_view,
         .sampler     = b->scene_sampler,
     };
 
-    /* blur_h_desc_set: binding 0 = bloom_a */
-    VkDescriptorImageInfo bloom_a_info = {
-        .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-        .imageView   = b->bloom_a_view,
-        .sampler     = b->bloom_a_sampler,
-    };
+    VkDescriptorImageInfo mip_infos[BLOOM_MAX_MIPS];
+    for (u32 i = 0; i < b->mip_count; i++) {
+        mip_infos[i] = (VkDescriptorImageInfo){
+            .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+            .imageView   = b->mip_views[i],
+            .sampler     = b->pyramid_sampler,
+        };
+    }
 
-    /* blur_v_desc_set: binding 0 = bloom_b */
-    VkDescriptorImageInfo bloom_b_info = {
+    VkDescriptorImageInfo bloom_info = {
         .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-        .imageView   = b->bloom_b_view,
-        .sampler     = b->bloom_b_sampler,
+        .imageView   = b->mip_views[0],
+        .sampler     = b->pyramid_sampler,
     };
 
-    VkWriteDescriptorSet writes[] = {
-        { /* extract: scene */
-            .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-            .dstSet          = b->extract_desc_set,
-            .dstBinding      = 0,
-            .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-            .descriptorCount = 1,
-            .pImageInfo      = &scene_info,
-        },
-        { /* blur_h: bloom_a */
+    VkWriteDescriptorSet writes[4 * BLOOM_MAX_MIPS + 2];
+    u32 count = 0;
+
+    for (u32 i = 0; i < b->mip_count; i++) {
+        /* down[i]: mip i-1 (scene for i == 0) -> mip i */
+        writes[count++] = (VkWriteDescriptorSet){
             .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-            .dstSet          = b->blur_h_desc_set,
+            .dstSet          = b->down_desc_sets[i],
             .dstBinding      = 0,
             .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
             .descriptorCount = 1,
-            .pImageInfo      = &bloom_a_info,
-        },
-        { /* blur_v: bloom_b */
+            .pImageInfo      = (i == 0) ? &scene_info : &mip_infos[i - 1],
+        };
+        writes[count++] = (VkWriteDescriptorSet){
             .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-            .dstSet          = b->blur_v_desc_set,
-            .dstBinding      = 0,
-            .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .dstSet          = b->down_desc_sets[i],
+            .dstBinding      = 1,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
             .descriptorCount = 1,
-            .pImageInfo      = &bloom_b_info,
-        },
-        { /* composite binding 0: scene */
+            .pImageInfo      = &mip_infos[i],
+        };
+
+        if (i == 0) continue;
+
+        /* up[i]: mip i -> mip i-1 */
+        writes[count++] = (VkWriteDescriptorSet){
             .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-            .dstSet          = b->composite_desc_set,
+            .dstSet          = b->up_desc_sets[i],
             .dstBinding      = 0,
             .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
             .descriptorCount = 1,
-            .pImageInfo      = &scene_info,
-        },
-        { /* composite binding 1: bloom_a */
+            .pImageInfo      = &mip_infos[i],
+        };
+        writes[count++] = (VkWriteDescriptorSet){
             .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-            .dstSet          = b->composite_desc_set,
+            .dstSet          = b->up_desc_sets[i],
             .dstBinding      = 1,
-            .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
             .descriptorCount = 1,
-            .pImageInfo      = &bloom_a_info,
-        },
+            .pImageInfo      = &mip_infos[i - 1],
+        };
+    }
+
+    /* composite: scene + pyramid mip 0 */
+    writes[count++] = (VkWriteDescriptorSet){
+        .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet          = b->composite_desc_set,
+        .dstBinding      = 0,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .descriptorCount = 1,
+        .pImageInfo      = &scene_info,
+    };
+    writes[count++] = (VkWriteDescriptorSet){
+        .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet          = b->composite_desc_set,
+        .dstBinding      = 1,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .descriptorCount = 1,
+        .pImageInfo      = &bloom_info,
     };
 
-    vkUpdateDescriptorSets(vk->device, 5, writes, 0, NULL);
+    vkUpdateDescriptorSets(vk->device, count, writes, 0, NULL);
 }
 
 /* --------------------------------------------------------------------------
- * Pipeline creation (extract, blur, composite)
+ * Pipeline creation (down/up compute, composite)
  * ------------------------------------------------------------------------ */
 
-static EngineResult create_postprocess_pipelines(VulkanContext *vk) {
+/* Push constants shared by bloom_down.comp and bloom_up.comp. Only the
+ * scaled part of each level is live, so the shaders clamp their reads to
+ * src_max / src_uv_max instead of the allocated size. */
+typedef struct {
+    f32 threshold;        /* down: soft-knee threshold (prefilter pass only) */
+    f32 soft_threshold;
+    u32 prefilter;        /* down: 1 on the scene -> mip 0 pass */
+    u32 pad;
+    i32 src_max[2];       /* down: last live source texel */
+    i32 dst_size[2];      /* live destination extent */
+    f32 src_uv_max[2];    /* up: last live source texel centre, in UV */
+} BloomMipPush;
+
+static EngineResult create_mip_pipeline(VulkanContext *vk, const char *path, VkPipeline *out) {
+    size_t code_size;
+    u8 *code = vk_read_file(path, &code_size);
+    if (!code) {
+        LOG_FATAL("Bloom: failed to load %s", path);
+        return ENGINE_ERROR_FILE_NOT_FOUND;
+    }
+
+    VkShaderModule module = vk_create_shader_module(vk->device, code, code_size);
+    free(code);
+    if (module == VK_NULL_HANDLE) return ENGINE_ERROR_VULKAN_PIPELINE;
+
+    VkComputePipelineCreateInfo info = {
+        .sType  = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .stage  = {
+            .sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage  = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module = module,
+            .pName  = "main",
+        },
+        .layout = vk->bloom.mip_layout,
+    };
+
+    VkResult vr = vkCreateComputePipelines(vk->device, vk->pipeline_cache, 1, &info, NULL, out);
+    vkDestroyShaderModule(vk->device, module, NULL);
+    return (vr == VK_SUCCESS) ? ENGINE_SUCCESS : ENGINE_ERROR_VULKAN_PIPELINE;
+}
+
+EngineResult bloom_create_postprocess_pipelines(VulkanContext *vk) {
     BloomContext *b = &vk->bloom;
+    EngineResult res;
+
+    /* ---- Down/up compute pipelines (shared layout) ---- */
+    {
+        VkPushConstantRange push = {
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .offset     = 0,
+            .size       = sizeof(BloomMipPush),
+        };
+
+        VkPipelineLayoutCreateInfo layout_info = {
+            .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .setLayoutCount         = 1,
+            .pSetLayouts            = &b->mip_set_layout,
+            .pushConstantRangeCount = 1,
+            .pPushConstantRanges    = &push,
+        };
+
+        if (vkCreatePipelineLayout(vk->device, &layout_info, NULL, &b->mip_layout) != VK_SUCCESS)
+            return ENGINE_ERROR_VULKAN_PIPELINE;
+
+        if ((res = create_mip_pipeline(vk, "shaders/bloom_down.comp.spv", &b->down_pipeline)) != ENGINE_SUCCESS)
+            return res;
+        if ((res = create_mip_pipeline(vk, "shaders/bloom_up.comp.spv", &b->up_pipeline)) != ENGINE_SUCCESS)
+            return res;
+    }
 
     /* Shared fullscreen vertex shader */
     size_t vert_size;
@@ -566,7 +524,7 @@ static EngineResult create_postprocess_pipelines(VulkanContext *vk) {
     free(vert_code);
     if (vert_module == VK_NULL_HANDLE) return ENGINE_ERROR_VULKAN_PIPELINE;
 
-    /* Shared pipeline state for fullscreen passes (no vertex input, no depth, no blending) */
+    /* Pipeline state for the fullscreen composite (no vertex input, no depth, no blending) */
     VkPipelineVertexInputStateCreateInfo empty_vertex_input = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
     };
@@ -620,146 +578,6 @@ static EngineResult create_postprocess_pipelines(VulkanContext *vk) {
         .pAttachments    = &no_blend,
     };
 
-    /* ---- Extract pipeline ---- */
-    {
-        size_t frag_size;
-        u8 *frag_code = vk_read_file("shaders/bloom_extract.frag.spv", &frag_size);
-        if (!frag_code) {
-            vkDestroyShaderModule(vk->device, vert_module, NULL);
-            return ENGINE_ERROR_FILE_NOT_FOUND;
-        }
-        VkShaderModule frag_module = vk_create_shader_module(vk->device, frag_code, frag_size);
-        free(frag_code);
-        if (frag_module == VK_NULL_HANDLE) {
-            vkDestroyShaderModule(vk->device, vert_module, NULL);
-            return ENGINE_ERROR_VULKAN_PIPELINE;
-        }
-
-        VkPipelineShaderStageCreateInfo stages[] = {
-            { .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-              .stage = VK_SHADER_STAGE_VERTEX_BIT, .module = vert_module, .pName = "main" },
-            { .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-              .stage = VK_SHADER_STAGE_FRAGMENT_BIT, .module = frag_module, .pName = "main" },
-        };
-
-        /* Push constants: threshold(f32) + soft_threshold(f32) = 8 bytes */
-        VkPushConstantRange push = {
-            .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
-            .offset     = 0,
-            .size       = 8,
-        };
-
-        VkPipelineLayoutCreateInfo layout_info = {
-            .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-            .setLayoutCount         = 1,
-            .pSetLayouts            = &b->single_sampler_layout,
-            .pushConstantRangeCount = 1,
-            .pPushConstantRanges    = &push,
-        };
-
-        if (vkCreatePipelineLayout(vk->device, &layout_info, NULL, &b->extract_layout) != VK_SUCCESS) {
-            vkDestroyShaderModule(vk->device, frag_module, NULL);
-            vkDestroyShaderModule(vk->device, vert_module, NULL);
-            return ENGINE_ERROR_VULKAN_PIPELINE;
-        }
-
-        VkGraphicsPipelineCreateInfo pipe_info = {
-            .sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-            .stageCount          = 2,
-            .pStages             = stages,
-            .pVertexInputState   = &empty_vertex_input,
-            .pInputAssemblyState = &input_assembly,
-            .pViewportState      = &viewport_state,
-            .pRasterizationState  = &rasterizer,
-            .pMultisampleState    = &multisampling,
-            .pDepthStencilState   = &no_depth,
-            .pColorBlendState     = &color_blending,
-            .pDynamicState        = &dynamic_state,
-            .layout               = b->extract_layout,
-            .renderPass           = b->postprocess_render_pass,
-            .subpass              = 0,
-        };
-
-        VkResult result = vkCreateGraphicsPipelines(vk->device, VK_NULL_HANDLE, 1,
-                                                     &pipe_info, NULL, &b->extract_pipeline);
-        vkDestroyShaderModule(vk->device, frag_module, NULL);
-
-        if (result != VK_SUCCESS) {
-            vkDestroyShaderModule(vk->device, vert_module, NULL);
-            return ENGINE_ERROR_VULKAN_PIPELINE;
-        }
-    }
-
-    /* ---- Blur pipeline ---- */
-    {
-        size_t frag_size;
-        u8 *frag_code = vk_read_file("shaders/bloom_blur.frag.spv", &frag_size);
-        if (!frag_code) {
-            vkDestroyShaderModule(vk->device, vert_module, NULL);
-            return ENGINE_ERROR_FILE_NOT_FOUND;
-        }
-        VkShaderModule frag_module = vk_create_shader_module(vk->device, frag_code, frag_size);
-        free(frag_code);
-        if (frag_module == VK_NULL_HANDLE) {
-            vkDestroyShaderModule(vk->device, vert_module, NULL);
-            return ENGINE_ERROR_VULKAN_PIPELINE;
-        }
-
-        VkPipelineShaderStageCreateInfo stages[] = {
-            { .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-              .stage = VK_SHADER_STAGE_VERTEX_BIT, .module = vert_module, .pName = "main" },
-            { .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-              .stage = VK_SHADER_STAGE_FRAGMENT_BIT, .module = frag_module, .pName = "main" },
-        };
-
-        /* Push constants: direction(vec2) = 8 bytes */
-        VkPushConstantRange push = {
-            .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
-            .offset     = 0,
-            .size       = 8,
-        };
-
-        VkPipelineLayoutCreateInfo layout_info = {
-            .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-            .setLayoutCount         = 1,
-            .pSetLayouts            = &b->single_sampler_layout,
-            .pushConstantRangeCount = 1,
-            .pPushConstantRanges    = &push,
-        };
-
-        if (vkCreatePipelineLayout(vk->device, &layout_info, NULL, &b->blur_layout) != VK_SUCCESS) {
-            vkDestroyShaderModule(vk->device, frag_module, NULL);
-            vkDestroyShaderModule(vk->device, vert_module, NULL);
-            return ENGINE_ERROR_VULKAN_PIPELINE;
-        }
-
-        VkGraphicsPipelineCreateInfo pipe_info = {
-            .sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-            .stageCount          = 2,
-            .pStages             = stages,
-            .pVertexInputState   = &empty_vertex_input,
-            .pInputAssemblyState = &input_assembly,
-            .pViewportState      = &viewport_state,
-            .pRasterizationState  = &rasterizer,
-            .pMultisampleState    = &multisampling,
-            .pDepthStencilState   = &no_depth,
-            .pColorBlendState     = &color_blending,
-            .pDynamicState        = &dynamic_state,
-            .layout               = b->blur_layout,
-            .renderPass           = b->postprocess_render_pass,
-            .subpass              = 0,
-        };
-
-        VkResult result = vkCreateGraphicsPipelines(vk->device, VK_NULL_HANDLE, 1,
-                                                     &pipe_info, NULL, &b->blur_pipeline);
-        vkDestroyShaderModule(vk->device, frag_module, NULL);
-
-        if (result != VK_SUCCESS) {
-            vkDestroyShaderModule(vk->device, vert_module, NULL);
-            return ENGINE_ERROR_VULKAN_PIPELINE;
-        }
-    }
-
     /* ---- Composite pipeline ---- */
     {
         size_t frag_size;
@@ -782,11 +600,12 @@ static EngineResult create_postprocess_pipelines(VulkanContext *vk) {
               .stage = VK_SHADER_STAGE_FRAGMENT_BIT, .module = frag_module, .pName = "main" },
         };
 
-        /* Push constants: intensity + scanline_strength + scanline_count + aberration + screen_size = 24 bytes */
+        /* Push constants: intensity + scanline_strength + scanline_count + aberration +
+         * screen_size + scene_uv_scale + scene_uv_max + bloom_uv_max = 48 bytes */
         VkPushConstantRange push = {
             .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
             .offset     = 0,
-            .size       = 24,
+            .size       = 48,
         };
 
         VkPipelineLayoutCreateInfo layout_info = {
@@ -820,7 +639,7 @@ static EngineResult create_postprocess_pipelines(VulkanContext *vk) {
             .subpass              = 0,
         };
 
-        VkResult result = vkCreateGraphicsPipelines(vk->device, VK_NULL_HANDLE, 1,
+        VkResult result = vkCreateGraphicsPipelines(vk->device, vk->pipeline_cache, 1,
                                                      &pipe_info, NULL, &b->composite_pipeline);
         vkDestroyShaderModule(vk->device, frag_module, NULL);
 
@@ -837,50 +656,73 @@ static EngineResult create_postprocess_pipelines(VulkanContext *vk) {
 }
 
 /* --------------------------------------------------------------------------
- * Size-dependent resource creation (images, framebuffers)
+ * Size-dependent resources (views over the graph's images, framebuffers)
  * ------------------------------------------------------------------------ */
 
-static EngineResult create_size_dependent_resources(VulkanContext *vk) {
+static void destroy_size_dependent_resources(VulkanContext *vk) {
     BloomContext *b = &vk->bloom;
+
+    bloom_cleanup_swapchain_deps(vk);
+
+    for (u32 i = 0; i < BLOOM_MAX_MIPS; i++) {
+        if (b->mip_views[i]) { vkDestroyImageView(vk->device, b->mip_views[i], NULL); b->mip_views[i] = VK_NULL_HANDLE; }
+    }
+    if (b->scene_view) { vkDestroyImageView(vk->device, b->scene_view, NULL); b->scene_view = VK_NULL_HANDLE; }
+}
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * ------------------------------------------------------------------------ */
+
+EngineResult bloom_init(VulkanContext *vk) {
+    BloomContext *b = &vk->bloom;
+    memset(b, 0, sizeof(BloomContext));
+    b->enabled = false;
+    b->render_scale = 1.0f;
+
     EngineResult res;
 
-    u32 w = vk->swapchain_extent.width;
-    u32 h = vk->swapchain_extent.height;
-    b->bloom_extent.width  = ENGINE_MAX(w / 2, 1);
-    b->bloom_extent.height = ENGINE_MAX(h / 2, 1);
+    if ((res = create_render_passes(vk)) != ENGINE_SUCCESS) return res;
+    if ((res = create_descriptors(vk))   != ENGINE_SUCCESS) return res;
+    if ((res = create_linear_sampler(vk, VK_SAMPLER_MIPMAP_MODE_LINEAR,
+                                     &b->scene_sampler)) != ENGINE_SUCCESS) return res;
+    if ((res = create_linear_sampler(vk, VK_SAMPLER_MIPMAP_MODE_NEAREST,
+                                     &b->pyramid_sampler)) != ENGINE_SUCCESS) return res;
 
-    /* Scene image (full-res HDR) */
-    res = create_bloom_image(vk, w, h, BLOOM_HDR_FORMAT,
-                              VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-                              &b->scene_image, &b->scene_memory,
-                              &b->scene_view, &b->scene_sampler);
-    if (res != ENGINE_SUCCESS) return res;
+    RgImageDesc scene_desc, pyramid_desc;
+    describe_targets(vk, &scene_desc, &pyramid_desc);
+    b->scene_target = render_graph_add_image(vk, "bloom_scene", &scene_desc);
+    b->pyramid      = render_graph_add_image(vk, "bloom_pyramid", &pyramid_desc);
 
-    /* Bloom A (half-res) */
-    res = create_bloom_image(vk, b->bloom_extent.width, b->bloom_extent.height,
-                              BLOOM_BLUR_FORMAT,
-                              VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-                              &b->bloom_a_image, &b->bloom_a_memory,
-                              &b->bloom_a_view, &b->bloom_a_sampler);
-    if (res != ENGINE_SUCCESS) return res;
+    LOG_INFO("Bloom post-processing initialized");
+    return ENGINE_SUCCESS;
+}
 
-    /* Bloom B (half-res) */
-    res = create_bloom_image(vk, b->bloom_extent.width, b->bloom_extent.height,
-                              BLOOM_BLUR_FORMAT,
-                              VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-                              &b->bloom_b_image, &b->bloom_b_memory,
-                              &b->bloom_b_view, &b->bloom_b_sampler);
-    if (res != ENGINE_SUCCESS) return res;
+EngineResult bloom_bind_targets(VulkanContext *vk) {
+    BloomContext *b = &vk->bloom;
+    EngineResult res;
 
-    /* Bloom depth buffer */
-    res = create_bloom_depth(vk);
+    u32 w = vk->swapchain_extent.width;
+    u32 h = vk->swapchain_extent.height;
+
+    res = create_mip_view(vk, render_graph_image(vk, b->scene_target), BLOOM_HDR_FORMAT,
+                          0, &b->scene_view);
     if (res != ENGINE_SUCCESS) return res;
 
+    /* Single-level views, so each pass samples exactly its source level and
+     * textureSize() reports that level's extent */
+    for (u32 i = 0; i < b->mip_count; i++) {
+        res = create_mip_view(vk, render_graph_image(vk, b->pyramid), BLOOM_PYRAMID_FORMAT,
+                              i, &b->mip_views[i]);
+        if (res != ENGINE_SUCCESS) return res;
+    }
+
     /* --- Framebuffers --- */
 
-    /* Scene framebuffer (HDR color + depth) */
+    /* Scene framebuffer (HDR color + the swapchain's shared transient depth,
+     * so vk_create_depth_resources must have run first) */
     {
-        VkImageView attachments[] = { b->scene_view, b->depth_view };
+        VkImageView attachments[] = { b->scene_view, vk->depth_image_view };
         VkFramebufferCreateInfo fb_info = {
             .sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
             .renderPass      = b->scene_render_pass,
@@ -894,51 +736,6 @@ static EngineResult create_size_dependent_resources(VulkanContext *vk) {
             return ENGINE_ERROR_VULKAN_INIT;
     }
 
-    /* Extract framebuffer (-> bloom_a, half-res) */
-    {
-        VkFramebufferCreateInfo fb_info = {
-            .sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
-            .renderPass      = b->postprocess_render_pass,
-            .attachmentCount = 1,
-            .pAttachments    = &b->bloom_a_view,
-            .width           = b->bloom_extent.width,
-            .height          = b->bloom_extent.height,
-            .layers          = 1,
-        };
-        if (vkCreateFramebuffer(vk->device, &fb_info, NULL, &b->extract_framebuffer) != VK_SUCCESS)
-            return ENGINE_ERROR_VULKAN_INIT;
-    }
-
-    /* Blur H framebuffer (-> bloom_b, half-res) */
-    {
-        VkFramebufferCreateInfo fb_info = {
-            .sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
-            .renderPass      = b->postprocess_render_pass,
-            .attachmentCount = 1,
-            .pAttachments    = &b->bloom_b_view,
-            .width           = b->bloom_extent.width,
-            .height          = b->bloom_extent.height,
-            .layers          = 1,
-        };
-        if (vkCreateFramebuffer(vk->device, &fb_info, NULL, &b->blur_h_framebuffer) != VK_SUCCESS)
-            return ENGINE_ERROR_VULKAN_INIT;
-    }
-
-    /* Blur V framebuffer (-> bloom_a, half-res) */
-    {
-        VkFramebufferCreateInfo fb_info = {
-            .sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
-            .renderPass      = b->postprocess_render_pass,
-            .attachmentCount = 1,
-            .pAttachments    = &b->bloom_a_view,
-            .width           = b->bloom_extent.width,
-            .height          = b->bloom_extent.height,
-            .layers          = 1,
-        };
-        if (vkCreateFramebuffer(vk->device, &fb_info, NULL, &b->blur_v_framebuffer) != VK_SUCCESS)
-            return ENGINE_ERROR_VULKAN_INIT;
-    }
-
     /* Composite framebuffers (one per swapchain image) */
     b->composite_framebuffers = malloc(sizeof(VkFramebuffer) * vk->swapchain_image_count);
     for (u32 i = 0; i < vk->swapchain_image_count; i++) {
@@ -958,59 +755,11 @@ static EngineResult create_size_dependent_resources(VulkanContext *vk) {
     /* Update descriptor sets with new image views */
     update_descriptor_sets(vk);
 
-    LOG_DEBUG("Bloom size-dependent resources created (%ux%u, bloom %ux%u)",
-              w, h, b->bloom_extent.width, b->bloom_extent.height);
-    return ENGINE_SUCCESS;
-}
-
-static void destroy_size_dependent_resources(VulkanContext *vk) {
-    BloomContext *b = &vk->bloom;
-
-    /* Composite framebuffers */
-    if (b->composite_framebuffers) {
-        for (u32 i = 0; i < vk->swapchain_image_count; i++) {
-            vkDestroyFramebuffer(vk->device, b->composite_framebuffers[i], NULL);
-        }
-        free(b->composite_framebuffers);
-        b->composite_framebuffers = NULL;
-    }
-
-    if (b->blur_v_framebuffer)  { vkDestroyFramebuffer(vk->device, b->blur_v_framebuffer, NULL);  b->blur_v_framebuffer  = VK_NULL_HANDLE; }
-    if (b->blur_h_framebuffer)  { vkDestroyFramebuffer(vk->device, b->blur_h_framebuffer, NULL);  b->blur_h_framebuffer  = VK_NULL_HANDLE; }
-    if (b->extract_framebuffer) { vkDestroyFramebuffer(vk->device, b->extract_framebuffer, NULL); b->extract_framebuffer = VK_NULL_HANDLE; }
-    if (b->scene_framebuffer)   { vkDestroyFramebuffer(vk->device, b->scene_framebuffer, NULL);   b->scene_framebuffer   = VK_NULL_HANDLE; }
-
-    /* Bloom depth */
-    if (b->depth_view)   { vkDestroyImageView(vk->device, b->depth_view, NULL);  b->depth_view = VK_NULL_HANDLE; }
-    if (b->depth_image)  { vkDestroyImage(vk->device, b->depth_image, NULL);     b->depth_image = VK_NULL_HANDLE; }
-    if (b->depth_memory) { vkFreeMemory(vk->device, b->depth_memory, NULL);      b->depth_memory = VK_NULL_HANDLE; }
-
-    /* Images */
-    destroy_bloom_image(vk, &b->bloom_b_image, &b->bloom_b_memory, &b->bloom_b_view, &b->bloom_b_sampler);
-    destroy_bloom_image(vk, &b->bloom_a_image, &b->bloom_a_memory, &b->bloom_a_view, &b->bloom_a_sampler);
-    destroy_bloom_image(vk, &b->scene_image, &b->scene_memory, &b->scene_view, &b->scene_sampler);
-}
-
-/* --------------------------------------------------------------------------
- * Public API
- * ------------------------------------------------------------------------ */
-
-EngineResult bloom_init(VulkanContext *vk) {
-    BloomContext *b = &vk->bloom;
-    memset(b, 0, sizeof(BloomContext));
-    b->enabled = false;
-
-    EngineResult res;
-
-    if ((res = create_render_passes(vk))            != ENGINE_SUCCESS) return res;
-    if ((res = create_descriptors(vk))              != ENGINE_SUCCESS) return res;
-    if ((res = create_postprocess_pipelines(vk))    != ENGINE_SUCCESS) return res;
-    if ((res = vk_create_bloom_scene_pipelines(vk)) != ENGINE_SUCCESS) return res;
-    if ((res = vk_create_bloom_scene_3d_pipeline(vk)) != ENGINE_SUCCESS) return res;
-    if ((res = vk_create_bloom_scene_skinned_3d_pipeline(vk)) != ENGINE_SUCCESS) return res;
-    if ((res = create_size_dependent_resources(vk)) != ENGINE_SUCCESS) return res;
+    /* Same scale at the new size */
+    bloom_set_render_scale(vk, b->render_scale);
 
-    LOG_INFO("Bloom post-processing initialized");
+    LOG_DEBUG("Bloom targets bound (%ux%u, bloom %ux%u, %u mips)",
+              w, h, b->bloom_extent.width, b->bloom_extent.height, b->mip_count);
     return ENGINE_SUCCESS;
 }
 
@@ -1019,15 +768,17 @@ void bloom_shutdown(VulkanContext *vk) {
 
     vkDeviceWaitIdle(vk->device);
 
+    /* The images themselves belong to the render graph */
     destroy_size_dependent_resources(vk);
+    if (b->pyramid_sampler)           vkDestroySampler(vk->device, b->pyramid_sampler, NULL);
+    if (b->scene_sampler)             vkDestroySampler(vk->device, b->scene_sampler, NULL);
 
     /* Pipelines */
     if (b->composite_pipeline)        vkDestroyPipeline(vk->device, b->composite_pipeline, NULL);
     if (b->composite_layout)          vkDestroyPipelineLayout(vk->device, b->composite_layout, NULL);
-    if (b->blur_pipeline)             vkDestroyPipeline(vk->device, b->blur_pipeline, NULL);
-    if (b->blur_layout)               vkDestroyPipelineLayout(vk->device, b->blur_layout, NULL);
-    if (b->extract_pipeline)          vkDestroyPipeline(vk->device, b->extract_pipeline, NULL);
-    if (b->extract_layout)            vkDestroyPipelineLayout(vk->device, b->extract_layout, NULL);
+    if (b->up_pipeline)               vkDestroyPipeline(vk->device, b->up_pipeline, NULL);
+    if (b->down_pipeline)             vkDestroyPipeline(vk->device, b->down_pipeline, NULL);
+    if (b->mip_layout)                vkDestroyPipelineLayout(vk->device, b->mip_layout, NULL);
     if (b->scene_graphics_pipeline)   vkDestroyPipeline(vk->device, b->scene_graphics_pipeline, NULL);
     if (b->scene_text_pipeline)       vkDestroyPipeline(vk->device, b->scene_text_pipeline, NULL);
     if (b->scene_3d_pipeline)         vkDestroyPipeline(vk->device, b->scene_3d_pipeline, NULL);
@@ -1036,11 +787,10 @@ void bloom_shutdown(VulkanContext *vk) {
     /* Descriptors */
     if (b->desc_pool)                 vkDestroyDescriptorPool(vk->device, b->desc_pool, NULL);
     if (b->dual_sampler_layout)       vkDestroyDescriptorSetLayout(vk->device, b->dual_sampler_layout, NULL);
-    if (b->single_sampler_layout)     vkDestroyDescriptorSetLayout(vk->device, b->single_sampler_layout, NULL);
+    if (b->mip_set_layout)            vkDestroyDescriptorSetLayout(vk->device, b->mip_set_layout, NULL);
 
     /* Render passes */
     if (b->composite_render_pass)     vkDestroyRenderPass(vk->device, b->composite_render_pass, NULL);
-    if (b->postprocess_render_pass)   vkDestroyRenderPass(vk->device, b->postprocess_render_pass, NULL);
     if (b->scene_render_pass)         vkDestroyRenderPass(vk->device, b->scene_render_pass, NULL);
 
     memset(b, 0, sizeof(BloomContext));
@@ -1048,8 +798,25 @@ void bloom_shutdown(VulkanContext *vk) {
 }
 
 EngineResult bloom_resize(VulkanContext *vk) {
+    BloomContext *b = &vk->bloom;
+
     destroy_size_dependent_resources(vk);
-    return create_size_dependent_resources(vk);
+
+    RgImageDesc scene_desc, pyramid_desc;
+    describe_targets(vk, &scene_desc, &pyramid_desc);
+    render_graph_set_image_desc(vk, b->scene_target, &scene_desc);
+    render_graph_set_image_desc(vk, b->pyramid, &pyramid_desc);
+    return ENGINE_SUCCESS;
+}
+
+void bloom_set_render_scale(VulkanContext *vk, f32 scale) {
+    BloomContext *b = &vk->bloom;
+
+    b->render_scale = ENGINE_CLAMP(scale, BLOOM_MIN_RENDER_SCALE, 1.0f);
+    b->scene_extent.width  = ENGINE_MAX((u32)((f32)vk->swapchain_extent.width  * b->render_scale), 1);
+    b->scene_extent.height = ENGINE_MAX((u32)((f32)vk->swapchain_extent.height * b->render_scale), 1);
+    b->scene_extent.width  = ENGINE_MIN(b->scene_extent.width,  vk->swapchain_extent.width);
+    b->scene_extent.height = ENGINE_MIN(b->scene_extent.height, vk->swapchain_extent.height);
 }
 
 void bloom_cleanup_swapchain_deps(VulkanContext *vk) {
@@ -1064,148 +831,161 @@ void bloom_cleanup_swapchain_deps(VulkanContext *vk) {
         free(b->composite_framebuffers);
         b->composite_framebuffers = NULL;
     }
+
+    /* The scene framebuffer holds the shared depth view, which goes with them */
+    if (b->scene_framebuffer) {
+        vkDestroyFramebuffer(vk->device, b->scene_framebuffer, NULL);
+        b->scene_framebuffer = VK_NULL_HANDLE;
+    }
 }
 
 /* --------------------------------------------------------------------------
- * Record bloom passes 2-5
+ * Record bloom: downsample, upsample, composite (one render graph pass each)
  * ------------------------------------------------------------------------ */
 
-void bloom_record(VulkanContext *vk, VkCommandBuffer cmd,
-                  const BloomSettings *settings, u32 image_index) {
-    BloomContext *b = &vk->bloom;
-
-    u32 bw = b->bloom_extent.width;
-    u32 bh = b->bloom_extent.height;
-    u32 fw = vk->swapchain_extent.width;
-    u32 fh = vk->swapchain_extent.height;
-
-    /* ---- Pass 2: Brightness extraction (scene -> bloom_a, half-res) ---- */
-    {
-        VkRenderPassBeginInfo rp_info = {
-            .sType       = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-            .renderPass  = b->postprocess_render_pass,
-            .framebuffer = b->extract_framebuffer,
-            .renderArea  = { .offset = {0, 0}, .extent = b->bloom_extent },
-        };
-
-        vkCmdBeginRenderPass(cmd, &rp_info, VK_SUBPASS_CONTENTS_INLINE);
-
-        VkViewport viewport = { 0.0f, 0.0f, (float)bw, (float)bh, 0.0f, 1.0f };
-        VkRect2D scissor = { .offset = {0, 0}, .extent = b->bloom_extent };
-        vkCmdSetViewport(cmd, 0, 1, &viewport);
-        vkCmdSetScissor(cmd, 0, 1, &scissor);
-
-        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, b->extract_pipeline);
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                 b->extract_layout, 0, 1, &b->extract_desc_set, 0, NULL);
-
-        struct { float threshold; float soft_threshold; } extract_push = {
-            settings->threshold, settings->soft_threshold
-        };
-        vkCmdPushConstants(cmd, b->extract_layout, VK_SHADER_STAGE_FRAGMENT_BIT,
-                           0, 8, &extract_push);
+static void dispatch_mip(VkCommandBuffer cmd, VkExtent2D extent) {
+    vkCmdDispatch(cmd, (extent.width  + BLOOM_GROUP_SIZE - 1) / BLOOM_GROUP_SIZE,
+                       (extent.height + BLOOM_GROUP_SIZE - 1) / BLOOM_GROUP_SIZE, 1);
+}
 
-        vkCmdDraw(cmd, 3, 1, 0, 0); /* fullscreen triangle */
+/* Each level reads what the previous one wrote. The render graph orders
+ * the chain against the scene and the composite; these only order it
+ * within itself. */
+static void mip_barrier(VkCommandBuffer cmd) {
+    VkMemoryBarrier barrier = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+    };
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 1, &barrier, 0, NULL, 0, NULL);
+}
 
-        vkCmdEndRenderPass(cmd);
+/* Live extent of each pyramid level at the current render scale */
+static void live_mip_extents(const BloomContext *b, VkExtent2D *out) {
+    u32 w = ENGINE_MAX(b->scene_extent.width / 2, 1);
+    u32 h = ENGINE_MAX(b->scene_extent.height / 2, 1);
+    for (u32 i = 0; i < b->mip_count; i++) {
+        out[i] = (VkExtent2D){ ENGINE_MIN(w, b->mip_extents[i].width),
+                               ENGINE_MIN(h, b->mip_extents[i].height) };
+        w = ENGINE_MAX(w / 2, 1);
+        h = ENGINE_MAX(h / 2, 1);
     }
+}
 
-    /* ---- Pass 3: Horizontal blur (bloom_a -> bloom_b, half-res) ---- */
-    {
-        VkRenderPassBeginInfo rp_info = {
-            .sType       = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-            .renderPass  = b->postprocess_render_pass,
-            .framebuffer = b->blur_h_framebuffer,
-            .renderArea  = { .offset = {0, 0}, .extent = b->bloom_extent },
-        };
-
-        vkCmdBeginRenderPass(cmd, &rp_info, VK_SUBPASS_CONTENTS_INLINE);
-
-        VkViewport viewport = { 0.0f, 0.0f, (float)bw, (float)bh, 0.0f, 1.0f };
-        VkRect2D scissor = { .offset = {0, 0}, .extent = b->bloom_extent };
-        vkCmdSetViewport(cmd, 0, 1, &viewport);
-        vkCmdSetScissor(cmd, 0, 1, &scissor);
-
-        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, b->blur_pipeline);
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                 b->blur_layout, 0, 1, &b->blur_h_desc_set, 0, NULL);
-
-        float direction[2] = { 1.0f / (float)bw, 0.0f };
-        vkCmdPushConstants(cmd, b->blur_layout, VK_SHADER_STAGE_FRAGMENT_BIT,
-                           0, 8, direction);
-
-        vkCmdDraw(cmd, 3, 1, 0, 0);
+void bloom_record_downsample(VulkanContext *vk, VkCommandBuffer cmd,
+                             const BloomSettings *settings) {
+    BloomContext *b = &vk->bloom;
 
-        vkCmdEndRenderPass(cmd);
+    VkExtent2D live[BLOOM_MAX_MIPS];
+    live_mip_extents(b, live);
+
+    /* ---- Downsample chain: scene -> mip 0 (thresholded) -> ... -> mip n-1 ---- */
+    gpu_profiler_pass_begin(vk, cmd, GPU_PASS_BLOOM_DOWN);
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, b->down_pipeline);
+    for (u32 i = 0; i < b->mip_count; i++) {
+        VkExtent2D src = (i == 0) ? b->scene_extent : live[i - 1];
+        BloomMipPush push = {
+            .threshold      = settings->threshold,
+            .soft_threshold = settings->soft_threshold,
+            .prefilter      = (i == 0) ? 1u : 0u,
+            .src_max        = { (i32)src.width - 1, (i32)src.height - 1 },
+            .dst_size       = { (i32)live[i].width, (i32)live[i].height },
+        };
+        if (i > 0) mip_barrier(cmd);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+                                 b->mip_layout, 0, 1, &b->down_desc_sets[i], 0, NULL);
+        vkCmdPushConstants(cmd, b->mip_layout, VK_SHADER_STAGE_COMPUTE_BIT,
+                           0, sizeof(push), &push);
+        dispatch_mip(cmd, live[i]);
     }
+    gpu_profiler_pass_end(vk, cmd, GPU_PASS_BLOOM_DOWN);
+}
 
-    /* ---- Pass 4: Vertical blur (bloom_b -> bloom_a, half-res) ---- */
-    {
-        VkRenderPassBeginInfo rp_info = {
-            .sType       = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-            .renderPass  = b->postprocess_render_pass,
-            .framebuffer = b->blur_v_framebuffer,
-            .renderArea  = { .offset = {0, 0}, .extent = b->bloom_extent },
-        };
-
-        vkCmdBeginRenderPass(cmd, &rp_info, VK_SUBPASS_CONTENTS_INLINE);
-
-        VkViewport viewport = { 0.0f, 0.0f, (float)bw, (float)bh, 0.0f, 1.0f };
-        VkRect2D scissor = { .offset = {0, 0}, .extent = b->bloom_extent };
-        vkCmdSetViewport(cmd, 0, 1, &viewport);
-        vkCmdSetScissor(cmd, 0, 1, &scissor);
+void bloom_record_upsample(VulkanContext *vk, VkCommandBuffer cmd) {
+    BloomContext *b = &vk->bloom;
 
-        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, b->blur_pipeline);
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                 b->blur_layout, 0, 1, &b->blur_v_desc_set, 0, NULL);
+    VkExtent2D live[BLOOM_MAX_MIPS];
+    live_mip_extents(b, live);
+
+    /* ---- Upsample chain: mip n-1 -> ... -> mip 0, accumulating ---- */
+    gpu_profiler_pass_begin(vk, cmd, GPU_PASS_BLOOM_UP);
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, b->up_pipeline);
+    for (u32 i = b->mip_count - 1; i > 0; i--) {
+        BloomMipPush push = {
+            .dst_size   = { (i32)live[i - 1].width, (i32)live[i - 1].height },
+            .src_uv_max = { ((f32)live[i].width  - 0.5f) / (f32)b->mip_extents[i].width,
+                            ((f32)live[i].height - 0.5f) / (f32)b->mip_extents[i].height },
+        };
+        if (i < b->mip_count - 1) mip_barrier(cmd);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+                                 b->mip_layout, 0, 1, &b->up_desc_sets[i], 0, NULL);
+        vkCmdPushConstants(cmd, b->mip_layout, VK_SHADER_STAGE_COMPUTE_BIT,
+                           0, sizeof(push), &push);
+        dispatch_mip(cmd, live[i - 1]);
+    }
+    gpu_profiler_pass_end(vk, cmd, GPU_PASS_BLOOM_UP);
+}
 
-        float direction[2] = { 0.0f, 1.0f / (float)bh };
-        vkCmdPushConstants(cmd, b->blur_layout, VK_SHADER_STAGE_FRAGMENT_BIT,
-                           0, 8, direction);
+void bloom_record_composite(VulkanContext *vk, VkCommandBuffer cmd,
+                            const BloomSettings *settings, u32 image_index) {
+    BloomContext *b = &vk->bloom;
 
-        vkCmdDraw(cmd, 3, 1, 0, 0);
+    u32 fw = vk->swapchain_extent.width;
+    u32 fh = vk->swapchain_extent.height;
 
-        vkCmdEndRenderPass(cmd);
-    }
+    VkExtent2D live[BLOOM_MAX_MIPS];
+    live_mip_extents(b, live);
 
-    /* ---- Pass 5: Composite (scene + bloom_a -> swapchain) ---- */
-    {
-        VkRenderPassBeginInfo rp_info = {
-            .sType       = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-            .renderPass  = b->composite_render_pass,
-            .framebuffer = b->composite_framebuffers[image_index],
-            .renderArea  = { .offset = {0, 0}, .extent = vk->swapchain_extent },
-        };
+    /* ---- Composite (scene + pyramid mip 0 -> swapchain, upscaling) ---- */
+    VkRenderPassBeginInfo rp_info = {
+        .sType       = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+        .renderPass  = b->composite_render_pass,
+        .framebuffer = b->composite_framebuffers[image_index],
+        .renderArea  = { .offset = {0, 0}, .extent = vk->swapchain_extent },
+    };
 
-        vkCmdBeginRenderPass(cmd, &rp_info, VK_SUBPASS_CONTENTS_INLINE);
-
-        VkViewport viewport = { 0.0f, 0.0f, (float)fw, (float)fh, 0.0f, 1.0f };
-        VkRect2D scissor = { .offset = {0, 0}, .extent = vk->swapchain_extent };
-        vkCmdSetViewport(cmd, 0, 1, &viewport);
-        vkCmdSetScissor(cmd, 0, 1, &scissor);
-
-        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, b->composite_pipeline);
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                 b->composite_layout, 0, 1, &b->composite_desc_set, 0, NULL);
-
-        struct {
-            float intensity;
-            float scanline_strength;
-            float scanline_count;
-            float aberration;
-            float screen_size[2];
-        } composite_push = {
-            settings->intensity,
-            settings->scanline_strength,
-            settings->scanline_count,
-            settings->aberration,
-            { (float)fw, (float)fh },
-        };
-        vkCmdPushConstants(cmd, b->composite_layout, VK_SHADER_STAGE_FRAGMENT_BIT,
-                           0, 24, &composite_push);
+    /* Includes any wait for the swapchain image */
+    gpu_profiler_pass_begin(vk, cmd, GPU_PASS_COMPOSITE);
+    vkCmdBeginRenderPass(cmd, &rp_info, VK_SUBPASS_CONTENTS_INLINE);
+
+    VkViewport viewport = { 0.0f, 0.0f, (float)fw, (float)fh, 0.0f, 1.0f };
+    VkRect2D scissor = { .offset = {0, 0}, .extent = vk->swapchain_extent };
+    vkCmdSetViewport(cmd, 0, 1, &viewport);
+    vkCmdSetScissor(cmd, 0, 1, &scissor);
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, b->composite_pipeline);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                             b->composite_layout, 0, 1, &b->composite_desc_set, 0, NULL);
+
+    f32 sw = (f32)b->scene_extent.width, sh = (f32)b->scene_extent.height;
+    struct {
+        float intensity;
+        float scanline_strength;
+        float scanline_count;
+        float aberration;
+        float screen_size[2];
+        float scene_uv_scale[2];   /* live part of the scene target */
+        float scene_uv_max[2];     /* clamp to the last live texel centre */
+        float bloom_uv_max[2];
+    } composite_push = {
+        /* Mip 0 holds the sum of every level, so average it back */
+        settings->intensity / (float)b->mip_count,
+        settings->scanline_strength,
+        settings->scanline_count,
+        settings->aberration,
+        { (float)fw, (float)fh },
+        { sw / (f32)fw, sh / (f32)fh },
+        { (sw - 0.5f) / (f32)fw, (sh - 0.5f) / (f32)fh },
+        { ((f32)live[0].width  - 0.5f) / (f32)b->mip_extents[0].width,
+          ((f32)live[0].height - 0.5f) / (f32)b->mip_extents[0].height },
+    };
+    vkCmdPushConstants(cmd, b->composite_layout, VK_SHADER_STAGE_FRAGMENT_BIT,
+                       0, sizeof(composite_push), &composite_push);
 
-        vkCmdDraw(cmd, 3, 1, 0, 0);
+    vkCmdDraw(cmd, 3, 1, 0, 0);
 
-        vkCmdEndRenderPass(cmd);
-    }
+    vkCmdEndRenderPass(cmd);
+    gpu_profiler_pass_end(vk, cmd, GPU_PASS_COMPOSITE);
 }
@@ -27,26 +27,49 @@ typedef struct {
     .aberration      = 1.5f,     \
 }
 
+/* Lowest scene render scale (per axis) the scene target is drawn at */
+#define BLOOM_MIN_RENDER_SCALE 0.5f
+
 /* ---- Lifecycle (called from renderer.c) ---- */
 
+/* Render passes and descriptors, and declares the scene target and mip
+ * pyramid as render graph images. Pipelines are built separately
+ * (bloom_create_postprocess_pipelines + vk_create_bloom_scene_*), so they can
+ * be compiled in parallel with the rest of the renderer's pipelines. */
 EngineResult bloom_init(VulkanContext *vk);
+EngineResult bloom_create_postprocess_pipelines(VulkanContext *vk);
 void         bloom_shutdown(VulkanContext *vk);
 
-/* Resize — destroy and recreate all size-dependent resources.
- * Called after swapchain recreation. */
+/* Create the views, framebuffers and descriptors over the graph's images.
+ * Called after every render_graph_compile. */
+EngineResult bloom_bind_targets(VulkanContext *vk);
+
+/* Resize — destroy the size-dependent resources and give the graph the new
+ * image sizes. Called after swapchain recreation; bloom_bind_targets follows
+ * the next render_graph_compile. */
 EngineResult bloom_resize(VulkanContext *vk);
 
-/* Destroy only the resources that depend on swapchain image views.
- * Must be called BEFORE vk_cleanup_swapchain(). */
+/* Destroy only the resources that depend on swapchain image views (and the
+ * swapchain's depth view). Must be called BEFORE vk_cleanup_swapchain(). */
 void         bloom_cleanup_swapchain_deps(VulkanContext *vk);
 
-/* Record bloom passes 2-5 (extract, blur H, blur V, composite).
- * Pass 1 (scene to HDR) is handled by the caller in record_command_buffer().
- * NOTE: This declaration requires Vulkan headers — only available when
+/* Scale the scene target (clamped to BLOOM_MIN_RENDER_SCALE..1) and
+ * recompute scene_extent. Takes effect from the next recorded frame, no
+ * resources are recreated. */
+void         bloom_set_render_scale(VulkanContext *vk, f32 scale);
+
+/* Record the bloom post-process, one render graph pass each: the compute
+ * downsample and upsample chains over the HDR scene, then the composite (with
+ * upscale) into the swapchain image. The graph places the barriers between
+ * them; the scene pass itself is recorded by renderer.c.
+ * NOTE: These declarations require Vulkan headers — only available when
  * vk_types.h has been included before bloom.h (i.e. internal engine code). */
 #ifdef VK_VERSION_1_0
-void         bloom_record(VulkanContext *vk, VkCommandBuffer cmd,
-                          const BloomSettings *settings, u32 image_index);
+void         bloom_record_downsample(VulkanContext *vk, VkCommandBuffer cmd,
+                                     const BloomSettings *settings);
+void         bloom_record_upsample(VulkanContext *vk, VkCommandBuffer cmd);
+void         bloom_record_composite(VulkanContext *vk, VkCommandBuffer cmd,
+                                    const BloomSettings *settings, u32 image_index);
 #endif
 
 #endif /* ENGINE_BLOOM_H */
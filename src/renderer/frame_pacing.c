@@ -0,0 +1,59 @@
+#include "renderer/frame_pacing.h"
+#include "platform/thread.h"
+#include "core/profile.h"
+
+/* A present that hasn't completed by then (e.g. the window is hidden and the
+ * compositor stopped flipping) must not hang the game loop */
+#define PRESENT_WAIT_TIMEOUT_NS 100000000ull  /* 100 ms */
+
+void frame_pacing_set_max_fps(VulkanContext *vk, f32 max_fps) {
+    FramePacing *p = &vk->pacing;
+    p->interval_ns = (max_fps > 0.0f) ? (u64)(1e9 / (f64)max_fps) : 0;
+    p->deadline_ns = 0;
+}
+
+void frame_pacing_swapchain_reset(VulkanContext *vk) {
+    vk->pacing.present_id = 0;
+}
+
+void frame_pacing_present(VulkanContext *vk, VkPresentInfoKHR *info, VkPresentIdKHR *id) {
+    FramePacing *p = &vk->pacing;
+    if (!p->present_wait) return;
+
+    p->present_id++;
+    *id = (VkPresentIdKHR){
+        .sType          = VK_STRUCTURE_TYPE_PRESENT_ID_KHR,
+        .pNext          = info->pNext,
+        .swapchainCount = 1,
+        .pPresentIds    = &p->present_id,
+    };
+    info->pNext = id;
+}
+
+void frame_pacing_end_frame(VulkanContext *vk) {
+    FramePacing *p = &vk->pacing;
+
+    /* Keep at most one frame queued behind the display: once the previous
+     * present is on screen, the one just made is next in line */
+    if (p->present_wait && p->present_id > 1) {
+        PROFILE_ZONE_BEGIN("wait_for_present");
+        p->wait_for_present(vk->device, vk->swapchain, p->present_id - 1,
+                            PRESENT_WAIT_TIMEOUT_NS);
+        PROFILE_ZONE_END();
+    }
+
+    if (p->interval_ns == 0) return;
+
+    /* Release frames on a fixed grid; a frame that ran long resets the grid
+     * instead of letting the next ones catch up in a burst */
+    u64 now  = thread_clock_ns();
+    u64 next = p->deadline_ns + p->interval_ns;
+    if (p->deadline_ns == 0 || next < now) {
+        next = now;
+    } else {
+        PROFILE_ZONE_BEGIN("frame_limit_sleep");
+        thread_sleep_until(next);
+        PROFILE_ZONE_END();
+    }
+    p->deadline_ns = next;
+}
@@ -0,0 +1,25 @@
+#ifndef ENGINE_FRAME_PACING_H
+#define ENGINE_FRAME_PACING_H
+
+#include "renderer/vk_types.h"
+#include "core/common.h"
+
+/* ---- Configuration ---- */
+
+/* Frame-rate cap in frames per second; 0 (or less) removes it. */
+void frame_pacing_set_max_fps(VulkanContext *vk, f32 max_fps);
+
+/* Present ids restart with every swapchain. Call after (re)creating it. */
+void frame_pacing_swapchain_reset(VulkanContext *vk);
+
+/* ---- Per frame ---- */
+
+/* Tag this present with the next present id by chaining *id (which must
+ * live until vkQueuePresentKHR returns) into info. No-op without present wait. */
+void frame_pacing_present(VulkanContext *vk, VkPresentInfoKHR *info, VkPresentIdKHR *id);
+
+/* After presenting: wait until the previous frame is on screen (present
+ * wait), then sleep out the rest of the frame-rate cap. */
+void frame_pacing_end_frame(VulkanContext *vk);
+
+#endif /* ENGINE_FRAME_PACING_H */
@@ -0,0 +1,547 @@
+#include "renderer/gpu_particles.h"
+#include "renderer/vk_pipeline.h"
+#include "renderer/resource_table.h"
+#include "renderer/vk_buffer.h"
+#include "renderer/vk_upload.h"
+#include "core/log.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define PARTICLE_LOCAL_SIZE  256   /* must match local_size_x in particles.comp */
+#define PARTICLE_STATE_BYTES 48    /* 12 floats, see particles.comp */
+
+/* Push constants (32 bytes), see particles.comp */
+typedef struct {
+    u32 mode;          /* PARTICLE_MODE_* */
+    u32 capacity;
+    u32 src;           /* half read by simulate */
+    u32 dst;           /* half written */
+    f32 delta_time;
+    u32 burst_first;   /* first burst record of the system in this frame's region */
+    u32 burst_count;
+    u32 spawn_count;
+} ParticlePush;
+
+enum { PARTICLE_MODE_SIMULATE = 0, PARTICLE_MODE_SPAWN = 1 };
+
+/* Burst record as read by particles.comp (16 words) */
+typedef struct {
+    f32 position[2];
+    f32 color[3];
+    u32 count;
+    u32 first;         /* spawn index of the burst's first particle */
+    u32 seed;
+    f32 speed[2];
+    f32 lifetime[2];
+    f32 angular_velocity[2];
+    f32 scale;
+    f32 pad;
+} BurstRecord;
+
+/* --------------------------------------------------------------------------
+ * Helpers
+ * ------------------------------------------------------------------------ */
+
+static bool graphics_queue_has_compute(const VulkanContext *vk) {
+    u32 count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(vk->physical_device, &count, NULL);
+    if (vk->graphics_family >= count) return false;
+
+    VkQueueFamilyProperties *families = malloc(sizeof(VkQueueFamilyProperties) * count);
+    if (!families) return false;
+    vkGetPhysicalDeviceQueueFamilyProperties(vk->physical_device, &count, families);
+    bool ok = (families[vk->graphics_family].queueFlags & VK_QUEUE_COMPUTE_BIT) != 0;
+    free(families);
+    return ok;
+}
+
+static GpuParticleSystem *get_system(VulkanContext *vk, GpuParticlesHandle handle) {
+    if (handle >= GPU_PARTICLES_MAX_SYSTEMS) return NULL;
+    GpuParticleSystem *ps = &vk->gpu_particles.systems[handle];
+    return ps->in_use ? ps : NULL;
+}
+
+static EngineResult create_layouts(VulkanContext *vk) {
+    GpuParticleContext *gp = &vk->gpu_particles;
+
+    VkDescriptorSetLayoutBinding bindings[] = {
+        {   /* Ping-pong particle state */
+            .binding         = 0,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+        },
+        {   /* Indirect draw args, one per half */
+            .binding         = 1,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+        },
+        {   /* InstanceData output */
+            .binding         = 2,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+        },
+        {   /* Burst records, selected per frame by dynamic offset */
+            .binding         = 3,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+            .descriptorCount = 1,
+            .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+        },
+    };
+
+    VkDescriptorSetLayoutCreateInfo set_info = {
+        .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .bindingCount = ENGINE_ARRAY_LEN(bindings),
+        .pBindings    = bindings,
+    };
+    if (vkCreateDescriptorSetLayout(vk->device, &set_info, NULL,
+                                     &gp->desc_set_layout) != VK_SUCCESS) {
+        LOG_FATAL("GPU particles: failed to create descriptor set layout");
+        return ENGINE_ERROR_VULKAN_PIPELINE;
+    }
+
+    VkPushConstantRange push_range = {
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .offset     = 0,
+        .size       = sizeof(ParticlePush),
+    };
+
+    VkPipelineLayoutCreateInfo layout_info = {
+        .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount         = 1,
+        .pSetLayouts            = &gp->desc_set_layout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges    = &push_range,
+    };
+    if (vkCreatePipelineLayout(vk->device, &layout_info, NULL,
+                                &gp->pipeline_layout) != VK_SUCCESS) {
+        LOG_FATAL("GPU particles: failed to create pipeline layout");
+        return ENGINE_ERROR_VULKAN_PIPELINE;
+    }
+
+    return ENGINE_SUCCESS;
+}
+
+static EngineResult create_pipeline(VulkanContext *vk) {
+    GpuParticleContext *gp = &vk->gpu_particles;
+
+    size_t code_size;
+    u8 *code = vk_read_file("shaders/particles.comp.spv", &code_size);
+    if (!code) {
+        LOG_FATAL("GPU particles: failed to load particles.comp.spv");
+        return ENGINE_ERROR_FILE_NOT_FOUND;
+    }
+
+    VkShaderModule module = vk_create_shader_module(vk->device, code, code_size);
+    free(code);
+    if (module == VK_NULL_HANDLE) return ENGINE_ERROR_VULKAN_PIPELINE;
+
+    VkComputePipelineCreateInfo info = {
+        .sType  = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .stage  = {
+            .sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage  = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module = module,
+            .pName  = "main",
+        },
+        .layout = gp->pipeline_layout,
+    };
+
+    VkResult vr = vkCreateComputePipelines(vk->device, vk->pipeline_cache, 1, &info,
+                                           NULL, &gp->pipeline);
+    vkDestroyShaderModule(vk->device, module, NULL);
+    if (vr != VK_SUCCESS) {
+        LOG_FATAL("GPU particles: failed to create pipeline");
+        return ENGINE_ERROR_VULKAN_PIPELINE;
+    }
+
+    return ENGINE_SUCCESS;
+}
+
+static EngineResult create_descriptor_pool(VulkanContext *vk) {
+    GpuParticleContext *gp = &vk->gpu_particles;
+
+    VkDescriptorPoolSize pool_sizes[] = {
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         3 * GPU_PARTICLES_MAX_SYSTEMS },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, GPU_PARTICLES_MAX_SYSTEMS },
+    };
+    VkDescriptorPoolCreateInfo pool_info = {
+        .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .flags         = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,
+        .maxSets       = GPU_PARTICLES_MAX_SYSTEMS,
+        .poolSizeCount = ENGINE_ARRAY_LEN(pool_sizes),
+        .pPoolSizes    = pool_sizes,
+    };
+    if (vkCreateDescriptorPool(vk->device, &pool_info, NULL, &gp->desc_pool) != VK_SUCCESS) {
+        LOG_FATAL("GPU particles: failed to create descriptor pool");
+        return ENGINE_ERROR_VULKAN_INIT;
+    }
+    return ENGINE_SUCCESS;
+}
+
+static EngineResult write_descriptors(VulkanContext *vk, GpuParticleSystem *ps) {
+    GpuParticleContext *gp = &vk->gpu_particles;
+
+    VkDescriptorSetAllocateInfo alloc_info = {
+        .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool     = gp->desc_pool,
+        .descriptorSetCount = 1,
+        .pSetLayouts        = &gp->desc_set_layout,
+    };
+    if (vkAllocateDescriptorSets(vk->device, &alloc_info, &ps->desc_set) != VK_SUCCESS) {
+        ps->desc_set = VK_NULL_HANDLE;
+        LOG_ERROR("GPU particles: failed to allocate descriptor set");
+        return ENGINE_ERROR_VULKAN_INIT;
+    }
+
+    VkDescriptorBufferInfo infos[] = {
+        { .buffer = ps->state,              .offset = 0, .range = VK_WHOLE_SIZE },
+        { .buffer = ps->args,               .offset = 0, .range = VK_WHOLE_SIZE },
+        { .buffer = ps->instances,          .offset = 0, .range = VK_WHOLE_SIZE },
+        { .buffer = gp->burst_ring.buffer,  .offset = 0, .range = gp->burst_ring.frame_size },
+    };
+    VkWriteDescriptorSet writes[ENGINE_ARRAY_LEN(infos)];
+    for (u32 i = 0; i < ENGINE_ARRAY_LEN(infos); i++) {
+        writes[i] = (VkWriteDescriptorSet){
+            .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet          = ps->desc_set,
+            .dstBinding      = i,
+            .descriptorType  = (i == 3) ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC
+                                        : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .pBufferInfo     = &infos[i],
+        };
+    }
+    vkUpdateDescriptorSets(vk->device, ENGINE_ARRAY_LEN(writes), writes, 0, NULL);
+
+    return ENGINE_SUCCESS;
+}
+
+static void release_system(VulkanContext *vk, GpuParticleSystem *ps) {
+    if (ps->desc_set)
+        vkFreeDescriptorSets(vk->device, vk->gpu_particles.desc_pool, 1, &ps->desc_set);
+    vk_destroy_buffer(vk, &ps->state,     &ps->state_memory);
+    vk_destroy_buffer(vk, &ps->instances, &ps->instances_memory);
+    vk_destroy_buffer(vk, &ps->args,      &ps->args_memory);
+    memset(ps, 0, sizeof(*ps));
+}
+
+/* --------------------------------------------------------------------------
+ * Lifecycle
+ * ------------------------------------------------------------------------ */
+
+EngineResult gpu_particles_init(VulkanContext *vk) {
+    GpuParticleContext *gp = &vk->gpu_particles;
+    memset(gp, 0, sizeof(*gp));
+
+    if (!graphics_queue_has_compute(vk)) {
+        LOG_WARN("Graphics queue has no compute support; GPU particles unavailable");
+        return ENGINE_SUCCESS;
+    }
+
+    EngineResult res;
+    if ((res = create_layouts(vk))         != ENGINE_SUCCESS) goto fail;
+    if ((res = create_pipeline(vk))        != ENGINE_SUCCESS) goto fail;
+    if ((res = create_descriptor_pool(vk)) != ENGINE_SUCCESS) goto fail;
+
+    res = vk_create_frame_ring(vk,
+        sizeof(BurstRecord) * GPU_PARTICLES_MAX_SYSTEMS * GPU_PARTICLES_MAX_BURSTS,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, &gp->burst_ring);
+    if (res != ENGINE_SUCCESS) goto fail;
+
+    gp->supported = true;
+    return ENGINE_SUCCESS;
+
+fail:
+    gpu_particles_shutdown(vk);
+    return res;
+}
+
+void gpu_particles_shutdown(VulkanContext *vk) {
+    GpuParticleContext *gp = &vk->gpu_particles;
+
+    for (u32 i = 0; i < GPU_PARTICLES_MAX_SYSTEMS; i++) {
+        if (gp->systems[i].in_use) release_system(vk, &gp->systems[i]);
+    }
+
+    vk_destroy_frame_ring(vk, &gp->burst_ring);
+    if (gp->desc_pool)
+        vkDestroyDescriptorPool(vk->device, gp->desc_pool, NULL);
+    if (gp->pipeline)
+        vkDestroyPipeline(vk->device, gp->pipeline, NULL);
+    if (gp->pipeline_layout)
+        vkDestroyPipelineLayout(vk->device, gp->pipeline_layout, NULL);
+    if (gp->desc_set_layout)
+        vkDestroyDescriptorSetLayout(vk->device, gp->desc_set_layout, NULL);
+
+    memset(gp, 0, sizeof(*gp));
+}
+
+/* --------------------------------------------------------------------------
+ * Systems
+ * ------------------------------------------------------------------------ */
+
+EngineResult gpu_particles_create(VulkanContext *vk, u32 capacity, MeshHandle mesh,
+                                  GpuParticlesHandle *out_handle) {
+    GpuParticleContext *gp = &vk->gpu_particles;
+    *out_handle = GPU_PARTICLES_HANDLE_INVALID;
+
+    if (!gp->supported) {
+        LOG_ERROR("GPU particles are not supported on this device");
+        return ENGINE_ERROR_VULKAN_INIT;
+    }
+    if (capacity == 0 || capacity > GPU_PARTICLES_MAX_CAPACITY) {
+        LOG_ERROR("GPU particle capacity %u out of range (1..%u)",
+                  capacity, GPU_PARTICLES_MAX_CAPACITY);
+        return ENGINE_ERROR_GENERIC;
+    }
+    u32 mesh_slot = mesh_lookup(vk, mesh);
+    if (mesh_slot == HANDLE_SLOT_NONE || vk->meshes[mesh_slot].is_3d) {
+        LOG_ERROR("GPU particles need a 2D mesh (got handle %u)", mesh);
+        return ENGINE_ERROR_GENERIC;
+    }
+
+    u32 slot = 0;
+    while (slot < GPU_PARTICLES_MAX_SYSTEMS && gp->systems[slot].in_use) slot++;
+    if (slot == GPU_PARTICLES_MAX_SYSTEMS) {
+        LOG_ERROR("GPU particle system limit reached (%d)", GPU_PARTICLES_MAX_SYSTEMS);
+        return ENGINE_ERROR_OUT_OF_MEMORY;
+    }
+
+    GpuParticleSystem *ps = &gp->systems[slot];
+    memset(ps, 0, sizeof(*ps));
+    ps->capacity = capacity;
+    ps->mesh     = mesh_slot;
+
+    EngineResult res;
+    res = vk_create_buffer(vk, (VkDeviceSize)PARTICLE_STATE_BYTES * capacity * 2,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &ps->state, &ps->state_memory);
+    if (res != ENGINE_SUCCESS) goto fail;
+
+    res = vk_create_buffer(vk, (VkDeviceSize)sizeof(InstanceData) * capacity * 2,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &ps->instances, &ps->instances_memory);
+    if (res != ENGINE_SUCCESS) goto fail;
+
+    res = vk_create_buffer(vk, sizeof(VkDrawIndirectCommand) * 2,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &ps->args, &ps->args_memory);
+    if (res != ENGINE_SUCCESS) goto fail;
+
+    /* Both halves start empty; the mesh part of the draw never changes */
+    const MeshSlot *m = &vk->meshes[mesh_slot];
+    VkDrawIndirectCommand args[2] = {
+        { m->vertex_count, 0, m->first_vertex, 0 },
+        { m->vertex_count, 0, m->first_vertex, 0 },
+    };
+    res = vk_upload_buffer(vk, ps->args, 0, args, sizeof(args));
+    if (res != ENGINE_SUCCESS) goto fail;
+
+    if ((res = write_descriptors(vk, ps)) != ENGINE_SUCCESS) goto fail;
+
+    ps->in_use  = true;
+    *out_handle = slot;
+    LOG_INFO("GPU particle system %u: %u particles (%llu KB)", slot, capacity,
+             (unsigned long long)(((u64)PARTICLE_STATE_BYTES * 2 + sizeof(InstanceData)) *
+                                  capacity / 1024));
+    return ENGINE_SUCCESS;
+
+fail:
+    release_system(vk, ps);
+    return res;
+}
+
+void gpu_particles_destroy(VulkanContext *vk, GpuParticlesHandle handle) {
+    GpuParticleSystem *ps = get_system(vk, handle);
+    if (!ps) return;
+
+    /* In-flight frames may still simulate or draw it */
+    vkDeviceWaitIdle(vk->device);
+    release_system(vk, ps);
+
+    /* Drop draws of it queued this frame */
+    GpuParticleContext *gp = &vk->gpu_particles;
+    u32 kept = 0;
+    for (u32 i = 0; i < gp->draw_count; i++) {
+        if (gp->draws[i].system != handle) gp->draws[kept++] = gp->draws[i];
+    }
+    gp->draw_count = kept;
+}
+
+/* --------------------------------------------------------------------------
+ * Per frame
+ * ------------------------------------------------------------------------ */
+
+void gpu_particles_begin_frame(VulkanContext *vk) {
+    GpuParticleContext *gp = &vk->gpu_particles;
+    if (!gp->supported) return;
+
+    for (u32 i = 0; i < GPU_PARTICLES_MAX_SYSTEMS; i++) {
+        GpuParticleSystem *ps = &gp->systems[i];
+        ps->src         = ps->dst;
+        ps->burst_count = 0;
+        ps->spawn_count = 0;
+        ps->simulate    = false;
+    }
+    gp->draw_count = 0;
+    gp->active     = false;
+    gp->in_place   = false;
+    gp->seed++;
+
+    vk_frame_ring_begin(&gp->burst_ring, vk->current_frame);
+}
+
+bool gpu_particles_burst(VulkanContext *vk, GpuParticlesHandle handle,
+                         const GpuParticleBurst *burst) {
+    GpuParticleSystem *ps = get_system(vk, handle);
+    if (!ps || ps->burst_count == GPU_PARTICLES_MAX_BURSTS) return false;
+    if (burst->count == 0) return true;
+
+    /* More than a full system's worth would be dropped on the GPU anyway */
+    u32 room = (ps->spawn_count < ps->capacity) ? ps->capacity - ps->spawn_count : 0;
+    if (room == 0) return true;
+
+    GpuParticleBurst *b = &ps->bursts[ps->burst_count++];
+    *b = *burst;
+    if (b->count > room) b->count = room;
+    ps->spawn_count += b->count;
+    return true;
+}
+
+void gpu_particles_simulate(VulkanContext *vk, GpuParticlesHandle handle, f32 delta_time) {
+    GpuParticleSystem *ps = get_system(vk, handle);
+    if (!ps) return;
+    ps->simulate   = true;
+    ps->delta_time = delta_time;
+}
+
+void gpu_particles_draw(VulkanContext *vk, GpuParticlesHandle handle, TextureHandle texture) {
+    GpuParticleContext *gp = &vk->gpu_particles;
+    if (!get_system(vk, handle)) return;
+    if (gp->draw_count == GPU_PARTICLES_MAX_DRAWS) {
+        LOG_WARN("GPU particle draw limit reached (%d)", GPU_PARTICLES_MAX_DRAWS);
+        return;
+    }
+    gp->draws[gp->draw_count++] = (GpuParticleDraw){ handle, texture };
+}
+
+void gpu_particles_prepare(VulkanContext *vk) {
+    GpuParticleContext *gp = &vk->gpu_particles;
+    if (!gp->supported) return;
+
+    BurstRecord *records = (BurstRecord *)(gp->burst_ring.mapped + gp->burst_ring.frame_offset);
+    u32 at = 0;
+
+    for (u32 s = 0; s < GPU_PARTICLES_MAX_SYSTEMS; s++) {
+        GpuParticleSystem *ps = &gp->systems[s];
+        if (!ps->in_use) continue;
+
+        ps->dst         = ps->simulate ? ps->src ^ 1u : ps->src;
+        ps->burst_first = at;
+        if (ps->simulate || ps->spawn_count > 0) gp->active = true;
+        if (!ps->simulate && ps->spawn_count > 0) gp->in_place = true;
+
+        u32 first = 0;
+        for (u32 i = 0; i < ps->burst_count; i++) {
+            const GpuParticleBurst *b = &ps->bursts[i];
+            records[at++] = (BurstRecord){
+                .position         = { b->position[0], b->position[1] },
+                .color            = { b->color[0], b->color[1], b->color[2] },
+                .count            = b->count,
+                .first            = first,
+                .seed             = (gp->seed * 0x9E3779B9u) ^ (s << 24) ^ (i << 16),
+                .speed            = { b->speed_min, b->speed_max },
+                .lifetime         = { b->lifetime_min, b->lifetime_max },
+                .angular_velocity = { b->angular_velocity_min, b->angular_velocity_max },
+                .scale            = b->scale,
+            };
+            first += b->count;
+        }
+    }
+}
+
+void gpu_particles_record(const VulkanContext *vk, VkCommandBuffer cmd) {
+    const GpuParticleContext *gp = &vk->gpu_particles;
+    if (!gp->active) return;
+
+    /* The previous frame's simulate wrote the state read and rewritten here.
+     * Its draws are ordered before this by the render graph (or, on the
+     * async compute queue, by the submit's wait). */
+    VkMemoryBarrier before = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT |
+                         VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+    };
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 1, &before, 0, NULL, 0, NULL);
+
+    /* A simulated system starts its destination half empty */
+    for (u32 s = 0; s < GPU_PARTICLES_MAX_SYSTEMS; s++) {
+        const GpuParticleSystem *ps = &gp->systems[s];
+        if (!ps->in_use || !ps->simulate) continue;
+        const MeshSlot *m = &vk->meshes[ps->mesh];
+        VkDrawIndirectCommand reset = { m->vertex_count, 0, m->first_vertex, 0 };
+        vkCmdUpdateBuffer(cmd, ps->args, sizeof(reset) * ps->dst, sizeof(reset), &reset);
+    }
+
+    VkMemoryBarrier reset_done = {
+        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+    };
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                         1, &reset_done, 0, NULL, 0, NULL);
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, gp->pipeline);
+    u32 ring_offset = (u32)gp->burst_ring.frame_offset;
+
+    /* Simulate every system, then spawn every system: one barrier between the
+     * two phases instead of one per system */
+    for (u32 phase = PARTICLE_MODE_SIMULATE; phase <= PARTICLE_MODE_SPAWN; phase++) {
+        if (phase == PARTICLE_MODE_SPAWN) {
+            VkMemoryBarrier simulated = {
+                .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+                .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+            };
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                                 1, &simulated, 0, NULL, 0, NULL);
+        }
+
+        for (u32 s = 0; s < GPU_PARTICLES_MAX_SYSTEMS; s++) {
+            const GpuParticleSystem *ps = &gp->systems[s];
+            if (!ps->in_use) continue;
+
+            u32 threads = (phase == PARTICLE_MODE_SIMULATE)
+                ? (ps->simulate ? ps->capacity : 0)
+                : ps->spawn_count;
+            if (threads == 0) continue;
+
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, gp->pipeline_layout,
+                                     0, 1, &ps->desc_set, 1, &ring_offset);
+
+            ParticlePush push = {
+                .mode        = phase,
+                .capacity    = ps->capacity,
+                .src         = ps->src,
+                .dst         = ps->dst,
+                .delta_time  = ps->delta_time,
+                .burst_first = ps->burst_first,
+                .burst_count = ps->burst_count,
+                .spawn_count = ps->spawn_count,
+            };
+            vkCmdPushConstants(cmd, gp->pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT,
+                               0, sizeof(push), &push);
+            vkCmdDispatch(cmd, (threads + PARTICLE_LOCAL_SIZE - 1) / PARTICLE_LOCAL_SIZE, 1, 1);
+        }
+    }
+}
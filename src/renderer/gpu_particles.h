@@ -0,0 +1,54 @@
+#ifndef ENGINE_GPU_PARTICLES_H
+#define ENGINE_GPU_PARTICLES_H
+
+#include "renderer/vk_types.h"
+#include "core/common.h"
+
+/* ---- Lifecycle (called from renderer.c) ---- */
+
+/* Pipeline, descriptor pool and burst ring. If the graphics queue family has
+ * no compute support GPU particles are left unsupported and this still
+ * succeeds. */
+EngineResult gpu_particles_init(VulkanContext *vk);
+
+/* Destroys every system still alive. The device must be idle. */
+void         gpu_particles_shutdown(VulkanContext *vk);
+
+/* ---- Systems ---- */
+
+/* Allocate the GPU-local state, instance and draw-args buffers for up to
+ * `capacity` particles drawn with the 2D mesh `mesh`. */
+EngineResult gpu_particles_create(VulkanContext *vk, u32 capacity, MeshHandle mesh,
+                                  GpuParticlesHandle *out_handle);
+
+/* Waits for the device to go idle, then frees the system's buffers. */
+void         gpu_particles_destroy(VulkanContext *vk, GpuParticlesHandle handle);
+
+/* ---- Per frame ---- */
+
+/* Makes last frame's output the source half and clears the queued work.
+ * Call after the frame slot's fence has signaled. */
+void gpu_particles_begin_frame(VulkanContext *vk);
+
+/* Queue a burst for this frame. Returns false when the handle is invalid or
+ * the system already has GPU_PARTICLES_MAX_BURSTS bursts queued. */
+bool gpu_particles_burst(VulkanContext *vk, GpuParticlesHandle handle,
+                         const GpuParticleBurst *burst);
+
+/* Step the system by delta_time this frame (the last call wins) */
+void gpu_particles_simulate(VulkanContext *vk, GpuParticlesHandle handle, f32 delta_time);
+
+/* Queue an indirect draw of the system's live particles */
+void gpu_particles_draw(VulkanContext *vk, GpuParticlesHandle handle, TextureHandle texture);
+
+/* Write this frame's burst records into the burst ring. Call once the frame's
+ * bursts are final, before gpu_particles_record. */
+void gpu_particles_prepare(VulkanContext *vk);
+
+/* Simulate and spawn every system with queued work. Records outside any
+ * render pass, before the scene pass; the render graph (or, on the async
+ * compute queue, the graphics submit's wait) makes the results visible to
+ * vertex input and indirect draws. */
+void gpu_particles_record(const VulkanContext *vk, VkCommandBuffer cmd);
+
+#endif /* ENGINE_GPU_PARTICLES_H */
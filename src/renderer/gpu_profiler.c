@@ -0,0 +1,160 @@
+#include "renderer/gpu_profiler.h"
+#include "core/log.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const char *s_pass_names[GPU_PASS_COUNT] = {
+    [GPU_PASS_SKIN_COMPUTE] = "Skin CS",
+    [GPU_PASS_PARTICLES]    = "Particles CS",
+    [GPU_PASS_LIGHT_CULL]   = "Light bin CS",
+    [GPU_PASS_SHADOW]       = "Shadows",
+    [GPU_PASS_2D]           = "2D",
+    [GPU_PASS_3D]           = "3D",
+    [GPU_PASS_SKINNED]      = "Skinned",
+    [GPU_PASS_TEXT]         = "Text",
+    [GPU_PASS_BLOOM_DOWN]   = "Bloom down",
+    [GPU_PASS_BLOOM_UP]     = "Bloom up",
+    [GPU_PASS_COMPOSITE]    = "Composite",
+};
+
+/* --------------------------------------------------------------------------
+ * Lifecycle
+ * ------------------------------------------------------------------------ */
+
+EngineResult gpu_profiler_init(VulkanContext *vk) {
+    GpuProfiler *gp = &vk->gpu_profiler;
+    memset(gp, 0, sizeof(*gp));
+
+    u32 family_count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(vk->physical_device, &family_count, NULL);
+    VkQueueFamilyProperties *families = malloc(sizeof(VkQueueFamilyProperties) * family_count);
+    u32 valid_bits = 0;
+    if (families) {
+        vkGetPhysicalDeviceQueueFamilyProperties(vk->physical_device, &family_count, families);
+        if (vk->graphics_family < family_count) {
+            valid_bits = families[vk->graphics_family].timestampValidBits;
+        }
+        free(families);
+    }
+
+    if (valid_bits == 0) {
+        LOG_INFO("Graphics queue has no timestamp support; GPU timings disabled");
+        return ENGINE_SUCCESS;
+    }
+
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(vk->physical_device, &props);
+    gp->period_ns = props.limits.timestampPeriod;
+    gp->mask      = (valid_bits >= 64) ? UINT64_MAX : ((1ull << valid_bits) - 1);
+
+    VkQueryPoolCreateInfo pool_info = {
+        .sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .queryType  = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = GPU_QUERIES_PER_FRAME * MAX_FRAMES_IN_FLIGHT,
+    };
+    if (vkCreateQueryPool(vk->device, &pool_info, NULL, &gp->pool) != VK_SUCCESS) {
+        LOG_WARN("Failed to create timestamp query pool; GPU timings disabled");
+        gp->pool = VK_NULL_HANDLE;
+        return ENGINE_SUCCESS;
+    }
+
+    LOG_DEBUG("GPU profiler: %u timestamps per frame, %.2f ns per tick",
+              GPU_QUERIES_PER_FRAME, (double)gp->period_ns);
+    return ENGINE_SUCCESS;
+}
+
+void gpu_profiler_shutdown(VulkanContext *vk) {
+    GpuProfiler *gp = &vk->gpu_profiler;
+    if (gp->pool) vkDestroyQueryPool(vk->device, gp->pool, NULL);
+    gp->pool = VK_NULL_HANDLE;
+}
+
+/* --------------------------------------------------------------------------
+ * Read back
+ * ------------------------------------------------------------------------ */
+
+typedef struct {
+    u64 ticks;
+    u64 available;
+} QueryResult;
+
+static bool span_ms(const GpuProfiler *gp, const QueryResult *q, u32 begin, u32 end,
+                    f32 *out_ms) {
+    if (!q[begin].available || !q[end].available) return false;
+    u64 elapsed = (q[end].ticks - q[begin].ticks) & gp->mask;
+    *out_ms = (f32)((double)elapsed * gp->period_ns * 1e-6);
+    return true;
+}
+
+void gpu_profiler_collect(VulkanContext *vk, u32 frame) {
+    GpuProfiler *gp = &vk->gpu_profiler;
+    if (!gp->pool || !gp->pending[frame]) return;
+    gp->pending[frame] = false;
+
+    /* Unwritten queries stay unavailable and make the call return
+     * VK_NOT_READY; the availability word sorts them out per query */
+    QueryResult q[GPU_QUERIES_PER_FRAME];
+    VkResult vr = vkGetQueryPoolResults(vk->device, gp->pool, frame * GPU_QUERIES_PER_FRAME,
+                                        GPU_QUERIES_PER_FRAME, sizeof(q), q, sizeof(QueryResult),
+                                        VK_QUERY_RESULT_64_BIT |
+                                        VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if (vr != VK_SUCCESS && vr != VK_NOT_READY) return;
+
+    GpuTimings t = {0};
+    if (!span_ms(gp, q, GPU_QUERY_FRAME_BEGIN, GPU_QUERY_FRAME_END, &t.frame_ms)) return;
+    if (!span_ms(gp, q, GPU_QUERY_FRAME_BEGIN, GPU_QUERY_SCENE_END, &t.scene_ms)) {
+        t.scene_ms = t.frame_ms;
+    }
+    for (u32 p = 0; p < GPU_PASS_COUNT; p++) {
+        u32 begin = GPU_QUERY_PASS_FIRST + 2 * p;
+        span_ms(gp, q, begin, begin + 1, &t.pass_ms[p]);
+    }
+    t.frame_number = gp->frame_numbers[frame];
+    t.valid        = true;
+    gp->timings    = t;
+}
+
+/* --------------------------------------------------------------------------
+ * Recording
+ * ------------------------------------------------------------------------ */
+
+static void write_timestamp(const VulkanContext *vk, VkCommandBuffer cmd, u32 query,
+                            VkPipelineStageFlagBits stage) {
+    const GpuProfiler *gp = &vk->gpu_profiler;
+    if (!gp->pool) return;
+    vkCmdWriteTimestamp(cmd, stage, gp->pool, vk->current_frame * GPU_QUERIES_PER_FRAME + query);
+}
+
+void gpu_profiler_frame_begin(VulkanContext *vk, VkCommandBuffer cmd) {
+    GpuProfiler *gp = &vk->gpu_profiler;
+    if (!gp->pool) return;
+
+    vkCmdResetQueryPool(cmd, gp->pool, vk->current_frame * GPU_QUERIES_PER_FRAME,
+                        GPU_QUERIES_PER_FRAME);
+    write_timestamp(vk, cmd, GPU_QUERY_FRAME_BEGIN, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+    gp->pending[vk->current_frame]       = true;
+    gp->frame_numbers[vk->current_frame] = vk->frame_number;
+}
+
+void gpu_profiler_scene_end(const VulkanContext *vk, VkCommandBuffer cmd) {
+    write_timestamp(vk, cmd, GPU_QUERY_SCENE_END, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+}
+
+void gpu_profiler_frame_end(const VulkanContext *vk, VkCommandBuffer cmd) {
+    write_timestamp(vk, cmd, GPU_QUERY_FRAME_END, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+}
+
+void gpu_profiler_pass_begin(const VulkanContext *vk, VkCommandBuffer cmd, GpuPass pass) {
+    write_timestamp(vk, cmd, GPU_QUERY_PASS_FIRST + 2 * (u32)pass,
+                    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+}
+
+void gpu_profiler_pass_end(const VulkanContext *vk, VkCommandBuffer cmd, GpuPass pass) {
+    write_timestamp(vk, cmd, GPU_QUERY_PASS_FIRST + 2 * (u32)pass + 1,
+                    VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+}
+
+const char *gpu_profiler_pass_name(GpuPass pass) {
+    return ((u32)pass < GPU_PASS_COUNT) ? s_pass_names[pass] : "?";
+}
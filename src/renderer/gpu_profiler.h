@@ -0,0 +1,36 @@
+#ifndef ENGINE_GPU_PROFILER_H
+#define ENGINE_GPU_PROFILER_H
+
+#include "renderer/vk_types.h"
+#include "core/common.h"
+
+/* ---- Lifecycle (called from renderer.c) ---- */
+
+/* Query pool for every frame slot. Leaves the profiler disabled (NULL pool)
+ * and still succeeds if the graphics queue has no timestamp support. */
+EngineResult gpu_profiler_init(VulkanContext *vk);
+void         gpu_profiler_shutdown(VulkanContext *vk);
+
+/* Read back `frame`'s timestamps without waiting. Call after the slot's
+ * fence has signaled; queries that weren't written that frame are skipped. */
+void         gpu_profiler_collect(VulkanContext *vk, u32 frame);
+
+/* ---- Recording ---- */
+
+/* Reset the current slot and write its frame-begin timestamp. Must be the
+ * first thing recorded into the primary, outside any render pass. */
+void gpu_profiler_frame_begin(VulkanContext *vk, VkCommandBuffer cmd);
+
+/* Once everything before the point has finished */
+void gpu_profiler_scene_end(const VulkanContext *vk, VkCommandBuffer cmd);
+void gpu_profiler_frame_end(const VulkanContext *vk, VkCommandBuffer cmd);
+
+/* Bracket one pass. Write only, so safe from worker threads recording
+ * secondaries; each pass is written at most once per frame. */
+void gpu_profiler_pass_begin(const VulkanContext *vk, VkCommandBuffer cmd, GpuPass pass);
+void gpu_profiler_pass_end(const VulkanContext *vk, VkCommandBuffer cmd, GpuPass pass);
+
+/* Short display name, e.g. "3D" */
+const char *gpu_profiler_pass_name(GpuPass pass);
+
+#endif /* ENGINE_GPU_PROFILER_H */
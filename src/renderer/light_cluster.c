@@ -0,0 +1,352 @@
+#include "renderer/light_cluster.h"
+#include "renderer/vk_pipeline.h"
+#include "renderer/vk_buffer.h"
+#include "core/log.h"
+
+#include <cglm/util.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LIGHT_CLUSTER_LOCAL_SIZE 64   /* must match local_size_x in light_cluster.comp */
+
+/* Push constants (84 bytes), see light_cluster.comp */
+typedef struct {
+    f32 view[16];
+    f32 near_plane;
+    f32 far_plane;
+    f32 tan_half_fov;
+    f32 aspect;
+    u32 light_count;
+} LightClusterPush;
+
+/* --------------------------------------------------------------------------
+ * Helpers
+ * ------------------------------------------------------------------------ */
+
+static bool graphics_queue_has_compute(const VulkanContext *vk) {
+    u32 count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(vk->physical_device, &count, NULL);
+    if (vk->graphics_family >= count) return false;
+
+    VkQueueFamilyProperties *families = malloc(sizeof(VkQueueFamilyProperties) * count);
+    if (!families) return false;
+    vkGetPhysicalDeviceQueueFamilyProperties(vk->physical_device, &count, families);
+    bool ok = (families[vk->graphics_family].queueFlags & VK_QUEUE_COMPUTE_BIT) != 0;
+    free(families);
+    return ok;
+}
+
+static bool sphere_visible(const f32 planes[6][4], const f32 c[3], f32 radius) {
+    for (u32 i = 0; i < 6; i++) {
+        const f32 *p = planes[i];
+        if (p[0] * c[0] + p[1] * c[1] + p[2] * c[2] + p[3] < -radius) return false;
+    }
+    return true;
+}
+
+static EngineResult create_layouts(VulkanContext *vk) {
+    LightClusterContext *lc = &vk->light_cluster;
+
+    VkDescriptorSetLayoutBinding bindings[] = {
+        {   /* Lights, selected per frame by dynamic offset */
+            .binding         = 0,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+            .descriptorCount = 1,
+            .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+        },
+        {   /* Cluster records, also one region per frame */
+            .binding         = 1,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+            .descriptorCount = 1,
+            .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+        },
+    };
+
+    VkDescriptorSetLayoutCreateInfo set_info = {
+        .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .bindingCount = ENGINE_ARRAY_LEN(bindings),
+        .pBindings    = bindings,
+    };
+    if (vkCreateDescriptorSetLayout(vk->device, &set_info, NULL,
+                                     &lc->desc_set_layout) != VK_SUCCESS) {
+        LOG_FATAL("Light clusters: failed to create descriptor set layout");
+        return ENGINE_ERROR_VULKAN_PIPELINE;
+    }
+
+    VkPushConstantRange push_range = {
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .offset     = 0,
+        .size       = sizeof(LightClusterPush),
+    };
+
+    VkPipelineLayoutCreateInfo layout_info = {
+        .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount         = 1,
+        .pSetLayouts            = &lc->desc_set_layout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges    = &push_range,
+    };
+    if (vkCreatePipelineLayout(vk->device, &layout_info, NULL,
+                                &lc->pipeline_layout) != VK_SUCCESS) {
+        LOG_FATAL("Light clusters: failed to create pipeline layout");
+        return ENGINE_ERROR_VULKAN_PIPELINE;
+    }
+
+    return ENGINE_SUCCESS;
+}
+
+static EngineResult create_pipeline(VulkanContext *vk) {
+    LightClusterContext *lc = &vk->light_cluster;
+
+    size_t code_size;
+    u8 *code = vk_read_file("shaders/light_cluster.comp.spv", &code_size);
+    if (!code) {
+        LOG_FATAL("Light clusters: failed to load light_cluster.comp.spv");
+        return ENGINE_ERROR_FILE_NOT_FOUND;
+    }
+
+    VkShaderModule module = vk_create_shader_module(vk->device, code, code_size);
+    free(code);
+    if (module == VK_NULL_HANDLE) return ENGINE_ERROR_VULKAN_PIPELINE;
+
+    VkComputePipelineCreateInfo info = {
+        .sType  = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .stage  = {
+            .sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage  = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module = module,
+            .pName  = "main",
+        },
+        .layout = lc->pipeline_layout,
+    };
+
+    VkResult vr = vkCreateComputePipelines(vk->device, vk->pipeline_cache, 1, &info,
+                                           NULL, &lc->pipeline);
+    vkDestroyShaderModule(vk->device, module, NULL);
+    if (vr != VK_SUCCESS) {
+        LOG_FATAL("Light clusters: failed to create pipeline");
+        return ENGINE_ERROR_VULKAN_PIPELINE;
+    }
+
+    return ENGINE_SUCCESS;
+}
+
+static EngineResult create_descriptors(VulkanContext *vk) {
+    LightClusterContext *lc = &vk->light_cluster;
+
+    VkDescriptorPoolSize pool_sizes[] = {
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 2 },
+    };
+    VkDescriptorPoolCreateInfo pool_info = {
+        .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .maxSets       = 1,
+        .poolSizeCount = ENGINE_ARRAY_LEN(pool_sizes),
+        .pPoolSizes    = pool_sizes,
+    };
+    if (vkCreateDescriptorPool(vk->device, &pool_info, NULL, &lc->desc_pool) != VK_SUCCESS) {
+        LOG_FATAL("Light clusters: failed to create descriptor pool");
+        return ENGINE_ERROR_VULKAN_INIT;
+    }
+
+    VkDescriptorSetAllocateInfo alloc_info = {
+        .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool     = lc->desc_pool,
+        .descriptorSetCount = 1,
+        .pSetLayouts        = &lc->desc_set_layout,
+    };
+    if (vkAllocateDescriptorSets(vk->device, &alloc_info, &lc->desc_set) != VK_SUCCESS) {
+        LOG_FATAL("Light clusters: failed to allocate descriptor set");
+        return ENGINE_ERROR_VULKAN_INIT;
+    }
+
+    VkDescriptorBufferInfo infos[] = {
+        { .buffer = lc->light_ring.buffer, .offset = 0, .range = lc->light_ring.frame_size },
+        { .buffer = lc->clusters,          .offset = 0, .range = lc->cluster_frame_size },
+    };
+    VkWriteDescriptorSet writes[ENGINE_ARRAY_LEN(infos)];
+    for (u32 i = 0; i < ENGINE_ARRAY_LEN(infos); i++) {
+        writes[i] = (VkWriteDescriptorSet){
+            .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet          = lc->desc_set,
+            .dstBinding      = i,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+            .descriptorCount = 1,
+            .pBufferInfo     = &infos[i],
+        };
+    }
+    vkUpdateDescriptorSets(vk->device, ENGINE_ARRAY_LEN(writes), writes, 0, NULL);
+
+    return ENGINE_SUCCESS;
+}
+
+/* --------------------------------------------------------------------------
+ * Lifecycle
+ * ------------------------------------------------------------------------ */
+
+EngineResult light_cluster_init(VulkanContext *vk) {
+    LightClusterContext *lc = &vk->light_cluster;
+    memset(lc, 0, sizeof(*lc));
+    lc->camera_frame = UINT64_MAX;
+
+    EngineResult res = vk_create_frame_ring(vk, sizeof(GpuLight) * RENDERER_MAX_LIGHTS,
+                                            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, &lc->light_ring);
+    if (res != ENGINE_SUCCESS) goto fail;
+
+    /* A region per frame slot, so binning a frame never waits for the
+     * previous one's fragments to stop reading */
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(vk->physical_device, &props);
+    VkDeviceSize align = props.limits.minStorageBufferOffsetAlignment;
+    if (align == 0) align = 1;
+
+    VkDeviceSize cluster_bytes = sizeof(u32) * LIGHT_CLUSTER_COUNT * (1 + LIGHT_CLUSTER_MAX_LIGHTS);
+    lc->cluster_frame_size = (cluster_bytes + align - 1) / align * align;
+    res = vk_create_buffer(vk, lc->cluster_frame_size * vk->frames_in_flight,
+                           VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                           &lc->clusters, &lc->clusters_memory);
+    if (res != ENGINE_SUCCESS) goto fail;
+
+    if (!graphics_queue_has_compute(vk)) {
+        LOG_WARN("Graphics queue has no compute support; point and spot lights unavailable");
+        return ENGINE_SUCCESS;
+    }
+
+    if ((res = create_layouts(vk))     != ENGINE_SUCCESS) goto fail;
+    if ((res = create_pipeline(vk))    != ENGINE_SUCCESS) goto fail;
+    if ((res = create_descriptors(vk)) != ENGINE_SUCCESS) goto fail;
+
+    lc->supported = true;
+    LOG_INFO("Light clusters: %ux%ux%u grid, %u lights per frame (%llu KB of clusters each)",
+             LIGHT_CLUSTER_X, LIGHT_CLUSTER_Y, LIGHT_CLUSTER_Z, RENDERER_MAX_LIGHTS,
+             (unsigned long long)(cluster_bytes / 1024));
+    return ENGINE_SUCCESS;
+
+fail:
+    light_cluster_shutdown(vk);
+    return res;
+}
+
+void light_cluster_shutdown(VulkanContext *vk) {
+    LightClusterContext *lc = &vk->light_cluster;
+
+    vk_destroy_frame_ring(vk, &lc->light_ring);
+    vk_destroy_buffer(vk, &lc->clusters, &lc->clusters_memory);
+    if (lc->desc_pool)
+        vkDestroyDescriptorPool(vk->device, lc->desc_pool, NULL);
+    if (lc->pipeline)
+        vkDestroyPipeline(vk->device, lc->pipeline, NULL);
+    if (lc->pipeline_layout)
+        vkDestroyPipelineLayout(vk->device, lc->pipeline_layout, NULL);
+    if (lc->desc_set_layout)
+        vkDestroyDescriptorSetLayout(vk->device, lc->desc_set_layout, NULL);
+
+    memset(lc, 0, sizeof(*lc));
+}
+
+/* --------------------------------------------------------------------------
+ * Per frame
+ * ------------------------------------------------------------------------ */
+
+void light_cluster_begin_frame(VulkanContext *vk) {
+    LightClusterContext *lc = &vk->light_cluster;
+    lc->count = 0;
+    vk_frame_ring_begin(&lc->light_ring, vk->current_frame);
+}
+
+void light_cluster_set_camera(VulkanContext *vk, const f32 view[16], const f32 vp[16],
+                              const Camera3D *camera, f32 aspect) {
+    LightClusterContext *lc = &vk->light_cluster;
+    memcpy(lc->view, view, sizeof(lc->view));
+    memcpy(lc->vp,   vp,   sizeof(lc->vp));
+    lc->near_plane   = camera->near_plane;
+    lc->far_plane    = camera->far_plane;
+    lc->tan_half_fov = tanf(camera->fov * ((f32)GLM_PI / 180.0f) * 0.5f);
+    lc->aspect       = aspect;
+    lc->camera_frame = vk->frame_number;
+}
+
+void light_cluster_draw(VulkanContext *vk, const PointLight *lights, u32 count) {
+    LightClusterContext *lc = &vk->light_cluster;
+    if (!lc->supported) return;
+
+    GpuLight *out = (GpuLight *)(lc->light_ring.mapped + lc->light_ring.frame_offset);
+    for (u32 i = 0; i < count; i++) {
+        const PointLight *l = &lights[i];
+        if (l->radius <= 0.0f) continue;
+        if (vk->frustum_valid && !sphere_visible(vk->frustum_planes, l->position, l->radius))
+            continue;
+
+        if (lc->count == RENDERER_MAX_LIGHTS) {
+            if (!lc->overflow_warned) {
+                LOG_WARN("More than %d lights in a frame; the rest are dropped",
+                         RENDERER_MAX_LIGHTS);
+                lc->overflow_warned = true;
+            }
+            return;
+        }
+
+        GpuLight *g = &out[lc->count++];
+        memcpy(g->position, l->position, sizeof(g->position));
+        g->radius = l->radius;
+        for (u32 k = 0; k < 3; k++) g->color[k] = l->color[k] * l->intensity;
+
+        /* Linear fade between the cone angles' cosines; a point light gets
+         * a constant 1 */
+        if (l->spot_outer > 0.0f) {
+            f32 cos_outer = cosf(l->spot_outer);
+            f32 cos_inner = cosf(fminf(l->spot_inner, l->spot_outer));
+            f32 scale = 1.0f / fmaxf(cos_inner - cos_outer, 1e-4f);
+            memcpy(g->direction, l->direction, sizeof(g->direction));
+            g->spot_scale  = scale;
+            g->spot_offset = -cos_outer * scale;
+        } else {
+            memset(g->direction, 0, sizeof(g->direction));
+            g->spot_scale  = 0.0f;
+            g->spot_offset = 1.0f;
+        }
+    }
+}
+
+bool light_cluster_active(const VulkanContext *vk) {
+    const LightClusterContext *lc = &vk->light_cluster;
+    return lc->supported && lc->count > 0 && lc->camera_frame == vk->frame_number;
+}
+
+void light_cluster_write_uniforms(const VulkanContext *vk, LightUniforms *out) {
+    const LightClusterContext *lc = &vk->light_cluster;
+    if (!light_cluster_active(vk)) return;
+
+    memcpy(out->cluster_vp, lc->vp, sizeof(out->cluster_vp));
+    out->cluster_params[0] = lc->near_plane;
+    out->cluster_params[1] = (f32)LIGHT_CLUSTER_Z / logf(lc->far_plane / lc->near_plane);
+    out->cluster_params[2] = 1.0f;
+}
+
+void light_cluster_record(const VulkanContext *vk, VkCommandBuffer cmd) {
+    const LightClusterContext *lc = &vk->light_cluster;
+    if (!light_cluster_active(vk)) return;
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, lc->pipeline);
+    u32 dynamic_offsets[] = {
+        (u32)lc->light_ring.frame_offset,
+        (u32)(lc->cluster_frame_size * vk->current_frame),
+    };
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, lc->pipeline_layout,
+                             0, 1, &lc->desc_set, 2, dynamic_offsets);
+
+    LightClusterPush push = {
+        .near_plane   = lc->near_plane,
+        .far_plane    = lc->far_plane,
+        .tan_half_fov = lc->tan_half_fov,
+        .aspect       = lc->aspect,
+        .light_count  = lc->count,
+    };
+    memcpy(push.view, lc->view, sizeof(push.view));
+    vkCmdPushConstants(cmd, lc->pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT,
+                       0, sizeof(push), &push);
+    vkCmdDispatch(cmd, (LIGHT_CLUSTER_COUNT + LIGHT_CLUSTER_LOCAL_SIZE - 1) /
+                       LIGHT_CLUSTER_LOCAL_SIZE, 1, 1);
+}
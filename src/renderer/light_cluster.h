@@ -0,0 +1,40 @@
+#ifndef ENGINE_LIGHT_CLUSTER_H
+#define ENGINE_LIGHT_CLUSTER_H
+
+#include "renderer/vk_types.h"
+#include "core/common.h"
+
+/* ---- Lifecycle (called from renderer.c) ---- */
+
+/* Light ring, cluster buffer and the binning pipeline. The buffers are
+ * always created since set 1 points at them; if the graphics queue family
+ * has no compute support lights are ignored and this still succeeds. */
+EngineResult light_cluster_init(VulkanContext *vk);
+void         light_cluster_shutdown(VulkanContext *vk);
+
+/* ---- Per frame ---- */
+
+/* Clears the queued lights. Call after the frame slot's fence has signaled. */
+void light_cluster_begin_frame(VulkanContext *vk);
+
+/* Remember the 3D camera the grid is binned in: its view and view-projection
+ * matrices (Vulkan Y flip included) and perspective parameters */
+void light_cluster_set_camera(VulkanContext *vk, const f32 view[16], const f32 vp[16],
+                              const Camera3D *camera, f32 aspect);
+
+/* Queue lights for this frame. Lights outside the 3D camera's frustum are
+ * dropped, as are any beyond RENDERER_MAX_LIGHTS. */
+void light_cluster_draw(VulkanContext *vk, const PointLight *lights, u32 count);
+
+/* Lights are queued and the camera belongs to this frame */
+bool light_cluster_active(const VulkanContext *vk);
+
+/* Fill the cluster fields of this frame's light uniforms */
+void light_cluster_write_uniforms(const VulkanContext *vk, LightUniforms *out);
+
+/* Bin this frame's lights. Records outside any render pass, before the scene
+ * pass; the render graph (or, on the async compute queue, the graphics
+ * submit's wait) makes the clusters visible to fragment shaders. */
+void light_cluster_record(const VulkanContext *vk, VkCommandBuffer cmd);
+
+#endif /* ENGINE_LIGHT_CLUSTER_H */
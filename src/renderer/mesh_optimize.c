@@ -0,0 +1,593 @@
+#include "renderer/mesh_optimize.h"
+#include "core/log.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* FIFO size used for the ACMR statistics (typical of current hardware) */
+#define ACMR_CACHE_SIZE     16
+
+/* Modelled LRU cache for triangle ordering (Forsyth, "Linear-Speed Vertex
+ * Cache Optimisation") */
+#define VCACHE_SIZE         32
+#define VCACHE_MAX_VALENCE  32   /* score table size; higher valences clamp */
+
+/* Every pass indexes per-vertex arrays with the index values, so an index
+ * stream from a malformed file must be checked first */
+static bool indices_in_range(const u32 *indices, u32 index_count, u32 vertex_count) {
+    for (u32 i = 0; i < index_count; i++) {
+        if (indices[i] >= vertex_count) return false;
+    }
+    return true;
+}
+
+/* ==========================================================================
+ * ACMR
+ * ========================================================================== */
+
+f32 mesh_optimize_acmr(const u32 *indices, u32 index_count, u32 vertex_count,
+                       u32 cache_size) {
+    if (index_count < 3 || vertex_count == 0) return 0.0f;
+    if (!indices_in_range(indices, index_count, vertex_count)) return 0.0f;
+
+    /* Timestamp per vertex: cached while it was inserted < cache_size misses ago */
+    u32 *stamp = calloc(vertex_count, sizeof(u32));
+    if (!stamp) return 0.0f;
+
+    u32 misses = 0;
+    for (u32 i = 0; i < index_count; i++) {
+        u32 v = indices[i];
+        if (stamp[v] == 0 || misses + 1 - stamp[v] > cache_size) {
+            misses++;
+            stamp[v] = misses;
+        }
+    }
+
+    free(stamp);
+    return (f32)misses / (f32)(index_count / 3);
+}
+
+/* ==========================================================================
+ * 1. Vertex deduplication
+ * ========================================================================== */
+
+static u32 hash_bytes(const u8 *p, size_t n) {
+    u32 h = 2166136261u;   /* FNV-1a */
+    for (size_t i = 0; i < n; i++) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static EngineResult dedup_vertices(u8 *vertices, size_t stride, u32 *vertex_count,
+                                   u32 *indices, u32 index_count) {
+    u32 count = *vertex_count;
+    u32 cap = 1;
+    while (cap < count * 2) cap <<= 1;
+
+    u32 *table = malloc(sizeof(u32) * cap);
+    u32 *remap = malloc(sizeof(u32) * count);
+    if (!table || !remap) {
+        free(table);
+        free(remap);
+        return ENGINE_ERROR_OUT_OF_MEMORY;
+    }
+    memset(table, 0xFF, sizeof(u32) * cap);
+
+    /* Unique vertices are compacted towards the front as they are found */
+    u32 unique = 0;
+    for (u32 v = 0; v < count; v++) {
+        const u8 *src = vertices + (size_t)v * stride;
+        u32 slot = hash_bytes(src, stride) & (cap - 1);
+        for (;;) {
+            u32 u = table[slot];
+            if (u == 0xFFFFFFFFu) {
+                if (unique != v) memcpy(vertices + (size_t)unique * stride, src, stride);
+                table[slot] = unique;
+                remap[v] = unique++;
+                break;
+            }
+            if (memcmp(vertices + (size_t)u * stride, src, stride) == 0) {
+                remap[v] = u;
+                break;
+            }
+            slot = (slot + 1) & (cap - 1);
+        }
+    }
+
+    for (u32 i = 0; i < index_count; i++) {
+        indices[i] = remap[indices[i]];
+    }
+    *vertex_count = unique;
+
+    free(table);
+    free(remap);
+    return ENGINE_SUCCESS;
+}
+
+/* ==========================================================================
+ * 2. Vertex cache ordering (Forsyth)
+ * ========================================================================== */
+
+static f32 score_cache[VCACHE_SIZE];
+static f32 score_valence[VCACHE_MAX_VALENCE + 1];
+static bool score_tables_ready;
+
+static void init_score_tables(void) {
+    if (score_tables_ready) return;
+    for (u32 i = 0; i < VCACHE_SIZE; i++) {
+        /* The last triangle's vertices get a fixed score so the next triangle
+         * doesn't simply reuse the same edge */
+        score_cache[i] = (i < 3) ? 0.75f
+                       : powf(1.0f - (f32)(i - 3) / (f32)(VCACHE_SIZE - 3), 1.5f);
+    }
+    score_valence[0] = 0.0f;
+    for (u32 i = 1; i <= VCACHE_MAX_VALENCE; i++) {
+        /* Favour vertices with few triangles left so they don't get stranded */
+        score_valence[i] = 2.0f * powf((f32)i, -0.5f);
+    }
+    score_tables_ready = true;
+}
+
+static inline f32 vertex_score(i32 cache_pos, u32 valence) {
+    if (valence == 0) return -1.0f;
+    f32 s = (cache_pos >= 0) ? score_cache[cache_pos] : 0.0f;
+    return s + score_valence[ENGINE_MIN(valence, (u32)VCACHE_MAX_VALENCE)];
+}
+
+static EngineResult optimize_vertex_cache(u32 *indices, u32 index_count, u32 vertex_count) {
+    u32 tri_count = index_count / 3;
+    init_score_tables();
+
+    u32  *valence    = calloc(vertex_count, sizeof(u32));   /* live triangles per vertex */
+    u32  *adj_offset = malloc(sizeof(u32) * (vertex_count + 1));
+    u32  *adj        = malloc(sizeof(u32) * index_count);
+    i32  *cache_pos  = malloc(sizeof(i32) * vertex_count);
+    f32  *vscore     = malloc(sizeof(f32) * vertex_count);
+    f32  *tscore     = malloc(sizeof(f32) * tri_count);
+    bool *emitted    = calloc(tri_count, sizeof(bool));
+    u32  *out        = malloc(sizeof(u32) * index_count);
+    if (!valence || !adj_offset || !adj || !cache_pos || !vscore || !tscore ||
+        !emitted || !out) {
+        free(valence); free(adj_offset); free(adj); free(cache_pos);
+        free(vscore); free(tscore); free(emitted); free(out);
+        return ENGINE_ERROR_OUT_OF_MEMORY;
+    }
+
+    /* Vertex -> triangle adjacency (CSR) */
+    for (u32 i = 0; i < index_count; i++) valence[indices[i]]++;
+    adj_offset[0] = 0;
+    for (u32 v = 0; v < vertex_count; v++) adj_offset[v + 1] = adj_offset[v] + valence[v];
+    memset(valence, 0, sizeof(u32) * vertex_count);
+    for (u32 t = 0; t < tri_count; t++) {
+        for (u32 k = 0; k < 3; k++) {
+            u32 v = indices[t * 3 + k];
+            adj[adj_offset[v] + valence[v]++] = t;
+        }
+    }
+
+    for (u32 v = 0; v < vertex_count; v++) {
+        cache_pos[v] = -1;
+        vscore[v] = vertex_score(-1, valence[v]);
+    }
+
+    u32 best = 0;
+    f32 best_score = -1.0f;
+    for (u32 t = 0; t < tri_count; t++) {
+        const u32 *tri = &indices[t * 3];
+        tscore[t] = vscore[tri[0]] + vscore[tri[1]] + vscore[tri[2]];
+        if (tscore[t] > best_score) { best_score = tscore[t]; best = t; }
+    }
+
+    u32 cache[VCACHE_SIZE + 3];
+    u32 cache_count = 0;
+    u32 scan = 0;   /* fallback cursor: every triangle before it is emitted */
+
+    for (u32 n = 0; n < tri_count; n++) {
+        /* Dead end: nothing in the cache has triangles left */
+        if (best_score < 0.0f) {
+            while (emitted[scan]) scan++;
+            best = scan;
+        }
+
+        const u32 *tri = &indices[best * 3];
+        memcpy(&out[n * 3], tri, sizeof(u32) * 3);
+        emitted[best] = true;
+
+        /* Drop the triangle from its vertices' live adjacency */
+        for (u32 k = 0; k < 3; k++) {
+            u32 v = tri[k];
+            u32 *list = &adj[adj_offset[v]];
+            for (u32 a = 0; a < valence[v]; a++) {
+                if (list[a] == best) {
+                    list[a] = list[--valence[v]];
+                    break;
+                }
+            }
+        }
+
+        /* LRU update: the triangle's vertices move to the front */
+        u32 next[VCACHE_SIZE + 3];
+        u32 next_count = 0;
+        for (u32 k = 0; k < 3; k++) next[next_count++] = tri[k];
+        for (u32 c = 0; c < cache_count; c++) {
+            u32 v = cache[c];
+            if (v != tri[0] && v != tri[1] && v != tri[2]) next[next_count++] = v;
+        }
+
+        /* Rescore everything that was or is in the cache, and their triangles */
+        best_score = -1.0f;
+        for (u32 c = 0; c < next_count; c++) {
+            u32 v = next[c];
+            cache_pos[v] = (c < VCACHE_SIZE) ? (i32)c : -1;
+            vscore[v] = vertex_score(cache_pos[v], valence[v]);
+        }
+        for (u32 c = 0; c < next_count; c++) {
+            u32 v = next[c];
+            const u32 *list = &adj[adj_offset[v]];
+            for (u32 a = 0; a < valence[v]; a++) {
+                u32 t = list[a];
+                const u32 *tv = &indices[t * 3];
+                tscore[t] = vscore[tv[0]] + vscore[tv[1]] + vscore[tv[2]];
+                if (c < VCACHE_SIZE && tscore[t] > best_score) {
+                    best_score = tscore[t];
+                    best = t;
+                }
+            }
+        }
+
+        cache_count = ENGINE_MIN(next_count, (u32)VCACHE_SIZE);
+        memcpy(cache, next, sizeof(u32) * cache_count);
+    }
+
+    memcpy(indices, out, sizeof(u32) * index_count);
+
+    free(valence); free(adj_offset); free(adj); free(cache_pos);
+    free(vscore); free(tscore); free(emitted); free(out);
+    return ENGINE_SUCCESS;
+}
+
+/* ==========================================================================
+ * 3. Overdraw: order cache-coherent clusters outside-in
+ *
+ * The cache-ordered stream is cut wherever a triangle misses on all three
+ * vertices (the optimizer had to jump), so reordering whole clusters costs
+ * almost nothing in ACMR. Clusters facing away from the mesh centre are drawn
+ * first: from most viewpoints they occlude the inner ones.
+ * ========================================================================== */
+
+typedef struct {
+    u32 first_tri;
+    u32 tri_count;
+    f32 sort_key;
+} MeshCluster;
+
+static int cluster_cmp(const void *a, const void *b) {
+    f32 ka = ((const MeshCluster *)a)->sort_key;
+    f32 kb = ((const MeshCluster *)b)->sort_key;
+    return (ka < kb) - (ka > kb);   /* descending */
+}
+
+static inline const f32 *vertex_position(const u8 *vertices, size_t stride,
+                                         size_t position_offset, u32 v) {
+    return (const f32 *)(vertices + (size_t)v * stride + position_offset);
+}
+
+static EngineResult optimize_overdraw(const u8 *vertices, size_t stride, size_t position_offset,
+                                      u32 vertex_count, u32 *indices, u32 index_count,
+                                      u32 *out_cluster_count) {
+    u32 tri_count = index_count / 3;
+    *out_cluster_count = 1;
+
+    MeshCluster *clusters = malloc(sizeof(MeshCluster) * tri_count);
+    u32         *stamp    = calloc(vertex_count, sizeof(u32));
+    u32         *out      = malloc(sizeof(u32) * index_count);
+    if (!clusters || !stamp || !out) {
+        free(clusters); free(stamp); free(out);
+        return ENGINE_ERROR_OUT_OF_MEMORY;
+    }
+
+    /* Split at hard cache boundaries (same FIFO model as the ACMR stat) */
+    u32 cluster_count = 0;
+    u32 misses = 0;
+    for (u32 t = 0; t < tri_count; t++) {
+        u32 tri_misses = 0;
+        for (u32 k = 0; k < 3; k++) {
+            u32 v = indices[t * 3 + k];
+            if (stamp[v] == 0 || misses + 1 - stamp[v] > ACMR_CACHE_SIZE) {
+                stamp[v] = ++misses;
+                tri_misses++;
+            }
+        }
+        if (t == 0 || tri_misses == 3) {
+            clusters[cluster_count].first_tri = t;
+            clusters[cluster_count].tri_count = 0;
+            cluster_count++;
+        }
+        clusters[cluster_count - 1].tri_count++;
+    }
+
+    /* Mesh centroid (vertex average — only a reference point) */
+    f32 mesh_c[3] = {0};
+    for (u32 v = 0; v < vertex_count; v++) {
+        const f32 *p = vertex_position(vertices, stride, position_offset, v);
+        for (u32 k = 0; k < 3; k++) mesh_c[k] += p[k];
+    }
+    for (u32 k = 0; k < 3; k++) mesh_c[k] /= (f32)vertex_count;
+
+    /* Key: area-weighted centroid offset along the cluster's average normal */
+    for (u32 c = 0; c < cluster_count; c++) {
+        MeshCluster *cl = &clusters[c];
+        f32 centroid[3] = {0}, normal[3] = {0};
+        f32 area_sum = 0.0f;
+
+        for (u32 t = cl->first_tri; t < cl->first_tri + cl->tri_count; t++) {
+            const f32 *p0 = vertex_position(vertices, stride, position_offset, indices[t * 3 + 0]);
+            const f32 *p1 = vertex_position(vertices, stride, position_offset, indices[t * 3 + 1]);
+            const f32 *p2 = vertex_position(vertices, stride, position_offset, indices[t * 3 + 2]);
+
+            f32 e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+            f32 e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+            f32 n[3]  = { e1[1] * e2[2] - e1[2] * e2[1],
+                          e1[2] * e2[0] - e1[0] * e2[2],
+                          e1[0] * e2[1] - e1[1] * e2[0] };
+            f32 area = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+            for (u32 k = 0; k < 3; k++) {
+                centroid[k] += (p0[k] + p1[k] + p2[k]) * (area / 3.0f);
+                normal[k]   += n[k];
+            }
+            area_sum += area;
+        }
+
+        f32 nlen = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (area_sum <= 0.0f || nlen <= 0.0f) {
+            cl->sort_key = 0.0f;
+            continue;
+        }
+        f32 key = 0.0f;
+        for (u32 k = 0; k < 3; k++) {
+            key += (centroid[k] / area_sum - mesh_c[k]) * (normal[k] / nlen);
+        }
+        cl->sort_key = key;
+    }
+
+    qsort(clusters, cluster_count, sizeof(MeshCluster), cluster_cmp);
+
+    u32 cursor = 0;
+    for (u32 c = 0; c < cluster_count; c++) {
+        u32 n = clusters[c].tri_count * 3;
+        memcpy(&out[cursor], &indices[clusters[c].first_tri * 3], sizeof(u32) * n);
+        cursor += n;
+    }
+    memcpy(indices, out, sizeof(u32) * index_count);
+    *out_cluster_count = cluster_count;
+
+    free(clusters); free(stamp); free(out);
+    return ENGINE_SUCCESS;
+}
+
+/* ==========================================================================
+ * 4. Vertex fetch ordering
+ * ========================================================================== */
+
+static EngineResult optimize_vertex_fetch(u8 *vertices, size_t stride, u32 *vertex_count,
+                                          u32 *indices, u32 index_count) {
+    u32 count = *vertex_count;
+    u32 *remap = malloc(sizeof(u32) * count);
+    u8  *copy  = malloc(stride * count);
+    if (!remap || !copy) {
+        free(remap);
+        free(copy);
+        return ENGINE_ERROR_OUT_OF_MEMORY;
+    }
+    memcpy(copy, vertices, stride * count);
+    memset(remap, 0xFF, sizeof(u32) * count);
+
+    /* Number vertices in the order the index stream first touches them */
+    u32 next = 0;
+    for (u32 i = 0; i < index_count; i++) {
+        u32 v = indices[i];
+        if (remap[v] == 0xFFFFFFFFu) {
+            remap[v] = next;
+            memcpy(vertices + (size_t)next * stride, copy + (size_t)v * stride, stride);
+            next++;
+        }
+        indices[i] = remap[v];
+    }
+    *vertex_count = next;
+
+    free(remap);
+    free(copy);
+    return ENGINE_SUCCESS;
+}
+
+/* ==========================================================================
+ * mesh_optimize
+ * ========================================================================== */
+
+EngineResult mesh_optimize(void *vertices, size_t stride, size_t position_offset,
+                           u32 *vertex_count, u32 *indices, u32 index_count,
+                           MeshOptimizeStats *out_stats) {
+    MeshOptimizeStats stats = {0};
+    stats.vertex_count_before = *vertex_count;
+    stats.vertex_count_after  = *vertex_count;
+    if (!indices_in_range(indices, index_count, *vertex_count)) {
+        LOG_WARN("mesh_optimize: index out of range (%u vertices), skipped", *vertex_count);
+        if (out_stats) *out_stats = stats;
+        return ENGINE_ERROR_GENERIC;
+    }
+    stats.acmr_before = mesh_optimize_acmr(indices, index_count, *vertex_count, ACMR_CACHE_SIZE);
+
+    EngineResult res = ENGINE_SUCCESS;
+    if (index_count < 3 || index_count % 3 != 0 || *vertex_count == 0) {
+        LOG_WARN("mesh_optimize: not a triangle list (%u indices), skipped", index_count);
+    } else {
+        u8 *verts = vertices;
+        res = dedup_vertices(verts, stride, vertex_count, indices, index_count);
+        if (res == ENGINE_SUCCESS) res = optimize_vertex_cache(indices, index_count, *vertex_count);
+        if (res == ENGINE_SUCCESS) res = optimize_overdraw(verts, stride, position_offset,
+                                                           *vertex_count, indices, index_count,
+                                                           &stats.cluster_count);
+        if (res == ENGINE_SUCCESS) res = optimize_vertex_fetch(verts, stride, vertex_count,
+                                                               indices, index_count);
+        if (res != ENGINE_SUCCESS) LOG_WARN("mesh_optimize: out of memory, optimization incomplete");
+    }
+
+    stats.vertex_count_after = *vertex_count;
+    stats.acmr_after = mesh_optimize_acmr(indices, index_count, *vertex_count, ACMR_CACHE_SIZE);
+    if (out_stats) *out_stats = stats;
+    return res;
+}
+
+/* ==========================================================================
+ * mesh_simplify (vertex clustering)
+ * ========================================================================== */
+
+/* Finest grid tried, per axis (cell ids must fit in 30 bits) */
+#define SIMPLIFY_MAX_GRID   1024
+#define CELL_EMPTY          0xFFFFFFFFu
+
+typedef struct {
+    u32 cell;
+    u32 rep;        /* representative vertex */
+    f32 best_d2;    /* its squared distance to the cell mean */
+    f32 sum[3];
+    u32 count;
+} SimplifyCell;
+
+typedef struct {
+    const u8     *verts;
+    size_t        stride;
+    size_t        position_offset;
+    u32           vertex_count;
+    const u32    *indices;
+    u32           index_count;
+    f32           lo[3];
+    f32           extent;       /* largest AABB side */
+    u32          *vertex_cell;  /* per vertex: slot in cells[] */
+    SimplifyCell *cells;
+    u32           cell_mask;
+} SimplifyState;
+
+static const f32 *simplify_pos(const SimplifyState *s, u32 v) {
+    return (const f32 *)(s->verts + (size_t)v * s->stride + s->position_offset);
+}
+
+/* Cluster on a grid x grid x grid lattice and write the collapsed triangle
+ * list. Returns the index count. */
+static u32 simplify_with_grid(SimplifyState *s, u32 grid, u32 *out) {
+    for (u32 i = 0; i <= s->cell_mask; i++) s->cells[i].cell = CELL_EMPTY;
+
+    f32 scale = (f32)grid / s->extent;
+    for (u32 v = 0; v < s->vertex_count; v++) {
+        const f32 *p = simplify_pos(s, v);
+        u32 c[3];
+        for (u32 k = 0; k < 3; k++) {
+            f32 f = (p[k] - s->lo[k]) * scale;
+            c[k] = (f <= 0.0f) ? 0 : ENGINE_MIN((u32)f, grid - 1);
+        }
+        u32 id = (c[0] * grid + c[1]) * grid + c[2];
+
+        u32 slot = (id * 2654435761u) & s->cell_mask;
+        while (s->cells[slot].cell != CELL_EMPTY && s->cells[slot].cell != id) {
+            slot = (slot + 1) & s->cell_mask;
+        }
+        SimplifyCell *cell = &s->cells[slot];
+        if (cell->cell == CELL_EMPTY) {
+            *cell = (SimplifyCell){ .cell = id, .rep = v, .best_d2 = INFINITY };
+        }
+        cell->sum[0] += p[0];
+        cell->sum[1] += p[1];
+        cell->sum[2] += p[2];
+        cell->count++;
+        s->vertex_cell[v] = slot;
+    }
+
+    /* Representative: the member closest to the cell's mean position */
+    for (u32 v = 0; v < s->vertex_count; v++) {
+        SimplifyCell *cell = &s->cells[s->vertex_cell[v]];
+        const f32 *p = simplify_pos(s, v);
+        f32 inv = 1.0f / (f32)cell->count;
+        f32 dx = p[0] - cell->sum[0] * inv;
+        f32 dy = p[1] - cell->sum[1] * inv;
+        f32 dz = p[2] - cell->sum[2] * inv;
+        f32 d2 = dx * dx + dy * dy + dz * dz;
+        if (d2 < cell->best_d2) {
+            cell->best_d2 = d2;
+            cell->rep = v;
+        }
+    }
+
+    u32 n = 0;
+    for (u32 i = 0; i + 2 < s->index_count; i += 3) {
+        u32 a = s->cells[s->vertex_cell[s->indices[i + 0]]].rep;
+        u32 b = s->cells[s->vertex_cell[s->indices[i + 1]]].rep;
+        u32 c = s->cells[s->vertex_cell[s->indices[i + 2]]].rep;
+        if (a == b || b == c || a == c) continue;
+        out[n++] = a;
+        out[n++] = b;
+        out[n++] = c;
+    }
+    return n;
+}
+
+u32 mesh_simplify(const void *vertices, size_t stride, size_t position_offset,
+                  u32 vertex_count, const u32 *indices, u32 index_count,
+                  u32 target_index_count, u32 *out_indices) {
+    if (vertex_count == 0 || index_count < 3) return 0;
+    if (!indices_in_range(indices, index_count, vertex_count)) return 0;
+
+    SimplifyState s = {
+        .verts           = vertices,
+        .stride          = stride,
+        .position_offset = position_offset,
+        .vertex_count    = vertex_count,
+        .indices         = indices,
+        .index_count     = index_count,
+    };
+
+    f32 hi[3];
+    memcpy(s.lo, simplify_pos(&s, 0), sizeof(s.lo));
+    memcpy(hi, s.lo, sizeof(hi));
+    for (u32 v = 1; v < vertex_count; v++) {
+        const f32 *p = simplify_pos(&s, v);
+        for (u32 k = 0; k < 3; k++) {
+            if (p[k] < s.lo[k]) s.lo[k] = p[k];
+            if (p[k] > hi[k])   hi[k]   = p[k];
+        }
+    }
+    s.extent = fmaxf(hi[0] - s.lo[0], fmaxf(hi[1] - s.lo[1], hi[2] - s.lo[2]));
+    if (!(s.extent > 0.0f)) return 0;
+
+    u32 cap = 1;
+    while (cap < vertex_count * 2) cap <<= 1;
+    s.cell_mask   = cap - 1;
+    s.cells       = malloc(sizeof(SimplifyCell) * cap);
+    s.vertex_cell = malloc(sizeof(u32) * vertex_count);
+    if (!s.cells || !s.vertex_cell) {
+        free(s.cells);
+        free(s.vertex_cell);
+        return 0;
+    }
+
+    /* Coarser grids never produce more triangles in practice, so binary
+     * search for the finest grid that meets the target */
+    u32 lo = 1, hi_grid = SIMPLIFY_MAX_GRID, best = 0;
+    while (lo <= hi_grid) {
+        u32 grid = lo + (hi_grid - lo) / 2;
+        if (simplify_with_grid(&s, grid, out_indices) <= target_index_count) {
+            best = grid;
+            lo = grid + 1;
+        } else {
+            hi_grid = grid - 1;
+        }
+    }
+
+    u32 n = best ? simplify_with_grid(&s, best, out_indices) : 0;
+    free(s.cells);
+    free(s.vertex_cell);
+    return n;
+}
@@ -0,0 +1,51 @@
+#ifndef ENGINE_MESH_OPTIMIZE_H
+#define ENGINE_MESH_OPTIMIZE_H
+
+#include "core/common.h"
+
+/* Import-time mesh optimization for indexed triangle lists (CPU only, run once
+ * by the model loaders before upload):
+ *   1. deduplicate bitwise-identical vertices
+ *   2. reorder triangles for the post-transform vertex cache (Forsyth)
+ *   3. reorder cache-friendly clusters outside-in to reduce overdraw
+ *   4. reorder vertices into first-use order for vertex fetch, dropping
+ *      unreferenced ones
+ * Works on any vertex layout: `stride` bytes per vertex with three f32
+ * position components at `position_offset`. */
+
+typedef struct {
+    u32 vertex_count_before;
+    u32 vertex_count_after;
+    f32 acmr_before;        /* average cache miss ratio (misses per triangle) */
+    f32 acmr_after;
+    u32 cluster_count;      /* overdraw clusters */
+} MeshOptimizeStats;
+
+/* Optimize in place; *vertex_count can only shrink. If scratch allocation
+ * fails part way the mesh stays valid, just less optimized, and
+ * ENGINE_ERROR_OUT_OF_MEMORY is returned. An index >= *vertex_count leaves
+ * the mesh untouched and returns ENGINE_ERROR_GENERIC. out_stats may be
+ * NULL. */
+EngineResult mesh_optimize(void *vertices, size_t stride, size_t position_offset,
+                           u32 *vertex_count, u32 *indices, u32 index_count,
+                           MeshOptimizeStats *out_stats);
+
+/* ACMR of an index stream through a FIFO cache of `cache_size` entries
+ * (0.5 is ideal for a regular grid, 3.0 is no reuse at all; 0 if an index is
+ * out of range) */
+f32 mesh_optimize_acmr(const u32 *indices, u32 index_count, u32 vertex_count,
+                       u32 cache_size);
+
+/* Simplified copy of a triangle list for distance LODs. Vertices are
+ * clustered on a uniform grid and every triangle is remapped to its cells'
+ * representative vertices; triangles that collapse are dropped. The output
+ * references the original vertex array, so all LODs of a mesh share one
+ * vertex range. Uses the finest grid that yields at most target_index_count
+ * indices. out_indices must hold index_count entries. Returns the number of
+ * indices written (0 on allocation failure, an index >= vertex_count, or if
+ * nothing survives). */
+u32 mesh_simplify(const void *vertices, size_t stride, size_t position_offset,
+                  u32 vertex_count, const u32 *indices, u32 index_count,
+                  u32 target_index_count, u32 *out_indices);
+
+#endif /* ENGINE_MESH_OPTIMIZE_H */
@@ -1,7 +1,11 @@
 #include "renderer/model.h"
 #include "renderer/renderer.h"
+#include "renderer/mesh_optimize.h"
+#include "renderer/asset_cache.h"
 #include "core/log.h"
+#include "core/profile.h"
 
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -11,15 +15,25 @@
 #include "cgltf/cgltf.h"
 
 /* --------------------------------------------------------------------------
- * renderer_load_model — load a glTF (.gltf / .glb) file and upload as a
- * single MeshHandle.  All meshes and triangle primitives are merged.
+ * model_decode — load a glTF (.gltf / .glb) file into one merged, optimized
+ * vertex/index set.  All meshes and triangle primitives are merged.
  * ------------------------------------------------------------------------ */
 
-EngineResult renderer_load_model(Renderer *renderer, const char *path,
-                                 MeshHandle *out_handle) {
-    if (!renderer || !path || !out_handle) {
-        LOG_ERROR("renderer_load_model: NULL argument");
-        return ENGINE_ERROR_GENERIC;
+static EngineResult decode_model(const char *path, ModelData *out_data) {
+    memset(out_data, 0, sizeof(*out_data));
+
+    /* ---- Step 0: Baked cache — hand out the mapping itself on a hit ---- */
+    u64  source_hash = 0;
+    bool have_hash   = asset_cache_hash_file(path, &source_hash) == ENGINE_SUCCESS;
+    if (have_hash &&
+        asset_cache_open(path, source_hash, ASSET_CACHE_MESH, sizeof(Vertex3D),
+                         &out_data->cached) == ENGINE_SUCCESS) {
+        out_data->from_cache   = true;
+        out_data->vertices     = out_data->cached.vertices;
+        out_data->vertex_count = out_data->cached.vertex_count;
+        out_data->indices      = out_data->cached.indices;
+        out_data->index_count  = out_data->cached.index_count;
+        return ENGINE_SUCCESS;
     }
 
     /* ---- Step 1: Parse the glTF file ---- */
@@ -40,6 +54,15 @@ EngineResult renderer_load_model(Renderer *renderer, const char *path,
         return ENGINE_ERROR_FILE_NOT_FOUND;
     }
 
+    /* Index values and accessor sizes come from the file and are used to
+     * index the vertex arrays, so a malformed file is rejected here */
+    result = cgltf_validate(data);
+    if (result != cgltf_result_success) {
+        LOG_ERROR("Invalid glTF file: %s (cgltf error %d)", path, (int)result);
+        cgltf_free(data);
+        return ENGINE_ERROR_GENERIC;
+    }
+
     /* ---- Step 3: First pass — count total vertices and indices ---- */
     u32 total_verts   = 0;
     u32 total_indices = 0;
@@ -181,17 +204,68 @@ EngineResult renderer_load_model(Renderer *renderer, const char *path,
         }
     }
 
-    /* ---- Step 6: Upload to GPU ---- */
-    EngineResult res = renderer_upload_mesh_3d(renderer, vertices, vert_cursor,
-                                               indices, idx_cursor, out_handle);
+    /* ---- Step 6: Reorder for vertex cache, overdraw and fetch ---- */
+    MeshOptimizeStats opt;
+    mesh_optimize(vertices, sizeof(Vertex3D), offsetof(Vertex3D, position),
+                  &vert_cursor, indices, idx_cursor, &opt);
+    LOG_INFO("Model optimized: %s (%u -> %u vertices, ACMR %.3f -> %.3f, %u clusters)",
+             path, opt.vertex_count_before, opt.vertex_count_after,
+             opt.acmr_before, opt.acmr_after, opt.cluster_count);
+
+    if (have_hash) {
+        asset_cache_write(path, source_hash, ASSET_CACHE_MESH, sizeof(Vertex3D),
+                          vertices, vert_cursor, indices, idx_cursor, NULL, NULL, 0);
+    }
 
-    free(vertices);
-    free(indices);
     cgltf_free(data);
 
+    out_data->owned_vertices = vertices;
+    out_data->owned_indices  = indices;
+    out_data->vertices       = vertices;
+    out_data->vertex_count   = vert_cursor;
+    out_data->indices        = indices;
+    out_data->index_count    = idx_cursor;
+    return ENGINE_SUCCESS;
+}
+
+EngineResult model_decode(const char *path, ModelData *out_data) {
+    PROFILE_ZONE_BEGIN("model_decode");
+    EngineResult res = decode_model(path, out_data);
+    PROFILE_ZONE_END();
+    return res;
+}
+
+void model_data_free(ModelData *data) {
+    if (data->from_cache) asset_cache_close(&data->cached);
+    free(data->owned_vertices);
+    free(data->owned_indices);
+    memset(data, 0, sizeof(*data));
+}
+
+/* --------------------------------------------------------------------------
+ * renderer_load_model — decode, then upload as a single MeshHandle
+ * ------------------------------------------------------------------------ */
+
+EngineResult renderer_load_model(Renderer *renderer, const char *path,
+                                 MeshHandle *out_handle) {
+    if (!renderer || !path || !out_handle) {
+        LOG_ERROR("renderer_load_model: NULL argument");
+        return ENGINE_ERROR_GENERIC;
+    }
+
+    PROFILE_ZONE_BEGIN("renderer_load_model");
+    ModelData data;
+    EngineResult res = model_decode(path, &data);
     if (res == ENGINE_SUCCESS) {
-        LOG_INFO("Model loaded: %s (%u vertices, %u indices)", path,
-                 vert_cursor, idx_cursor);
+        res = renderer_upload_mesh_3d(renderer, data.vertices, data.vertex_count,
+                                      data.indices, data.index_count, out_handle);
+        if (res == ENGINE_SUCCESS) {
+            LOG_INFO("Model loaded%s: %s (%u vertices, %u indices)",
+                     data.from_cache ? " from cache" : "", path,
+                     data.vertex_count, data.index_count);
+        }
+        model_data_free(&data);
     }
+    PROFILE_ZONE_END();
     return res;
 }
@@ -3,6 +3,7 @@
 
 #include "core/common.h"
 #include "renderer/renderer_types.h"
+#include "renderer/asset_cache.h"
 
 typedef struct Renderer Renderer;
 
@@ -14,4 +15,24 @@ typedef struct Renderer Renderer;
 EngineResult renderer_load_model(Renderer *renderer, const char *path,
                                  MeshHandle *out_handle);
 
+/* ---- Internal: the CPU half of a load, used by the async loader ---- */
+
+/* Merged, optimized geometry ready for upload: owned arrays after a glTF
+ * parse, or pointers into the baked cache mapping on a cache hit. */
+typedef struct {
+    const Vertex3D *vertices;
+    u32             vertex_count;
+    const u32      *indices;
+    u32             index_count;
+    Vertex3D       *owned_vertices;  /* NULL on a cache hit */
+    u32            *owned_indices;
+    AssetCacheView  cached;
+    bool            from_cache;
+} ModelData;
+
+/* Read, parse and optimize a model (writing the baked cache on a miss).
+ * Touches no renderer state, so it runs on any thread. */
+EngineResult model_decode(const char *path, ModelData *out_data);
+void         model_data_free(ModelData *data);
+
 #endif /* ENGINE_MODEL_H */
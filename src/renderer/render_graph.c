@@ -0,0 +1,490 @@
+#include "renderer/render_graph.h"
+#include "renderer/vk_buffer.h"
+#include "core/log.h"
+
+#include <string.h>
+
+/* Access bits that write memory; a barrier only has to make these visible */
+#define RG_WRITE_ACCESS (VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | \
+                         VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT)
+
+typedef struct {
+    VkPipelineStageFlags stages;
+    VkAccessFlags        access;
+    VkImageLayout        color_layout;
+    VkImageLayout        depth_layout;
+    bool                 write;
+} RgAccessInfo;
+
+static const RgAccessInfo ACCESS_INFO[RG_ACCESS_COUNT] = {
+    [RG_ACCESS_COLOR_ATTACHMENT] = {
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_UNDEFINED, true,
+    },
+    [RG_ACCESS_DEPTH_ATTACHMENT] = {
+        VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, true,
+    },
+    [RG_ACCESS_FRAGMENT_READ] = {
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+        false,
+    },
+    [RG_ACCESS_COMPUTE_READ] = {
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+        false,
+    },
+    [RG_ACCESS_COMPUTE_STORAGE] = {
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+        VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, true,
+    },
+    [RG_ACCESS_VERTEX_INPUT] = {
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED, false,
+    },
+    [RG_ACCESS_INDIRECT_READ] = {
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED, false,
+    },
+};
+
+/* --------------------------------------------------------------------------
+ * Lifecycle
+ * ------------------------------------------------------------------------ */
+
+void render_graph_init(VulkanContext *vk) {
+    memset(&vk->graph, 0, sizeof(vk->graph));
+}
+
+static void destroy_images(VulkanContext *vk) {
+    RenderGraph *g = &vk->graph;
+
+    for (u32 i = 0; i < g->resource_count; i++) {
+        RgResourceInfo *r = &g->resources[i];
+        if (r->image) {
+            vkDestroyImage(vk->device, r->image, NULL);
+            r->image = VK_NULL_HANDLE;
+        }
+    }
+    for (u32 i = 0; i < g->slot_count; i++) vk_memory_free(vk, &g->slots[i].memory);
+    g->slot_count      = 0;
+    g->transient_bytes = 0;
+    g->aliased_bytes   = 0;
+}
+
+void render_graph_shutdown(VulkanContext *vk) {
+    destroy_images(vk);
+    memset(&vk->graph, 0, sizeof(vk->graph));
+}
+
+/* --------------------------------------------------------------------------
+ * Setup
+ * ------------------------------------------------------------------------ */
+
+static RgResource add_resource(RenderGraph *g, const char *name) {
+    if (g->resource_count >= RG_MAX_RESOURCES) {
+        LOG_ERROR("Render graph: too many resources (max %d), '%s' dropped", RG_MAX_RESOURCES, name);
+        return RG_NONE;
+    }
+    RgResource id = g->resource_count++;
+    RgResourceInfo *r = &g->resources[id];
+    memset(r, 0, sizeof(*r));
+    r->name = name;
+    r->slot = RG_NONE;
+    return id;
+}
+
+RgResource render_graph_add_image(VulkanContext *vk, const char *name, const RgImageDesc *desc) {
+    RenderGraph *g = &vk->graph;
+    RgResource id = add_resource(g, name);
+    if (id == RG_NONE) return RG_NONE;
+
+    g->resources[id].is_image = true;
+    g->resources[id].desc     = *desc;
+    g->dirty = true;
+    return id;
+}
+
+void render_graph_set_image_desc(VulkanContext *vk, RgResource image, const RgImageDesc *desc) {
+    RenderGraph *g = &vk->graph;
+    if (image == RG_NONE) return;
+    RgResourceInfo *r = &g->resources[image];
+    if (memcmp(&r->desc, desc, sizeof(*desc)) == 0) return;
+    r->desc  = *desc;
+    g->dirty = true;
+}
+
+RgResource render_graph_add_buffer(VulkanContext *vk, const char *name, bool frame_local) {
+    RenderGraph *g = &vk->graph;
+    RgResource id = add_resource(g, name);
+    if (id == RG_NONE) return RG_NONE;
+
+    g->resources[id].frame_local = frame_local;
+    return id;
+}
+
+RgPass render_graph_add_pass(VulkanContext *vk, const char *name,
+                             RgRecordFn record, void *user, bool output) {
+    RenderGraph *g = &vk->graph;
+    if (g->pass_count >= RG_MAX_PASSES) {
+        LOG_ERROR("Render graph: too many passes (max %d), '%s' dropped", RG_MAX_PASSES, name);
+        return RG_NONE;
+    }
+    RgPass id = g->pass_count++;
+    g->passes[id] = (RgPassInfo){
+        .name   = name,
+        .record = record,
+        .user   = user,
+        .output = output,
+    };
+    g->dirty = true;   /* lifetimes may change */
+    return id;
+}
+
+void render_graph_use(VulkanContext *vk, RgPass pass, RgResource resource, RgAccess access) {
+    RenderGraph *g = &vk->graph;
+    if (pass == RG_NONE || resource == RG_NONE) return;
+
+    RgPassInfo *p = &g->passes[pass];
+    const RgResourceInfo *r = &g->resources[resource];
+    const RgAccessInfo *info = &ACCESS_INFO[access];
+    VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    if (r->is_image) {
+        layout = (r->desc.aspect & VK_IMAGE_ASPECT_DEPTH_BIT) ? info->depth_layout
+                                                              : info->color_layout;
+    }
+
+    /* A second use of the same resource widens the first */
+    for (u32 i = 0; i < p->access_count; i++) {
+        RgPassAccess *a = &p->accesses[i];
+        if (a->resource != resource) continue;
+        if (a->layout != layout) {
+            LOG_ERROR("Render graph: pass '%s' uses '%s' in two layouts", p->name, r->name);
+            return;
+        }
+        a->stages |= info->stages;
+        a->access |= info->access;
+        a->write  |= info->write;
+        return;
+    }
+
+    if (p->access_count >= RG_MAX_ACCESSES) {
+        LOG_ERROR("Render graph: pass '%s' uses too many resources (max %d)",
+                  p->name, RG_MAX_ACCESSES);
+        return;
+    }
+    p->accesses[p->access_count++] = (RgPassAccess){
+        .resource = resource,
+        .stages   = info->stages,
+        .access   = info->access,
+        .layout   = layout,
+        .write    = info->write,
+    };
+    if (r->is_image) g->dirty = true;
+}
+
+/* --------------------------------------------------------------------------
+ * Transient images and memory aliasing
+ * ------------------------------------------------------------------------ */
+
+static bool lifetimes_overlap(const RgResourceInfo *a, const RgResourceInfo *b) {
+    if (a->first_pass == RG_NONE || b->first_pass == RG_NONE) return false;
+    return a->first_pass <= b->last_pass && b->first_pass <= a->last_pass;
+}
+
+/* First slot of a compatible memory type whose images are all dead while
+ * `r` is alive */
+static u32 find_slot(const RenderGraph *g, RgResource r, const VkMemoryRequirements *reqs) {
+    for (u32 s = 0; s < g->slot_count; s++) {
+        if (!(g->slots[s].reqs.memoryTypeBits & reqs->memoryTypeBits)) continue;
+
+        bool free = true;
+        for (u32 i = 0; i < g->resource_count && free; i++) {
+            if (i != r && g->resources[i].slot == s)
+                free = !lifetimes_overlap(&g->resources[i], &g->resources[r]);
+        }
+        if (free) return s;
+    }
+    return RG_NONE;
+}
+
+EngineResult render_graph_compile(VulkanContext *vk) {
+    RenderGraph *g = &vk->graph;
+    if (!g->dirty) return ENGINE_SUCCESS;
+
+    destroy_images(vk);
+
+    /* Lifetimes over every registered pass, enabled or not: a frame that
+     * runs fewer passes only shortens them, so sharing stays safe */
+    for (u32 i = 0; i < g->resource_count; i++) {
+        g->resources[i].first_pass = RG_NONE;
+        g->resources[i].last_pass  = RG_NONE;
+        g->resources[i].slot       = RG_NONE;
+    }
+    for (u32 p = 0; p < g->pass_count; p++) {
+        for (u32 a = 0; a < g->passes[p].access_count; a++) {
+            RgResourceInfo *r = &g->resources[g->passes[p].accesses[a].resource];
+            if (r->first_pass == RG_NONE) r->first_pass = p;
+            r->last_pass = p;
+        }
+    }
+
+    VkMemoryRequirements reqs[RG_MAX_RESOURCES];
+    RgResource order[RG_MAX_RESOURCES];
+    u32 image_count = 0;
+
+    for (u32 i = 0; i < g->resource_count; i++) {
+        RgResourceInfo *r = &g->resources[i];
+        if (!r->is_image) continue;
+
+        VkImageCreateInfo img_info = {
+            .sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+            .imageType     = VK_IMAGE_TYPE_2D,
+            .extent        = { r->desc.extent.width, r->desc.extent.height, 1 },
+            .mipLevels     = r->desc.mip_levels,
+            .arrayLayers   = r->desc.array_layers,
+            .format        = r->desc.format,
+            .tiling        = VK_IMAGE_TILING_OPTIMAL,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .usage         = r->desc.usage,
+            .sharingMode   = VK_SHARING_MODE_EXCLUSIVE,
+            .samples       = VK_SAMPLE_COUNT_1_BIT,
+        };
+        if (vkCreateImage(vk->device, &img_info, NULL, &r->image) != VK_SUCCESS) {
+            LOG_FATAL("Render graph: failed to create image '%s' (%ux%u)", r->name,
+                      r->desc.extent.width, r->desc.extent.height);
+            return ENGINE_ERROR_VULKAN_INIT;
+        }
+        vkGetImageMemoryRequirements(vk->device, r->image, &reqs[i]);
+        r->size = reqs[i].size;
+
+        /* Largest first, so the big images open the slots */
+        u32 at = image_count++;
+        while (at > 0 && g->resources[order[at - 1]].size < r->size) {
+            order[at] = order[at - 1];
+            at--;
+        }
+        order[at] = i;
+    }
+
+    for (u32 k = 0; k < image_count; k++) {
+        RgResource i = order[k];
+        u32 s = find_slot(g, i, &reqs[i]);
+        if (s == RG_NONE) {
+            s = g->slot_count++;
+            g->slots[s] = (RgMemorySlot){ .reqs = reqs[i] };
+        } else {
+            VkMemoryRequirements *sr = &g->slots[s].reqs;
+            sr->size            = ENGINE_MAX(sr->size, reqs[i].size);
+            sr->alignment       = ENGINE_MAX(sr->alignment, reqs[i].alignment);
+            sr->memoryTypeBits &= reqs[i].memoryTypeBits;
+            g->aliased_bytes   += reqs[i].size;
+        }
+        g->resources[i].slot = s;
+    }
+
+    for (u32 s = 0; s < g->slot_count; s++) {
+        RgMemorySlot *slot = &g->slots[s];
+        EngineResult res = vk_memory_alloc(vk, &slot->reqs, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                           true, &slot->memory);
+        if (res != ENGINE_SUCCESS) return res;
+        g->transient_bytes += slot->reqs.size;
+    }
+
+    for (u32 k = 0; k < image_count; k++) {
+        RgResourceInfo *r = &g->resources[order[k]];
+        const GpuAllocation *mem = &g->slots[r->slot].memory;
+        if (vkBindImageMemory(vk->device, r->image, mem->memory, mem->offset) != VK_SUCCESS) {
+            LOG_FATAL("Render graph: failed to bind image '%s'", r->name);
+            return ENGINE_ERROR_VULKAN_INIT;
+        }
+        r->layout         = VK_IMAGE_LAYOUT_UNDEFINED;
+        r->write_stages   = 0;
+        r->write_access   = 0;
+        r->read_stages    = 0;
+        r->visible_stages = 0;
+    }
+
+    g->dirty = false;
+    LOG_INFO("Render graph: %u transient images in %u allocations, %.1f MB (%.1f MB shared)",
+             image_count, g->slot_count, (f64)g->transient_bytes / (1024.0 * 1024.0),
+             (f64)g->aliased_bytes / (1024.0 * 1024.0));
+    return ENGINE_SUCCESS;
+}
+
+VkImage render_graph_image(const VulkanContext *vk, RgResource image) {
+    if (image == RG_NONE) return VK_NULL_HANDLE;
+    return vk->graph.resources[image].image;
+}
+
+/* --------------------------------------------------------------------------
+ * Per frame
+ * ------------------------------------------------------------------------ */
+
+void render_graph_enable_pass(VulkanContext *vk, RgPass pass, bool enabled) {
+    if (pass == RG_NONE) return;
+    vk->graph.passes[pass].enabled = enabled;
+}
+
+/* Walk back from the passes with outside effects: a pass is live when
+ * something after it reads what it writes. Images and frame-local buffers
+ * die with the frame; other buffers are read again next frame. */
+static void cull_passes(RenderGraph *g) {
+    bool needed[RG_MAX_RESOURCES];
+    for (u32 i = 0; i < g->resource_count; i++) {
+        needed[i] = !g->resources[i].is_image && !g->resources[i].frame_local;
+    }
+
+    for (u32 p = g->pass_count; p-- > 0;) {
+        RgPassInfo *pass = &g->passes[p];
+        pass->live = false;
+        if (!pass->enabled) continue;
+
+        bool live = pass->output;
+        for (u32 a = 0; a < pass->access_count && !live; a++) {
+            live = pass->accesses[a].write && needed[pass->accesses[a].resource];
+        }
+        if (!live) continue;
+        pass->live = true;
+
+        for (u32 a = 0; a < pass->access_count; a++) {
+            const RgPassAccess *acc = &pass->accesses[a];
+            if (acc->write) needed[acc->resource] = false;
+        }
+        for (u32 a = 0; a < pass->access_count; a++) {
+            const RgPassAccess *acc = &pass->accesses[a];
+            if (acc->access & ~RG_WRITE_ACCESS) needed[acc->resource] = true;
+        }
+    }
+}
+
+typedef struct {
+    VkPipelineStageFlags src_stages;
+    VkPipelineStageFlags dst_stages;
+    VkAccessFlags        src_access;   /* global memory barrier */
+    VkAccessFlags        dst_access;
+    VkImageMemoryBarrier images[RG_MAX_ACCESSES];
+    u32                  image_count;
+} PassBarrier;
+
+/* Fold what `a` needs into the pass's barrier and advance the resource's
+ * state past it */
+static void add_access_barrier(RenderGraph *g, const RgPassAccess *a, PassBarrier *b) {
+    RgResourceInfo *r = &g->resources[a->resource];
+    VkAccessFlags written = a->write ? (a->access & RG_WRITE_ACCESS) : 0;
+
+    if (r->is_image && (!r->discarded || r->layout != a->layout)) {
+        /* Layout transition. At the first use in a frame the old contents
+         * are dropped, but whatever last used the memory (this image in an
+         * earlier frame, or one sharing its slot) must be done with it. */
+        VkImageLayout        old        = r->layout;
+        VkPipelineStageFlags src        = r->write_stages | r->read_stages;
+        VkAccessFlags        src_access = r->write_access;
+        RgMemorySlot *slot = &g->slots[r->slot];
+        if (!r->discarded) {
+            old          = VK_IMAGE_LAYOUT_UNDEFINED;
+            src          = slot->stages;
+            src_access   = slot->writes;
+            slot->stages = 0;
+            slot->writes = 0;
+            r->discarded = true;
+        }
+
+        b->images[b->image_count++] = (VkImageMemoryBarrier){
+            .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask       = src_access,
+            .dstAccessMask       = a->access,
+            .oldLayout           = old,
+            .newLayout           = a->layout,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image               = r->image,
+            .subresourceRange    = { r->desc.aspect, 0, r->desc.mip_levels,
+                                     0, r->desc.array_layers },
+        };
+        b->src_stages |= src;
+        b->dst_stages |= a->stages;
+
+        /* The transition counts as a write finished before a->stages */
+        r->layout         = a->layout;
+        r->write_stages   = a->stages;
+        r->write_access   = written;
+        r->read_stages    = a->write ? 0 : a->stages;
+        r->visible_stages = a->write ? 0 : a->stages;
+    } else {
+        if (r->write_stages && (a->write || (a->stages & ~r->visible_stages))) {
+            /* Read or write after write */
+            b->src_stages |= r->write_stages | (a->write ? r->read_stages : 0);
+            b->dst_stages |= a->stages;
+            b->src_access |= r->write_access;
+            b->dst_access |= a->access;
+        } else if (a->write && r->read_stages) {
+            /* Write after read: execution order is enough */
+            b->src_stages |= r->read_stages;
+            b->dst_stages |= a->stages;
+        }
+
+        if (a->write) {
+            r->write_stages   = a->stages;
+            r->write_access   = written;
+            r->read_stages    = 0;
+            r->visible_stages = 0;
+        } else {
+            r->read_stages    |= a->stages;
+            r->visible_stages |= a->stages;
+        }
+    }
+
+    if (r->is_image) {
+        g->slots[r->slot].stages |= a->stages;
+        g->slots[r->slot].writes |= written;
+    }
+}
+
+EngineResult render_graph_execute(VulkanContext *vk, VkCommandBuffer cmd) {
+    RenderGraph *g = &vk->graph;
+
+    for (u32 i = 0; i < g->resource_count; i++) {
+        RgResourceInfo *r = &g->resources[i];
+        r->discarded = false;
+        if (r->frame_local) {
+            r->write_stages   = 0;
+            r->write_access   = 0;
+            r->read_stages    = 0;
+            r->visible_stages = 0;
+        }
+    }
+
+    cull_passes(g);
+
+    for (u32 p = 0; p < g->pass_count; p++) {
+        RgPassInfo *pass = &g->passes[p];
+        if (!pass->live) continue;
+
+        PassBarrier b = {0};
+        for (u32 a = 0; a < pass->access_count; a++) {
+            add_access_barrier(g, &pass->accesses[a], &b);
+        }
+
+        if (b.dst_stages && (b.src_stages || b.image_count)) {
+            VkMemoryBarrier mem = {
+                .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                .srcAccessMask = b.src_access,
+                .dstAccessMask = b.dst_access,
+            };
+            u32 mem_count = (b.src_access || b.dst_access) ? 1 : 0;
+            vkCmdPipelineBarrier(cmd,
+                                 b.src_stages ? b.src_stages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                 b.dst_stages, 0, mem_count, &mem, 0, NULL,
+                                 b.image_count, b.images);
+        }
+
+        EngineResult res = pass->record(vk, cmd, pass->user);
+        if (res != ENGINE_SUCCESS) return res;
+    }
+    return ENGINE_SUCCESS;
+}
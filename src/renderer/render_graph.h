@@ -0,0 +1,59 @@
+#ifndef ENGINE_RENDER_GRAPH_H
+#define ENGINE_RENDER_GRAPH_H
+
+#include "renderer/vk_types.h"
+#include "core/common.h"
+
+/* ---- Lifecycle (called from renderer.c) ---- */
+
+void         render_graph_init(VulkanContext *vk);
+void         render_graph_shutdown(VulkanContext *vk);
+
+/* ---- Setup ----
+ * Resources and passes are registered once; passes execute in the order
+ * they were added. Registration can't fail: it is sized at compile time
+ * (RG_MAX_*), and exceeding a limit is a programming error that is logged
+ * and returns RG_NONE. Every function taking a handle ignores RG_NONE, so
+ * optional resources and passes need no special cases. */
+
+/* A transient image owned by the graph. The VkImage exists from the next
+ * render_graph_compile until the one after a desc change. */
+RgResource   render_graph_add_image(VulkanContext *vk, const char *name, const RgImageDesc *desc);
+
+/* Change a transient image's description (e.g. on resize). The image is
+ * recreated by the next render_graph_compile. */
+void         render_graph_set_image_desc(VulkanContext *vk, RgResource image,
+                                         const RgImageDesc *desc);
+
+/* A logical buffer: no handle, only hazards between the passes using it.
+ * frame_local buffers are written to a region per frame slot, so nothing
+ * orders them against earlier frames. Other buffers outlive the frame, so
+ * passes writing them are never culled. */
+RgResource   render_graph_add_buffer(VulkanContext *vk, const char *name, bool frame_local);
+
+/* A pass recorded by `record`. output passes have effects outside the graph
+ * (the swapchain) and are never culled. */
+RgPass       render_graph_add_pass(VulkanContext *vk, const char *name,
+                                   RgRecordFn record, void *user, bool output);
+
+/* Declare that `pass` uses `resource` the way `access` describes */
+void         render_graph_use(VulkanContext *vk, RgPass pass, RgResource resource,
+                              RgAccess access);
+
+/* Create (or recreate) the transient images and bind them, sharing memory
+ * between images whose lifetimes don't overlap. No-op when nothing
+ * changed. The GPU must be idle if images already exist. */
+EngineResult render_graph_compile(VulkanContext *vk);
+
+/* The VkImage of a transient image, valid after render_graph_compile */
+VkImage      render_graph_image(const VulkanContext *vk, RgResource image);
+
+/* ---- Per frame ---- */
+
+/* Run `pass` this frame (passes start disabled) */
+void         render_graph_enable_pass(VulkanContext *vk, RgPass pass, bool enabled);
+
+/* Cull, then record every live pass behind the barriers it needs */
+EngineResult render_graph_execute(VulkanContext *vk, VkCommandBuffer cmd);
+
+#endif /* ENGINE_RENDER_GRAPH_H */
@@ -0,0 +1,166 @@
+#include "renderer/render_stats.h"
+#include "renderer/shadow.h"
+#include "renderer/vk_buffer.h"
+
+#include <string.h>
+
+/* ---- Per-frame counters ----
+ * Each group below mirrors one record_* helper in renderer.c: a non-empty
+ * group binds its pipeline once and pushes a new texture index whenever
+ * consecutive draws differ. Texture handles are compared directly, so an
+ * unloaded or still-loading texture (drawn as the dummy) may count a change
+ * the recorder skips. */
+
+static u32 mesh_triangles(const MeshSlot *mesh, u32 lod) {
+    if (mesh->index_count == 0) return mesh->vertex_count / 3;
+    if (lod < mesh->lod_count) return mesh->lods[lod].index_count / 3;
+    return mesh->index_count / 3;
+}
+
+static void count_draw_list(const VulkanContext *vk, const DrawList *list,
+                            RendererFrameStats *fs) {
+    if (list->count == 0) return;
+    fs->pipeline_binds++;
+
+    for (u32 i = 0; i < list->count; i++) {
+        const DrawCommand *dc = &list->items[i];
+        fs->draws++;
+        fs->instances += dc->instance_count;
+        fs->triangles += (u64)mesh_triangles(&vk->meshes[dc->mesh], dc->lod) * dc->instance_count;
+        if (i > 0 && dc->texture != list->items[i - 1].texture) fs->texture_changes++;
+    }
+}
+
+static void count_static_batches(const VulkanContext *vk, u8 view, RendererFrameStats *fs) {
+    const StaticBatchContext *sc = &vk->static_batches;
+    const StaticBatch *last = NULL;
+
+    for (u32 i = 0; i < sc->draw_count; i++) {
+        const StaticBatch *sb = &sc->batches[sc->draws[i]];
+        if (!(sb->views & view)) continue;
+
+        if (!last) fs->pipeline_binds++;
+        else if (sb->texture != last->texture) fs->texture_changes++;
+        fs->draws++;
+        fs->instances += sb->count;
+        fs->triangles += (u64)mesh_triangles(&vk->meshes[sb->mesh], 0) * sb->count;
+        last = sb;
+    }
+}
+
+/* Palette-skinned draws, or (preskinned) those the compute pre-pass already
+ * skinned, which go out one draw per instance */
+static void count_skinned(const VulkanContext *vk, bool preskinned, RendererFrameStats *fs) {
+    const SkinnedDrawList *list = &vk->draw_list_skinned;
+    const SkinnedDrawCommand *last = NULL;
+
+    for (u32 i = 0; i < list->count; i++) {
+        const SkinnedDrawCommand *dc = &list->items[i];
+        if ((dc->skinned_vertex != SKIN_COMPUTE_NONE) != preskinned) continue;
+
+        if (!last) fs->pipeline_binds++;
+        else if (dc->texture != last->texture) fs->texture_changes++;
+        fs->draws     += preskinned ? dc->instance_count : 1;
+        fs->instances += dc->instance_count;
+        fs->triangles += (u64)mesh_triangles(&vk->meshes[dc->mesh], 0) * dc->instance_count;
+        last = dc;
+    }
+}
+
+/* Bytes the CPU wrote for the GPU this frame: uploads queued into staging
+ * since the last collect, plus the per-frame rings */
+static u64 frame_upload_bytes(VulkanContext *vk) {
+    u64 bytes = vk->upload.bytes_staged - vk->stats_staged_bytes;
+    vk->stats_staged_bytes = vk->upload.bytes_staged;
+
+    u32 stride_3d = vk_instance_3d_stride(vk);
+    bytes += (u64)vk->instance_count * sizeof(InstanceData);
+    bytes += (u64)(vk->instance_3d_count + vk->instance_skinned_count) * stride_3d;
+    bytes += vk->joint_ssbo_used_bytes;
+    bytes += (u64)vk->text_vertex_count * sizeof(TextVertex);
+    bytes += sizeof(LightUniforms);
+    if (vk->multi_draw_indirect && vk->indirect_3d_capacity >= vk->indirect_3d_count) {
+        bytes += (u64)vk->indirect_3d_count * sizeof(VkDrawIndexedIndirectCommand);
+    }
+    return bytes;
+}
+
+void render_stats_collect(VulkanContext *vk) {
+    RendererStats      *st = &vk->stats;
+    RendererFrameStats  fs = {0};
+
+    /* Scene: 2D, GPU particles, 3D, static batches, skinned */
+    count_draw_list(vk, &vk->draw_list, &fs);
+    if (vk->gpu_particles.draw_count > 0) {
+        fs.pipeline_binds++;
+        fs.draws += vk->gpu_particles.draw_count;
+    }
+    count_draw_list(vk, &vk->draw_list_3d, &fs);
+    count_static_batches(vk, STATIC_BATCH_VIEW_CAMERA, &fs);
+    count_skinned(vk, true, &fs);
+    count_skinned(vk, false, &fs);
+
+    /* Each shadow cascade draws its own list, its batches and every
+     * skinned draw again */
+    if (shadow_active(vk)) {
+        for (u32 c = 0; c < SHADOW_CASCADES; c++) {
+            count_draw_list(vk, &vk->shadow.draw_lists[c], &fs);
+            count_static_batches(vk, STATIC_BATCH_VIEW_CASCADE(c), &fs);
+            count_skinned(vk, true, &fs);
+            count_skinned(vk, false, &fs);
+        }
+    }
+
+    if (vk->text_draw_count > 0) {
+        fs.pipeline_binds++;
+        fs.draws     += vk->text_draw_count;
+        fs.triangles += vk->text_drawn_vertices / 3;
+    }
+
+    fs.upload_bytes = frame_upload_bytes(vk);
+    st->frame        = fs;
+    st->frame_number = vk->frame_number;
+
+    st->instances_2d      = (RendererUsage){ vk->instance_count, vk->instance_capacity };
+    st->instances_3d      = (RendererUsage){ vk->instance_3d_count, vk->instance_3d_capacity };
+    st->instances_skinned = (RendererUsage){ vk->instance_skinned_count,
+                                             vk->instance_skinned_capacity };
+    st->joint_bytes       = (RendererUsage){ vk->joint_ssbo_used_bytes, vk->joint_ssbo_capacity };
+    st->text_vertices     = (RendererUsage){ vk->text_vertex_count, vk->text_vertex_capacity };
+}
+
+/* ---- Query ---- */
+
+static RendererUsage range_usage(const RangeAllocator *ra) {
+    return (RendererUsage){ ra->used, ra->capacity };
+}
+
+void render_stats_get(const VulkanContext *vk, RendererStats *out) {
+    *out = vk->stats;
+
+    /* Slots ever claimed minus those released for reuse */
+    out->meshes   = (RendererUsage){ vk->mesh_count - vk->mesh_handles.free_count, MAX_MESHES };
+    out->textures = (RendererUsage){ vk->texture_count - vk->texture_handles.free_count,
+                                     vk->texture_slots - 1 };
+    out->vertices_2d      = range_usage(&vk->vertex_ranges);
+    out->vertices_3d      = range_usage(&vk->vertex_3d_ranges);
+    out->vertices_skinned = range_usage(&vk->vertex_skinned_ranges);
+    out->indices          = range_usage(&vk->index_ranges);
+
+    GpuMemoryStats mem;
+    vk_memory_get_stats(vk, &mem);
+    out->gpu_memory    = (RendererUsage){ mem.used_bytes, mem.block_bytes };
+    out->heap_count    = ENGINE_MIN(mem.heap_count, (u32)RENDERER_STATS_MAX_HEAPS);
+    out->memory_budget = mem.heap_budget_valid;
+    memset(out->heaps, 0, sizeof(out->heaps));
+    for (u32 h = 0; h < out->heap_count; h++) {
+        RendererHeapStats *heap = &out->heaps[h];
+        heap->size         = mem.heap_size[h];
+        heap->reserved     = mem.heap_block_bytes[h];
+        heap->device_local = (mem.heap_flags[h] & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+        if (mem.heap_budget_valid) {
+            heap->budget = mem.heap_budget[h];
+            heap->usage  = mem.heap_usage[h];
+        }
+    }
+}
@@ -0,0 +1,16 @@
+#ifndef ENGINE_RENDER_STATS_H
+#define ENGINE_RENDER_STATS_H
+
+#include "renderer/vk_types.h"
+#include "core/common.h"
+
+/* Count the frame's draws from its final draw lists into vk->stats, and
+ * snapshot the per-frame ring usage before begin_frame resets it. Call in
+ * end_frame once the command buffer is recorded (text counts come from
+ * recording); one serial pass over the lists, the recorders stay untouched. */
+void render_stats_collect(VulkanContext *vk);
+
+/* The collected counters plus current resource usage and device memory */
+void render_stats_get(const VulkanContext *vk, RendererStats *out);
+
+#endif /* ENGINE_RENDER_STATS_H */
@@ -2,25 +2,55 @@
 #include "renderer/renderer.h"
 #include "renderer/vk_init.h"
 #include "renderer/vk_pipeline.h"
+#include "renderer/skin_compute.h"
+#include "renderer/gpu_particles.h"
+#include "renderer/static_batch.h"
+#include "renderer/shadow.h"
+#include "renderer/light_cluster.h"
+#include "renderer/frame_pacing.h"
+#include "renderer/async_compute.h"
+#include "renderer/gpu_profiler.h"
+#include "renderer/render_stats.h"
+#include "renderer/sprite_batch.h"
 #include "renderer/vk_buffer.h"
+#include "renderer/vk_upload.h"
 #include "renderer/bloom.h"
+#include "renderer/render_graph.h"
 #include "renderer/text.h"
 #include "renderer/skinned_model.h"
+#include "renderer/asset_load.h"
+#include "renderer/resource_table.h"
 #include "platform/window.h"
 #include "core/log.h"
+#include "core/jobs.h"
+#include "core/profile.h"
 
 #include <cglm/mat4.h>
 #include <cglm/cam.h>
 #include <cglm/affine.h>
+#include <cglm/frustum.h>
 
 #include "stb/stb_image.h"
 
+#include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-#define MAX_INSTANCES              4096
+#define INITIAL_INSTANCE_CAPACITY  4096   /* per frame; instance rings grow on demand */
+#define FRAME_ARENA_INITIAL_SIZE   (256 * 1024)
+#define UPLOAD_STAGING_SIZE        (16 * 1024 * 1024)
 #define MAX_VERTICES               65536
 #define CAMERA_DEFAULT_HALF_HEIGHT 10.0f
+#define PIPELINE_CACHE_PATH        "pipeline_cache.bin"
+
+/* The frame's render graph passes (RG_NONE when not registered) */
+typedef struct {
+    RgPass skin, particles, light_cull;   /* only without async compute */
+    RgPass shadow;
+    RgPass scene;                         /* straight to the swapchain */
+    RgPass scene_hdr, bloom_down, bloom_up, composite;
+} FramePasses;
 
 struct Renderer {
     VulkanContext vk;
@@ -28,8 +58,47 @@ struct Renderer {
     u32           current_image_index; /* set by begin_frame, used by end_frame */
     f32           clear_color[4];      /* r, g, b, a */
     BloomSettings bloom_settings;      /* current bloom config */
+    bool          dynamic_resolution;  /* scale the bloom scene target to hold a budget */
+    f32           dynres_target_ms;    /* GPU frame-time budget */
+    f32           dynres_avg_ms;       /* smoothed GPU scene time, 0 until measured */
+    u64           dynres_frame;        /* frame of the last timings applied */
+    FramePasses   passes;
 };
 
+/* --------------------------------------------------------------------------
+ * Render graph images
+ * ------------------------------------------------------------------------ */
+
+/* Create the graph's images if anything changed, then point every view,
+ * framebuffer and descriptor that uses them at the new ones. The GPU must be
+ * idle. */
+static EngineResult bind_graph_images(VulkanContext *vk) {
+    EngineResult res;
+    if ((res = render_graph_compile(vk)) != ENGINE_SUCCESS) return res;
+    if ((res = bloom_bind_targets(vk))   != ENGINE_SUCCESS) return res;
+    if ((res = shadow_bind_map(vk))      != ENGINE_SUCCESS) return res;
+
+    /* Light set binding 1: the shadow map, in the layout the scene pass
+     * samples it in */
+    VkDescriptorImageInfo shadow_info = {
+        .sampler     = vk->shadow.sampler,
+        .imageView   = vk->shadow.array_view,
+        .imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+    };
+    for (u32 i = 0; i < vk->frames_in_flight; i++) {
+        VkWriteDescriptorSet write = {
+            .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet          = vk->light_desc_sets[i],
+            .dstBinding      = 1,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = 1,
+            .pImageInfo      = &shadow_info,
+        };
+        vkUpdateDescriptorSets(vk->device, 1, &write, 0, NULL);
+    }
+    return ENGINE_SUCCESS;
+}
+
 /* --------------------------------------------------------------------------
  * Swapchain recreation (for resize)
  * ------------------------------------------------------------------------ */
@@ -46,63 +115,821 @@ static EngineResult recreate_swapchain(Renderer *r) {
 
     vkDeviceWaitIdle(r->vk.device);
 
-    /* Destroy bloom resources that depend on swapchain image views FIRST */
-    if (r->vk.bloom.enabled) {
-        bloom_cleanup_swapchain_deps(&r->vk);
-    }
+    /* Destroy bloom resources that depend on swapchain image views FIRST.
+     * Done even with bloom off: its framebuffers share the depth view, and
+     * enabling bloom later must find them at the current size. */
+    bloom_cleanup_swapchain_deps(&r->vk);
 
     vk_cleanup_swapchain(&r->vk);
 
     EngineResult res;
     if ((res = vk_create_swapchain(&r->vk, width, height)) != ENGINE_SUCCESS) return res;
+    frame_pacing_swapchain_reset(&r->vk);
     if ((res = vk_create_image_views(&r->vk))               != ENGINE_SUCCESS) return res;
     if ((res = vk_create_depth_resources(&r->vk))            != ENGINE_SUCCESS) return res;
     if ((res = vk_create_framebuffers(&r->vk))               != ENGINE_SUCCESS) return res;
 
-    /* Recreate bloom size-dependent resources */
-    if (r->vk.bloom.enabled) {
-        if ((res = bloom_resize(&r->vk)) != ENGINE_SUCCESS) return res;
-    }
+    /* Resize the bloom targets, then rebuild everything over the graph's
+     * images (the shadow map's views too, should its memory have moved) */
+    if ((res = bloom_resize(&r->vk))      != ENGINE_SUCCESS) return res;
+    if ((res = bind_graph_images(&r->vk)) != ENGINE_SUCCESS) return res;
 
     LOG_INFO("Swapchain recreated: %dx%d", width, height);
     return ENGINE_SUCCESS;
 }
 
+/* --------------------------------------------------------------------------
+ * Per-frame storage: growable draw lists and instance/joint ring buffers
+ * ------------------------------------------------------------------------ */
+
+/* Grow a draw list so it holds at least `needed` items (capacity doubles).
+ * Storage comes from the frame arena, which chains another block when full. */
+static bool frame_list_reserve(VulkanContext *vk, void **items, u32 *capacity,
+                               u32 count, u32 needed, size_t item_size) {
+    if (needed <= *capacity) return true;
+
+    u32 new_cap = (*capacity > 0) ? *capacity : 64;
+    while (new_cap < needed) new_cap *= 2;
+
+    void *new_items = arena_alloc_nozero(&vk->frame_arena, (size_t)new_cap * item_size, 16);
+    if (!new_items) {
+        LOG_ERROR("Out of memory growing draw list to %u entries", new_cap);
+        return false;
+    }
+    if (count > 0) memcpy(new_items, *items, (size_t)count * item_size);
+
+    *items    = new_items;
+    *capacity = new_cap;
+    return true;
+}
+
+#define draw_list_reserve(vk, list, needed) \
+    frame_list_reserve((vk), (void **)&(list)->items, &(list)->capacity, \
+                       (list)->count, (needed), sizeof(*(list)->items))
+
+#define draw_list_release(list) memset((list), 0, sizeof(*(list)))
+
+/* Reset the draw lists for a new frame. Blocks the arena chained last frame
+ * are kept and reused, and each list is pre-sized to last frame's count, so
+ * the steady state costs one bump allocation per list and no heap traffic. */
+static void frame_storage_reset(VulkanContext *vk) {
+    u32 prev_2d      = vk->draw_list.count;
+    u32 prev_3d      = vk->draw_list_3d.count;
+    u32 prev_skinned = vk->draw_list_skinned.count;
+    u32 prev_shadow[SHADOW_CASCADES];
+
+    draw_list_release(&vk->draw_list);
+    draw_list_release(&vk->draw_list_3d);
+    draw_list_release(&vk->draw_list_skinned);
+    for (u32 c = 0; c < SHADOW_CASCADES; c++) {
+        prev_shadow[c] = vk->shadow.draw_lists[c].count;
+        draw_list_release(&vk->shadow.draw_lists[c]);
+    }
+
+    arena_reset(&vk->frame_arena);
+
+    draw_list_reserve(vk, &vk->draw_list,         ENGINE_MAX(prev_2d, INITIAL_DRAW_COMMANDS));
+    draw_list_reserve(vk, &vk->draw_list_3d,      ENGINE_MAX(prev_3d, INITIAL_DRAW_COMMANDS));
+    draw_list_reserve(vk, &vk->draw_list_skinned, ENGINE_MAX(prev_skinned, INITIAL_SKINNED_DRAW_COMMANDS));
+    for (u32 c = 0; c < SHADOW_CASCADES; c++) {
+        if (prev_shadow[c] > 0) draw_list_reserve(vk, &vk->shadow.draw_lists[c], prev_shadow[c]);
+    }
+}
+
+/* Destroy retired rings that no in-flight frame can still reference.
+ * A ring replaced during frame R was last read by frame R-1; once the fence
+ * for frame F - frames_in_flight has been waited on, everything up to that
+ * frame is done, so the ring is free when F >= R + frames_in_flight - 1. */
+static void release_retired_rings(VulkanContext *vk, bool force) {
+    u32 kept = 0;
+    for (u32 i = 0; i < vk->retired_ring_count; i++) {
+        RetiredRing *rr = &vk->retired_rings[i];
+        if (force || vk->frame_number + 1 >= rr->retire_frame + vk->frames_in_flight) {
+            if (rr->desc_set)
+                vkFreeDescriptorSets(vk->device, rr->desc_pool, 1, &rr->desc_set);
+            vk_destroy_frame_ring(vk, &rr->ring);
+        } else {
+            vk->retired_rings[kept++] = *rr;
+        }
+    }
+    vk->retired_ring_count = kept;
+}
+
+static void retire_ring(VulkanContext *vk, const FrameRing *ring,
+                        VkDescriptorPool desc_pool, VkDescriptorSet desc_set) {
+    if (vk->retired_ring_count >= MAX_RETIRED_RINGS) {
+        /* Many grows in a short window: drain the GPU once and free them all */
+        vkDeviceWaitIdle(vk->device);
+        release_retired_rings(vk, true);
+    }
+
+    RetiredRing *rr  = &vk->retired_rings[vk->retired_ring_count++];
+    rr->ring         = *ring;
+    rr->desc_pool    = desc_pool;
+    rr->desc_set     = desc_set;
+    rr->retire_frame = vk->frame_number;
+}
+
+/* Make sure an instance (or indirect record) ring can hold `needed` items this
+ * frame. On growth the items already written this frame are carried over and
+ * the old ring retired. */
+static bool instance_ring_reserve(VulkanContext *vk, FrameRing *ring, u32 *capacity,
+                                  u32 used, u32 needed, size_t item_size) {
+    if (needed <= *capacity) return true;
+
+    u32 new_cap = (*capacity > 0) ? *capacity * 2 : INITIAL_INSTANCE_CAPACITY;
+    while (new_cap < needed) new_cap *= 2;
+
+    FrameRing old;
+    if (vk_frame_ring_grow(vk, ring, (VkDeviceSize)new_cap * item_size,
+                           (VkDeviceSize)used * item_size, &old) != ENGINE_SUCCESS) {
+        LOG_ERROR("Failed to grow instance buffer to %u instances", new_cap);
+        return false;
+    }
+    retire_ring(vk, &old, VK_NULL_HANDLE, VK_NULL_HANDLE);
+
+    *capacity = (u32)(ring->frame_size / item_size);
+    LOG_INFO("Ring buffer grown to %u items per frame", *capacity);
+    return true;
+}
+
+/* Allocate a joint SSBO descriptor set pointing at the current joint ring.
+ * Range is one frame region; the region is chosen by the dynamic offset. */
+static EngineResult alloc_joint_desc_set(VulkanContext *vk, VkDescriptorSet *out_set) {
+    VkDescriptorSetAllocateInfo alloc_info = {
+        .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool     = vk->joint_desc_pool,
+        .descriptorSetCount = 1,
+        .pSetLayouts        = &vk->joint_desc_set_layout,
+    };
+    if (vkAllocateDescriptorSets(vk->device, &alloc_info, out_set) != VK_SUCCESS) {
+        LOG_ERROR("Failed to allocate joint descriptor set");
+        return ENGINE_ERROR_VULKAN_INIT;
+    }
+
+    VkDescriptorBufferInfo buf_info = {
+        .buffer = vk->joint_ring.buffer,
+        .offset = 0,
+        .range  = vk->joint_ring.frame_size,
+    };
+    VkWriteDescriptorSet write = {
+        .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet          = *out_set,
+        .dstBinding      = 0,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+        .descriptorCount = 1,
+        .pBufferInfo     = &buf_info,
+    };
+    vkUpdateDescriptorSets(vk->device, 1, &write, 0, NULL);
+    return ENGINE_SUCCESS;
+}
+
+/* Make sure the joint ring holds `needed_bytes` this frame. Growing also
+ * needs a fresh descriptor set, since the old one may be bound by an
+ * in-flight command buffer; both are retired together. */
+static bool joint_ring_reserve(VulkanContext *vk, u32 needed_bytes) {
+    if (needed_bytes <= vk->joint_ssbo_capacity) return true;
+
+    VkDeviceSize new_size = (VkDeviceSize)vk->joint_ssbo_capacity * 2;
+    while (new_size < needed_bytes) new_size *= 2;
+
+    FrameRing old_ring;
+    if (vk_frame_ring_grow(vk, &vk->joint_ring, new_size,
+                           vk->joint_ssbo_used_bytes, &old_ring) != ENGINE_SUCCESS) {
+        LOG_ERROR("Failed to grow joint SSBO to %llu bytes", (unsigned long long)new_size);
+        return false;
+    }
+
+    VkDescriptorSet old_set = vk->joint_desc_set;
+    if (alloc_joint_desc_set(vk, &vk->joint_desc_set) != ENGINE_SUCCESS) {
+        /* Keep using the old ring rather than leaving the set dangling */
+        vk_destroy_frame_ring(vk, &vk->joint_ring);
+        vk->joint_ring     = old_ring;
+        vk->joint_desc_set = old_set;
+        return false;
+    }
+    retire_ring(vk, &old_ring, vk->joint_desc_pool, old_set);
+
+    vk->joint_ssbo_capacity = (u32)vk->joint_ring.frame_size;
+    LOG_INFO("Joint SSBO grown to %u KB per frame", vk->joint_ssbo_capacity / 1024);
+    return true;
+}
+
+/* ---- Bindless texture table ---- */
+
+/* Write slots [first, first + count) of a texture table set. Slot 0 is the
+ * dummy texture, slot h + 1 is texture handle h; `dummy_fill` writes the
+ * dummy into every slot of the range instead. */
+static void texture_table_write(VulkanContext *vk, VkDescriptorSet set,
+                                u32 first, u32 count, bool dummy_fill) {
+    VkDescriptorImageInfo infos[64];
+    while (count > 0) {
+        u32 n = ENGINE_MIN(count, (u32)ENGINE_ARRAY_LEN(infos));
+        for (u32 k = 0; k < n; k++) {
+            u32 slot = first + k;
+            const VulkanTexture *tex = (dummy_fill || slot == 0 ||
+                                        !vk->texture_handles.live[slot - 1] ||
+                                        vk->textures[slot - 1].placeholder)
+                ? &vk->dummy_texture : &vk->textures[slot - 1];
+            infos[k] = (VkDescriptorImageInfo){
+                .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                .imageView   = tex->view,
+                .sampler     = tex->sampler,
+            };
+        }
+        VkWriteDescriptorSet write = {
+            .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet          = set,
+            .dstBinding      = 0,
+            .dstArrayElement = first,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = n,
+            .pImageInfo      = infos,
+        };
+        vkUpdateDescriptorSets(vk->device, 1, &write, 0, NULL);
+        first += n;
+        count -= n;
+    }
+}
+
+/* Allocate the texture table set(s) and write the dummy into slot 0. Without
+ * partially-bound descriptors every slot must be valid, so the per-frame sets
+ * are filled with the dummy up front. */
+static EngineResult texture_table_create(VulkanContext *vk) {
+    u32 set_count = vk->texture_update_after_bind ? 1 : vk->frames_in_flight;
+    VkDescriptorSetLayout layouts[MAX_FRAMES_IN_FLIGHT];
+    for (u32 i = 0; i < set_count; i++) layouts[i] = vk->geo_desc_set_layout;
+
+    VkDescriptorSetAllocateInfo alloc_info = {
+        .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool     = vk->geo_desc_pool,
+        .descriptorSetCount = set_count,
+        .pSetLayouts        = layouts,
+    };
+    if (vkAllocateDescriptorSets(vk->device, &alloc_info, vk->texture_table) != VK_SUCCESS) {
+        LOG_FATAL("Failed to allocate texture table");
+        return ENGINE_ERROR_VULKAN_INIT;
+    }
+
+    for (u32 i = 0; i < set_count; i++) {
+        if (vk->texture_update_after_bind) {
+            texture_table_write(vk, vk->texture_table[i], 0, 1, true);
+        } else {
+            texture_table_write(vk, vk->texture_table[i], 0, vk->texture_slots, true);
+        }
+        vk->texture_table_written[i] = 1;
+    }
+    return ENGINE_SUCCESS;
+}
+
+/* Publish textures loaded since this frame's table set was last written.
+ * The update-after-bind set only gains new slots, which in-flight frames do
+ * not read; a per-frame set is idle once the frame's fence has signalled.
+ * Slots marked stale are rewritten too: async loads that finished after
+ * their slot was written with the dummy, unloaded textures (back to the
+ * dummy) and released slots handed out again. */
+static void texture_table_sync(VulkanContext *vk) {
+    u32 idx = vk->texture_update_after_bind ? 0 : vk->current_frame;
+
+    if (vk->texture_table_stale > 0) {
+        u8 bit = (u8)(1u << idx);
+        for (u32 h = 0; h < vk->texture_count; h++) {
+            if (!(vk->texture_stale[h] & bit)) continue;
+            texture_table_write(vk, vk->texture_table[idx], h + 1, 1, false);
+            vk->texture_stale[h] &= (u8)~bit;
+            if (!vk->texture_stale[h]) vk->texture_table_stale--;
+        }
+    }
+
+    u32 used = vk->texture_count + 1;
+    u32 written = vk->texture_table_written[idx];
+    if (written >= used) return;
+
+    texture_table_write(vk, vk->texture_table[idx], written, used - written, false);
+    vk->texture_table_written[idx] = used;
+}
+
+/* Make room for one more draw command and `instance_count` more instances.
+ * Returns how many instances fit (0 = drop the draw). */
+static u32 queue_draw_reserve(VulkanContext *vk, DrawList *list,
+                              FrameRing *ring, u32 *inst_count, u32 *inst_capacity,
+                              size_t inst_size, u32 instance_count) {
+    if (!draw_list_reserve(vk, list, list->count + 1)) return 0;
+
+    if (!instance_ring_reserve(vk, ring, inst_capacity, *inst_count,
+                               *inst_count + instance_count, inst_size)) {
+        /* Growth failed: fall back to clamping into what is left */
+        u32 remaining = *inst_capacity - *inst_count;
+        LOG_WARN("Instance buffer full (%u/%u), clamping",
+                 *inst_count + instance_count, *inst_capacity);
+        instance_count = remaining;
+    }
+    return instance_count;
+}
+
+static void queue_draw_commit(DrawList *list, u32 mesh, TextureHandle texture,
+                              u32 inst_offset, u32 instance_count, u32 lod) {
+    DrawCommand *dc = &list->items[list->count++];
+    dc->mesh            = mesh;
+    dc->texture         = texture;
+    dc->instance_offset = inst_offset;
+    dc->instance_count  = instance_count;
+    dc->lod             = lod;
+}
+
+/* Take instance_count instances (already reserved) from the ring and queue
+ * one draw command for them. Returns where the instances go in the mapped
+ * region. */
+static void *queue_draw_alloc(DrawList *list, FrameRing *ring, u32 *inst_count,
+                              size_t inst_size, u32 mesh, TextureHandle texture,
+                              u32 instance_count) {
+    u32 inst_offset = *inst_count;
+    *inst_count += instance_count;
+    queue_draw_commit(list, mesh, texture, inst_offset, instance_count, 0);
+    return ring->mapped + ring->frame_offset + (size_t)inst_offset * inst_size;
+}
+
+/* Append instances to a per-frame ring and queue one draw command for them.
+ * Shared by the 2D and 3D draw paths (validation happens in the callers). */
+static void queue_draw(VulkanContext *vk, DrawList *list,
+                       FrameRing *ring, u32 *inst_count, u32 *inst_capacity,
+                       size_t inst_size, u32 mesh, TextureHandle texture,
+                       const void *instances, u32 instance_count) {
+    instance_count = queue_draw_reserve(vk, list, ring, inst_count, inst_capacity,
+                                        inst_size, instance_count);
+    if (instance_count == 0) return;
+
+    void *dst = queue_draw_alloc(list, ring, inst_count, inst_size, mesh, texture,
+                                 instance_count);
+    memcpy(dst, instances, inst_size * instance_count);
+}
+
+/* queue_draw without the copy: the caller fills the returned instances. All
+ * or nothing, so the caller never writes past what the draw covers. */
+static void *queue_draw_in_place(VulkanContext *vk, DrawList *list,
+                                 FrameRing *ring, u32 *inst_count, u32 *inst_capacity,
+                                 size_t inst_size, u32 mesh, TextureHandle texture,
+                                 u32 instance_count) {
+    u32 room = queue_draw_reserve(vk, list, ring, inst_count, inst_capacity,
+                                  inst_size, instance_count);
+    if (room < instance_count) return NULL;
+    return queue_draw_alloc(list, ring, inst_count, inst_size, mesh, texture, instance_count);
+}
+
+/* --------------------------------------------------------------------------
+ * Frustum culling (3D instances)
+ *
+ * Instances are tested on the CPU as they are copied into the ring, so
+ * off-screen instances cost neither upload bandwidth nor vertex work. The
+ * test uses the 3D camera active at submission time.
+ * ------------------------------------------------------------------------ */
+
+/* World-space bounding sphere of the instance: returns the radius and the
+ * centre in out_center */
+static f32 instance_bounds(const MeshSlot *slot, const InstanceData3D *inst,
+                           f32 out_center[3]) {
+    const f32 *s = inst->scale;
+    f32 max_scale = fmaxf(fabsf(s[0]), fmaxf(fabsf(s[1]), fabsf(s[2])));
+    f32 radius = slot->bounds_radius * max_scale;
+
+    /* World-space centre: same scale -> rotate (Ry * Rx * Rz) -> translate as mesh3d.vert */
+    f32 c[3] = { inst->position[0], inst->position[1], inst->position[2] };
+    const f32 *bc = slot->bounds_center;
+    if (bc[0] != 0.0f || bc[1] != 0.0f || bc[2] != 0.0f) {
+        f32 x = bc[0] * s[0], y = bc[1] * s[1], z = bc[2] * s[2];
+        f32 cp = cosf(inst->rotation[0]), sp = sinf(inst->rotation[0]);
+        f32 cy = cosf(inst->rotation[1]), sy = sinf(inst->rotation[1]);
+        f32 cr = cosf(inst->rotation[2]), sr = sinf(inst->rotation[2]);
+        c[0] += (cy*cr + sy*sp*sr) * x + (-cy*sr + sy*sp*cr) * y + (sy*cp) * z;
+        c[1] += (cp*sr) * x         + (cp*cr) * y            + (-sp) * z;
+        c[2] += (-sy*cr + cy*sp*sr) * x + (sy*sr + cy*sp*cr) * y + (cy*cp) * z;
+    }
+    memcpy(out_center, c, sizeof(c));
+    return radius;
+}
+
+static bool sphere_in_planes(const f32 planes[6][4], const f32 c[3], f32 radius) {
+    for (u32 i = 0; i < 6; i++) {
+        const f32 *p = planes[i];
+        if (p[0] * c[0] + p[1] * c[1] + p[2] * c[2] + p[3] < -radius) return false;
+    }
+    return true;
+}
+
+/* Returns the world-space bounding sphere radius of the instance (0 if it is
+ * outside the frustum) and its centre in out_center. */
+static f32 instance_in_frustum(const VulkanContext *vk, const MeshSlot *slot,
+                               const InstanceData3D *inst, f32 out_center[3]) {
+    f32 radius = instance_bounds(slot, inst, out_center);
+    if (!sphere_in_planes(vk->frustum_planes, out_center, radius)) return 0.0f;
+    return fmaxf(radius, 1e-6f);
+}
+
+/* --------------------------------------------------------------------------
+ * Mesh LOD selection
+ *
+ * Screen size is the bounding sphere's radius over the half-height of the
+ * view at its distance; level i is used while the size is at least
+ * MESH_LOD_SCREEN_SIZE[i], the last level below that.
+ * ------------------------------------------------------------------------ */
+
+static const f32 MESH_LOD_SCREEN_SIZE[MESH_MAX_LODS - 1] = { 0.25f, 0.10f, 0.04f };
+
+static u32 select_mesh_lod(const VulkanContext *vk, const MeshSlot *slot,
+                           const f32 center[3], f32 radius) {
+    f32 dx = center[0] - vk->view_position[0];
+    f32 dy = center[1] - vk->view_position[1];
+    f32 dz = center[2] - vk->view_position[2];
+    f32 dist = sqrtf(dx * dx + dy * dy + dz * dz);
+    if (dist <= radius) return 0;
+
+    f32 size = radius * vk->lod_projection_scale / dist;
+    u32 lod = 0;
+    while (lod + 1 < slot->lod_count && size < MESH_LOD_SCREEN_SIZE[lod]) lod++;
+    return lod;
+}
+
+/* queue_draw_3d while shadows are on. Every instance seen by the camera or a
+ * cascade is written once, grouped by level and by the set of views that
+ * see it, and each view queues the groups it sees: the camera's groups come
+ * last within a level, so it still gets one draw per level, and cascade
+ * draws of neighbouring groups merge in batch_draw_lists. Casters use the
+ * camera's LOD so their shadows match what is drawn. */
+#define SHADOW_VIEW_CAMERA (1u << SHADOW_CASCADES)  /* above the cascade bits */
+#define SHADOW_VIEW_GROUPS (2u << SHADOW_CASCADES)
+
+static void queue_draw_3d_shadowed(VulkanContext *vk, u32 mesh, TextureHandle texture,
+                                   const InstanceData3D *instances, u32 instance_count,
+                                   u32 room) {
+    ShadowContext *sh = &vk->shadow;
+    const MeshSlot *slot = &vk->meshes[mesh];
+    size_t stride = vk_instance_3d_stride(vk);
+    u8 *ring = vk->instance_ring_3d.mapped + vk->instance_ring_3d.frame_offset;
+
+    enum { CHUNK = 1024, CULLED = 0xFF, GROUPS = MESH_MAX_LODS * SHADOW_VIEW_GROUPS };
+    _Static_assert(GROUPS <= CULLED, "group index must fit in a byte");
+    u8 group_of[CHUNK];
+
+    for (u32 base = 0; base < instance_count && room > 0; base += CHUNK) {
+        u32 n = ENGINE_MIN(instance_count - base, (u32)CHUNK);
+        u32 group_count[GROUPS] = {0};
+        u32 visible = 0;
+        for (u32 i = 0; i < n && visible < room; i++) {
+            f32 center[3];
+            f32 radius = instance_bounds(slot, &instances[base + i], center);
+            u32 views = sphere_in_planes(vk->frustum_planes, center, radius) ? SHADOW_VIEW_CAMERA : 0;
+            for (u32 c = 0; c < SHADOW_CASCADES; c++) {
+                if (sphere_in_planes(sh->planes[c], center, radius)) views |= 1u << c;
+            }
+            if (views == 0) {
+                group_of[i] = CULLED;
+                continue;
+            }
+            u32 lod = select_mesh_lod(vk, slot, center, fmaxf(radius, 1e-6f));
+            u32 g = lod * SHADOW_VIEW_GROUPS + views;
+            group_of[i] = (u8)g;
+            group_count[g]++;
+            visible++;
+        }
+        if (visible == 0) continue;
+
+        /* Worst case: a draw per level for the camera, a draw per group
+         * containing the cascade for each cascade */
+        if (!draw_list_reserve(vk, &vk->draw_list_3d, vk->draw_list_3d.count + MESH_MAX_LODS)) {
+            return;
+        }
+        for (u32 c = 0; c < SHADOW_CASCADES; c++) {
+            DrawList *list = &sh->draw_lists[c];
+            if (!draw_list_reserve(vk, list, list->count + GROUPS / 2)) return;
+        }
+
+        u32 cursor[GROUPS];
+        u32 offset = vk->instance_3d_count;
+        for (u32 l = 0; l < slot->lod_count; l++) {
+            u32 camera_first = 0, camera_count = 0;
+            for (u32 v = 1; v < SHADOW_VIEW_GROUPS; v++) {
+                u32 g = l * SHADOW_VIEW_GROUPS + v;
+                cursor[g] = offset;
+                if (group_count[g] == 0) continue;
+
+                if (v & SHADOW_VIEW_CAMERA) {
+                    if (camera_count == 0) camera_first = offset;
+                    camera_count += group_count[g];
+                }
+                for (u32 c = 0; c < SHADOW_CASCADES; c++) {
+                    if (v & (1u << c)) {
+                        queue_draw_commit(&sh->draw_lists[c], mesh, TEXTURE_HANDLE_INVALID,
+                                          offset, group_count[g], l);
+                    }
+                }
+                offset += group_count[g];
+            }
+            if (camera_count > 0) {
+                queue_draw_commit(&vk->draw_list_3d, mesh, texture, camera_first, camera_count, l);
+            }
+        }
+        for (u32 i = 0, written = 0; i < n && written < visible; i++) {
+            if (group_of[i] == CULLED) continue;
+            vk_write_instances_3d(vk, ring + cursor[group_of[i]]++ * stride, &instances[base + i], 1);
+            written++;
+        }
+
+        vk->instance_3d_count += visible;
+        room -= visible;
+    }
+}
+
+/* queue_draw for the 3D list, dropping instances outside the camera frustum.
+ * Survivors are written contiguously, so one draw command still covers them. */
+static void queue_draw_3d(VulkanContext *vk, u32 mesh, TextureHandle texture,
+                          const InstanceData3D *instances, u32 instance_count) {
+    size_t stride = vk_instance_3d_stride(vk);
+    u32 room = queue_draw_reserve(vk, &vk->draw_list_3d, &vk->instance_ring_3d,
+                                  &vk->instance_3d_count, &vk->instance_3d_capacity,
+                                  stride, instance_count);
+    if (room == 0) return;
+
+    if (!vk->frustum_valid) {
+        void *dst = queue_draw_alloc(&vk->draw_list_3d, &vk->instance_ring_3d,
+                                     &vk->instance_3d_count, stride, mesh, texture, room);
+        vk_write_instances_3d(vk, dst, instances, room);
+        return;
+    }
+    if (shadow_active(vk)) {
+        queue_draw_3d_shadowed(vk, mesh, texture, instances, instance_count, room);
+        return;
+    }
+
+    const MeshSlot *slot = &vk->meshes[mesh];
+    u8 *ring = vk->instance_ring_3d.mapped + vk->instance_ring_3d.frame_offset;
+
+    if (slot->lod_count <= 1) {
+        u32 inst_offset = vk->instance_3d_count;
+        u32 visible = 0;
+        f32 center[3];
+        for (u32 i = 0; i < instance_count && visible < room; i++) {
+            if (instance_in_frustum(vk, slot, &instances[i], center) > 0.0f) {
+                vk_write_instances_3d(vk, ring + (inst_offset + visible++) * stride,
+                                      &instances[i], 1);
+            }
+        }
+        if (visible == 0) return;
+
+        vk->instance_3d_count += visible;
+        queue_draw_commit(&vk->draw_list_3d, mesh, texture, inst_offset, visible, 0);
+        return;
+    }
+
+    /* With LODs, each chunk of instances is classified first and then
+     * written grouped by level, one draw command per level present. The
+     * ring is write-only, so the grouping cannot happen after the copy. */
+    enum { LOD_CHUNK = 1024, LOD_CULLED = 0xFF };
+    u8 lod_of[LOD_CHUNK];
+
+    for (u32 base = 0; base < instance_count && room > 0; base += LOD_CHUNK) {
+        u32 n = ENGINE_MIN(instance_count - base, (u32)LOD_CHUNK);
+        u32 level_count[MESH_MAX_LODS] = {0};
+        u32 visible = 0;
+        for (u32 i = 0; i < n && visible < room; i++) {
+            f32 center[3];
+            f32 radius = instance_in_frustum(vk, slot, &instances[base + i], center);
+            if (radius > 0.0f) {
+                u32 lod = select_mesh_lod(vk, slot, center, radius);
+                lod_of[i] = (u8)lod;
+                level_count[lod]++;
+                visible++;
+            } else {
+                lod_of[i] = LOD_CULLED;
+            }
+        }
+        if (visible == 0) continue;
+
+        /* The draw list needs one entry per level beyond the reserved one */
+        if (!draw_list_reserve(vk, &vk->draw_list_3d, vk->draw_list_3d.count + MESH_MAX_LODS)) {
+            return;
+        }
+
+        u32 cursor[MESH_MAX_LODS];
+        u32 offset = vk->instance_3d_count;
+        for (u32 l = 0; l < slot->lod_count; l++) {
+            cursor[l] = offset;
+            if (level_count[l] > 0) {
+                queue_draw_commit(&vk->draw_list_3d, mesh, texture, offset, level_count[l], l);
+            }
+            offset += level_count[l];
+        }
+        for (u32 i = 0, written = 0; i < n && written < visible; i++) {
+            if (lod_of[i] == LOD_CULLED) continue;
+            vk_write_instances_3d(vk, ring + cursor[lod_of[i]]++ * stride, &instances[base + i], 1);
+            written++;
+        }
+
+        vk->instance_3d_count += visible;
+        room -= visible;
+    }
+}
+
+/* Queue each sprite atlas page's batch as one instanced 2D draw */
+static void flush_sprite_batches(VulkanContext *vk) {
+    SpriteContext *sc = &vk->sprites;
+    for (u32 p = 0; p < sc->page_count; p++) {
+        SpritePage *page = &sc->pages[p];
+        if (page->instance_count == 0) continue;
+
+        queue_draw(vk, &vk->draw_list, &vk->instance_ring,
+                   &vk->instance_count, &vk->instance_capacity, sizeof(InstanceData),
+                   HANDLE_SLOT(sc->quad_mesh), page->texture, page->instances, page->instance_count);
+        page->instance_count = 0;
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Draw list batching
+ *
+ * Runs once per frame before recording. Merging only ever joins draws whose
+ * instance ranges are already contiguous in the ring, so no instance data is
+ * moved (the rings are write-combined and must not be read back).
+ *
+ * The 2D list keeps submission order: sprites share a depth plane and rely
+ * on painter's order for blending. The 3D and skinned lists are depth-tested,
+ * so they are sorted by (texture, mesh) to group state changes. Ties fall
+ * back to instance_offset, which keeps the order deterministic and puts
+ * back-to-back submissions of the same mesh next to each other.
+ * ------------------------------------------------------------------------ */
+
+static int compare_draw_commands(const void *a, const void *b) {
+    const DrawCommand *da = a;
+    const DrawCommand *db = b;
+    if (da->texture != db->texture) return da->texture < db->texture ? -1 : 1;
+    if (da->mesh != db->mesh)       return da->mesh < db->mesh ? -1 : 1;
+    if (da->lod != db->lod)         return da->lod < db->lod ? -1 : 1;
+    if (da->instance_offset != db->instance_offset)
+        return da->instance_offset < db->instance_offset ? -1 : 1;
+    return 0;
+}
+
+static int compare_skinned_draw_commands(const void *a, const void *b) {
+    const SkinnedDrawCommand *da = a;
+    const SkinnedDrawCommand *db = b;
+    if (da->texture != db->texture) return da->texture < db->texture ? -1 : 1;
+    if (da->mesh != db->mesh)       return da->mesh < db->mesh ? -1 : 1;
+    if (da->instance_offset != db->instance_offset)
+        return da->instance_offset < db->instance_offset ? -1 : 1;
+    return 0;
+}
+
+/* Fold neighbouring commands with the same mesh + texture and contiguous
+ * instance ranges into one instanced draw. Returns the new count. */
+static u32 merge_draw_commands(DrawCommand *items, u32 count) {
+    if (count == 0) return 0;
+
+    u32 out = 0;
+    for (u32 i = 1; i < count; i++) {
+        DrawCommand *last = &items[out];
+        const DrawCommand *dc = &items[i];
+        if (dc->mesh == last->mesh && dc->texture == last->texture && dc->lod == last->lod &&
+            dc->instance_offset == last->instance_offset + last->instance_count) {
+            last->instance_count += dc->instance_count;
+        } else {
+            items[++out] = *dc;
+        }
+    }
+    return out + 1;
+}
+
+static void sort_merge_draw_list(DrawList *list) {
+    if (list->count > 1) {
+        qsort(list->items, list->count, sizeof(DrawCommand), compare_draw_commands);
+    }
+    list->count = merge_draw_commands(list->items, list->count);
+}
+
+static void batch_draw_lists(VulkanContext *vk) {
+    vk->draw_list.count = merge_draw_commands(vk->draw_list.items, vk->draw_list.count);
+
+    sort_merge_draw_list(&vk->draw_list_3d);
+    for (u32 c = 0; c < SHADOW_CASCADES; c++) sort_merge_draw_list(&vk->shadow.draw_lists[c]);
+
+    /* Skinned draws each carry their own joint range, so they sort but never merge */
+    if (vk->draw_list_skinned.count > 1) {
+        qsort(vk->draw_list_skinned.items, vk->draw_list_skinned.count,
+              sizeof(SkinnedDrawCommand), compare_skinned_draw_commands);
+    }
+}
+
+static void write_indirect_draws(const VulkanContext *vk, const DrawList *list,
+                                 VkDrawIndexedIndirectCommand *records) {
+    for (u32 i = 0; i < list->count; i++) {
+        const DrawCommand *dc = &list->items[i];
+        const MeshSlot *mesh  = &vk->meshes[dc->mesh];
+        if (mesh->index_count == 0) continue;
+
+        const MeshLod *lod = &mesh->lods[dc->lod];
+        records[i] = (VkDrawIndexedIndirectCommand){
+            .indexCount    = lod->index_count,
+            .instanceCount = dc->instance_count,
+            .firstIndex    = lod->first_index,
+            .vertexOffset  = (i32)mesh->first_vertex,
+            .firstInstance = dc->instance_offset,
+        };
+    }
+}
+
+/* Write one VkDrawIndexedIndirectCommand per 3D draw, at the same index as the
+ * draw in draw_list_3d, then the shadow cascades' lists after it (from
+ * shadow.indirect_first[c]). Non-indexed meshes leave their slot unused and
+ * are drawn directly. If the ring cannot grow, recording falls back to
+ * direct draws for this frame (capacity stays below the record count). */
+static void build_indirect_draws_3d(VulkanContext *vk) {
+    u32 count = vk->draw_list_3d.count;
+    for (u32 c = 0; c < SHADOW_CASCADES; c++) {
+        vk->shadow.indirect_first[c] = count;
+        count += vk->shadow.draw_lists[c].count;
+    }
+    vk->indirect_3d_count = count;
+    if (!vk->multi_draw_indirect || count == 0) return;
+
+    if (!instance_ring_reserve(vk, &vk->indirect_ring_3d, &vk->indirect_3d_capacity,
+                               0, count, sizeof(VkDrawIndexedIndirectCommand))) {
+        return;
+    }
+
+    VkDrawIndexedIndirectCommand *records = (VkDrawIndexedIndirectCommand *)
+        (vk->indirect_ring_3d.mapped + vk->indirect_ring_3d.frame_offset);
+
+    write_indirect_draws(vk, &vk->draw_list_3d, records);
+    for (u32 c = 0; c < SHADOW_CASCADES; c++) {
+        write_indirect_draws(vk, &vk->shadow.draw_lists[c], records + vk->shadow.indirect_first[c]);
+    }
+}
+
+/* Texture table slot of a handle; slot 0 is the dummy used for untextured
+ * draws, for textures whose async load has not landed and for handles
+ * unloaded since the draw was queued */
+static u32 texture_slot(const VulkanContext *vk, TextureHandle texture) {
+    u32 slot = texture_lookup(vk, texture);
+    if (slot != HANDLE_SLOT_NONE && !vk->textures[slot].placeholder) return slot + 1;
+    return 0;
+}
+
+/* The texture table set the current frame reads. With update-after-bind one
+ * set is shared (new slots are written while older frames may still use it);
+ * otherwise each frame in flight has its own copy. */
+static VkDescriptorSet texture_table_set(const VulkanContext *vk) {
+    return vk->texture_table[vk->texture_update_after_bind ? 0 : vk->current_frame];
+}
+
+/* The light set of the current frame: its light_ring region, the shadow map,
+ * its point/spot lights and the light clusters */
+static VkDescriptorSet light_desc_set(const VulkanContext *vk) {
+    return vk->light_desc_sets[vk->current_frame];
+}
+
 /* --------------------------------------------------------------------------
  * Helper: record geometry draw commands into a command buffer.
- * Used by both the bloom path and the non-bloom path.
+ * Used by both the bloom path and the non-bloom path. Each helper records
+ * draws [begin, end) of its list and sets all the state it needs, so a range
+ * can go into its own secondary command buffer.
+ *
+ * The VP matrix is the same for every draw, so the full push constant block
+ * is written once and only the texture_index word is updated when it changes.
+ * Set 0 is the bindless texture table, bound once per range.
  * ------------------------------------------------------------------------ */
 
-static void record_geometry_draws(VulkanContext *vk, VkCommandBuffer cmd, VkPipeline geo_pipeline) {
-    if (vk->draw_command_count == 0) return;
+static void record_geometry_draws(const VulkanContext *vk, VkCommandBuffer cmd,
+                                  VkPipeline geo_pipeline, u32 begin, u32 end) {
+    if (begin >= end) return;
 
     vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, geo_pipeline);
 
     /* Bind vertex buffer (binding 0) and instance buffer (binding 1) */
-    VkBuffer buffers[] = { vk->vertex_buffer, vk->instance_buffer };
-    VkDeviceSize offsets[] = { 0, 0 };
+    VkBuffer buffers[] = { vk->vertex_buffer, vk->instance_ring.buffer };
+    VkDeviceSize offsets[] = { 0, vk->instance_ring.frame_offset };
     vkCmdBindVertexBuffers(cmd, 0, 2, buffers, offsets);
 
-    for (u32 i = 0; i < vk->draw_command_count; i++) {
-        DrawCommand *dc = &vk->draw_commands[i];
-        MeshSlot *mesh  = &vk->meshes[dc->mesh];
-
-        /* Push VP matrix + use_texture flag (68 bytes total) */
-        struct { float vp[16]; u32 use_texture; } push_data;
-        memcpy(push_data.vp, vk->vp_matrix, 64);
-        push_data.use_texture = (dc->texture != TEXTURE_HANDLE_INVALID) ? 1 : 0;
-        vkCmdPushConstants(cmd, vk->pipeline_layout,
-                           VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                           0, 68, &push_data);
-
-        /* Bind texture descriptor (real texture or dummy for untextured) */
-        VkDescriptorSet desc_set = vk->dummy_desc_set;
-        if (dc->texture != TEXTURE_HANDLE_INVALID && dc->texture < vk->texture_count) {
-            desc_set = vk->texture_desc_sets[dc->texture];
+    VkDescriptorSet table = texture_table_set(vk);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                             vk->pipeline_layout, 0, 1, &table, 0, NULL);
+
+    /* Push VP matrix + texture_index (68 bytes total) */
+    struct { float vp[16]; u32 texture_index; } push_data;
+    memcpy(push_data.vp, vk->vp_matrix, 64);
+    push_data.texture_index = texture_slot(vk, vk->draw_list.items[begin].texture);
+    vkCmdPushConstants(cmd, vk->pipeline_layout,
+                       VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                       0, 68, &push_data);
+
+    for (u32 i = begin; i < end; i++) {
+        const DrawCommand *dc = &vk->draw_list.items[i];
+        const MeshSlot *mesh  = &vk->meshes[dc->mesh];
+
+        u32 texture_index = texture_slot(vk, dc->texture);
+        if (texture_index != push_data.texture_index) {
+            push_data.texture_index = texture_index;
+            vkCmdPushConstants(cmd, vk->pipeline_layout,
+                               VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                               64, 4, &push_data.texture_index);
         }
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                 vk->pipeline_layout, 0, 1,
-                                 &desc_set, 0, NULL);
 
         vkCmdDraw(cmd,
                   mesh->vertex_count,   /* vertexCount */
@@ -112,259 +939,980 @@ static void record_geometry_draws(VulkanContext *vk, VkCommandBuffer cmd, VkPipe
     }
 }
 
+/* GPU particle systems draw with the 2D pipeline, their instances read from
+ * the system's own buffer and the count from its indirect args. Recorded
+ * after the 2D draws. */
+static void record_gpu_particle_draws(const VulkanContext *vk, VkCommandBuffer cmd,
+                                      VkPipeline geo_pipeline) {
+    const GpuParticleContext *gp = &vk->gpu_particles;
+    if (gp->draw_count == 0) return;
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, geo_pipeline);
+
+    VkDescriptorSet table = texture_table_set(vk);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                             vk->pipeline_layout, 0, 1, &table, 0, NULL);
+
+    struct { float vp[16]; u32 texture_index; } push_data;
+    memcpy(push_data.vp, vk->vp_matrix, 64);
+
+    for (u32 i = 0; i < gp->draw_count; i++) {
+        const GpuParticleDraw   *d  = &gp->draws[i];
+        const GpuParticleSystem *ps = &gp->systems[d->system];
+
+        VkBuffer buffers[] = { vk->vertex_buffer, ps->instances };
+        VkDeviceSize offsets[] = { 0, (VkDeviceSize)sizeof(InstanceData) * ps->capacity * ps->dst };
+        vkCmdBindVertexBuffers(cmd, 0, 2, buffers, offsets);
+
+        push_data.texture_index = texture_slot(vk, d->texture);
+        vkCmdPushConstants(cmd, vk->pipeline_layout,
+                           VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                           0, 68, &push_data);
+
+        vkCmdDrawIndirect(cmd, ps->args, sizeof(VkDrawIndirectCommand) * ps->dst,
+                          1, sizeof(VkDrawIndirectCommand));
+    }
+}
+
 /* --------------------------------------------------------------------------
  * Helper: record 3D geometry draw commands into a command buffer.
+ * list is draw_list_3d (camera) or a shadow cascade's list; its indirect
+ * records start at indirect_first. vp is the view's VP matrix.
  * ------------------------------------------------------------------------ */
 
-static void record_geometry_draws_3d(VulkanContext *vk, VkCommandBuffer cmd, VkPipeline pipeline_3d) {
-    if (vk->draw_command_3d_count == 0) return;
+static void record_geometry_draws_3d(const VulkanContext *vk, VkCommandBuffer cmd,
+                                     VkPipeline pipeline_3d, const DrawList *list,
+                                     u32 indirect_first, const f32 *vp,
+                                     u32 begin, u32 end) {
+    if (begin >= end) return;
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_3d);
+
+    /* Bind 3D vertex buffer (binding 0) and 3D instance buffer (binding 1) */
+    VkBuffer buffers[] = { vk->vertex_buffer_3d, vk->instance_ring_3d.buffer };
+    VkDeviceSize offsets[] = { 0, vk->instance_ring_3d.frame_offset };
+    vkCmdBindVertexBuffers(cmd, 0, 2, buffers, offsets);
+
+    /* Bind index buffer */
+    if (vk->index_buffer) {
+        vkCmdBindIndexBuffer(cmd, vk->index_buffer, 0, VK_INDEX_TYPE_UINT32);
+    }
+
+    /* Texture table (set 0) and light UBO (set 1) are the same for every draw */
+    VkDescriptorSet sets[] = { texture_table_set(vk), light_desc_set(vk) };
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                             vk->pipeline_layout_3d, 0, 2, sets, 0, NULL);
+
+    /* Push VP matrix + texture_index (68 bytes total) */
+    struct { float vp[16]; u32 texture_index; } push_data;
+    memcpy(push_data.vp, vp, 64);
+    push_data.texture_index = texture_slot(vk, list->items[begin].texture);
+    vkCmdPushConstants(cmd, vk->pipeline_layout_3d,
+                       VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                       0, 68, &push_data);
+
+    /* Consecutive indexed draws with the same texture go out as one
+     * vkCmdDrawIndexedIndirect over their records. The texture index is a
+     * push constant, so a texture change still splits the run. */
+    bool indirect = vk->multi_draw_indirect &&
+                    vk->indirect_3d_capacity >= vk->indirect_3d_count;
+    const VkDeviceSize stride = sizeof(VkDrawIndexedIndirectCommand);
+
+    for (u32 i = begin; i < end; ) {
+        const DrawCommand *dc = &list->items[i];
+        const MeshSlot *mesh  = &vk->meshes[dc->mesh];
+
+        u32 texture_index = texture_slot(vk, dc->texture);
+        if (texture_index != push_data.texture_index) {
+            push_data.texture_index = texture_index;
+            vkCmdPushConstants(cmd, vk->pipeline_layout_3d,
+                               VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                               64, 4, &push_data.texture_index);
+        }
+
+        if (indirect && mesh->index_count > 0) {
+            u32 run = 1;
+            while (i + run < end && run < vk->max_draw_indirect_count) {
+                const DrawCommand *next = &list->items[i + run];
+                if (vk->meshes[next->mesh].index_count == 0) break;
+                if (texture_slot(vk, next->texture) != texture_index) break;
+                run++;
+            }
+            vkCmdDrawIndexedIndirect(cmd, vk->indirect_ring_3d.buffer,
+                                     vk->indirect_ring_3d.frame_offset + (indirect_first + i) * stride,
+                                     run, (u32)stride);
+            i += run;
+            continue;
+        }
+
+        if (mesh->index_count > 0) {
+            const MeshLod *lod = &mesh->lods[dc->lod];
+            vkCmdDrawIndexed(cmd,
+                             lod->index_count,
+                             dc->instance_count,
+                             lod->first_index,
+                             (i32)mesh->first_vertex,
+                             dc->instance_offset);
+        } else {
+            vkCmdDraw(cmd,
+                      mesh->vertex_count,
+                      dc->instance_count,
+                      mesh->first_vertex,
+                      dc->instance_offset);
+        }
+        i++;
+    }
+}
+
+/* Static batches draw with the 3D pipeline from their own instance buffers,
+ * one instanced draw each, for the batches queued for `view` (a
+ * STATIC_BATCH_VIEW_* bit). Recorded after the 3D draws. */
+static void record_static_batch_draws(const VulkanContext *vk, VkCommandBuffer cmd,
+                                      VkPipeline pipeline_3d, u8 view, const f32 *vp) {
+    const StaticBatchContext *sc = &vk->static_batches;
+    u32 first = 0;
+    while (first < sc->draw_count && !(sc->batches[sc->draws[first]].views & view)) first++;
+    if (first == sc->draw_count) return;
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_3d);
+    if (vk->index_buffer) {
+        vkCmdBindIndexBuffer(cmd, vk->index_buffer, 0, VK_INDEX_TYPE_UINT32);
+    }
+
+    VkDescriptorSet sets[] = { texture_table_set(vk), light_desc_set(vk) };
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                             vk->pipeline_layout_3d, 0, 2, sets, 0, NULL);
+
+    struct { float vp[16]; u32 texture_index; } push_data;
+    memcpy(push_data.vp, vp, 64);
+    push_data.texture_index = texture_slot(vk, sc->batches[sc->draws[first]].texture);
+    vkCmdPushConstants(cmd, vk->pipeline_layout_3d,
+                       VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                       0, 68, &push_data);
+
+    for (u32 i = first; i < sc->draw_count; i++) {
+        const StaticBatch *sb = &sc->batches[sc->draws[i]];
+        const MeshSlot *mesh  = &vk->meshes[sb->mesh];
+        if (!(sb->views & view)) continue;
+
+        VkBuffer buffers[] = { vk->vertex_buffer_3d, sb->instances };
+        VkDeviceSize offsets[] = { 0, 0 };
+        vkCmdBindVertexBuffers(cmd, 0, 2, buffers, offsets);
+
+        u32 texture_index = texture_slot(vk, sb->texture);
+        if (texture_index != push_data.texture_index) {
+            push_data.texture_index = texture_index;
+            vkCmdPushConstants(cmd, vk->pipeline_layout_3d,
+                               VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                               64, 4, &push_data.texture_index);
+        }
+
+        if (mesh->index_count > 0) {
+            vkCmdDrawIndexed(cmd, mesh->index_count, sb->count, mesh->first_index,
+                             (i32)mesh->first_vertex, 0);
+        } else {
+            vkCmdDraw(cmd, mesh->vertex_count, sb->count, mesh->first_vertex, 0);
+        }
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Helper: record skinned 3D geometry draw commands into a command buffer.
+ * ------------------------------------------------------------------------ */
+
+static void record_geometry_draws_skinned(const VulkanContext *vk, VkCommandBuffer cmd,
+                                          VkPipeline skinned_pipeline, const f32 *vp,
+                                          u32 begin, u32 end) {
+    /* Draws the compute pre-pass skinned go through record_preskinned_draws */
+    while (begin < end && vk->draw_list_skinned.items[begin].skinned_vertex != SKIN_COMPUTE_NONE)
+        begin++;
+    if (begin >= end) return;
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, skinned_pipeline);
+
+    /* Bind skinned vertex buffer (binding 0) and skinned instance buffer (binding 1) */
+    VkBuffer buffers[] = { vk->vertex_buffer_skinned, vk->instance_ring_skinned.buffer };
+    VkDeviceSize offsets[] = { 0, vk->instance_ring_skinned.frame_offset };
+    vkCmdBindVertexBuffers(cmd, 0, 2, buffers, offsets);
+
+    /* Bind index buffer (shared with regular 3D meshes) */
+    if (vk->index_buffer) {
+        vkCmdBindIndexBuffer(cmd, vk->index_buffer, 0, VK_INDEX_TYPE_UINT32);
+    }
+
+    /* Light UBO (set 1) and joint SSBO (set 2, at this frame's ring region)
+     * are shared by every draw; per-draw joint ranges go in push constants */
+    u32 joint_base = (u32)vk->joint_ring.frame_offset;
+    VkDescriptorSet shared_sets[] = { texture_table_set(vk), light_desc_set(vk), vk->joint_desc_set };
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                             vk->pipeline_layout_skinned, 0, 3,
+                             shared_sets, 1, &joint_base);
+
+    /* Push constants: VP (64B) + texture_index (4B) + joint_offset (4B) + joint_count (4B)
+     * + first_instance (4B) = 80B. The shader picks instance i's palette at
+     * joint_offset + (gl_InstanceIndex - first_instance) * joint_count. */
+    struct {
+        float vp[16];
+        u32 texture_index;
+        u32 joint_offset;
+        u32 joint_count;
+        u32 first_instance;
+    } push_data;
+    const SkinnedDrawCommand *first = &vk->draw_list_skinned.items[begin];
+    memcpy(push_data.vp, vp, 64);
+    push_data.texture_index = texture_slot(vk, first->texture);
+    push_data.joint_offset = first->joint_ssbo_offset;
+    push_data.joint_count = first->joint_count;
+    push_data.first_instance = first->instance_offset;
+    vkCmdPushConstants(cmd, vk->pipeline_layout_skinned,
+                       VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                       0, 80, &push_data);
+
+    for (u32 i = begin; i < end; i++) {
+        const SkinnedDrawCommand *dc = &vk->draw_list_skinned.items[i];
+        const MeshSlot *mesh = &vk->meshes[dc->mesh];
+        if (dc->skinned_vertex != SKIN_COMPUTE_NONE) continue;
+
+        /* Update only the trailing words that differ from the last draw */
+        u32 texture_index = texture_slot(vk, dc->texture);
+        if (texture_index != push_data.texture_index) {
+            push_data.texture_index = texture_index;
+            vkCmdPushConstants(cmd, vk->pipeline_layout_skinned,
+                               VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                               64, 4, &push_data.texture_index);
+        }
+        if (dc->joint_ssbo_offset != push_data.joint_offset ||
+            dc->joint_count != push_data.joint_count ||
+            dc->instance_offset != push_data.first_instance) {
+            push_data.joint_offset = dc->joint_ssbo_offset;
+            push_data.joint_count = dc->joint_count;
+            push_data.first_instance = dc->instance_offset;
+            vkCmdPushConstants(cmd, vk->pipeline_layout_skinned,
+                               VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                               68, 12, &push_data.joint_offset);
+        }
+
+        if (mesh->index_count > 0) {
+            vkCmdDrawIndexed(cmd,
+                             mesh->index_count,
+                             dc->instance_count,
+                             mesh->first_index,
+                             (i32)mesh->first_vertex,
+                             dc->instance_offset);
+        } else {
+            vkCmdDraw(cmd,
+                      mesh->vertex_count,
+                      dc->instance_count,
+                      mesh->first_vertex,
+                      dc->instance_offset);
+        }
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Helper: record skinned draws already skinned by the compute pre-pass.
+ * They are regular 3D vertices (packed or not, like vertex_buffer_3d) in the
+ * skin output buffer, drawn with the 3D pipeline; index data and instance
+ * data are the skinned draw's own.
+ * ------------------------------------------------------------------------ */
+
+static void record_preskinned_draws(const VulkanContext *vk, VkCommandBuffer cmd,
+                                    VkPipeline pipeline_3d, const f32 *vp, u32 begin, u32 end) {
+    while (begin < end && vk->draw_list_skinned.items[begin].skinned_vertex == SKIN_COMPUTE_NONE)
+        begin++;
+    if (begin >= end) return;
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_3d);
+
+    /* Skin output (binding 0) and skinned instance buffer (binding 1) */
+    VkBuffer buffers[] = { vk->skin_compute.output, vk->instance_ring_skinned.buffer };
+    VkDeviceSize offsets[] = { skin_compute_frame_offset(vk), vk->instance_ring_skinned.frame_offset };
+    vkCmdBindVertexBuffers(cmd, 0, 2, buffers, offsets);
+
+    if (vk->index_buffer) {
+        vkCmdBindIndexBuffer(cmd, vk->index_buffer, 0, VK_INDEX_TYPE_UINT32);
+    }
+
+    VkDescriptorSet sets[] = { texture_table_set(vk), light_desc_set(vk) };
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                             vk->pipeline_layout_3d, 0, 2, sets, 0, NULL);
+
+    struct { float vp[16]; u32 texture_index; } push_data;
+    memcpy(push_data.vp, vp, 64);
+    push_data.texture_index = texture_slot(vk, vk->draw_list_skinned.items[begin].texture);
+    vkCmdPushConstants(cmd, vk->pipeline_layout_3d,
+                       VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                       0, 68, &push_data);
+
+    for (u32 i = begin; i < end; i++) {
+        const SkinnedDrawCommand *dc = &vk->draw_list_skinned.items[i];
+        const MeshSlot *mesh = &vk->meshes[dc->mesh];
+        if (dc->skinned_vertex == SKIN_COMPUTE_NONE) continue;
+
+        u32 texture_index = texture_slot(vk, dc->texture);
+        if (texture_index != push_data.texture_index) {
+            push_data.texture_index = texture_index;
+            vkCmdPushConstants(cmd, vk->pipeline_layout_3d,
+                               VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                               64, 4, &push_data.texture_index);
+        }
+
+        /* Each instance has its own skinned copy of the mesh */
+        for (u32 k = 0; k < dc->instance_count; k++) {
+            u32 first_vertex = dc->skinned_vertex + k * mesh->vertex_count;
+            if (mesh->index_count > 0) {
+                vkCmdDrawIndexed(cmd, mesh->index_count, 1, mesh->first_index,
+                                 (i32)first_vertex, dc->instance_offset + k);
+            } else {
+                vkCmdDraw(cmd, mesh->vertex_count, 1, first_vertex, dc->instance_offset + k);
+            }
+        }
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Parallel recording: secondary command buffers
+ *
+ * Large frames split each draw list into chunks of RECORD_CHUNK_DRAWS and
+ * record every chunk as a job into a secondary from the executing thread's
+ * pool. The primary executes them in list order, so the 2D painter's order
+ * and the 3D sort order are preserved. Text is recorded on the calling
+ * thread because text_flush consumes the text module's batched vertices.
+ * ------------------------------------------------------------------------ */
+
+#define RECORD_CHUNK_DRAWS        512   /* draws per secondary command buffer */
+#define RECORD_PARALLEL_MIN_DRAWS 1024  /* below this, record inline */
+
+typedef enum {
+    RECORD_2D,
+    RECORD_3D,
+    RECORD_SKINNED,
+} RecordKind;
+
+/* State shared by every secondary recorded for one render pass */
+typedef struct {
+    VulkanContext *vk;
+    VkRenderPass   render_pass;
+    VkFramebuffer  framebuffer;
+    VkExtent2D     extent;          /* viewport/scissor (render-scaled scene target) */
+    VkPipeline     geo_pipeline;
+    VkPipeline     pipeline_3d;
+    VkPipeline     skinned_pipeline;
+    VkPipeline     text_pipeline;
+} RecordPass;
+
+typedef struct {
+    const RecordPass *pass;
+    RecordKind        kind;
+    u32               begin;
+    u32               end;
+    bool              first;   /* of its kind: writes the pass begin timestamp */
+    bool              last;    /* writes the pass end timestamp */
+    VkCommandBuffer   cmd;     /* output */
+    EngineResult      result;
+} RecordChunk;
+
+/* Reset every secondary pool of a frame slot whose fence has signalled */
+static void secondary_pools_reset(VulkanContext *vk, u32 frame) {
+    for (u32 t = 0; t < JOBS_MAX_THREADS; t++) {
+        SecondaryPool *sp = &vk->secondary_pools[frame][t];
+        if (!sp->pool) continue;
+        vkResetCommandPool(vk->device, sp->pool, 0);
+        sp->used = 0;
+    }
+}
+
+static void secondary_pools_destroy(VulkanContext *vk) {
+    for (u32 f = 0; f < vk->frames_in_flight; f++) {
+        for (u32 t = 0; t < JOBS_MAX_THREADS; t++) {
+            SecondaryPool *sp = &vk->secondary_pools[f][t];
+            if (sp->pool) vkDestroyCommandPool(vk->device, sp->pool, NULL);
+            free(sp->buffers);
+            memset(sp, 0, sizeof(*sp));
+        }
+    }
+}
+
+/* Hand out a secondary from the calling thread's pool for the current frame
+ * and begin it inside `pass`. Only the owning thread touches its pool. */
+static EngineResult begin_secondary(const RecordPass *pass, VkCommandBuffer *out_cmd) {
+    VulkanContext *vk = pass->vk;
+    SecondaryPool *sp = &vk->secondary_pools[vk->current_frame][jobs_thread_index()];
+
+    if (!sp->pool) {
+        VkCommandPoolCreateInfo pool_info = {
+            .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = vk->graphics_family,
+        };
+        if (vkCreateCommandPool(vk->device, &pool_info, NULL, &sp->pool) != VK_SUCCESS) {
+            LOG_ERROR("Failed to create secondary command pool");
+            sp->pool = VK_NULL_HANDLE;
+            return ENGINE_ERROR_VULKAN_INIT;
+        }
+    }
+
+    if (sp->used == sp->count) {
+        u32 new_count = (sp->count > 0) ? sp->count * 2 : 8;
+        VkCommandBuffer *buffers = realloc(sp->buffers, sizeof(VkCommandBuffer) * new_count);
+        if (!buffers) {
+            LOG_ERROR("Out of memory growing secondary command buffers");
+            return ENGINE_ERROR_OUT_OF_MEMORY;
+        }
+        sp->buffers = buffers;
+
+        VkCommandBufferAllocateInfo alloc_info = {
+            .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool        = sp->pool,
+            .level              = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+            .commandBufferCount = new_count - sp->count,
+        };
+        if (vkAllocateCommandBuffers(vk->device, &alloc_info, &sp->buffers[sp->count]) != VK_SUCCESS) {
+            LOG_ERROR("Failed to allocate secondary command buffers");
+            return ENGINE_ERROR_VULKAN_INIT;
+        }
+        sp->count = new_count;
+    }
+
+    VkCommandBuffer cmd = sp->buffers[sp->used++];
+
+    VkCommandBufferInheritanceInfo inheritance = {
+        .sType       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+        .renderPass  = pass->render_pass,
+        .subpass     = 0,
+        .framebuffer = pass->framebuffer,
+    };
+    VkCommandBufferBeginInfo begin_info = {
+        .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT |
+                            VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+        .pInheritanceInfo = &inheritance,
+    };
+    if (vkBeginCommandBuffer(cmd, &begin_info) != VK_SUCCESS) {
+        LOG_ERROR("Failed to begin secondary command buffer");
+        return ENGINE_ERROR_VULKAN_INIT;
+    }
+
+    /* Dynamic state is not inherited from the primary */
+    VkViewport viewport = {
+        0.0f, 0.0f, (float)pass->extent.width, (float)pass->extent.height, 0.0f, 1.0f,
+    };
+    vkCmdSetViewport(cmd, 0, 1, &viewport);
+
+    VkRect2D scissor = { .offset = {0, 0}, .extent = pass->extent };
+    vkCmdSetScissor(cmd, 0, 1, &scissor);
+
+    *out_cmd = cmd;
+    return ENGINE_SUCCESS;
+}
+
+static void record_chunk_job(void *data) {
+    RecordChunk *c = data;
+    const RecordPass *pass = c->pass;
+
+    c->result = begin_secondary(pass, &c->cmd);
+    if (c->result != ENGINE_SUCCESS) return;
+
+    static const GpuPass gpu_pass[] = {
+        [RECORD_2D]      = GPU_PASS_2D,
+        [RECORD_3D]      = GPU_PASS_3D,
+        [RECORD_SKINNED] = GPU_PASS_SKINNED,
+    };
+    if (c->first) gpu_profiler_pass_begin(pass->vk, c->cmd, gpu_pass[c->kind]);
+
+    switch (c->kind) {
+    case RECORD_2D:
+        record_geometry_draws(pass->vk, c->cmd, pass->geo_pipeline, c->begin, c->end);
+        break;
+    case RECORD_3D:
+        record_geometry_draws_3d(pass->vk, c->cmd, pass->pipeline_3d, &pass->vk->draw_list_3d, 0,
+                                 pass->vk->vp_matrix, c->begin, c->end);
+        break;
+    case RECORD_SKINNED:
+        record_preskinned_draws(pass->vk, c->cmd, pass->pipeline_3d, pass->vk->vp_matrix,
+                                c->begin, c->end);
+        record_geometry_draws_skinned(pass->vk, c->cmd, pass->skinned_pipeline, pass->vk->vp_matrix,
+                                      c->begin, c->end);
+        break;
+    }
+
+    if (c->last) gpu_profiler_pass_end(pass->vk, c->cmd, gpu_pass[c->kind]);
+
+    if (vkEndCommandBuffer(c->cmd) != VK_SUCCESS) {
+        LOG_ERROR("Failed to record secondary command buffer");
+        c->result = ENGINE_ERROR_VULKAN_INIT;
+    }
+}
+
+static u32 add_record_chunks(RecordChunk *chunks, u32 at, const RecordPass *pass,
+                             RecordKind kind, u32 count) {
+    for (u32 begin = 0; begin < count; begin += RECORD_CHUNK_DRAWS) {
+        chunks[at++] = (RecordChunk){
+            .pass  = pass,
+            .kind  = kind,
+            .begin = begin,
+            .end   = ENGINE_MIN(begin + RECORD_CHUNK_DRAWS, count),
+            .first = begin == 0,
+            .last  = begin + RECORD_CHUNK_DRAWS >= count,
+        };
+    }
+    return at;
+}
+
+static u32 record_chunk_count(u32 draws) {
+    return (draws + RECORD_CHUNK_DRAWS - 1) / RECORD_CHUNK_DRAWS;
+}
+
+/* Bump-allocate frame-lifetime scratch (NULL only if the heap is exhausted) */
+static void *frame_alloc(VulkanContext *vk, size_t bytes) {
+    return arena_alloc_nozero(&vk->frame_arena, bytes, 16);
+}
+
+/* Record the scene's draws and text inside one render pass instance. */
+static EngineResult record_scene_pass(VulkanContext *vk, VkCommandBuffer cmd,
+                                      const VkRenderPassBeginInfo *rp_info,
+                                      const RecordPass *pass) {
+    u32 n2d      = vk->draw_list.count;
+    u32 n3d      = vk->draw_list_3d.count;
+    u32 nskinned = vk->draw_list_skinned.count;
+
+    u32          chunk_count = 0;
+    RecordChunk *chunks      = NULL;
+    Job         *jobs        = NULL;
+    VkCommandBuffer *secondaries = NULL;
+
+    if (jobs_thread_count() > 1 && n2d + n3d + nskinned >= RECORD_PARALLEL_MIN_DRAWS) {
+        chunk_count = record_chunk_count(n2d) + record_chunk_count(n3d) +
+                      record_chunk_count(nskinned);
+        chunks      = frame_alloc(vk, sizeof(RecordChunk) * chunk_count);
+        jobs        = frame_alloc(vk, sizeof(Job) * chunk_count);
+        secondaries = frame_alloc(vk, sizeof(VkCommandBuffer) * (chunk_count + 3));
+    }
+
+    if (!chunks || !jobs || !secondaries) {
+        /* Small frame (or no workers): everything inline in the primary */
+        vkCmdBeginRenderPass(cmd, rp_info, VK_SUBPASS_CONTENTS_INLINE);
+
+        VkViewport viewport = {
+            0.0f, 0.0f, (float)pass->extent.width, (float)pass->extent.height, 0.0f, 1.0f,
+        };
+        vkCmdSetViewport(cmd, 0, 1, &viewport);
+
+        VkRect2D scissor = { .offset = {0, 0}, .extent = pass->extent };
+        vkCmdSetScissor(cmd, 0, 1, &scissor);
+
+        gpu_profiler_pass_begin(vk, cmd, GPU_PASS_2D);
+        record_geometry_draws(vk, cmd, pass->geo_pipeline, 0, n2d);
+        record_gpu_particle_draws(vk, cmd, pass->geo_pipeline);
+        gpu_profiler_pass_end(vk, cmd, GPU_PASS_2D);
 
-    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_3d);
+        gpu_profiler_pass_begin(vk, cmd, GPU_PASS_3D);
+        record_geometry_draws_3d(vk, cmd, pass->pipeline_3d, &vk->draw_list_3d, 0,
+                                 vk->vp_matrix, 0, n3d);
+        record_static_batch_draws(vk, cmd, pass->pipeline_3d, STATIC_BATCH_VIEW_CAMERA,
+                                  vk->vp_matrix);
+        gpu_profiler_pass_end(vk, cmd, GPU_PASS_3D);
 
-    /* Bind 3D vertex buffer (binding 0) and 3D instance buffer (binding 1) */
-    VkBuffer buffers[] = { vk->vertex_buffer_3d, vk->instance_buffer_3d };
-    VkDeviceSize offsets[] = { 0, 0 };
-    vkCmdBindVertexBuffers(cmd, 0, 2, buffers, offsets);
+        gpu_profiler_pass_begin(vk, cmd, GPU_PASS_SKINNED);
+        record_preskinned_draws(vk, cmd, pass->pipeline_3d, vk->vp_matrix, 0, nskinned);
+        record_geometry_draws_skinned(vk, cmd, pass->skinned_pipeline, vk->vp_matrix, 0, nskinned);
+        gpu_profiler_pass_end(vk, cmd, GPU_PASS_SKINNED);
 
-    /* Bind index buffer */
-    if (vk->index_buffer) {
-        vkCmdBindIndexBuffer(cmd, vk->index_buffer, 0, VK_INDEX_TYPE_UINT32);
+        gpu_profiler_pass_begin(vk, cmd, GPU_PASS_TEXT);
+        text_flush_with_pipeline(vk, cmd, pass->text_pipeline);
+        gpu_profiler_pass_end(vk, cmd, GPU_PASS_TEXT);
+
+        vkCmdEndRenderPass(cmd);
+        return ENGINE_SUCCESS;
     }
 
-    for (u32 i = 0; i < vk->draw_command_3d_count; i++) {
-        DrawCommand *dc = &vk->draw_commands_3d[i];
-        MeshSlot *mesh  = &vk->meshes[dc->mesh];
+    u32 at = 0;
+    at = add_record_chunks(chunks, at, pass, RECORD_2D,      n2d);
+    at = add_record_chunks(chunks, at, pass, RECORD_3D,      n3d);
+    at = add_record_chunks(chunks, at, pass, RECORD_SKINNED, nskinned);
 
-        /* Push VP matrix + use_texture flag (68 bytes total) */
-        struct { float vp[16]; u32 use_texture; } push_data;
-        memcpy(push_data.vp, vk->vp_matrix, 64);
-        push_data.use_texture = (dc->texture != TEXTURE_HANDLE_INVALID) ? 1 : 0;
-        vkCmdPushConstants(cmd, vk->pipeline_layout_3d,
-                           VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                           0, 68, &push_data);
+    for (u32 i = 0; i < chunk_count; i++) {
+        jobs[i] = (Job){ record_chunk_job, &chunks[i], NULL };
+    }
 
-        /* Bind texture descriptor (set 0) */
-        VkDescriptorSet tex_set = vk->dummy_desc_set;
-        if (dc->texture != TEXTURE_HANDLE_INVALID && dc->texture < vk->texture_count) {
-            tex_set = vk->texture_desc_sets[dc->texture];
+    JobCounter counter = {0};
+    jobs_run(jobs, chunk_count, &counter);
+
+    /* GPU particles follow the 2D draws, static batches the 3D draws, and the
+     * text overlay goes last; all are recorded here while the workers run */
+    VkCommandBuffer particle_cmd = VK_NULL_HANDLE;
+    EngineResult res = ENGINE_SUCCESS;
+    if (vk->gpu_particles.draw_count > 0) {
+        res = begin_secondary(pass, &particle_cmd);
+        if (res == ENGINE_SUCCESS) {
+            record_gpu_particle_draws(vk, particle_cmd, pass->geo_pipeline);
+            if (vkEndCommandBuffer(particle_cmd) != VK_SUCCESS) {
+                LOG_ERROR("Failed to record particle secondary command buffer");
+                res = ENGINE_ERROR_VULKAN_INIT;
+            }
         }
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                 vk->pipeline_layout_3d, 0, 1,
-                                 &tex_set, 0, NULL);
+    }
 
-        /* Bind light UBO descriptor (set 1) */
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                 vk->pipeline_layout_3d, 1, 1,
-                                 &vk->light_desc_set, 0, NULL);
+    VkCommandBuffer static_cmd = VK_NULL_HANDLE;
+    if (res == ENGINE_SUCCESS && vk->static_batches.draw_count > 0) {
+        res = begin_secondary(pass, &static_cmd);
+        if (res == ENGINE_SUCCESS) {
+            record_static_batch_draws(vk, static_cmd, pass->pipeline_3d, STATIC_BATCH_VIEW_CAMERA,
+                                      vk->vp_matrix);
+            if (vkEndCommandBuffer(static_cmd) != VK_SUCCESS) {
+                LOG_ERROR("Failed to record static batch secondary command buffer");
+                res = ENGINE_ERROR_VULKAN_INIT;
+            }
+        }
+    }
 
-        if (mesh->index_count > 0) {
-            vkCmdDrawIndexed(cmd,
-                             mesh->index_count,
-                             dc->instance_count,
-                             mesh->first_index,
-                             (i32)mesh->first_vertex,
-                             dc->instance_offset);
-        } else {
-            vkCmdDraw(cmd,
-                      mesh->vertex_count,
-                      dc->instance_count,
-                      mesh->first_vertex,
-                      dc->instance_offset);
+    VkCommandBuffer text_cmd = VK_NULL_HANDLE;
+    if (res == ENGINE_SUCCESS) res = begin_secondary(pass, &text_cmd);
+    if (res == ENGINE_SUCCESS) {
+        gpu_profiler_pass_begin(vk, text_cmd, GPU_PASS_TEXT);
+        text_flush_with_pipeline(vk, text_cmd, pass->text_pipeline);
+        gpu_profiler_pass_end(vk, text_cmd, GPU_PASS_TEXT);
+        if (vkEndCommandBuffer(text_cmd) != VK_SUCCESS) {
+            LOG_ERROR("Failed to record text secondary command buffer");
+            res = ENGINE_ERROR_VULKAN_INIT;
         }
     }
+
+    jobs_wait(&counter);
+
+    u32 n2d_chunks = record_chunk_count(n2d);
+    u32 n3d_end    = n2d_chunks + record_chunk_count(n3d);
+    u32 count = 0;
+    for (u32 i = 0; i <= chunk_count; i++) {
+        if (i == n2d_chunks && particle_cmd) secondaries[count++] = particle_cmd;
+        if (i == n3d_end && static_cmd)      secondaries[count++] = static_cmd;
+        if (i == chunk_count) break;
+        if (chunks[i].result != ENGINE_SUCCESS) return chunks[i].result;
+        secondaries[count++] = chunks[i].cmd;
+    }
+    if (res != ENGINE_SUCCESS) return res;
+    secondaries[count++] = text_cmd;
+
+    vkCmdBeginRenderPass(cmd, rp_info, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    vkCmdExecuteCommands(cmd, count, secondaries);
+    vkCmdEndRenderPass(cmd);
+    return ENGINE_SUCCESS;
 }
 
 /* --------------------------------------------------------------------------
- * Helper: record skinned 3D geometry draw commands into a command buffer.
+ * Shadow cascades
  * ------------------------------------------------------------------------ */
 
-static void record_geometry_draws_skinned(VulkanContext *vk, VkCommandBuffer cmd,
-                                           VkPipeline skinned_pipeline) {
-    if (vk->draw_command_skinned_count == 0) return;
-
-    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, skinned_pipeline);
+/* One depth-only pass per cascade, ahead of the scene pass that samples
+ * them. Recorded inline: the cascade lists hold merged, untextured casters,
+ * far fewer draws than the scene. Skinned draws go into every cascade.
+ * Only runs on shadowed frames; otherwise the scene pass samples whatever
+ * the graph left in the map, and mesh3d.frag ignores it. */
+static EngineResult record_shadow_pass(VulkanContext *vk, VkCommandBuffer cmd, void *user) {
+    (void)user;
+    ShadowContext *sh = &vk->shadow;
+
+    u32 nskinned = vk->draw_list_skinned.count;
+    VkClearValue clear = { .depthStencil = { 1.0f, 0 } };
+    VkExtent2D extent = { sh->size, sh->size };
+    VkViewport viewport = { 0.0f, 0.0f, (float)sh->size, (float)sh->size, 0.0f, 1.0f };
+    VkRect2D scissor = { .offset = {0, 0}, .extent = extent };
+
+    gpu_profiler_pass_begin(vk, cmd, GPU_PASS_SHADOW);
+    for (u32 c = 0; c < SHADOW_CASCADES; c++) {
+        VkRenderPassBeginInfo rp_info = {
+            .sType           = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+            .renderPass      = sh->render_pass,
+            .framebuffer     = sh->framebuffers[c],
+            .renderArea      = { .offset = {0, 0}, .extent = extent },
+            .clearValueCount = 1,
+            .pClearValues    = &clear,
+        };
+        vkCmdBeginRenderPass(cmd, &rp_info, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdSetViewport(cmd, 0, 1, &viewport);
+        vkCmdSetScissor(cmd, 0, 1, &scissor);
 
-    /* Bind skinned vertex buffer (binding 0) and skinned instance buffer (binding 1) */
-    VkBuffer buffers[] = { vk->vertex_buffer_skinned, vk->instance_buffer_skinned };
-    VkDeviceSize offsets[] = { 0, 0 };
-    vkCmdBindVertexBuffers(cmd, 0, 2, buffers, offsets);
+        const DrawList *list = &sh->draw_lists[c];
+        const f32 *vp = sh->vp[c];
+        record_geometry_draws_3d(vk, cmd, sh->pipeline_3d, list, sh->indirect_first[c],
+                                 vp, 0, list->count);
+        record_static_batch_draws(vk, cmd, sh->pipeline_3d, STATIC_BATCH_VIEW_CASCADE(c), vp);
+        record_preskinned_draws(vk, cmd, sh->pipeline_3d, vp, 0, nskinned);
+        record_geometry_draws_skinned(vk, cmd, sh->skinned_pipeline, vp, 0, nskinned);
 
-    /* Bind index buffer (shared with regular 3D meshes) */
-    if (vk->index_buffer) {
-        vkCmdBindIndexBuffer(cmd, vk->index_buffer, 0, VK_INDEX_TYPE_UINT32);
+        vkCmdEndRenderPass(cmd);
     }
+    gpu_profiler_pass_end(vk, cmd, GPU_PASS_SHADOW);
+    return ENGINE_SUCCESS;
+}
 
-    for (u32 i = 0; i < vk->draw_command_skinned_count; i++) {
-        SkinnedDrawCommand *dc = &vk->draw_commands_skinned[i];
-        MeshSlot *mesh = &vk->meshes[dc->mesh];
-
-        /* Push constants: VP (64B) + use_texture (4B) + joint_offset (4B) + joint_count (4B) = 76B */
-        struct {
-            float vp[16];
-            u32 use_texture;
-            u32 joint_offset;
-            u32 joint_count;
-        } push_data;
-        memcpy(push_data.vp, vk->vp_matrix, 64);
-        push_data.use_texture = (dc->texture != TEXTURE_HANDLE_INVALID) ? 1 : 0;
-        push_data.joint_offset = dc->joint_ssbo_offset;
-        push_data.joint_count = dc->joint_count;
-        vkCmdPushConstants(cmd, vk->pipeline_layout_skinned,
-                           VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                           0, 76, &push_data);
-
-        /* Bind texture descriptor (set 0) */
-        VkDescriptorSet tex_set = vk->dummy_desc_set;
-        if (dc->texture != TEXTURE_HANDLE_INVALID && dc->texture < vk->texture_count) {
-            tex_set = vk->texture_desc_sets[dc->texture];
-        }
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                 vk->pipeline_layout_skinned, 0, 1,
-                                 &tex_set, 0, NULL);
-
-        /* Bind light UBO descriptor (set 1) */
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                 vk->pipeline_layout_skinned, 1, 1,
-                                 &vk->light_desc_set, 0, NULL);
-
-        /* Bind joint SSBO descriptor (set 2) */
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                 vk->pipeline_layout_skinned, 2, 1,
-                                 &vk->joint_desc_set, 0, NULL);
+/* --------------------------------------------------------------------------
+ * Dynamic resolution
+ * ------------------------------------------------------------------------ */
 
-        if (mesh->index_count > 0) {
-            vkCmdDrawIndexed(cmd,
-                             mesh->index_count,
-                             dc->instance_count,
-                             mesh->first_index,
-                             (i32)mesh->first_vertex,
-                             dc->instance_offset);
-        } else {
-            vkCmdDraw(cmd,
-                      mesh->vertex_count,
-                      dc->instance_count,
-                      mesh->first_vertex,
-                      dc->instance_offset);
-        }
-    }
+#define DYNRES_SMOOTHING   0.1f   /* EMA weight of the newest GPU frame time */
+#define DYNRES_HIGH        0.95f  /* shrink above this fraction of the budget */
+#define DYNRES_LOW         0.80f  /* grow below this fraction */
+#define DYNRES_AIM         0.90f  /* fraction of the budget a change aims for */
+#define DYNRES_MAX_STEP    0.05f  /* largest scale change per frame */
+
+/* Nudge the scene render scale toward the GPU frame-time budget. Pixel cost
+ * goes with scale squared, so the step is the square root of the time ratio;
+ * a dead band between DYNRES_LOW and DYNRES_HIGH stops it oscillating. */
+static void update_dynamic_resolution(Renderer *r) {
+    VulkanContext *vk = &r->vk;
+    const GpuTimings *t = &vk->gpu_profiler.timings;
+    if (!r->dynamic_resolution || !vk->bloom.enabled || !t->valid) return;
+    if (t->frame_number == r->dynres_frame) return;   /* already applied */
+    r->dynres_frame = t->frame_number;
+
+    /* Scene time: the composite waits on the swapchain image and doesn't
+     * scale with the render scale */
+    r->dynres_avg_ms = (r->dynres_avg_ms > 0.0f)
+        ? r->dynres_avg_ms + (t->scene_ms - r->dynres_avg_ms) * DYNRES_SMOOTHING
+        : t->scene_ms;
+
+    f32 budget = r->dynres_target_ms;
+    f32 avg    = r->dynres_avg_ms;
+    if (avg <= budget * DYNRES_HIGH && avg >= budget * DYNRES_LOW) return;
+
+    f32 scale  = vk->bloom.render_scale;
+    f32 wanted = scale * sqrtf(budget * DYNRES_AIM / avg);
+    wanted = ENGINE_CLAMP(wanted, scale - DYNRES_MAX_STEP, scale + DYNRES_MAX_STEP);
+    bloom_set_render_scale(vk, wanted);
 }
 
 /* --------------------------------------------------------------------------
  * Command buffer recording
  * ------------------------------------------------------------------------ */
 
-static EngineResult record_command_buffer(Renderer *renderer, VkCommandBuffer cmd, u32 image_index) {
-    VulkanContext *vk = &renderer->vk;
+/* With async compute, the compute passes get this frame's compute command
+ * buffer instead of graph passes; nothing is recorded when none of them has
+ * work. Timestamps are only written on the graphics queue, whose submit
+ * resets the queries. */
+static EngineResult record_async_compute(VulkanContext *vk) {
+    if (!vk->compute.enabled) return ENGINE_SUCCESS;
+    if (vk->skin_compute.vertex_count == 0 && !vk->gpu_particles.active &&
+        !light_cluster_active(vk)) {
+        return ENGINE_SUCCESS;
+    }
 
-    VkCommandBufferBeginInfo begin_info = {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-    };
+    VkCommandBuffer cmd;
+    EngineResult res = async_compute_begin(vk, &cmd);
+    if (res != ENGINE_SUCCESS) return res;
+    if (vk->skin_compute.vertex_count > 0) skin_compute_record(vk, cmd);
+    if (vk->gpu_particles.active)          gpu_particles_record(vk, cmd);
+    if (light_cluster_active(vk))          light_cluster_record(vk, cmd);
+    return async_compute_end(vk);
+}
 
-    if (vkBeginCommandBuffer(cmd, &begin_info) != VK_SUCCESS) {
-        LOG_ERROR("Failed to begin recording command buffer");
-        return ENGINE_ERROR_VULKAN_INIT;
-    }
+/* ---- Render graph passes ---- */
 
-    if (vk->bloom.enabled) {
-        /* ================================================================
-         * BLOOM PATH: Render scene to offscreen HDR, then post-process
-         * ================================================================ */
+static EngineResult record_skin_pass(VulkanContext *vk, VkCommandBuffer cmd, void *user) {
+    (void)user;
+    gpu_profiler_pass_begin(vk, cmd, GPU_PASS_SKIN_COMPUTE);
+    skin_compute_record(vk, cmd);
+    gpu_profiler_pass_end(vk, cmd, GPU_PASS_SKIN_COMPUTE);
+    return ENGINE_SUCCESS;
+}
 
-        VkClearValue clear_values[2];
-        clear_values[0].color = (VkClearColorValue){{
-            vk->clear_color[0], vk->clear_color[1],
-            vk->clear_color[2], vk->clear_color[3]
-        }};
-        clear_values[1].depthStencil = (VkClearDepthStencilValue){ 1.0f, 0 };
+static EngineResult record_particle_pass(VulkanContext *vk, VkCommandBuffer cmd, void *user) {
+    (void)user;
+    gpu_profiler_pass_begin(vk, cmd, GPU_PASS_PARTICLES);
+    gpu_particles_record(vk, cmd);
+    gpu_profiler_pass_end(vk, cmd, GPU_PASS_PARTICLES);
+    return ENGINE_SUCCESS;
+}
 
-        /* Pass 1: Scene -> offscreen HDR image */
-        VkRenderPassBeginInfo rp_info = {
-            .sType       = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-            .renderPass  = vk->bloom.scene_render_pass,
-            .framebuffer = vk->bloom.scene_framebuffer,
-            .renderArea  = { .offset = {0, 0}, .extent = vk->swapchain_extent },
-            .clearValueCount = 2,
-            .pClearValues    = clear_values,
-        };
+static EngineResult record_light_cull_pass(VulkanContext *vk, VkCommandBuffer cmd, void *user) {
+    (void)user;
+    gpu_profiler_pass_begin(vk, cmd, GPU_PASS_LIGHT_CULL);
+    light_cluster_record(vk, cmd);
+    gpu_profiler_pass_end(vk, cmd, GPU_PASS_LIGHT_CULL);
+    return ENGINE_SUCCESS;
+}
 
-        vkCmdBeginRenderPass(cmd, &rp_info, VK_SUBPASS_CONTENTS_INLINE);
+static void scene_clear_values(const VulkanContext *vk, VkClearValue out[2]) {
+    out[0].color = (VkClearColorValue){{
+        vk->clear_color[0], vk->clear_color[1],
+        vk->clear_color[2], vk->clear_color[3]
+    }};
+    out[1].depthStencil = (VkClearDepthStencilValue){ 1.0f, 0 };
+}
 
-        /* Dynamic viewport & scissor */
-        VkViewport viewport = {
-            0.0f, 0.0f,
-            (float)vk->swapchain_extent.width, (float)vk->swapchain_extent.height,
-            0.0f, 1.0f,
-        };
-        vkCmdSetViewport(cmd, 0, 1, &viewport);
+/* Without bloom: a single render pass straight to the swapchain image */
+static EngineResult record_swapchain_scene_pass(VulkanContext *vk, VkCommandBuffer cmd,
+                                                void *user) {
+    const Renderer *renderer = user;
+    VkClearValue clear_values[2];
+    scene_clear_values(vk, clear_values);
+
+    VkRenderPassBeginInfo rp_info = {
+        .sType       = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+        .renderPass  = vk->render_pass,
+        .framebuffer = vk->framebuffers[renderer->current_image_index],
+        .renderArea  = { .offset = {0, 0}, .extent = vk->swapchain_extent },
+        .clearValueCount = 2,
+        .pClearValues    = clear_values,
+    };
 
-        VkRect2D scissor = { .offset = {0, 0}, .extent = vk->swapchain_extent };
-        vkCmdSetScissor(cmd, 0, 1, &scissor);
+    RecordPass pass = {
+        .vk               = vk,
+        .render_pass      = rp_info.renderPass,
+        .framebuffer      = rp_info.framebuffer,
+        .extent           = rp_info.renderArea.extent,
+        .geo_pipeline     = vk->graphics_pipeline,
+        .pipeline_3d      = vk->graphics_pipeline_3d,
+        .skinned_pipeline = vk->graphics_pipeline_skinned,
+        .text_pipeline    = vk->text_pipeline,
+    };
 
-        /* Draw 2D geometry using bloom scene pipeline */
-        record_geometry_draws(vk, cmd, vk->bloom.scene_graphics_pipeline);
+    return record_scene_pass(vk, cmd, &rp_info, &pass);
+}
 
-        /* Draw 3D geometry using bloom scene 3D pipeline */
-        record_geometry_draws_3d(vk, cmd, vk->bloom.scene_3d_pipeline);
+/* With bloom: the scene into the offscreen HDR target, using the bloom scene
+ * pipelines. Only the render-scaled corner is drawn; the composite
+ * upscales it. */
+static EngineResult record_hdr_scene_pass(VulkanContext *vk, VkCommandBuffer cmd, void *user) {
+    (void)user;
+    VkClearValue clear_values[2];
+    scene_clear_values(vk, clear_values);
+
+    VkRenderPassBeginInfo rp_info = {
+        .sType       = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+        .renderPass  = vk->bloom.scene_render_pass,
+        .framebuffer = vk->bloom.scene_framebuffer,
+        .renderArea  = { .offset = {0, 0}, .extent = vk->bloom.scene_extent },
+        .clearValueCount = 2,
+        .pClearValues    = clear_values,
+    };
 
-        /* Draw skinned 3D geometry using bloom scene skinned pipeline */
-        record_geometry_draws_skinned(vk, cmd, vk->bloom.scene_skinned_pipeline);
+    RecordPass pass = {
+        .vk               = vk,
+        .render_pass      = rp_info.renderPass,
+        .framebuffer      = rp_info.framebuffer,
+        .extent           = rp_info.renderArea.extent,
+        .geo_pipeline     = vk->bloom.scene_graphics_pipeline,
+        .pipeline_3d      = vk->bloom.scene_3d_pipeline,
+        .skinned_pipeline = vk->bloom.scene_skinned_pipeline,
+        .text_pipeline    = vk->bloom.scene_text_pipeline,
+    };
 
-        /* Draw text using bloom scene text pipeline */
-        text_flush_with_pipeline(vk, cmd, vk->bloom.scene_text_pipeline);
+    return record_scene_pass(vk, cmd, &rp_info, &pass);
+}
 
-        vkCmdEndRenderPass(cmd);
+static EngineResult record_bloom_down_pass(VulkanContext *vk, VkCommandBuffer cmd, void *user) {
+    const Renderer *renderer = user;
+    bloom_record_downsample(vk, cmd, &renderer->bloom_settings);
+    return ENGINE_SUCCESS;
+}
 
-        /* Passes 2-5: extract, blur, composite */
-        bloom_record(vk, cmd, &renderer->bloom_settings, image_index);
+static EngineResult record_bloom_up_pass(VulkanContext *vk, VkCommandBuffer cmd, void *user) {
+    (void)user;
+    bloom_record_upsample(vk, cmd);
+    return ENGINE_SUCCESS;
+}
 
-    } else {
-        /* ================================================================
-         * ORIGINAL PATH: Single render pass directly to swapchain
-         * ================================================================ */
+static EngineResult record_composite_pass(VulkanContext *vk, VkCommandBuffer cmd, void *user) {
+    const Renderer *renderer = user;
 
-        VkClearValue clear_values[2];
-        clear_values[0].color = (VkClearColorValue){{
-            vk->clear_color[0], vk->clear_color[1],
-            vk->clear_color[2], vk->clear_color[3]
-        }};
-        clear_values[1].depthStencil = (VkClearDepthStencilValue){ 1.0f, 0 };
+    /* The scene ends before the composite: that pass is the first to wait
+     * on the swapchain image */
+    gpu_profiler_scene_end(vk, cmd);
+    bloom_record_composite(vk, cmd, &renderer->bloom_settings, renderer->current_image_index);
+    return ENGINE_SUCCESS;
+}
 
-        VkRenderPassBeginInfo rp_info = {
-            .sType       = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-            .renderPass  = vk->render_pass,
-            .framebuffer = vk->framebuffers[image_index],
-            .renderArea  = { .offset = {0, 0}, .extent = vk->swapchain_extent },
-            .clearValueCount = 2,
-            .pClearValues    = clear_values,
-        };
+/* Register the frame's passes and what each reads and writes, once every
+ * module has declared its images. The swapchain image and the shared depth
+ * buffer stay with their render passes. With async compute the compute
+ * passes run on the other queue and their buffers are synchronised by the
+ * submit, so they are left out. */
+static void setup_frame_graph(Renderer *r) {
+    VulkanContext *vk = &r->vk;
+    FramePasses *p = &r->passes;
+
+    RgResource skinned = RG_NONE, particles = RG_NONE, clusters = RG_NONE;
+    p->skin = p->particles = p->light_cull = RG_NONE;
+    if (!vk->compute.enabled) {
+        skinned   = render_graph_add_buffer(vk, "skinned_vertices", true);
+        particles = render_graph_add_buffer(vk, "particles", false);
+        clusters  = render_graph_add_buffer(vk, "light_clusters", true);
+
+        p->skin       = render_graph_add_pass(vk, "skin", record_skin_pass, r, false);
+        p->particles  = render_graph_add_pass(vk, "particles", record_particle_pass, r, false);
+        p->light_cull = render_graph_add_pass(vk, "light_cull", record_light_cull_pass, r, false);
+        render_graph_use(vk, p->skin, skinned, RG_ACCESS_COMPUTE_STORAGE);
+        render_graph_use(vk, p->particles, particles, RG_ACCESS_COMPUTE_STORAGE);
+        render_graph_use(vk, p->light_cull, clusters, RG_ACCESS_COMPUTE_STORAGE);
+    }
 
-        vkCmdBeginRenderPass(cmd, &rp_info, VK_SUBPASS_CONTENTS_INLINE);
+    p->shadow = render_graph_add_pass(vk, "shadow", record_shadow_pass, r, false);
+    render_graph_use(vk, p->shadow, vk->shadow.map, RG_ACCESS_DEPTH_ATTACHMENT);
+    render_graph_use(vk, p->shadow, skinned, RG_ACCESS_VERTEX_INPUT);
+
+    /* Both scene variants draw the same things */
+    p->scene     = render_graph_add_pass(vk, "scene", record_swapchain_scene_pass, r, true);
+    p->scene_hdr = render_graph_add_pass(vk, "scene_hdr", record_hdr_scene_pass, r, false);
+    RgPass scenes[] = { p->scene, p->scene_hdr };
+    for (u32 i = 0; i < ENGINE_ARRAY_LEN(scenes); i++) {
+        render_graph_use(vk, scenes[i], vk->shadow.map, RG_ACCESS_FRAGMENT_READ);
+        render_graph_use(vk, scenes[i], skinned, RG_ACCESS_VERTEX_INPUT);
+        render_graph_use(vk, scenes[i], particles, RG_ACCESS_VERTEX_INPUT);
+        render_graph_use(vk, scenes[i], particles, RG_ACCESS_INDIRECT_READ);
+        render_graph_use(vk, scenes[i], clusters, RG_ACCESS_FRAGMENT_READ);
+    }
+    render_graph_use(vk, p->scene_hdr, vk->bloom.scene_target, RG_ACCESS_COLOR_ATTACHMENT);
 
-        VkViewport viewport = {
-            0.0f, 0.0f,
-            (float)vk->swapchain_extent.width, (float)vk->swapchain_extent.height,
-            0.0f, 1.0f,
-        };
-        vkCmdSetViewport(cmd, 0, 1, &viewport);
+    p->bloom_down = render_graph_add_pass(vk, "bloom_down", record_bloom_down_pass, r, false);
+    render_graph_use(vk, p->bloom_down, vk->bloom.scene_target, RG_ACCESS_COMPUTE_READ);
+    render_graph_use(vk, p->bloom_down, vk->bloom.pyramid, RG_ACCESS_COMPUTE_STORAGE);
 
-        VkRect2D scissor = { .offset = {0, 0}, .extent = vk->swapchain_extent };
-        vkCmdSetScissor(cmd, 0, 1, &scissor);
+    p->bloom_up = render_graph_add_pass(vk, "bloom_up", record_bloom_up_pass, r, false);
+    render_graph_use(vk, p->bloom_up, vk->bloom.pyramid, RG_ACCESS_COMPUTE_STORAGE);
 
-        /* Draw 2D geometry using standard pipeline */
-        record_geometry_draws(vk, cmd, vk->graphics_pipeline);
+    p->composite = render_graph_add_pass(vk, "composite", record_composite_pass, r, true);
+    render_graph_use(vk, p->composite, vk->bloom.scene_target, RG_ACCESS_FRAGMENT_READ);
+    render_graph_use(vk, p->composite, vk->bloom.pyramid, RG_ACCESS_FRAGMENT_READ);
 
-        /* Draw 3D geometry using 3D pipeline */
-        record_geometry_draws_3d(vk, cmd, vk->graphics_pipeline_3d);
+    /* The bloom chain only runs when the composite needs it */
+    render_graph_enable_pass(vk, p->bloom_down, true);
+    render_graph_enable_pass(vk, p->bloom_up, true);
+}
 
-        /* Draw skinned 3D geometry using skinned pipeline */
-        record_geometry_draws_skinned(vk, cmd, vk->graphics_pipeline_skinned);
+static EngineResult record_command_buffer(Renderer *renderer, VkCommandBuffer cmd) {
+    VulkanContext *vk = &renderer->vk;
+    const FramePasses *p = &renderer->passes;
 
-        /* Draw text overlay */
-        text_flush(vk, cmd);
+    VkCommandBufferBeginInfo begin_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+    };
 
-        vkCmdEndRenderPass(cmd);
+    if (vkBeginCommandBuffer(cmd, &begin_info) != VK_SUCCESS) {
+        LOG_ERROR("Failed to begin recording command buffer");
+        return ENGINE_ERROR_VULKAN_INIT;
     }
 
+    gpu_profiler_frame_begin(vk, cmd);
+
+    /* The graph culls whatever the enabled outputs don't need and places the
+     * barriers between what's left */
+    render_graph_enable_pass(vk, p->skin, vk->skin_compute.vertex_count > 0);
+    render_graph_enable_pass(vk, p->particles, vk->gpu_particles.active);
+    render_graph_enable_pass(vk, p->light_cull, light_cluster_active(vk));
+    render_graph_enable_pass(vk, p->shadow, shadow_active(vk));
+    render_graph_enable_pass(vk, p->scene, !vk->bloom.enabled);
+    render_graph_enable_pass(vk, p->scene_hdr, vk->bloom.enabled);
+    render_graph_enable_pass(vk, p->composite, vk->bloom.enabled);
+
+    EngineResult res = render_graph_execute(vk, cmd);
+    if (res != ENGINE_SUCCESS) return res;
+
+    /* Without bloom the scene pass draws to the swapchain, so its time
+     * includes any wait for the image */
+    if (!vk->bloom.enabled) gpu_profiler_scene_end(vk, cmd);
+    gpu_profiler_frame_end(vk, cmd);
+
     if (vkEndCommandBuffer(cmd) != VK_SUCCESS) {
         LOG_ERROR("Failed to record command buffer");
         return ENGINE_ERROR_VULKAN_INIT;
@@ -407,6 +1955,9 @@ static void compute_vp_matrix(VulkanContext *vk, const Camera2D *camera) {
 
     /* Store as flat float[16] for push constants */
     memcpy(vk->vp_matrix, vp, sizeof(float) * 16);
+
+    /* 3D draws under a 2D camera are not culled */
+    vk->frustum_valid = false;
 }
 
 static void compute_vp_matrix_3d(VulkanContext *vk, const Camera3D *camera) {
@@ -430,10 +1981,88 @@ static void compute_vp_matrix_3d(VulkanContext *vk, const Camera3D *camera) {
 
     memcpy(vk->vp_matrix, vp, sizeof(float) * 16);
 
+    /* Frustum planes for culling 3D draws submitted under this camera */
+    vec4 planes[6];
+    glm_frustum_planes(vp, planes);
+    for (u32 i = 0; i < 6; i++) {
+        memcpy(vk->frustum_planes[i], planes[i], sizeof(float) * 4);
+    }
+    vk->frustum_valid = true;
+    vk->lod_projection_scale = 1.0f / tanf(fov_rad * 0.5f);
+
     /* Cache camera position for specular lighting */
     vk->view_position[0] = camera->position[0];
     vk->view_position[1] = camera->position[1];
     vk->view_position[2] = camera->position[2];
+
+    /* The shadow cascades split this camera's view, the light grid bins it */
+    shadow_set_camera(vk, camera, aspect);
+    light_cluster_set_camera(vk, (const f32 *)view, (const f32 *)vp, camera, aspect);
+}
+
+/* --------------------------------------------------------------------------
+ * Parallel pipeline creation
+ *
+ * Pipelines only read the layouts and render passes created before them, so
+ * each one is compiled as a job while renderer_create carries on with
+ * buffers, textures and fonts. All share the (internally synchronized)
+ * pipeline cache. Without a running job system they are built inline.
+ * ------------------------------------------------------------------------ */
+
+typedef EngineResult (*PipelineBuildFn)(VulkanContext *vk);
+
+static const PipelineBuildFn pipeline_builders[] = {
+    vk_create_graphics_pipeline,
+    vk_create_text_pipeline,
+    vk_create_3d_pipeline,
+    vk_create_skinned_3d_pipeline,
+    vk_create_bloom_scene_pipelines,
+    vk_create_bloom_scene_3d_pipeline,
+    vk_create_bloom_scene_skinned_3d_pipeline,
+    bloom_create_postprocess_pipelines,
+    vk_create_shadow_3d_pipeline,
+    vk_create_shadow_skinned_3d_pipeline,
+};
+
+#define PIPELINE_BUILDER_COUNT ENGINE_ARRAY_LEN(pipeline_builders)
+
+typedef struct PipelineBuild PipelineBuild;
+
+typedef struct {
+    PipelineBuild *build;
+    u32            index;
+} PipelineTask;
+
+struct PipelineBuild {
+    VulkanContext *vk;
+    JobCounter     counter;
+    PipelineTask   tasks[PIPELINE_BUILDER_COUNT];
+    EngineResult   results[PIPELINE_BUILDER_COUNT];
+};
+
+static void pipeline_build_job(void *data) {
+    PipelineTask *t = data;
+    t->build->results[t->index] = pipeline_builders[t->index](t->build->vk);
+}
+
+static void pipeline_build_start(PipelineBuild *b, VulkanContext *vk) {
+    b->vk = vk;
+
+    Job jobs[PIPELINE_BUILDER_COUNT];
+    for (u32 i = 0; i < PIPELINE_BUILDER_COUNT; i++) {
+        b->tasks[i] = (PipelineTask){ b, i };
+        jobs[i] = (Job){ pipeline_build_job, &b->tasks[i], NULL };
+    }
+    jobs_run(jobs, PIPELINE_BUILDER_COUNT, &b->counter);
+}
+
+/* Join the build (no-op if it never started). Returns the first failure. */
+static EngineResult pipeline_build_wait(PipelineBuild *b) {
+    jobs_wait(&b->counter);
+    for (u32 i = 0; i < PIPELINE_BUILDER_COUNT; i++) {
+        if (b->results[i] != ENGINE_SUCCESS) return b->results[i];
+    }
+    return ENGINE_SUCCESS;
 }
 
 /* --------------------------------------------------------------------------
@@ -446,6 +2075,7 @@ EngineResult renderer_create(Window *window, const RendererConfig *config,
     if (!r) return ENGINE_ERROR_OUT_OF_MEMORY;
 
     r->window = window;
+    PipelineBuild pipelines = {0};
 
     /* Default bloom settings */
     BloomSettings default_bloom = BLOOM_SETTINGS_DEFAULT;
@@ -462,6 +2092,21 @@ EngineResult renderer_create(Window *window, const RendererConfig *config,
         r->vk.clear_color[3] = 1.0f;
     }
 
+    /* Vertex format is fixed for the renderer's lifetime (buffers + pipelines) */
+    r->vk.packed_vertices = config->packed_vertices;
+    r->vk.mesh_lods       = config->mesh_lods;
+    r->vk.instance_format_3d = config->instance_format_3d;
+
+    /* Presentation and latency: a frame slot count outside 1..max falls
+     * back to the default */
+    r->vk.frames_in_flight = config->frames_in_flight;
+    if (r->vk.frames_in_flight == 0 || r->vk.frames_in_flight > MAX_FRAMES_IN_FLIGHT)
+        r->vk.frames_in_flight = DEFAULT_FRAMES_IN_FLIGHT;
+    r->vk.present_mode_request = config->present_mode;
+    r->vk.pacing.present_wait  = config->present_wait;
+    frame_pacing_set_max_fps(&r->vk, config->max_fps);
+    LOG_INFO("Frames in flight: %u", r->vk.frames_in_flight);
+
     i32 width, height;
     window_get_framebuffer_size(window, &width, &height);
 
@@ -473,146 +2118,145 @@ EngineResult renderer_create(Window *window, const RendererConfig *config,
     if ((res = vk_create_surface(&r->vk, window))    != ENGINE_SUCCESS) goto fail;
     if ((res = vk_pick_physical_device(&r->vk))      != ENGINE_SUCCESS) goto fail;
     if ((res = vk_create_logical_device(&r->vk))     != ENGINE_SUCCESS) goto fail;
+    if ((res = vk_memory_init(&r->vk))               != ENGINE_SUCCESS) goto fail;
     if ((res = vk_create_swapchain(&r->vk, width, height)) != ENGINE_SUCCESS) goto fail;
     if ((res = vk_create_image_views(&r->vk))        != ENGINE_SUCCESS) goto fail;
+    if ((res = vk_create_pipeline_cache(&r->vk, PIPELINE_CACHE_PATH)) != ENGINE_SUCCESS) goto fail;
     if ((res = vk_create_render_pass(&r->vk))        != ENGINE_SUCCESS) goto fail;
-    if ((res = vk_create_graphics_pipeline(&r->vk))  != ENGINE_SUCCESS) goto fail;
-    if ((res = vk_create_text_pipeline(&r->vk))      != ENGINE_SUCCESS) goto fail;
+    if ((res = vk_create_pipeline_layouts(&r->vk))   != ENGINE_SUCCESS) goto fail;
     if ((res = vk_create_depth_resources(&r->vk))    != ENGINE_SUCCESS) goto fail;
     if ((res = vk_create_framebuffers(&r->vk))       != ENGINE_SUCCESS) goto fail;
     if ((res = vk_create_command_pool(&r->vk))       != ENGINE_SUCCESS) goto fail;
 
+    /* Compute-only queue, if any (before the buffers it shares are created) */
+    if ((res = async_compute_init(&r->vk)) != ENGINE_SUCCESS) goto fail;
+
+    /* Frame graph; modules declare their transient images into it */
+    render_graph_init(&r->vk);
+
+    /* Bloom post-processing (render passes + targets — disabled by default) */
+    if ((res = bloom_init(&r->vk)) != ENGINE_SUCCESS) goto fail;
+
+    /* Shadow map + depth-only render pass (shadows stay off until enabled) */
+    if ((res = shadow_init(&r->vk, config->shadow_map_size)) != ENGINE_SUCCESS) goto fail;
+
+    /* Point/spot light ring, cluster grid and the binning compute pipeline */
+    if ((res = light_cluster_init(&r->vk)) != ENGINE_SUCCESS) goto fail;
+
+    /* Every layout and render pass exists now: compile pipelines as jobs
+     * while the rest of the resources are created */
+    pipeline_build_start(&pipelines, &r->vk);
+
+    /* Upload manager (before any GPU-local buffer or texture is created) */
+    if ((res = vk_upload_init(&r->vk, UPLOAD_STAGING_SIZE)) != ENGINE_SUCCESS) goto fail;
+    asset_load_init(&r->vk);
+
+    /* Mesh and texture handle tables (before the first mesh or texture) */
+    if ((res = resource_table_init(&r->vk)) != ENGINE_SUCCESS) goto fail;
+
     /* Shared vertex buffer (pre-allocated, meshes appended via staging) */
     if ((res = vk_create_vertex_buffer(&r->vk, MAX_VERTICES)) != ENGINE_SUCCESS) goto fail;
 
+    /* Sprite batcher (shared quad mesh; atlas pages are built on demand) */
+    if ((res = sprite_batch_init(&r->vk)) != ENGINE_SUCCESS) goto fail;
+
     /* Text rendering init */
     if ((res = text_init(&r->vk, config->font_path, config->font_size)) != ENGINE_SUCCESS) goto fail;
 
-    /* Instance buffer (CPU-visible, persistently mapped, updated every frame) */
+    /* Frame arena (backs the growable draw lists, reset every frame) */
     {
-        VkDeviceSize buf_size = sizeof(InstanceData) * MAX_INSTANCES;
-        r->vk.instance_capacity = MAX_INSTANCES;
-        r->vk.instance_count = 0;
+        void *arena_buf = malloc(FRAME_ARENA_INITIAL_SIZE);
+        if (!arena_buf) {
+            LOG_FATAL("Failed to allocate frame arena");
+            res = ENGINE_ERROR_OUT_OF_MEMORY;
+            goto fail;
+        }
+        arena_init_growable(&r->vk.frame_arena, arena_buf, FRAME_ARENA_INITIAL_SIZE,
+                            FRAME_ARENA_INITIAL_SIZE);
+    }
 
-        res = vk_create_buffer(&r->vk, buf_size,
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            &r->vk.instance_buffer, &r->vk.instance_buffer_memory);
-        if (res != ENGINE_SUCCESS) goto fail;
+    /* Instance buffer (per-frame ring, persistently mapped, grows on demand) */
+    {
+        r->vk.instance_capacity = INITIAL_INSTANCE_CAPACITY;
+        r->vk.instance_count = 0;
 
-        if (vkMapMemory(r->vk.device, r->vk.instance_buffer_memory,
-                        0, buf_size, 0, &r->vk.instance_mapped) != VK_SUCCESS) {
-            LOG_FATAL("Failed to persistently map instance buffer");
-            res = ENGINE_ERROR_VULKAN_INIT;
+        res = vk_create_frame_ring(&r->vk, sizeof(InstanceData) * INITIAL_INSTANCE_CAPACITY,
+                                   VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, &r->vk.instance_ring);
+        if (res != ENGINE_SUCCESS) {
+            LOG_FATAL("Failed to create instance ring buffer");
             goto fail;
         }
     }
 
-    /* 1x1 white dummy texture — bound for untextured draws so the descriptor
-     * set 0 (sampler) is always valid, even when the shader doesn't sample it. */
+    /* 1x1 white dummy texture — slot 0 of the texture table, sampled by
+     * nothing (texture_index 0 means untextured) but keeps the slot valid. */
     {
         u8 white_pixel[] = { 255, 255, 255, 255 };
         res = vk_create_texture(&r->vk, white_pixel, 1, 1,
-                                VK_FORMAT_R8G8B8A8_SRGB, VK_FILTER_NEAREST,
+                                VK_FORMAT_R8G8B8A8_SRGB, VK_FILTER_NEAREST, false,
                                 &r->vk.dummy_texture);
         if (res != ENGINE_SUCCESS) goto fail;
 
-        VkDescriptorSetAllocateInfo alloc_info = {
-            .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-            .descriptorPool     = r->vk.geo_desc_pool,
-            .descriptorSetCount = 1,
-            .pSetLayouts        = &r->vk.geo_desc_set_layout,
-        };
-        if (vkAllocateDescriptorSets(r->vk.device, &alloc_info,
-                                      &r->vk.dummy_desc_set) != VK_SUCCESS) {
-            LOG_FATAL("Failed to allocate dummy descriptor set");
-            res = ENGINE_ERROR_VULKAN_INIT;
-            goto fail;
-        }
-
-        VkDescriptorImageInfo img_info = {
-            .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-            .imageView   = r->vk.dummy_texture.view,
-            .sampler     = r->vk.dummy_texture.sampler,
-        };
-        VkWriteDescriptorSet write = {
-            .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-            .dstSet          = r->vk.dummy_desc_set,
-            .dstBinding      = 0,
-            .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-            .descriptorCount = 1,
-            .pImageInfo      = &img_info,
-        };
-        vkUpdateDescriptorSets(r->vk.device, 1, &write, 0, NULL);
+        if ((res = texture_table_create(&r->vk)) != ENGINE_SUCCESS) goto fail;
     }
 
-    /* ---- 3D pipeline and buffers ---- */
-    if ((res = vk_create_3d_pipeline(&r->vk)) != ENGINE_SUCCESS) goto fail;
+    /* ---- 3D buffers ---- */
     if ((res = vk_create_vertex_buffer_3d(&r->vk, MAX_VERTICES_3D)) != ENGINE_SUCCESS) goto fail;
     if ((res = vk_create_index_buffer(&r->vk, MAX_INDICES)) != ENGINE_SUCCESS) goto fail;
 
-    /* 3D instance buffer (CPU-visible, persistently mapped) */
+    /* 3D instance buffer (per-frame ring, persistently mapped) */
     {
-        VkDeviceSize buf_size = sizeof(InstanceData3D) * MAX_INSTANCES;
-        r->vk.instance_3d_capacity = MAX_INSTANCES;
+        r->vk.instance_3d_capacity = INITIAL_INSTANCE_CAPACITY;
         r->vk.instance_3d_count = 0;
 
-        res = vk_create_buffer(&r->vk, buf_size,
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            &r->vk.instance_buffer_3d, &r->vk.instance_buffer_3d_memory);
-        if (res != ENGINE_SUCCESS) goto fail;
-
-        if (vkMapMemory(r->vk.device, r->vk.instance_buffer_3d_memory,
-                        0, buf_size, 0, &r->vk.instance_3d_mapped) != VK_SUCCESS) {
-            LOG_FATAL("Failed to map 3D instance buffer");
-            res = ENGINE_ERROR_VULKAN_INIT;
+        res = vk_create_frame_ring(&r->vk,
+                                   (VkDeviceSize)vk_instance_3d_stride(&r->vk) * INITIAL_INSTANCE_CAPACITY,
+                                   VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, &r->vk.instance_ring_3d);
+        if (res != ENGINE_SUCCESS) {
+            LOG_FATAL("Failed to create 3D instance ring buffer");
             goto fail;
         }
     }
 
-    /* Light UBO (std140 layout, 80 bytes, persistently mapped) */
-    {
-        VkDeviceSize ubo_size = 80;
-        res = vk_create_buffer(&r->vk, ubo_size,
-            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            &r->vk.light_ubo, &r->vk.light_ubo_memory);
-        if (res != ENGINE_SUCCESS) goto fail;
+    /* 3D indirect draw records (per-frame ring, only with multiDrawIndirect) */
+    if (r->vk.multi_draw_indirect) {
+        r->vk.indirect_3d_capacity = INITIAL_DRAW_COMMANDS;
 
-        if (vkMapMemory(r->vk.device, r->vk.light_ubo_memory,
-                        0, ubo_size, 0, &r->vk.light_ubo_mapped) != VK_SUCCESS) {
-            LOG_FATAL("Failed to map light UBO");
-            res = ENGINE_ERROR_VULKAN_INIT;
+        res = vk_create_frame_ring(&r->vk, sizeof(VkDrawIndexedIndirectCommand) * INITIAL_DRAW_COMMANDS,
+                                   VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, &r->vk.indirect_ring_3d);
+        if (res != ENGINE_SUCCESS) {
+            LOG_FATAL("Failed to create 3D indirect draw buffer");
             goto fail;
         }
+    }
+
+    /* Light UBO (LightUniforms, std140) as a per-frame ring; one light set
+     * per frame in flight pairs its region with the shadow map, that frame's
+     * point/spot lights and the light clusters */
+    {
+        res = vk_create_frame_ring(&r->vk, sizeof(LightUniforms),
+                                   VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, &r->vk.light_ring);
+        if (res != ENGINE_SUCCESS) goto fail;
 
-        /* Write default light */
-        struct {
-            f32 direction[4]; /* xyz + pad */
-            f32 color[4];
-            f32 ambient[4];
-            f32 view_pos[4];
-            f32 shininess[4];
-        } default_light = {
-            .direction = { 0.0f, -1.0f, 0.0f, 0.0f },
-            .color     = { 1.0f,  1.0f, 1.0f, 0.0f },
-            .ambient   = { 0.1f,  0.1f, 0.1f, 0.0f },
-            .view_pos  = { 0.0f,  0.0f, 0.0f, 0.0f },
-            .shininess = { 32.0f, 0.0f, 0.0f, 0.0f },
+        /* Default light: straight down, white, dim ambient */
+        r->vk.light = (DirectionalLight){
+            .direction = { 0.0f, -1.0f, 0.0f },
+            .color     = { 1.0f,  1.0f, 1.0f },
+            .ambient   = { 0.1f,  0.1f, 0.1f },
+            .shininess = 32.0f,
         };
-        memcpy(r->vk.light_ubo_mapped, &default_light, sizeof(default_light));
 
-        /* Light descriptor pool (1 UBO) */
-        VkDescriptorPoolSize pool_size = {
-            .type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-            .descriptorCount = 1,
+        /* Light descriptor pool (1 UBO + 1 shadow map + 2 SSBOs per frame) */
+        VkDescriptorPoolSize pool_sizes[] = {
+            { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,         r->vk.frames_in_flight },
+            { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, r->vk.frames_in_flight },
+            { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         r->vk.frames_in_flight * 2 },
         };
         VkDescriptorPoolCreateInfo pool_info = {
             .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-            .maxSets       = 1,
-            .poolSizeCount = 1,
-            .pPoolSizes    = &pool_size,
+            .maxSets       = r->vk.frames_in_flight,
+            .poolSizeCount = ENGINE_ARRAY_LEN(pool_sizes),
+            .pPoolSizes    = pool_sizes,
         };
         if (vkCreateDescriptorPool(r->vk.device, &pool_info, NULL,
                                     &r->vk.light_desc_pool) != VK_SUCCESS) {
@@ -621,89 +2265,113 @@ EngineResult renderer_create(Window *window, const RendererConfig *config,
             goto fail;
         }
 
-        /* Allocate light descriptor set */
+        /* Allocate light descriptor sets */
+        VkDescriptorSetLayout layouts[MAX_FRAMES_IN_FLIGHT];
+        for (u32 i = 0; i < r->vk.frames_in_flight; i++) layouts[i] = r->vk.light_desc_set_layout;
         VkDescriptorSetAllocateInfo alloc_info = {
             .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
             .descriptorPool     = r->vk.light_desc_pool,
-            .descriptorSetCount = 1,
-            .pSetLayouts        = &r->vk.light_desc_set_layout,
+            .descriptorSetCount = r->vk.frames_in_flight,
+            .pSetLayouts        = layouts,
         };
         if (vkAllocateDescriptorSets(r->vk.device, &alloc_info,
-                                      &r->vk.light_desc_set) != VK_SUCCESS) {
-            LOG_FATAL("Failed to allocate light descriptor set");
+                                      r->vk.light_desc_sets) != VK_SUCCESS) {
+            LOG_FATAL("Failed to allocate light descriptor sets");
             res = ENGINE_ERROR_VULKAN_INIT;
             goto fail;
         }
 
-        /* Write UBO to descriptor set */
-        VkDescriptorBufferInfo buf_info = {
-            .buffer = r->vk.light_ubo,
-            .offset = 0,
-            .range  = ubo_size,
-        };
-        VkWriteDescriptorSet write = {
-            .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-            .dstSet          = r->vk.light_desc_set,
-            .dstBinding      = 0,
-            .descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-            .descriptorCount = 1,
-            .pBufferInfo     = &buf_info,
-        };
-        vkUpdateDescriptorSets(r->vk.device, 1, &write, 0, NULL);
+        /* Write each frame's UBO, light regions and clusters to its set; the
+         * shadow map follows once the render graph has created it */
+        for (u32 i = 0; i < r->vk.frames_in_flight; i++) {
+            VkDescriptorBufferInfo buf_info = {
+                .buffer = r->vk.light_ring.buffer,
+                .offset = r->vk.light_ring.frame_size * i,
+                .range  = sizeof(LightUniforms),
+            };
+            const LightClusterContext *lc = &r->vk.light_cluster;
+            VkDescriptorBufferInfo light_info = {
+                .buffer = lc->light_ring.buffer,
+                .offset = lc->light_ring.frame_size * i,
+                .range  = lc->light_ring.frame_size,
+            };
+            VkDescriptorBufferInfo cluster_info = {
+                .buffer = lc->clusters,
+                .offset = lc->cluster_frame_size * i,
+                .range  = lc->cluster_frame_size,
+            };
+            VkWriteDescriptorSet writes[] = {
+                {
+                    .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet          = r->vk.light_desc_sets[i],
+                    .dstBinding      = 0,
+                    .descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                    .descriptorCount = 1,
+                    .pBufferInfo     = &buf_info,
+                },
+                {
+                    .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet          = r->vk.light_desc_sets[i],
+                    .dstBinding      = 2,
+                    .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .descriptorCount = 1,
+                    .pBufferInfo     = &light_info,
+                },
+                {
+                    .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet          = r->vk.light_desc_sets[i],
+                    .dstBinding      = 3,
+                    .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .descriptorCount = 1,
+                    .pBufferInfo     = &cluster_info,
+                },
+            };
+            vkUpdateDescriptorSets(r->vk.device, ENGINE_ARRAY_LEN(writes), writes, 0, NULL);
+        }
     }
 
-    /* ---- Skinned 3D pipeline and buffers ---- */
-    if ((res = vk_create_skinned_3d_pipeline(&r->vk)) != ENGINE_SUCCESS) goto fail;
+    /* ---- Skinned 3D buffers ---- */
     if ((res = vk_create_vertex_buffer_skinned(&r->vk, MAX_SKINNED_VERTICES_3D)) != ENGINE_SUCCESS) goto fail;
 
-    /* Skinned instance buffer (CPU-visible, persistently mapped, reuses InstanceData3D) */
+    /* Skinned instance buffer (per-frame ring, same instance format as 3D) */
     {
-        VkDeviceSize buf_size = sizeof(InstanceData3D) * MAX_SKINNED_DRAW_COMMANDS;
-        r->vk.instance_skinned_capacity = MAX_SKINNED_DRAW_COMMANDS;
+        r->vk.instance_skinned_capacity = INITIAL_SKINNED_DRAW_COMMANDS;
         r->vk.instance_skinned_count = 0;
 
-        res = vk_create_buffer(&r->vk, buf_size,
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            &r->vk.instance_buffer_skinned, &r->vk.instance_buffer_skinned_memory);
-        if (res != ENGINE_SUCCESS) goto fail;
-
-        if (vkMapMemory(r->vk.device, r->vk.instance_buffer_skinned_memory,
-                        0, buf_size, 0, &r->vk.instance_skinned_mapped) != VK_SUCCESS) {
-            LOG_FATAL("Failed to map skinned instance buffer");
-            res = ENGINE_ERROR_VULKAN_INIT;
+        res = vk_create_frame_ring(&r->vk,
+                                   (VkDeviceSize)vk_instance_3d_stride(&r->vk) * INITIAL_SKINNED_DRAW_COMMANDS,
+                                   VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, &r->vk.instance_ring_skinned);
+        if (res != ENGINE_SUCCESS) {
+            LOG_FATAL("Failed to create skinned instance ring buffer");
             goto fail;
         }
     }
 
-    /* Joint matrix SSBO (CPU-visible, persistently mapped) */
+    /* Joint matrix SSBO (per-frame ring, bound with a dynamic offset) */
     {
-        /* 128 joints * 64 bytes * 64 draws = ~512 KB */
-        u32 ssbo_capacity = MAX_JOINTS * sizeof(f32) * 16 * MAX_SKINNED_DRAW_COMMANDS;
-        r->vk.joint_ssbo_capacity = ssbo_capacity;
+        /* 128 joints * 48 bytes * 64 draws = 384 KB per frame in flight (grows on demand) */
+        u32 ssbo_capacity = MAX_JOINTS * JOINT_AFFINE_BYTES * INITIAL_SKINNED_DRAW_COMMANDS;
         r->vk.joint_ssbo_used_bytes = 0;
 
-        res = vk_create_buffer(&r->vk, ssbo_capacity,
-            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            &r->vk.joint_ssbo, &r->vk.joint_ssbo_memory);
-        if (res != ENGINE_SUCCESS) goto fail;
-
-        if (vkMapMemory(r->vk.device, r->vk.joint_ssbo_memory,
-                        0, ssbo_capacity, 0, &r->vk.joint_ssbo_mapped) != VK_SUCCESS) {
-            LOG_FATAL("Failed to map joint SSBO");
-            res = ENGINE_ERROR_VULKAN_INIT;
+        res = vk_create_frame_ring(&r->vk, ssbo_capacity,
+                                   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, &r->vk.joint_ring);
+        if (res != ENGINE_SUCCESS) {
+            LOG_FATAL("Failed to create joint SSBO ring buffer");
             goto fail;
         }
+        r->vk.joint_ssbo_capacity = (u32)r->vk.joint_ring.frame_size;
 
-        /* Joint SSBO descriptor pool (1 SSBO) */
+        /* Joint SSBO descriptor pool. Sets are reallocated when the ring grows
+         * (the old set may still be bound in flight), so leave room for the
+         * retired ones and allow individual frees. */
         VkDescriptorPoolSize pool_size = {
-            .type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-            .descriptorCount = 1,
+            .type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+            .descriptorCount = MAX_RETIRED_RINGS + 2,
         };
         VkDescriptorPoolCreateInfo pool_info = {
             .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-            .maxSets       = 1,
+            .flags         = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,
+            .maxSets       = MAX_RETIRED_RINGS + 2,
             .poolSizeCount = 1,
             .pPoolSizes    = &pool_size,
         };
@@ -714,48 +2382,36 @@ EngineResult renderer_create(Window *window, const RendererConfig *config,
             goto fail;
         }
 
-        /* Allocate joint descriptor set */
-        VkDescriptorSetAllocateInfo alloc_info = {
-            .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-            .descriptorPool     = r->vk.joint_desc_pool,
-            .descriptorSetCount = 1,
-            .pSetLayouts        = &r->vk.joint_desc_set_layout,
-        };
-        if (vkAllocateDescriptorSets(r->vk.device, &alloc_info,
-                                      &r->vk.joint_desc_set) != VK_SUCCESS) {
-            LOG_FATAL("Failed to allocate joint descriptor set");
-            res = ENGINE_ERROR_VULKAN_INIT;
+        /* Allocate + write joint descriptor set for the joint ring */
+        if ((res = alloc_joint_desc_set(&r->vk, &r->vk.joint_desc_set)) != ENGINE_SUCCESS) {
+            LOG_FATAL("Failed to set up joint SSBO descriptor");
             goto fail;
         }
-
-        /* Write SSBO to descriptor set */
-        VkDescriptorBufferInfo buf_info = {
-            .buffer = r->vk.joint_ssbo,
-            .offset = 0,
-            .range  = ssbo_capacity,
-        };
-        VkWriteDescriptorSet write = {
-            .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-            .dstSet          = r->vk.joint_desc_set,
-            .dstBinding      = 0,
-            .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-            .descriptorCount = 1,
-            .pBufferInfo     = &buf_info,
-        };
-        vkUpdateDescriptorSets(r->vk.device, 1, &write, 0, NULL);
     }
 
-    /* Bloom post-processing (creates all bloom resources — disabled by default) */
-    if ((res = bloom_init(&r->vk)) != ENGINE_SUCCESS) goto fail;
+    /* Compute skinning pre-pass (off until renderer_set_compute_skinning) */
+    if ((res = skin_compute_init(&r->vk)) != ENGINE_SUCCESS) goto fail;
+
+    /* GPU particle systems (created on demand) */
+    if ((res = gpu_particles_init(&r->vk)) != ENGINE_SUCCESS) goto fail;
 
     if ((res = vk_create_command_buffers(&r->vk))    != ENGINE_SUCCESS) goto fail;
     if ((res = vk_create_sync_objects(&r->vk))       != ENGINE_SUCCESS) goto fail;
+    if ((res = gpu_profiler_init(&r->vk))            != ENGINE_SUCCESS) goto fail;
+
+    /* Every pass and image is known: build the graph's images */
+    setup_frame_graph(r);
+    if ((res = bind_graph_images(&r->vk)) != ENGINE_SUCCESS) goto fail;
+
+    if ((res = pipeline_build_wait(&pipelines)) != ENGINE_SUCCESS) goto fail;
 
     LOG_INFO("Renderer initialized successfully");
     *out_renderer = r;
     return ENGINE_SUCCESS;
 
 fail:
+    /* Pipeline jobs still reference r->vk */
+    pipeline_build_wait(&pipelines);
     free(r);
     return res;
 }
@@ -766,44 +2422,49 @@ void renderer_destroy(Renderer *renderer) {
 
         vkDeviceWaitIdle(vk->device);
 
+        /* Persist compiled pipelines for the next launch */
+        vk_save_pipeline_cache(vk, PIPELINE_CACHE_PATH);
+
+        /* Async loads still decoding are dropped without callbacks */
+        asset_load_shutdown(vk);
+
+        /* Upload manager (waits for any batch still in flight) */
+        vk_upload_shutdown(vk);
+
         /* Bloom cleanup */
         bloom_shutdown(vk);
+        shadow_shutdown(vk);
+        light_cluster_shutdown(vk);
+        render_graph_shutdown(vk);
+
+        /* Grown-out rings (device is idle, nothing references them) */
+        release_retired_rings(vk, true);
+
+        /* Unloaded meshes and textures, then the handle tables */
+        resource_table_shutdown(vk);
+
+        /* Per-thread secondary command pools */
+        secondary_pools_destroy(vk);
+        async_compute_shutdown(vk);
+        gpu_profiler_shutdown(vk);
+
+        /* Per-frame draw lists + frame arena */
+        draw_list_release(&vk->draw_list);
+        draw_list_release(&vk->draw_list_3d);
+        draw_list_release(&vk->draw_list_skinned);
+        for (u32 c = 0; c < SHADOW_CASCADES; c++) draw_list_release(&vk->shadow.draw_lists[c]);
+        arena_release(&vk->frame_arena);
+        free(vk->frame_arena.buf);
 
         /* 2D Instance buffer cleanup */
-        if (vk->instance_mapped) {
-            vkUnmapMemory(vk->device, vk->instance_buffer_memory);
-            vk->instance_mapped = NULL;
-        }
-        if (vk->instance_buffer) {
-            vkDestroyBuffer(vk->device, vk->instance_buffer, NULL);
-            vkFreeMemory(vk->device, vk->instance_buffer_memory, NULL);
-        }
+        vk_destroy_frame_ring(vk, &vk->instance_ring);
 
         /* 3D cleanup */
-        if (vk->instance_3d_mapped) {
-            vkUnmapMemory(vk->device, vk->instance_buffer_3d_memory);
-            vk->instance_3d_mapped = NULL;
-        }
-        if (vk->instance_buffer_3d) {
-            vkDestroyBuffer(vk->device, vk->instance_buffer_3d, NULL);
-            vkFreeMemory(vk->device, vk->instance_buffer_3d_memory, NULL);
-        }
-        if (vk->vertex_buffer_3d) {
-            vkDestroyBuffer(vk->device, vk->vertex_buffer_3d, NULL);
-            vkFreeMemory(vk->device, vk->vertex_buffer_3d_memory, NULL);
-        }
-        if (vk->index_buffer) {
-            vkDestroyBuffer(vk->device, vk->index_buffer, NULL);
-            vkFreeMemory(vk->device, vk->index_buffer_memory, NULL);
-        }
-        if (vk->light_ubo_mapped) {
-            vkUnmapMemory(vk->device, vk->light_ubo_memory);
-            vk->light_ubo_mapped = NULL;
-        }
-        if (vk->light_ubo) {
-            vkDestroyBuffer(vk->device, vk->light_ubo, NULL);
-            vkFreeMemory(vk->device, vk->light_ubo_memory, NULL);
-        }
+        vk_destroy_frame_ring(vk, &vk->instance_ring_3d);
+        vk_destroy_frame_ring(vk, &vk->indirect_ring_3d);
+        vk_destroy_buffer(vk, &vk->vertex_buffer_3d, &vk->vertex_buffer_3d_memory);
+        vk_destroy_buffer(vk, &vk->index_buffer, &vk->index_buffer_memory);
+        vk_destroy_frame_ring(vk, &vk->light_ring);
         if (vk->light_desc_pool)
             vkDestroyDescriptorPool(vk->device, vk->light_desc_pool, NULL);
         if (vk->light_desc_set_layout)
@@ -812,30 +2473,17 @@ void renderer_destroy(Renderer *renderer) {
             vkDestroyPipeline(vk->device, vk->graphics_pipeline_3d, NULL);
         if (vk->pipeline_layout_3d)
             vkDestroyPipelineLayout(vk->device, vk->pipeline_layout_3d, NULL);
-
-        /* Skinned 3D cleanup */
-        if (vk->instance_skinned_mapped) {
-            vkUnmapMemory(vk->device, vk->instance_buffer_skinned_memory);
-            vk->instance_skinned_mapped = NULL;
-        }
-        if (vk->instance_buffer_skinned) {
-            vkDestroyBuffer(vk->device, vk->instance_buffer_skinned, NULL);
-            vkFreeMemory(vk->device, vk->instance_buffer_skinned_memory, NULL);
-        }
-        if (vk->joint_ssbo_mapped) {
-            vkUnmapMemory(vk->device, vk->joint_ssbo_memory);
-            vk->joint_ssbo_mapped = NULL;
-        }
-        if (vk->joint_ssbo) {
-            vkDestroyBuffer(vk->device, vk->joint_ssbo, NULL);
-            vkFreeMemory(vk->device, vk->joint_ssbo_memory, NULL);
-        }
+
+        gpu_particles_shutdown(vk);
+        static_batch_shutdown(vk);
+
+        /* Skinned 3D cleanup */
+        skin_compute_shutdown(vk);
+        vk_destroy_frame_ring(vk, &vk->instance_ring_skinned);
+        vk_destroy_frame_ring(vk, &vk->joint_ring);
         if (vk->joint_desc_pool)
             vkDestroyDescriptorPool(vk->device, vk->joint_desc_pool, NULL);
-        if (vk->vertex_buffer_skinned) {
-            vkDestroyBuffer(vk->device, vk->vertex_buffer_skinned, NULL);
-            vkFreeMemory(vk->device, vk->vertex_buffer_skinned_memory, NULL);
-        }
+        vk_destroy_buffer(vk, &vk->vertex_buffer_skinned, &vk->vertex_buffer_skinned_memory);
         if (vk->graphics_pipeline_skinned)
             vkDestroyPipeline(vk->device, vk->graphics_pipeline_skinned, NULL);
         if (vk->pipeline_layout_skinned)
@@ -843,12 +2491,18 @@ void renderer_destroy(Renderer *renderer) {
         if (vk->joint_desc_set_layout)
             vkDestroyDescriptorSetLayout(vk->device, vk->joint_desc_set_layout, NULL);
 
-        /* Texture cleanup */
+        /* Texture cleanup (released slots are zeroed, so safe to destroy) */
         for (u32 i = 0; i < vk->texture_count; i++) {
             vk_destroy_texture(vk, &vk->textures[i]);
         }
         vk_destroy_texture(vk, &vk->dummy_texture);
 
+        range_alloc_destroy(&vk->vertex_ranges);
+        range_alloc_destroy(&vk->vertex_3d_ranges);
+        range_alloc_destroy(&vk->vertex_skinned_ranges);
+        range_alloc_destroy(&vk->index_ranges);
+
+        sprite_batch_shutdown(vk);
         text_shutdown(vk);
         vk_destroy(vk);
         free(renderer);
@@ -856,30 +2510,64 @@ void renderer_destroy(Renderer *renderer) {
     }
 }
 
-EngineResult renderer_begin_frame(Renderer *renderer) {
+static EngineResult begin_frame(Renderer *renderer) {
     VulkanContext *vk = &renderer->vk;
     u32 frame = vk->current_frame;
 
     /* Reset per-frame state */
     vk->instance_count              = 0;
-    vk->draw_command_count          = 0;
     vk->instance_3d_count           = 0;
-    vk->draw_command_3d_count       = 0;
     vk->instance_skinned_count      = 0;
-    vk->draw_command_skinned_count  = 0;
     vk->joint_ssbo_used_bytes       = 0;
+    vk->text_vertex_count           = 0;
+    vk->text_draw_count             = 0;
+    vk->text_drawn_vertices         = 0;
+    skin_compute_begin_frame(vk);
+    frame_storage_reset(vk);
 
     /* Default camera: centered at origin, no rotation, zoom 1 */
     Camera2D default_cam = { .position = {0.0f, 0.0f}, .rotation = 0.0f, .zoom = 1.0f };
     compute_vp_matrix(vk, &default_cam);
 
-    /* Wait for previous frame to finish */
+    /* Wait only for the frame that last used this slot (frames_in_flight
+     * frames ago); the previous frame keeps executing on the GPU while we record. */
+    PROFILE_ZONE_BEGIN("wait_frame_fence");
     vkWaitForFences(vk->device, 1, &vk->in_flight[frame], VK_TRUE, UINT64_MAX);
+    PROFILE_ZONE_END();
+
+    /* That frame's GPU timings are ready; they drive the render scale */
+    gpu_profiler_collect(vk, frame);
+    update_dynamic_resolution(renderer);
+
+    /* Rings replaced by larger ones, and unloaded meshes and textures, are
+     * freed once no frame can read them */
+    release_retired_rings(vk, false);
+    resource_release_retired(vk, false);
+
+    /* Upload async loads whose decode finished (runs their callbacks) */
+    asset_load_poll(vk);
+
+    /* Secondaries recorded for this slot have finished executing */
+    secondary_pools_reset(vk, frame);
+
+    /* This slot's ring regions are now free for the CPU to overwrite */
+    vk_frame_ring_begin(&vk->instance_ring,         frame);
+    vk_frame_ring_begin(&vk->instance_ring_3d,      frame);
+    vk_frame_ring_begin(&vk->indirect_ring_3d,      frame);
+    vk_frame_ring_begin(&vk->instance_ring_skinned, frame);
+    vk_frame_ring_begin(&vk->joint_ring,            frame);
+    vk_frame_ring_begin(&vk->text_vertex_ring,      frame);
+    vk_frame_ring_begin(&vk->light_ring,            frame);
+    gpu_particles_begin_frame(vk);
+    static_batch_begin_frame(vk);
+    light_cluster_begin_frame(vk);
 
     /* Acquire next swapchain image */
+    PROFILE_ZONE_BEGIN("acquire_image");
     VkResult result = vkAcquireNextImageKHR(vk->device, vk->swapchain, UINT64_MAX,
                                              vk->image_available[frame], VK_NULL_HANDLE,
                                              &renderer->current_image_index);
+    PROFILE_ZONE_END();
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR) {
         EngineResult res = recreate_swapchain(renderer);
@@ -901,31 +2589,114 @@ EngineResult renderer_begin_frame(Renderer *renderer) {
     return ENGINE_SUCCESS;
 }
 
-EngineResult renderer_end_frame(Renderer *renderer) {
+EngineResult renderer_begin_frame(Renderer *renderer) {
+    PROFILE_ZONE_BEGIN("renderer_begin_frame");
+    EngineResult res = begin_frame(renderer);
+    PROFILE_ZONE_END();
+    return res;
+}
+
+/* This frame's LightUniforms: the light, the last 3D camera position, the
+ * shadow cascades and the light grid's camera */
+static void write_light_uniforms(VulkanContext *vk) {
+    LightUniforms u = {0};
+    memcpy(u.direction, vk->light.direction, sizeof(f32) * 3);
+    memcpy(u.color,     vk->light.color,     sizeof(f32) * 3);
+    memcpy(u.ambient,   vk->light.ambient,   sizeof(f32) * 3);
+    memcpy(u.view_pos,  vk->view_position,   sizeof(f32) * 3);
+    u.shininess[0] = vk->light.shininess;
+    shadow_write_uniforms(vk, &u);
+    light_cluster_write_uniforms(vk, &u);
+
+    memcpy(vk->light_ring.mapped + vk->light_ring.frame_offset, &u, sizeof(u));
+}
+
+static EngineResult end_frame(Renderer *renderer) {
     VulkanContext *vk = &renderer->vk;
     u32 frame = vk->current_frame;
 
     /* Upload instance data (already in persistently mapped buffer via draw_mesh) */
 
+    /* Sprites still batched go on top of this frame's 2D draws */
+    PROFILE_ZONE_BEGIN("batch_draws");
+    flush_sprite_batches(vk);
+
+    /* Merge and sort draw lists so recording skips redundant state changes */
+    batch_draw_lists(vk);
+    build_indirect_draws_3d(vk);
+    write_light_uniforms(vk);
+    gpu_particles_prepare(vk);
+    texture_table_sync(vk);
+    PROFILE_ZONE_END();
+
     /* Record command buffer */
+    PROFILE_ZONE_BEGIN("record_command_buffer");
     vkResetCommandBuffer(vk->command_buffers[frame], 0);
-    EngineResult res = record_command_buffer(renderer, vk->command_buffers[frame],
-                                              renderer->current_image_index);
+    EngineResult res = record_async_compute(vk);
+    if (res == ENGINE_SUCCESS) {
+        res = record_command_buffer(renderer, vk->command_buffers[frame]);
+    }
+    PROFILE_ZONE_END();
+    if (res != ENGINE_SUCCESS) return res;
+
+    /* Counters for renderer_get_stats, over the lists just recorded */
+    render_stats_collect(vk);
+
+    /* Kick off uploads queued since the last frame; the frame waits on them */
+    res = vk_upload_flush(vk);
+    if (res != ENGINE_SUCCESS) return res;
+
+    /* This frame's compute goes first, so it can run while the GPU is still
+     * rendering the previous frame */
+    res = async_compute_submit(vk, vk->gpu_particles.in_place);
     if (res != ENGINE_SUCCESS) return res;
 
     /* Submit */
-    VkSemaphore wait_sems[]   = { vk->image_available[frame] };
-    VkSemaphore signal_sems[] = { vk->render_finished[frame] };
-    VkPipelineStageFlags wait_stages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+    VkSemaphore wait_sems[3]   = { vk->image_available[frame] };
+    u64 wait_values[3]         = { 0 };
+    VkPipelineStageFlags wait_stages[3] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+    u32 wait_count = 1;
+
+    if (vk_upload_frame_wait(vk, &wait_sems[wait_count], &wait_values[wait_count])) {
+        wait_stages[wait_count++] = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+                                    VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+                                    VK_PIPELINE_STAGE_TRANSFER_BIT |
+                                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+                                    VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                                    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    }
+
+    /* Only the stages reading skinned vertices, particle instances and args
+     * and the light clusters wait for compute */
+    if (async_compute_frame_wait(vk, &wait_sems[wait_count])) {
+        wait_stages[wait_count++] = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+                                    VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+                                    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    }
+
+    VkSemaphore signal_sems[2] = { vk->render_finished[frame] };
+    u64 signal_values[2]       = { 0 };
+    u32 signal_count = 1;
+    if (async_compute_frame_signal(vk, &signal_sems[1], &signal_values[1])) signal_count = 2;
+
+    /* Binary semaphores ignore their entry in wait_values / signal_values */
+    VkTimelineSemaphoreSubmitInfo timeline_info = {
+        .sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .waitSemaphoreValueCount   = wait_count,
+        .pWaitSemaphoreValues      = wait_values,
+        .signalSemaphoreValueCount = signal_count,
+        .pSignalSemaphoreValues    = signal_values,
+    };
 
     VkSubmitInfo submit_info = {
         .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-        .waitSemaphoreCount   = 1,
+        .pNext                = (wait_count > 1 || signal_count > 1) ? &timeline_info : NULL,
+        .waitSemaphoreCount   = wait_count,
         .pWaitSemaphores      = wait_sems,
         .pWaitDstStageMask    = wait_stages,
         .commandBufferCount   = 1,
         .pCommandBuffers      = &vk->command_buffers[frame],
-        .signalSemaphoreCount = 1,
+        .signalSemaphoreCount = signal_count,
         .pSignalSemaphores    = signal_sems,
     };
 
@@ -944,8 +2715,12 @@ EngineResult renderer_end_frame(Renderer *renderer) {
         .pSwapchains        = swapchains,
         .pImageIndices      = &renderer->current_image_index,
     };
+    VkPresentIdKHR present_id;
+    frame_pacing_present(vk, &present_info, &present_id);
 
+    PROFILE_ZONE_BEGIN("present");
     VkResult result = vkQueuePresentKHR(vk->present_queue, &present_info);
+    PROFILE_ZONE_END();
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
         recreate_swapchain(renderer);
@@ -954,10 +2729,31 @@ EngineResult renderer_end_frame(Renderer *renderer) {
         return ENGINE_ERROR_VULKAN_SWAPCHAIN;
     }
 
-    vk->current_frame = (frame + 1) % MAX_FRAMES_IN_FLIGHT;
+    vk->current_frame = (frame + 1) % vk->frames_in_flight;
+    vk->frame_number++;
+
+    /* Hold the game here rather than in the next begin_frame, so its input
+     * is sampled after the wait */
+    frame_pacing_end_frame(vk);
     return ENGINE_SUCCESS;
 }
 
+EngineResult renderer_end_frame(Renderer *renderer) {
+    PROFILE_ZONE_BEGIN("renderer_end_frame");
+    EngineResult res = end_frame(renderer);
+    PROFILE_ZONE_END();
+    return res;
+}
+
+EngineResult renderer_set_present_mode(Renderer *renderer, PresentMode mode) {
+    renderer->vk.present_mode_request = mode;
+    return recreate_swapchain(renderer);
+}
+
+void renderer_set_max_fps(Renderer *renderer, f32 max_fps) {
+    frame_pacing_set_max_fps(&renderer->vk, max_fps);
+}
+
 void renderer_set_clear_color(Renderer *renderer, f32 r, f32 g, f32 b, f32 a) {
     renderer->vk.clear_color[0] = r;
     renderer->vk.clear_color[1] = g;
@@ -980,36 +2776,15 @@ void renderer_draw_mesh(Renderer *renderer, MeshHandle mesh,
     VulkanContext *vk = &renderer->vk;
 
     if (instance_count == 0) return;
-    if (mesh >= vk->mesh_count) {
-        LOG_WARN("Invalid mesh handle %u (have %u meshes)", mesh, vk->mesh_count);
+    u32 slot = mesh_lookup(vk, mesh);
+    if (slot == HANDLE_SLOT_NONE) {
+        LOG_WARN("Invalid mesh handle %u", mesh);
         return;
     }
-    if (vk->draw_command_count >= MAX_DRAW_COMMANDS) {
-        LOG_WARN("Draw command list full (%u)", MAX_DRAW_COMMANDS);
-        return;
-    }
-
-    /* Append instances to the per-frame instance buffer */
-    u32 remaining = vk->instance_capacity - vk->instance_count;
-    if (instance_count > remaining) {
-        LOG_WARN("Instance buffer full (%u/%u), clamping",
-                 vk->instance_count + instance_count, vk->instance_capacity);
-        instance_count = remaining;
-        if (instance_count == 0) return;
-    }
-
-    u32 inst_offset = vk->instance_count;
-
-    InstanceData *dst = (InstanceData *)vk->instance_mapped + vk->instance_count;
-    memcpy(dst, instances, sizeof(InstanceData) * instance_count);
-    vk->instance_count += instance_count;
 
-    /* Record draw command */
-    DrawCommand *dc = &vk->draw_commands[vk->draw_command_count++];
-    dc->mesh            = mesh;
-    dc->texture         = TEXTURE_HANDLE_INVALID;
-    dc->instance_offset = inst_offset;
-    dc->instance_count  = instance_count;
+    queue_draw(vk, &vk->draw_list, &vk->instance_ring,
+               &vk->instance_count, &vk->instance_capacity, sizeof(InstanceData),
+               slot, TEXTURE_HANDLE_INVALID, instances, instance_count);
 }
 
 void renderer_draw_mesh_textured(Renderer *renderer, MeshHandle mesh,
@@ -1019,110 +2794,142 @@ void renderer_draw_mesh_textured(Renderer *renderer, MeshHandle mesh,
     VulkanContext *vk = &renderer->vk;
 
     if (instance_count == 0) return;
-    if (mesh >= vk->mesh_count) {
-        LOG_WARN("Invalid mesh handle %u (have %u meshes)", mesh, vk->mesh_count);
-        return;
-    }
-    if (texture >= vk->texture_count) {
-        LOG_WARN("Invalid texture handle %u (have %u textures)", texture, vk->texture_count);
+    u32 slot = mesh_lookup(vk, mesh);
+    if (slot == HANDLE_SLOT_NONE) {
+        LOG_WARN("Invalid mesh handle %u", mesh);
         return;
     }
-    if (vk->draw_command_count >= MAX_DRAW_COMMANDS) {
-        LOG_WARN("Draw command list full (%u)", MAX_DRAW_COMMANDS);
+    if (texture_lookup(vk, texture) == HANDLE_SLOT_NONE) {
+        LOG_WARN("Invalid texture handle %u", texture);
         return;
     }
 
-    /* Append instances to the per-frame instance buffer */
-    u32 remaining = vk->instance_capacity - vk->instance_count;
-    if (instance_count > remaining) {
-        LOG_WARN("Instance buffer full (%u/%u), clamping",
-                 vk->instance_count + instance_count, vk->instance_capacity);
-        instance_count = remaining;
-        if (instance_count == 0) return;
-    }
-
-    u32 inst_offset = vk->instance_count;
+    queue_draw(vk, &vk->draw_list, &vk->instance_ring,
+               &vk->instance_count, &vk->instance_capacity, sizeof(InstanceData),
+               slot, texture, instances, instance_count);
+}
 
-    InstanceData *dst = (InstanceData *)vk->instance_mapped + vk->instance_count;
-    memcpy(dst, instances, sizeof(InstanceData) * instance_count);
-    vk->instance_count += instance_count;
+/* Shared checks of the in-place 2D and 3D paths; resolves the mesh slot */
+static bool alloc_instances_valid(const VulkanContext *vk, MeshHandle mesh,
+                                  TextureHandle texture, bool is_3d, u32 *out_slot) {
+    u32 slot = mesh_lookup(vk, mesh);
+    if (slot == HANDLE_SLOT_NONE) {
+        LOG_WARN("Invalid mesh handle %u", mesh);
+        return false;
+    }
+    if (vk->meshes[slot].is_3d != is_3d) {
+        LOG_WARN("Mesh %u is not a %s mesh", mesh, is_3d ? "3D" : "2D");
+        return false;
+    }
+    if (texture != TEXTURE_HANDLE_INVALID && texture_lookup(vk, texture) == HANDLE_SLOT_NONE) {
+        LOG_WARN("Invalid texture handle %u", texture);
+        return false;
+    }
+    *out_slot = slot;
+    return true;
+}
 
-    /* Record draw command */
-    DrawCommand *dc = &vk->draw_commands[vk->draw_command_count++];
-    dc->mesh            = mesh;
-    dc->texture         = texture;
-    dc->instance_offset = inst_offset;
-    dc->instance_count  = instance_count;
+InstanceData *renderer_alloc_instances(Renderer *renderer, MeshHandle mesh, u32 instance_count) {
+    return renderer_alloc_instances_textured(renderer, mesh, TEXTURE_HANDLE_INVALID,
+                                             instance_count);
 }
 
-EngineResult renderer_load_texture(Renderer *renderer, const char *path,
-                                    TextureFilter filter,
-                                    TextureHandle *out_handle) {
+InstanceData *renderer_alloc_instances_textured(Renderer *renderer, MeshHandle mesh,
+                                                TextureHandle texture, u32 instance_count) {
     VulkanContext *vk = &renderer->vk;
 
-    if (vk->texture_count >= MAX_TEXTURES) {
-        LOG_ERROR("Texture table full (%u/%u)", vk->texture_count, MAX_TEXTURES);
-        return ENGINE_ERROR_VULKAN_INIT;
-    }
+    u32 slot;
+    if (instance_count == 0) return NULL;
+    if (!alloc_instances_valid(vk, mesh, texture, false, &slot)) return NULL;
+
+    return queue_draw_in_place(vk, &vk->draw_list, &vk->instance_ring,
+                               &vk->instance_count, &vk->instance_capacity, sizeof(InstanceData),
+                               slot, texture, instance_count);
+}
 
-    /* Map public enum to Vulkan filter */
-    VkFilter vk_filter = (filter == TEXTURE_FILTER_PIXELART)
-        ? VK_FILTER_NEAREST
-        : VK_FILTER_LINEAR;
+/* --------------------------------------------------------------------------
+ * Sprites: atlas-packed images drawn through per-page batches
+ * ------------------------------------------------------------------------ */
 
-    /* Decode image file with stb_image */
+EngineResult renderer_load_sprite(Renderer *renderer, const char *path,
+                                  TextureFilter filter, SpriteHandle *out_handle) {
     int width, height, channels;
     stbi_uc *pixels = stbi_load(path, &width, &height, &channels, STBI_rgb_alpha);
     if (!pixels) {
-        LOG_ERROR("Failed to load texture: %s", path);
-        return ENGINE_ERROR_VULKAN_INIT;
+        LOG_ERROR("Failed to load sprite: %s", path);
+        return ENGINE_ERROR_FILE_NOT_FOUND;
     }
 
-    /* Upload to GPU */
-    TextureHandle handle = (TextureHandle)vk->texture_count;
-    EngineResult res = vk_create_texture(vk, pixels, (u32)width, (u32)height,
-                                          VK_FORMAT_R8G8B8A8_SRGB, vk_filter,
-                                          &vk->textures[handle]);
+    EngineResult res = sprite_batch_add(&renderer->vk, pixels, (u32)width, (u32)height,
+                                        filter, out_handle);
     stbi_image_free(pixels);
+    return res;
+}
 
-    if (res != ENGINE_SUCCESS) return res;
+EngineResult renderer_add_sprite(Renderer *renderer, const u8 *rgba,
+                                 u32 width, u32 height, TextureFilter filter,
+                                 SpriteHandle *out_handle) {
+    return sprite_batch_add(&renderer->vk, rgba, width, height, filter, out_handle);
+}
 
-    /* Allocate descriptor set for this texture */
-    VkDescriptorSetAllocateInfo alloc_info = {
-        .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-        .descriptorPool     = vk->geo_desc_pool,
-        .descriptorSetCount = 1,
-        .pSetLayouts        = &vk->geo_desc_set_layout,
-    };
+EngineResult renderer_build_sprite_atlas(Renderer *renderer) {
+    return sprite_batch_build(&renderer->vk);
+}
 
-    if (vkAllocateDescriptorSets(vk->device, &alloc_info,
-                                  &vk->texture_desc_sets[handle]) != VK_SUCCESS) {
-        LOG_ERROR("Failed to allocate descriptor set for texture %u", handle);
-        return ENGINE_ERROR_VULKAN_INIT;
-    }
+void renderer_get_sprite_size(const Renderer *renderer, SpriteHandle sprite,
+                              u32 *width, u32 *height) {
+    const SpriteContext *sc = &renderer->vk.sprites;
+    bool valid = sprite < sc->sprite_count;
+    *width  = valid ? sc->sprites[sprite].width  : 0;
+    *height = valid ? sc->sprites[sprite].height : 0;
+}
 
-    /* Write texture to descriptor set */
-    VkDescriptorImageInfo image_info = {
-        .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-        .imageView   = vk->textures[handle].view,
-        .sampler     = vk->textures[handle].sampler,
-    };
+void renderer_draw_sprites(Renderer *renderer, SpriteHandle sprite,
+                           const InstanceData *instances, u32 instance_count) {
+    sprite_batch_draw(&renderer->vk, sprite, instances, instance_count);
+}
 
-    VkWriteDescriptorSet write = {
-        .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-        .dstSet          = vk->texture_desc_sets[handle],
-        .dstBinding      = 0,
-        .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-        .descriptorCount = 1,
-        .pImageInfo      = &image_info,
-    };
+void renderer_flush_sprites(Renderer *renderer) {
+    flush_sprite_batches(&renderer->vk);
+}
 
-    vkUpdateDescriptorSets(vk->device, 1, &write, 0, NULL);
+/* --------------------------------------------------------------------------
+ * Texture loading (decode lives in asset_load.c)
+ * ------------------------------------------------------------------------ */
+
+/* Map public enum to Vulkan filter */
+static VkFilter texture_filter_vk(TextureFilter filter) {
+    return filter == TEXTURE_FILTER_PIXELART ? VK_FILTER_NEAREST : VK_FILTER_LINEAR;
+}
+
+EngineResult renderer_load_texture(Renderer *renderer, const char *path,
+                                   TextureFilter filter,
+                                   TextureHandle *out_handle) {
+    VulkanContext *vk = &renderer->vk;
+
+    TextureData data;
+    EngineResult res = texture_decode(vk, path, &data);
+    if (res != ENGINE_SUCCESS) return res;
+
+    TextureHandle handle;
+    if ((res = texture_reserve(vk, &handle)) != ENGINE_SUCCESS) {
+        texture_data_free(&data);
+        return res;
+    }
 
-    vk->texture_count++;
+    /* Upload to GPU */
+    res = texture_create(vk, &data, texture_filter_vk(filter), &vk->textures[HANDLE_SLOT(handle)]);
+    texture_data_free(&data);   /* levels were copied into staging */
+    if (res != ENGINE_SUCCESS) {
+        texture_cancel(vk, handle);
+        return res;
+    }
+
+    /* The table slot is written at the start of the next end_frame */
     *out_handle = handle;
 
-    LOG_INFO("Texture %u loaded: \"%s\" (%dx%d)", handle, path, width, height);
+    LOG_INFO("Texture %u loaded: \"%s\" (%ux%u)", handle, path,
+             vk->textures[HANDLE_SLOT(handle)].width, vk->textures[HANDLE_SLOT(handle)].height);
     return ENGINE_SUCCESS;
 }
 
@@ -1132,6 +2939,12 @@ void renderer_draw_text(Renderer *renderer, const char *str,
     text_draw(&renderer->vk, str, x, y, scale, r, g, b);
 }
 
+void renderer_draw_text_cached(Renderer *renderer, const char *str,
+                               f32 x, f32 y, f32 scale,
+                               f32 r, f32 g, f32 b) {
+    text_draw_cached(&renderer->vk, str, x, y, scale, r, g, b);
+}
+
 void renderer_get_extent(const Renderer *renderer, u32 *width, u32 *height) {
     *width  = renderer->vk.swapchain_extent.width;
     *height = renderer->vk.swapchain_extent.height;
@@ -1151,6 +2964,163 @@ void renderer_set_bloom_settings(Renderer *renderer, const BloomSettings *settin
     renderer->bloom_settings = *settings;
 }
 
+void renderer_set_render_scale(Renderer *renderer, f32 scale) {
+    renderer->dynamic_resolution = false;
+    bloom_set_render_scale(&renderer->vk, scale);
+}
+
+f32 renderer_get_render_scale(const Renderer *renderer) {
+    return renderer->vk.bloom.render_scale;
+}
+
+bool renderer_set_dynamic_resolution(Renderer *renderer, bool enabled, f32 target_ms) {
+    if (enabled && !renderer->vk.gpu_profiler.pool) {
+        LOG_WARN("Dynamic resolution needs GPU timestamps, not supported on this device");
+        return false;
+    }
+    renderer->dynamic_resolution = enabled;
+    renderer->dynres_target_ms   = (target_ms > 0.0f) ? target_ms : 1000.0f / 60.0f;
+    renderer->dynres_avg_ms      = 0.0f;
+    return true;
+}
+
+bool renderer_get_gpu_timings(const Renderer *renderer, GpuTimings *out) {
+    *out = renderer->vk.gpu_profiler.timings;
+    return out->valid;
+}
+
+void renderer_draw_gpu_timings(Renderer *renderer, f32 x, f32 y, f32 scale) {
+    const GpuTimings *t = &renderer->vk.gpu_profiler.timings;
+    if (!t->valid) return;
+
+    f32  line = text_line_height(scale);
+    char buf[64];
+    snprintf(buf, sizeof(buf), "GPU %.2f ms (scene %.2f)", (double)t->frame_ms,
+             (double)t->scene_ms);
+    text_draw(&renderer->vk, buf, x, y, scale, 1.0f, 1.0f, 1.0f);
+
+    for (u32 p = 0; p < GPU_PASS_COUNT; p++) {
+        if (t->pass_ms[p] <= 0.0f) continue;
+        y += line;
+        snprintf(buf, sizeof(buf), "  %-10s %6.2f", gpu_profiler_pass_name((GpuPass)p),
+                 (double)t->pass_ms[p]);
+        text_draw(&renderer->vk, buf, x, y, scale, 0.7f, 0.9f, 0.7f);
+    }
+}
+
+void renderer_get_stats(const Renderer *renderer, RendererStats *out) {
+    render_stats_get(&renderer->vk, out);
+}
+
+/* One overlay line per limit, colored by how full it is */
+static void draw_usage_line(Renderer *renderer, const char *name, RendererUsage u,
+                            f32 x, f32 y, f32 scale) {
+    f32 fill = u.capacity ? (f32)((f64)u.used / (f64)u.capacity) : 0.0f;
+    f32 r = 0.7f, g = 0.9f, b = 0.7f;
+    if (fill >= 0.95f)      { r = 1.0f; g = 0.3f; b = 0.3f; }
+    else if (fill >= 0.75f) { r = 1.0f; g = 0.9f; b = 0.3f; }
+
+    char buf[80];
+    snprintf(buf, sizeof(buf), "  %-12s %10llu / %-10llu %3.0f%%", name,
+             (unsigned long long)u.used, (unsigned long long)u.capacity,
+             (double)(fill * 100.0f));
+    text_draw(&renderer->vk, buf, x, y, scale, r, g, b);
+}
+
+void renderer_draw_stats(Renderer *renderer, f32 x, f32 y, f32 scale) {
+    RendererStats st;
+    render_stats_get(&renderer->vk, &st);
+    const RendererFrameStats *f = &st.frame;
+
+    f32  line = text_line_height(scale);
+    char buf[96];
+    snprintf(buf, sizeof(buf), "%u draws  %u instances  %llu tris", f->draws, f->instances,
+             (unsigned long long)f->triangles);
+    text_draw(&renderer->vk, buf, x, y, scale, 1.0f, 1.0f, 1.0f);
+    y += line;
+    snprintf(buf, sizeof(buf), "%u pipelines  %u textures  %llu KB uploaded",
+             f->pipeline_binds, f->texture_changes, (unsigned long long)(f->upload_bytes >> 10));
+    text_draw(&renderer->vk, buf, x, y, scale, 1.0f, 1.0f, 1.0f);
+
+    const struct { const char *name; RendererUsage usage; } limits[] = {
+        { "meshes",       st.meshes },
+        { "textures",     st.textures },
+        { "vertices 2D",  st.vertices_2d },
+        { "vertices 3D",  st.vertices_3d },
+        { "skinned vtx",  st.vertices_skinned },
+        { "indices",      st.indices },
+        { "instances 2D", st.instances_2d },
+        { "instances 3D", st.instances_3d },
+        { "skinned inst", st.instances_skinned },
+        { "joint bytes",  st.joint_bytes },
+        { "text verts",   st.text_vertices },
+    };
+    for (u32 i = 0; i < ENGINE_ARRAY_LEN(limits); i++) {
+        y += line;
+        draw_usage_line(renderer, limits[i].name, limits[i].usage, x, y, scale);
+    }
+
+    y += line;
+    snprintf(buf, sizeof(buf), "GPU memory %llu / %llu MB in blocks",
+             (unsigned long long)(st.gpu_memory.used >> 20),
+             (unsigned long long)(st.gpu_memory.capacity >> 20));
+    text_draw(&renderer->vk, buf, x, y, scale, 1.0f, 1.0f, 1.0f);
+
+    for (u32 h = 0; h < st.heap_count; h++) {
+        const RendererHeapStats *heap = &st.heaps[h];
+        if (heap->reserved == 0 && heap->usage == 0) continue;
+        y += line;
+        if (st.memory_budget) {
+            /* Process-wide usage against the heap's budget */
+            RendererUsage u = { heap->usage >> 20, heap->budget >> 20 };
+            snprintf(buf, sizeof(buf), "%s %u MB", heap->device_local ? "vram" : "heap", h);
+            draw_usage_line(renderer, buf, u, x, y, scale);
+        } else {
+            snprintf(buf, sizeof(buf), "  %s %u MB    %llu / %llu reserved",
+                     heap->device_local ? "vram" : "heap", h,
+                     (unsigned long long)(heap->reserved >> 20),
+                     (unsigned long long)(heap->size >> 20));
+            text_draw(&renderer->vk, buf, x, y, scale, 0.7f, 0.9f, 0.7f);
+        }
+    }
+}
+
+bool renderer_set_compute_skinning(Renderer *renderer, bool enabled) {
+    SkinComputeContext *sc = &renderer->vk.skin_compute;
+    if (enabled && !sc->supported) {
+        LOG_WARN("Compute skinning not supported on this device");
+        return false;
+    }
+    sc->enabled = enabled;
+    return true;
+}
+
+/* ---- GPU particle systems ---- */
+
+EngineResult renderer_create_gpu_particles(Renderer *renderer, u32 capacity,
+                                           MeshHandle mesh, GpuParticlesHandle *out_handle) {
+    return gpu_particles_create(&renderer->vk, capacity, mesh, out_handle);
+}
+
+void renderer_destroy_gpu_particles(Renderer *renderer, GpuParticlesHandle handle) {
+    gpu_particles_destroy(&renderer->vk, handle);
+}
+
+bool renderer_emit_gpu_particles(Renderer *renderer, GpuParticlesHandle handle,
+                                 const GpuParticleBurst *burst) {
+    return gpu_particles_burst(&renderer->vk, handle, burst);
+}
+
+void renderer_simulate_gpu_particles(Renderer *renderer, GpuParticlesHandle handle,
+                                     f32 delta_time) {
+    gpu_particles_simulate(&renderer->vk, handle, delta_time);
+}
+
+void renderer_draw_gpu_particles(Renderer *renderer, GpuParticlesHandle handle,
+                                 TextureHandle texture) {
+    gpu_particles_draw(&renderer->vk, handle, texture);
+}
+
 /* ---- 3D Rendering API ---- */
 
 void renderer_set_camera_3d(Renderer *renderer, const Camera3D *camera) {
@@ -1159,23 +3129,29 @@ void renderer_set_camera_3d(Renderer *renderer, const Camera3D *camera) {
 
 void renderer_set_light(Renderer *renderer, const DirectionalLight *light) {
     VulkanContext *vk = &renderer->vk;
+    vk->light = *light;
 
-    /* std140 layout: each vec3 padded to vec4 (16 bytes) */
-    struct {
-        f32 direction[4];
-        f32 color[4];
-        f32 ambient[4];
-        f32 view_pos[4];
-        f32 shininess[4];
-    } ubo_data = {0};
+    /* The cascade boxes face the light */
+    shadow_fit_cascades(vk);
+}
+
+bool renderer_set_shadows(Renderer *renderer, bool enabled, f32 max_distance) {
+    VulkanContext *vk = &renderer->vk;
+    ShadowContext *sh = &vk->shadow;
+    if (enabled && !sh->available) {
+        LOG_WARN("Shadows need RendererConfig.shadow_map_size");
+        return false;
+    }
 
-    memcpy(ubo_data.direction, light->direction, sizeof(f32) * 3);
-    memcpy(ubo_data.color, light->color, sizeof(f32) * 3);
-    memcpy(ubo_data.ambient, light->ambient, sizeof(f32) * 3);
-    memcpy(ubo_data.view_pos, vk->view_position, sizeof(f32) * 3);
-    ubo_data.shininess[0] = light->shininess;
+    sh->enabled = enabled;
+    if (max_distance > 0.0f) sh->max_distance = max_distance;
+    shadow_fit_cascades(vk);
+    return true;
+}
 
-    memcpy(vk->light_ubo_mapped, &ubo_data, sizeof(ubo_data));
+void renderer_draw_lights(Renderer *renderer, const PointLight *lights, u32 count) {
+    if (!lights || count == 0) return;
+    light_cluster_draw(&renderer->vk, lights, count);
 }
 
 EngineResult renderer_upload_mesh_3d(Renderer *renderer,
@@ -1191,38 +3167,17 @@ void renderer_draw_mesh_3d(Renderer *renderer, MeshHandle mesh,
     VulkanContext *vk = &renderer->vk;
 
     if (instance_count == 0) return;
-    if (mesh >= vk->mesh_count) {
-        LOG_WARN("Invalid mesh handle %u (have %u meshes)", mesh, vk->mesh_count);
+    u32 slot = mesh_lookup(vk, mesh);
+    if (slot == HANDLE_SLOT_NONE) {
+        LOG_WARN("Invalid mesh handle %u", mesh);
         return;
     }
-    if (!vk->meshes[mesh].is_3d) {
+    if (!vk->meshes[slot].is_3d) {
         LOG_WARN("Mesh %u is not a 3D mesh — use renderer_draw_mesh instead", mesh);
         return;
     }
-    if (vk->draw_command_3d_count >= MAX_DRAW_COMMANDS) {
-        LOG_WARN("3D draw command list full (%u)", MAX_DRAW_COMMANDS);
-        return;
-    }
-
-    u32 remaining = vk->instance_3d_capacity - vk->instance_3d_count;
-    if (instance_count > remaining) {
-        LOG_WARN("3D instance buffer full (%u/%u), clamping",
-                 vk->instance_3d_count + instance_count, vk->instance_3d_capacity);
-        instance_count = remaining;
-        if (instance_count == 0) return;
-    }
-
-    u32 inst_offset = vk->instance_3d_count;
-
-    InstanceData3D *dst = (InstanceData3D *)vk->instance_3d_mapped + vk->instance_3d_count;
-    memcpy(dst, instances, sizeof(InstanceData3D) * instance_count);
-    vk->instance_3d_count += instance_count;
 
-    DrawCommand *dc = &vk->draw_commands_3d[vk->draw_command_3d_count++];
-    dc->mesh            = mesh;
-    dc->texture         = TEXTURE_HANDLE_INVALID;
-    dc->instance_offset = inst_offset;
-    dc->instance_count  = instance_count;
+    queue_draw_3d(vk, slot, TEXTURE_HANDLE_INVALID, instances, instance_count);
 }
 
 void renderer_draw_mesh_3d_textured(Renderer *renderer, MeshHandle mesh,
@@ -1232,42 +3187,129 @@ void renderer_draw_mesh_3d_textured(Renderer *renderer, MeshHandle mesh,
     VulkanContext *vk = &renderer->vk;
 
     if (instance_count == 0) return;
-    if (mesh >= vk->mesh_count) {
-        LOG_WARN("Invalid mesh handle %u (have %u meshes)", mesh, vk->mesh_count);
+    u32 slot = mesh_lookup(vk, mesh);
+    if (slot == HANDLE_SLOT_NONE) {
+        LOG_WARN("Invalid mesh handle %u", mesh);
         return;
     }
-    if (!vk->meshes[mesh].is_3d) {
+    if (!vk->meshes[slot].is_3d) {
         LOG_WARN("Mesh %u is not a 3D mesh — use renderer_draw_mesh_textured instead", mesh);
         return;
     }
-    if (texture >= vk->texture_count) {
-        LOG_WARN("Invalid texture handle %u (have %u textures)", texture, vk->texture_count);
+    if (texture_lookup(vk, texture) == HANDLE_SLOT_NONE) {
+        LOG_WARN("Invalid texture handle %u", texture);
         return;
     }
-    if (vk->draw_command_3d_count >= MAX_DRAW_COMMANDS) {
-        LOG_WARN("3D draw command list full (%u)", MAX_DRAW_COMMANDS);
-        return;
+
+    queue_draw_3d(vk, slot, texture, instances, instance_count);
+}
+
+InstanceData3D *renderer_alloc_instances_3d(Renderer *renderer, MeshHandle mesh,
+                                            TextureHandle texture, u32 instance_count) {
+    VulkanContext *vk = &renderer->vk;
+
+    u32 slot;
+    if (instance_count == 0) return NULL;
+    if (!alloc_instances_valid(vk, mesh, texture, true, &slot)) return NULL;
+    if (vk->instance_format_3d != INSTANCE_FORMAT_3D_EULER) {
+        LOG_WARN("renderer_alloc_instances_3d needs INSTANCE_FORMAT_3D_EULER");
+        return NULL;
     }
 
-    u32 remaining = vk->instance_3d_capacity - vk->instance_3d_count;
-    if (instance_count > remaining) {
-        LOG_WARN("3D instance buffer full (%u/%u), clamping",
-                 vk->instance_3d_count + instance_count, vk->instance_3d_capacity);
-        instance_count = remaining;
-        if (instance_count == 0) return;
+    InstanceData3D *out = queue_draw_in_place(vk, &vk->draw_list_3d, &vk->instance_ring_3d,
+                                              &vk->instance_3d_count, &vk->instance_3d_capacity,
+                                              sizeof(InstanceData3D), slot, texture,
+                                              instance_count);
+
+    /* Unculled for the camera, so unculled for every cascade too */
+    if (out && shadow_active(vk)) {
+        u32 offset = vk->instance_3d_count - instance_count;
+        for (u32 c = 0; c < SHADOW_CASCADES; c++) {
+            DrawList *list = &vk->shadow.draw_lists[c];
+            if (!draw_list_reserve(vk, list, list->count + 1)) break;
+            queue_draw_commit(list, slot, TEXTURE_HANDLE_INVALID, offset, instance_count, 0);
+        }
     }
+    return out;
+}
 
-    u32 inst_offset = vk->instance_3d_count;
+/* ---- Static batch API ---- */
 
-    InstanceData3D *dst = (InstanceData3D *)vk->instance_3d_mapped + vk->instance_3d_count;
-    memcpy(dst, instances, sizeof(InstanceData3D) * instance_count);
-    vk->instance_3d_count += instance_count;
+EngineResult renderer_create_static_batch(Renderer *renderer, MeshHandle mesh,
+                                          TextureHandle texture,
+                                          const InstanceData3D *instances, u32 count,
+                                          StaticBatchHandle *out_handle) {
+    return static_batch_create(&renderer->vk, mesh, texture, instances, count, out_handle);
+}
 
-    DrawCommand *dc = &vk->draw_commands_3d[vk->draw_command_3d_count++];
-    dc->mesh            = mesh;
-    dc->texture         = texture;
-    dc->instance_offset = inst_offset;
-    dc->instance_count  = instance_count;
+EngineResult renderer_update_static_batch(Renderer *renderer, StaticBatchHandle batch,
+                                          u32 first, const InstanceData3D *instances,
+                                          u32 count) {
+    return static_batch_update(&renderer->vk, batch, first, instances, count);
+}
+
+void renderer_destroy_static_batch(Renderer *renderer, StaticBatchHandle batch) {
+    static_batch_destroy(&renderer->vk, batch);
+}
+
+void renderer_draw_static_batch(Renderer *renderer, StaticBatchHandle batch) {
+    static_batch_draw(&renderer->vk, batch);
+}
+
+/* ---- Async loading API ---- */
+
+EngineResult renderer_load_model_async(Renderer *renderer, const char *path,
+                                       AssetLoadCallback callback, void *user,
+                                       MeshHandle *out_handle) {
+    VulkanContext *vk = &renderer->vk;
+    if (vk->asset_loads.placeholder_mesh == MESH_HANDLE_INVALID) {
+        EngineResult res = renderer_create_cube(renderer, &vk->asset_loads.placeholder_mesh);
+        if (res != ENGINE_SUCCESS) return res;
+    }
+    return asset_load_model(vk, path, callback, user, out_handle);
+}
+
+EngineResult renderer_load_skinned_model_async(Renderer *renderer, const char *path,
+                                               SkinnedModel *out_model,
+                                               AssetLoadCallback callback, void *user) {
+    return asset_load_skinned_model(&renderer->vk, path, out_model, callback, user);
+}
+
+EngineResult renderer_load_texture_async(Renderer *renderer, const char *path,
+                                         TextureFilter filter,
+                                         AssetLoadCallback callback, void *user,
+                                         TextureHandle *out_handle) {
+    return asset_load_texture(&renderer->vk, path, texture_filter_vk(filter),
+                              callback, user, out_handle);
+}
+
+void renderer_set_load_placeholder(Renderer *renderer, MeshHandle mesh) {
+    renderer->vk.asset_loads.placeholder_mesh = mesh;
+}
+
+u32 renderer_pending_loads(const Renderer *renderer) {
+    return asset_load_pending(&renderer->vk);
+}
+
+/* ---- Unloading API ---- */
+
+bool renderer_unload_mesh(Renderer *renderer, MeshHandle mesh) {
+    VulkanContext *vk = &renderer->vk;
+    if (!mesh_unload(vk, mesh)) return false;
+
+    /* The next async model load creates a fresh cube */
+    if (mesh == vk->asset_loads.placeholder_mesh) {
+        vk->asset_loads.placeholder_mesh = MESH_HANDLE_INVALID;
+    }
+    return true;
+}
+
+bool renderer_unload_texture(Renderer *renderer, TextureHandle texture) {
+    return texture_unload(&renderer->vk, texture);
+}
+
+EngineResult renderer_compact_meshes(Renderer *renderer) {
+    return mesh_compact(&renderer->vk);
 }
 
 /* ---- Skeletal Animation API ---- */
@@ -1285,70 +3327,109 @@ EngineResult renderer_upload_mesh_skinned(Renderer *renderer,
                                    indices, index_count, out_handle);
 }
 
-/* Internal helper for skinned draw (shared by textured + untextured) */
+/* Internal helper for skinned draws (single, textured, affine, instanced).
+ * Each instance gets its own palette of joint_count matrices; the palettes
+ * are stored back to back and the shader picks one per instance. */
+/* Reserve instances, joint palettes and a draw command for one skinned draw
+ * and queue it; the caller fills *out_instances and *out_joints. Mesh and
+ * counts are validated by the callers. */
+static bool alloc_skinned_draw(VulkanContext *vk, u32 mesh, TextureHandle texture,
+                               u32 instance_count, u32 joint_count,
+                               void **out_instances,
+                               f32 (**out_joints)[JOINT_AFFINE_FLOATS]) {
+    size_t stride = vk_instance_3d_stride(vk);
+    if (!draw_list_reserve(vk, &vk->draw_list_skinned, vk->draw_list_skinned.count + 1)) return false;
+
+    if (!instance_ring_reserve(vk, &vk->instance_ring_skinned, &vk->instance_skinned_capacity,
+                               vk->instance_skinned_count, vk->instance_skinned_count + instance_count,
+                               stride)) {
+        LOG_WARN("Skinned instance buffer full");
+        return false;
+    }
+
+    /* Joint matrices go to the SSBO as 3x4 affine (48 bytes per joint). Ranges
+     * are packed back to back; the shader indexes by joint_offset / 48. */
+    u32 joint_data_size = joint_count * instance_count * JOINT_AFFINE_BYTES;
+    u32 aligned_offset  = vk->joint_ssbo_used_bytes;
+
+    if (!joint_ring_reserve(vk, aligned_offset + joint_data_size)) {
+        LOG_WARN("Joint SSBO full (%u + %u > %u)",
+                 aligned_offset, joint_data_size, vk->joint_ssbo_capacity);
+        return false;
+    }
+
+    u32 inst_offset = vk->instance_skinned_count;
+    vk->instance_skinned_count += instance_count;
+    vk->joint_ssbo_used_bytes   = aligned_offset + joint_data_size;
+
+    SkinnedDrawCommand *dc = &vk->draw_list_skinned.items[vk->draw_list_skinned.count++];
+    dc->mesh              = mesh;
+    dc->texture           = texture;
+    dc->instance_offset   = inst_offset;
+    dc->instance_count    = instance_count;
+    dc->joint_ssbo_offset = aligned_offset;
+    dc->joint_count       = joint_count;
+    dc->skinned_vertex    = skin_compute_reserve(vk, vk->meshes[mesh].vertex_count * instance_count);
+
+    *out_instances = vk->instance_ring_skinned.mapped + vk->instance_ring_skinned.frame_offset +
+                     (size_t)inst_offset * stride;
+    *out_joints    = (f32 (*)[JOINT_AFFINE_FLOATS])(vk->joint_ring.mapped +
+                                                    vk->joint_ring.frame_offset + aligned_offset);
+    return true;
+}
+
 static void draw_skinned_internal(Renderer *renderer, MeshHandle mesh,
                                    TextureHandle texture,
-                                   const InstanceData3D *instance,
-                                   const f32 joint_matrices[][16], u32 joint_count) {
+                                   const InstanceData3D *instances, u32 instance_count,
+                                   const f32 (*joint_matrices)[16],
+                                   const f32 (*joint_affine)[JOINT_AFFINE_FLOATS],
+                                   u32 joint_count) {
     VulkanContext *vk = &renderer->vk;
 
-    if (mesh >= vk->mesh_count) {
-        LOG_WARN("Invalid mesh handle %u (have %u meshes)", mesh, vk->mesh_count);
+    u32 slot = mesh_lookup(vk, mesh);
+    if (slot == HANDLE_SLOT_NONE) {
+        LOG_WARN("Invalid mesh handle %u", mesh);
         return;
     }
-    if (!vk->meshes[mesh].is_skinned) {
+    if (!vk->meshes[slot].is_skinned) {
         LOG_WARN("Mesh %u is not a skinned mesh", mesh);
         return;
     }
-    if (vk->draw_command_skinned_count >= MAX_SKINNED_DRAW_COMMANDS) {
-        LOG_WARN("Skinned draw command list full (%u)", MAX_SKINNED_DRAW_COMMANDS);
-        return;
-    }
-    if (joint_count == 0 || !joint_matrices) {
+    if (joint_count == 0 || (!joint_matrices && !joint_affine)) {
         LOG_WARN("No joint matrices provided for skinned draw");
         return;
     }
+    if (instance_count == 0 || !instances) return;
 
-    /* Copy instance data (1 instance per skinned draw) */
-    if (vk->instance_skinned_count >= vk->instance_skinned_capacity) {
-        LOG_WARN("Skinned instance buffer full");
+    void *dst;
+    f32 (*ssbo_dst)[JOINT_AFFINE_FLOATS];
+    if (!alloc_skinned_draw(vk, slot, texture, instance_count, joint_count, &dst, &ssbo_dst)) {
         return;
     }
-    u32 inst_offset = vk->instance_skinned_count;
-    InstanceData3D *dst = (InstanceData3D *)vk->instance_skinned_mapped + inst_offset;
-    memcpy(dst, instance, sizeof(InstanceData3D));
-    vk->instance_skinned_count++;
-
-    /* Copy joint matrices to SSBO (256-byte aligned for buffer dynamic offset compat) */
-    u32 joint_data_size = joint_count * sizeof(f32) * 16; /* joint_count * 64 bytes */
-    u32 aligned_offset = (vk->joint_ssbo_used_bytes + 255) & ~255u; /* 256-byte align */
+    vk_write_instances_3d(vk, dst, instances, instance_count);
 
-    if (aligned_offset + joint_data_size > vk->joint_ssbo_capacity) {
-        LOG_WARN("Joint SSBO full (%u + %u > %u)",
-                 aligned_offset, joint_data_size, vk->joint_ssbo_capacity);
-        vk->instance_skinned_count--; /* rollback */
-        return;
+    u32 palette_count = joint_count * instance_count;
+    if (joint_affine) {
+        memcpy(ssbo_dst, joint_affine, (size_t)palette_count * JOINT_AFFINE_BYTES);
+    } else {
+        /* Drop the projective row: transpose the top 3 rows of each mat4 */
+        for (u32 j = 0; j < palette_count; j++) {
+            const f32 *m = joint_matrices[j];
+            for (u32 r = 0; r < 3; r++) {
+                ssbo_dst[j][r * 4 + 0] = m[0 + r];
+                ssbo_dst[j][r * 4 + 1] = m[4 + r];
+                ssbo_dst[j][r * 4 + 2] = m[8 + r];
+                ssbo_dst[j][r * 4 + 3] = m[12 + r];
+            }
+        }
     }
-
-    u8 *ssbo_dst = (u8 *)vk->joint_ssbo_mapped + aligned_offset;
-    memcpy(ssbo_dst, joint_matrices, joint_data_size);
-    vk->joint_ssbo_used_bytes = aligned_offset + joint_data_size;
-
-    /* Record draw command */
-    SkinnedDrawCommand *dc = &vk->draw_commands_skinned[vk->draw_command_skinned_count++];
-    dc->mesh              = mesh;
-    dc->texture           = texture;
-    dc->instance_offset   = inst_offset;
-    dc->instance_count    = 1;
-    dc->joint_ssbo_offset = aligned_offset;
-    dc->joint_count       = joint_count;
 }
 
 void renderer_draw_skinned(Renderer *renderer, MeshHandle mesh,
                            const InstanceData3D *instance,
                            const f32 joint_matrices[][16], u32 joint_count) {
     draw_skinned_internal(renderer, mesh, TEXTURE_HANDLE_INVALID,
-                          instance, joint_matrices, joint_count);
+                          instance, 1, joint_matrices, NULL, joint_count);
 }
 
 void renderer_draw_skinned_textured(Renderer *renderer, MeshHandle mesh,
@@ -1356,5 +3437,49 @@ void renderer_draw_skinned_textured(Renderer *renderer, MeshHandle mesh,
                                     const InstanceData3D *instance,
                                     const f32 joint_matrices[][16], u32 joint_count) {
     draw_skinned_internal(renderer, mesh, texture,
-                          instance, joint_matrices, joint_count);
+                          instance, 1, joint_matrices, NULL, joint_count);
+}
+
+void renderer_draw_skinned_affine(Renderer *renderer, MeshHandle mesh,
+                                  TextureHandle texture,
+                                  const InstanceData3D *instance,
+                                  const f32 joint_affine[][JOINT_AFFINE_FLOATS],
+                                  u32 joint_count) {
+    draw_skinned_internal(renderer, mesh, texture,
+                          instance, 1, NULL, joint_affine, joint_count);
+}
+
+void renderer_draw_skinned_instanced(Renderer *renderer, MeshHandle mesh,
+                                     TextureHandle texture,
+                                     const InstanceData3D *instances, u32 instance_count,
+                                     const f32 joint_affine[][JOINT_AFFINE_FLOATS],
+                                     u32 joint_count) {
+    draw_skinned_internal(renderer, mesh, texture,
+                          instances, instance_count, NULL, joint_affine, joint_count);
+}
+
+bool renderer_alloc_skinned(Renderer *renderer, MeshHandle mesh, TextureHandle texture,
+                            u32 instance_count, u32 joint_count,
+                            InstanceData3D **out_instances,
+                            f32 (**out_joint_affine)[JOINT_AFFINE_FLOATS]) {
+    VulkanContext *vk = &renderer->vk;
+
+    if (instance_count == 0 || joint_count == 0) return false;
+    u32 slot = mesh_lookup(vk, mesh);
+    if (slot == HANDLE_SLOT_NONE || !vk->meshes[slot].is_skinned) {
+        LOG_WARN("Mesh %u is not a skinned mesh", mesh);
+        return false;
+    }
+    if (vk->instance_format_3d != INSTANCE_FORMAT_3D_EULER) {
+        LOG_WARN("renderer_alloc_skinned needs INSTANCE_FORMAT_3D_EULER");
+        return false;
+    }
+
+    void *instances;
+    if (!alloc_skinned_draw(vk, slot, texture, instance_count, joint_count,
+                            &instances, out_joint_affine)) {
+        return false;
+    }
+    *out_instances = instances;
+    return true;
 }
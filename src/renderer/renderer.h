@@ -14,6 +14,25 @@ typedef struct {
     const char *font_path;   /* e.g. "assets/consolas.ttf" */
     f32         font_size;   /* e.g. 24.0f */
     f32         clear_color[4]; /* r, g, b, a — background clear color (default: dark grey) */
+    bool        packed_vertices; /* store 3D/skinned meshes as PackedVertex3D /
+                                    PackedSkinnedVertex3D (about half the size) */
+    bool        mesh_lods;   /* build simplified index LODs for 3D meshes; 3D draws
+                                pick one per instance from projected size */
+    InstanceFormat3D instance_format_3d; /* what 3D / skinned instances are sent
+                                            to the GPU as (default EULER; QUAT
+                                            and MATRIX skip per-vertex sin/cos) */
+    u32         shadow_map_size; /* texels per side of each shadow cascade, e.g.
+                                    2048 (0 = no shadows; renderer_set_shadows) */
+    PresentMode present_mode;    /* swapchain present mode (default: IMMEDIATE, else
+                                    MAILBOX, else FIFO); an unsupported mode falls
+                                    back to FIFO */
+    u32         frames_in_flight; /* frames the CPU records ahead of the GPU, 1..
+                                     RENDERER_MAX_FRAMES_IN_FLIGHT (0 = 2). 1 gives
+                                     the least latency, at the cost of CPU/GPU overlap */
+    f32         max_fps;         /* frame-rate cap, 0 = uncapped (renderer_set_max_fps) */
+    bool        present_wait;    /* with VK_KHR_present_wait: end_frame waits until the
+                                    previous frame is on screen, so at most one frame
+                                    queues behind the display (ignored if unsupported) */
 } RendererConfig;
 
 /* Lifecycle */
@@ -25,6 +44,13 @@ void         renderer_destroy(Renderer *renderer);
 EngineResult renderer_begin_frame(Renderer *renderer);
 EngineResult renderer_end_frame(Renderer *renderer);
 
+/* Switch the present mode (recreates the swapchain; waits for the GPU) */
+EngineResult renderer_set_present_mode(Renderer *renderer, PresentMode mode);
+
+/* Frame-rate cap, 0 = uncapped. renderer_end_frame sleeps until the frame's
+ * slot comes up (OS sleep, then a short spin for sub-millisecond accuracy). */
+void         renderer_set_max_fps(Renderer *renderer, f32 max_fps);
+
 /* Change the background clear color at runtime */
 void         renderer_set_clear_color(Renderer *renderer, f32 r, f32 g, f32 b, f32 a);
 
@@ -39,8 +65,11 @@ EngineResult renderer_upload_mesh(Renderer *renderer,
                                   const Vertex *vertices, u32 count,
                                   MeshHandle *out_handle);
 
-/* Texture loading — decodes an image file (PNG/JPG/BMP) and uploads to GPU.
- * filter: TEXTURE_FILTER_PIXELART for sharp pixels, TEXTURE_FILTER_SMOOTH for bilinear.
+/* Texture loading — decodes an image file (PNG/JPG/BMP) and uploads to GPU
+ * with a generated mip chain. DDS / KTX2 files (BC1/3/4/5/7, ASTC 4x4) are
+ * uploaded as-is with their pre-built mips; if the device can't sample the
+ * format, the same path with a .png extension is loaded instead.
+ * filter: TEXTURE_FILTER_PIXELART for sharp pixels, TEXTURE_FILTER_SMOOTH for trilinear.
  * Returns a TextureHandle for use with renderer_draw_mesh_textured(). */
 EngineResult renderer_load_texture(Renderer *renderer, const char *path,
                                    TextureFilter filter,
@@ -58,11 +87,98 @@ void         renderer_draw_mesh_textured(Renderer *renderer, MeshHandle mesh,
                                          const InstanceData *instances,
                                          u32 instance_count);
 
+/* In-place draws — queue the draw and return its instance_count instances
+ * inside this frame's mapped instance buffer, for the caller to fill instead
+ * of building an array that draw_mesh would copy. The memory is write-only
+ * (often write-combined: write every field in order, never read it back) and
+ * only valid until the next draw or alloc call, which may grow the buffer.
+ * Returns NULL, queuing nothing, when the mesh is invalid or the instances
+ * don't fit. */
+InstanceData *renderer_alloc_instances(Renderer *renderer, MeshHandle mesh,
+                                       u32 instance_count);
+InstanceData *renderer_alloc_instances_textured(Renderer *renderer, MeshHandle mesh,
+                                                TextureHandle texture, u32 instance_count);
+
+/* ---- Sprites (atlas-packed) ----
+ * Sprites are images packed into shared atlas pages. Draws are collected per
+ * page and each page goes out as one instanced quad draw: when
+ * renderer_flush_sprites is called, or at end_frame. Sprites therefore land
+ * on top of the 2D draws issued before the flush; within a page they keep
+ * submission order. Use the flush to layer 2D meshes above sprites. */
+
+/* Decode an image (PNG/JPG/BMP) as a sprite. Packing happens at the next
+ * renderer_build_sprite_atlas, or lazily on the first draw of a pending
+ * sprite. Built pages are immutable; sprites added later open new pages, so
+ * load them in bulk and build once (e.g. after a level's assets). */
+EngineResult renderer_load_sprite(Renderer *renderer, const char *path,
+                                  TextureFilter filter, SpriteHandle *out_handle);
+
+/* Same from RGBA8 pixels (copied) */
+EngineResult renderer_add_sprite(Renderer *renderer, const u8 *rgba,
+                                 u32 width, u32 height, TextureFilter filter,
+                                 SpriteHandle *out_handle);
+
+/* Pack every pending sprite and upload the new pages */
+EngineResult renderer_build_sprite_atlas(Renderer *renderer);
+
+/* Source image size in pixels (0x0 for an invalid handle) */
+void         renderer_get_sprite_size(const Renderer *renderer, SpriteHandle sprite,
+                                      u32 *width, u32 *height);
+
+/* Batched sprite draw. Instances are unit quads (scale sets the size);
+ * uv_offset/uv_scale are relative to the sprite, so a sprite sheet loaded as
+ * one sprite still selects tiles the usual way. */
+void         renderer_draw_sprites(Renderer *renderer, SpriteHandle sprite,
+                                   const InstanceData *instances, u32 instance_count);
+
+/* Queue the sprite batches collected so far */
+void         renderer_flush_sprites(Renderer *renderer);
+
+/* ---- GPU particle systems ----
+ * Particles that live entirely on the GPU: a compute pass steps them, drops
+ * dead ones, spawns queued bursts and writes their instances, and the 2D
+ * pipeline draws them indirectly, so nothing per particle is uploaded. Use it
+ * for effects in the hundreds of thousands; gameplay/particle_system.h wraps
+ * it together with the CPU path. Needs compute on the graphics queue. */
+
+/* Create a system of up to `capacity` particles (<= GPU_PARTICLES_MAX_CAPACITY)
+ * drawn with a 2D mesh. Fails when the device has no compute support or all
+ * GPU_PARTICLES_MAX_SYSTEMS systems exist. */
+EngineResult renderer_create_gpu_particles(Renderer *renderer, u32 capacity,
+                                           MeshHandle mesh, GpuParticlesHandle *out_handle);
+
+/* Blocks until the GPU is idle, then frees the system */
+void         renderer_destroy_gpu_particles(Renderer *renderer, GpuParticlesHandle handle);
+
+/* Spawn a burst this frame, after this frame's step. Particles beyond the
+ * capacity are dropped. Returns false if the handle is invalid or the
+ * per-frame burst limit (GPU_PARTICLES_MAX_BURSTS) is hit. */
+bool         renderer_emit_gpu_particles(Renderer *renderer, GpuParticlesHandle handle,
+                                         const GpuParticleBurst *burst);
+
+/* Advance the system by delta_time this frame. Systems that aren't stepped
+ * keep their particles frozen. */
+void         renderer_simulate_gpu_particles(Renderer *renderer, GpuParticlesHandle handle,
+                                             f32 delta_time);
+
+/* Draw the live particles (after this frame's step) on top of the 2D draws */
+void         renderer_draw_gpu_particles(Renderer *renderer, GpuParticlesHandle handle,
+                                         TextureHandle texture);
+
 /* Text drawing — call between begin_frame and end_frame */
 void         renderer_draw_text(Renderer *renderer, const char *str,
                                 f32 x, f32 y, f32 scale,
                                 f32 r, f32 g, f32 b);
 
+/* Retained text — same as draw_text, but the string is laid out once into a
+ * GPU-resident run keyed by (string, scale, color) and later frames only
+ * issue an offset draw. Use it for labels, menus and values that change
+ * occasionally (scores); per-frame values such as timers are better drawn
+ * with renderer_draw_text, since every new string costs a layout + upload. */
+void         renderer_draw_text_cached(Renderer *renderer, const char *str,
+                                       f32 x, f32 y, f32 scale,
+                                       f32 r, f32 g, f32 b);
+
 /* Query current swapchain extent in pixels */
 void         renderer_get_extent(const Renderer *renderer,
                                  u32 *width, u32 *height);
@@ -77,16 +193,67 @@ void         renderer_set_bloom(Renderer *renderer, bool enabled,
                                 f32 intensity, f32 threshold);
 void         renderer_set_bloom_settings(Renderer *renderer, const BloomSettings *settings);
 
+/* Resolution scaling for the bloom HDR scene target (no effect with bloom
+ * off). The scene is drawn at scale x swapchain size per axis, clamped to
+ * BLOOM_MIN_RENDER_SCALE..1, and the composite upscales it; changing the
+ * scale never reallocates anything. Setting a fixed scale turns dynamic
+ * resolution off. */
+void         renderer_set_render_scale(Renderer *renderer, f32 scale);
+f32          renderer_get_render_scale(const Renderer *renderer);
+
+/* Dynamic resolution — adjust the render scale every frame from measured GPU
+ * frame time (timestamp queries) to stay within target_ms, e.g. 16.6 for
+ * 60 Hz or 8.3 for 120 Hz (<= 0 picks 60 Hz). Returns false if the device
+ * can't time frames. */
+bool         renderer_set_dynamic_resolution(Renderer *renderer, bool enabled, f32 target_ms);
+
+/* GPU timings — per-pass timestamp results from frames_in_flight frames
+ * ago (read back without stalling). Returns false until the first frame is
+ * measured or if the device can't time frames. */
+bool         renderer_get_gpu_timings(const Renderer *renderer, GpuTimings *out);
+
+/* Overlay of the latest GPU timings, one line per pass that ran, drawn
+ * through renderer_draw_text at (x, y). Call before renderer_end_frame. */
+void         renderer_draw_gpu_timings(Renderer *renderer, f32 x, f32 y, f32 scale);
+
+/* Statistics — the last submitted frame's counters (draws, instances,
+ * triangles, binds, bytes uploaded), each fixed limit's usage and device
+ * memory per heap, with budgets where VK_EXT_memory_budget is supported.
+ * Frame counters are zero until the first end_frame. */
+void         renderer_get_stats(const Renderer *renderer, RendererStats *out);
+
+/* Overlay of renderer_get_stats: the frame counters, one line per limit
+ * (yellow from 75% full, red from 95%) and the heaps in use, drawn through
+ * renderer_draw_text at (x, y). Call before renderer_end_frame. */
+void         renderer_draw_stats(Renderer *renderer, f32 x, f32 y, f32 scale);
+
 /* ---- 3D Rendering ---- */
 
 /* 3D Camera — computes perspective VP matrix (glm_perspective + glm_lookat).
  * Call instead of renderer_set_camera for 3D scenes. */
 void         renderer_set_camera_3d(Renderer *renderer, const Camera3D *camera);
 
-/* Directional light for 3D Phong shading. Call once per frame before draw calls.
- * Must be called AFTER renderer_set_camera_3d (needs camera position for specular). */
+/* Directional light for 3D Phong shading. Persists across frames; the camera
+ * position for specular is picked up at end_frame. With shadows on, call it
+ * before the frame's 3D draws: casters are sorted into cascades on
+ * submission, against the light as it is then. */
 void         renderer_set_light(Renderer *renderer, const DirectionalLight *light);
 
+/* Cascaded shadow maps for the directional light. The 3D camera's view out to
+ * max_distance (<= 0 keeps the current, default 50) is split into
+ * SHADOW_CASCADES slices, each with its own shadow map layer. 3D draws,
+ * static batches and skinned draws submitted while the 3D camera is set cast
+ * shadows; alpha is ignored. Off by default. Returns false (and stays off)
+ * without RendererConfig.shadow_map_size. */
+bool         renderer_set_shadows(Renderer *renderer, bool enabled, f32 max_distance);
+
+/* Point and spot lights for this frame (clustered forward shading). Lights
+ * outside the current 3D camera's frustum are dropped at submission, so set
+ * the camera first; up to RENDERER_MAX_LIGHTS per frame are kept. Before the
+ * scene pass a compute pass bins them into a froxel grid over the camera's
+ * view and each 3D fragment shades only the lights of its cluster. */
+void         renderer_draw_lights(Renderer *renderer, const PointLight *lights, u32 count);
+
 /* 3D mesh upload — vertices with normals, optional index buffer.
  * Pass indices=NULL, index_count=0 for non-indexed meshes. */
 EngineResult renderer_upload_mesh_3d(Renderer *renderer,
@@ -94,7 +261,11 @@ EngineResult renderer_upload_mesh_3d(Renderer *renderer,
                                      const u32 *indices, u32 index_count,
                                      MeshHandle *out_handle);
 
-/* 3D instanced draw — uses the 3D pipeline with Phong lighting. */
+/* 3D instanced draw — uses the 3D pipeline with Phong lighting.
+ * Instances whose bounding sphere is outside the current 3D camera's frustum
+ * are dropped at submission, so set the camera before drawing. With
+ * RendererConfig.mesh_lods each surviving instance also picks a LOD from its
+ * projected bounding-sphere size under that camera. */
 void         renderer_draw_mesh_3d(Renderer *renderer, MeshHandle mesh,
                                    const InstanceData3D *instances, u32 instance_count);
 
@@ -104,6 +275,33 @@ void         renderer_draw_mesh_3d_textured(Renderer *renderer, MeshHandle mesh,
                                             const InstanceData3D *instances,
                                             u32 instance_count);
 
+/* In-place 3D draw, as renderer_alloc_instances (texture may be
+ * TEXTURE_HANDLE_INVALID). The instances don't exist yet when the draw is
+ * queued, so they skip frustum culling and LOD selection: use it for
+ * batches known to be on screen. Needs RendererConfig.instance_format_3d ==
+ * INSTANCE_FORMAT_3D_EULER (NULL otherwise). */
+InstanceData3D *renderer_alloc_instances_3d(Renderer *renderer, MeshHandle mesh,
+                                            TextureHandle texture, u32 instance_count);
+
+/* Static batches — scenery that never (or rarely) moves. The instances are
+ * converted and uploaded to GPU memory once; drawing the handle is a single
+ * instanced draw with no per-frame copy or per-instance CPU work. The whole
+ * batch is culled against the 3D camera frustum by its bounds, and always
+ * uses LOD 0. Updates overwrite a range through the upload manager and wait
+ * for an earlier frame still drawing the batch, so keep them occasional.
+ * Destroying waits for the device to go idle. */
+EngineResult renderer_create_static_batch(Renderer *renderer, MeshHandle mesh,
+                                          TextureHandle texture,
+                                          const InstanceData3D *instances, u32 count,
+                                          StaticBatchHandle *out_handle);
+EngineResult renderer_update_static_batch(Renderer *renderer, StaticBatchHandle batch,
+                                          u32 first, const InstanceData3D *instances,
+                                          u32 count);
+void         renderer_destroy_static_batch(Renderer *renderer, StaticBatchHandle batch);
+
+/* Queue a static batch for this frame (between begin_frame and end_frame) */
+void         renderer_draw_static_batch(Renderer *renderer, StaticBatchHandle batch);
+
 /* Procedural 3D primitives — generate indexed meshes at init time.
  * All primitives are centered at origin, unit-sized (-0.5 to 0.5). */
 EngineResult renderer_create_cube(Renderer *renderer, MeshHandle *out_handle);
@@ -124,12 +322,70 @@ EngineResult renderer_load_model(Renderer *renderer, const char *path,
 EngineResult renderer_load_skinned_model_file(Renderer *renderer, const char *path,
                                               SkinnedModel *out_model);
 
+/* ---- Async loading ----
+ *
+ * These return at once: the file is decoded on a background job and the
+ * result is uploaded at a later renderer_begin_frame (finished loads go
+ * oldest first, within a per-frame byte budget). Until
+ * then a model handle draws the placeholder mesh (a cube unless set with
+ * renderer_set_load_placeholder) and a texture handle samples the white
+ * dummy; a load that fails keeps its placeholder. The callback (may be
+ * NULL) runs on the main thread inside begin_frame once the load is done.
+ * Create static batches over a model only after its callback. */
+EngineResult renderer_load_model_async(Renderer *renderer, const char *path,
+                                       AssetLoadCallback callback, void *user,
+                                       MeshHandle *out_handle);
+EngineResult renderer_load_texture_async(Renderer *renderer, const char *path,
+                                         TextureFilter filter,
+                                         AssetLoadCallback callback, void *user,
+                                         TextureHandle *out_handle);
+
+/* out_model is zeroed now and filled when the load completes (before the
+ * callback), so it must stay valid until then; its mesh_handle is
+ * MESH_HANDLE_INVALID meanwhile, which skinned draws ignore. */
+EngineResult renderer_load_skinned_model_async(Renderer *renderer, const char *path,
+                                               SkinnedModel *out_model,
+                                               AssetLoadCallback callback, void *user);
+
+/* Mesh that pending model handles draw. Applies to loads started later. */
+void         renderer_set_load_placeholder(Renderer *renderer, MeshHandle mesh);
+
+/* Async loads not yet finished (poll this, or use the callbacks) */
+u32          renderer_pending_loads(const Renderer *renderer);
+
+/* ---- Unloading ----
+ *
+ * Mesh and texture handles carry a generation, so a handle stays invalid
+ * after its unload even once the slot is reused: draws with it are dropped
+ * with a warning (a texture falls back to the dummy). The slot, the mesh's
+ * vertex / index ranges and the texture image are released once no frame in
+ * flight can still use them. Unloading a mesh that a static batch or GPU
+ * particle system still draws is refused (destroy those first), as is
+ * unloading the placeholder of pending async loads; unloading a pending
+ * handle drops its result (the callback gets an error). Returns false for an
+ * invalid or refused handle. */
+bool         renderer_unload_mesh(Renderer *renderer, MeshHandle mesh);
+bool         renderer_unload_texture(Renderer *renderer, TextureHandle texture);
+
+/* Freed vertex / index ranges are reused first-fit, so long sessions of
+ * mixed sizes fragment the shared buffers. This moves every live 3D and
+ * skinned mesh to the front of its buffer. Waits for the device to go idle:
+ * call between frames, e.g. on a level change. The 2D vertex buffer is not
+ * compacted. */
+EngineResult renderer_compact_meshes(Renderer *renderer);
+
 /* Upload skinned mesh geometry to GPU. Returns a MeshHandle for skinned draws. */
 EngineResult renderer_upload_mesh_skinned(Renderer *renderer,
                                           const SkinnedVertex3D *vertices, u32 vertex_count,
                                           const u32 *indices, u32 index_count,
                                           MeshHandle *out_handle);
 
+/* Skin each skinned draw once per frame in a compute pre-pass and draw the
+ * result with the regular 3D pipeline, instead of skinning in the vertex
+ * shader of every pass. Off by default. Returns false (and stays off) if the
+ * device can't run it. Takes effect for draws issued after the call. */
+bool         renderer_set_compute_skinning(Renderer *renderer, bool enabled);
+
 /* Draw a skinned model with joint matrices (untextured). */
 void         renderer_draw_skinned(Renderer *renderer, MeshHandle mesh,
                                    const InstanceData3D *instance,
@@ -141,4 +397,35 @@ void         renderer_draw_skinned_textured(Renderer *renderer, MeshHandle mesh,
                                             const InstanceData3D *instance,
                                             const f32 joint_matrices[][16], u32 joint_count);
 
+/* Draw a skinned model from 3x4 affine joint matrices (see
+ * animation_pose_to_affine). This is the SSBO layout, so the data is copied
+ * as-is instead of being narrowed from mat4. texture may be
+ * TEXTURE_HANDLE_INVALID. */
+void         renderer_draw_skinned_affine(Renderer *renderer, MeshHandle mesh,
+                                          TextureHandle texture,
+                                          const InstanceData3D *instance,
+                                          const f32 joint_affine[][JOINT_AFFINE_FLOATS],
+                                          u32 joint_count);
+
+/* Draw instance_count copies of one skinned mesh in a single draw call.
+ * joint_affine holds instance_count palettes of joint_count 3x4 matrices,
+ * back to back in instance order (palette i starts at i * joint_count).
+ * texture may be TEXTURE_HANDLE_INVALID. */
+void         renderer_draw_skinned_instanced(Renderer *renderer, MeshHandle mesh,
+                                             TextureHandle texture,
+                                             const InstanceData3D *instances, u32 instance_count,
+                                             const f32 joint_affine[][JOINT_AFFINE_FLOATS],
+                                             u32 joint_count);
+
+/* In-place form of renderer_draw_skinned_instanced: queues the draw and
+ * returns its instances and joint palettes (same layout) in this frame's
+ * mapped buffers, e.g. for animation_pose_to_affine to write into directly. Same
+ * write-only / next-call lifetime rules as renderer_alloc_instances. Returns
+ * false, queuing nothing, if the mesh isn't skinned, a buffer is full or the
+ * instance format isn't INSTANCE_FORMAT_3D_EULER. */
+bool         renderer_alloc_skinned(Renderer *renderer, MeshHandle mesh, TextureHandle texture,
+                                    u32 instance_count, u32 joint_count,
+                                    InstanceData3D **out_instances,
+                                    f32 (**out_joint_affine)[JOINT_AFFINE_FLOATS]);
+
 #endif /* ENGINE_RENDERER_H */
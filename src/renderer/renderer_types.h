@@ -78,6 +78,49 @@ typedef struct {
     f32 weights[4];  /* bone weights (sum to 1.0) */
 } SkinnedVertex3D;   /* 76 bytes */
 
+/* ---- Packed GPU vertex formats (RendererConfig.packed_vertices) ----
+ * What the vertex buffers hold when packing is enabled. Uploads still take
+ * Vertex3D / SkinnedVertex3D and convert (see vertex_pack.h). */
+
+typedef struct {
+    f32 position[3]; /* x, y, z */
+    i16 normal[2];   /* octahedral-encoded unit normal, snorm16 */
+    u16 uv[2];       /* half floats */
+    u8  color[4];    /* r, g, b unorm8 (a unused, 255) */
+} PackedVertex3D;    /* 24 bytes */
+
+typedef struct {
+    f32 position[3];
+    i16 normal[2];
+    u16 uv[2];
+    u8  color[4];
+    u8  joints[4];   /* bone indices (MAX_JOINTS <= 256) */
+    u16 weights[4];  /* unorm16, sum to 65535 */
+} PackedSkinnedVertex3D; /* 36 bytes */
+
+/* ---- GPU 3D instance formats (RendererConfig.instance_format_3d) ----
+ * What the 3D and skinned instance buffers hold. Draw calls still take
+ * InstanceData3D and convert once per instance on submission, so the vertex
+ * shader no longer rebuilds a rotation from Euler angles for every vertex. */
+
+typedef enum {
+    INSTANCE_FORMAT_3D_EULER,  /* InstanceData3D as is (48 B), sin/cos per vertex */
+    INSTANCE_FORMAT_3D_QUAT,   /* PackedInstanceData3D (32 B) */
+    INSTANCE_FORMAT_3D_MATRIX, /* MatrixInstanceData3D (60 B), no per-vertex rebuild at all */
+} InstanceFormat3D;
+
+typedef struct {
+    f32 position[3]; /* x, y, z */
+    i16 rotation[4]; /* unit quaternion x, y, z, w, snorm16 */
+    u16 scale[3];    /* half floats */
+    u16 color[3];    /* half floats (HDR tints survive) */
+} PackedInstanceData3D; /* 32 bytes */
+
+typedef struct {
+    f32 model[3][4]; /* rows of the 3x4 model matrix (rotation * scale | position) */
+    f32 color[3];
+} MatrixInstanceData3D; /* 60 bytes */
+
 /* ---- 3D Camera ---- */
 
 typedef struct {
@@ -98,9 +141,161 @@ typedef struct {
     f32 shininess;    /* specular exponent (e.g. 32.0) */
 } DirectionalLight;
 
+/* Shadow cascades of the directional light (renderer_set_shadows) */
+#define SHADOW_CASCADES 4
+
+/* ---- Point and spot lights (renderer_draw_lights) ---- */
+
+#define RENDERER_MAX_LIGHTS 1024   /* per frame */
+
+/* A spot light is a point light with a cone: spot_outer > 0 */
+typedef struct {
+    f32 position[3];  /* world space */
+    f32 radius;       /* no light beyond this distance */
+    f32 color[3];     /* r, g, b */
+    f32 intensity;    /* multiplied with color */
+    f32 direction[3]; /* spot only: normalized, the way the cone points */
+    f32 spot_inner;   /* spot only: half-angle of full intensity, radians */
+    f32 spot_outer;   /* half-angle where the cone fades out, radians (0 = point light) */
+} PointLight;
+
+/* ---- Presentation (RendererConfig.present_mode, renderer_set_present_mode) ---- */
+
+typedef enum {
+    PRESENT_MODE_DEFAULT,      /* IMMEDIATE, else MAILBOX, else FIFO (uncapped, for benchmarking) */
+    PRESENT_MODE_FIFO,         /* VSync, always available; lowest power */
+    PRESENT_MODE_FIFO_RELAXED, /* VSync, but a late frame tears instead of waiting a refresh */
+    PRESENT_MODE_MAILBOX,      /* VSync without blocking: the newest frame replaces a queued one */
+    PRESENT_MODE_IMMEDIATE,    /* no VSync, may tear; lowest latency */
+} PresentMode;
+
+/* Upper bound for RendererConfig.frames_in_flight */
+#define RENDERER_MAX_FRAMES_IN_FLIGHT 3
+
 /* ---- Texture handle (opaque to the game, returned by renderer_load_texture) ---- */
 
 typedef u32 TextureHandle;
 #define TEXTURE_HANDLE_INVALID ((TextureHandle)0xFFFFFFFF)
 
+/* ---- Sprite handle (an atlas sub-rect, returned by renderer_load_sprite) ---- */
+
+typedef u32 SpriteHandle;
+#define SPRITE_HANDLE_INVALID ((SpriteHandle)0xFFFFFFFF)
+
+/* ---- GPU particle systems (renderer_create_gpu_particles) ---- */
+
+typedef u32 GpuParticlesHandle;
+#define GPU_PARTICLES_HANDLE_INVALID ((GpuParticlesHandle)0xFFFFFFFF)
+
+#define GPU_PARTICLES_MAX_SYSTEMS  8
+#define GPU_PARTICLES_MAX_CAPACITY (1u << 20)  /* particles per system */
+#define GPU_PARTICLES_MAX_BURSTS   32          /* bursts per system per frame */
+
+/* A burst spawned on the GPU: count particles in a 360-degree circle around
+ * position. Same fields and meaning as ParticleEmitter (gameplay/particles.h). */
+typedef struct {
+    f32 position[2];
+    f32 color[3];
+    u32 count;
+    f32 speed_min, speed_max;
+    f32 lifetime_min, lifetime_max;
+    f32 scale;
+    f32 angular_velocity_min, angular_velocity_max;
+} GpuParticleBurst;
+
+/* ---- Static 3D instance batches (renderer_create_static_batch) ---- */
+
+typedef u32 StaticBatchHandle;
+#define STATIC_BATCH_HANDLE_INVALID ((StaticBatchHandle)0xFFFFFFFF)
+
+#define STATIC_BATCH_MAX 64
+
+/* ---- GPU timings (renderer_get_gpu_timings) ---- */
+
+typedef enum {
+    GPU_PASS_SKIN_COMPUTE,
+    GPU_PASS_PARTICLES,   /* GPU particle simulate + spawn dispatches */
+    GPU_PASS_LIGHT_CULL,  /* clustered light binning dispatch */
+    GPU_PASS_SHADOW,      /* depth-only cascade passes */
+    GPU_PASS_2D,
+    GPU_PASS_3D,
+    GPU_PASS_SKINNED,     /* pre-skinned and palette-skinned draws */
+    GPU_PASS_TEXT,
+    GPU_PASS_BLOOM_DOWN,  /* prefilter + downsample chain */
+    GPU_PASS_BLOOM_UP,
+    GPU_PASS_COMPOSITE,
+    GPU_PASS_COUNT,
+} GpuPass;
+
+/* Times are in milliseconds. Passes inside one render pass can overlap on
+ * the GPU, so pass times need not add up to frame_ms. */
+typedef struct {
+    f32  frame_ms;                 /* first to last command of the frame */
+    f32  scene_ms;                 /* up to the end of the bloom pyramid (== frame_ms without bloom) */
+    f32  pass_ms[GPU_PASS_COUNT];  /* 0 for passes that didn't run */
+    u64  frame_number;             /* frame these were recorded in */
+    bool valid;                    /* false until the first frame is read back */
+} GpuTimings;
+
+/* ---- Renderer statistics (renderer_get_stats) ---- */
+
+#define RENDERER_STATS_MAX_HEAPS 16  /* VK_MAX_MEMORY_HEAPS */
+
+/* What the last submitted frame recorded, over every view (camera and
+ * shadow cascades). draws counts draw records: a run of indexed 3D draws
+ * that goes out as one multi-draw-indirect call still counts each record.
+ * GPU particle instances and triangles are only known to the GPU and are
+ * left out; their draws are counted. */
+typedef struct {
+    u32 draws;
+    u32 instances;
+    u64 triangles;
+    u32 pipeline_binds;   /* one per non-empty draw group */
+    u32 texture_changes;  /* texture index updates between consecutive draws */
+    u64 upload_bytes;     /* staged uploads queued + per-frame ring writes */
+} RendererFrameStats;
+
+/* How much of a limit is taken */
+typedef struct {
+    u64 used;
+    u64 capacity;
+} RendererUsage;
+
+/* One device memory heap. budget and usage come from VK_EXT_memory_budget
+ * and cover the whole process (0 when the extension is missing). */
+typedef struct {
+    u64  size;
+    u64  reserved;      /* bytes in the renderer's memory blocks */
+    u64  budget;        /* what the process can allocate before trouble */
+    u64  usage;
+    bool device_local;
+} RendererHeapStats;
+
+typedef struct {
+    RendererFrameStats frame;
+    u64                frame_number;  /* frame the counters belong to */
+
+    /* Resource tables and shared geometry buffers, in slots / elements */
+    RendererUsage meshes;
+    RendererUsage textures;
+    RendererUsage vertices_2d;
+    RendererUsage vertices_3d;
+    RendererUsage vertices_skinned;
+    RendererUsage indices;
+
+    /* Per-frame rings as the last frame left them. Instance rings grow on
+     * demand, so their capacity is the current size rather than a limit. */
+    RendererUsage instances_2d;
+    RendererUsage instances_3d;
+    RendererUsage instances_skinned;
+    RendererUsage joint_bytes;
+    RendererUsage text_vertices;
+
+    /* Device memory: bytes handed out / bytes reserved in blocks */
+    RendererUsage     gpu_memory;
+    u32               heap_count;
+    RendererHeapStats heaps[RENDERER_STATS_MAX_HEAPS];
+    bool              memory_budget;  /* heaps[].budget / usage are filled in */
+} RendererStats;
+
 #endif /* ENGINE_RENDERER_TYPES_H */
@@ -0,0 +1,483 @@
+#include "renderer/resource_table.h"
+#include "renderer/vk_buffer.h"
+#include "renderer/vk_upload.h"
+#include "core/log.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* --------------------------------------------------------------------------
+ * Range allocator
+ * ------------------------------------------------------------------------ */
+
+static bool range_insert(RangeAllocator *ra, u32 at, u32 first, u32 count) {
+    if (ra->free_count == ra->free_capacity) {
+        u32 new_cap = ra->free_capacity ? ra->free_capacity * 2 : 16;
+        BufferRange *r = realloc(ra->free, sizeof(BufferRange) * new_cap);
+        if (!r) return false;
+        ra->free          = r;
+        ra->free_capacity = new_cap;
+    }
+    memmove(&ra->free[at + 1], &ra->free[at], sizeof(BufferRange) * (ra->free_count - at));
+    ra->free[at] = (BufferRange){ first, count };
+    ra->free_count++;
+    return true;
+}
+
+static void range_remove(RangeAllocator *ra, u32 at) {
+    memmove(&ra->free[at], &ra->free[at + 1], sizeof(BufferRange) * (ra->free_count - at - 1));
+    ra->free_count--;
+}
+
+/* Everything below `used` allocated, the rest one free range */
+static void range_reset(RangeAllocator *ra, u32 used) {
+    ra->free_count = 0;
+    ra->used       = used;
+    if (used < ra->capacity) range_insert(ra, 0, used, ra->capacity - used);
+}
+
+EngineResult range_alloc_init(RangeAllocator *ra, u32 capacity) {
+    memset(ra, 0, sizeof(*ra));
+    ra->capacity = capacity;
+    if (!range_insert(ra, 0, 0, capacity)) return ENGINE_ERROR_OUT_OF_MEMORY;
+    return ENGINE_SUCCESS;
+}
+
+void range_alloc_destroy(RangeAllocator *ra) {
+    free(ra->free);
+    memset(ra, 0, sizeof(*ra));
+}
+
+bool range_alloc(RangeAllocator *ra, u32 count, u32 *out_first) {
+    if (count == 0) {
+        *out_first = 0;
+        return true;
+    }
+    for (u32 i = 0; i < ra->free_count; i++) {
+        BufferRange *r = &ra->free[i];
+        if (r->count < count) continue;
+
+        *out_first = r->first;
+        if (r->count == count) {
+            range_remove(ra, i);
+        } else {
+            r->first += count;
+            r->count -= count;
+        }
+        ra->used += count;
+        return true;
+    }
+    return false;
+}
+
+void range_free(RangeAllocator *ra, u32 first, u32 count) {
+    if (count == 0) return;
+
+    u32 at = 0;
+    while (at < ra->free_count && ra->free[at].first < first) at++;
+
+    bool merge_prev = at > 0 && ra->free[at - 1].first + ra->free[at - 1].count == first;
+    bool merge_next = at < ra->free_count && first + count == ra->free[at].first;
+
+    if (merge_prev && merge_next) {
+        ra->free[at - 1].count += count + ra->free[at].count;
+        range_remove(ra, at);
+    } else if (merge_prev) {
+        ra->free[at - 1].count += count;
+    } else if (merge_next) {
+        ra->free[at].first  = first;
+        ra->free[at].count += count;
+    } else if (!range_insert(ra, at, first, count)) {
+        /* Out of host memory: the range leaks until the next compaction */
+        LOG_WARN("Range allocator: failed to record freed range");
+    }
+    ra->used -= count;
+}
+
+/* --------------------------------------------------------------------------
+ * Handle tables
+ * ------------------------------------------------------------------------ */
+
+static EngineResult handle_table_init(HandleTable *t, u32 capacity) {
+    memset(t, 0, sizeof(*t));
+    t->generation = calloc(capacity, sizeof(u16));
+    t->live       = calloc(capacity, sizeof(u8));
+    t->free       = calloc(capacity, sizeof(u32));
+    if (!t->generation || !t->live || !t->free) return ENGINE_ERROR_OUT_OF_MEMORY;
+    return ENGINE_SUCCESS;
+}
+
+static void handle_table_destroy(HandleTable *t) {
+    free(t->generation);
+    free(t->live);
+    free(t->free);
+    memset(t, 0, sizeof(*t));
+}
+
+static u32 handle_of(const HandleTable *t, u32 slot) {
+    return slot | ((u32)t->generation[slot] << HANDLE_SLOT_BITS);
+}
+
+/* Pop a released slot, or take slot *count if it is below capacity */
+static bool handle_claim(HandleTable *t, u32 *count, u32 capacity, u32 *out_slot) {
+    u32 slot;
+    if (t->free_count > 0) {
+        slot = t->free[--t->free_count];
+    } else if (*count < capacity) {
+        slot = (*count)++;
+    } else {
+        return false;
+    }
+    t->live[slot] = 1;
+    *out_slot = slot;
+    return true;
+}
+
+static u32 handle_lookup(const HandleTable *t, u32 count, u32 handle) {
+    u32 slot = HANDLE_SLOT(handle);
+    if (slot >= count || !t->live[slot] || handle != handle_of(t, slot)) return HANDLE_SLOT_NONE;
+    return slot;
+}
+
+EngineResult resource_table_init(VulkanContext *vk) {
+    EngineResult res = handle_table_init(&vk->mesh_handles, MAX_MESHES);
+    if (res != ENGINE_SUCCESS) return res;
+    return handle_table_init(&vk->texture_handles, MAX_TEXTURES);
+}
+
+void resource_table_shutdown(VulkanContext *vk) {
+    resource_release_retired(vk, true);
+    free(vk->retired_resources);
+    vk->retired_resources         = NULL;
+    vk->retired_resource_capacity = 0;
+    handle_table_destroy(&vk->mesh_handles);
+    handle_table_destroy(&vk->texture_handles);
+}
+
+/* Put an unloaded slot on the retired list. Slots unloaded this frame may
+ * still be referenced by draws being recorded, so the list grows rather
+ * than releasing anything early. */
+static void retire(VulkanContext *vk, bool texture, u32 slot) {
+    if (vk->retired_resource_count == vk->retired_resource_capacity) {
+        u32 new_cap = vk->retired_resource_capacity ? vk->retired_resource_capacity * 2 : 64;
+        RetiredResource *r = realloc(vk->retired_resources, sizeof(RetiredResource) * new_cap);
+        if (!r) {
+            /* Out of memory: the slot stays unusable rather than being
+             * freed under the frame that references it */
+            LOG_ERROR("Retired resource list full; %s slot %u leaked",
+                      texture ? "texture" : "mesh", slot);
+            return;
+        }
+        vk->retired_resources         = r;
+        vk->retired_resource_capacity = new_cap;
+    }
+    vk->retired_resources[vk->retired_resource_count++] = (RetiredResource){
+        .texture      = texture,
+        .slot         = slot,
+        .retire_frame = vk->frame_number,
+    };
+}
+
+/* --------------------------------------------------------------------------
+ * Meshes
+ * ------------------------------------------------------------------------ */
+
+EngineResult mesh_reserve(VulkanContext *vk, MeshHandle *out_handle) {
+    u32 slot;
+    if (!handle_claim(&vk->mesh_handles, &vk->mesh_count, MAX_MESHES, &slot)) {
+        LOG_ERROR("Mesh table full (%u/%u)", vk->mesh_count, MAX_MESHES);
+        return ENGINE_ERROR_VULKAN_INIT;
+    }
+    vk->meshes[slot] = (MeshSlot){0};
+    *out_handle = handle_of(&vk->mesh_handles, slot);
+    return ENGINE_SUCCESS;
+}
+
+void mesh_cancel(VulkanContext *vk, MeshHandle handle) {
+    HandleTable *t = &vk->mesh_handles;
+    u32 slot = HANDLE_SLOT(handle);
+    t->live[slot] = 0;
+    t->free[t->free_count++] = slot;
+}
+
+u32 mesh_lookup(const VulkanContext *vk, MeshHandle handle) {
+    return handle_lookup(&vk->mesh_handles, vk->mesh_count, handle);
+}
+
+/* True if a pending async load is showing this mesh's geometry */
+static bool mesh_lent(const VulkanContext *vk, u32 slot) {
+    const MeshSlot *src = &vk->meshes[slot];
+    for (u32 i = 0; i < vk->mesh_count; i++) {
+        const MeshSlot *m = &vk->meshes[i];
+        if (i != slot && vk->mesh_handles.live[i] && m->borrowed && !src->borrowed &&
+            m->is_3d == src->is_3d && m->first_vertex == src->first_vertex &&
+            m->vertex_count == src->vertex_count) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* True if a static batch or GPU particle system draws this mesh. Both keep
+ * the raw slot, and particle draw args bake in its vertex range. */
+static bool mesh_referenced(const VulkanContext *vk, u32 slot) {
+    for (u32 i = 0; i < STATIC_BATCH_MAX; i++) {
+        const StaticBatch *sb = &vk->static_batches.batches[i];
+        if (sb->in_use && sb->mesh == slot) return true;
+    }
+    for (u32 i = 0; i < GPU_PARTICLES_MAX_SYSTEMS; i++) {
+        const GpuParticleSystem *ps = &vk->gpu_particles.systems[i];
+        if (ps->in_use && ps->mesh == slot) return true;
+    }
+    return false;
+}
+
+bool mesh_unload(VulkanContext *vk, MeshHandle handle) {
+    u32 slot = mesh_lookup(vk, handle);
+    if (slot == HANDLE_SLOT_NONE) {
+        LOG_WARN("Invalid mesh handle %u", handle);
+        return false;
+    }
+    if (mesh_lent(vk, slot)) {
+        LOG_WARN("Mesh %u is the placeholder of pending loads; not unloaded", handle);
+        return false;
+    }
+    if (mesh_referenced(vk, slot)) {
+        LOG_WARN("Mesh %u is drawn by a static batch or particle system; not unloaded",
+                 handle);
+        return false;
+    }
+
+    /* Draws queued earlier this frame still read the slot: it stays as is */
+    vk->mesh_handles.live[slot] = 0;
+    vk->mesh_handles.generation[slot]++;
+    retire(vk, false, slot);
+    return true;
+}
+
+static void release_mesh(VulkanContext *vk, u32 slot) {
+    MeshSlot *m = &vk->meshes[slot];
+    if (!m->borrowed) {
+        RangeAllocator *vertices = !m->is_3d      ? &vk->vertex_ranges
+                                 : m->is_skinned ? &vk->vertex_skinned_ranges
+                                                 : &vk->vertex_3d_ranges;
+        range_free(vertices, m->first_vertex, m->vertex_count);
+        for (u32 i = 0; i < m->lod_count; i++) {
+            range_free(&vk->index_ranges, m->lods[i].first_index, m->lods[i].index_count);
+        }
+    }
+    *m = (MeshSlot){0};
+
+    HandleTable *t = &vk->mesh_handles;
+    t->free[t->free_count++] = slot;
+}
+
+/* --------------------------------------------------------------------------
+ * Textures
+ * ------------------------------------------------------------------------ */
+
+void texture_mark_stale(VulkanContext *vk, u32 slot) {
+    u32 set_count = vk->texture_update_after_bind ? 1 : vk->frames_in_flight;
+    u8  stale = 0;
+    for (u32 i = 0; i < set_count; i++) {
+        if (vk->texture_table_written[i] > slot + 1) stale |= (u8)(1u << i);
+    }
+    if (stale && !vk->texture_stale[slot]) vk->texture_table_stale++;
+    vk->texture_stale[slot] |= stale;
+}
+
+EngineResult texture_reserve(VulkanContext *vk, TextureHandle *out_handle) {
+    /* Slot 0 of the table is the dummy, so the device limit caps handles */
+    u32 slot;
+    if (!handle_claim(&vk->texture_handles, &vk->texture_count, vk->texture_slots - 1, &slot)) {
+        LOG_ERROR("Texture table full (%u/%u)", vk->texture_count, vk->texture_slots - 1);
+        return ENGINE_ERROR_VULKAN_INIT;
+    }
+    vk->textures[slot] = (VulkanTexture){0};
+    texture_mark_stale(vk, slot);
+    *out_handle = handle_of(&vk->texture_handles, slot);
+    return ENGINE_SUCCESS;
+}
+
+void texture_cancel(VulkanContext *vk, TextureHandle handle) {
+    HandleTable *t = &vk->texture_handles;
+    u32 slot = HANDLE_SLOT(handle);
+    t->live[slot] = 0;
+    t->free[t->free_count++] = slot;
+}
+
+u32 texture_lookup(const VulkanContext *vk, TextureHandle handle) {
+    return handle_lookup(&vk->texture_handles, vk->texture_count, handle);
+}
+
+bool texture_unload(VulkanContext *vk, TextureHandle handle) {
+    u32 slot = texture_lookup(vk, handle);
+    if (slot == HANDLE_SLOT_NONE) {
+        LOG_WARN("Invalid texture handle %u", handle);
+        return false;
+    }
+
+    /* Submitted frames may still sample the slot, so its descriptor and
+     * image stay as they are until the last of them retires */
+    vk->texture_handles.live[slot] = 0;
+    vk->texture_handles.generation[slot]++;
+    retire(vk, true, slot);
+    return true;
+}
+
+static void release_texture(VulkanContext *vk, u32 slot) {
+    vk_destroy_texture(vk, &vk->textures[slot]);
+    vk->textures[slot] = (VulkanTexture){0};
+
+    /* No pending frame samples the slot any more; with update-after-bind the
+     * one shared set is rewritten to the dummy before this frame submits */
+    texture_mark_stale(vk, slot);
+
+    HandleTable *t = &vk->texture_handles;
+    t->free[t->free_count++] = slot;
+}
+
+/* Draws queued before the unload still use the slot in the frame it was
+ * unloaded in, which has completed once frames_in_flight more have begun */
+void resource_release_retired(VulkanContext *vk, bool force) {
+    u32 kept = 0;
+    for (u32 i = 0; i < vk->retired_resource_count; i++) {
+        RetiredResource *rr = &vk->retired_resources[i];
+        if (force || vk->frame_number >= rr->retire_frame + vk->frames_in_flight) {
+            if (rr->texture) release_texture(vk, rr->slot);
+            else             release_mesh(vk, rr->slot);
+        } else {
+            vk->retired_resources[kept++] = *rr;
+        }
+    }
+    vk->retired_resource_count = kept;
+}
+
+/* --------------------------------------------------------------------------
+ * Compaction
+ *
+ * Live ranges are copied, in offset order, into a scratch buffer packed from
+ * zero and then copied back in one piece: a move within one buffer would
+ * overlap its own source whenever a range slides by less than its size.
+ * ------------------------------------------------------------------------ */
+
+typedef struct {
+    u32 *first;   /* offset field to patch */
+    u32  count;
+} CompactRange;
+
+static int compare_ranges(const void *a, const void *b) {
+    u32 fa = *((const CompactRange *)a)->first;
+    u32 fb = *((const CompactRange *)b)->first;
+    return (fa > fb) - (fa < fb);
+}
+
+static EngineResult compact_buffer(VulkanContext *vk, VkBuffer buffer, u32 elem_size,
+                                   RangeAllocator *ra, CompactRange *ranges, u32 count,
+                                   const char *name) {
+    qsort(ranges, count, sizeof(CompactRange), compare_ranges);
+
+    VkBufferCopy regions[MAX_MESHES * MESH_MAX_LODS];
+    u32  used  = 0;
+    bool moved = false;
+    for (u32 i = 0; i < count; i++) {
+        regions[i] = (VkBufferCopy){
+            .srcOffset = (VkDeviceSize)*ranges[i].first * elem_size,
+            .dstOffset = (VkDeviceSize)used * elem_size,
+            .size      = (VkDeviceSize)ranges[i].count * elem_size,
+        };
+        if (*ranges[i].first != used) moved = true;
+        used += ranges[i].count;
+    }
+
+    if (moved) {
+        VkBuffer      scratch = VK_NULL_HANDLE;
+        GpuAllocation scratch_memory = {0};
+        VkDeviceSize  size = (VkDeviceSize)used * elem_size;
+        EngineResult res = vk_create_buffer(vk, size,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &scratch, &scratch_memory);
+        if (res != ENGINE_SUCCESS) return res;
+
+        VkCommandBuffer cmd = vk_begin_single_command(vk);
+        vkCmdCopyBuffer(cmd, buffer, scratch, count, regions);
+        VkMemoryBarrier barrier = {
+            .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+        };
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 1, &barrier, 0, NULL, 0, NULL);
+        VkBufferCopy back = { .srcOffset = 0, .dstOffset = 0, .size = size };
+        vkCmdCopyBuffer(cmd, scratch, buffer, 1, &back);
+        vk_end_single_command(vk, cmd);
+
+        vk_destroy_buffer(vk, &scratch, &scratch_memory);
+
+        for (u32 i = 0; i < count; i++) {
+            *ranges[i].first = (u32)(regions[i].dstOffset / elem_size);
+        }
+    }
+
+    if (moved) LOG_INFO("%s compacted: %u / %u in use", name, used, ra->capacity);
+    range_reset(ra, used);
+    return ENGINE_SUCCESS;
+}
+
+EngineResult mesh_compact(VulkanContext *vk) {
+    /* Nothing may read the old offsets or still be copying into them */
+    vkDeviceWaitIdle(vk->device);
+    vk_upload_wait_idle(vk);
+    resource_release_retired(vk, true);
+
+    CompactRange vertices_3d[MAX_MESHES];
+    CompactRange vertices_skinned[MAX_MESHES];
+    CompactRange indices[MAX_MESHES * MESH_MAX_LODS];
+    u32 n3d = 0, nskinned = 0, nindices = 0;
+
+    for (u32 i = 0; i < vk->mesh_count; i++) {
+        MeshSlot *m = &vk->meshes[i];
+        if (!vk->mesh_handles.live[i] || m->borrowed || !m->is_3d) continue;
+
+        CompactRange r = { &m->first_vertex, m->vertex_count };
+        if (m->vertex_count > 0) {
+            if (m->is_skinned) vertices_skinned[nskinned++] = r;
+            else               vertices_3d[n3d++] = r;
+        }
+        for (u32 l = 0; l < m->lod_count; l++) {
+            if (m->lods[l].index_count == 0) continue;
+            indices[nindices++] = (CompactRange){ &m->lods[l].first_index, m->lods[l].index_count };
+        }
+    }
+
+    EngineResult res = compact_buffer(vk, vk->vertex_buffer_3d, vk_vertex_3d_stride(vk),
+                                      &vk->vertex_3d_ranges, vertices_3d, n3d,
+                                      "3D vertex buffer");
+    if (res == ENGINE_SUCCESS && vk->vertex_buffer_skinned) {
+        res = compact_buffer(vk, vk->vertex_buffer_skinned, vk_vertex_skinned_stride(vk),
+                             &vk->vertex_skinned_ranges, vertices_skinned, nskinned,
+                             "Skinned vertex buffer");
+    }
+    if (res == ENGINE_SUCCESS) {
+        res = compact_buffer(vk, vk->index_buffer, sizeof(u32), &vk->index_ranges,
+                             indices, nindices, "Index buffer");
+    }
+
+    /* lods[0] mirrors the mesh's own index range; borrowed slots mirror
+     * the placeholder they were copied from */
+    for (u32 i = 0; i < vk->mesh_count; i++) {
+        MeshSlot *m = &vk->meshes[i];
+        if (vk->mesh_handles.live[i] && !m->borrowed && m->lod_count > 0) {
+            m->first_index = m->lods[0].first_index;
+        }
+    }
+    u32 placeholder = mesh_lookup(vk, vk->asset_loads.placeholder_mesh);
+    for (u32 i = 0; i < vk->mesh_count; i++) {
+        MeshSlot *m = &vk->meshes[i];
+        if (vk->mesh_handles.live[i] && m->borrowed && placeholder != HANDLE_SLOT_NONE) {
+            *m = vk->meshes[placeholder];
+            m->borrowed = true;
+        }
+    }
+    return res;
+}
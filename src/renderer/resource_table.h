@@ -0,0 +1,64 @@
+#ifndef ENGINE_RESOURCE_TABLE_H
+#define ENGINE_RESOURCE_TABLE_H
+
+#include "renderer/vk_types.h"
+#include "core/common.h"
+
+/* ---- Range allocation over the shared vertex / index buffers ---- */
+
+EngineResult range_alloc_init(RangeAllocator *ra, u32 capacity);
+void         range_alloc_destroy(RangeAllocator *ra);
+
+/* First-fit carve of `count` elements. Returns false when no free range is
+ * large enough (unloading or compacting may make room). */
+bool         range_alloc(RangeAllocator *ra, u32 count, u32 *out_first);
+
+/* Return a range, merging it with its free neighbours */
+void         range_free(RangeAllocator *ra, u32 first, u32 count);
+
+/* ---- Mesh and texture handle tables ---- */
+
+/* Call before any mesh or texture is created */
+EngineResult resource_table_init(VulkanContext *vk);
+
+/* Release everything still retired (the device must be idle) and free the
+ * tables. Live textures are left to the renderer's teardown. */
+void         resource_table_shutdown(VulkanContext *vk);
+
+/* Claim a mesh slot (a released one first) and return its handle. The
+ * caller fills vk->meshes[HANDLE_SLOT(handle)]; if that fails it hands the
+ * slot back with mesh_cancel. */
+EngineResult mesh_reserve(VulkanContext *vk, MeshHandle *out_handle);
+void         mesh_cancel(VulkanContext *vk, MeshHandle handle);
+
+/* Slot of a live mesh handle, or HANDLE_SLOT_NONE if the handle is invalid,
+ * stale or unloaded */
+u32          mesh_lookup(const VulkanContext *vk, MeshHandle handle);
+
+/* Invalidate the handle now; the slot and its buffer ranges are released
+ * once no in-flight frame can draw them. Returns false (and logs) for a bad
+ * handle or a mesh that pending async loads are showing as placeholder. */
+bool         mesh_unload(VulkanContext *vk, MeshHandle handle);
+
+/* Texture counterparts. A reserved slot whose table entry was already
+ * written (a reused slot) is queued for rewriting in those table sets. */
+EngineResult texture_reserve(VulkanContext *vk, TextureHandle *out_handle);
+void         texture_cancel(VulkanContext *vk, TextureHandle handle);
+u32          texture_lookup(const VulkanContext *vk, TextureHandle handle);
+bool         texture_unload(VulkanContext *vk, TextureHandle handle);
+
+/* Queue a texture table slot for rewriting in every set already written
+ * past it (texture_table_sync does the writes, one set per frame) */
+void         texture_mark_stale(VulkanContext *vk, u32 slot);
+
+/* Release unloaded resources whose last possible frame has retired (all of
+ * them with force, once the device is idle). Call after the frame fence. */
+void         resource_release_retired(VulkanContext *vk, bool force);
+
+/* Move the live ranges of the 3D vertex, skinned vertex and index buffers
+ * to the front of each buffer, closing the holes unloads leave behind.
+ * Waits for the device to go idle; call outside begin/end_frame. The 2D
+ * vertex buffer is not compacted: GPU particle systems keep offsets into it. */
+EngineResult mesh_compact(VulkanContext *vk);
+
+#endif /* ENGINE_RESOURCE_TABLE_H */
@@ -0,0 +1,310 @@
+#include "renderer/shadow.h"
+#include "renderer/render_graph.h"
+#include "core/log.h"
+
+#include <cglm/mat4.h>
+#include <cglm/vec3.h>
+#include <cglm/cam.h>
+#include <cglm/frustum.h>
+
+#include <math.h>
+#include <string.h>
+
+#define SHADOW_FORMAT       VK_FORMAT_D32_SFLOAT
+#define SHADOW_SPLIT_LAMBDA 0.75f  /* 0 = uniform splits, 1 = logarithmic */
+
+_Static_assert(SHADOW_CASCADES <= 4, "cascade splits are packed into one vec4 of LightUniforms");
+
+/* --------------------------------------------------------------------------
+ * Resources
+ * ------------------------------------------------------------------------ */
+
+static EngineResult create_render_pass(VulkanContext *vk) {
+    ShadowContext *sh = &vk->shadow;
+
+    /* Cleared every pass. The render graph puts the map in the attachment
+     * layout first, then in the read-only one for the scene pass, with the
+     * barriers both ways, so the pass needs no dependencies of its own. */
+    VkAttachmentDescription attachment = {
+        .format         = SHADOW_FORMAT,
+        .samples        = VK_SAMPLE_COUNT_1_BIT,
+        .loadOp         = VK_ATTACHMENT_LOAD_OP_CLEAR,
+        .storeOp        = VK_ATTACHMENT_STORE_OP_STORE,
+        .stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+        .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+        .initialLayout  = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+        .finalLayout    = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+    };
+
+    VkAttachmentReference depth_ref = { 0, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+
+    VkSubpassDescription subpass = {
+        .pipelineBindPoint       = VK_PIPELINE_BIND_POINT_GRAPHICS,
+        .pDepthStencilAttachment = &depth_ref,
+    };
+
+    VkRenderPassCreateInfo rp_info = {
+        .sType           = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+        .attachmentCount = 1,
+        .pAttachments    = &attachment,
+        .subpassCount    = 1,
+        .pSubpasses      = &subpass,
+    };
+
+    if (vkCreateRenderPass(vk->device, &rp_info, NULL, &sh->render_pass) != VK_SUCCESS) {
+        LOG_FATAL("Shadows: failed to create render pass");
+        return ENGINE_ERROR_VULKAN_PIPELINE;
+    }
+    return ENGINE_SUCCESS;
+}
+
+static EngineResult create_sampler(VulkanContext *vk) {
+    /* Hardware compare with linear filtering blends 2x2 results per tap;
+     * outside the map reads as lit */
+    VkSamplerCreateInfo sampler_info = {
+        .sType         = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+        .magFilter     = VK_FILTER_LINEAR,
+        .minFilter     = VK_FILTER_LINEAR,
+        .addressModeU  = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER,
+        .addressModeV  = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER,
+        .addressModeW  = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        .borderColor   = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE,
+        .mipmapMode    = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+        .compareEnable = VK_TRUE,
+        .compareOp     = VK_COMPARE_OP_LESS_OR_EQUAL,
+    };
+
+    if (vkCreateSampler(vk->device, &sampler_info, NULL, &vk->shadow.sampler) != VK_SUCCESS)
+        return ENGINE_ERROR_VULKAN_INIT;
+    return ENGINE_SUCCESS;
+}
+
+static void destroy_views(VulkanContext *vk) {
+    ShadowContext *sh = &vk->shadow;
+
+    for (u32 i = 0; i < SHADOW_CASCADES; i++) {
+        if (sh->framebuffers[i]) vkDestroyFramebuffer(vk->device, sh->framebuffers[i], NULL);
+        if (sh->layer_views[i])  vkDestroyImageView(vk->device, sh->layer_views[i], NULL);
+        sh->framebuffers[i] = VK_NULL_HANDLE;
+        sh->layer_views[i]  = VK_NULL_HANDLE;
+    }
+    if (sh->array_view) vkDestroyImageView(vk->device, sh->array_view, NULL);
+    sh->array_view = VK_NULL_HANDLE;
+}
+
+/* --------------------------------------------------------------------------
+ * Lifecycle
+ * ------------------------------------------------------------------------ */
+
+EngineResult shadow_init(VulkanContext *vk, u32 size) {
+    ShadowContext *sh = &vk->shadow;
+    memset(sh, 0, sizeof(*sh));
+
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(vk->physical_device, &props);
+    u32 max_size = props.limits.maxImageDimension2D;
+
+    sh->available    = size > 0;
+    sh->size         = sh->available ? ENGINE_MIN(size, max_size) : 1;
+    sh->max_distance = SHADOW_DEFAULT_DISTANCE;
+    sh->fitted_frame = UINT64_MAX;
+
+    EngineResult res;
+    if ((res = create_render_pass(vk)) != ENGINE_SUCCESS) return res;
+    if ((res = create_sampler(vk))     != ENGINE_SUCCESS) return res;
+
+    RgImageDesc desc = {
+        .format       = SHADOW_FORMAT,
+        .extent       = { sh->size, sh->size },
+        .mip_levels   = 1,
+        .array_layers = SHADOW_CASCADES,
+        .usage        = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        .aspect       = VK_IMAGE_ASPECT_DEPTH_BIT,
+    };
+    sh->map = render_graph_add_image(vk, "shadow_map", &desc);
+
+    if (sh->available) {
+        LOG_INFO("Shadow map: %d cascades of %ux%u (%u MB)", SHADOW_CASCADES, sh->size,
+                 sh->size, (u32)((u64)sh->size * sh->size * 4 * SHADOW_CASCADES >> 20));
+    }
+    return ENGINE_SUCCESS;
+}
+
+EngineResult shadow_bind_map(VulkanContext *vk) {
+    ShadowContext *sh = &vk->shadow;
+    destroy_views(vk);
+
+    /* One array view for sampling, one single-layer view per framebuffer */
+    for (u32 i = 0; i <= SHADOW_CASCADES; i++) {
+        bool array = (i == SHADOW_CASCADES);
+        VkImageViewCreateInfo view_info = {
+            .sType    = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .image    = render_graph_image(vk, sh->map),
+            .viewType = array ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D,
+            .format   = SHADOW_FORMAT,
+            .subresourceRange = {
+                .aspectMask     = VK_IMAGE_ASPECT_DEPTH_BIT,
+                .baseMipLevel   = 0,
+                .levelCount     = 1,
+                .baseArrayLayer = array ? 0 : i,
+                .layerCount     = array ? SHADOW_CASCADES : 1,
+            },
+        };
+        VkImageView *view = array ? &sh->array_view : &sh->layer_views[i];
+        if (vkCreateImageView(vk->device, &view_info, NULL, view) != VK_SUCCESS)
+            return ENGINE_ERROR_VULKAN_INIT;
+    }
+
+    for (u32 i = 0; i < SHADOW_CASCADES; i++) {
+        VkFramebufferCreateInfo fb_info = {
+            .sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+            .renderPass      = sh->render_pass,
+            .attachmentCount = 1,
+            .pAttachments    = &sh->layer_views[i],
+            .width           = sh->size,
+            .height          = sh->size,
+            .layers          = 1,
+        };
+        if (vkCreateFramebuffer(vk->device, &fb_info, NULL, &sh->framebuffers[i]) != VK_SUCCESS)
+            return ENGINE_ERROR_VULKAN_INIT;
+    }
+    return ENGINE_SUCCESS;
+}
+
+void shadow_shutdown(VulkanContext *vk) {
+    ShadowContext *sh = &vk->shadow;
+
+    /* The map itself belongs to the render graph */
+    destroy_views(vk);
+    if (sh->skinned_pipeline) vkDestroyPipeline(vk->device, sh->skinned_pipeline, NULL);
+    if (sh->pipeline_3d)      vkDestroyPipeline(vk->device, sh->pipeline_3d, NULL);
+    if (sh->sampler)          vkDestroySampler(vk->device, sh->sampler, NULL);
+    if (sh->render_pass)      vkDestroyRenderPass(vk->device, sh->render_pass, NULL);
+
+    memset(sh, 0, sizeof(*sh));
+}
+
+/* --------------------------------------------------------------------------
+ * Cascade fitting
+ * ------------------------------------------------------------------------ */
+
+/* Fit cascade c around the camera view between depths z0 and z1. The box
+ * is built on the slice's bounding sphere, which doesn't change size as the
+ * camera turns, and its centre moves in whole texels of light space, so a
+ * static shadow stays on the same texels from frame to frame. */
+static void fit_cascade(ShadowContext *sh, u32 c, vec3 eye, vec3 forward, vec3 right,
+                        vec3 up, f32 tan_half, vec3 light_dir, vec3 light_up,
+                        f32 z0, f32 z1) {
+    vec3 corners[8];
+    vec3 center = { 0.0f, 0.0f, 0.0f };
+    for (u32 k = 0; k < 8; k++) {
+        f32 z = (k & 4) ? z1 : z0;
+        f32 h = z * tan_half;
+        f32 w = h * sh->aspect;
+        glm_vec3_copy(eye, corners[k]);
+        glm_vec3_muladds(forward, z, corners[k]);
+        glm_vec3_muladds(right, (k & 1) ? w : -w, corners[k]);
+        glm_vec3_muladds(up, (k & 2) ? h : -h, corners[k]);
+        glm_vec3_add(center, corners[k], center);
+    }
+    glm_vec3_scale(center, 1.0f / 8.0f, center);
+
+    f32 radius = 0.0f;
+    for (u32 k = 0; k < 8; k++) radius = fmaxf(radius, glm_vec3_distance(center, corners[k]));
+    radius = ceilf(radius * 16.0f) / 16.0f;
+
+    /* Snap the centre to the texel grid of the light's rotation */
+    f32 texel = 2.0f * radius / (f32)sh->size;
+    vec3 origin = { 0.0f, 0.0f, 0.0f };
+    mat4 rotation, inverse;
+    glm_lookat(origin, light_dir, light_up, rotation);
+    glm_mat4_inv(rotation, inverse);
+
+    vec3 snapped;
+    glm_mat4_mulv3(rotation, center, 1.0f, snapped);
+    snapped[0] = floorf(snapped[0] / texel) * texel;
+    snapped[1] = floorf(snapped[1] / texel) * texel;
+    glm_mat4_mulv3(inverse, snapped, 1.0f, center);
+
+    /* Casters up to max_distance towards the light still land in the box */
+    f32 pullback = radius + sh->max_distance;
+    vec3 light_eye;
+    glm_vec3_copy(center, light_eye);
+    glm_vec3_muladds(light_dir, -pullback, light_eye);
+
+    mat4 view, proj, vp;
+    glm_lookat(light_eye, center, light_up, view);
+    glm_ortho_rh_zo(-radius, radius, -radius, radius, 0.0f, pullback + radius, proj);
+    glm_mat4_mul(proj, view, vp);
+
+    memcpy(sh->vp[c], vp, sizeof(f32) * 16);
+    vec4 planes[6];
+    glm_frustum_planes(vp, planes);
+    for (u32 i = 0; i < 6; i++) memcpy(sh->planes[c][i], planes[i], sizeof(f32) * 4);
+    sh->texel_world[c] = texel;
+}
+
+void shadow_set_camera(VulkanContext *vk, const Camera3D *camera, f32 aspect) {
+    ShadowContext *sh = &vk->shadow;
+    sh->camera     = *camera;
+    sh->aspect     = aspect;
+    sh->has_camera = true;
+    shadow_fit_cascades(vk);
+}
+
+void shadow_fit_cascades(VulkanContext *vk) {
+    ShadowContext *sh = &vk->shadow;
+    if (!sh->enabled || !sh->has_camera) return;
+
+    const Camera3D *cam = &sh->camera;
+    vec3 eye     = { cam->position[0], cam->position[1], cam->position[2] };
+    vec3 target  = { cam->target[0], cam->target[1], cam->target[2] };
+    vec3 cam_up  = { cam->up[0], cam->up[1], cam->up[2] };
+    vec3 forward, right, up;
+    glm_vec3_sub(target, eye, forward);
+    glm_vec3_normalize(forward);
+    glm_vec3_crossn(forward, cam_up, right);
+    glm_vec3_cross(right, forward, up);
+
+    vec3 light_dir = { vk->light.direction[0], vk->light.direction[1], vk->light.direction[2] };
+    if (glm_vec3_norm2(light_dir) < 1e-12f) glm_vec3_copy((vec3){ 0.0f, -1.0f, 0.0f }, light_dir);
+    glm_vec3_normalize(light_dir);
+    vec3 light_up = { 0.0f, 1.0f, 0.0f };
+    if (fabsf(light_dir[1]) > 0.99f) glm_vec3_copy((vec3){ 0.0f, 0.0f, 1.0f }, light_up);
+
+    /* Practical split scheme: a blend of logarithmic and uniform splits */
+    f32 tan_half = tanf(cam->fov * ((f32)GLM_PI / 180.0f) * 0.5f);
+    f32 z_near = cam->near_plane;
+    f32 z_far  = ENGINE_MAX(ENGINE_MIN(cam->far_plane, sh->max_distance), z_near * 2.0f);
+    f32 z0 = z_near;
+    for (u32 c = 0; c < SHADOW_CASCADES; c++) {
+        f32 t   = (f32)(c + 1) / (f32)SHADOW_CASCADES;
+        f32 z1  = SHADOW_SPLIT_LAMBDA * z_near * powf(z_far / z_near, t) +
+                  (1.0f - SHADOW_SPLIT_LAMBDA) * (z_near + (z_far - z_near) * t);
+        fit_cascade(sh, c, eye, forward, right, up, tan_half, light_dir, light_up, z0, z1);
+        sh->splits[c] = z1;
+        z0 = z1;
+    }
+
+    glm_vec3_copy(forward, sh->view_dir);
+    sh->fitted_frame = vk->frame_number;
+}
+
+bool shadow_active(const VulkanContext *vk) {
+    const ShadowContext *sh = &vk->shadow;
+    return sh->enabled && sh->fitted_frame == vk->frame_number && vk->frustum_valid;
+}
+
+void shadow_write_uniforms(const VulkanContext *vk, LightUniforms *out) {
+    const ShadowContext *sh = &vk->shadow;
+    bool active = shadow_active(vk);
+
+    memcpy(out->cascade_vp, sh->vp, sizeof(out->cascade_vp));
+    for (u32 c = 0; c < SHADOW_CASCADES; c++) {
+        out->cascade_splits[c] = sh->splits[c];
+        out->cascade_texel[c]  = sh->texel_world[c];
+    }
+    memcpy(out->view_dir, sh->view_dir, sizeof(f32) * 3);
+    out->shadow_params[0] = active ? 1.0f : 0.0f;
+    out->shadow_params[1] = 1.0f / (f32)sh->size;
+}
@@ -0,0 +1,37 @@
+#ifndef ENGINE_SHADOW_H
+#define ENGINE_SHADOW_H
+
+#include "renderer/vk_types.h"
+#include "core/common.h"
+
+/* ---- Lifecycle (called from renderer.c) ---- */
+
+/* Render pass and sampler, and declares the shadow map (size x size texels
+ * per cascade) as a render graph image. size 0 makes shadows unavailable: a
+ * 1-texel map still backs the light descriptor. The depth-only pipelines are
+ * built with the others (vk_create_shadow_3d_pipeline /
+ * vk_create_shadow_skinned_3d_pipeline). */
+EngineResult shadow_init(VulkanContext *vk, u32 size);
+void         shadow_shutdown(VulkanContext *vk);
+
+/* (Re)create the views and framebuffers over the graph's shadow map. Called
+ * after every render_graph_compile. */
+EngineResult shadow_bind_map(VulkanContext *vk);
+
+/* ---- Cascades ---- */
+
+/* Remember the 3D camera the cascades split (aspect of its viewport) and refit */
+void shadow_set_camera(VulkanContext *vk, const Camera3D *camera, f32 aspect);
+
+/* Refit the cascades to the remembered camera and vk->light. Called again
+ * whenever either changes. */
+void shadow_fit_cascades(VulkanContext *vk);
+
+/* Shadows are on and the cascades belong to this frame's camera, so 3D draws
+ * submitted now also go into the cascade draw lists */
+bool shadow_active(const VulkanContext *vk);
+
+/* Fill the cascade and shadow fields of this frame's light uniforms */
+void shadow_write_uniforms(const VulkanContext *vk, LightUniforms *out);
+
+#endif /* ENGINE_SHADOW_H */
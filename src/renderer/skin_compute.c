@@ -0,0 +1,318 @@
+#include "renderer/skin_compute.h"
+#include "renderer/vk_pipeline.h"
+#include "renderer/vk_buffer.h"
+#include "core/log.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SKIN_LOCAL_SIZE 64   /* must match local_size_x in skin.comp */
+
+/* Push constants (20 bytes), see skin.comp */
+typedef struct {
+    u32 src_first;     /* first skinned vertex of the mesh */
+    u32 dst_first;     /* first 3D vertex in this frame's output region */
+    u32 vertex_count;
+    u32 joint_base;    /* first joint matrix in the joint SSBO region */
+    u32 joint_count;   /* joints per instance palette */
+} SkinPush;
+
+/* --------------------------------------------------------------------------
+ * Helpers
+ * ------------------------------------------------------------------------ */
+
+static bool graphics_queue_has_compute(const VulkanContext *vk) {
+    u32 count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(vk->physical_device, &count, NULL);
+    if (vk->graphics_family >= count) return false;
+
+    VkQueueFamilyProperties *families = malloc(sizeof(VkQueueFamilyProperties) * count);
+    if (!families) return false;
+    vkGetPhysicalDeviceQueueFamilyProperties(vk->physical_device, &count, families);
+    bool ok = (families[vk->graphics_family].queueFlags & VK_QUEUE_COMPUTE_BIT) != 0;
+    free(families);
+    return ok;
+}
+
+static EngineResult create_layouts(VulkanContext *vk) {
+    SkinComputeContext *sc = &vk->skin_compute;
+
+    VkDescriptorSetLayoutBinding bindings[] = {
+        {   /* Source SkinnedVertex3D buffer (static) */
+            .binding         = 0,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+        },
+        {   /* Output Vertex3D region, selected per frame by dynamic offset */
+            .binding         = 1,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+            .descriptorCount = 1,
+            .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+        },
+    };
+
+    VkDescriptorSetLayoutCreateInfo set_info = {
+        .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .bindingCount = ENGINE_ARRAY_LEN(bindings),
+        .pBindings    = bindings,
+    };
+    if (vkCreateDescriptorSetLayout(vk->device, &set_info, NULL,
+                                     &sc->desc_set_layout) != VK_SUCCESS) {
+        LOG_FATAL("Skin compute: failed to create descriptor set layout");
+        return ENGINE_ERROR_VULKAN_PIPELINE;
+    }
+
+    /* Set 1 reuses the joint SSBO layout, so the graphics path's set works here */
+    VkDescriptorSetLayout set_layouts[] = { sc->desc_set_layout, vk->joint_desc_set_layout };
+
+    VkPushConstantRange push_range = {
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .offset     = 0,
+        .size       = sizeof(SkinPush),
+    };
+
+    VkPipelineLayoutCreateInfo layout_info = {
+        .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount         = ENGINE_ARRAY_LEN(set_layouts),
+        .pSetLayouts            = set_layouts,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges    = &push_range,
+    };
+    if (vkCreatePipelineLayout(vk->device, &layout_info, NULL,
+                                &sc->pipeline_layout) != VK_SUCCESS) {
+        LOG_FATAL("Skin compute: failed to create pipeline layout");
+        return ENGINE_ERROR_VULKAN_PIPELINE;
+    }
+
+    return ENGINE_SUCCESS;
+}
+
+static EngineResult create_pipeline(VulkanContext *vk) {
+    SkinComputeContext *sc = &vk->skin_compute;
+
+    size_t code_size;
+    u8 *code = vk_read_file("shaders/skin.comp.spv", &code_size);
+    if (!code) {
+        LOG_FATAL("Skin compute: failed to load skin.comp.spv");
+        return ENGINE_ERROR_FILE_NOT_FOUND;
+    }
+
+    VkShaderModule module = vk_create_shader_module(vk->device, code, code_size);
+    free(code);
+    if (module == VK_NULL_HANDLE) return ENGINE_ERROR_VULKAN_PIPELINE;
+
+    /* Constant 0 selects the packed source/output vertex layouts */
+    VkBool32 packed = vk->packed_vertices ? VK_TRUE : VK_FALSE;
+    VkSpecializationMapEntry spec_entry = { .constantID = 0, .offset = 0, .size = sizeof(VkBool32) };
+    VkSpecializationInfo spec = {
+        .mapEntryCount = 1,
+        .pMapEntries   = &spec_entry,
+        .dataSize      = sizeof(VkBool32),
+        .pData         = &packed,
+    };
+
+    VkComputePipelineCreateInfo info = {
+        .sType  = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .stage  = {
+            .sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage               = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module              = module,
+            .pName               = "main",
+            .pSpecializationInfo = &spec,
+        },
+        .layout = sc->pipeline_layout,
+    };
+
+    VkResult vr = vkCreateComputePipelines(vk->device, vk->pipeline_cache, 1, &info,
+                                           NULL, &sc->pipeline);
+    vkDestroyShaderModule(vk->device, module, NULL);
+    if (vr != VK_SUCCESS) {
+        LOG_FATAL("Skin compute: failed to create pipeline");
+        return ENGINE_ERROR_VULKAN_PIPELINE;
+    }
+
+    return ENGINE_SUCCESS;
+}
+
+static EngineResult create_output(VulkanContext *vk) {
+    SkinComputeContext *sc = &vk->skin_compute;
+
+    /* Regions are bound with a dynamic offset, so align them like a FrameRing */
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(vk->physical_device, &props);
+    VkDeviceSize align = props.limits.minStorageBufferOffsetAlignment;
+    if (align == 0) align = 1;
+
+    VkDeviceSize frame_size = (VkDeviceSize)vk_vertex_3d_stride(vk) * SKIN_COMPUTE_MAX_VERTICES;
+    sc->frame_size = (frame_size + align - 1) / align * align;
+
+    return vk_create_buffer(vk, sc->frame_size * vk->frames_in_flight,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        &sc->output, &sc->output_memory);
+}
+
+static EngineResult create_descriptors(VulkanContext *vk) {
+    SkinComputeContext *sc = &vk->skin_compute;
+
+    VkDescriptorPoolSize pool_sizes[] = {
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         1 },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1 },
+    };
+    VkDescriptorPoolCreateInfo pool_info = {
+        .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .maxSets       = 1,
+        .poolSizeCount = ENGINE_ARRAY_LEN(pool_sizes),
+        .pPoolSizes    = pool_sizes,
+    };
+    if (vkCreateDescriptorPool(vk->device, &pool_info, NULL, &sc->desc_pool) != VK_SUCCESS) {
+        LOG_FATAL("Skin compute: failed to create descriptor pool");
+        return ENGINE_ERROR_VULKAN_INIT;
+    }
+
+    VkDescriptorSetAllocateInfo alloc_info = {
+        .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool     = sc->desc_pool,
+        .descriptorSetCount = 1,
+        .pSetLayouts        = &sc->desc_set_layout,
+    };
+    if (vkAllocateDescriptorSets(vk->device, &alloc_info, &sc->desc_set) != VK_SUCCESS) {
+        LOG_FATAL("Skin compute: failed to allocate descriptor set");
+        return ENGINE_ERROR_VULKAN_INIT;
+    }
+
+    /* Neither buffer is ever recreated, so the set is written once */
+    VkDescriptorBufferInfo src_info = {
+        .buffer = vk->vertex_buffer_skinned,
+        .offset = 0,
+        .range  = VK_WHOLE_SIZE,
+    };
+    VkDescriptorBufferInfo dst_info = {
+        .buffer = sc->output,
+        .offset = 0,
+        .range  = sc->frame_size,
+    };
+    VkWriteDescriptorSet writes[] = {
+        {
+            .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet          = sc->desc_set,
+            .dstBinding      = 0,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .pBufferInfo     = &src_info,
+        },
+        {
+            .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet          = sc->desc_set,
+            .dstBinding      = 1,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+            .descriptorCount = 1,
+            .pBufferInfo     = &dst_info,
+        },
+    };
+    vkUpdateDescriptorSets(vk->device, ENGINE_ARRAY_LEN(writes), writes, 0, NULL);
+
+    return ENGINE_SUCCESS;
+}
+
+/* --------------------------------------------------------------------------
+ * Lifecycle
+ * ------------------------------------------------------------------------ */
+
+EngineResult skin_compute_init(VulkanContext *vk) {
+    SkinComputeContext *sc = &vk->skin_compute;
+    memset(sc, 0, sizeof(*sc));
+
+    if (!graphics_queue_has_compute(vk)) {
+        LOG_WARN("Graphics queue has no compute support; compute skinning unavailable");
+        return ENGINE_SUCCESS;
+    }
+
+    EngineResult res;
+    if ((res = create_layouts(vk))     != ENGINE_SUCCESS) goto fail;
+    if ((res = create_pipeline(vk))    != ENGINE_SUCCESS) goto fail;
+    if ((res = create_output(vk))      != ENGINE_SUCCESS) goto fail;
+    if ((res = create_descriptors(vk)) != ENGINE_SUCCESS) goto fail;
+
+    sc->supported = true;
+    LOG_INFO("Compute skinning ready: %u vertices per frame (%llu KB)",
+             SKIN_COMPUTE_MAX_VERTICES, (unsigned long long)(sc->frame_size / 1024));
+    return ENGINE_SUCCESS;
+
+fail:
+    skin_compute_shutdown(vk);
+    return res;
+}
+
+void skin_compute_shutdown(VulkanContext *vk) {
+    SkinComputeContext *sc = &vk->skin_compute;
+
+    vk_destroy_buffer(vk, &sc->output, &sc->output_memory);
+    if (sc->desc_pool)
+        vkDestroyDescriptorPool(vk->device, sc->desc_pool, NULL);
+    if (sc->pipeline)
+        vkDestroyPipeline(vk->device, sc->pipeline, NULL);
+    if (sc->pipeline_layout)
+        vkDestroyPipelineLayout(vk->device, sc->pipeline_layout, NULL);
+    if (sc->desc_set_layout)
+        vkDestroyDescriptorSetLayout(vk->device, sc->desc_set_layout, NULL);
+
+    memset(sc, 0, sizeof(*sc));
+}
+
+/* --------------------------------------------------------------------------
+ * Per frame
+ * ------------------------------------------------------------------------ */
+
+void skin_compute_begin_frame(VulkanContext *vk) {
+    vk->skin_compute.vertex_count = 0;
+}
+
+u32 skin_compute_reserve(VulkanContext *vk, u32 vertex_count) {
+    SkinComputeContext *sc = &vk->skin_compute;
+    if (!sc->enabled || !sc->supported) return SKIN_COMPUTE_NONE;
+    if (vertex_count > SKIN_COMPUTE_MAX_VERTICES - sc->vertex_count) return SKIN_COMPUTE_NONE;
+
+    u32 first = sc->vertex_count;
+    sc->vertex_count += vertex_count;
+    return first;
+}
+
+VkDeviceSize skin_compute_frame_offset(const VulkanContext *vk) {
+    return vk->skin_compute.frame_size * vk->current_frame;
+}
+
+void skin_compute_record(const VulkanContext *vk, VkCommandBuffer cmd) {
+    const SkinComputeContext *sc = &vk->skin_compute;
+    if (sc->vertex_count == 0) return;
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, sc->pipeline);
+
+    u32 dynamic_offsets[] = {
+        (u32)skin_compute_frame_offset(vk),
+        (u32)vk->joint_ring.frame_offset,
+    };
+    VkDescriptorSet sets[] = { sc->desc_set, vk->joint_desc_set };
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, sc->pipeline_layout,
+                             0, 2, sets, 2, dynamic_offsets);
+
+    /* One dispatch per draw, one row of workgroups per instance */
+    for (u32 i = 0; i < vk->draw_list_skinned.count; i++) {
+        const SkinnedDrawCommand *dc = &vk->draw_list_skinned.items[i];
+        if (dc->skinned_vertex == SKIN_COMPUTE_NONE) continue;
+
+        const MeshSlot *mesh = &vk->meshes[dc->mesh];
+        SkinPush push = {
+            .src_first    = mesh->first_vertex,
+            .dst_first    = dc->skinned_vertex,
+            .vertex_count = mesh->vertex_count,
+            .joint_base   = dc->joint_ssbo_offset / JOINT_AFFINE_BYTES,
+            .joint_count  = dc->joint_count,
+        };
+        vkCmdPushConstants(cmd, sc->pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT,
+                           0, sizeof(push), &push);
+        vkCmdDispatch(cmd, (mesh->vertex_count + SKIN_LOCAL_SIZE - 1) / SKIN_LOCAL_SIZE,
+                      dc->instance_count, 1);
+    }
+}
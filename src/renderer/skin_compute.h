@@ -0,0 +1,31 @@
+#ifndef ENGINE_SKIN_COMPUTE_H
+#define ENGINE_SKIN_COMPUTE_H
+
+#include "renderer/vk_types.h"
+#include "core/common.h"
+
+/* ---- Lifecycle (called from renderer.c) ---- */
+
+/* Pipeline, descriptors and output buffer. Needs the skinned vertex buffer and
+ * the joint SSBO layout. If the graphics queue family has no compute support
+ * the pre-pass is left unsupported and this still succeeds. */
+EngineResult skin_compute_init(VulkanContext *vk);
+void         skin_compute_shutdown(VulkanContext *vk);
+
+/* ---- Per frame ---- */
+
+void skin_compute_begin_frame(VulkanContext *vk);
+
+/* Reserve output space for one skinned draw. Returns its first Vertex3D, or
+ * SKIN_COMPUTE_NONE when disabled or this frame's region is full. */
+u32  skin_compute_reserve(VulkanContext *vk, u32 vertex_count);
+
+/* Byte offset of the current frame's output region (vertex binding 0) */
+VkDeviceSize skin_compute_frame_offset(const VulkanContext *vk);
+
+/* Dispatch every reserved draw. Records outside any render pass, before the
+ * scene pass; the render graph (or, on the async compute queue, the graphics
+ * submit's wait) makes the output visible to vertex input. */
+void skin_compute_record(const VulkanContext *vk, VkCommandBuffer cmd);
+
+#endif /* ENGINE_SKIN_COMPUTE_H */
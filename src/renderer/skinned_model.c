@@ -2,8 +2,13 @@
 #include "renderer/vk_types.h"
 #include "renderer/vk_buffer.h"
 #include "renderer/animation_types.h"
+#include "renderer/anim_compress.h"
+#include "renderer/mesh_optimize.h"
+#include "renderer/asset_cache.h"
 #include "core/log.h"
+#include "core/profile.h"
 
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -322,6 +327,7 @@ static void skinned_model_destroy_clips(SkinnedModel *model) {
             free(clip->channels[ch].values);
         }
         free(clip->channels);
+        anim_compressed_destroy(clip->compressed);
     }
     free(model->clips);
     model->clips = NULL;
@@ -329,17 +335,45 @@ static void skinned_model_destroy_clips(SkinnedModel *model) {
 }
 
 /* --------------------------------------------------------------------------
- * renderer_load_skinned_model
+ * Baked cache hit: skeleton and clips are copied out, geometry is uploaded
+ * straight from the mapping
  * ------------------------------------------------------------------------ */
 
-EngineResult renderer_load_skinned_model(VulkanContext *vk, const char *path,
-                                          SkinnedModel *out_model) {
-    if (!vk || !path || !out_model) {
-        LOG_ERROR("renderer_load_skinned_model: NULL argument");
-        return ENGINE_ERROR_GENERIC;
+static EngineResult decode_from_cache(const char *path, u64 source_hash,
+                                      SkinnedModelData *out_data) {
+    EngineResult res = asset_cache_open(path, source_hash, ASSET_CACHE_SKINNED,
+                                        sizeof(SkinnedVertex3D), &out_data->cached);
+    if (res != ENGINE_SUCCESS) return res;
+
+    res = asset_cache_read_animation(&out_data->cached, &out_data->model.skeleton,
+                                     &out_data->model.clips, &out_data->model.clip_count);
+    if (res != ENGINE_SUCCESS) {
+        asset_cache_close(&out_data->cached);
+        memset(out_data, 0, sizeof(*out_data));
+        return res;
     }
 
-    memset(out_model, 0, sizeof(*out_model));
+    out_data->from_cache   = true;
+    out_data->vertices     = out_data->cached.vertices;
+    out_data->vertex_count = out_data->cached.vertex_count;
+    out_data->indices      = out_data->cached.indices;
+    out_data->index_count  = out_data->cached.index_count;
+    return ENGINE_SUCCESS;
+}
+
+/* --------------------------------------------------------------------------
+ * skinned_model_decode
+ * ------------------------------------------------------------------------ */
+
+static EngineResult decode_skinned_model(const char *path, SkinnedModelData *out_data) {
+    memset(out_data, 0, sizeof(*out_data));
+
+    /* ---- Baked cache ---- */
+    u64  source_hash = 0;
+    bool have_hash   = asset_cache_hash_file(path, &source_hash) == ENGINE_SUCCESS;
+    if (have_hash && decode_from_cache(path, source_hash, out_data) == ENGINE_SUCCESS) {
+        return ENGINE_SUCCESS;
+    }
 
     /* ---- Parse glTF ---- */
     cgltf_options options = {0};
@@ -358,6 +392,15 @@ EngineResult renderer_load_skinned_model(VulkanContext *vk, const char *path,
         return ENGINE_ERROR_FILE_NOT_FOUND;
     }
 
+    /* Index values and accessor sizes come from the file and are used to
+     * index the vertex arrays, so a malformed file is rejected here */
+    result = cgltf_validate(data);
+    if (result != cgltf_result_success) {
+        LOG_ERROR("Invalid glTF file: %s (error %d)", path, (int)result);
+        cgltf_free(data);
+        return ENGINE_ERROR_GENERIC;
+    }
+
     /* ---- Require at least one skin ---- */
     if (data->skins_count == 0) {
         LOG_ERROR("No skins found in glTF: %s", path);
@@ -368,10 +411,10 @@ EngineResult renderer_load_skinned_model(VulkanContext *vk, const char *path,
     cgltf_skin *skin = &data->skins[0];
 
     /* ---- Extract skeleton ---- */
-    extract_skeleton(skin, &out_model->skeleton);
+    extract_skeleton(skin, &out_data->model.skeleton);
 
     /* ---- Extract animations ---- */
-    extract_animations(data, skin, &out_model->clips, &out_model->clip_count);
+    extract_animations(data, skin, &out_data->model.clips, &out_data->model.clip_count);
 
     /* ---- Count vertices and indices (first pass) ---- */
     u32 total_verts = 0;
@@ -399,6 +442,7 @@ EngineResult renderer_load_skinned_model(VulkanContext *vk, const char *path,
 
     if (total_verts == 0) {
         LOG_ERROR("No valid geometry found in skinned glTF: %s", path);
+        skinned_model_destroy_clips(&out_data->model);
         cgltf_free(data);
         return ENGINE_ERROR_GENERIC;
     }
@@ -410,6 +454,7 @@ EngineResult renderer_load_skinned_model(VulkanContext *vk, const char *path,
     if (!vertices || !indices) {
         free(vertices);
         free(indices);
+        skinned_model_destroy_clips(&out_data->model);
         cgltf_free(data);
         LOG_ERROR("Out of memory loading skinned model: %s", path);
         return ENGINE_ERROR_OUT_OF_MEMORY;
@@ -535,25 +580,89 @@ EngineResult renderer_load_skinned_model(VulkanContext *vk, const char *path,
         }
     }
 
-    /* ---- Upload to GPU ---- */
-    MeshHandle mesh_handle;
-    EngineResult res = vk_upload_mesh_skinned(vk, vertices, vert_cursor,
-                                               indices, idx_cursor, &mesh_handle);
+    /* ---- Reorder for vertex cache, overdraw and fetch ---- */
+    MeshOptimizeStats opt;
+    mesh_optimize(vertices, sizeof(SkinnedVertex3D), offsetof(SkinnedVertex3D, position),
+                  &vert_cursor, indices, idx_cursor, &opt);
+    LOG_INFO("Skinned model optimized: %s (%u -> %u vertices, ACMR %.3f -> %.3f, %u clusters)",
+             path, opt.vertex_count_before, opt.vertex_count_after,
+             opt.acmr_before, opt.acmr_after, opt.cluster_count);
+
+    if (have_hash) {
+        asset_cache_write(path, source_hash, ASSET_CACHE_SKINNED, sizeof(SkinnedVertex3D),
+                          vertices, vert_cursor, indices, idx_cursor,
+                          &out_data->model.skeleton,
+                          out_data->model.clips, out_data->model.clip_count);
+    }
 
-    free(vertices);
-    free(indices);
     cgltf_free(data);
 
+    out_data->owned_vertices = vertices;
+    out_data->owned_indices  = indices;
+    out_data->vertices       = vertices;
+    out_data->vertex_count   = vert_cursor;
+    out_data->indices        = indices;
+    out_data->index_count    = idx_cursor;
+    return ENGINE_SUCCESS;
+}
+
+EngineResult skinned_model_decode(const char *path, SkinnedModelData *out_data) {
+    PROFILE_ZONE_BEGIN("skinned_model_decode");
+    EngineResult res = decode_skinned_model(path, out_data);
+    PROFILE_ZONE_END();
+    return res;
+}
+
+EngineResult skinned_model_upload(VulkanContext *vk, SkinnedModelData *data,
+                                  SkinnedModel *out_model) {
+    MeshHandle mesh_handle;
+    EngineResult res = vk_upload_mesh_skinned(vk, data->vertices, data->vertex_count,
+                                              data->indices, data->index_count, &mesh_handle);
     if (res != ENGINE_SUCCESS) {
-        skinned_model_destroy_clips(out_model);
+        skinned_model_destroy_clips(&data->model);
         return res;
     }
 
+    *out_model = data->model;
     out_model->mesh_handle = mesh_handle;
+    memset(&data->model, 0, sizeof(data->model));
+    return ENGINE_SUCCESS;
+}
 
-    LOG_INFO("Skinned model loaded: %s (%u verts, %u indices, %u joints, %u clips)",
-             path, vert_cursor, idx_cursor,
-             out_model->skeleton.joint_count, out_model->clip_count);
+void skinned_model_data_free(SkinnedModelData *data) {
+    skinned_model_destroy_clips(&data->model);
+    if (data->from_cache) asset_cache_close(&data->cached);
+    free(data->owned_vertices);
+    free(data->owned_indices);
+    memset(data, 0, sizeof(*data));
+}
 
-    return ENGINE_SUCCESS;
+/* --------------------------------------------------------------------------
+ * renderer_load_skinned_model
+ * ------------------------------------------------------------------------ */
+
+EngineResult renderer_load_skinned_model(VulkanContext *vk, const char *path,
+                                          SkinnedModel *out_model) {
+    if (!vk || !path || !out_model) {
+        LOG_ERROR("renderer_load_skinned_model: NULL argument");
+        return ENGINE_ERROR_GENERIC;
+    }
+
+    memset(out_model, 0, sizeof(*out_model));
+
+    PROFILE_ZONE_BEGIN("renderer_load_skinned_model");
+    SkinnedModelData data;
+    EngineResult res = skinned_model_decode(path, &data);
+    if (res == ENGINE_SUCCESS) {
+        res = skinned_model_upload(vk, &data, out_model);
+        if (res == ENGINE_SUCCESS) {
+            LOG_INFO("Skinned model loaded%s: %s (%u verts, %u indices, %u joints, %u clips)",
+                     data.from_cache ? " from cache" : "", path,
+                     data.vertex_count, data.index_count,
+                     out_model->skeleton.joint_count, out_model->clip_count);
+        }
+        skinned_model_data_free(&data);
+    }
+    PROFILE_ZONE_END();
+    return res;
 }
@@ -4,6 +4,7 @@
 #include "core/common.h"
 #include "renderer/renderer_types.h"
 #include "renderer/animation_types.h"
+#include "renderer/asset_cache.h"
 
 /* Forward decl — skinned_model.c works directly with VulkanContext */
 typedef struct VulkanContext VulkanContext;
@@ -18,4 +19,33 @@ typedef struct VulkanContext VulkanContext;
 EngineResult renderer_load_skinned_model(VulkanContext *vk, const char *path,
                                          SkinnedModel *out_model);
 
+/* ---- Internal: the CPU half of a load, used by the async loader ---- */
+
+/* Skeleton, clips and optimized geometry ready for upload. model.mesh_handle
+ * is unset until skinned_model_upload. Geometry is owned after a glTF parse,
+ * or points into the baked cache mapping on a cache hit. */
+typedef struct {
+    SkinnedModel           model;
+    const SkinnedVertex3D *vertices;
+    u32                    vertex_count;
+    const u32             *indices;
+    u32                    index_count;
+    SkinnedVertex3D       *owned_vertices;  /* NULL on a cache hit */
+    u32                   *owned_indices;
+    AssetCacheView         cached;
+    bool                   from_cache;
+} SkinnedModelData;
+
+/* Read and parse a skinned model (writing the baked cache on a miss).
+ * Touches no renderer state, so it runs on any thread. */
+EngineResult skinned_model_decode(const char *path, SkinnedModelData *out_data);
+
+/* Upload the geometry and move skeleton and clips into out_model. The data
+ * no longer owns the clips afterwards, whatever the result. */
+EngineResult skinned_model_upload(VulkanContext *vk, SkinnedModelData *data,
+                                  SkinnedModel *out_model);
+
+/* Free what the data still owns (geometry, and clips if never uploaded) */
+void         skinned_model_data_free(SkinnedModelData *data);
+
 #endif /* ENGINE_SKINNED_MODEL_H */
@@ -0,0 +1,309 @@
+#include "renderer/sprite_batch.h"
+#include "renderer/atlas_pack.h"
+#include "renderer/vk_buffer.h"
+#include "renderer/resource_table.h"
+#include "core/log.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* --------------------------------------------------------------------------
+ * Lifecycle
+ * ------------------------------------------------------------------------ */
+
+EngineResult sprite_batch_init(VulkanContext *vk) {
+    SpriteContext *sc = &vk->sprites;
+    memset(sc, 0, sizeof(*sc));
+
+    /* Same winding and UV orientation as a full-texture quad */
+    static const Vertex quad[] = {
+        { .position = { -0.5f, -0.5f }, .uv = { 0.0f, 0.0f }, .color = { 1.0f, 1.0f, 1.0f } },
+        { .position = {  0.5f, -0.5f }, .uv = { 1.0f, 0.0f }, .color = { 1.0f, 1.0f, 1.0f } },
+        { .position = {  0.5f,  0.5f }, .uv = { 1.0f, 1.0f }, .color = { 1.0f, 1.0f, 1.0f } },
+        { .position = { -0.5f, -0.5f }, .uv = { 0.0f, 0.0f }, .color = { 1.0f, 1.0f, 1.0f } },
+        { .position = {  0.5f,  0.5f }, .uv = { 1.0f, 1.0f }, .color = { 1.0f, 1.0f, 1.0f } },
+        { .position = { -0.5f,  0.5f }, .uv = { 0.0f, 1.0f }, .color = { 1.0f, 1.0f, 1.0f } },
+    };
+    return vk_upload_mesh(vk, quad, ENGINE_ARRAY_LEN(quad), &sc->quad_mesh);
+}
+
+void sprite_batch_shutdown(VulkanContext *vk) {
+    SpriteContext *sc = &vk->sprites;
+    for (u32 i = 0; i < sc->sprite_count; i++) {
+        free(sc->sprites[i].pixels);
+    }
+    for (u32 p = 0; p < sc->page_count; p++) {
+        free(sc->pages[p].instances);
+    }
+    memset(sc, 0, sizeof(*sc));
+}
+
+/* --------------------------------------------------------------------------
+ * Sprites
+ * ------------------------------------------------------------------------ */
+
+EngineResult sprite_batch_add(VulkanContext *vk, const u8 *rgba, u32 width, u32 height,
+                              TextureFilter filter, SpriteHandle *out_handle) {
+    SpriteContext *sc = &vk->sprites;
+
+    if (sc->sprite_count >= SPRITE_MAX) {
+        LOG_ERROR("Sprite table full (%u)", SPRITE_MAX);
+        return ENGINE_ERROR_GENERIC;
+    }
+    if (width == 0 || height == 0 ||
+        width  + 2 * SPRITE_PADDING > SPRITE_PAGE_SIZE ||
+        height + 2 * SPRITE_PADDING > SPRITE_PAGE_SIZE) {
+        LOG_ERROR("Sprite size %ux%u does not fit an atlas page (%u)",
+                  width, height, SPRITE_PAGE_SIZE);
+        return ENGINE_ERROR_GENERIC;
+    }
+
+    size_t size = (size_t)width * height * 4;
+    u8 *copy = malloc(size);
+    if (!copy) return ENGINE_ERROR_OUT_OF_MEMORY;
+    memcpy(copy, rgba, size);
+
+    SpriteHandle handle = sc->sprite_count++;
+    sc->sprites[handle] = (SpriteSlot){
+        .page   = SPRITE_PAGE_PENDING,
+        .filter = (u16)filter,
+        .width  = width,
+        .height = height,
+        .pixels = copy,
+    };
+    sc->pending_count++;
+
+    *out_handle = handle;
+    return ENGINE_SUCCESS;
+}
+
+/* ---- Build ---- */
+
+typedef struct {
+    u32 sprite;
+    u32 width;      /* padded */
+    u32 height;
+    u32 x, y;       /* padded rect's corner within its page */
+    u32 page;       /* index into this build's pages, UINT32_MAX = unplaced */
+} PackItem;
+
+typedef struct {
+    AtlasPacker   packer;
+    TextureFilter filter;
+    u32           right;    /* used extent */
+    u32           bottom;
+} BuildPage;
+
+/* Tallest first, then widest; sprite index keeps the order deterministic */
+static int compare_pack_items(const void *a, const void *b) {
+    const PackItem *pa = a, *pb = b;
+    if (pa->height != pb->height) return pa->height > pb->height ? -1 : 1;
+    if (pa->width  != pb->width)  return pa->width  > pb->width  ? -1 : 1;
+    return pa->sprite < pb->sprite ? -1 : 1;
+}
+
+/* Copy a sprite into the page at (x, y) (padded corner) and extrude its edge
+ * texels into the padding, so filtering at the rect border never picks up a
+ * neighbour */
+static void blit_sprite(u8 *page, u32 page_width, const SpriteSlot *s, u32 x, u32 y) {
+    const u32 P = SPRITE_PADDING;
+    for (u32 row = 0; row < s->height + 2 * P; row++) {
+        u32 src_row = (row < P) ? 0 : (row - P >= s->height ? s->height - 1 : row - P);
+        const u8 *src = s->pixels + (size_t)src_row * s->width * 4;
+        u8 *dst = page + ((size_t)(y + row) * page_width + x) * 4;
+
+        for (u32 k = 0; k < P; k++) memcpy(dst + k * 4, src, 4);
+        memcpy(dst + P * 4, src, (size_t)s->width * 4);
+        for (u32 k = 0; k < P; k++) {
+            memcpy(dst + (P + s->width + k) * 4, src + (size_t)(s->width - 1) * 4, 4);
+        }
+    }
+}
+
+static EngineResult upload_page(VulkanContext *vk, const BuildPage *bp,
+                                PackItem *items, u32 item_count, u32 build_index) {
+    SpriteContext *sc = &vk->sprites;
+
+    u8 *pixels = calloc((size_t)bp->right * bp->bottom, 4);
+    if (!pixels) return ENGINE_ERROR_OUT_OF_MEMORY;
+
+    for (u32 i = 0; i < item_count; i++) {
+        if (items[i].page != build_index) continue;
+        blit_sprite(pixels, bp->right, &sc->sprites[items[i].sprite], items[i].x, items[i].y);
+    }
+
+    TextureHandle texture;
+    EngineResult res = texture_reserve(vk, &texture);
+    if (res != ENGINE_SUCCESS) {
+        LOG_ERROR("Texture table full, cannot upload sprite atlas page");
+        free(pixels);
+        return res;
+    }
+    VkFilter filter = (bp->filter == TEXTURE_FILTER_PIXELART) ? VK_FILTER_NEAREST : VK_FILTER_LINEAR;
+
+    /* No mips: lower levels would blend neighbouring sprites */
+    res = vk_create_texture(vk, pixels, bp->right, bp->bottom,
+                            VK_FORMAT_R8G8B8A8_SRGB, filter, false,
+                            &vk->textures[HANDLE_SLOT(texture)]);
+    free(pixels);
+    if (res != ENGINE_SUCCESS) {
+        texture_cancel(vk, texture);
+        return res;
+    }
+
+    u32 page_index = sc->page_count++;
+    sc->pages[page_index] = (SpritePage){ .texture = texture };
+
+    f32 inv_w = 1.0f / (f32)bp->right;
+    f32 inv_h = 1.0f / (f32)bp->bottom;
+    for (u32 i = 0; i < item_count; i++) {
+        if (items[i].page != build_index) continue;
+        SpriteSlot *s = &sc->sprites[items[i].sprite];
+        s->page         = (u16)page_index;
+        s->uv_offset[0] = (f32)(items[i].x + SPRITE_PADDING) * inv_w;
+        s->uv_offset[1] = (f32)(items[i].y + SPRITE_PADDING) * inv_h;
+        s->uv_scale[0]  = (f32)s->width  * inv_w;
+        s->uv_scale[1]  = (f32)s->height * inv_h;
+        free(s->pixels);
+        s->pixels = NULL;
+        sc->pending_count--;
+    }
+
+    LOG_INFO("Sprite atlas page %u: %ux%u, %.0f%% occupied", page_index,
+             bp->right, bp->bottom, atlas_pack_occupancy(&bp->packer) * 100.0f);
+    return ENGINE_SUCCESS;
+}
+
+EngineResult sprite_batch_build(VulkanContext *vk) {
+    SpriteContext *sc = &vk->sprites;
+    if (sc->pending_count == 0) return ENGINE_SUCCESS;
+
+    u32 max_pages = SPRITE_MAX_PAGES - sc->page_count;
+    if (max_pages == 0) {
+        LOG_ERROR("Sprite atlas page limit reached (%u)", SPRITE_MAX_PAGES);
+        return ENGINE_ERROR_GENERIC;
+    }
+
+    PackItem  *items = malloc(sizeof(PackItem) * sc->pending_count);
+    BuildPage *pages = malloc(sizeof(BuildPage) * max_pages);
+    if (!items || !pages) {
+        free(items);
+        free(pages);
+        return ENGINE_ERROR_OUT_OF_MEMORY;
+    }
+
+    u32 item_count = 0;
+    for (u32 i = 0; i < sc->sprite_count; i++) {
+        const SpriteSlot *s = &sc->sprites[i];
+        if (s->page != SPRITE_PAGE_PENDING) continue;
+        items[item_count++] = (PackItem){
+            .sprite = i,
+            .width  = s->width  + 2 * SPRITE_PADDING,
+            .height = s->height + 2 * SPRITE_PADDING,
+            .page   = UINT32_MAX,
+        };
+    }
+    qsort(items, item_count, sizeof(PackItem), compare_pack_items);
+
+    /* Place each sprite on the first open page of its filter, opening a new
+     * page when none has room */
+    u32 page_count = 0;
+    u32 unplaced = 0;
+    for (u32 i = 0; i < item_count; i++) {
+        PackItem *it = &items[i];
+        TextureFilter filter = (TextureFilter)sc->sprites[it->sprite].filter;
+
+        for (u32 p = 0; p <= page_count && it->page == UINT32_MAX; p++) {
+            if (p == page_count) {
+                if (page_count == max_pages) break;
+                atlas_pack_init(&pages[p].packer, SPRITE_PAGE_SIZE, SPRITE_PAGE_SIZE);
+                pages[p].filter = filter;
+                pages[p].right  = 0;
+                pages[p].bottom = 0;
+                page_count++;
+            }
+            if (pages[p].filter != filter) continue;
+            if (!atlas_pack_insert(&pages[p].packer, it->width, it->height, &it->x, &it->y))
+                continue;
+
+            it->page = p;
+            pages[p].right  = ENGINE_MAX(pages[p].right,  it->x + it->width);
+            pages[p].bottom = ENGINE_MAX(pages[p].bottom, it->y + it->height);
+        }
+        if (it->page == UINT32_MAX) unplaced++;
+    }
+
+    EngineResult res = ENGINE_SUCCESS;
+    for (u32 p = 0; p < page_count; p++) {
+        res = upload_page(vk, &pages[p], items, item_count, p);
+        if (res != ENGINE_SUCCESS) break;
+    }
+
+    free(items);
+    free(pages);
+
+    if (res == ENGINE_SUCCESS && unplaced > 0) {
+        LOG_ERROR("Sprite atlas page limit reached, %u sprites left unpacked", unplaced);
+        res = ENGINE_ERROR_GENERIC;
+    }
+    return res;
+}
+
+/* --------------------------------------------------------------------------
+ * Batching
+ * ------------------------------------------------------------------------ */
+
+static bool page_reserve(SpritePage *page, u32 needed) {
+    if (needed <= page->instance_capacity) return true;
+
+    u32 capacity = page->instance_capacity ? page->instance_capacity * 2 : 256;
+    while (capacity < needed) capacity *= 2;
+
+    InstanceData *grown = realloc(page->instances, sizeof(InstanceData) * capacity);
+    if (!grown) return false;
+    page->instances = grown;
+    page->instance_capacity = capacity;
+    return true;
+}
+
+void sprite_batch_draw(VulkanContext *vk, SpriteHandle sprite,
+                       const InstanceData *instances, u32 instance_count) {
+    SpriteContext *sc = &vk->sprites;
+
+    if (instance_count == 0) return;
+    if (sprite >= sc->sprite_count) {
+        LOG_WARN("Invalid sprite handle %u (have %u sprites)", sprite, sc->sprite_count);
+        return;
+    }
+
+    const SpriteSlot *s = &sc->sprites[sprite];
+    if (s->page == SPRITE_PAGE_PENDING) {
+        sprite_batch_build(vk);
+        if (s->page == SPRITE_PAGE_PENDING) return;
+    }
+
+    SpritePage *page = &sc->pages[s->page];
+    if (!page_reserve(page, page->instance_count + instance_count)) {
+        LOG_WARN("Sprite batch allocation failed, dropping %u instances", instance_count);
+        return;
+    }
+
+    InstanceData *dst = &page->instances[page->instance_count];
+    for (u32 i = 0; i < instance_count; i++) {
+        const InstanceData *src = &instances[i];
+        dst[i] = *src;
+        if (src->uv_scale[0] > 0.0f || src->uv_scale[1] > 0.0f) {
+            /* Tile within the sprite */
+            dst[i].uv_offset[0] = s->uv_offset[0] + src->uv_offset[0] * s->uv_scale[0];
+            dst[i].uv_offset[1] = s->uv_offset[1] + src->uv_offset[1] * s->uv_scale[1];
+            dst[i].uv_scale[0]  = src->uv_scale[0] * s->uv_scale[0];
+            dst[i].uv_scale[1]  = src->uv_scale[1] * s->uv_scale[1];
+        } else {
+            dst[i].uv_offset[0] = s->uv_offset[0];
+            dst[i].uv_offset[1] = s->uv_offset[1];
+            dst[i].uv_scale[0]  = s->uv_scale[0];
+            dst[i].uv_scale[1]  = s->uv_scale[1];
+        }
+    }
+    page->instance_count += instance_count;
+}
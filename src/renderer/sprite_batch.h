@@ -0,0 +1,35 @@
+#ifndef ENGINE_SPRITE_BATCH_H
+#define ENGINE_SPRITE_BATCH_H
+
+#include "renderer/vk_types.h"
+#include "core/common.h"
+
+/* ---- Lifecycle (called from renderer.c) ---- */
+
+/* Uploads the shared unit quad. Needs the 2D vertex buffer. */
+EngineResult sprite_batch_init(VulkanContext *vk);
+
+/* Frees pending pixels and batch arrays. Page textures live in the texture
+ * table and are destroyed with it. */
+void         sprite_batch_shutdown(VulkanContext *vk);
+
+/* ---- Sprites ---- */
+
+/* Register an RGBA8 image as a sprite. The pixels are copied and packed by
+ * the next sprite_batch_build. */
+EngineResult sprite_batch_add(VulkanContext *vk, const u8 *rgba, u32 width, u32 height,
+                              TextureFilter filter, SpriteHandle *out_handle);
+
+/* Pack every pending sprite into new atlas pages and upload them. Sprites
+ * that could not be placed (page or texture table full) stay pending. */
+EngineResult sprite_batch_build(VulkanContext *vk);
+
+/* ---- Batching ---- */
+
+/* Append instances to the sprite's page batch, remapping their UVs into the
+ * sprite's sub-rect (an instance uv_offset/uv_scale then selects a tile
+ * within the sprite). Builds pending sprites first if needed. */
+void         sprite_batch_draw(VulkanContext *vk, SpriteHandle sprite,
+                               const InstanceData *instances, u32 instance_count);
+
+#endif /* ENGINE_SPRITE_BATCH_H */
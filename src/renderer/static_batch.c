@@ -0,0 +1,250 @@
+#include "renderer/static_batch.h"
+#include "renderer/shadow.h"
+#include "renderer/resource_table.h"
+#include "renderer/vk_buffer.h"
+#include "renderer/vk_upload.h"
+#include "core/log.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STATIC_BATCH_CONVERT_CHUNK 4096  /* instances converted per staging copy */
+
+static StaticBatch *get_batch(VulkanContext *vk, StaticBatchHandle handle) {
+    if (handle >= STATIC_BATCH_MAX) return NULL;
+    StaticBatch *sb = &vk->static_batches.batches[handle];
+    return sb->in_use ? sb : NULL;
+}
+
+static void release_batch(VulkanContext *vk, StaticBatch *sb) {
+    vk_destroy_buffer(vk, &sb->instances, &sb->instances_memory);
+    memset(sb, 0, sizeof(*sb));
+}
+
+/* Grow the batch AABB by each instance's world-space bounding sphere (same
+ * scale -> rotate -> translate as mesh3d.vert and the 3D frustum test) */
+static void grow_bounds(const MeshSlot *slot, const InstanceData3D *instances, u32 count,
+                        StaticBatch *sb) {
+    const f32 *bc = slot->bounds_center;
+    for (u32 i = 0; i < count; i++) {
+        const InstanceData3D *inst = &instances[i];
+        const f32 *s = inst->scale;
+        f32 radius = slot->bounds_radius *
+                     fmaxf(fabsf(s[0]), fmaxf(fabsf(s[1]), fabsf(s[2])));
+
+        f32 c[3] = { inst->position[0], inst->position[1], inst->position[2] };
+        if (bc[0] != 0.0f || bc[1] != 0.0f || bc[2] != 0.0f) {
+            f32 x = bc[0] * s[0], y = bc[1] * s[1], z = bc[2] * s[2];
+            f32 cp = cosf(inst->rotation[0]), sp = sinf(inst->rotation[0]);
+            f32 cy = cosf(inst->rotation[1]), sy = sinf(inst->rotation[1]);
+            f32 cr = cosf(inst->rotation[2]), sr = sinf(inst->rotation[2]);
+            c[0] += (cy*cr + sy*sp*sr) * x + (-cy*sr + sy*sp*cr) * y + (sy*cp) * z;
+            c[1] += (cp*sr) * x         + (cp*cr) * y            + (-sp) * z;
+            c[2] += (-sy*cr + cy*sp*sr) * x + (sy*sr + cy*sp*cr) * y + (cy*cp) * z;
+        }
+
+        for (u32 k = 0; k < 3; k++) {
+            sb->bounds_min[k] = fminf(sb->bounds_min[k], c[k] - radius);
+            sb->bounds_max[k] = fmaxf(sb->bounds_max[k], c[k] + radius);
+        }
+    }
+}
+
+static bool sphere_visible(const f32 planes[6][4], const f32 c[3], f32 radius) {
+    for (u32 i = 0; i < 6; i++) {
+        const f32 *p = planes[i];
+        if (p[0] * c[0] + p[1] * c[1] + p[2] * c[2] + p[3] < -radius) return false;
+    }
+    return true;
+}
+
+/* Convert in chunks and hand each one to the upload manager, so a large
+ * batch never needs a second full-size copy on the heap */
+static EngineResult upload_instances(VulkanContext *vk, StaticBatch *sb, u32 first,
+                                     const InstanceData3D *instances, u32 count) {
+    size_t stride = vk_instance_3d_stride(vk);
+    u32 chunk = ENGINE_MIN(count, (u32)STATIC_BATCH_CONVERT_CHUNK);
+    u8 *scratch = malloc(stride * chunk);
+    if (!scratch) return ENGINE_ERROR_OUT_OF_MEMORY;
+
+    EngineResult res = ENGINE_SUCCESS;
+    for (u32 done = 0; done < count && res == ENGINE_SUCCESS; done += chunk) {
+        u32 n = ENGINE_MIN(count - done, chunk);
+        vk_write_instances_3d(vk, scratch, instances + done, n);
+        res = vk_upload_buffer(vk, sb->instances, (VkDeviceSize)(first + done) * stride,
+                               scratch, (VkDeviceSize)n * stride);
+    }
+    free(scratch);
+    return res;
+}
+
+/* --------------------------------------------------------------------------
+ * Lifecycle
+ * ------------------------------------------------------------------------ */
+
+void static_batch_shutdown(VulkanContext *vk) {
+    StaticBatchContext *sc = &vk->static_batches;
+    for (u32 i = 0; i < STATIC_BATCH_MAX; i++) {
+        if (sc->batches[i].in_use) release_batch(vk, &sc->batches[i]);
+    }
+    memset(sc, 0, sizeof(*sc));
+}
+
+/* --------------------------------------------------------------------------
+ * Batches
+ * ------------------------------------------------------------------------ */
+
+EngineResult static_batch_create(VulkanContext *vk, MeshHandle mesh, TextureHandle texture,
+                                 const InstanceData3D *instances, u32 count,
+                                 StaticBatchHandle *out_handle) {
+    StaticBatchContext *sc = &vk->static_batches;
+    *out_handle = STATIC_BATCH_HANDLE_INVALID;
+
+    if (count == 0 || !instances) {
+        LOG_ERROR("Static batch needs at least one instance");
+        return ENGINE_ERROR_GENERIC;
+    }
+    u32 mesh_slot = mesh_lookup(vk, mesh);
+    if (mesh_slot == HANDLE_SLOT_NONE || !vk->meshes[mesh_slot].is_3d ||
+        vk->meshes[mesh_slot].is_skinned) {
+        LOG_ERROR("Static batch needs a 3D mesh (got handle %u)", mesh);
+        return ENGINE_ERROR_GENERIC;
+    }
+    if (texture != TEXTURE_HANDLE_INVALID && texture_lookup(vk, texture) == HANDLE_SLOT_NONE) {
+        LOG_ERROR("Invalid texture handle %u", texture);
+        return ENGINE_ERROR_GENERIC;
+    }
+
+    u32 slot = 0;
+    while (slot < STATIC_BATCH_MAX && sc->batches[slot].in_use) slot++;
+    if (slot == STATIC_BATCH_MAX) {
+        LOG_ERROR("Static batch limit reached (%d)", STATIC_BATCH_MAX);
+        return ENGINE_ERROR_OUT_OF_MEMORY;
+    }
+
+    StaticBatch *sb = &sc->batches[slot];
+    memset(sb, 0, sizeof(*sb));
+    sb->mesh       = mesh_slot;
+    sb->texture    = texture;
+    sb->count      = count;
+    sb->last_frame = STATIC_BATCH_NEVER;
+    sb->prev_frame = STATIC_BATCH_NEVER;
+    for (u32 k = 0; k < 3; k++) {
+        sb->bounds_min[k] =  INFINITY;
+        sb->bounds_max[k] = -INFINITY;
+    }
+
+    VkDeviceSize size = (VkDeviceSize)vk_instance_3d_stride(vk) * count;
+    EngineResult res = vk_create_buffer(vk, size,
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &sb->instances, &sb->instances_memory);
+    if (res != ENGINE_SUCCESS) goto fail;
+
+    if ((res = upload_instances(vk, sb, 0, instances, count)) != ENGINE_SUCCESS) goto fail;
+    grow_bounds(&vk->meshes[mesh_slot], instances, count, sb);
+
+    sb->in_use  = true;
+    *out_handle = slot;
+    LOG_INFO("Static batch %u: %u instances of mesh %u (%llu KB)", slot, count, mesh,
+             (unsigned long long)(size / 1024));
+    return ENGINE_SUCCESS;
+
+fail:
+    release_batch(vk, sb);
+    return res;
+}
+
+EngineResult static_batch_update(VulkanContext *vk, StaticBatchHandle handle, u32 first,
+                                 const InstanceData3D *instances, u32 count) {
+    StaticBatch *sb = get_batch(vk, handle);
+    if (!sb) return ENGINE_ERROR_GENERIC;
+    if (count == 0) return ENGINE_SUCCESS;
+    if (!instances || first > sb->count || count > sb->count - first) {
+        LOG_ERROR("Static batch %u update [%u, %u) out of range (%u instances)",
+                  handle, first, first + count, sb->count);
+        return ENGINE_ERROR_GENERIC;
+    }
+
+    /* The copy may run on another queue, so no submitted frame may still be
+     * reading the batch. A frame's fence stays valid until its slot comes
+     * round again, by which point the frame itself has completed. */
+    u64 drawn = (sb->last_frame != STATIC_BATCH_NEVER && sb->last_frame < vk->frame_number)
+                ? sb->last_frame : sb->prev_frame;
+    if (drawn != STATIC_BATCH_NEVER && drawn + vk->frames_in_flight > vk->frame_number) {
+        vkWaitForFences(vk->device, 1, &vk->in_flight[drawn % vk->frames_in_flight],
+                        VK_TRUE, UINT64_MAX);
+    }
+
+    EngineResult res = upload_instances(vk, sb, first, instances, count);
+    if (res != ENGINE_SUCCESS) return res;
+    grow_bounds(&vk->meshes[sb->mesh], instances, count, sb);
+    return ENGINE_SUCCESS;
+}
+
+void static_batch_destroy(VulkanContext *vk, StaticBatchHandle handle) {
+    StaticBatch *sb = get_batch(vk, handle);
+    if (!sb) return;
+
+    /* In-flight frames may still draw it */
+    vkDeviceWaitIdle(vk->device);
+    release_batch(vk, sb);
+
+    /* Drop a draw of it queued this frame */
+    StaticBatchContext *sc = &vk->static_batches;
+    u32 kept = 0;
+    for (u32 i = 0; i < sc->draw_count; i++) {
+        if (sc->draws[i] != handle) sc->draws[kept++] = sc->draws[i];
+    }
+    sc->draw_count = kept;
+}
+
+/* --------------------------------------------------------------------------
+ * Per frame
+ * ------------------------------------------------------------------------ */
+
+void static_batch_begin_frame(VulkanContext *vk) {
+    StaticBatchContext *sc = &vk->static_batches;
+    for (u32 i = 0; i < sc->draw_count; i++) {
+        sc->batches[sc->draws[i]].views = 0;
+    }
+    sc->draw_count = 0;
+}
+
+void static_batch_draw(VulkanContext *vk, StaticBatchHandle handle) {
+    StaticBatch *sb = get_batch(vk, handle);
+    if (!sb) return;
+
+    /* Whole-batch cull: bounding sphere of the AABB against the camera and
+     * each shadow cascade */
+    u32 views = STATIC_BATCH_VIEW_CAMERA;
+    if (vk->frustum_valid) {
+        f32 c[3], e[3];
+        for (u32 k = 0; k < 3; k++) {
+            c[k] = (sb->bounds_min[k] + sb->bounds_max[k]) * 0.5f;
+            e[k] = (sb->bounds_max[k] - sb->bounds_min[k]) * 0.5f;
+        }
+        f32 radius = sqrtf(e[0] * e[0] + e[1] * e[1] + e[2] * e[2]);
+        if (!sphere_visible(vk->frustum_planes, c, radius)) views = 0;
+        if (shadow_active(vk)) {
+            for (u32 i = 0; i < SHADOW_CASCADES; i++) {
+                if (sphere_visible(vk->shadow.planes[i], c, radius))
+                    views |= STATIC_BATCH_VIEW_CASCADE(i);
+            }
+        }
+    }
+    if (views == 0) return;
+
+    if (sb->last_frame != vk->frame_number) {
+        sb->prev_frame = sb->last_frame;
+        sb->last_frame = vk->frame_number;
+    }
+
+    /* Drawn at most once per view; a second call can only add views */
+    bool queued = sb->views != 0;
+    sb->views |= (u8)views;
+    if (queued) return;
+
+    StaticBatchContext *sc = &vk->static_batches;
+    sc->draws[sc->draw_count++] = handle;
+}
@@ -0,0 +1,40 @@
+#ifndef ENGINE_STATIC_BATCH_H
+#define ENGINE_STATIC_BATCH_H
+
+#include "renderer/vk_types.h"
+#include "core/common.h"
+
+/* ---- Lifecycle (called from renderer.c) ---- */
+
+/* Destroys every batch still alive. The device must be idle. */
+void static_batch_shutdown(VulkanContext *vk);
+
+/* ---- Batches ---- */
+
+/* Convert `count` instances to the renderer's instance format once and
+ * upload them into a new device-local buffer. `mesh` must be a 3D mesh;
+ * `texture` may be TEXTURE_HANDLE_INVALID. */
+EngineResult static_batch_create(VulkanContext *vk, MeshHandle mesh, TextureHandle texture,
+                                 const InstanceData3D *instances, u32 count,
+                                 StaticBatchHandle *out_handle);
+
+/* Overwrite instances [first, first + count) through the upload manager.
+ * Waits for an earlier frame still drawing the batch, if any; the current
+ * frame's draw already sees the new data. */
+EngineResult static_batch_update(VulkanContext *vk, StaticBatchHandle handle, u32 first,
+                                 const InstanceData3D *instances, u32 count);
+
+/* Waits for the device to go idle, then frees the batch's buffer. */
+void static_batch_destroy(VulkanContext *vk, StaticBatchHandle handle);
+
+/* ---- Per frame ---- */
+
+/* Clears the queued draws. Call after the frame slot's fence has signaled. */
+void static_batch_begin_frame(VulkanContext *vk);
+
+/* Queue the batch for this frame, in the views (3D camera frustum, shadow
+ * cascades) its bounds touch; nothing if none. A batch is drawn at most once
+ * per view and frame. */
+void static_batch_draw(VulkanContext *vk, StaticBatchHandle handle);
+
+#endif /* ENGINE_STATIC_BATCH_H */
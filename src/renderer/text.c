@@ -1,5 +1,6 @@
 #include "renderer/text.h"
 #include "renderer/vk_buffer.h"
+#include "renderer/vk_upload.h"
 #include "core/log.h"
 
 #include <stdio.h>
@@ -26,6 +27,95 @@ static f32             s_font_size;
 static TextVertex s_vertices[TEXT_MAX_CHARS * 6]; /* 6 verts per char (2 tris) */
 static u32        s_vertex_count;
 
+/* --------------------------------------------------------------------------
+ * Retained text cache
+ *
+ * Runs live in text_cache_buffer in whole blocks of TEXT_CACHE_BLOCK_CHARS
+ * quads, found through an open-addressed table keyed by a hash of
+ * (string, scale, color). A run is only evicted once it has not been drawn
+ * for MAX_FRAMES_IN_FLIGHT frames, so no in-flight frame still reads its
+ * blocks when they are overwritten.
+ * ------------------------------------------------------------------------ */
+
+#define TEXT_CACHE_BLOCKS      (TEXT_CACHE_MAX_CHARS / TEXT_CACHE_BLOCK_CHARS)
+#define TEXT_CACHE_TABLE_SIZE  (TEXT_CACHE_MAX_RUNS * 2)   /* power of two */
+#define TEXT_CACHE_TABLE_MASK  (TEXT_CACHE_TABLE_SIZE - 1)
+#define TEXT_CACHE_MAX_RUN_CHARS 256   /* longer strings are truncated */
+
+typedef struct {
+    u64 key;            /* 0 = empty slot */
+    u64 last_used;      /* frame_number of the last draw */
+    u32 first_block;
+    u32 block_count;
+    u32 vertex_count;
+} TextRun;
+
+typedef struct {
+    u32 first_vertex;
+    u32 vertex_count;
+    f32 origin[2];
+} TextRunDraw;
+
+static TextRun     s_runs[TEXT_CACHE_TABLE_SIZE];
+static u32         s_run_count;
+static u8          s_block_used[TEXT_CACHE_BLOCKS];
+static TextRunDraw s_run_draws[TEXT_CACHE_MAX_DRAWS];
+static u32         s_run_draw_count;
+static TextVertex  s_run_scratch[TEXT_CACHE_MAX_RUN_CHARS * 6];   /* layout of a miss */
+
+/* --------------------------------------------------------------------------
+ * Layout
+ * ------------------------------------------------------------------------ */
+
+/* Lay out str with its top-left at (x, y) as two triangles per quad.
+ * Returns the number of vertices written (at most max_chars * 6). */
+static u32 layout_text(const char *str, f32 x, f32 y, f32 scale,
+                       f32 r, f32 g, f32 b, TextVertex *out, u32 max_chars) {
+    /* stb_truetype works at the baked font size.
+     * We let it advance cursor_x/cursor_y at native (1x) size,
+     * then scale the resulting quad positions relative to the
+     * requested origin (x, y). */
+    f32 cursor_x = x / scale;
+    f32 cursor_y = (y + s_font_size * scale) / scale; /* baseline offset */
+    u32 count = 0;
+
+    for (const char *p = str; *p; p++) {
+        int ch = (int)(unsigned char)*p;
+        if (ch < FIRST_CHAR || ch >= FIRST_CHAR + CHAR_COUNT) continue;
+
+        if (count + 6 > max_chars * 6) {
+            LOG_WARN("Text vertex limit reached, skipping remaining characters");
+            break;
+        }
+
+        stbtt_aligned_quad q;
+        stbtt_GetBakedQuad(s_char_data, ATLAS_WIDTH, ATLAS_HEIGHT,
+                           ch - FIRST_CHAR, &cursor_x, &cursor_y, &q, 1);
+
+        /* Scale quad positions from native size to requested size */
+        f32 x0 = q.x0 * scale;
+        f32 y0 = q.y0 * scale;
+        f32 x1 = q.x1 * scale;
+        f32 y1 = q.y1 * scale;
+
+        /* Two triangles per character quad */
+        TextVertex *v = &out[count];
+
+        /* Triangle 1: top-left, bottom-left, bottom-right */
+        v[0] = (TextVertex){ .position = { x0, y0 }, .uv = { q.s0, q.t0 }, .color = { r, g, b } };
+        v[1] = (TextVertex){ .position = { x0, y1 }, .uv = { q.s0, q.t1 }, .color = { r, g, b } };
+        v[2] = (TextVertex){ .position = { x1, y1 }, .uv = { q.s1, q.t1 }, .color = { r, g, b } };
+
+        /* Triangle 2: top-left, bottom-right, top-right */
+        v[3] = (TextVertex){ .position = { x0, y0 }, .uv = { q.s0, q.t0 }, .color = { r, g, b } };
+        v[4] = (TextVertex){ .position = { x1, y1 }, .uv = { q.s1, q.t1 }, .color = { r, g, b } };
+        v[5] = (TextVertex){ .position = { x1, y0 }, .uv = { q.s1, q.t0 }, .color = { r, g, b } };
+
+        count += 6;
+    }
+    return count;
+}
+
 /* --------------------------------------------------------------------------
  * Public API
  * ------------------------------------------------------------------------ */
@@ -65,7 +155,7 @@ EngineResult text_init(VulkanContext *ctx, const char *font_path, f32 font_size)
 
     /* Upload atlas as R8 texture */
     EngineResult res = vk_create_texture(ctx, atlas_bitmap, ATLAS_WIDTH, ATLAS_HEIGHT,
-                                          VK_FORMAT_R8_UNORM, VK_FILTER_LINEAR,
+                                          VK_FORMAT_R8_UNORM, VK_FILTER_LINEAR, false,
                                           &ctx->font_atlas);
     free(atlas_bitmap);
     if (res != ENGINE_SUCCESS) return res;
@@ -121,110 +211,229 @@ EngineResult text_init(VulkanContext *ctx, const char *font_path, f32 font_size)
 
     vkUpdateDescriptorSets(ctx->device, 1, &write, 0, NULL);
 
-    /* Create text vertex buffer (CPU-visible, updated every frame) */
+    /* Text vertex ring (CPU-visible, one region per frame in flight) */
     VkDeviceSize buf_size = sizeof(TextVertex) * TEXT_MAX_CHARS * 6;
     ctx->text_vertex_capacity = TEXT_MAX_CHARS * 6;
 
-    res = vk_create_buffer(ctx, buf_size,
-        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        &ctx->text_vertex_buffer, &ctx->text_vertex_buffer_memory);
+    res = vk_create_frame_ring(ctx, buf_size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                               &ctx->text_vertex_ring);
     if (res != ENGINE_SUCCESS) return res;
 
-    /* Persistently map — avoids vkMapMemory/vkUnmapMemory every frame */
-    if (vkMapMemory(ctx->device, ctx->text_vertex_buffer_memory,
-                    0, buf_size, 0, &ctx->text_vertex_mapped) != VK_SUCCESS) {
-        LOG_FATAL("Failed to persistently map text vertex buffer");
-        return ENGINE_ERROR_VULKAN_INIT;
-    }
+    /* Retained run buffer (GPU-local, written through the staging ring) */
+    res = vk_create_buffer(ctx, sizeof(TextVertex) * TEXT_CACHE_MAX_CHARS * 6,
+                           VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                           &ctx->text_cache_buffer, &ctx->text_cache_memory);
+    if (res != ENGINE_SUCCESS) return res;
+
+    memset(s_runs, 0, sizeof(s_runs));
+    memset(s_block_used, 0, sizeof(s_block_used));
+    s_run_count = 0;
+    s_run_draw_count = 0;
 
     LOG_INFO("Text rendering initialized (font: %s, size: %.0f, atlas: %dx%d)",
              font_path, font_size, ATLAS_WIDTH, ATLAS_HEIGHT);
     return ENGINE_SUCCESS;
 }
 
+f32 text_line_height(f32 scale) {
+    return s_font_size * scale;
+}
+
 void text_draw(VulkanContext *ctx, const char *str,
                f32 x, f32 y, f32 scale, f32 r, f32 g, f32 b)
 {
     ENGINE_UNUSED(ctx);
 
-    /* stb_truetype works at the baked font size.
-     * We let it advance cursor_x/cursor_y at native (1x) size,
-     * then scale the resulting quad positions relative to the
-     * requested origin (x, y). */
-    f32 cursor_x = x / scale;
-    f32 cursor_y = (y + s_font_size * scale) / scale; /* baseline offset */
+    s_vertex_count += layout_text(str, x, y, scale, r, g, b,
+                                  &s_vertices[s_vertex_count],
+                                  TEXT_MAX_CHARS - s_vertex_count / 6);
+}
 
+/* ---- Retained text cache ---- */
+
+static u64 run_key(const char *str, f32 scale, f32 r, f32 g, f32 b) {
+    u64 h = 14695981039346656037ull;   /* FNV-1a 64 */
     for (const char *p = str; *p; p++) {
-        int ch = (int)(unsigned char)*p;
-        if (ch < FIRST_CHAR || ch >= FIRST_CHAR + CHAR_COUNT) continue;
+        h ^= (u8)*p;
+        h *= 1099511628211ull;
+    }
+    f32 params[4] = { scale, r, g, b };
+    const u8 *bytes = (const u8 *)params;
+    for (size_t i = 0; i < sizeof(params); i++) {
+        h ^= bytes[i];
+        h *= 1099511628211ull;
+    }
+    return h ? h : 1;
+}
 
-        if (s_vertex_count + 6 > TEXT_MAX_CHARS * 6) {
-            LOG_WARN("Text vertex limit reached, skipping remaining characters");
-            break;
+static u32 run_find(u64 key) {
+    u32 i = (u32)key & TEXT_CACHE_TABLE_MASK;
+    while (s_runs[i].key != 0 && s_runs[i].key != key) {
+        i = (i + 1) & TEXT_CACHE_TABLE_MASK;
+    }
+    return i;
+}
+
+/* Free a run's blocks and close the gap in its probe chain (backward shift) */
+static void run_remove(u32 slot) {
+    TextRun *run = &s_runs[slot];
+    memset(&s_block_used[run->first_block], 0, run->block_count);
+    s_run_count--;
+
+    u32 i = slot;
+    for (;;) {
+        s_runs[i].key = 0;
+        u32 j = i;
+        for (;;) {
+            j = (j + 1) & TEXT_CACHE_TABLE_MASK;
+            if (s_runs[j].key == 0) return;
+            u32 home = (u32)s_runs[j].key & TEXT_CACHE_TABLE_MASK;
+            /* Entry j may fill slot i unless its home lies in (i, j] */
+            bool between = (i <= j) ? (home > i && home <= j) : (home > i || home <= j);
+            if (!between) break;
         }
+        s_runs[i] = s_runs[j];
+        i = j;
+    }
+}
 
-        stbtt_aligned_quad q;
-        stbtt_GetBakedQuad(s_char_data, ATLAS_WIDTH, ATLAS_HEIGHT,
-                           ch - FIRST_CHAR, &cursor_x, &cursor_y, &q, 1);
+/* Drop every run that no in-flight frame can still be reading */
+static void runs_evict_stale(u64 frame_number) {
+    for (u32 i = 0; i < TEXT_CACHE_TABLE_SIZE; ) {
+        if (s_runs[i].key != 0 && frame_number >= s_runs[i].last_used + MAX_FRAMES_IN_FLIGHT) {
+            run_remove(i);   /* i now holds a shifted entry (or is empty) */
+        } else {
+            i++;
+        }
+    }
+}
 
-        /* Scale quad positions from native size to requested size */
-        f32 x0 = q.x0 * scale;
-        f32 y0 = q.y0 * scale;
-        f32 x1 = q.x1 * scale;
-        f32 y1 = q.y1 * scale;
+/* First fit over the block map. Returns TEXT_CACHE_BLOCKS when full. */
+static u32 blocks_alloc(u32 count) {
+    u32 run = 0;
+    for (u32 i = 0; i < TEXT_CACHE_BLOCKS; i++) {
+        run = s_block_used[i] ? 0 : run + 1;
+        if (run == count) {
+            u32 first = i + 1 - count;
+            memset(&s_block_used[first], 1, count);
+            return first;
+        }
+    }
+    return TEXT_CACHE_BLOCKS;
+}
 
-        /* Two triangles per character quad */
-        TextVertex *v = &s_vertices[s_vertex_count];
+void text_draw_cached(VulkanContext *ctx, const char *str,
+                      f32 x, f32 y, f32 scale, f32 r, f32 g, f32 b)
+{
+    if (s_run_draw_count >= TEXT_CACHE_MAX_DRAWS) {
+        text_draw(ctx, str, x, y, scale, r, g, b);
+        return;
+    }
 
-        /* Triangle 1: top-left, bottom-left, bottom-right */
-        v[0] = (TextVertex){ .position = { x0, y0 }, .uv = { q.s0, q.t0 }, .color = { r, g, b } };
-        v[1] = (TextVertex){ .position = { x0, y1 }, .uv = { q.s0, q.t1 }, .color = { r, g, b } };
-        v[2] = (TextVertex){ .position = { x1, y1 }, .uv = { q.s1, q.t1 }, .color = { r, g, b } };
+    u64 key = run_key(str, scale, r, g, b);
+    u32 slot = run_find(key);
+
+    if (s_runs[slot].key == 0) {
+        /* Miss: lay out at the origin, then allocate and upload */
+        TextVertex *verts = s_run_scratch;
+        u32 count = layout_text(str, 0.0f, 0.0f, scale, r, g, b,
+                                verts, TEXT_CACHE_MAX_RUN_CHARS);
+        if (count == 0) return;
+
+        u32 chars  = count / 6;
+        u32 blocks = (chars + TEXT_CACHE_BLOCK_CHARS - 1) / TEXT_CACHE_BLOCK_CHARS;
+        u32 first  = TEXT_CACHE_BLOCKS;
+        if (s_run_count < TEXT_CACHE_MAX_RUNS) first = blocks_alloc(blocks);
+        if (first == TEXT_CACHE_BLOCKS) {
+            runs_evict_stale(ctx->frame_number);
+            if (s_run_count < TEXT_CACHE_MAX_RUNS) first = blocks_alloc(blocks);
+        }
+        if (first == TEXT_CACHE_BLOCKS) {
+            text_draw(ctx, str, x, y, scale, r, g, b);
+            return;
+        }
 
-        /* Triangle 2: top-left, bottom-right, top-right */
-        v[3] = (TextVertex){ .position = { x0, y0 }, .uv = { q.s0, q.t0 }, .color = { r, g, b } };
-        v[4] = (TextVertex){ .position = { x1, y1 }, .uv = { q.s1, q.t1 }, .color = { r, g, b } };
-        v[5] = (TextVertex){ .position = { x1, y0 }, .uv = { q.s1, q.t0 }, .color = { r, g, b } };
+        VkDeviceSize offset = (VkDeviceSize)first * TEXT_CACHE_BLOCK_CHARS * 6 * sizeof(TextVertex);
+        if (vk_upload_buffer(ctx, ctx->text_cache_buffer, offset, verts,
+                             sizeof(TextVertex) * count) != ENGINE_SUCCESS) {
+            memset(&s_block_used[first], 0, blocks);
+            text_draw(ctx, str, x, y, scale, r, g, b);
+            return;
+        }
 
-        s_vertex_count += 6;
+        slot = run_find(key);   /* eviction may have moved the probe chain */
+        s_runs[slot] = (TextRun){
+            .key          = key,
+            .first_block  = first,
+            .block_count  = blocks,
+            .vertex_count = count,
+        };
+        s_run_count++;
     }
+
+    TextRun *run = &s_runs[slot];
+    run->last_used = ctx->frame_number;
+    s_run_draws[s_run_draw_count++] = (TextRunDraw){
+        .first_vertex = run->first_block * TEXT_CACHE_BLOCK_CHARS * 6,
+        .vertex_count = run->vertex_count,
+        .origin       = { x, y },
+    };
 }
 
 void text_flush_with_pipeline(VulkanContext *ctx, VkCommandBuffer cmd, VkPipeline pipeline) {
-    if (s_vertex_count == 0) return;
-
-    /* Upload vertex data via persistently mapped pointer (no map/unmap overhead) */
-    memcpy(ctx->text_vertex_mapped, s_vertices, sizeof(TextVertex) * s_vertex_count);
-
-    ctx->text_vertex_count = s_vertex_count;
+    if (s_vertex_count == 0 && s_run_draw_count == 0) return;
 
     /* Bind text pipeline (may be the default or bloom scene text pipeline) */
     vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
 
-    /* Push screen size */
-    f32 screen_size[2] = {
+    /* Push screen size and a zero origin */
+    f32 push[4] = {
         (f32)ctx->swapchain_extent.width,
         (f32)ctx->swapchain_extent.height,
+        0.0f, 0.0f,
     };
     vkCmdPushConstants(cmd, ctx->text_pipeline_layout,
-                       VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(screen_size), screen_size);
+                       VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(push), push);
 
     /* Bind descriptor set (font atlas) */
     vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
                             ctx->text_pipeline_layout, 0, 1,
                             &ctx->text_desc_set, 0, NULL);
 
-    /* Bind text vertex buffer */
-    VkBuffer buffers[] = { ctx->text_vertex_buffer };
-    VkDeviceSize offsets[] = { 0 };
-    vkCmdBindVertexBuffers(cmd, 0, 1, buffers, offsets);
+    if (s_vertex_count > 0) {
+        /* Upload into this frame's ring region (the GPU may still read the other one) */
+        FrameRing *ring = &ctx->text_vertex_ring;
+        memcpy(ring->mapped + ring->frame_offset, s_vertices,
+               sizeof(TextVertex) * s_vertex_count);
 
-    /* Draw */
-    vkCmdDraw(cmd, ctx->text_vertex_count, 1, 0, 0);
+        ctx->text_vertex_count = s_vertex_count;
+        ctx->text_draw_count++;
+        ctx->text_drawn_vertices += s_vertex_count;
+
+        VkBuffer buffers[] = { ring->buffer };
+        VkDeviceSize offsets[] = { ring->frame_offset };
+        vkCmdBindVertexBuffers(cmd, 0, 1, buffers, offsets);
+        vkCmdDraw(cmd, ctx->text_vertex_count, 1, 0, 0);
+    }
+
+    if (s_run_draw_count > 0) {
+        /* Cached runs: one draw each at its origin */
+        VkDeviceSize zero = 0;
+        vkCmdBindVertexBuffers(cmd, 0, 1, &ctx->text_cache_buffer, &zero);
+        for (u32 i = 0; i < s_run_draw_count; i++) {
+            const TextRunDraw *d = &s_run_draws[i];
+            vkCmdPushConstants(cmd, ctx->text_pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT,
+                               sizeof(f32) * 2, sizeof(d->origin), d->origin);
+            vkCmdDraw(cmd, d->vertex_count, 1, d->first_vertex, 0);
+            ctx->text_drawn_vertices += d->vertex_count;
+        }
+        ctx->text_draw_count += s_run_draw_count;
+    }
 
     /* Reset for next frame */
     s_vertex_count = 0;
+    s_run_draw_count = 0;
 }
 
 void text_flush(VulkanContext *ctx, VkCommandBuffer cmd) {
@@ -234,15 +443,8 @@ void text_flush(VulkanContext *ctx, VkCommandBuffer cmd) {
 void text_shutdown(VulkanContext *ctx) {
     vkDeviceWaitIdle(ctx->device);
 
-    if (ctx->text_vertex_buffer) {
-        if (ctx->text_vertex_mapped) {
-            vkUnmapMemory(ctx->device, ctx->text_vertex_buffer_memory);
-            ctx->text_vertex_mapped = NULL;
-        }
-        vkDestroyBuffer(ctx->device, ctx->text_vertex_buffer, NULL);
-        vkFreeMemory(ctx->device, ctx->text_vertex_buffer_memory, NULL);
-        ctx->text_vertex_buffer = VK_NULL_HANDLE;
-    }
+    vk_destroy_frame_ring(ctx, &ctx->text_vertex_ring);
+    vk_destroy_buffer(ctx, &ctx->text_cache_buffer, &ctx->text_cache_memory);
 
     if (ctx->text_desc_pool) {
         vkDestroyDescriptorPool(ctx->device, ctx->text_desc_pool, NULL);
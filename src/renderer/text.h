@@ -4,9 +4,15 @@
 #include "renderer/vk_types.h"
 #include "core/common.h"
 
-/* Maximum characters we can render in a single frame */
+/* Maximum characters we can render in a single frame (immediate text) */
 #define TEXT_MAX_CHARS 4096
 
+/* Retained text: runs laid out once and kept in a GPU-local buffer */
+#define TEXT_CACHE_MAX_CHARS   16384  /* buffer capacity */
+#define TEXT_CACHE_BLOCK_CHARS 16     /* allocation granularity */
+#define TEXT_CACHE_MAX_RUNS    1024
+#define TEXT_CACHE_MAX_DRAWS   1024   /* cached draws per frame */
+
 /* Initialize text rendering: load font, bake atlas, create GPU resources. */
 EngineResult text_init(VulkanContext *ctx, const char *font_path, f32 font_size);
 
@@ -15,6 +21,17 @@ EngineResult text_init(VulkanContext *ctx, const char *font_path, f32 font_size)
 void text_draw(VulkanContext *ctx, const char *str,
                f32 x, f32 y, f32 scale, f32 r, f32 g, f32 b);
 
+/* Draw a string through the retained-text cache. The run is keyed by
+ * (string hash, scale, color): the first call lays it out at the origin and
+ * uploads it once, later calls with the same key only queue an offset draw.
+ * Runs unused for a few frames are evicted when space runs out. Falls back
+ * to text_draw if the cache is full. Does not use the TEXT_MAX_CHARS budget. */
+void text_draw_cached(VulkanContext *ctx, const char *str,
+                      f32 x, f32 y, f32 scale, f32 r, f32 g, f32 b);
+
+/* Vertical advance of one line of text at `scale` */
+f32  text_line_height(f32 scale);
+
 /* Upload queued text vertices and record draw commands into the given command buffer.
  * Must be called inside a render pass. Uses the default text pipeline. */
 void text_flush(VulkanContext *ctx, VkCommandBuffer cmd);
@@ -0,0 +1,304 @@
+#include "renderer/texture_file.h"
+#include "platform/file_map.h"
+#include "core/log.h"
+
+#include <ctype.h>
+#include <string.h>
+
+/* --------------------------------------------------------------------------
+ * Format table
+ *
+ * DXGI_FORMAT values (DDS DX10 header) and VkFormat values (KTX2 header) are
+ * the numeric enum constants from the respective specs, so this file does
+ * not need the D3D or Vulkan headers.
+ * ------------------------------------------------------------------------ */
+
+typedef struct {
+    TextureFileFormat format;
+    u32               dxgi;
+    u32               vk_format;
+    u32               block_dim;
+    u32               block_bytes;
+} FormatInfo;
+
+static const FormatInfo FORMATS[] = {
+    { TEXTURE_FILE_FORMAT_RGBA8,         28,  37, 1,  4 },
+    { TEXTURE_FILE_FORMAT_RGBA8_SRGB,    29,  43, 1,  4 },
+    { TEXTURE_FILE_FORMAT_BC1,           71, 133, 4,  8 },
+    { TEXTURE_FILE_FORMAT_BC1_SRGB,      72, 134, 4,  8 },
+    { TEXTURE_FILE_FORMAT_BC3,           77, 137, 4, 16 },
+    { TEXTURE_FILE_FORMAT_BC3_SRGB,      78, 138, 4, 16 },
+    { TEXTURE_FILE_FORMAT_BC4,           80, 139, 4,  8 },
+    { TEXTURE_FILE_FORMAT_BC5,           83, 141, 4, 16 },
+    { TEXTURE_FILE_FORMAT_BC7,           98, 145, 4, 16 },
+    { TEXTURE_FILE_FORMAT_BC7_SRGB,      99, 146, 4, 16 },
+    { TEXTURE_FILE_FORMAT_ASTC_4X4,       0, 157, 4, 16 },  /* no DXGI equivalent */
+    { TEXTURE_FILE_FORMAT_ASTC_4X4_SRGB,  0, 158, 4, 16 },
+};
+
+#define FORMAT_COUNT (sizeof(FORMATS) / sizeof(FORMATS[0]))
+
+static const FormatInfo *format_info(TextureFileFormat format) {
+    for (u32 i = 0; i < FORMAT_COUNT; i++) {
+        if (FORMATS[i].format == format) return &FORMATS[i];
+    }
+    return NULL;
+}
+
+static TextureFileFormat format_from_dxgi(u32 dxgi) {
+    for (u32 i = 0; i < FORMAT_COUNT; i++) {
+        if (FORMATS[i].dxgi != 0 && FORMATS[i].dxgi == dxgi) return FORMATS[i].format;
+    }
+    return TEXTURE_FILE_FORMAT_UNKNOWN;
+}
+
+static TextureFileFormat format_from_vk(u32 vk_format) {
+    for (u32 i = 0; i < FORMAT_COUNT; i++) {
+        if (FORMATS[i].vk_format == vk_format) return FORMATS[i].format;
+    }
+    return TEXTURE_FILE_FORMAT_UNKNOWN;
+}
+
+u32 texture_file_block_dim(TextureFileFormat format) {
+    const FormatInfo *info = format_info(format);
+    return info ? info->block_dim : 0;
+}
+
+u32 texture_file_block_bytes(TextureFileFormat format) {
+    const FormatInfo *info = format_info(format);
+    return info ? info->block_bytes : 0;
+}
+
+/* Bytes of one level; UINT64_MAX if a hostile size overflows, which no
+ * file can then hold */
+static u64 level_bytes(const FormatInfo *info, u32 width, u32 height) {
+    u64 bw = ((u64)width  + info->block_dim - 1) / info->block_dim;
+    u64 bh = ((u64)height + info->block_dim - 1) / info->block_dim;
+    if (bh && bw > UINT64_MAX / info->block_bytes / bh) return UINT64_MAX;
+    return bw * bh * info->block_bytes;
+}
+
+static u32 read_u32(const u8 *p) {
+    u32 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static u64 read_u64(const u8 *p) {
+    u64 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static u32 mip_dim(u32 size, u32 level) {
+    u32 d = size >> level;
+    return d ? d : 1;
+}
+
+/* Levels a header may claim: down to 1x1 (floor(log2(max(w, h))) + 1) and
+ * at most TEXTURE_FILE_MAX_LEVELS; anything more is invalid as mipLevels */
+static u32 clamp_level_count(u32 count, u32 width, u32 height) {
+    u32 full = 1;
+    for (u32 d = width > height ? width : height; d > 1; d >>= 1) full++;
+    if (count == 0) count = 1;
+    if (count > full) count = full;
+    if (count > TEXTURE_FILE_MAX_LEVELS) count = TEXTURE_FILE_MAX_LEVELS;
+    return count;
+}
+
+bool texture_file_is_container(const char *path) {
+    const char *dot = strrchr(path, '.');
+    if (!dot) return false;
+
+    char ext[8] = {0};
+    for (u32 i = 0; i < sizeof(ext) - 1 && dot[i + 1]; i++) {
+        ext[i] = (char)tolower((unsigned char)dot[i + 1]);
+    }
+    return strcmp(ext, "dds") == 0 || strcmp(ext, "ktx2") == 0;
+}
+
+/* --------------------------------------------------------------------------
+ * DDS
+ *
+ * "DDS " + 124-byte DDS_HEADER, optionally followed by DDS_HEADER_DXT10 when
+ * the pixel format FourCC is "DX10". Mips follow the headers back to back.
+ * ------------------------------------------------------------------------ */
+
+#define DDS_HEADER_SIZE       128   /* magic + DDS_HEADER */
+#define DDS_DX10_SIZE         20
+#define DDS_FLAGS_FOURCC      0x4u
+#define DDS_CAPS2_CUBEMAP     0x200u
+#define DDS_CAPS2_VOLUME      0x200000u
+#define DDS_DIMENSION_2D      3u
+
+static u32 fourcc(const char s[4]) {
+    return (u32)(u8)s[0] | ((u32)(u8)s[1] << 8) | ((u32)(u8)s[2] << 16) | ((u32)(u8)s[3] << 24);
+}
+
+static bool parse_dds(const u8 *base, size_t size, TextureFile *out) {
+    if (size < DDS_HEADER_SIZE || read_u32(base + 4) != 124) return false;
+
+    u32 height     = read_u32(base + 12);
+    u32 width      = read_u32(base + 16);
+    u32 mip_count  = read_u32(base + 28);
+    u32 pf_flags   = read_u32(base + 80);
+    u32 pf_fourcc  = read_u32(base + 84);
+    u32 caps2      = read_u32(base + 112);
+    if (caps2 & (DDS_CAPS2_CUBEMAP | DDS_CAPS2_VOLUME)) {
+        LOG_ERROR("DDS cube maps and volume textures are not supported");
+        return false;
+    }
+
+    size_t data_offset = DDS_HEADER_SIZE;
+    TextureFileFormat format = TEXTURE_FILE_FORMAT_UNKNOWN;
+    if (!(pf_flags & DDS_FLAGS_FOURCC)) {
+        LOG_ERROR("DDS without FourCC (uncompressed legacy layout) is not supported");
+        return false;
+    }
+    if (pf_fourcc == fourcc("DX10")) {
+        if (size < DDS_HEADER_SIZE + DDS_DX10_SIZE) return false;
+        const u8 *dx10 = base + DDS_HEADER_SIZE;
+        if (read_u32(dx10 + 4) != DDS_DIMENSION_2D || read_u32(dx10 + 12) != 1) {
+            LOG_ERROR("DDS: only single 2D textures are supported");
+            return false;
+        }
+        format = format_from_dxgi(read_u32(dx10));
+        data_offset += DDS_DX10_SIZE;
+    } else if (pf_fourcc == fourcc("DXT1")) {
+        format = TEXTURE_FILE_FORMAT_BC1;
+    } else if (pf_fourcc == fourcc("DXT5")) {
+        format = TEXTURE_FILE_FORMAT_BC3;
+    } else if (pf_fourcc == fourcc("ATI1") || pf_fourcc == fourcc("BC4U")) {
+        format = TEXTURE_FILE_FORMAT_BC4;
+    } else if (pf_fourcc == fourcc("ATI2") || pf_fourcc == fourcc("BC5U")) {
+        format = TEXTURE_FILE_FORMAT_BC5;
+    }
+    if (format == TEXTURE_FILE_FORMAT_UNKNOWN) {
+        LOG_ERROR("DDS pixel format not supported");
+        return false;
+    }
+
+    const FormatInfo *info = format_info(format);
+    mip_count = clamp_level_count(mip_count, width, height);
+
+    size_t offset = data_offset;
+    for (u32 level = 0; level < mip_count; level++) {
+        u64 bytes = level_bytes(info, mip_dim(width, level), mip_dim(height, level));
+        if (bytes > (u64)(size - offset)) return false;
+        out->levels[level]      = base + offset;
+        out->level_sizes[level] = (size_t)bytes;
+        offset += (size_t)bytes;
+    }
+
+    out->format      = format;
+    out->width       = width;
+    out->height      = height;
+    out->level_count = mip_count;
+    return true;
+}
+
+/* --------------------------------------------------------------------------
+ * KTX2
+ *
+ * 12-byte identifier, 9 u32 header fields, the DFD/KVD/SGD index and one
+ * { byteOffset, byteLength, uncompressedByteLength } u64 triple per level.
+ * ------------------------------------------------------------------------ */
+
+static const u8 KTX2_IDENTIFIER[12] = {
+    0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'
+};
+
+#define KTX2_HEADER_SIZE  80
+#define KTX2_LEVEL_SIZE   24
+
+static bool parse_ktx2(const u8 *base, size_t size, TextureFile *out) {
+    if (size < KTX2_HEADER_SIZE) return false;
+
+    u32 vk_format    = read_u32(base + 12);
+    u32 width        = read_u32(base + 20);
+    u32 height       = read_u32(base + 24);
+    u32 depth        = read_u32(base + 28);
+    u32 layers       = read_u32(base + 32);
+    u32 faces        = read_u32(base + 36);
+    u32 level_count  = read_u32(base + 40);
+    u32 supercompress = read_u32(base + 44);
+
+    if (vk_format == 0 || supercompress != 0) {
+        /* VK_FORMAT_UNDEFINED = UASTC/ETC1S payload; BasisLZ/Zstd/zlib need a decoder */
+        LOG_ERROR("KTX2 is Basis/supercompressed (format %u, scheme %u); transcoding not available",
+                  vk_format, supercompress);
+        return false;
+    }
+    if (depth > 1 || layers > 1 || faces != 1) {
+        LOG_ERROR("KTX2: only single 2D textures are supported");
+        return false;
+    }
+
+    TextureFileFormat format = format_from_vk(vk_format);
+    if (format == TEXTURE_FILE_FORMAT_UNKNOWN) {
+        LOG_ERROR("KTX2 format %u not supported", vk_format);
+        return false;
+    }
+
+    /* levelCount 0 asks the loader to generate mips; we only use level 0 then */
+    level_count = clamp_level_count(level_count, width, height);
+    if (KTX2_HEADER_SIZE + (size_t)level_count * KTX2_LEVEL_SIZE > size) return false;
+
+    const FormatInfo *info = format_info(format);
+    for (u32 level = 0; level < level_count; level++) {
+        const u8 *entry = base + KTX2_HEADER_SIZE + (size_t)level * KTX2_LEVEL_SIZE;
+        u64 offset = read_u64(entry);
+        u64 length = read_u64(entry + 8);
+        u64 needed = level_bytes(info, mip_dim(width, level), mip_dim(height, level));
+        if (length < needed || offset > size || length > size - offset) return false;
+        out->levels[level]      = base + offset;
+        out->level_sizes[level] = (size_t)needed;
+    }
+
+    out->format      = format;
+    out->width       = width;
+    out->height      = height;
+    out->level_count = level_count;
+    return true;
+}
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * ------------------------------------------------------------------------ */
+
+EngineResult texture_file_open(const char *path, TextureFile *out_file) {
+    memset(out_file, 0, sizeof(*out_file));
+
+    FileMap *map = NULL;
+    EngineResult res = file_map_open(path, &map);
+    if (res != ENGINE_SUCCESS) return res;
+
+    const u8 *base = file_map_data(map);
+    size_t    size = file_map_size(map);
+
+    bool ok = false;
+    if (size >= 4 && memcmp(base, "DDS ", 4) == 0) {
+        ok = parse_dds(base, size, out_file);
+    } else if (size >= sizeof(KTX2_IDENTIFIER) &&
+               memcmp(base, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) == 0) {
+        ok = parse_ktx2(base, size, out_file);
+    } else {
+        LOG_ERROR("Not a DDS or KTX2 file: %s", path);
+    }
+
+    if (!ok || out_file->width == 0 || out_file->height == 0) {
+        LOG_ERROR("Failed to parse texture container: %s", path);
+        file_map_close(map);
+        memset(out_file, 0, sizeof(*out_file));
+        return ENGINE_ERROR_GENERIC;
+    }
+
+    out_file->map = map;
+    return ENGINE_SUCCESS;
+}
+
+void texture_file_close(TextureFile *file) {
+    if (!file) return;
+    file_map_close(file->map);
+    memset(file, 0, sizeof(*file));
+}
@@ -0,0 +1,55 @@
+#ifndef ENGINE_TEXTURE_FILE_H
+#define ENGINE_TEXTURE_FILE_H
+
+#include "core/common.h"
+
+/* Pre-compressed texture containers (DDS, KTX2) with pre-built mip chains.
+ * The file is memory-mapped; level pointers reference the mapping and are
+ * handed straight to the upload path. Only 2D, single-layer, non-cube
+ * textures in the block formats below are accepted. */
+
+#define TEXTURE_FILE_MAX_LEVELS 16
+
+typedef enum {
+    TEXTURE_FILE_FORMAT_UNKNOWN = 0,
+    TEXTURE_FILE_FORMAT_RGBA8,
+    TEXTURE_FILE_FORMAT_RGBA8_SRGB,
+    TEXTURE_FILE_FORMAT_BC1,
+    TEXTURE_FILE_FORMAT_BC1_SRGB,
+    TEXTURE_FILE_FORMAT_BC3,
+    TEXTURE_FILE_FORMAT_BC3_SRGB,
+    TEXTURE_FILE_FORMAT_BC4,
+    TEXTURE_FILE_FORMAT_BC5,          /* two-channel, e.g. normal maps */
+    TEXTURE_FILE_FORMAT_BC7,
+    TEXTURE_FILE_FORMAT_BC7_SRGB,
+    TEXTURE_FILE_FORMAT_ASTC_4X4,
+    TEXTURE_FILE_FORMAT_ASTC_4X4_SRGB,
+} TextureFileFormat;
+
+typedef struct FileMap FileMap;
+
+typedef struct {
+    FileMap          *map;
+    TextureFileFormat format;
+    u32               width;
+    u32               height;
+    u32               level_count;
+    const u8         *levels[TEXTURE_FILE_MAX_LEVELS];      /* level 0 = full size */
+    size_t            level_sizes[TEXTURE_FILE_MAX_LEVELS];
+} TextureFile;
+
+/* True if the path has a .dds or .ktx2 extension (case-insensitive) */
+bool texture_file_is_container(const char *path);
+
+/* Map and parse a DDS or KTX2 file. Returns ENGINE_ERROR_FILE_NOT_FOUND if it
+ * cannot be opened and ENGINE_ERROR_GENERIC for malformed files or content
+ * this loader does not handle (including Basis-supercompressed KTX2, which
+ * needs a transcoder). */
+EngineResult texture_file_open(const char *path, TextureFile *out_file);
+void         texture_file_close(TextureFile *file);
+
+/* Texels per block side (1 for RGBA8, 4 for BC / ASTC 4x4) and bytes per block */
+u32 texture_file_block_dim(TextureFileFormat format);
+u32 texture_file_block_bytes(TextureFileFormat format);
+
+#endif /* ENGINE_TEXTURE_FILE_H */
@@ -0,0 +1,191 @@
+#include "renderer/vertex_pack.h"
+
+#include <math.h>
+#include <string.h>
+
+/* --------------------------------------------------------------------------
+ * Scalar encoders
+ * ------------------------------------------------------------------------ */
+
+static inline i16 snorm16(f32 v) {
+    v = ENGINE_CLAMP(v, -1.0f, 1.0f);
+    return (i16)lrintf(v * 32767.0f);
+}
+
+static inline u8 unorm8(f32 v) {
+    v = ENGINE_CLAMP(v, 0.0f, 1.0f);
+    return (u8)lrintf(v * 255.0f);
+}
+
+static inline f32 sign_not_zero(f32 v) {
+    return (v >= 0.0f) ? 1.0f : -1.0f;
+}
+
+void vertex_pack_octahedral(const f32 n[3], i16 out[2]) {
+    f32 l1 = fabsf(n[0]) + fabsf(n[1]) + fabsf(n[2]);
+    if (l1 < 1e-20f) {
+        out[0] = out[1] = 0;
+        return;
+    }
+
+    f32 x = n[0] / l1;
+    f32 y = n[1] / l1;
+
+    /* Lower hemisphere folds over the diagonals */
+    if (n[2] < 0.0f) {
+        f32 fx = (1.0f - fabsf(y)) * sign_not_zero(x);
+        f32 fy = (1.0f - fabsf(x)) * sign_not_zero(y);
+        x = fx;
+        y = fy;
+    }
+
+    out[0] = snorm16(x);
+    out[1] = snorm16(y);
+}
+
+u16 vertex_pack_half(f32 v) {
+    u32 bits;
+    memcpy(&bits, &v, sizeof(bits));
+
+    u32 sign = (bits >> 16) & 0x8000u;
+    u32 abs  = bits & 0x7FFFFFFFu;
+
+    if (abs >= 0x7F800000u) {                     /* inf / NaN */
+        return (u16)(sign | 0x7C00u | ((abs > 0x7F800000u) ? 0x200u : 0u));
+    }
+    if (abs >= 0x477FF000u) {                     /* rounds past 65504 */
+        return (u16)(sign | 0x7C00u);
+    }
+    if (abs < 0x38800000u) {                      /* half subnormal or zero */
+        if (abs < 0x33000000u) return (u16)sign;  /* below half of the smallest subnormal */
+        u32 mant  = (abs & 0x007FFFFFu) | 0x00800000u;
+        u32 shift = 126u - (abs >> 23);           /* 14..24 */
+        u32 half  = mant >> shift;
+        u32 rest  = mant & ((1u << shift) - 1u);
+        u32 mid   = 1u << (shift - 1u);
+        if (rest > mid || (rest == mid && (half & 1u))) half++;
+        return (u16)(sign | half);
+    }
+
+    /* Normal: rebias the exponent and round the 13 dropped mantissa bits */
+    u32 half = ((abs >> 13) - (112u << 10));
+    u32 rest = abs & 0x1FFFu;
+    if (rest > 0x1000u || (rest == 0x1000u && (half & 1u))) half++;
+    return (u16)(sign | half);
+}
+
+/* --------------------------------------------------------------------------
+ * Vertex conversion
+ * ------------------------------------------------------------------------ */
+
+void vertex_pack_3d(const Vertex3D *src, u32 count, PackedVertex3D *dst) {
+    for (u32 i = 0; i < count; i++) {
+        const Vertex3D *s = &src[i];
+        PackedVertex3D *d = &dst[i];
+
+        memcpy(d->position, s->position, sizeof(d->position));
+        vertex_pack_octahedral(s->normal, d->normal);
+        d->uv[0]    = vertex_pack_half(s->uv[0]);
+        d->uv[1]    = vertex_pack_half(s->uv[1]);
+        d->color[0] = unorm8(s->color[0]);
+        d->color[1] = unorm8(s->color[1]);
+        d->color[2] = unorm8(s->color[2]);
+        d->color[3] = 255;
+    }
+}
+
+void vertex_pack_skinned(const SkinnedVertex3D *src, u32 count, PackedSkinnedVertex3D *dst) {
+    for (u32 i = 0; i < count; i++) {
+        const SkinnedVertex3D *s = &src[i];
+        PackedSkinnedVertex3D *d = &dst[i];
+
+        memcpy(d->position, s->position, sizeof(d->position));
+        vertex_pack_octahedral(s->normal, d->normal);
+        d->uv[0]    = vertex_pack_half(s->uv[0]);
+        d->uv[1]    = vertex_pack_half(s->uv[1]);
+        d->color[0] = unorm8(s->color[0]);
+        d->color[1] = unorm8(s->color[1]);
+        d->color[2] = unorm8(s->color[2]);
+        d->color[3] = 255;
+
+        f32 sum = 0.0f;
+        for (u32 k = 0; k < 4; k++) {
+            d->joints[k] = (u8)ENGINE_MIN(s->joints[k], 255u);
+            sum += ENGINE_MAX(s->weights[k], 0.0f);
+        }
+
+        /* Quantize, then hand the rounding residue to the heaviest influence */
+        if (sum <= 0.0f) {
+            d->weights[0] = 65535;
+            d->weights[1] = d->weights[2] = d->weights[3] = 0;
+            continue;
+        }
+        i32 total = 0;
+        u32 heaviest = 0;
+        for (u32 k = 0; k < 4; k++) {
+            f32 w = ENGINE_MAX(s->weights[k], 0.0f) / sum;
+            d->weights[k] = (u16)lrintf(w * 65535.0f);
+            total += d->weights[k];
+            if (d->weights[k] > d->weights[heaviest]) heaviest = k;
+        }
+        d->weights[heaviest] = (u16)(d->weights[heaviest] + (65535 - total));
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Instance conversion
+ * ------------------------------------------------------------------------ */
+
+/* Rows of R = Ry(yaw) * Rx(pitch) * Rz(roll), as mesh3d.vert */
+static void euler_rotation(const f32 e[3], f32 r[3][3]) {
+    f32 cp = cosf(e[0]), sp = sinf(e[0]);
+    f32 cy = cosf(e[1]), sy = sinf(e[1]);
+    f32 cr = cosf(e[2]), sr = sinf(e[2]);
+    r[0][0] = cy*cr + sy*sp*sr;  r[0][1] = -cy*sr + sy*sp*cr;  r[0][2] = sy*cp;
+    r[1][0] = cp*sr;             r[1][1] = cp*cr;              r[1][2] = -sp;
+    r[2][0] = -sy*cr + cy*sp*sr; r[2][1] = sy*sr + cy*sp*cr;   r[2][2] = cy*cp;
+}
+
+void vertex_pack_instance_3d(const InstanceData3D *src, u32 count, PackedInstanceData3D *dst) {
+    for (u32 i = 0; i < count; i++) {
+        const InstanceData3D *s = &src[i];
+        PackedInstanceData3D *d = &dst[i];
+
+        /* q = qy * qx * qz, the quaternion of the same Ry * Rx * Rz */
+        f32 cx = cosf(s->rotation[0] * 0.5f), sx = sinf(s->rotation[0] * 0.5f);
+        f32 cy = cosf(s->rotation[1] * 0.5f), sy = sinf(s->rotation[1] * 0.5f);
+        f32 cz = cosf(s->rotation[2] * 0.5f), sz = sinf(s->rotation[2] * 0.5f);
+        f32 w =  cy * cx, x = cy * sx, y = sy * cx, z = -sy * sx;
+        f32 q[4] = {
+            x * cz + y * sz,
+            y * cz - x * sz,
+            w * sz + z * cz,
+            w * cz - z * sz,
+        };
+
+        memcpy(d->position, s->position, sizeof(d->position));
+        for (u32 k = 0; k < 4; k++) d->rotation[k] = snorm16(q[k]);
+        for (u32 k = 0; k < 3; k++) {
+            d->scale[k] = vertex_pack_half(s->scale[k]);
+            d->color[k] = vertex_pack_half(s->color[k]);
+        }
+    }
+}
+
+void vertex_pack_instance_matrix_3d(const InstanceData3D *src, u32 count,
+                                    MatrixInstanceData3D *dst) {
+    for (u32 i = 0; i < count; i++) {
+        const InstanceData3D *s = &src[i];
+        MatrixInstanceData3D *d = &dst[i];
+
+        f32 r[3][3];
+        euler_rotation(s->rotation, r);
+        for (u32 row = 0; row < 3; row++) {
+            d->model[row][0] = r[row][0] * s->scale[0];
+            d->model[row][1] = r[row][1] * s->scale[1];
+            d->model[row][2] = r[row][2] * s->scale[2];
+            d->model[row][3] = s->position[row];
+        }
+        memcpy(d->color, s->color, sizeof(d->color));
+    }
+}
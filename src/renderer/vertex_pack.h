@@ -0,0 +1,29 @@
+#ifndef ENGINE_VERTEX_PACK_H
+#define ENGINE_VERTEX_PACK_H
+
+#include "core/common.h"
+#include "renderer/renderer_types.h"
+
+/* CPU side of the packed vertex formats (PackedVertex3D,
+ * PackedSkinnedVertex3D). Decoding happens in the vertex / skin shaders. */
+
+/* Octahedral map of a unit vector to two snorm16 values. Zero-length input
+ * encodes +Z. */
+void vertex_pack_octahedral(const f32 n[3], i16 out[2]);
+
+/* IEEE half float, round to nearest even; overflow saturates to infinity */
+u16  vertex_pack_half(f32 v);
+
+void vertex_pack_3d(const Vertex3D *src, u32 count, PackedVertex3D *dst);
+
+/* Joints above 255 are clamped; weights are renormalized so the four unorm16
+ * values always add up to exactly 65535. */
+void vertex_pack_skinned(const SkinnedVertex3D *src, u32 count, PackedSkinnedVertex3D *dst);
+
+/* Instance formats. Both build the same Ry * Rx * Rz rotation mesh3d.vert
+ * uses for InstanceData3D, so switching formats doesn't move anything. */
+void vertex_pack_instance_3d(const InstanceData3D *src, u32 count, PackedInstanceData3D *dst);
+void vertex_pack_instance_matrix_3d(const InstanceData3D *src, u32 count,
+                                    MatrixInstanceData3D *dst);
+
+#endif /* ENGINE_VERTEX_PACK_H */
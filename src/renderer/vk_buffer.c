@@ -1,19 +1,34 @@
 #include "renderer/vk_buffer.h"
+#include "renderer/vk_upload.h"
+#include "renderer/vertex_pack.h"
+#include "renderer/mesh_optimize.h"
+#include "renderer/resource_table.h"
 #include "core/log.h"
 
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
 
 /* --------------------------------------------------------------------------
- * Memory type selection
+ * GPU memory sub-allocator
+ *
+ * Blocks of GPU_BLOCK_SIZE bytes (smaller on small heaps) are allocated per
+ * memory type and carved up first-fit from a sorted, coalesced free list.
+ * Resources larger than half a block get a dedicated block. Blocks are freed
+ * as soon as their last allocation goes away. Not thread-safe.
  * ------------------------------------------------------------------------ */
 
+static VkDeviceSize align_up(VkDeviceSize v, VkDeviceSize a) {
+    return (v + a - 1) / a * a;
+}
+
 static u32 find_memory_type(VulkanContext *ctx, u32 type_filter, VkMemoryPropertyFlags props) {
-    VkPhysicalDeviceMemoryProperties mem_props;
-    vkGetPhysicalDeviceMemoryProperties(ctx->physical_device, &mem_props);
+    const VkPhysicalDeviceMemoryProperties *mem_props = &ctx->allocator.props;
 
-    for (u32 i = 0; i < mem_props.memoryTypeCount; i++) {
+    for (u32 i = 0; i < mem_props->memoryTypeCount; i++) {
         if ((type_filter & (1 << i)) &&
-            (mem_props.memoryTypes[i].propertyFlags & props) == props) {
+            (mem_props->memoryTypes[i].propertyFlags & props) == props) {
             return i;
         }
     }
@@ -22,6 +37,326 @@ static u32 find_memory_type(VulkanContext *ctx, u32 type_filter, VkMemoryPropert
     return UINT32_MAX;
 }
 
+bool vk_memory_type_available(const VulkanContext *ctx, u32 type_filter,
+                              VkMemoryPropertyFlags props) {
+    const VkPhysicalDeviceMemoryProperties *mem_props = &ctx->allocator.props;
+
+    for (u32 i = 0; i < mem_props->memoryTypeCount; i++) {
+        if ((type_filter & (1 << i)) &&
+            (mem_props->memoryTypes[i].propertyFlags & props) == props) {
+            return true;
+        }
+    }
+    return false;
+}
+
+EngineResult vk_memory_init(VulkanContext *ctx) {
+    memset(&ctx->allocator, 0, sizeof(ctx->allocator));
+    vkGetPhysicalDeviceMemoryProperties(ctx->physical_device, &ctx->allocator.props);
+    return ENGINE_SUCCESS;
+}
+
+static void destroy_block(VulkanContext *ctx, GpuMemoryBlock *block) {
+    if (block->mapped) vkUnmapMemory(ctx->device, block->memory);
+    vkFreeMemory(ctx->device, block->memory, NULL);
+    free(block->free_ranges);
+    memset(block, 0, sizeof(*block));
+}
+
+void vk_memory_shutdown(VulkanContext *ctx) {
+    GpuAllocator *a = &ctx->allocator;
+    for (u32 i = 0; i < GPU_MAX_BLOCKS; i++) {
+        GpuMemoryBlock *block = &a->blocks[i];
+        if (!block->memory) continue;
+        if (block->alloc_count > 0) {
+            LOG_WARN("GPU memory block %u still has %u allocations at shutdown",
+                     i, block->alloc_count);
+        }
+        destroy_block(ctx, block);
+    }
+}
+
+/* Insert a free range at position `at`, growing the array if needed. */
+static bool free_list_insert(GpuMemoryBlock *block, u32 at, VkDeviceSize offset, VkDeviceSize size) {
+    if (block->free_count == block->free_capacity) {
+        u32 new_cap = block->free_capacity ? block->free_capacity * 2 : 16;
+        GpuFreeRange *r = realloc(block->free_ranges, sizeof(GpuFreeRange) * new_cap);
+        if (!r) return false;
+        block->free_ranges   = r;
+        block->free_capacity = new_cap;
+    }
+    memmove(&block->free_ranges[at + 1], &block->free_ranges[at],
+            sizeof(GpuFreeRange) * (block->free_count - at));
+    block->free_ranges[at] = (GpuFreeRange){ offset, size };
+    block->free_count++;
+    return true;
+}
+
+static void free_list_remove(GpuMemoryBlock *block, u32 at) {
+    memmove(&block->free_ranges[at], &block->free_ranges[at + 1],
+            sizeof(GpuFreeRange) * (block->free_count - at - 1));
+    block->free_count--;
+}
+
+/* First-fit carve of `size` bytes at `align` from a block. */
+static bool block_alloc(GpuMemoryBlock *block, VkDeviceSize size, VkDeviceSize align,
+                        VkDeviceSize *out_offset) {
+    for (u32 i = 0; i < block->free_count; i++) {
+        GpuFreeRange r = block->free_ranges[i];
+        VkDeviceSize start = align_up(r.offset, align);
+        VkDeviceSize pad   = start - r.offset;
+        if (pad + size > r.size) continue;
+
+        VkDeviceSize tail = r.size - pad - size;
+        if (pad > 0 && tail > 0) {
+            /* Split: keep the alignment gap and the remainder */
+            if (!free_list_insert(block, i + 1, start + size, tail)) return false;
+            block->free_ranges[i].size = pad;
+        } else if (pad > 0) {
+            block->free_ranges[i].size = pad;
+        } else if (tail > 0) {
+            block->free_ranges[i] = (GpuFreeRange){ start + size, tail };
+        } else {
+            free_list_remove(block, i);
+        }
+
+        block->used += size;
+        block->alloc_count++;
+        *out_offset = start;
+        return true;
+    }
+    return false;
+}
+
+/* Return a range to a block's free list, merging with its neighbours. */
+static void block_free(GpuMemoryBlock *block, VkDeviceSize offset, VkDeviceSize size) {
+    u32 at = 0;
+    while (at < block->free_count && block->free_ranges[at].offset < offset) at++;
+
+    bool merge_prev = at > 0 &&
+        block->free_ranges[at - 1].offset + block->free_ranges[at - 1].size == offset;
+    bool merge_next = at < block->free_count &&
+        offset + size == block->free_ranges[at].offset;
+
+    if (merge_prev && merge_next) {
+        block->free_ranges[at - 1].size += size + block->free_ranges[at].size;
+        free_list_remove(block, at);
+    } else if (merge_prev) {
+        block->free_ranges[at - 1].size += size;
+    } else if (merge_next) {
+        block->free_ranges[at].offset = offset;
+        block->free_ranges[at].size  += size;
+    } else if (!free_list_insert(block, at, offset, size)) {
+        /* Out of host memory: the range leaks until the block is destroyed */
+        LOG_WARN("GPU allocator: failed to record freed range");
+    }
+
+    block->used -= size;
+    block->alloc_count--;
+}
+
+static GpuMemoryBlock *create_block(VulkanContext *ctx, u32 type, VkDeviceSize size,
+                                    bool optimal, bool dedicated, u32 *out_index) {
+    GpuAllocator *a = &ctx->allocator;
+
+    u32 slot = GPU_MAX_BLOCKS;
+    for (u32 i = 0; i < GPU_MAX_BLOCKS; i++) {
+        if (!a->blocks[i].memory) { slot = i; break; }
+    }
+    if (slot == GPU_MAX_BLOCKS) {
+        LOG_ERROR("GPU allocator: block table full (%u blocks)", GPU_MAX_BLOCKS);
+        return NULL;
+    }
+
+    VkMemoryAllocateInfo alloc_info = {
+        .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize  = size,
+        .memoryTypeIndex = type,
+    };
+
+    GpuMemoryBlock *block = &a->blocks[slot];
+    if (vkAllocateMemory(ctx->device, &alloc_info, NULL, &block->memory) != VK_SUCCESS) {
+        LOG_ERROR("Failed to allocate %llu KB device memory block",
+                  (unsigned long long)(size / 1024));
+        block->memory = VK_NULL_HANDLE;
+        return NULL;
+    }
+
+    if (a->props.memoryTypes[type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        void *mapped;
+        if (vkMapMemory(ctx->device, block->memory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS) {
+            LOG_ERROR("Failed to map host-visible memory block");
+            vkFreeMemory(ctx->device, block->memory, NULL);
+            block->memory = VK_NULL_HANDLE;
+            return NULL;
+        }
+        block->mapped = mapped;
+    }
+
+    block->size      = size;
+    block->type      = type;
+    block->optimal   = optimal;
+    block->dedicated = dedicated;
+    if (!free_list_insert(block, 0, 0, size)) {
+        destroy_block(ctx, block);
+        return NULL;
+    }
+
+    *out_index = slot;
+    return block;
+}
+
+EngineResult vk_memory_alloc(VulkanContext *ctx, const VkMemoryRequirements *reqs,
+                             VkMemoryPropertyFlags props, bool optimal_image,
+                             GpuAllocation *out) {
+    GpuAllocator *a = &ctx->allocator;
+    memset(out, 0, sizeof(*out));
+
+    u32 type = find_memory_type(ctx, reqs->memoryTypeBits, props);
+    if (type == UINT32_MAX) return ENGINE_ERROR_VULKAN_INIT;
+
+    /* Keep blocks to a fraction of small heaps (e.g. 256 MB BAR windows) */
+    u32 heap = a->props.memoryTypes[type].heapIndex;
+    VkDeviceSize block_size = GPU_BLOCK_SIZE;
+    if (a->props.memoryHeaps[heap].size / 8 < block_size) {
+        block_size = a->props.memoryHeaps[heap].size / 8;
+    }
+
+    VkDeviceSize align = reqs->alignment ? reqs->alignment : 1;
+    u32 index = 0;
+    VkDeviceSize offset = 0;
+    GpuMemoryBlock *block = NULL;
+
+    if (reqs->size > block_size / 2) {
+        block = create_block(ctx, type, reqs->size, optimal_image, true, &index);
+        if (!block) return ENGINE_ERROR_OUT_OF_MEMORY;
+        block_alloc(block, reqs->size, align, &offset);
+    } else {
+        for (u32 i = 0; i < GPU_MAX_BLOCKS; i++) {
+            GpuMemoryBlock *b = &a->blocks[i];
+            if (!b->memory || b->dedicated || b->type != type || b->optimal != optimal_image) continue;
+            if (block_alloc(b, reqs->size, align, &offset)) {
+                block = b;
+                index = i;
+                break;
+            }
+        }
+        if (!block) {
+            block = create_block(ctx, type, block_size, optimal_image, false, &index);
+            if (!block) return ENGINE_ERROR_OUT_OF_MEMORY;
+            if (!block_alloc(block, reqs->size, align, &offset)) {
+                destroy_block(ctx, block);
+                return ENGINE_ERROR_OUT_OF_MEMORY;
+            }
+        }
+    }
+
+    out->memory = block->memory;
+    out->offset = offset;
+    out->size   = reqs->size;
+    out->mapped = block->mapped ? block->mapped + offset : NULL;
+    out->block  = index;
+    return ENGINE_SUCCESS;
+}
+
+void vk_memory_free(VulkanContext *ctx, GpuAllocation *alloc) {
+    if (!alloc->memory) return;
+
+    GpuMemoryBlock *block = &ctx->allocator.blocks[alloc->block];
+    block_free(block, alloc->offset, alloc->size);
+    if (block->alloc_count == 0) {
+        destroy_block(ctx, block);
+    }
+    memset(alloc, 0, sizeof(*alloc));
+}
+
+EngineResult vk_memory_alloc_image(VulkanContext *ctx, VkImage image,
+                                   VkMemoryPropertyFlags props, GpuAllocation *out) {
+    VkMemoryRequirements mem_reqs;
+    vkGetImageMemoryRequirements(ctx->device, image, &mem_reqs);
+
+    EngineResult res = vk_memory_alloc(ctx, &mem_reqs, props, true, out);
+    if (res != ENGINE_SUCCESS) return res;
+
+    if (vkBindImageMemory(ctx->device, image, out->memory, out->offset) != VK_SUCCESS) {
+        LOG_ERROR("Failed to bind image memory");
+        vk_memory_free(ctx, out);
+        return ENGINE_ERROR_VULKAN_INIT;
+    }
+    return ENGINE_SUCCESS;
+}
+
+void vk_memory_get_stats(const VulkanContext *ctx, GpuMemoryStats *out) {
+    const GpuAllocator *a = &ctx->allocator;
+    memset(out, 0, sizeof(*out));
+
+    out->heap_count = a->props.memoryHeapCount;
+    for (u32 h = 0; h < a->props.memoryHeapCount; h++) {
+        out->heap_size[h]  = a->props.memoryHeaps[h].size;
+        out->heap_flags[h] = a->props.memoryHeaps[h].flags;
+    }
+
+    /* The budget moves with other processes and the driver, so it is
+     * queried fresh each time */
+    if (ctx->memory_budget) {
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budget = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT,
+        };
+        VkPhysicalDeviceMemoryProperties2 props2 = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+            .pNext = &budget,
+        };
+        vkGetPhysicalDeviceMemoryProperties2(ctx->physical_device, &props2);
+        for (u32 h = 0; h < a->props.memoryHeapCount; h++) {
+            out->heap_budget[h] = budget.heapBudget[h];
+            out->heap_usage[h]  = budget.heapUsage[h];
+        }
+        out->heap_budget_valid = true;
+    }
+
+    for (u32 i = 0; i < GPU_MAX_BLOCKS; i++) {
+        const GpuMemoryBlock *b = &a->blocks[i];
+        if (!b->memory) continue;
+
+        out->block_count++;
+        out->allocation_count += b->alloc_count;
+        out->block_bytes      += b->size;
+        out->used_bytes       += b->used;
+        out->free_range_count += b->free_count;
+        out->heap_block_bytes[a->props.memoryTypes[b->type].heapIndex] += b->size;
+        for (u32 r = 0; r < b->free_count; r++) {
+            if (b->free_ranges[r].size > out->largest_free)
+                out->largest_free = b->free_ranges[r].size;
+        }
+    }
+}
+
+void vk_memory_log_stats(const VulkanContext *ctx) {
+    GpuMemoryStats st;
+    vk_memory_get_stats(ctx, &st);
+
+    LOG_INFO("GPU memory: %u allocations in %u blocks, %llu / %llu KB used, "
+             "%u free ranges (largest %llu KB)",
+             st.allocation_count, st.block_count,
+             (unsigned long long)(st.used_bytes / 1024),
+             (unsigned long long)(st.block_bytes / 1024),
+             st.free_range_count, (unsigned long long)(st.largest_free / 1024));
+    for (u32 h = 0; h < st.heap_count; h++) {
+        if (st.heap_block_bytes[h] == 0) continue;
+        if (st.heap_budget_valid) {
+            LOG_INFO("  heap %u: %llu / %llu MB reserved, process %llu / %llu MB budget", h,
+                     (unsigned long long)(st.heap_block_bytes[h] >> 20),
+                     (unsigned long long)(st.heap_size[h] >> 20),
+                     (unsigned long long)(st.heap_usage[h] >> 20),
+                     (unsigned long long)(st.heap_budget[h] >> 20));
+        } else {
+            LOG_INFO("  heap %u: %llu / %llu MB reserved", h,
+                     (unsigned long long)(st.heap_block_bytes[h] >> 20),
+                     (unsigned long long)(st.heap_size[h] >> 20));
+        }
+    }
+}
+
 /* --------------------------------------------------------------------------
  * Generic buffer creation
  * ------------------------------------------------------------------------ */
@@ -31,7 +366,7 @@ EngineResult vk_create_buffer(VulkanContext *ctx,
                               VkBufferUsageFlags usage,
                               VkMemoryPropertyFlags mem_props,
                               VkBuffer *out_buffer,
-                              VkDeviceMemory *out_memory)
+                              GpuAllocation *out_memory)
 {
     VkBufferCreateInfo buf_info = {
         .sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
@@ -40,6 +375,20 @@ EngineResult vk_create_buffer(VulkanContext *ctx,
         .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
     };
 
+    /* Upload targets are written by the transfer queue and read by graphics;
+     * storage buffers may also be read or written by the async compute queue */
+    u32 families[3] = { ctx->graphics_family };
+    u32 family_count = 1;
+    if ((usage & VK_BUFFER_USAGE_TRANSFER_DST_BIT) && ctx->upload.concurrent)
+        families[family_count++] = ctx->transfer_family;
+    if ((usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT) && ctx->compute.enabled)
+        families[family_count++] = ctx->compute.family;
+    if (family_count > 1) {
+        buf_info.sharingMode           = VK_SHARING_MODE_CONCURRENT;
+        buf_info.queueFamilyIndexCount = family_count;
+        buf_info.pQueueFamilyIndices   = families;
+    }
+
     if (vkCreateBuffer(ctx->device, &buf_info, NULL, out_buffer) != VK_SUCCESS) {
         LOG_ERROR("Failed to create buffer");
         return ENGINE_ERROR_VULKAN_INIT;
@@ -48,28 +397,89 @@ EngineResult vk_create_buffer(VulkanContext *ctx,
     VkMemoryRequirements mem_reqs;
     vkGetBufferMemoryRequirements(ctx->device, *out_buffer, &mem_reqs);
 
-    u32 mem_type = find_memory_type(ctx, mem_reqs.memoryTypeBits, mem_props);
-    if (mem_type == UINT32_MAX) {
+    EngineResult res = vk_memory_alloc(ctx, &mem_reqs, mem_props, false, out_memory);
+    if (res != ENGINE_SUCCESS) {
+        LOG_ERROR("Failed to allocate buffer memory");
         vkDestroyBuffer(ctx->device, *out_buffer, NULL);
-        return ENGINE_ERROR_VULKAN_INIT;
+        return res;
     }
 
-    VkMemoryAllocateInfo alloc_info = {
-        .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .allocationSize  = mem_reqs.size,
-        .memoryTypeIndex = mem_type,
-    };
+    vkBindBufferMemory(ctx->device, *out_buffer, out_memory->memory, out_memory->offset);
+    return ENGINE_SUCCESS;
+}
 
-    if (vkAllocateMemory(ctx->device, &alloc_info, NULL, out_memory) != VK_SUCCESS) {
-        LOG_ERROR("Failed to allocate buffer memory");
-        vkDestroyBuffer(ctx->device, *out_buffer, NULL);
-        return ENGINE_ERROR_OUT_OF_MEMORY;
+void vk_destroy_buffer(VulkanContext *ctx, VkBuffer *buffer, GpuAllocation *memory) {
+    if (*buffer) {
+        vkDestroyBuffer(ctx->device, *buffer, NULL);
+        *buffer = VK_NULL_HANDLE;
     }
+    vk_memory_free(ctx, memory);
+}
 
-    vkBindBufferMemory(ctx->device, *out_buffer, *out_memory, 0);
+/* --------------------------------------------------------------------------
+ * Per-frame ring buffers (one mapped region per frame in flight)
+ * ------------------------------------------------------------------------ */
+
+EngineResult vk_create_frame_ring(VulkanContext *ctx,
+                                  VkDeviceSize frame_size,
+                                  VkBufferUsageFlags usage,
+                                  FrameRing *out_ring)
+{
+    memset(out_ring, 0, sizeof(*out_ring));
+
+    /* Align each region so frame offsets are legal dynamic offsets */
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(ctx->physical_device, &props);
+    VkDeviceSize align = props.limits.minStorageBufferOffsetAlignment;
+    if (props.limits.minUniformBufferOffsetAlignment > align)
+        align = props.limits.minUniformBufferOffsetAlignment;
+    if (align == 0) align = 1;
+    frame_size = (frame_size + align - 1) / align * align;
+
+    VkDeviceSize total = frame_size * ctx->frames_in_flight;
+    EngineResult res = vk_create_buffer(ctx, total, usage,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        &out_ring->buffer, &out_ring->memory);
+    if (res != ENGINE_SUCCESS) return res;
+
+    /* Host-visible blocks are persistently mapped by the allocator */
+    out_ring->mapped       = out_ring->memory.mapped;
+    out_ring->frame_size   = frame_size;
+    out_ring->frame_offset = 0;
+    out_ring->usage        = usage;
     return ENGINE_SUCCESS;
 }
 
+EngineResult vk_frame_ring_grow(VulkanContext *ctx, FrameRing *ring,
+                                VkDeviceSize min_frame_size,
+                                VkDeviceSize keep_bytes,
+                                FrameRing *out_old)
+{
+    FrameRing grown;
+    EngineResult res = vk_create_frame_ring(ctx, min_frame_size, ring->usage, &grown);
+    if (res != ENGINE_SUCCESS) return res;
+
+    /* Stay on the same frame slot and carry over what this frame already wrote */
+    grown.frame_offset = grown.frame_size * (ring->frame_offset / ring->frame_size);
+    if (keep_bytes > 0) {
+        memcpy(grown.mapped + grown.frame_offset,
+               ring->mapped + ring->frame_offset, (size_t)keep_bytes);
+    }
+
+    *out_old = *ring;
+    *ring    = grown;
+    return ENGINE_SUCCESS;
+}
+
+void vk_destroy_frame_ring(VulkanContext *ctx, FrameRing *ring) {
+    ring->mapped = NULL;
+    vk_destroy_buffer(ctx, &ring->buffer, &ring->memory);
+}
+
+void vk_frame_ring_begin(FrameRing *ring, u32 frame) {
+    ring->frame_offset = ring->frame_size * frame;
+}
+
 /* --------------------------------------------------------------------------
  * Single-shot command helpers (for staging transfers)
  * ------------------------------------------------------------------------ */
@@ -122,8 +532,8 @@ EngineResult vk_create_vertex_buffer(VulkanContext *ctx, u32 max_vertices) {
         &ctx->vertex_buffer, &ctx->vertex_buffer_memory);
     if (res != ENGINE_SUCCESS) return res;
 
-    ctx->vertex_total = 0;
-    ctx->mesh_count   = 0;
+    res = range_alloc_init(&ctx->vertex_ranges, max_vertices);
+    if (res != ENGINE_SUCCESS) return res;
 
     LOG_INFO("Shared vertex buffer created: capacity %u vertices (%llu bytes)",
              max_vertices, (unsigned long long)buf_size);
@@ -134,52 +544,37 @@ EngineResult vk_upload_mesh(VulkanContext *ctx,
                             const Vertex *vertices, u32 vertex_count,
                             MeshHandle *out_handle)
 {
-    if (ctx->mesh_count >= MAX_MESHES) {
-        LOG_ERROR("Mesh table full (%u/%u)", ctx->mesh_count, MAX_MESHES);
-        return ENGINE_ERROR_VULKAN_INIT;
+    u32 first_vertex;
+    if (!range_alloc(&ctx->vertex_ranges, vertex_count, &first_vertex)) {
+        LOG_ERROR("Vertex buffer full (%u of %u vertices used, %u more needed)",
+                  ctx->vertex_ranges.used, ctx->vertex_ranges.capacity, vertex_count);
+        return ENGINE_ERROR_OUT_OF_MEMORY;
     }
 
     VkDeviceSize data_size   = sizeof(Vertex) * vertex_count;
-    VkDeviceSize dest_offset = sizeof(Vertex) * ctx->vertex_total;
-
-    /* Staging buffer */
-    VkBuffer staging_buf;
-    VkDeviceMemory staging_mem;
-    EngineResult res = vk_create_buffer(ctx, data_size,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        &staging_buf, &staging_mem);
-    if (res != ENGINE_SUCCESS) return res;
-
-    void *mapped;
-    vkMapMemory(ctx->device, staging_mem, 0, data_size, 0, &mapped);
-    memcpy(mapped, vertices, (size_t)data_size);
-    vkUnmapMemory(ctx->device, staging_mem);
-
-    /* Copy at offset into the shared vertex buffer */
-    VkCommandBuffer cmd = vk_begin_single_command(ctx);
-    VkBufferCopy copy_region = {
-        .srcOffset = 0,
-        .dstOffset = dest_offset,
-        .size      = data_size,
-    };
-    vkCmdCopyBuffer(cmd, staging_buf, ctx->vertex_buffer, 1, &copy_region);
-    vk_end_single_command(ctx, cmd);
-
-    vkDestroyBuffer(ctx->device, staging_buf, NULL);
-    vkFreeMemory(ctx->device, staging_mem, NULL);
+    VkDeviceSize dest_offset = sizeof(Vertex) * first_vertex;
+
+    /* Copy at offset into the shared vertex buffer (batched, see vk_upload.c) */
+    MeshHandle handle;
+    EngineResult res = mesh_reserve(ctx, &handle);
+    if (res == ENGINE_SUCCESS) {
+        res = vk_upload_buffer(ctx, ctx->vertex_buffer, dest_offset, vertices, data_size);
+        if (res != ENGINE_SUCCESS) mesh_cancel(ctx, handle);
+    }
+    if (res != ENGINE_SUCCESS) {
+        range_free(&ctx->vertex_ranges, first_vertex, vertex_count);
+        return res;
+    }
 
     /* Register mesh slot */
-    MeshHandle handle = (MeshHandle)ctx->mesh_count;
-    ctx->meshes[handle].first_vertex = ctx->vertex_total;
-    ctx->meshes[handle].vertex_count = vertex_count;
-    ctx->vertex_total += vertex_count;
-    ctx->mesh_count++;
+    MeshSlot *slot = &ctx->meshes[HANDLE_SLOT(handle)];
+    slot->first_vertex = first_vertex;
+    slot->vertex_count = vertex_count;
 
     *out_handle = handle;
 
     LOG_INFO("Mesh %u uploaded: %u vertices at offset %u",
-             handle, vertex_count, ctx->meshes[handle].first_vertex);
+             HANDLE_SLOT(handle), vertex_count, first_vertex);
     return ENGINE_SUCCESS;
 }
 
@@ -187,16 +582,45 @@ EngineResult vk_upload_mesh(VulkanContext *ctx,
  * 3D vertex buffer (pre-allocated GPU-local, separate from 2D buffer)
  * ------------------------------------------------------------------------ */
 
+u32 vk_vertex_3d_stride(const VulkanContext *ctx) {
+    return ctx->packed_vertices ? (u32)sizeof(PackedVertex3D) : (u32)sizeof(Vertex3D);
+}
+
+u32 vk_vertex_skinned_stride(const VulkanContext *ctx) {
+    return ctx->packed_vertices ? (u32)sizeof(PackedSkinnedVertex3D)
+                                : (u32)sizeof(SkinnedVertex3D);
+}
+
+u32 vk_instance_3d_stride(const VulkanContext *ctx) {
+    switch (ctx->instance_format_3d) {
+    case INSTANCE_FORMAT_3D_QUAT:   return (u32)sizeof(PackedInstanceData3D);
+    case INSTANCE_FORMAT_3D_MATRIX: return (u32)sizeof(MatrixInstanceData3D);
+    default:                        return (u32)sizeof(InstanceData3D);
+    }
+}
+
+void vk_write_instances_3d(const VulkanContext *ctx, void *dst,
+                           const InstanceData3D *src, u32 count) {
+    switch (ctx->instance_format_3d) {
+    case INSTANCE_FORMAT_3D_QUAT:   vertex_pack_instance_3d(src, count, dst);        break;
+    case INSTANCE_FORMAT_3D_MATRIX: vertex_pack_instance_matrix_3d(src, count, dst); break;
+    default:                        memcpy(dst, src, sizeof(InstanceData3D) * count); break;
+    }
+}
+
 EngineResult vk_create_vertex_buffer_3d(VulkanContext *ctx, u32 max_vertices) {
-    VkDeviceSize buf_size = sizeof(Vertex3D) * max_vertices;
+    VkDeviceSize buf_size = (VkDeviceSize)vk_vertex_3d_stride(ctx) * max_vertices;
 
+    /* Transfer source: mesh_compact copies live ranges out and back */
     EngineResult res = vk_create_buffer(ctx, buf_size,
-        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
         &ctx->vertex_buffer_3d, &ctx->vertex_buffer_3d_memory);
     if (res != ENGINE_SUCCESS) return res;
 
-    ctx->vertex_3d_total = 0;
+    res = range_alloc_init(&ctx->vertex_3d_ranges, max_vertices);
+    if (res != ENGINE_SUCCESS) return res;
 
     LOG_INFO("3D vertex buffer created: capacity %u vertices (%llu bytes)",
              max_vertices, (unsigned long long)buf_size);
@@ -211,18 +635,97 @@ EngineResult vk_create_index_buffer(VulkanContext *ctx, u32 max_indices) {
     VkDeviceSize buf_size = sizeof(u32) * max_indices;
 
     EngineResult res = vk_create_buffer(ctx, buf_size,
-        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+        VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
         &ctx->index_buffer, &ctx->index_buffer_memory);
     if (res != ENGINE_SUCCESS) return res;
 
-    ctx->index_total = 0;
+    res = range_alloc_init(&ctx->index_ranges, max_indices);
+    if (res != ENGINE_SUCCESS) return res;
 
     LOG_INFO("Index buffer created: capacity %u indices (%llu bytes)",
              max_indices, (unsigned long long)buf_size);
     return ENGINE_SUCCESS;
 }
 
+/* --------------------------------------------------------------------------
+ * Mesh bounds (for frustum culling)
+ *
+ * Sphere centred on the AABB with radius reaching the farthest vertex. Not
+ * minimal, but cheap and tight enough for culling. `positions` points at the
+ * first vertex's position; `stride` is the vertex size.
+ * ------------------------------------------------------------------------ */
+
+static void compute_mesh_bounds(const u8 *positions, size_t stride, u32 vertex_count,
+                                MeshSlot *slot) {
+    slot->bounds_center[0] = slot->bounds_center[1] = slot->bounds_center[2] = 0.0f;
+    slot->bounds_radius = 0.0f;
+    if (vertex_count == 0) return;
+
+    f32 lo[3], hi[3];
+    memcpy(lo, positions, sizeof(lo));
+    memcpy(hi, positions, sizeof(hi));
+    for (u32 i = 1; i < vertex_count; i++) {
+        const f32 *p = (const f32 *)(positions + (size_t)i * stride);
+        for (u32 k = 0; k < 3; k++) {
+            if (p[k] < lo[k]) lo[k] = p[k];
+            if (p[k] > hi[k]) hi[k] = p[k];
+        }
+    }
+
+    f32 c[3] = { (lo[0] + hi[0]) * 0.5f, (lo[1] + hi[1]) * 0.5f, (lo[2] + hi[2]) * 0.5f };
+    f32 max_d2 = 0.0f;
+    for (u32 i = 0; i < vertex_count; i++) {
+        const f32 *p = (const f32 *)(positions + (size_t)i * stride);
+        f32 dx = p[0] - c[0], dy = p[1] - c[1], dz = p[2] - c[2];
+        f32 d2 = dx * dx + dy * dy + dz * dz;
+        if (d2 > max_d2) max_d2 = d2;
+    }
+
+    memcpy(slot->bounds_center, c, sizeof(c));
+    slot->bounds_radius = sqrtf(max_d2);
+}
+
+/* --------------------------------------------------------------------------
+ * Mesh LOD chain (RendererConfig.mesh_lods)
+ *
+ * Each level is simplified from the full mesh to half the previous level's
+ * index count and appended to the shared index buffer; all levels draw from
+ * the mesh's one vertex range. The chain stops once a level saves less than
+ * a quarter or the mesh is too small to be worth it.
+ * ------------------------------------------------------------------------ */
+
+#define MESH_LOD_MIN_INDICES 384   /* 128 triangles */
+
+static void upload_mesh_lods(VulkanContext *ctx, const Vertex3D *vertices, u32 vertex_count,
+                             const u32 *indices, u32 index_count, MeshSlot *slot) {
+    if (!ctx->mesh_lods || slot->lod_count == 0 || index_count < MESH_LOD_MIN_INDICES) return;
+
+    u32 *scratch = malloc(sizeof(u32) * index_count);
+    if (!scratch) return;
+
+    u32 prev = index_count;
+    while (slot->lod_count < MESH_MAX_LODS && prev >= MESH_LOD_MIN_INDICES) {
+        u32 n = mesh_simplify(vertices, sizeof(Vertex3D), offsetof(Vertex3D, position),
+                              vertex_count, indices, index_count, prev / 2, scratch);
+        if (n == 0 || n > prev - prev / 4) break;
+        u32 first;
+        if (!range_alloc(&ctx->index_ranges, n, &first)) {
+            LOG_WARN("Index buffer full, mesh LOD chain truncated at %u levels", slot->lod_count);
+            break;
+        }
+        if (vk_upload_buffer(ctx, ctx->index_buffer, sizeof(u32) * first,
+                             scratch, sizeof(u32) * n) != ENGINE_SUCCESS) {
+            range_free(&ctx->index_ranges, first, n);
+            break;
+        }
+        slot->lods[slot->lod_count++] = (MeshLod){ first, n };
+        prev = n;
+    }
+    free(scratch);
+}
+
 /* --------------------------------------------------------------------------
  * 3D mesh upload (vertices + optional indices via staging)
  * ------------------------------------------------------------------------ */
@@ -232,86 +735,96 @@ EngineResult vk_upload_mesh_3d(VulkanContext *ctx,
                                const u32 *indices, u32 index_count,
                                MeshHandle *out_handle)
 {
-    if (ctx->mesh_count >= MAX_MESHES) {
-        LOG_ERROR("Mesh table full (%u/%u)", ctx->mesh_count, MAX_MESHES);
-        return ENGINE_ERROR_VULKAN_INIT;
-    }
-
-    /* Upload vertices */
-    VkDeviceSize vert_size   = sizeof(Vertex3D) * vertex_count;
-    VkDeviceSize vert_offset = sizeof(Vertex3D) * ctx->vertex_3d_total;
-
-    VkBuffer staging_buf;
-    VkDeviceMemory staging_mem;
-    EngineResult res = vk_create_buffer(ctx, vert_size,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        &staging_buf, &staging_mem);
+    MeshHandle handle;
+    EngineResult res = mesh_reserve(ctx, &handle);
     if (res != ENGINE_SUCCESS) return res;
 
-    void *mapped;
-    vkMapMemory(ctx->device, staging_mem, 0, vert_size, 0, &mapped);
-    memcpy(mapped, vertices, (size_t)vert_size);
-    vkUnmapMemory(ctx->device, staging_mem);
+    res = vk_upload_mesh_3d_at(ctx, handle, vertices, vertex_count, indices, index_count);
+    if (res != ENGINE_SUCCESS) {
+        mesh_cancel(ctx, handle);
+        return res;
+    }
 
-    VkCommandBuffer cmd = vk_begin_single_command(ctx);
-    VkBufferCopy copy_region = {
-        .srcOffset = 0,
-        .dstOffset = vert_offset,
-        .size      = vert_size,
-    };
-    vkCmdCopyBuffer(cmd, staging_buf, ctx->vertex_buffer_3d, 1, &copy_region);
-    vk_end_single_command(ctx, cmd);
-
-    vkDestroyBuffer(ctx->device, staging_buf, NULL);
-    vkFreeMemory(ctx->device, staging_mem, NULL);
-
-    /* Upload indices (if any) */
-    u32 first_index = 0;
-    if (indices && index_count > 0) {
-        VkDeviceSize idx_size   = sizeof(u32) * index_count;
-        VkDeviceSize idx_offset = sizeof(u32) * ctx->index_total;
-
-        res = vk_create_buffer(ctx, idx_size,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            &staging_buf, &staging_mem);
-        if (res != ENGINE_SUCCESS) return res;
-
-        vkMapMemory(ctx->device, staging_mem, 0, idx_size, 0, &mapped);
-        memcpy(mapped, indices, (size_t)idx_size);
-        vkUnmapMemory(ctx->device, staging_mem);
-
-        cmd = vk_begin_single_command(ctx);
-        VkBufferCopy idx_copy = {
-            .srcOffset = 0,
-            .dstOffset = idx_offset,
-            .size      = idx_size,
-        };
-        vkCmdCopyBuffer(cmd, staging_buf, ctx->index_buffer, 1, &idx_copy);
-        vk_end_single_command(ctx, cmd);
+    *out_handle = handle;
+    return ENGINE_SUCCESS;
+}
 
-        vkDestroyBuffer(ctx->device, staging_buf, NULL);
-        vkFreeMemory(ctx->device, staging_mem, NULL);
+/* Allocate a vertex range (and an index range when indexed) and stage both
+ * into the same batch. On failure nothing stays allocated. */
+static EngineResult upload_mesh_ranges(VulkanContext *ctx, RangeAllocator *vertex_ranges,
+                                       VkBuffer vertex_buffer, u32 stride,
+                                       const void *vert_data, u32 vertex_count,
+                                       const u32 *indices, u32 index_count,
+                                       u32 *out_first_vertex, u32 *out_first_index) {
+    u32 first_vertex, first_index = 0;
+    if (!range_alloc(vertex_ranges, vertex_count, &first_vertex)) {
+        LOG_ERROR("Vertex buffer full (%u of %u vertices used, %u more needed)",
+                  vertex_ranges->used, vertex_ranges->capacity, vertex_count);
+        return ENGINE_ERROR_OUT_OF_MEMORY;
+    }
+    bool indexed = indices && index_count > 0;
+    if (indexed && !range_alloc(&ctx->index_ranges, index_count, &first_index)) {
+        LOG_ERROR("Index buffer full (%u of %u indices used, %u more needed)",
+                  ctx->index_ranges.used, ctx->index_ranges.capacity, index_count);
+        range_free(vertex_ranges, first_vertex, vertex_count);
+        return ENGINE_ERROR_OUT_OF_MEMORY;
+    }
 
-        first_index = ctx->index_total;
-        ctx->index_total += index_count;
+    EngineResult res = vk_upload_buffer(ctx, vertex_buffer, (VkDeviceSize)stride * first_vertex,
+                                        vert_data, (VkDeviceSize)stride * vertex_count);
+    if (res == ENGINE_SUCCESS && indexed) {
+        res = vk_upload_buffer(ctx, ctx->index_buffer, sizeof(u32) * (VkDeviceSize)first_index,
+                               indices, sizeof(u32) * (VkDeviceSize)index_count);
+    }
+    if (res != ENGINE_SUCCESS) {
+        range_free(vertex_ranges, first_vertex, vertex_count);
+        if (indexed) range_free(&ctx->index_ranges, first_index, index_count);
+        return res;
     }
 
-    /* Register mesh slot */
-    MeshHandle handle = (MeshHandle)ctx->mesh_count;
-    ctx->meshes[handle].first_vertex = ctx->vertex_3d_total;
-    ctx->meshes[handle].vertex_count = vertex_count;
-    ctx->meshes[handle].is_3d        = true;
-    ctx->meshes[handle].first_index  = first_index;
-    ctx->meshes[handle].index_count  = index_count;
-    ctx->vertex_3d_total += vertex_count;
-    ctx->mesh_count++;
+    *out_first_vertex = first_vertex;
+    *out_first_index  = first_index;
+    return ENGINE_SUCCESS;
+}
 
-    *out_handle = handle;
+EngineResult vk_upload_mesh_3d_at(VulkanContext *ctx, MeshHandle handle,
+                                  const Vertex3D *vertices, u32 vertex_count,
+                                  const u32 *indices, u32 index_count)
+{
+    /* Vertices and indices are staged into the same batch */
+    const void     *vert_data = vertices;
+    PackedVertex3D *packed    = NULL;
+    if (ctx->packed_vertices) {
+        packed = malloc(sizeof(PackedVertex3D) * vertex_count);
+        if (!packed) return ENGINE_ERROR_OUT_OF_MEMORY;
+        vertex_pack_3d(vertices, vertex_count, packed);
+        vert_data = packed;
+    }
 
-    LOG_INFO("3D mesh %u uploaded: %u vertices, %u indices",
-             handle, vertex_count, index_count);
+    u32 first_vertex, first_index;
+    EngineResult res = upload_mesh_ranges(ctx, &ctx->vertex_3d_ranges, ctx->vertex_buffer_3d,
+                                          vk_vertex_3d_stride(ctx), vert_data, vertex_count,
+                                          indices, index_count, &first_vertex, &first_index);
+    free(packed);   /* copied into staging */
+    if (res != ENGINE_SUCCESS) return res;
+
+    /* Fill the mesh slot */
+    MeshSlot *slot = &ctx->meshes[HANDLE_SLOT(handle)];
+    *slot = (MeshSlot){0};
+    slot->first_vertex = first_vertex;
+    slot->vertex_count = vertex_count;
+    slot->is_3d        = true;
+    slot->first_index  = first_index;
+    slot->index_count  = index_count;
+    slot->lod_count    = (index_count > 0) ? 1 : 0;
+    slot->lods[0]      = (MeshLod){ first_index, index_count };
+    compute_mesh_bounds((const u8 *)vertices + offsetof(Vertex3D, position), sizeof(Vertex3D),
+                        vertex_count, slot);
+    upload_mesh_lods(ctx, vertices, vertex_count, indices, index_count, slot);
+
+    LOG_INFO("3D mesh %u uploaded: %u vertices, %u indices, %u LODs (coarsest %u indices)",
+             HANDLE_SLOT(handle), vertex_count, index_count, slot->lod_count,
+             slot->lod_count ? slot->lods[slot->lod_count - 1].index_count : 0);
     return ENGINE_SUCCESS;
 }
 
@@ -320,15 +833,18 @@ EngineResult vk_upload_mesh_3d(VulkanContext *ctx,
  * ------------------------------------------------------------------------ */
 
 EngineResult vk_create_vertex_buffer_skinned(VulkanContext *ctx, u32 max_vertices) {
-    VkDeviceSize buf_size = sizeof(SkinnedVertex3D) * max_vertices;
+    VkDeviceSize buf_size = (VkDeviceSize)vk_vertex_skinned_stride(ctx) * max_vertices;
 
+    /* Storage usage: the compute skinning pre-pass reads it as an SSBO */
     EngineResult res = vk_create_buffer(ctx, buf_size,
-        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
         &ctx->vertex_buffer_skinned, &ctx->vertex_buffer_skinned_memory);
     if (res != ENGINE_SUCCESS) return res;
 
-    ctx->vertex_skinned_total = 0;
+    res = range_alloc_init(&ctx->vertex_skinned_ranges, max_vertices);
+    if (res != ENGINE_SUCCESS) return res;
 
     LOG_INFO("Skinned vertex buffer created: capacity %u vertices (%llu bytes)",
              max_vertices, (unsigned long long)buf_size);
@@ -344,87 +860,50 @@ EngineResult vk_upload_mesh_skinned(VulkanContext *ctx,
                                      const u32 *indices, u32 index_count,
                                      MeshHandle *out_handle)
 {
-    if (ctx->mesh_count >= MAX_MESHES) {
-        LOG_ERROR("Mesh table full (%u/%u)", ctx->mesh_count, MAX_MESHES);
-        return ENGINE_ERROR_VULKAN_INIT;
-    }
-
-    /* Upload vertices */
-    VkDeviceSize vert_size   = sizeof(SkinnedVertex3D) * vertex_count;
-    VkDeviceSize vert_offset = sizeof(SkinnedVertex3D) * ctx->vertex_skinned_total;
-
-    VkBuffer staging_buf;
-    VkDeviceMemory staging_mem;
-    EngineResult res = vk_create_buffer(ctx, vert_size,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        &staging_buf, &staging_mem);
+    MeshHandle handle;
+    EngineResult res = mesh_reserve(ctx, &handle);
     if (res != ENGINE_SUCCESS) return res;
 
-    void *mapped;
-    vkMapMemory(ctx->device, staging_mem, 0, vert_size, 0, &mapped);
-    memcpy(mapped, vertices, (size_t)vert_size);
-    vkUnmapMemory(ctx->device, staging_mem);
-
-    VkCommandBuffer cmd = vk_begin_single_command(ctx);
-    VkBufferCopy copy_region = {
-        .srcOffset = 0,
-        .dstOffset = vert_offset,
-        .size      = vert_size,
-    };
-    vkCmdCopyBuffer(cmd, staging_buf, ctx->vertex_buffer_skinned, 1, &copy_region);
-    vk_end_single_command(ctx, cmd);
-
-    vkDestroyBuffer(ctx->device, staging_buf, NULL);
-    vkFreeMemory(ctx->device, staging_mem, NULL);
-
-    /* Upload indices (shared index buffer with regular 3D meshes) */
-    u32 first_index = 0;
-    if (indices && index_count > 0) {
-        VkDeviceSize idx_size   = sizeof(u32) * index_count;
-        VkDeviceSize idx_offset = sizeof(u32) * ctx->index_total;
-
-        res = vk_create_buffer(ctx, idx_size,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            &staging_buf, &staging_mem);
-        if (res != ENGINE_SUCCESS) return res;
-
-        vkMapMemory(ctx->device, staging_mem, 0, idx_size, 0, &mapped);
-        memcpy(mapped, indices, (size_t)idx_size);
-        vkUnmapMemory(ctx->device, staging_mem);
-
-        cmd = vk_begin_single_command(ctx);
-        VkBufferCopy idx_copy = {
-            .srcOffset = 0,
-            .dstOffset = idx_offset,
-            .size      = idx_size,
-        };
-        vkCmdCopyBuffer(cmd, staging_buf, ctx->index_buffer, 1, &idx_copy);
-        vk_end_single_command(ctx, cmd);
-
-        vkDestroyBuffer(ctx->device, staging_buf, NULL);
-        vkFreeMemory(ctx->device, staging_mem, NULL);
+    /* Vertices and indices are staged into the same batch */
+    const void            *vert_data = vertices;
+    PackedSkinnedVertex3D *packed    = NULL;
+    if (ctx->packed_vertices) {
+        packed = malloc(sizeof(PackedSkinnedVertex3D) * vertex_count);
+        if (!packed) {
+            mesh_cancel(ctx, handle);
+            return ENGINE_ERROR_OUT_OF_MEMORY;
+        }
+        vertex_pack_skinned(vertices, vertex_count, packed);
+        vert_data = packed;
+    }
 
-        first_index = ctx->index_total;
-        ctx->index_total += index_count;
+    u32 first_vertex, first_index;
+    res = upload_mesh_ranges(ctx, &ctx->vertex_skinned_ranges, ctx->vertex_buffer_skinned,
+                             vk_vertex_skinned_stride(ctx), vert_data, vertex_count,
+                             indices, index_count, &first_vertex, &first_index);
+    free(packed);
+    if (res != ENGINE_SUCCESS) {
+        mesh_cancel(ctx, handle);
+        return res;
     }
 
     /* Register mesh slot */
-    MeshHandle handle = (MeshHandle)ctx->mesh_count;
-    ctx->meshes[handle].first_vertex = ctx->vertex_skinned_total;
-    ctx->meshes[handle].vertex_count = vertex_count;
-    ctx->meshes[handle].is_3d        = true;
-    ctx->meshes[handle].is_skinned   = true;
-    ctx->meshes[handle].first_index  = first_index;
-    ctx->meshes[handle].index_count  = index_count;
-    ctx->vertex_skinned_total += vertex_count;
-    ctx->mesh_count++;
+    MeshSlot *slot = &ctx->meshes[HANDLE_SLOT(handle)];
+    slot->first_vertex = first_vertex;
+    slot->vertex_count = vertex_count;
+    slot->is_3d        = true;
+    slot->is_skinned   = true;
+    slot->first_index  = first_index;
+    slot->index_count  = index_count;
+    slot->lod_count    = (index_count > 0) ? 1 : 0;
+    slot->lods[0]      = (MeshLod){ first_index, index_count };
+    compute_mesh_bounds((const u8 *)vertices + offsetof(SkinnedVertex3D, position),
+                        sizeof(SkinnedVertex3D), vertex_count, slot);
 
     *out_handle = handle;
 
     LOG_INFO("Skinned mesh %u uploaded: %u vertices, %u indices",
-             handle, vertex_count, index_count);
+             HANDLE_SLOT(handle), vertex_count, index_count);
     return ENGINE_SUCCESS;
 }
 
@@ -432,151 +911,67 @@ EngineResult vk_upload_mesh_skinned(VulkanContext *ctx,
  * Texture creation (staging -> GPU-local VkImage)
  * ------------------------------------------------------------------------ */
 
-static void transition_image_layout(VulkanContext *ctx, VkImage image,
-                                     VkImageLayout old_layout, VkImageLayout new_layout)
-{
-    VkCommandBuffer cmd = vk_begin_single_command(ctx);
-
-    VkImageMemoryBarrier barrier = {
-        .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-        .oldLayout           = old_layout,
-        .newLayout           = new_layout,
-        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .image               = image,
-        .subresourceRange    = {
-            .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-            .baseMipLevel   = 0,
-            .levelCount     = 1,
-            .baseArrayLayer = 0,
-            .layerCount     = 1,
-        },
-    };
-
-    VkPipelineStageFlags src_stage, dst_stage;
-
-    if (old_layout == VK_IMAGE_LAYOUT_UNDEFINED &&
-        new_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        src_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-        dst_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-    } else if (old_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL &&
-               new_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-        src_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        dst_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    } else {
-        LOG_ERROR("Unsupported layout transition");
-        vk_end_single_command(ctx, cmd);
-        return;
-    }
-
-    vkCmdPipelineBarrier(cmd, src_stage, dst_stage, 0,
-                          0, NULL, 0, NULL, 1, &barrier);
-
-    vk_end_single_command(ctx, cmd);
+static u32 full_mip_count(u32 width, u32 height) {
+    u32 levels = 1;
+    for (u32 size = ENGINE_MAX(width, height); size > 1; size >>= 1) levels++;
+    return levels;
 }
 
-EngineResult vk_create_texture(VulkanContext *ctx,
-                               const u8 *pixels,
-                               u32 width, u32 height,
-                               VkFormat format,
-                               VkFilter filter,
-                               VulkanTexture *out_tex)
-{
-    u32 pixel_size = (format == VK_FORMAT_R8_UNORM) ? 1 : 4;
-    VkDeviceSize image_size = (VkDeviceSize)width * height * pixel_size;
-
-    /* Staging buffer */
-    VkBuffer staging_buf;
-    VkDeviceMemory staging_mem;
-    EngineResult res = vk_create_buffer(ctx, image_size,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        &staging_buf, &staging_mem);
-    if (res != ENGINE_SUCCESS) return res;
+/* Image + device-local memory. TRANSFER_SRC is added for mip blits. */
+static EngineResult create_texture_image(VulkanContext *ctx, VkFormat format,
+                                         u32 width, u32 height, u32 mip_levels,
+                                         VulkanTexture *out_tex) {
+    memset(out_tex, 0, sizeof(*out_tex));
 
-    void *mapped;
-    vkMapMemory(ctx->device, staging_mem, 0, image_size, 0, &mapped);
-    memcpy(mapped, pixels, (size_t)image_size);
-    vkUnmapMemory(ctx->device, staging_mem);
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    if (mip_levels > 1) usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 
-    /* Create VkImage */
     VkImageCreateInfo image_info = {
         .sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
         .imageType     = VK_IMAGE_TYPE_2D,
         .extent        = { width, height, 1 },
-        .mipLevels     = 1,
+        .mipLevels     = mip_levels,
         .arrayLayers   = 1,
         .format        = format,
         .tiling        = VK_IMAGE_TILING_OPTIMAL,
         .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-        .usage         = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        .usage         = usage,
         .sharingMode   = VK_SHARING_MODE_EXCLUSIVE,
         .samples       = VK_SAMPLE_COUNT_1_BIT,
     };
 
-    if (vkCreateImage(ctx->device, &image_info, NULL, &out_tex->image) != VK_SUCCESS) {
-        LOG_ERROR("Failed to create texture image");
-        vkDestroyBuffer(ctx->device, staging_buf, NULL);
-        vkFreeMemory(ctx->device, staging_mem, NULL);
-        return ENGINE_ERROR_VULKAN_INIT;
+    /* Written by the transfer queue, sampled by graphics */
+    u32 families[2] = { ctx->graphics_family, ctx->transfer_family };
+    if (ctx->upload.concurrent) {
+        image_info.sharingMode           = VK_SHARING_MODE_CONCURRENT;
+        image_info.queueFamilyIndexCount = 2;
+        image_info.pQueueFamilyIndices   = families;
     }
 
-    /* Allocate memory for image */
-    VkMemoryRequirements mem_reqs;
-    vkGetImageMemoryRequirements(ctx->device, out_tex->image, &mem_reqs);
-
-    u32 mem_type = find_memory_type(ctx, mem_reqs.memoryTypeBits,
-                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-    if (mem_type == UINT32_MAX) {
-        vkDestroyImage(ctx->device, out_tex->image, NULL);
-        vkDestroyBuffer(ctx->device, staging_buf, NULL);
-        vkFreeMemory(ctx->device, staging_mem, NULL);
+    if (vkCreateImage(ctx->device, &image_info, NULL, &out_tex->image) != VK_SUCCESS) {
+        LOG_ERROR("Failed to create texture image");
         return ENGINE_ERROR_VULKAN_INIT;
     }
 
-    VkMemoryAllocateInfo alloc_info = {
-        .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .allocationSize  = mem_reqs.size,
-        .memoryTypeIndex = mem_type,
-    };
-
-    if (vkAllocateMemory(ctx->device, &alloc_info, NULL, &out_tex->memory) != VK_SUCCESS) {
+    /* Sub-allocate device-local memory for the image */
+    EngineResult res = vk_memory_alloc_image(ctx, out_tex->image,
+                                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &out_tex->memory);
+    if (res != ENGINE_SUCCESS) {
         vkDestroyImage(ctx->device, out_tex->image, NULL);
-        vkDestroyBuffer(ctx->device, staging_buf, NULL);
-        vkFreeMemory(ctx->device, staging_mem, NULL);
-        return ENGINE_ERROR_OUT_OF_MEMORY;
+        out_tex->image = VK_NULL_HANDLE;
+        return res;
     }
 
-    vkBindImageMemory(ctx->device, out_tex->image, out_tex->memory, 0);
-
-    /* Transition to transfer dst, copy, transition to shader read */
-    transition_image_layout(ctx, out_tex->image,
-        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-
-    VkCommandBuffer cmd = vk_begin_single_command(ctx);
-    VkBufferImageCopy region = {
-        .imageSubresource = {
-            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-            .layerCount = 1,
-        },
-        .imageExtent = { width, height, 1 },
-    };
-    vkCmdCopyBufferToImage(cmd, staging_buf, out_tex->image,
-                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-    vk_end_single_command(ctx, cmd);
-
-    transition_image_layout(ctx, out_tex->image,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-    /* Cleanup staging */
-    vkDestroyBuffer(ctx->device, staging_buf, NULL);
-    vkFreeMemory(ctx->device, staging_mem, NULL);
+    out_tex->width      = width;
+    out_tex->height     = height;
+    out_tex->mip_levels = mip_levels;
+    return ENGINE_SUCCESS;
+}
 
-    /* Image view */
+/* View over every level + sampler. Trilinear for LINEAR; NEAREST (pixel
+ * art) keeps crisp texels and snaps to the nearest level. */
+static EngineResult create_texture_view_sampler(VulkanContext *ctx, VkFormat format,
+                                                VkFilter filter, VulkanTexture *out_tex) {
     VkImageViewCreateInfo view_info = {
         .sType    = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
         .image    = out_tex->image,
@@ -585,7 +980,7 @@ EngineResult vk_create_texture(VulkanContext *ctx,
         .subresourceRange = {
             .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
             .baseMipLevel   = 0,
-            .levelCount     = 1,
+            .levelCount     = out_tex->mip_levels,
             .baseArrayLayer = 0,
             .layerCount     = 1,
         },
@@ -596,7 +991,6 @@ EngineResult vk_create_texture(VulkanContext *ctx,
         return ENGINE_ERROR_VULKAN_INIT;
     }
 
-    /* Sampler — filter passed from caller (NEAREST for pixel art, LINEAR for smooth) */
     VkSamplerMipmapMode mip_mode = (filter == VK_FILTER_NEAREST)
         ? VK_SAMPLER_MIPMAP_MODE_NEAREST
         : VK_SAMPLER_MIPMAP_MODE_LINEAR;
@@ -608,24 +1002,85 @@ EngineResult vk_create_texture(VulkanContext *ctx,
         .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
         .addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
         .mipmapMode   = mip_mode,
+        .minLod       = 0.0f,
+        .maxLod       = (f32)out_tex->mip_levels,
     };
 
     if (vkCreateSampler(ctx->device, &sampler_info, NULL, &out_tex->sampler) != VK_SUCCESS) {
         LOG_ERROR("Failed to create texture sampler");
         return ENGINE_ERROR_VULKAN_INIT;
     }
+    return ENGINE_SUCCESS;
+}
+
+EngineResult vk_create_texture(VulkanContext *ctx,
+                               const u8 *pixels,
+                               u32 width, u32 height,
+                               VkFormat format,
+                               VkFilter filter,
+                               bool mipmaps,
+                               VulkanTexture *out_tex)
+{
+    u32 pixel_size = (format == VK_FORMAT_R8_UNORM) ? 1 : 4;
+    u32 mip_levels = mipmaps ? full_mip_count(width, height) : 1;
+
+    EngineResult res = create_texture_image(ctx, format, width, height, mip_levels, out_tex);
+    if (res != ENGINE_SUCCESS) return res;
+
+    /* Transition, copy (and build the mip chain) in the open upload batch */
+    res = vk_upload_image(ctx, out_tex->image, format, width, height, pixel_size,
+                          mip_levels, pixels);
+    if (res == ENGINE_SUCCESS) res = create_texture_view_sampler(ctx, format, filter, out_tex);
+    if (res != ENGINE_SUCCESS) {
+        /* Copies into the image may sit in the open upload batch or in
+         * batches already submitted when the staging ring filled */
+        vk_upload_wait_idle(ctx);
+        vk_destroy_texture(ctx, out_tex);
+        return res;
+    }
 
-    out_tex->width  = width;
-    out_tex->height = height;
+    LOG_INFO("Texture created: %ux%u, %u mip levels", width, height, mip_levels);
+    return ENGINE_SUCCESS;
+}
+
+EngineResult vk_create_texture_levels(VulkanContext *ctx,
+                                      VkFormat format,
+                                      u32 width, u32 height,
+                                      u32 block_dim, u32 block_bytes,
+                                      u32 level_count, const void *const *levels,
+                                      VkFilter filter,
+                                      VulkanTexture *out_tex)
+{
+    EngineResult res = create_texture_image(ctx, format, width, height, level_count, out_tex);
+    if (res != ENGINE_SUCCESS) return res;
 
-    LOG_INFO("Texture created: %ux%u", width, height);
+    res = vk_upload_image_levels(ctx, out_tex->image, width, height, block_dim, block_bytes,
+                                 level_count, levels);
+    if (res == ENGINE_SUCCESS) res = create_texture_view_sampler(ctx, format, filter, out_tex);
+    if (res != ENGINE_SUCCESS) {
+        /* Copies into the image may sit in the open upload batch or in
+         * batches already submitted when the staging ring filled */
+        vk_upload_wait_idle(ctx);
+        vk_destroy_texture(ctx, out_tex);
+        return res;
+    }
+
+    LOG_INFO("Texture created: %ux%u, %u pre-built levels (format %d)",
+             width, height, level_count, (int)format);
     return ENGINE_SUCCESS;
 }
 
+/* True if the device can sample `format` with optimal tiling */
+bool vk_texture_format_supported(const VulkanContext *ctx, VkFormat format) {
+    VkFormatProperties props;
+    vkGetPhysicalDeviceFormatProperties(ctx->physical_device, format, &props);
+    return (props.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+}
+
 void vk_destroy_texture(VulkanContext *ctx, VulkanTexture *tex) {
     if (tex->sampler)  vkDestroySampler(ctx->device, tex->sampler, NULL);
     if (tex->view)     vkDestroyImageView(ctx->device, tex->view, NULL);
     if (tex->image)    vkDestroyImage(ctx->device, tex->image, NULL);
-    if (tex->memory)   vkFreeMemory(ctx->device, tex->memory, NULL);
+    vk_memory_free(ctx, &tex->memory);
     memset(tex, 0, sizeof(*tex));
 }
@@ -4,13 +4,71 @@
 #include "renderer/vk_types.h"
 #include "core/common.h"
 
-/* Create a Vulkan buffer + device memory allocation. */
+/* Set up the GPU memory sub-allocator. Call right after logical device
+ * creation, before any buffer or image is created. */
+EngineResult vk_memory_init(VulkanContext *ctx);
+
+/* Free every remaining memory block. Call just before vkDestroyDevice. */
+void vk_memory_shutdown(VulkanContext *ctx);
+
+/* Sub-allocate memory satisfying `reqs`. optimal_image selects blocks for
+ * optimal-tiling images; buffers and linear images pass false. */
+EngineResult vk_memory_alloc(VulkanContext *ctx, const VkMemoryRequirements *reqs,
+                             VkMemoryPropertyFlags props, bool optimal_image,
+                             GpuAllocation *out);
+
+/* Return an allocation to its block. Safe to call on a zeroed allocation. */
+void vk_memory_free(VulkanContext *ctx, GpuAllocation *alloc);
+
+/* True if some memory type in `type_filter` has all of `props`. Quiet probe
+ * for optional properties such as LAZILY_ALLOCATED. */
+bool vk_memory_type_available(const VulkanContext *ctx, u32 type_filter,
+                              VkMemoryPropertyFlags props);
+
+/* Allocate and bind memory for an optimal-tiling image. */
+EngineResult vk_memory_alloc_image(VulkanContext *ctx, VkImage image,
+                                   VkMemoryPropertyFlags props, GpuAllocation *out);
+
+/* Snapshot allocator usage (blocks, bytes, fragmentation, per-heap totals). */
+void vk_memory_get_stats(const VulkanContext *ctx, GpuMemoryStats *out);
+void vk_memory_log_stats(const VulkanContext *ctx);
+
+/* Create a Vulkan buffer backed by a sub-allocated memory range. Host-visible
+ * buffers come back persistently mapped through out_memory->mapped. */
 EngineResult vk_create_buffer(VulkanContext *ctx,
                               VkDeviceSize size,
                               VkBufferUsageFlags usage,
                               VkMemoryPropertyFlags mem_props,
                               VkBuffer *out_buffer,
-                              VkDeviceMemory *out_memory);
+                              GpuAllocation *out_memory);
+
+/* Destroy a buffer and free its memory range. Safe on null handles. */
+void vk_destroy_buffer(VulkanContext *ctx, VkBuffer *buffer, GpuAllocation *memory);
+
+/* Create a per-frame ring: one host-visible, persistently mapped buffer holding
+ * frames_in_flight regions of at least frame_size bytes each. Region size
+ * is rounded up to the device's storage/uniform offset alignment so the
+ * offsets are valid for dynamic descriptors as well as vertex bindings. */
+EngineResult vk_create_frame_ring(VulkanContext *ctx,
+                                  VkDeviceSize frame_size,
+                                  VkBufferUsageFlags usage,
+                                  FrameRing *out_ring);
+
+/* Unmap and destroy a frame ring. Safe to call on a zeroed ring. */
+void vk_destroy_frame_ring(VulkanContext *ctx, FrameRing *ring);
+
+/* Replace `ring` with a new ring of at least min_frame_size bytes per region,
+ * keeping the current frame slot and copying the first keep_bytes written to
+ * it. The previous ring is returned in *out_old; the caller must keep it alive
+ * until no in-flight frame references it. */
+EngineResult vk_frame_ring_grow(VulkanContext *ctx, FrameRing *ring,
+                                VkDeviceSize min_frame_size,
+                                VkDeviceSize keep_bytes,
+                                FrameRing *out_old);
+
+/* Select the region owned by frame slot `frame`. Call after that slot's
+ * in_flight fence has signaled, before writing any data for the frame. */
+void vk_frame_ring_begin(FrameRing *ring, u32 frame);
 
 /* Pre-allocate a shared vertex buffer on the GPU. Call once at init. */
 EngineResult vk_create_vertex_buffer(VulkanContext *ctx, u32 max_vertices);
@@ -21,33 +79,69 @@ EngineResult vk_upload_mesh(VulkanContext *ctx,
                             MeshHandle *out_handle);
 
 /* Create a texture from raw pixel data (R8 single-channel or RGBA).
- * filter: VK_FILTER_NEAREST for pixel art, VK_FILTER_LINEAR for smooth. */
+ * filter: VK_FILTER_NEAREST for pixel art, VK_FILTER_LINEAR for smooth.
+ * mipmaps: generate the full mip chain at upload. */
 EngineResult vk_create_texture(VulkanContext *ctx,
                                const u8 *pixels,
                                u32 width, u32 height,
                                VkFormat format,
                                VkFilter filter,
+                               bool mipmaps,
                                VulkanTexture *out_tex);
 
+/* Create a texture from pre-built levels in any sampled format, e.g. BC7 or
+ * ASTC from a DDS/KTX2 file (see vk_upload_image_levels for the layout). */
+EngineResult vk_create_texture_levels(VulkanContext *ctx,
+                                      VkFormat format,
+                                      u32 width, u32 height,
+                                      u32 block_dim, u32 block_bytes,
+                                      u32 level_count, const void *const *levels,
+                                      VkFilter filter,
+                                      VulkanTexture *out_tex);
+
+/* True if the device can sample `format` with optimal tiling */
+bool vk_texture_format_supported(const VulkanContext *ctx, VkFormat format);
+
 /* Destroy a texture and free its resources. */
 void vk_destroy_texture(VulkanContext *ctx, VulkanTexture *tex);
 
+/* Bytes per vertex in the 3D / skinned vertex buffers (packed or f32) */
+u32 vk_vertex_3d_stride(const VulkanContext *ctx);
+u32 vk_vertex_skinned_stride(const VulkanContext *ctx);
+
+/* Bytes per instance in the 3D / skinned instance rings (ctx->instance_format_3d) */
+u32 vk_instance_3d_stride(const VulkanContext *ctx);
+
+/* Convert InstanceData3D into that format (the rotation is resolved here,
+ * once per instance) */
+void vk_write_instances_3d(const VulkanContext *ctx, void *dst,
+                           const InstanceData3D *src, u32 count);
+
 /* 3D vertex buffer (GPU-local, separate from 2D). */
 EngineResult vk_create_vertex_buffer_3d(VulkanContext *ctx, u32 max_vertices);
 
 /* Shared index buffer (GPU-local). */
 EngineResult vk_create_index_buffer(VulkanContext *ctx, u32 max_indices);
 
-/* Upload a 3D mesh (vertices + optional indices). */
+/* Upload a 3D mesh (vertices + optional indices). Packs the vertices when
+ * ctx->packed_vertices is set. */
 EngineResult vk_upload_mesh_3d(VulkanContext *ctx,
                                const Vertex3D *vertices, u32 vertex_count,
                                const u32 *indices, u32 index_count,
                                MeshHandle *out_handle);
 
+/* Same, into a slot the caller already reserved with mesh_reserve (async
+ * loads hand out the handle before the geometry exists). Overwrites the
+ * whole slot. */
+EngineResult vk_upload_mesh_3d_at(VulkanContext *ctx, MeshHandle handle,
+                                  const Vertex3D *vertices, u32 vertex_count,
+                                  const u32 *indices, u32 index_count);
+
 /* Skinned vertex buffer (GPU-local, separate from regular 3D). */
 EngineResult vk_create_vertex_buffer_skinned(VulkanContext *ctx, u32 max_vertices);
 
-/* Upload a skinned 3D mesh (SkinnedVertex3D + indices). */
+/* Upload a skinned 3D mesh (SkinnedVertex3D + indices), packed like
+ * vk_upload_mesh_3d. */
 EngineResult vk_upload_mesh_skinned(VulkanContext *ctx,
                                      const SkinnedVertex3D *vertices, u32 vertex_count,
                                      const u32 *indices, u32 index_count,
@@ -1,4 +1,5 @@
 #include "renderer/vk_init.h"
+#include "renderer/vk_buffer.h"
 #include "platform/window.h"
 #include "core/log.h"
 
@@ -78,8 +79,12 @@ static bool check_validation_layer_support(void) {
 typedef struct {
     u32  graphics;
     u32  present;
+    u32  transfer;      /* transfer-only family (DMA engine), if any */
+    u32  compute;       /* compute family without graphics (async compute), if any */
     bool has_graphics;
     bool has_present;
+    bool has_transfer;
+    bool has_compute;
 } QueueFamilyIndices;
 
 static QueueFamilyIndices find_queue_families(VkPhysicalDevice device, VkSurfaceKHR surface) {
@@ -106,6 +111,29 @@ static QueueFamilyIndices find_queue_families(VkPhysicalDevice device, VkSurface
         if (indices.has_graphics && indices.has_present) break;
     }
 
+    /* A family with transfer but neither graphics nor compute is usually a
+     * dedicated copy engine that can run uploads alongside rendering */
+    for (u32 i = 0; i < count; i++) {
+        VkQueueFlags flags = families[i].queueFlags;
+        if ((flags & VK_QUEUE_TRANSFER_BIT) &&
+            !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+            indices.transfer = i;
+            indices.has_transfer = true;
+            break;
+        }
+    }
+
+    /* Likewise a compute family without graphics runs dispatches next to
+     * the graphics queue's work */
+    for (u32 i = 0; i < count; i++) {
+        VkQueueFlags flags = families[i].queueFlags;
+        if ((flags & VK_QUEUE_COMPUTE_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT)) {
+            indices.compute = i;
+            indices.has_compute = true;
+            break;
+        }
+    }
+
     free(families);
     return indices;
 }
@@ -158,23 +186,48 @@ static VkSurfaceFormatKHR choose_surface_format(const SwapchainSupport *support)
     return support->formats[0];
 }
 
-static VkPresentModeKHR choose_present_mode(const SwapchainSupport *support) {
-    /* Prefer IMMEDIATE (no VSync, uncapped FPS) for benchmarking.
-     * Fall back to MAILBOX (triple-buffered VSync), then FIFO (VSync). */
+static bool has_present_mode(const SwapchainSupport *support, VkPresentModeKHR mode) {
     for (u32 i = 0; i < support->present_mode_count; i++) {
-        if (support->present_modes[i] == VK_PRESENT_MODE_IMMEDIATE_KHR) {
-            LOG_INFO("Present mode: IMMEDIATE (VSync off)");
-            return VK_PRESENT_MODE_IMMEDIATE_KHR;
-        }
+        if (support->present_modes[i] == mode) return true;
     }
-    for (u32 i = 0; i < support->present_mode_count; i++) {
-        if (support->present_modes[i] == VK_PRESENT_MODE_MAILBOX_KHR) {
-            LOG_INFO("Present mode: MAILBOX (triple-buffered VSync)");
-            return VK_PRESENT_MODE_MAILBOX_KHR;
+    return false;
+}
+
+static const char *present_mode_name(VkPresentModeKHR mode) {
+    switch (mode) {
+    case VK_PRESENT_MODE_IMMEDIATE_KHR:    return "IMMEDIATE (VSync off)";
+    case VK_PRESENT_MODE_MAILBOX_KHR:      return "MAILBOX (triple-buffered VSync)";
+    case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "FIFO_RELAXED (adaptive VSync)";
+    default:                               return "FIFO (VSync)";
+    }
+}
+
+static VkPresentModeKHR choose_present_mode(const SwapchainSupport *support, PresentMode request) {
+    static const VkPresentModeKHR requested_modes[] = {
+        [PRESENT_MODE_FIFO]         = VK_PRESENT_MODE_FIFO_KHR,
+        [PRESENT_MODE_FIFO_RELAXED] = VK_PRESENT_MODE_FIFO_RELAXED_KHR,
+        [PRESENT_MODE_MAILBOX]      = VK_PRESENT_MODE_MAILBOX_KHR,
+        [PRESENT_MODE_IMMEDIATE]    = VK_PRESENT_MODE_IMMEDIATE_KHR,
+    };
+
+    VkPresentModeKHR mode = VK_PRESENT_MODE_FIFO_KHR; /* guaranteed available */
+    if (request != PRESENT_MODE_DEFAULT && (u32)request < ENGINE_ARRAY_LEN(requested_modes)) {
+        /* Exactly what was asked for, else FIFO */
+        if (has_present_mode(support, requested_modes[request])) {
+            mode = requested_modes[request];
+        } else {
+            LOG_WARN("Present mode %s not supported, falling back to FIFO",
+                     present_mode_name(requested_modes[request]));
         }
+    } else if (has_present_mode(support, VK_PRESENT_MODE_IMMEDIATE_KHR)) {
+        /* Default: uncapped for benchmarking, then triple-buffered VSync */
+        mode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+    } else if (has_present_mode(support, VK_PRESENT_MODE_MAILBOX_KHR)) {
+        mode = VK_PRESENT_MODE_MAILBOX_KHR;
     }
-    LOG_INFO("Present mode: FIFO (VSync)");
-    return VK_PRESENT_MODE_FIFO_KHR; /* guaranteed available */
+
+    LOG_INFO("Present mode: %s", present_mode_name(mode));
+    return mode;
 }
 
 static VkExtent2D choose_extent(const VkSurfaceCapabilitiesKHR *caps, i32 width, i32 height) {
@@ -380,15 +433,15 @@ EngineResult vk_pick_physical_device(VulkanContext *ctx) {
     return ENGINE_SUCCESS;
 }
 
-#ifdef __APPLE__
-static bool device_supports_portability_subset(VkPhysicalDevice device) {
+static bool device_supports_extension(VkPhysicalDevice device, const char *name) {
     u32 count;
     vkEnumerateDeviceExtensionProperties(device, NULL, &count, NULL);
     VkExtensionProperties *props = malloc(sizeof(VkExtensionProperties) * count);
+    if (!props) return false;
     vkEnumerateDeviceExtensionProperties(device, NULL, &count, props);
     bool found = false;
     for (u32 i = 0; i < count; i++) {
-        if (strcmp(props[i].extensionName, "VK_KHR_portability_subset") == 0) {
+        if (strcmp(props[i].extensionName, name) == 0) {
             found = true;
             break;
         }
@@ -396,7 +449,6 @@ static bool device_supports_portability_subset(VkPhysicalDevice device) {
     free(props);
     return found;
 }
-#endif
 
 EngineResult vk_create_logical_device(VulkanContext *ctx) {
     QueueFamilyIndices indices = find_queue_families(ctx->physical_device, ctx->surface);
@@ -404,11 +456,17 @@ EngineResult vk_create_logical_device(VulkanContext *ctx) {
     ctx->present_family  = indices.present;
 
     /* Unique queue families */
-    u32 unique_families[2] = { indices.graphics, indices.present };
+    u32 unique_families[4] = { indices.graphics, indices.present };
     u32 unique_count = (indices.graphics == indices.present) ? 1 : 2;
+    if (indices.has_transfer) {
+        unique_families[unique_count++] = indices.transfer;
+    }
+    if (indices.has_compute && indices.compute != indices.present) {
+        unique_families[unique_count++] = indices.compute;
+    }
 
     float priority = 1.0f;
-    VkDeviceQueueCreateInfo queue_infos[2];
+    VkDeviceQueueCreateInfo queue_infos[4];
     for (u32 i = 0; i < unique_count; i++) {
         queue_infos[i] = (VkDeviceQueueCreateInfo){
             .sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
@@ -418,14 +476,144 @@ EngineResult vk_create_logical_device(VulkanContext *ctx) {
         };
     }
 
+    /* Indirect drawing needs a non-zero firstInstance in each record to reach
+     * per-draw instance data; multiDrawIndirect lets one call issue many. */
+    VkPhysicalDeviceFeatures supported;
+    vkGetPhysicalDeviceFeatures(ctx->physical_device, &supported);
+
     VkPhysicalDeviceFeatures features = {0};
 
-    /* Build device extension list — base + optional portability subset */
-    const char *enabled_exts[4];
+    /* The bindless texture table is indexed by a push constant (dynamically
+     * uniform), which only needs this core feature */
+    if (supported.shaderSampledImageArrayDynamicIndexing) {
+        features.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+    } else {
+        LOG_WARN("shaderSampledImageArrayDynamicIndexing not supported; texture table indexing is undefined");
+    }
+
+    if (supported.multiDrawIndirect && supported.drawIndirectFirstInstance) {
+        features.multiDrawIndirect         = VK_TRUE;
+        features.drawIndirectFirstInstance = VK_TRUE;
+
+        VkPhysicalDeviceProperties props;
+        vkGetPhysicalDeviceProperties(ctx->physical_device, &props);
+        ctx->multi_draw_indirect     = true;
+        ctx->max_draw_indirect_count = props.limits.maxDrawIndirectCount;
+    } else {
+        LOG_INFO("multiDrawIndirect not supported, using direct draws");
+    }
+
+    /* Timeline semaphores (core in 1.2) let uploads signal completion without
+     * blocking the CPU; without them uploads fall back to waiting per batch */
+    VkPhysicalDeviceProperties dev_props;
+    vkGetPhysicalDeviceProperties(ctx->physical_device, &dev_props);
+
+    VkPhysicalDeviceVulkan12Features features12 = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+    };
+    VkPhysicalDevicePresentWaitFeaturesKHR present_wait_features = {
+        .sType       = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR,
+        .presentWait = VK_TRUE,
+    };
+    VkPhysicalDevicePresentIdFeaturesKHR present_id_features = {
+        .sType     = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR,
+        .pNext     = &present_wait_features,
+        .presentId = VK_TRUE,
+    };
+    bool present_pacing = false;
+    if (dev_props.apiVersion >= VK_API_VERSION_1_2) {
+        VkPhysicalDeviceVulkan12Features supported12 = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+        };
+        VkPhysicalDeviceFeatures2 supported2 = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = &supported12,
+        };
+        vkGetPhysicalDeviceFeatures2(ctx->physical_device, &supported2);
+        if (supported12.timelineSemaphore) {
+            features12.timelineSemaphore = VK_TRUE;
+            ctx->timeline_semaphores = true;
+        }
+
+        /* Present wait (VK_KHR_present_id + VK_KHR_present_wait) lets frame
+         * pacing block until a given present is on screen; only asked for
+         * with RendererConfig.present_wait */
+        if (ctx->pacing.present_wait &&
+            device_supports_extension(ctx->physical_device, VK_KHR_PRESENT_ID_EXTENSION_NAME) &&
+            device_supports_extension(ctx->physical_device, VK_KHR_PRESENT_WAIT_EXTENSION_NAME)) {
+            VkPhysicalDevicePresentWaitFeaturesKHR wait_supported = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR,
+            };
+            VkPhysicalDevicePresentIdFeaturesKHR id_supported = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR,
+                .pNext = &wait_supported,
+            };
+            VkPhysicalDeviceFeatures2 pacing2 = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+                .pNext = &id_supported,
+            };
+            vkGetPhysicalDeviceFeatures2(ctx->physical_device, &pacing2);
+            present_pacing = id_supported.presentId && wait_supported.presentWait;
+        }
+
+        /* Descriptor indexing (VK_EXT_descriptor_indexing, core in 1.2):
+         * lets the shared texture table take new textures while bound and
+         * raises the sampler limits */
+        if (supported12.descriptorBindingSampledImageUpdateAfterBind &&
+            supported12.descriptorBindingPartiallyBound &&
+            supported12.descriptorBindingUpdateUnusedWhilePending) {
+            features12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+            features12.descriptorBindingPartiallyBound              = VK_TRUE;
+            features12.descriptorBindingUpdateUnusedWhilePending    = VK_TRUE;
+            ctx->texture_update_after_bind = true;
+        }
+    }
+
+    /* Texture table size: slot 0 (dummy) + MAX_TEXTURES, within the
+     * per-stage and per-set limits that apply to the chosen mode */
+    u32 sampler_limit;
+    if (ctx->texture_update_after_bind) {
+        VkPhysicalDeviceVulkan12Properties props12 = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES,
+        };
+        VkPhysicalDeviceProperties2 props2 = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+            .pNext = &props12,
+        };
+        vkGetPhysicalDeviceProperties2(ctx->physical_device, &props2);
+        sampler_limit = ENGINE_MIN(
+            ENGINE_MIN(props12.maxPerStageDescriptorUpdateAfterBindSamplers,
+                       props12.maxPerStageDescriptorUpdateAfterBindSampledImages),
+            ENGINE_MIN(props12.maxDescriptorSetUpdateAfterBindSamplers,
+                       props12.maxDescriptorSetUpdateAfterBindSampledImages));
+    } else {
+        const VkPhysicalDeviceLimits *lim = &dev_props.limits;
+        sampler_limit = ENGINE_MIN(
+            ENGINE_MIN(lim->maxPerStageDescriptorSamplers, lim->maxPerStageDescriptorSampledImages),
+            ENGINE_MIN(lim->maxDescriptorSetSamplers, lim->maxDescriptorSetSampledImages));
+    }
+    ctx->texture_slots = ENGINE_MIN(sampler_limit, (u32)MAX_TEXTURES + 1);
+    LOG_INFO("Texture table: %u slots (%s)", ctx->texture_slots,
+             ctx->texture_update_after_bind ? "update-after-bind" : "per-frame sets");
+
+    /* Build device extension list — base + present pacing + memory budget +
+     * optional portability subset */
+    const char *enabled_exts[5];
     u32 enabled_ext_count = 0;
     enabled_exts[enabled_ext_count++] = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
+    if (present_pacing) {
+        enabled_exts[enabled_ext_count++] = VK_KHR_PRESENT_ID_EXTENSION_NAME;
+        enabled_exts[enabled_ext_count++] = VK_KHR_PRESENT_WAIT_EXTENSION_NAME;
+        features12.pNext = &present_id_features;
+    }
+    /* Heap budgets for renderer_get_stats; the query is core in 1.1 */
+    if (dev_props.apiVersion >= VK_API_VERSION_1_1 &&
+        device_supports_extension(ctx->physical_device, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)) {
+        enabled_exts[enabled_ext_count++] = VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+        ctx->memory_budget = true;
+    }
 #ifdef __APPLE__
-    if (device_supports_portability_subset(ctx->physical_device)) {
+    if (device_supports_extension(ctx->physical_device, "VK_KHR_portability_subset")) {
         enabled_exts[enabled_ext_count++] = "VK_KHR_portability_subset";
         LOG_INFO("Enabling VK_KHR_portability_subset (MoltenVK)");
     }
@@ -433,6 +621,7 @@ EngineResult vk_create_logical_device(VulkanContext *ctx) {
 
     VkDeviceCreateInfo create_info = {
         .sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+        .pNext                   = (dev_props.apiVersion >= VK_API_VERSION_1_2) ? &features12 : NULL,
         .queueCreateInfoCount    = unique_count,
         .pQueueCreateInfos       = queue_infos,
         .pEnabledFeatures        = &features,
@@ -450,6 +639,28 @@ EngineResult vk_create_logical_device(VulkanContext *ctx) {
     vkGetDeviceQueue(ctx->device, indices.graphics, 0, &ctx->graphics_queue);
     vkGetDeviceQueue(ctx->device, indices.present,  0, &ctx->present_queue);
 
+    if (present_pacing) {
+        ctx->pacing.wait_for_present = (PFN_vkWaitForPresentKHR)
+            vkGetDeviceProcAddr(ctx->device, "vkWaitForPresentKHR");
+    }
+    if (ctx->pacing.present_wait) {
+        ctx->pacing.present_wait = ctx->pacing.wait_for_present != NULL;
+        LOG_INFO("Present wait: %s", ctx->pacing.present_wait ? "enabled" : "not supported");
+    }
+
+    if (indices.has_transfer) {
+        ctx->transfer_family = indices.transfer;
+        ctx->has_transfer_queue = true;
+        vkGetDeviceQueue(ctx->device, indices.transfer, 0, &ctx->transfer_queue);
+        LOG_INFO("Using dedicated transfer queue family %u", indices.transfer);
+    }
+
+    if (indices.has_compute) {
+        ctx->compute_family = indices.compute;
+        ctx->has_compute_queue = true;
+        vkGetDeviceQueue(ctx->device, indices.compute, 0, &ctx->compute_queue);
+    }
+
     LOG_INFO("Vulkan logical device created");
     return ENGINE_SUCCESS;
 }
@@ -458,7 +669,7 @@ EngineResult vk_create_swapchain(VulkanContext *ctx, i32 width, i32 height) {
     SwapchainSupport support = query_swapchain_support(ctx->physical_device, ctx->surface);
 
     VkSurfaceFormatKHR format = choose_surface_format(&support);
-    VkPresentModeKHR   mode   = choose_present_mode(&support);
+    VkPresentModeKHR   mode   = choose_present_mode(&support, ctx->present_mode_request);
     VkExtent2D         extent = choose_extent(&support.capabilities, width, height);
 
     u32 image_count = support.capabilities.minImageCount + 1;
@@ -508,6 +719,7 @@ EngineResult vk_create_swapchain(VulkanContext *ctx, i32 width, i32 height) {
 
     ctx->swapchain_format = format.format;
     ctx->swapchain_extent = extent;
+    ctx->present_mode     = mode;
 
     free_swapchain_support(&support);
     LOG_INFO("Swapchain created: %ux%u, %u images", extent.width, extent.height, ctx->swapchain_image_count);
@@ -553,25 +765,13 @@ EngineResult vk_create_image_views(VulkanContext *ctx) {
  * Depth buffer
  * ------------------------------------------------------------------------ */
 
-static u32 find_memory_type_init(VulkanContext *ctx, u32 type_filter, VkMemoryPropertyFlags props) {
-    VkPhysicalDeviceMemoryProperties mem_props;
-    vkGetPhysicalDeviceMemoryProperties(ctx->physical_device, &mem_props);
-
-    for (u32 i = 0; i < mem_props.memoryTypeCount; i++) {
-        if ((type_filter & (1 << i)) &&
-            (mem_props.memoryTypes[i].propertyFlags & props) == props) {
-            return i;
-        }
-    }
-
-    LOG_FATAL("Failed to find suitable memory type");
-    return UINT32_MAX;
-}
-
 EngineResult vk_create_depth_resources(VulkanContext *ctx) {
     VkFormat depth_format = VK_FORMAT_D32_SFLOAT;
 
-    /* Create depth image */
+    /* Create depth image. Depth is cleared on load and never stored or read
+     * after its pass, so it is a transient attachment: on tilers it can live
+     * in tile memory only. The bloom scene pass renders into this same
+     * image. */
     VkImageCreateInfo image_info = {
         .sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
         .imageType     = VK_IMAGE_TYPE_2D,
@@ -581,7 +781,8 @@ EngineResult vk_create_depth_resources(VulkanContext *ctx) {
         .format        = depth_format,
         .tiling        = VK_IMAGE_TILING_OPTIMAL,
         .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-        .usage         = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+        .usage         = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
+                         VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
         .sharingMode   = VK_SHARING_MODE_EXCLUSIVE,
         .samples       = VK_SAMPLE_COUNT_1_BIT,
     };
@@ -591,31 +792,22 @@ EngineResult vk_create_depth_resources(VulkanContext *ctx) {
         return ENGINE_ERROR_VULKAN_INIT;
     }
 
-    /* Allocate device-local memory */
+    /* Lazily allocated memory where the device has it (tile-based GPUs),
+     * plain device-local otherwise */
     VkMemoryRequirements mem_reqs;
     vkGetImageMemoryRequirements(ctx->device, ctx->depth_image, &mem_reqs);
+    VkMemoryPropertyFlags mem_props = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    bool lazy = vk_memory_type_available(ctx, mem_reqs.memoryTypeBits,
+                                         VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+    if (lazy) mem_props = VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
 
-    u32 mem_type = find_memory_type_init(ctx, mem_reqs.memoryTypeBits,
-                                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-    if (mem_type == UINT32_MAX) {
-        vkDestroyImage(ctx->device, ctx->depth_image, NULL);
-        return ENGINE_ERROR_VULKAN_INIT;
-    }
-
-    VkMemoryAllocateInfo alloc_info = {
-        .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .allocationSize  = mem_reqs.size,
-        .memoryTypeIndex = mem_type,
-    };
-
-    if (vkAllocateMemory(ctx->device, &alloc_info, NULL, &ctx->depth_memory) != VK_SUCCESS) {
+    EngineResult res = vk_memory_alloc_image(ctx, ctx->depth_image, mem_props, &ctx->depth_memory);
+    if (res != ENGINE_SUCCESS) {
         LOG_FATAL("Failed to allocate depth image memory");
         vkDestroyImage(ctx->device, ctx->depth_image, NULL);
-        return ENGINE_ERROR_OUT_OF_MEMORY;
+        return res;
     }
 
-    vkBindImageMemory(ctx->device, ctx->depth_image, ctx->depth_memory, 0);
-
     /* Create image view */
     VkImageViewCreateInfo view_info = {
         .sType    = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
@@ -636,8 +828,9 @@ EngineResult vk_create_depth_resources(VulkanContext *ctx) {
         return ENGINE_ERROR_VULKAN_INIT;
     }
 
-    LOG_INFO("Depth buffer created: %ux%u (D32_SFLOAT)",
-             ctx->swapchain_extent.width, ctx->swapchain_extent.height);
+    LOG_INFO("Depth buffer created: %ux%u (D32_SFLOAT, transient%s)",
+             ctx->swapchain_extent.width, ctx->swapchain_extent.height,
+             lazy ? ", lazily allocated" : "");
     return ENGINE_SUCCESS;
 }
 
@@ -696,7 +889,7 @@ EngineResult vk_create_command_buffers(VulkanContext *ctx) {
         .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
         .commandPool        = ctx->command_pool,
         .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-        .commandBufferCount = MAX_FRAMES_IN_FLIGHT,
+        .commandBufferCount = ctx->frames_in_flight,
     };
 
     if (vkAllocateCommandBuffers(ctx->device, &alloc_info, ctx->command_buffers) != VK_SUCCESS) {
@@ -704,7 +897,7 @@ EngineResult vk_create_command_buffers(VulkanContext *ctx) {
         return ENGINE_ERROR_VULKAN_INIT;
     }
 
-    LOG_DEBUG("Allocated %d command buffers", MAX_FRAMES_IN_FLIGHT);
+    LOG_DEBUG("Allocated %u command buffers", ctx->frames_in_flight);
     return ENGINE_SUCCESS;
 }
 
@@ -718,7 +911,7 @@ EngineResult vk_create_sync_objects(VulkanContext *ctx) {
         .flags = VK_FENCE_CREATE_SIGNALED_BIT, /* start signaled so first frame doesn't hang */
     };
 
-    for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+    for (u32 i = 0; i < ctx->frames_in_flight; i++) {
         if (vkCreateSemaphore(ctx->device, &sem_info, NULL, &ctx->image_available[i]) != VK_SUCCESS ||
             vkCreateSemaphore(ctx->device, &sem_info, NULL, &ctx->render_finished[i]) != VK_SUCCESS ||
             vkCreateFence(ctx->device, &fence_info, NULL, &ctx->in_flight[i]) != VK_SUCCESS) {
@@ -728,7 +921,7 @@ EngineResult vk_create_sync_objects(VulkanContext *ctx) {
     }
 
     ctx->current_frame = 0;
-    LOG_DEBUG("Sync objects created (%d frames in flight)", MAX_FRAMES_IN_FLIGHT);
+    LOG_DEBUG("Sync objects created (%u frames in flight)", ctx->frames_in_flight);
     return ENGINE_SUCCESS;
 }
 
@@ -752,10 +945,7 @@ void vk_cleanup_swapchain(VulkanContext *ctx) {
         vkDestroyImage(ctx->device, ctx->depth_image, NULL);
         ctx->depth_image = VK_NULL_HANDLE;
     }
-    if (ctx->depth_memory) {
-        vkFreeMemory(ctx->device, ctx->depth_memory, NULL);
-        ctx->depth_memory = VK_NULL_HANDLE;
-    }
+    vk_memory_free(ctx, &ctx->depth_memory);
 
     for (u32 i = 0; i < ctx->swapchain_image_count; i++) {
         vkDestroyImageView(ctx->device, ctx->swapchain_image_views[i], NULL);
@@ -773,7 +963,7 @@ void vk_cleanup_swapchain(VulkanContext *ctx) {
 void vk_destroy(VulkanContext *ctx) {
     vkDeviceWaitIdle(ctx->device);
 
-    for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+    for (u32 i = 0; i < ctx->frames_in_flight; i++) {
         vkDestroySemaphore(ctx->device, ctx->image_available[i], NULL);
         vkDestroySemaphore(ctx->device, ctx->render_finished[i], NULL);
         vkDestroyFence(ctx->device, ctx->in_flight[i], NULL);
@@ -783,10 +973,7 @@ void vk_destroy(VulkanContext *ctx) {
 
     vk_cleanup_swapchain(ctx);
 
-    if (ctx->vertex_buffer) {
-        vkDestroyBuffer(ctx->device, ctx->vertex_buffer, NULL);
-        vkFreeMemory(ctx->device, ctx->vertex_buffer_memory, NULL);
-    }
+    vk_destroy_buffer(ctx, &ctx->vertex_buffer, &ctx->vertex_buffer_memory);
 
     vkDestroyPipeline(ctx->device, ctx->graphics_pipeline, NULL);
     vkDestroyPipelineLayout(ctx->device, ctx->pipeline_layout, NULL);
@@ -810,7 +997,12 @@ void vk_destroy(VulkanContext *ctx) {
     }
 
     vkDestroyRenderPass(ctx->device, ctx->render_pass, NULL);
+    if (ctx->pipeline_cache) {
+        vkDestroyPipelineCache(ctx->device, ctx->pipeline_cache, NULL);
+    }
 
+    vk_memory_log_stats(ctx);
+    vk_memory_shutdown(ctx);
     vkDestroyDevice(ctx->device, NULL);
 
 #ifdef ENGINE_DEBUG
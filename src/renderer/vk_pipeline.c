@@ -1,9 +1,11 @@
 #include "renderer/vk_pipeline.h"
+#include "renderer/vk_buffer.h"
 #include "core/log.h"
 
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 /* --------------------------------------------------------------------------
  * Shader module loading
@@ -48,6 +50,156 @@ VkShaderModule vk_create_shader_module(VkDevice device, const u8 *code, size_t s
     return module;
 }
 
+/* --------------------------------------------------------------------------
+ * Pipeline cache
+ * ------------------------------------------------------------------------ */
+
+#define PIPELINE_CACHE_MAGIC   0x43505645u /* "EVPC" */
+#define PIPELINE_CACHE_VERSION 1u
+
+/* Our own header in front of the driver blob. The driver validates its blob
+ * too, but not every driver does so robustly, and it knows nothing about the
+ * driver version it was produced by. */
+typedef struct {
+    u32 magic;
+    u32 version;
+    u32 vendor_id;
+    u32 device_id;
+    u32 driver_version;
+    u8  cache_uuid[VK_UUID_SIZE];
+    u64 data_size;
+    u64 data_hash;
+} PipelineCacheFileHeader;
+
+static u64 hash_bytes(const u8 *data, size_t size) {
+    u64 h = 14695981039346656037ull; /* FNV-1a */
+    for (size_t i = 0; i < size; i++) {
+        h ^= data[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+static void fill_cache_header(const VulkanContext *ctx, PipelineCacheFileHeader *hdr) {
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(ctx->physical_device, &props);
+
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->magic          = PIPELINE_CACHE_MAGIC;
+    hdr->version        = PIPELINE_CACHE_VERSION;
+    hdr->vendor_id      = props.vendorID;
+    hdr->device_id      = props.deviceID;
+    hdr->driver_version = props.driverVersion;
+    memcpy(hdr->cache_uuid, props.pipelineCacheUUID, VK_UUID_SIZE);
+}
+
+/* Read and validate a cache file. Returns the driver blob or NULL. */
+static u8 *load_cache_blob(const VulkanContext *ctx, const char *path, size_t *out_size) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL; /* first launch */
+
+    PipelineCacheFileHeader hdr, expected;
+    fill_cache_header(ctx, &expected);
+
+    u8 *blob = NULL;
+    if (fread(&hdr, sizeof(hdr), 1, f) != 1 ||
+        hdr.magic != expected.magic || hdr.version != expected.version) {
+        LOG_WARN("Pipeline cache %s: unrecognised file, ignoring", path);
+        goto done;
+    }
+    if (hdr.vendor_id != expected.vendor_id || hdr.device_id != expected.device_id ||
+        hdr.driver_version != expected.driver_version ||
+        memcmp(hdr.cache_uuid, expected.cache_uuid, VK_UUID_SIZE) != 0) {
+        LOG_INFO("Pipeline cache %s: device or driver changed, rebuilding", path);
+        goto done;
+    }
+
+    blob = malloc((size_t)hdr.data_size);
+    if (!blob || fread(blob, 1, (size_t)hdr.data_size, f) != hdr.data_size ||
+        hash_bytes(blob, (size_t)hdr.data_size) != hdr.data_hash) {
+        LOG_WARN("Pipeline cache %s: truncated or corrupt, ignoring", path);
+        free(blob);
+        blob = NULL;
+        goto done;
+    }
+    *out_size = (size_t)hdr.data_size;
+
+done:
+    fclose(f);
+    return blob;
+}
+
+EngineResult vk_create_pipeline_cache(VulkanContext *ctx, const char *path) {
+    size_t blob_size = 0;
+    u8 *blob = path ? load_cache_blob(ctx, path, &blob_size) : NULL;
+
+    VkPipelineCacheCreateInfo info = {
+        .sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .initialDataSize = blob_size,
+        .pInitialData    = blob,
+    };
+
+    VkResult result = vkCreatePipelineCache(ctx->device, &info, NULL, &ctx->pipeline_cache);
+    if (result != VK_SUCCESS && blob) {
+        /* Driver rejected the blob; start empty rather than fail */
+        LOG_WARN("Pipeline cache data rejected by driver, starting empty");
+        info.initialDataSize = 0;
+        info.pInitialData    = NULL;
+        result = vkCreatePipelineCache(ctx->device, &info, NULL, &ctx->pipeline_cache);
+    }
+    free(blob);
+
+    if (result != VK_SUCCESS) {
+        LOG_FATAL("Failed to create pipeline cache");
+        return ENGINE_ERROR_VULKAN_PIPELINE;
+    }
+
+    if (blob_size > 0) {
+        LOG_INFO("Pipeline cache loaded: %zu KB from %s", blob_size / 1024, path);
+    }
+    return ENGINE_SUCCESS;
+}
+
+void vk_save_pipeline_cache(VulkanContext *ctx, const char *path) {
+    if (!ctx->pipeline_cache || !path) return;
+
+    size_t size = 0;
+    if (vkGetPipelineCacheData(ctx->device, ctx->pipeline_cache, &size, NULL) != VK_SUCCESS ||
+        size == 0) {
+        return;
+    }
+
+    u8 *blob = malloc(size);
+    if (!blob) return;
+    if (vkGetPipelineCacheData(ctx->device, ctx->pipeline_cache, &size, blob) != VK_SUCCESS) {
+        free(blob);
+        return;
+    }
+
+    PipelineCacheFileHeader hdr;
+    fill_cache_header(ctx, &hdr);
+    hdr.data_size = size;
+    hdr.data_hash = hash_bytes(blob, size);
+
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        LOG_WARN("Failed to write pipeline cache: %s", path);
+        free(blob);
+        return;
+    }
+    bool ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1 && fwrite(blob, 1, size, f) == size;
+    if (fclose(f) != 0) ok = false;
+    free(blob);
+
+    if (!ok) {
+        /* A partial file would fail the hash check anyway; don't leave it */
+        LOG_WARN("Failed to write pipeline cache: %s", path);
+        remove(path);
+        return;
+    }
+    LOG_DEBUG("Pipeline cache saved: %zu KB to %s", size / 1024, path);
+}
+
 /* --------------------------------------------------------------------------
  * Render pass
  * ------------------------------------------------------------------------ */
@@ -125,6 +277,297 @@ EngineResult vk_create_render_pass(VulkanContext *ctx) {
     return ENGINE_SUCCESS;
 }
 
+/* --------------------------------------------------------------------------
+ * Descriptor set + pipeline layouts
+ *
+ * Created up front, serially, so the pipelines themselves only read them and
+ * can be compiled in parallel by vk_create_pipelines().
+ * ------------------------------------------------------------------------ */
+
+static EngineResult create_geometry_layouts(VulkanContext *ctx) {
+    /* Descriptor set layout: the bindless texture table, one combined image
+     * sampler array shared by the 2D, 3D and skinned pipelines */
+    VkDescriptorSetLayoutBinding geo_sampler_binding = {
+        .binding         = 0,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .descriptorCount = ctx->texture_slots,
+        .stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT,
+    };
+
+    VkDescriptorBindingFlags binding_flags =
+        VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+        VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT |
+        VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+    VkDescriptorSetLayoutBindingFlagsCreateInfo flags_info = {
+        .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+        .bindingCount  = 1,
+        .pBindingFlags = &binding_flags,
+    };
+
+    VkDescriptorSetLayoutCreateInfo geo_desc_layout_info = {
+        .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .pNext        = ctx->texture_update_after_bind ? &flags_info : NULL,
+        .flags        = ctx->texture_update_after_bind
+                        ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT : 0,
+        .bindingCount = 1,
+        .pBindings    = &geo_sampler_binding,
+    };
+
+    if (vkCreateDescriptorSetLayout(ctx->device, &geo_desc_layout_info, NULL,
+                                     &ctx->geo_desc_set_layout) != VK_SUCCESS) {
+        LOG_FATAL("Failed to create geometry descriptor set layout");
+        return ENGINE_ERROR_VULKAN_PIPELINE;
+    }
+
+    /* Descriptor pool for the texture table: one shared set with
+     * update-after-bind, otherwise one per frame in flight */
+    u32 set_count = ctx->texture_update_after_bind ? 1 : ctx->frames_in_flight;
+    VkDescriptorPoolSize pool_size = {
+        .type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .descriptorCount = ctx->texture_slots * set_count,
+    };
+
+    VkDescriptorPoolCreateInfo pool_info = {
+        .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .flags         = ctx->texture_update_after_bind
+                         ? VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT : 0,
+        .maxSets       = set_count,
+        .poolSizeCount = 1,
+        .pPoolSizes    = &pool_size,
+    };
+
+    if (vkCreateDescriptorPool(ctx->device, &pool_info, NULL,
+                                &ctx->geo_desc_pool) != VK_SUCCESS) {
+        LOG_FATAL("Failed to create geometry descriptor pool");
+        return ENGINE_ERROR_VULKAN_PIPELINE;
+    }
+
+    /* Pipeline layout: VP matrix + texture_index as push constants (68 bytes),
+     * plus the texture table */
+    VkPushConstantRange push_range = {
+        .stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+        .offset     = 0,
+        .size       = 68, /* mat4 (64) + uint texture_index (4) */
+    };
+
+    VkPipelineLayoutCreateInfo layout_info = {
+        .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount         = 1,
+        .pSetLayouts            = &ctx->geo_desc_set_layout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges    = &push_range,
+    };
+
+    if (vkCreatePipelineLayout(ctx->device, &layout_info, NULL,
+                               &ctx->pipeline_layout) != VK_SUCCESS) {
+        LOG_FATAL("Failed to create pipeline layout");
+        return ENGINE_ERROR_VULKAN_PIPELINE;
+    }
+
+    return ENGINE_SUCCESS;
+}
+
+static EngineResult create_text_layouts(VulkanContext *ctx) {
+    /* Descriptor set layout: one combined image sampler for font atlas */
+    VkDescriptorSetLayoutBinding sampler_binding = {
+        .binding         = 0,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .descriptorCount = 1,
+        .stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT,
+    };
+
+    VkDescriptorSetLayoutCreateInfo desc_layout_info = {
+        .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .bindingCount = 1,
+        .pBindings    = &sampler_binding,
+    };
+
+    if (vkCreateDescriptorSetLayout(ctx->device, &desc_layout_info, NULL,
+                                     &ctx->text_desc_set_layout) != VK_SUCCESS) {
+        LOG_FATAL("Failed to create text descriptor set layout");
+        return ENGINE_ERROR_VULKAN_PIPELINE;
+    }
+
+    /* Push constants: screen_size (vec2) + origin (vec2, offset of a cached
+     * text run) = 16 bytes */
+    VkPushConstantRange push_range = {
+        .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+        .offset     = 0,
+        .size       = sizeof(f32) * 4,
+    };
+
+    VkPipelineLayoutCreateInfo layout_info = {
+        .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount         = 1,
+        .pSetLayouts            = &ctx->text_desc_set_layout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges    = &push_range,
+    };
+
+    if (vkCreatePipelineLayout(ctx->device, &layout_info, NULL,
+                                &ctx->text_pipeline_layout) != VK_SUCCESS) {
+        LOG_FATAL("Failed to create text pipeline layout");
+        return ENGINE_ERROR_VULKAN_PIPELINE;
+    }
+
+    return ENGINE_SUCCESS;
+}
+
+static EngineResult create_3d_layouts(VulkanContext *ctx) {
+    /* Light descriptor set layout (set 1): binding 0 = light UBO,
+     * binding 1 = cascaded shadow map (sampler2DArrayShadow),
+     * binding 2 = point/spot lights, binding 3 = light clusters */
+    VkDescriptorSetLayoutBinding light_bindings[] = {
+        {
+            .binding         = 0,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT,
+        },
+        {
+            .binding         = 1,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = 1,
+            .stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT,
+        },
+        {
+            .binding         = 2,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT,
+        },
+        {
+            .binding         = 3,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT,
+        },
+    };
+
+    VkDescriptorSetLayoutCreateInfo ubo_layout_info = {
+        .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .bindingCount = ENGINE_ARRAY_LEN(light_bindings),
+        .pBindings    = light_bindings,
+    };
+
+    if (vkCreateDescriptorSetLayout(ctx->device, &ubo_layout_info, NULL,
+                                     &ctx->light_desc_set_layout) != VK_SUCCESS) {
+        LOG_FATAL("Failed to create light descriptor set layout");
+        return ENGINE_ERROR_VULKAN_PIPELINE;
+    }
+
+    /* Pipeline layout: set 0 = texture table (reuse geo_desc_set_layout),
+     *                  set 1 = light UBO + shadow map + clustered lights */
+    VkDescriptorSetLayout set_layouts[] = {
+        ctx->geo_desc_set_layout,
+        ctx->light_desc_set_layout,
+    };
+
+    VkPushConstantRange push_range = {
+        .stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+        .offset     = 0,
+        .size       = 68, /* mat4 (64) + uint texture_index (4) */
+    };
+
+    VkPipelineLayoutCreateInfo layout_info = {
+        .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount         = ENGINE_ARRAY_LEN(set_layouts),
+        .pSetLayouts            = set_layouts,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges    = &push_range,
+    };
+
+    if (vkCreatePipelineLayout(ctx->device, &layout_info, NULL,
+                                &ctx->pipeline_layout_3d) != VK_SUCCESS) {
+        LOG_FATAL("Failed to create 3D pipeline layout");
+        return ENGINE_ERROR_VULKAN_PIPELINE;
+    }
+
+    return ENGINE_SUCCESS;
+}
+
+static EngineResult create_skinned_layouts(VulkanContext *ctx) {
+    /* Joint SSBO descriptor set layout (set 2, binding 0).
+     * Dynamic so each frame-in-flight region is selected at bind time. */
+    VkDescriptorSetLayoutBinding ssbo_binding = {
+        .binding         = 0,
+        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+        .descriptorCount = 1,
+        .stageFlags      = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT, /* + skin.comp */
+    };
+
+    VkDescriptorSetLayoutCreateInfo ssbo_layout_info = {
+        .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .bindingCount = 1,
+        .pBindings    = &ssbo_binding,
+    };
+
+    if (vkCreateDescriptorSetLayout(ctx->device, &ssbo_layout_info, NULL,
+                                     &ctx->joint_desc_set_layout) != VK_SUCCESS) {
+        LOG_FATAL("Failed to create joint SSBO descriptor set layout");
+        return ENGINE_ERROR_VULKAN_PIPELINE;
+    }
+
+    /* Pipeline layout: set 0 = texture table, set 1 = light UBO, set 2 = joint SSBO */
+    VkDescriptorSetLayout set_layouts[] = {
+        ctx->geo_desc_set_layout,
+        ctx->light_desc_set_layout,
+        ctx->joint_desc_set_layout,
+    };
+
+    VkPushConstantRange push_range = {
+        .stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+        .offset     = 0,
+        .size       = 80, /* mat4 (64) + texture_index (4) + joint_offset (4) + joint_count (4)
+                             + first_instance (4) */
+    };
+
+    VkPipelineLayoutCreateInfo layout_info = {
+        .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount         = ENGINE_ARRAY_LEN(set_layouts),
+        .pSetLayouts            = set_layouts,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges    = &push_range,
+    };
+
+    if (vkCreatePipelineLayout(ctx->device, &layout_info, NULL,
+                                &ctx->pipeline_layout_skinned) != VK_SUCCESS) {
+        LOG_FATAL("Failed to create skinned pipeline layout");
+        return ENGINE_ERROR_VULKAN_PIPELINE;
+    }
+
+    return ENGINE_SUCCESS;
+}
+
+EngineResult vk_create_pipeline_layouts(VulkanContext *ctx) {
+    EngineResult res;
+    if ((res = create_geometry_layouts(ctx)) != ENGINE_SUCCESS) return res;
+    if ((res = create_text_layouts(ctx))     != ENGINE_SUCCESS) return res;
+    if ((res = create_3d_layouts(ctx))       != ENGINE_SUCCESS) return res;
+    if ((res = create_skinned_layouts(ctx))  != ENGINE_SUCCESS) return res;
+    return ENGINE_SUCCESS;
+}
+
+/* --------------------------------------------------------------------------
+ * Texture table size: the geometry fragment shaders declare the sampler array
+ * with specialization constant 1 (TEXTURE_SLOTS) so it matches the layout.
+ * ------------------------------------------------------------------------ */
+
+static const VkSpecializationMapEntry texture_slots_entry = {
+    .constantID = 1, .offset = 0, .size = sizeof(u32),
+};
+
+static void texture_slots_spec(const VulkanContext *ctx, u32 *value,
+                               VkSpecializationInfo *out) {
+    *value = ctx->texture_slots;
+    *out = (VkSpecializationInfo){
+        .mapEntryCount = 1,
+        .pMapEntries   = &texture_slots_entry,
+        .dataSize      = sizeof(u32),
+        .pData         = value,
+    };
+}
+
 /* --------------------------------------------------------------------------
  * Graphics pipeline
  * ------------------------------------------------------------------------ */
@@ -151,6 +594,10 @@ EngineResult vk_create_graphics_pipeline(VulkanContext *ctx) {
         return ENGINE_ERROR_VULKAN_PIPELINE;
     }
 
+    u32                  slots;
+    VkSpecializationInfo frag_spec;
+    texture_slots_spec(ctx, &slots, &frag_spec);
+
     VkPipelineShaderStageCreateInfo shader_stages[] = {
         {
             .sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
@@ -159,10 +606,11 @@ EngineResult vk_create_graphics_pipeline(VulkanContext *ctx) {
             .pName  = "main",
         },
         {
-            .sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-            .stage  = VK_SHADER_STAGE_FRAGMENT_BIT,
-            .module = frag_module,
-            .pName  = "main",
+            .sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage               = VK_SHADER_STAGE_FRAGMENT_BIT,
+            .module              = frag_module,
+            .pName               = "main",
+            .pSpecializationInfo = &frag_spec,
         },
     };
 
@@ -307,73 +755,6 @@ EngineResult vk_create_graphics_pipeline(VulkanContext *ctx) {
         .pAttachments    = &blend_attachment,
     };
 
-    /* Descriptor set layout: one combined image sampler for geometry textures */
-    VkDescriptorSetLayoutBinding geo_sampler_binding = {
-        .binding         = 0,
-        .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-        .descriptorCount = 1,
-        .stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT,
-    };
-
-    VkDescriptorSetLayoutCreateInfo geo_desc_layout_info = {
-        .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-        .bindingCount = 1,
-        .pBindings    = &geo_sampler_binding,
-    };
-
-    if (vkCreateDescriptorSetLayout(ctx->device, &geo_desc_layout_info, NULL,
-                                     &ctx->geo_desc_set_layout) != VK_SUCCESS) {
-        LOG_FATAL("Failed to create geometry descriptor set layout");
-        vkDestroyShaderModule(ctx->device, vert_module, NULL);
-        vkDestroyShaderModule(ctx->device, frag_module, NULL);
-        return ENGINE_ERROR_VULKAN_PIPELINE;
-    }
-
-    /* Descriptor pool for geometry textures */
-    VkDescriptorPoolSize pool_size = {
-        .type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-        .descriptorCount = MAX_TEXTURES,
-    };
-
-    VkDescriptorPoolCreateInfo pool_info = {
-        .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-        .maxSets       = MAX_TEXTURES,
-        .poolSizeCount = 1,
-        .pPoolSizes    = &pool_size,
-    };
-
-    if (vkCreateDescriptorPool(ctx->device, &pool_info, NULL,
-                                &ctx->geo_desc_pool) != VK_SUCCESS) {
-        LOG_FATAL("Failed to create geometry descriptor pool");
-        vkDestroyShaderModule(ctx->device, vert_module, NULL);
-        vkDestroyShaderModule(ctx->device, frag_module, NULL);
-        return ENGINE_ERROR_VULKAN_PIPELINE;
-    }
-
-    /* Pipeline layout: VP matrix + use_texture flag as push constants (68 bytes),
-     * plus one descriptor set for texture sampling */
-    VkPushConstantRange push_range = {
-        .stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-        .offset     = 0,
-        .size       = 68, /* mat4 (64) + uint use_texture (4) */
-    };
-
-    VkPipelineLayoutCreateInfo layout_info = {
-        .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-        .setLayoutCount         = 1,
-        .pSetLayouts            = &ctx->geo_desc_set_layout,
-        .pushConstantRangeCount = 1,
-        .pPushConstantRanges    = &push_range,
-    };
-
-    if (vkCreatePipelineLayout(ctx->device, &layout_info, NULL,
-                               &ctx->pipeline_layout) != VK_SUCCESS) {
-        LOG_FATAL("Failed to create pipeline layout");
-        vkDestroyShaderModule(ctx->device, vert_module, NULL);
-        vkDestroyShaderModule(ctx->device, frag_module, NULL);
-        return ENGINE_ERROR_VULKAN_PIPELINE;
-    }
-
     /* Graphics pipeline */
     VkGraphicsPipelineCreateInfo pipeline_info = {
         .sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
@@ -392,7 +773,7 @@ EngineResult vk_create_graphics_pipeline(VulkanContext *ctx) {
         .subpass              = 0,
     };
 
-    VkResult result = vkCreateGraphicsPipelines(ctx->device, VK_NULL_HANDLE, 1,
+    VkResult result = vkCreateGraphicsPipelines(ctx->device, ctx->pipeline_cache, 1,
                                                  &pipeline_info, NULL,
                                                  &ctx->graphics_pipeline);
 
@@ -545,51 +926,6 @@ EngineResult vk_create_text_pipeline(VulkanContext *ctx) {
         .pAttachments    = &blend_attachment,
     };
 
-    /* Descriptor set layout: one combined image sampler for font atlas */
-    VkDescriptorSetLayoutBinding sampler_binding = {
-        .binding         = 0,
-        .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-        .descriptorCount = 1,
-        .stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT,
-    };
-
-    VkDescriptorSetLayoutCreateInfo desc_layout_info = {
-        .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-        .bindingCount = 1,
-        .pBindings    = &sampler_binding,
-    };
-
-    if (vkCreateDescriptorSetLayout(ctx->device, &desc_layout_info, NULL,
-                                     &ctx->text_desc_set_layout) != VK_SUCCESS) {
-        LOG_FATAL("Failed to create text descriptor set layout");
-        vkDestroyShaderModule(ctx->device, vert_module, NULL);
-        vkDestroyShaderModule(ctx->device, frag_module, NULL);
-        return ENGINE_ERROR_VULKAN_PIPELINE;
-    }
-
-    /* Push constant: screen_size (vec2 = 8 bytes) */
-    VkPushConstantRange push_range = {
-        .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
-        .offset     = 0,
-        .size       = sizeof(f32) * 2,
-    };
-
-    VkPipelineLayoutCreateInfo layout_info = {
-        .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-        .setLayoutCount         = 1,
-        .pSetLayouts            = &ctx->text_desc_set_layout,
-        .pushConstantRangeCount = 1,
-        .pPushConstantRanges    = &push_range,
-    };
-
-    if (vkCreatePipelineLayout(ctx->device, &layout_info, NULL,
-                                &ctx->text_pipeline_layout) != VK_SUCCESS) {
-        LOG_FATAL("Failed to create text pipeline layout");
-        vkDestroyShaderModule(ctx->device, vert_module, NULL);
-        vkDestroyShaderModule(ctx->device, frag_module, NULL);
-        return ENGINE_ERROR_VULKAN_PIPELINE;
-    }
-
     VkGraphicsPipelineCreateInfo pipeline_info = {
         .sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
         .stageCount          = ENGINE_ARRAY_LEN(shader_stages),
@@ -607,7 +943,7 @@ EngineResult vk_create_text_pipeline(VulkanContext *ctx) {
         .subpass              = 0,
     };
 
-    VkResult result = vkCreateGraphicsPipelines(ctx->device, VK_NULL_HANDLE, 1,
+    VkResult result = vkCreateGraphicsPipelines(ctx->device, ctx->pipeline_cache, 1,
                                                  &pipeline_info, NULL,
                                                  &ctx->text_pipeline);
 
@@ -651,6 +987,10 @@ EngineResult vk_create_bloom_scene_pipelines(VulkanContext *ctx) {
         return ENGINE_ERROR_VULKAN_PIPELINE;
     }
 
+    u32                  slots;
+    VkSpecializationInfo frag_spec;
+    texture_slots_spec(ctx, &slots, &frag_spec);
+
     VkPipelineShaderStageCreateInfo shader_stages[] = {
         {
             .sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
@@ -659,10 +999,11 @@ EngineResult vk_create_bloom_scene_pipelines(VulkanContext *ctx) {
             .pName  = "main",
         },
         {
-            .sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-            .stage  = VK_SHADER_STAGE_FRAGMENT_BIT,
-            .module = frag_module,
-            .pName  = "main",
+            .sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage               = VK_SHADER_STAGE_FRAGMENT_BIT,
+            .module              = frag_module,
+            .pName               = "main",
+            .pSpecializationInfo = &frag_spec,
         },
     };
 
@@ -765,7 +1106,7 @@ EngineResult vk_create_bloom_scene_pipelines(VulkanContext *ctx) {
         .subpass              = 0,
     };
 
-    VkResult result = vkCreateGraphicsPipelines(ctx->device, VK_NULL_HANDLE, 1,
+    VkResult result = vkCreateGraphicsPipelines(ctx->device, ctx->pipeline_cache, 1,
                                                  &pipeline_info, NULL,
                                                  &ctx->bloom.scene_graphics_pipeline);
 
@@ -863,7 +1204,7 @@ EngineResult vk_create_bloom_scene_pipelines(VulkanContext *ctx) {
         .subpass              = 0,
     };
 
-    result = vkCreateGraphicsPipelines(ctx->device, VK_NULL_HANDLE, 1,
+    result = vkCreateGraphicsPipelines(ctx->device, ctx->pipeline_cache, 1,
                                         &text_pipe_info, NULL,
                                         &ctx->bloom.scene_text_pipeline);
 
@@ -879,13 +1220,86 @@ EngineResult vk_create_bloom_scene_pipelines(VulkanContext *ctx) {
     return ENGINE_SUCCESS;
 }
 
+/* --------------------------------------------------------------------------
+ * Packed vertex formats: the 3D / skinned vertex shaders read the normal as an
+ * octahedral pair when specialization constant 0 (PACKED_VERTICES) is true.
+ * The other packed attributes are widened by the vertex fetch formats.
+ *
+ * Instance formats: specialization constant 2 (INSTANCE_FORMAT) selects how
+ * the four per-instance attributes are read (InstanceFormat3D values).
+ * ------------------------------------------------------------------------ */
+
+typedef struct {
+    VkBool32 packed;
+    u32      instance_format;
+} VertexSpecData;
+
+static const VkSpecializationMapEntry vertex_spec_entries[] = {
+    { .constantID = 0, .offset = offsetof(VertexSpecData, packed),          .size = sizeof(VkBool32) },
+    { .constantID = 2, .offset = offsetof(VertexSpecData, instance_format), .size = sizeof(u32) },
+};
+
+static void vertex_format_spec(const VulkanContext *ctx, VertexSpecData *data,
+                               VkSpecializationInfo *out) {
+    data->packed          = ctx->packed_vertices ? VK_TRUE : VK_FALSE;
+    data->instance_format = (u32)ctx->instance_format_3d;
+    *out = (VkSpecializationInfo){
+        .mapEntryCount = ENGINE_ARRAY_LEN(vertex_spec_entries),
+        .pMapEntries   = vertex_spec_entries,
+        .dataSize      = sizeof(*data),
+        .pData         = data,
+    };
+}
+
+#define INSTANCE_ATTR(fmt, type, field) \
+    ((VkVertexInputAttributeDescription){ .binding = 1, .format = (fmt), \
+                                          .offset = offsetof(type, field) })
+
+/* The four per-instance attributes (binding 1) at locations first..first+3.
+ * The shaders declare them as vec4; missing components read as 0 / 1. */
+static void instance_3d_attributes(const VulkanContext *ctx, u32 first,
+                                   VkVertexInputAttributeDescription out[4]) {
+    switch (ctx->instance_format_3d) {
+    case INSTANCE_FORMAT_3D_QUAT:
+        /* position, quaternion, (scale.xyz, color.r), color.gb */
+        out[0] = INSTANCE_ATTR(VK_FORMAT_R32G32B32_SFLOAT, PackedInstanceData3D, position);
+        out[1] = INSTANCE_ATTR(VK_FORMAT_R16G16B16A16_SNORM, PackedInstanceData3D, rotation);
+        out[2] = INSTANCE_ATTR(VK_FORMAT_R16G16B16A16_SFLOAT, PackedInstanceData3D, scale);
+        out[3] = INSTANCE_ATTR(VK_FORMAT_R16G16_SFLOAT, PackedInstanceData3D, color[1]);
+        break;
+    case INSTANCE_FORMAT_3D_MATRIX:
+        /* three model rows, color */
+        out[0] = INSTANCE_ATTR(VK_FORMAT_R32G32B32A32_SFLOAT, MatrixInstanceData3D, model[0]);
+        out[1] = INSTANCE_ATTR(VK_FORMAT_R32G32B32A32_SFLOAT, MatrixInstanceData3D, model[1]);
+        out[2] = INSTANCE_ATTR(VK_FORMAT_R32G32B32A32_SFLOAT, MatrixInstanceData3D, model[2]);
+        out[3] = INSTANCE_ATTR(VK_FORMAT_R32G32B32_SFLOAT, MatrixInstanceData3D, color);
+        break;
+    default:
+        out[0] = INSTANCE_ATTR(VK_FORMAT_R32G32B32_SFLOAT, InstanceData3D, position);
+        out[1] = INSTANCE_ATTR(VK_FORMAT_R32G32B32_SFLOAT, InstanceData3D, rotation);
+        out[2] = INSTANCE_ATTR(VK_FORMAT_R32G32B32_SFLOAT, InstanceData3D, scale);
+        out[3] = INSTANCE_ATTR(VK_FORMAT_R32G32B32_SFLOAT, InstanceData3D, color);
+        break;
+    }
+    for (u32 i = 0; i < 4; i++) out[i].location = first + i;
+}
+
+#undef INSTANCE_ATTR
+
+/* Slope-scaled depth bias of the shadow pipelines, against shadow acne */
+#define SHADOW_DEPTH_BIAS_CONSTANT 1.25f
+#define SHADOW_DEPTH_BIAS_SLOPE    1.75f
+
 /* --------------------------------------------------------------------------
  * Internal: create a 3D graphics pipeline against a given render pass.
- * Used by both vk_create_3d_pipeline() and vk_create_bloom_scene_3d_pipeline().
+ * Used by vk_create_3d_pipeline(), vk_create_bloom_scene_3d_pipeline() and,
+ * depth_only (vertex stage, no colour attachment, depth bias), by
+ * vk_create_shadow_3d_pipeline().
  * ------------------------------------------------------------------------ */
 
 static EngineResult create_3d_pipeline_internal(VulkanContext *ctx,
                                                  VkRenderPass  render_pass,
+                                                 bool          depth_only,
                                                  VkPipeline   *out_pipeline) {
     /* Load 3D shaders */
     size_t vert_size, frag_size;
@@ -908,25 +1322,34 @@ static EngineResult create_3d_pipeline_internal(VulkanContext *ctx,
         return ENGINE_ERROR_VULKAN_PIPELINE;
     }
 
+    VertexSpecData       spec_data;
+    VkSpecializationInfo spec;
+    vertex_format_spec(ctx, &spec_data, &spec);
+    u32                  slots;
+    VkSpecializationInfo frag_spec;
+    texture_slots_spec(ctx, &slots, &frag_spec);
+
     VkPipelineShaderStageCreateInfo shader_stages[] = {
         {
-            .sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-            .stage  = VK_SHADER_STAGE_VERTEX_BIT,
-            .module = vert_module,
-            .pName  = "main",
+            .sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage               = VK_SHADER_STAGE_VERTEX_BIT,
+            .module              = vert_module,
+            .pName               = "main",
+            .pSpecializationInfo = &spec,
         },
         {
-            .sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-            .stage  = VK_SHADER_STAGE_FRAGMENT_BIT,
-            .module = frag_module,
-            .pName  = "main",
+            .sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage               = VK_SHADER_STAGE_FRAGMENT_BIT,
+            .module              = frag_module,
+            .pName               = "main",
+            .pSpecializationInfo = &frag_spec,
         },
     };
 
-    /* Vertex input: binding 0 = Vertex3D (per-vertex), binding 1 = InstanceData3D (per-instance) */
+    /* Vertex input: binding 0 = Vertex3D (per-vertex), binding 1 = instance format (per-instance) */
     VkVertexInputBindingDescription bindings[] = {
-        { .binding = 0, .stride = sizeof(Vertex3D),      .inputRate = VK_VERTEX_INPUT_RATE_VERTEX },
-        { .binding = 1, .stride = sizeof(InstanceData3D), .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE },
+        { .binding = 0, .stride = sizeof(Vertex3D),            .inputRate = VK_VERTEX_INPUT_RATE_VERTEX },
+        { .binding = 1, .stride = vk_instance_3d_stride(ctx), .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE },
     };
 
     VkVertexInputAttributeDescription attributes[] = {
@@ -935,12 +1358,22 @@ static EngineResult create_3d_pipeline_internal(VulkanContext *ctx,
         { .binding = 0, .location = 1, .format = VK_FORMAT_R32G32B32_SFLOAT,  .offset = offsetof(Vertex3D, normal) },
         { .binding = 0, .location = 2, .format = VK_FORMAT_R32G32_SFLOAT,     .offset = offsetof(Vertex3D, uv) },
         { .binding = 0, .location = 3, .format = VK_FORMAT_R32G32B32_SFLOAT,  .offset = offsetof(Vertex3D, color) },
-        /* Per-instance (binding 1) */
-        { .binding = 1, .location = 4, .format = VK_FORMAT_R32G32B32_SFLOAT,  .offset = offsetof(InstanceData3D, position) },
-        { .binding = 1, .location = 5, .format = VK_FORMAT_R32G32B32_SFLOAT,  .offset = offsetof(InstanceData3D, rotation) },
-        { .binding = 1, .location = 6, .format = VK_FORMAT_R32G32B32_SFLOAT,  .offset = offsetof(InstanceData3D, scale) },
-        { .binding = 1, .location = 7, .format = VK_FORMAT_R32G32B32_SFLOAT,  .offset = offsetof(InstanceData3D, color) },
-    };
+        /* Per-instance (binding 1), filled in below */
+        { 0 }, { 0 }, { 0 }, { 0 },
+    };
+    instance_3d_attributes(ctx, 4, &attributes[4]);
+
+    /* PackedVertex3D: same locations, narrower fetch formats */
+    if (ctx->packed_vertices) {
+        bindings[0].stride = sizeof(PackedVertex3D);
+        attributes[0].offset = offsetof(PackedVertex3D, position);
+        attributes[1].format = VK_FORMAT_R16G16_SNORM;
+        attributes[1].offset = offsetof(PackedVertex3D, normal);
+        attributes[2].format = VK_FORMAT_R16G16_SFLOAT;
+        attributes[2].offset = offsetof(PackedVertex3D, uv);
+        attributes[3].format = VK_FORMAT_R8G8B8A8_UNORM;
+        attributes[3].offset = offsetof(PackedVertex3D, color);
+    }
 
     VkPipelineVertexInputStateCreateInfo vertex_input = {
         .sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
@@ -974,6 +1407,9 @@ static EngineResult create_3d_pipeline_internal(VulkanContext *ctx,
         .lineWidth   = 1.0f,
         .cullMode    = VK_CULL_MODE_NONE,
         .frontFace   = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+        .depthBiasEnable         = depth_only,
+        .depthBiasConstantFactor = depth_only ? SHADOW_DEPTH_BIAS_CONSTANT : 0.0f,
+        .depthBiasSlopeFactor    = depth_only ? SHADOW_DEPTH_BIAS_SLOPE : 0.0f,
     };
 
     VkPipelineMultisampleStateCreateInfo multisampling = {
@@ -1002,13 +1438,13 @@ static EngineResult create_3d_pipeline_internal(VulkanContext *ctx,
 
     VkPipelineColorBlendStateCreateInfo color_blending = {
         .sType           = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
-        .attachmentCount = 1,
+        .attachmentCount = depth_only ? 0 : 1,
         .pAttachments    = &blend_attachment,
     };
 
     VkGraphicsPipelineCreateInfo pipeline_info = {
         .sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-        .stageCount          = ENGINE_ARRAY_LEN(shader_stages),
+        .stageCount          = depth_only ? 1 : ENGINE_ARRAY_LEN(shader_stages),
         .pStages             = shader_stages,
         .pVertexInputState   = &vertex_input,
         .pInputAssemblyState = &input_assembly,
@@ -1023,7 +1459,7 @@ static EngineResult create_3d_pipeline_internal(VulkanContext *ctx,
         .subpass              = 0,
     };
 
-    VkResult result = vkCreateGraphicsPipelines(ctx->device, VK_NULL_HANDLE, 1,
+    VkResult result = vkCreateGraphicsPipelines(ctx->device, ctx->pipeline_cache, 1,
                                                  &pipeline_info, NULL, out_pipeline);
 
     vkDestroyShaderModule(ctx->device, vert_module, NULL);
@@ -1042,54 +1478,7 @@ static EngineResult create_3d_pipeline_internal(VulkanContext *ctx,
  * ------------------------------------------------------------------------ */
 
 EngineResult vk_create_3d_pipeline(VulkanContext *ctx) {
-    /* Light UBO descriptor set layout (set 1, binding 0) */
-    VkDescriptorSetLayoutBinding ubo_binding = {
-        .binding         = 0,
-        .descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-        .descriptorCount = 1,
-        .stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT,
-    };
-
-    VkDescriptorSetLayoutCreateInfo ubo_layout_info = {
-        .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-        .bindingCount = 1,
-        .pBindings    = &ubo_binding,
-    };
-
-    if (vkCreateDescriptorSetLayout(ctx->device, &ubo_layout_info, NULL,
-                                     &ctx->light_desc_set_layout) != VK_SUCCESS) {
-        LOG_FATAL("Failed to create light descriptor set layout");
-        return ENGINE_ERROR_VULKAN_PIPELINE;
-    }
-
-    /* Pipeline layout: set 0 = texture sampler (reuse geo_desc_set_layout),
-     *                  set 1 = light UBO */
-    VkDescriptorSetLayout set_layouts[] = {
-        ctx->geo_desc_set_layout,
-        ctx->light_desc_set_layout,
-    };
-
-    VkPushConstantRange push_range = {
-        .stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-        .offset     = 0,
-        .size       = 68, /* mat4 (64) + uint use_texture (4) */
-    };
-
-    VkPipelineLayoutCreateInfo layout_info = {
-        .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-        .setLayoutCount         = ENGINE_ARRAY_LEN(set_layouts),
-        .pSetLayouts            = set_layouts,
-        .pushConstantRangeCount = 1,
-        .pPushConstantRanges    = &push_range,
-    };
-
-    if (vkCreatePipelineLayout(ctx->device, &layout_info, NULL,
-                                &ctx->pipeline_layout_3d) != VK_SUCCESS) {
-        LOG_FATAL("Failed to create 3D pipeline layout");
-        return ENGINE_ERROR_VULKAN_PIPELINE;
-    }
-
-    EngineResult res = create_3d_pipeline_internal(ctx, ctx->render_pass,
+    EngineResult res = create_3d_pipeline_internal(ctx, ctx->render_pass, false,
                                                     &ctx->graphics_pipeline_3d);
     if (res != ENGINE_SUCCESS) return res;
 
@@ -1102,7 +1491,7 @@ EngineResult vk_create_3d_pipeline(VulkanContext *ctx) {
  * ------------------------------------------------------------------------ */
 
 EngineResult vk_create_bloom_scene_3d_pipeline(VulkanContext *ctx) {
-    EngineResult res = create_3d_pipeline_internal(ctx, ctx->bloom.scene_render_pass,
+    EngineResult res = create_3d_pipeline_internal(ctx, ctx->bloom.scene_render_pass, false,
                                                     &ctx->bloom.scene_3d_pipeline);
     if (res != ENGINE_SUCCESS) return res;
 
@@ -1110,14 +1499,30 @@ EngineResult vk_create_bloom_scene_3d_pipeline(VulkanContext *ctx) {
     return ENGINE_SUCCESS;
 }
 
+/* --------------------------------------------------------------------------
+ * Depth-only 3D pipeline for the shadow cascades
+ * ------------------------------------------------------------------------ */
+
+EngineResult vk_create_shadow_3d_pipeline(VulkanContext *ctx) {
+    if (!ctx->shadow.available) return ENGINE_SUCCESS;
+
+    EngineResult res = create_3d_pipeline_internal(ctx, ctx->shadow.render_pass, true,
+                                                    &ctx->shadow.pipeline_3d);
+    if (res != ENGINE_SUCCESS) return res;
+
+    LOG_INFO("Shadow 3D pipeline created");
+    return ENGINE_SUCCESS;
+}
+
 /* --------------------------------------------------------------------------
  * Internal: create a skinned 3D pipeline against a given render pass.
  * Same as 3D pipeline but with SkinnedVertex3D (joints/weights) + joint SSBO.
- * Reuses mesh3d.frag for Phong lighting.
+ * Reuses mesh3d.frag for Phong lighting; depth_only as for the 3D pipeline.
  * ------------------------------------------------------------------------ */
 
 static EngineResult create_skinned_3d_pipeline_internal(VulkanContext *ctx,
                                                          VkRenderPass  render_pass,
+                                                         bool          depth_only,
                                                          VkPipeline   *out_pipeline) {
     size_t vert_size, frag_size;
     u8 *vert_code = vk_read_file("shaders/skinned3d.vert.spv", &vert_size);
@@ -1139,24 +1544,33 @@ static EngineResult create_skinned_3d_pipeline_internal(VulkanContext *ctx,
         return ENGINE_ERROR_VULKAN_PIPELINE;
     }
 
+    VertexSpecData       spec_data;
+    VkSpecializationInfo spec;
+    vertex_format_spec(ctx, &spec_data, &spec);
+    u32                  slots;
+    VkSpecializationInfo frag_spec;
+    texture_slots_spec(ctx, &slots, &frag_spec);
+
     VkPipelineShaderStageCreateInfo shader_stages[] = {
         {
-            .sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-            .stage  = VK_SHADER_STAGE_VERTEX_BIT,
-            .module = vert_module,
-            .pName  = "main",
+            .sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage               = VK_SHADER_STAGE_VERTEX_BIT,
+            .module              = vert_module,
+            .pName               = "main",
+            .pSpecializationInfo = &spec,
         },
         {
-            .sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-            .stage  = VK_SHADER_STAGE_FRAGMENT_BIT,
-            .module = frag_module,
-            .pName  = "main",
+            .sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage               = VK_SHADER_STAGE_FRAGMENT_BIT,
+            .module              = frag_module,
+            .pName               = "main",
+            .pSpecializationInfo = &frag_spec,
         },
     };
 
     VkVertexInputBindingDescription bindings[] = {
         { .binding = 0, .stride = sizeof(SkinnedVertex3D), .inputRate = VK_VERTEX_INPUT_RATE_VERTEX },
-        { .binding = 1, .stride = sizeof(InstanceData3D),  .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE },
+        { .binding = 1, .stride = vk_instance_3d_stride(ctx), .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE },
     };
 
     VkVertexInputAttributeDescription attributes[] = {
@@ -1167,12 +1581,26 @@ static EngineResult create_skinned_3d_pipeline_internal(VulkanContext *ctx,
         { .binding = 0, .location = 3, .format = VK_FORMAT_R32G32B32_SFLOAT,    .offset = offsetof(SkinnedVertex3D, color) },
         { .binding = 0, .location = 4, .format = VK_FORMAT_R32G32B32A32_UINT,   .offset = offsetof(SkinnedVertex3D, joints) },
         { .binding = 0, .location = 5, .format = VK_FORMAT_R32G32B32A32_SFLOAT, .offset = offsetof(SkinnedVertex3D, weights) },
-        /* Per-instance (binding 1) — InstanceData3D */
-        { .binding = 1, .location = 6, .format = VK_FORMAT_R32G32B32_SFLOAT,    .offset = offsetof(InstanceData3D, position) },
-        { .binding = 1, .location = 7, .format = VK_FORMAT_R32G32B32_SFLOAT,    .offset = offsetof(InstanceData3D, rotation) },
-        { .binding = 1, .location = 8, .format = VK_FORMAT_R32G32B32_SFLOAT,    .offset = offsetof(InstanceData3D, scale) },
-        { .binding = 1, .location = 9, .format = VK_FORMAT_R32G32B32_SFLOAT,    .offset = offsetof(InstanceData3D, color) },
-    };
+        /* Per-instance (binding 1), same formats as the 3D pipeline */
+        { 0 }, { 0 }, { 0 }, { 0 },
+    };
+    instance_3d_attributes(ctx, 6, &attributes[6]);
+
+    /* PackedSkinnedVertex3D: same locations, narrower fetch formats */
+    if (ctx->packed_vertices) {
+        bindings[0].stride = sizeof(PackedSkinnedVertex3D);
+        attributes[0].offset = offsetof(PackedSkinnedVertex3D, position);
+        attributes[1].format = VK_FORMAT_R16G16_SNORM;
+        attributes[1].offset = offsetof(PackedSkinnedVertex3D, normal);
+        attributes[2].format = VK_FORMAT_R16G16_SFLOAT;
+        attributes[2].offset = offsetof(PackedSkinnedVertex3D, uv);
+        attributes[3].format = VK_FORMAT_R8G8B8A8_UNORM;
+        attributes[3].offset = offsetof(PackedSkinnedVertex3D, color);
+        attributes[4].format = VK_FORMAT_R8G8B8A8_UINT;
+        attributes[4].offset = offsetof(PackedSkinnedVertex3D, joints);
+        attributes[5].format = VK_FORMAT_R16G16B16A16_UNORM;
+        attributes[5].offset = offsetof(PackedSkinnedVertex3D, weights);
+    }
 
     VkPipelineVertexInputStateCreateInfo vertex_input = {
         .sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
@@ -1206,6 +1634,9 @@ static EngineResult create_skinned_3d_pipeline_internal(VulkanContext *ctx,
         .lineWidth   = 1.0f,
         .cullMode    = VK_CULL_MODE_NONE,
         .frontFace   = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+        .depthBiasEnable         = depth_only,
+        .depthBiasConstantFactor = depth_only ? SHADOW_DEPTH_BIAS_CONSTANT : 0.0f,
+        .depthBiasSlopeFactor    = depth_only ? SHADOW_DEPTH_BIAS_SLOPE : 0.0f,
     };
 
     VkPipelineMultisampleStateCreateInfo multisampling = {
@@ -1234,13 +1665,13 @@ static EngineResult create_skinned_3d_pipeline_internal(VulkanContext *ctx,
 
     VkPipelineColorBlendStateCreateInfo color_blending = {
         .sType           = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
-        .attachmentCount = 1,
+        .attachmentCount = depth_only ? 0 : 1,
         .pAttachments    = &blend_attachment,
     };
 
     VkGraphicsPipelineCreateInfo pipeline_info = {
         .sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-        .stageCount          = ENGINE_ARRAY_LEN(shader_stages),
+        .stageCount          = depth_only ? 1 : ENGINE_ARRAY_LEN(shader_stages),
         .pStages             = shader_stages,
         .pVertexInputState   = &vertex_input,
         .pInputAssemblyState = &input_assembly,
@@ -1255,7 +1686,7 @@ static EngineResult create_skinned_3d_pipeline_internal(VulkanContext *ctx,
         .subpass              = 0,
     };
 
-    VkResult result = vkCreateGraphicsPipelines(ctx->device, VK_NULL_HANDLE, 1,
+    VkResult result = vkCreateGraphicsPipelines(ctx->device, ctx->pipeline_cache, 1,
                                                  &pipeline_info, NULL, out_pipeline);
 
     vkDestroyShaderModule(ctx->device, vert_module, NULL);
@@ -1274,54 +1705,7 @@ static EngineResult create_skinned_3d_pipeline_internal(VulkanContext *ctx,
  * ------------------------------------------------------------------------ */
 
 EngineResult vk_create_skinned_3d_pipeline(VulkanContext *ctx) {
-    /* Joint SSBO descriptor set layout (set 2, binding 0) */
-    VkDescriptorSetLayoutBinding ssbo_binding = {
-        .binding         = 0,
-        .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-        .descriptorCount = 1,
-        .stageFlags      = VK_SHADER_STAGE_VERTEX_BIT,
-    };
-
-    VkDescriptorSetLayoutCreateInfo ssbo_layout_info = {
-        .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-        .bindingCount = 1,
-        .pBindings    = &ssbo_binding,
-    };
-
-    if (vkCreateDescriptorSetLayout(ctx->device, &ssbo_layout_info, NULL,
-                                     &ctx->joint_desc_set_layout) != VK_SUCCESS) {
-        LOG_FATAL("Failed to create joint SSBO descriptor set layout");
-        return ENGINE_ERROR_VULKAN_PIPELINE;
-    }
-
-    /* Pipeline layout: set 0 = texture, set 1 = light UBO, set 2 = joint SSBO */
-    VkDescriptorSetLayout set_layouts[] = {
-        ctx->geo_desc_set_layout,
-        ctx->light_desc_set_layout,
-        ctx->joint_desc_set_layout,
-    };
-
-    VkPushConstantRange push_range = {
-        .stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-        .offset     = 0,
-        .size       = 76, /* mat4 (64) + use_texture (4) + joint_offset (4) + joint_count (4) */
-    };
-
-    VkPipelineLayoutCreateInfo layout_info = {
-        .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-        .setLayoutCount         = ENGINE_ARRAY_LEN(set_layouts),
-        .pSetLayouts            = set_layouts,
-        .pushConstantRangeCount = 1,
-        .pPushConstantRanges    = &push_range,
-    };
-
-    if (vkCreatePipelineLayout(ctx->device, &layout_info, NULL,
-                                &ctx->pipeline_layout_skinned) != VK_SUCCESS) {
-        LOG_FATAL("Failed to create skinned pipeline layout");
-        return ENGINE_ERROR_VULKAN_PIPELINE;
-    }
-
-    EngineResult res = create_skinned_3d_pipeline_internal(ctx, ctx->render_pass,
+    EngineResult res = create_skinned_3d_pipeline_internal(ctx, ctx->render_pass, false,
                                                             &ctx->graphics_pipeline_skinned);
     if (res != ENGINE_SUCCESS) return res;
 
@@ -1334,10 +1718,25 @@ EngineResult vk_create_skinned_3d_pipeline(VulkanContext *ctx) {
  * ------------------------------------------------------------------------ */
 
 EngineResult vk_create_bloom_scene_skinned_3d_pipeline(VulkanContext *ctx) {
-    EngineResult res = create_skinned_3d_pipeline_internal(ctx, ctx->bloom.scene_render_pass,
+    EngineResult res = create_skinned_3d_pipeline_internal(ctx, ctx->bloom.scene_render_pass, false,
                                                             &ctx->bloom.scene_skinned_pipeline);
     if (res != ENGINE_SUCCESS) return res;
 
     LOG_INFO("Bloom scene skinned 3D pipeline created");
     return ENGINE_SUCCESS;
 }
+
+/* --------------------------------------------------------------------------
+ * Depth-only skinned 3D pipeline for the shadow cascades
+ * ------------------------------------------------------------------------ */
+
+EngineResult vk_create_shadow_skinned_3d_pipeline(VulkanContext *ctx) {
+    if (!ctx->shadow.available) return ENGINE_SUCCESS;
+
+    EngineResult res = create_skinned_3d_pipeline_internal(ctx, ctx->shadow.render_pass, true,
+                                                            &ctx->shadow.skinned_pipeline);
+    if (res != ENGINE_SUCCESS) return res;
+
+    LOG_INFO("Shadow skinned 3D pipeline created");
+    return ENGINE_SUCCESS;
+}
@@ -10,7 +10,19 @@
 u8            *vk_read_file(const char *path, size_t *out_size);
 VkShaderModule vk_create_shader_module(VkDevice device, const u8 *code, size_t size);
 
+/* Pipeline cache shared by every pipeline the renderer builds. The file at
+ * `path` is used as initial data if it was written on the same device and
+ * driver; otherwise the cache starts empty. Destroyed by vk_destroy. */
+EngineResult vk_create_pipeline_cache(VulkanContext *ctx, const char *path);
+void         vk_save_pipeline_cache(VulkanContext *ctx, const char *path);
+
 EngineResult vk_create_render_pass(VulkanContext *ctx);
+
+/* Descriptor set and pipeline layouts for the 2D, text, 3D and skinned
+ * pipelines. Must run before any vk_create_*_pipeline* below; those only read
+ * ctx state and may run concurrently on different threads. */
+EngineResult vk_create_pipeline_layouts(VulkanContext *ctx);
+
 EngineResult vk_create_graphics_pipeline(VulkanContext *ctx);
 EngineResult vk_create_text_pipeline(VulkanContext *ctx);
 
@@ -29,4 +41,9 @@ EngineResult vk_create_skinned_3d_pipeline(VulkanContext *ctx);
 /* Skinned 3D pipeline against bloom HDR render pass */
 EngineResult vk_create_bloom_scene_skinned_3d_pipeline(VulkanContext *ctx);
 
+/* Depth-only 3D and skinned pipelines against the shadow render pass (no-ops
+ * when shadows are unavailable) */
+EngineResult vk_create_shadow_3d_pipeline(VulkanContext *ctx);
+EngineResult vk_create_shadow_skinned_3d_pipeline(VulkanContext *ctx);
+
 #endif /* ENGINE_VK_PIPELINE_H */
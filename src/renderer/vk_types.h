@@ -2,30 +2,116 @@
 #define ENGINE_VK_TYPES_H
 
 #include "renderer/renderer_types.h"
+#include "core/arena.h"
+#include "core/jobs.h"
 #include <vulkan/vulkan.h>
 
-#define MAX_FRAMES_IN_FLIGHT 2
+/* Per-frame arrays are sized for the most frames in flight; the renderer
+ * uses vk->frames_in_flight of them (RendererConfig.frames_in_flight) */
+#define MAX_FRAMES_IN_FLIGHT     RENDERER_MAX_FRAMES_IN_FLIGHT
+#define DEFAULT_FRAMES_IN_FLIGHT 2
 #define MAX_MESHES           32
-#define MAX_TEXTURES         64
-#define MAX_DRAW_COMMANDS    256
+#define MAX_TEXTURES         4096  /* upper bound; the device may allow fewer */
+#define INITIAL_DRAW_COMMANDS 256   /* draw lists grow past this on demand */
 #define MAX_VERTICES_3D      65536
 #define MAX_INDICES          131072
 #define MAX_SKINNED_VERTICES_3D  65536
-#define MAX_SKINNED_DRAW_COMMANDS 64
+#define INITIAL_SKINNED_DRAW_COMMANDS 64
+#define MAX_RETIRED_RINGS    16      /* grown ring buffers awaiting destruction */
+
+/* ---- Secondary command pools ----
+ * One per job thread per frame slot, so threads record secondaries without
+ * locking. Buffers are kept across frames and the pool is reset once the
+ * slot's fence has signalled. */
+
+typedef struct {
+    VkCommandPool    pool;      /* created on first use by the owning thread */
+    VkCommandBuffer *buffers;
+    u32              count;     /* allocated from pool */
+    u32              used;      /* handed out since the last reset */
+} SecondaryPool;
+
+/* ---- GPU memory sub-allocation ----
+ * Buffers and images get a range of a larger VkDeviceMemory block instead of
+ * their own allocation. Each block holds either linear resources (buffers) or
+ * optimal-tiling images, never both, so bufferImageGranularity never applies.
+ * Host-visible blocks stay mapped for their whole lifetime. */
+
+#define GPU_MAX_BLOCKS  64
+#define GPU_BLOCK_SIZE  (64ull * 1024 * 1024)
+
+typedef struct {
+    VkDeviceMemory memory;  /* owning block's memory (shared, never free this) */
+    VkDeviceSize   offset;  /* byte offset within the block */
+    VkDeviceSize   size;
+    u8            *mapped;  /* host pointer at offset, NULL if not host-visible */
+    u32            block;   /* index into GpuAllocator.blocks */
+} GpuAllocation;
+
+typedef struct {
+    VkDeviceSize offset;
+    VkDeviceSize size;
+} GpuFreeRange;
+
+typedef struct {
+    VkDeviceMemory memory;       /* VK_NULL_HANDLE = unused slot */
+    VkDeviceSize   size;
+    VkDeviceSize   used;
+    u8            *mapped;
+    GpuFreeRange  *free_ranges;  /* sorted by offset, neighbours coalesced */
+    u32            free_count;
+    u32            free_capacity;
+    u32            alloc_count;
+    u32            type;         /* memory type index */
+    bool           optimal;      /* holds optimal-tiling images */
+    bool           dedicated;    /* sized for a single large resource */
+} GpuMemoryBlock;
+
+typedef struct {
+    GpuMemoryBlock                   blocks[GPU_MAX_BLOCKS];
+    VkPhysicalDeviceMemoryProperties props;
+} GpuAllocator;
+
+typedef struct {
+    u32          block_count;
+    u32          allocation_count;
+    VkDeviceSize block_bytes;       /* reserved from the driver */
+    VkDeviceSize used_bytes;        /* handed out to resources */
+    VkDeviceSize largest_free;      /* largest free range in any block */
+    u32          free_range_count;  /* free ranges across blocks (fragmentation) */
+    u32          heap_count;
+    VkDeviceSize heap_size[VK_MAX_MEMORY_HEAPS];
+    VkDeviceSize heap_block_bytes[VK_MAX_MEMORY_HEAPS];
+    VkMemoryHeapFlags heap_flags[VK_MAX_MEMORY_HEAPS];
+    bool         heap_budget_valid;  /* VK_EXT_memory_budget: the two below are filled in */
+    VkDeviceSize heap_budget[VK_MAX_MEMORY_HEAPS];
+    VkDeviceSize heap_usage[VK_MAX_MEMORY_HEAPS];  /* whole process, not just this allocator */
+} GpuMemoryStats;
 
 /* ---- Texture handle ---- */
 
 typedef struct {
     VkImage        image;
-    VkDeviceMemory memory;
+    GpuAllocation  memory;
     VkImageView    view;
     VkSampler      sampler;
     u32            width;
     u32            height;
+    u32            mip_levels;
+    bool           placeholder;  /* async load pending or failed: draws sample the dummy */
 } VulkanTexture;
 
 /* ---- Mesh slot (region within a shared vertex buffer) ---- */
 
+/* Index ranges per mesh: level 0 is the full mesh, higher levels are
+ * simplified copies over the same vertices (RendererConfig.mesh_lods) */
+#define MESH_MAX_LODS 4
+
+typedef struct {
+    u32 first_index;
+    u32 index_count;
+} MeshLod;
+
 typedef struct {
     u32  first_vertex;  /* offset into the shared vertex buffer */
     u32  vertex_count;  /* number of vertices in this mesh */
@@ -33,57 +119,243 @@ typedef struct {
     bool is_skinned;    /* true = SkinnedVertex3D format (skeletal animation) */
     u32  first_index;   /* offset into the shared index buffer (3D only) */
     u32  index_count;   /* 0 = non-indexed draw */
+    f32  bounds_center[3]; /* object-space bounding sphere (3D only; bind pose if skinned) */
+    f32  bounds_radius;
+    u32  lod_count;     /* valid entries in lods[] (0 = non-indexed) */
+    MeshLod lods[MESH_MAX_LODS]; /* lods[0] == { first_index, index_count } */
+    bool borrowed;      /* ranges belong to another mesh (async load placeholder) */
 } MeshSlot;
 
 /* ---- Per-frame draw command (queued by renderer_draw_mesh) ---- */
 
 typedef struct {
-    MeshHandle    mesh;            /* which mesh to draw */
+    u32           mesh;            /* meshes[] slot (handle resolved at queue time) */
     TextureHandle texture;         /* TEXTURE_HANDLE_INVALID = untextured */
     u32           instance_offset; /* offset into instance buffer */
     u32           instance_count;  /* number of instances */
+    u32           lod;             /* MeshSlot.lods entry (3D only) */
 } DrawCommand;
 
 /* ---- Per-frame skinned draw command (skeletal animation) ---- */
 
 typedef struct {
-    MeshHandle    mesh;
+    u32           mesh;              /* meshes[] slot */
     TextureHandle texture;
     u32           instance_offset;
     u32           instance_count;
     u32           joint_ssbo_offset; /* byte offset into the joint SSBO */
     u32           joint_count;       /* number of joints for this draw */
+    u32           skinned_vertex;    /* first Vertex3D in the compute skinning
+                                        output, or SKIN_COMPUTE_NONE */
 } SkinnedDrawCommand;
 
+/* ---- Growable per-frame draw lists ----
+ * Storage is bump-allocated from the frame arena and doubled on demand; the
+ * arena chains another block if it runs out mid-frame. */
+
+typedef struct {
+    DrawCommand *items;
+    u32          count;
+    u32          capacity;
+} DrawList;
+
+typedef struct {
+    SkinnedDrawCommand *items;
+    u32                 count;
+    u32                 capacity;
+} SkinnedDrawList;
+
+/* ---- Per-frame ring buffer ----
+ * One persistently mapped, host-visible buffer split into frames_in_flight
+ * equally sized regions. The CPU only writes the region owned by the frame
+ * currently being recorded; the GPU reads it through a bind-time offset
+ * (vertex buffer offset or dynamic descriptor offset). The region is reused
+ * only after that frame slot's in_flight fence has signaled. */
+
+typedef struct {
+    VkBuffer       buffer;
+    GpuAllocation  memory;
+    u8            *mapped;       /* base of the whole buffer (all regions) */
+    VkDeviceSize   frame_size;   /* bytes per region (aligned) */
+    VkDeviceSize   frame_offset; /* byte offset of the current frame's region */
+    VkBufferUsageFlags usage;    /* kept so the ring can be recreated larger */
+} FrameRing;
+
+/* A ring replaced by a larger one while earlier frames may still read it.
+ * Destroyed once every frame that could reference it has retired. */
+typedef struct {
+    FrameRing        ring;
+    VkDescriptorPool desc_pool;    /* pool desc_set came from (if any) */
+    VkDescriptorSet  desc_set;     /* descriptor set pointing at ring (or VK_NULL_HANDLE) */
+    u64              retire_frame; /* frame_number when it was replaced */
+} RetiredRing;
+
+/* ---- Upload manager ----
+ * One persistently mapped staging buffer used as a ring. Copies are recorded
+ * into an open batch and submitted together; each batch signals the next
+ * value of a timeline semaphore, and its staging bytes are reused once that
+ * value is reached. The graphics queue waits on the last submitted value. */
+
+#define UPLOAD_MAX_BATCHES 8
+
+typedef struct {
+    VkCommandBuffer cmd;
+    VkDeviceSize    end;       /* staging head after this batch's data */
+    u64             value;     /* timeline value signaled on completion */
+} UploadBatch;
+
+typedef struct {
+    VkBuffer        staging;
+    GpuAllocation   staging_memory;
+    u8             *staging_mapped;
+    VkDeviceSize    staging_size;
+    VkDeviceSize    head;      /* next free byte */
+    VkDeviceSize    tail;      /* first byte still owned by a batch */
+
+    VkQueue         queue;     /* transfer queue, or the graphics queue */
+    VkCommandPool   command_pool;
+    bool            concurrent; /* upload targets are shared with a separate transfer family */
+
+    UploadBatch     batches[UPLOAD_MAX_BATCHES]; /* ring of batches: in flight then open */
+    u32             batch_first;  /* oldest in-flight batch */
+    u32             batch_count;  /* in-flight batches */
+    bool            open;         /* batches[(first + count) % MAX] is recording */
+    u32             open_copies;  /* commands recorded into the open batch */
+
+    VkSemaphore     timeline;     /* VK_NULL_HANDLE without timeline support */
+    u64             submitted;    /* last value signaled by a submitted batch */
+    u64             bytes_staged; /* total copied into staging, for statistics */
+} UploadContext;
+
+/* ---- Render graph (render_graph.c) ----
+ * The frame's passes are registered once, in execution order, with every
+ * resource each one reads or writes. Per frame the renderer switches passes
+ * on or off; an enabled pass is still culled when nothing later in the frame
+ * reads what it writes. In front of each remaining pass the graph records at
+ * most one barrier, derived from the tracked state of what the pass touches:
+ * image barriers only for layout transitions, one memory barrier for every
+ * other hazard. Transient images belong to the graph and are discarded at
+ * their first use each frame; two whose lifetimes (first to last pass using
+ * them) don't overlap share memory. Buffers are logical, they only carry
+ * hazards. */
+
+#define RG_MAX_RESOURCES 16
+#define RG_MAX_PASSES    16
+#define RG_MAX_ACCESSES  8     /* resources per pass */
+#define RG_NONE          0xFFFFFFFFu
+
+typedef u32 RgResource;
+typedef u32 RgPass;
+
+typedef enum {
+    RG_ACCESS_COLOR_ATTACHMENT,   /* render pass colour target */
+    RG_ACCESS_DEPTH_ATTACHMENT,   /* render pass depth target */
+    RG_ACCESS_FRAGMENT_READ,      /* sampled image or storage buffer, fragment shaders */
+    RG_ACCESS_COMPUTE_READ,       /* sampled image or storage buffer, compute */
+    RG_ACCESS_COMPUTE_STORAGE,    /* storage read/write in compute (images in GENERAL) */
+    RG_ACCESS_VERTEX_INPUT,       /* vertex attributes */
+    RG_ACCESS_INDIRECT_READ,      /* indirect draw arguments */
+    RG_ACCESS_COUNT
+} RgAccess;
+
+typedef struct {
+    VkFormat           format;
+    VkExtent2D         extent;
+    u32                mip_levels;
+    u32                array_layers;
+    VkImageUsageFlags  usage;
+    VkImageAspectFlags aspect;
+} RgImageDesc;
+
+typedef struct {
+    const char          *name;
+    bool                 is_image;
+    bool                 frame_local;   /* buffer with a region per frame slot: no hazards across frames */
+    RgImageDesc          desc;
+    VkImage              image;         /* transient images, created by render_graph_compile */
+    VkDeviceSize         size;          /* memory requirement */
+    u32                  slot;          /* RgMemorySlot the image is bound to */
+    u32                  first_pass;    /* lifetime over every registered pass */
+    u32                  last_pass;
+
+    /* Tracked across passes and frames */
+    VkImageLayout        layout;
+    VkPipelineStageFlags write_stages;   /* last write (or layout transition) */
+    VkAccessFlags        write_access;
+    VkPipelineStageFlags read_stages;    /* reads since that write */
+    VkPipelineStageFlags visible_stages; /* stages the write was made visible to */
+    bool                 discarded;      /* transient image already first used this frame */
+} RgResourceInfo;
+
+/* One resource as a pass uses it; several accesses to the same resource in
+ * one pass are merged */
+typedef struct {
+    RgResource           resource;
+    VkPipelineStageFlags stages;
+    VkAccessFlags        access;
+    VkImageLayout        layout;
+    bool                 write;
+} RgPassAccess;
+
+struct VulkanContext;
+typedef EngineResult (*RgRecordFn)(struct VulkanContext *vk, VkCommandBuffer cmd, void *user);
+
+typedef struct {
+    const char   *name;
+    RgRecordFn    record;
+    void         *user;
+    RgPassAccess  accesses[RG_MAX_ACCESSES];
+    u32           access_count;
+    bool          output;     /* effects outside the graph (draws to the swapchain): never culled */
+    bool          enabled;    /* set by the renderer every frame */
+    bool          live;       /* enabled and not culled this frame */
+} RgPassInfo;
+
+/* Memory shared by transient images with disjoint lifetimes */
+typedef struct {
+    GpuAllocation        memory;
+    VkMemoryRequirements reqs;       /* union of its images' requirements */
+    VkPipelineStageFlags stages;     /* stages the memory was used at since the last discard */
+    VkAccessFlags        writes;
+} RgMemorySlot;
+
+typedef struct {
+    RgResourceInfo resources[RG_MAX_RESOURCES];
+    u32            resource_count;
+    RgPassInfo     passes[RG_MAX_PASSES];
+    u32            pass_count;
+    RgMemorySlot   slots[RG_MAX_RESOURCES];
+    u32            slot_count;
+    VkDeviceSize   transient_bytes;   /* bound to transient images */
+    VkDeviceSize   aliased_bytes;     /* saved by sharing slots */
+    bool           dirty;             /* images need (re)creating */
+} RenderGraph;
+
 /* ---- Bloom post-processing context ---- */
 
+#define BLOOM_MAX_MIPS 6
+
 typedef struct {
-    /* Offscreen images */
-    VkImage        scene_image;
-    VkDeviceMemory scene_memory;
+    /* Offscreen HDR scene, a transient image of the render graph */
+    RgResource     scene_target;
     VkImageView    scene_view;
     VkSampler      scene_sampler;
 
-    VkImage        bloom_a_image;
-    VkDeviceMemory bloom_a_memory;
-    VkImageView    bloom_a_view;
-    VkSampler      bloom_a_sampler;
-
-    VkImage        bloom_b_image;
-    VkDeviceMemory bloom_b_memory;
-    VkImageView    bloom_b_view;
-    VkSampler      bloom_b_sampler;
+    /* Bloom mip pyramid: up to BLOOM_MAX_MIPS levels, mip 0 at half res, also
+     * transient. Written by the compute down/up chain in GENERAL layout and
+     * sampled by the composite. */
+    RgResource     pyramid;
+    VkImageView    mip_views[BLOOM_MAX_MIPS];   /* one per level, sampled + storage */
+    VkSampler      pyramid_sampler;
+    VkExtent2D     mip_extents[BLOOM_MAX_MIPS];
+    u32            mip_count;
 
     /* Render passes */
     VkRenderPass   scene_render_pass;       /* HDR color + depth */
-    VkRenderPass   postprocess_render_pass; /* single HDR color (extract + blur) */
     VkRenderPass   composite_render_pass;   /* single swapchain-format color */
 
     /* Framebuffers */
     VkFramebuffer  scene_framebuffer;
-    VkFramebuffer  extract_framebuffer;     /* -> bloom_a */
-    VkFramebuffer  blur_h_framebuffer;      /* -> bloom_b */
-    VkFramebuffer  blur_v_framebuffer;      /* -> bloom_a */
     VkFramebuffer *composite_framebuffers;  /* one per swapchain image */
 
     /* Scene pipelines (geometry + text, for HDR render pass) */
@@ -93,31 +365,410 @@ typedef struct {
     VkPipeline     scene_skinned_pipeline;   /* Skinned 3D for HDR scene pass */
 
     /* Post-processing pipelines */
-    VkPipelineLayout extract_layout;
-    VkPipeline       extract_pipeline;
-    VkPipelineLayout blur_layout;
-    VkPipeline       blur_pipeline;
+    VkPipelineLayout mip_layout;           /* shared by the down/up compute passes */
+    VkPipeline       down_pipeline;
+    VkPipeline       up_pipeline;
     VkPipelineLayout composite_layout;
     VkPipeline       composite_pipeline;
 
     /* Descriptors */
-    VkDescriptorSetLayout single_sampler_layout; /* 1 combined image sampler */
+    VkDescriptorSetLayout mip_set_layout;        /* sampled source + storage destination */
     VkDescriptorSetLayout dual_sampler_layout;   /* 2 combined image samplers */
     VkDescriptorPool      desc_pool;
-    VkDescriptorSet       extract_desc_set;      /* samples scene_image */
-    VkDescriptorSet       blur_h_desc_set;       /* samples bloom_a */
-    VkDescriptorSet       blur_v_desc_set;       /* samples bloom_b */
-    VkDescriptorSet       composite_desc_set;    /* samples scene_image + bloom_a */
+    VkDescriptorSet       down_desc_sets[BLOOM_MAX_MIPS]; /* mip i-1 (or scene) -> mip i */
+    VkDescriptorSet       up_desc_sets[BLOOM_MAX_MIPS];   /* mip i -> mip i-1, [0] unused */
+    VkDescriptorSet       composite_desc_set;    /* samples the scene + pyramid mip 0 */
 
-    /* Depth buffer for HDR scene rendering */
-    VkImage        depth_image;
-    VkDeviceMemory depth_memory;
-    VkImageView    depth_view;
+    VkExtent2D     bloom_extent; /* half-res, == mip_extents[0] */
 
-    VkExtent2D     bloom_extent; /* half-res */
+    /* Resolution scaling: the scene renders into the top-left scene_extent of
+     * the scene target (allocated at full swapchain size) and the composite
+     * upscales it. The pyramid follows at half scene_extent. */
+    f32            render_scale;  /* BLOOM_MIN_RENDER_SCALE .. 1 */
+    VkExtent2D     scene_extent;
     bool           enabled;
 } BloomContext;
 
+/* ---- Compute skinning pre-pass ----
+ * When enabled, each skinned draw is skinned once per frame by a compute
+ * dispatch into a transient Vertex3D buffer, and the regular 3D pipeline
+ * draws from it. The output buffer is GPU-local with one region per frame in
+ * flight. Draws that don't fit this frame's region fall back to skinning in
+ * the vertex shader. */
+
+#define SKIN_COMPUTE_MAX_VERTICES 131072      /* pre-skinned vertices per frame */
+#define SKIN_COMPUTE_NONE         0xFFFFFFFFu
+
+typedef struct {
+    VkBuffer              output;           /* Vertex3D, frames_in_flight regions */
+    GpuAllocation         output_memory;
+    VkDeviceSize          frame_size;       /* bytes per region (offset-aligned) */
+    u32                   vertex_count;     /* vertices reserved this frame */
+
+    VkDescriptorSetLayout desc_set_layout;  /* source vertices + output region */
+    VkDescriptorPool      desc_pool;
+    VkDescriptorSet       desc_set;
+    VkPipelineLayout      pipeline_layout;  /* set 0 = io, set 1 = joint SSBO */
+    VkPipeline            pipeline;
+
+    bool                  supported;        /* graphics queue can dispatch compute */
+    bool                  enabled;
+} SkinComputeContext;
+
+/* ---- GPU particle systems ----
+ * Particle state lives in GPU-local buffers and never crosses the bus: each
+ * frame a compute pass steps the live particles of one half of a ping-pong
+ * state buffer into the other (dropping dead ones), appends that frame's
+ * bursts after them and writes InstanceData for every survivor. The survivor
+ * count is the instanceCount of the half's VkDrawIndirectCommand, which the
+ * 2D pipeline draws straight from. Burst records go through a FrameRing.
+ * Limits are in renderer_types.h. */
+
+#define GPU_PARTICLES_MAX_DRAWS    16   /* draws per frame, all systems */
+
+typedef struct {
+    VkBuffer         state;         /* 2 x capacity particles, ping-pong halves */
+    GpuAllocation    state_memory;
+    VkBuffer         instances;     /* capacity InstanceData per half (vertex binding 1) */
+    GpuAllocation    instances_memory;
+    VkBuffer         args;          /* one VkDrawIndirectCommand per half */
+    GpuAllocation    args_memory;
+    VkDescriptorSet  desc_set;
+    u32              mesh;          /* meshes[] slot of the 2D mesh every particle is drawn with */
+    u32              capacity;
+    u32              src;           /* half holding last frame's particles */
+    u32              dst;           /* half written this frame (== src when only spawning) */
+
+    /* Queued this frame */
+    GpuParticleBurst bursts[GPU_PARTICLES_MAX_BURSTS];
+    u32              burst_count;
+    u32              burst_first;   /* first record in the burst ring (end_frame) */
+    u32              spawn_count;   /* particles requested by the bursts */
+    f32              delta_time;
+    bool             simulate;
+    bool             in_use;
+} GpuParticleSystem;
+
+typedef struct {
+    GpuParticlesHandle system;
+    TextureHandle      texture;
+} GpuParticleDraw;
+
+typedef struct {
+    GpuParticleSystem     systems[GPU_PARTICLES_MAX_SYSTEMS];
+    GpuParticleDraw       draws[GPU_PARTICLES_MAX_DRAWS];
+    u32                   draw_count;
+    u32                   seed;          /* varies spawn randomness per frame */
+
+    FrameRing             burst_ring;    /* burst records, one region per frame */
+    VkDescriptorSetLayout desc_set_layout;
+    VkDescriptorPool      desc_pool;
+    VkPipelineLayout      pipeline_layout;
+    VkPipeline            pipeline;      /* particles.comp, simulate + spawn */
+
+    bool                  supported;     /* graphics queue can dispatch compute */
+    bool                  active;        /* some system runs compute this frame */
+    bool                  in_place;      /* ...and one spawns into the half last drawn */
+} GpuParticleContext;
+
+/* ---- Static 3D instance batches (static_batch.c) ----
+ * Instances registered once into device-local memory, in the renderer's
+ * instance format. Drawing one is a single instanced draw with no per-frame
+ * copy; updates go through the upload manager. */
+
+#define STATIC_BATCH_NEVER UINT64_MAX
+
+/* Views a queued batch is drawn in: the camera and each shadow cascade */
+#define STATIC_BATCH_VIEW_CAMERA     1u
+#define STATIC_BATCH_VIEW_CASCADE(c) (2u << (c))
+
+typedef struct {
+    VkBuffer         instances;     /* device-local, vk_instance_3d_stride per instance */
+    GpuAllocation    instances_memory;
+    u32              mesh;          /* meshes[] slot of the 3D (non-skinned) mesh */
+    TextureHandle    texture;       /* TEXTURE_HANDLE_INVALID = untextured */
+    u32              count;
+    f32              bounds_min[3]; /* world AABB of the instances' bounding spheres; */
+    f32              bounds_max[3]; /* updates only ever grow it */
+    u64              last_frame;    /* frame_number of the latest draw, */
+    u64              prev_frame;    /* and of the one before (STATIC_BATCH_NEVER) */
+    u8               views;         /* STATIC_BATCH_VIEW_* bits this frame (0 = not queued) */
+    bool             in_use;
+} StaticBatch;
+
+typedef struct {
+    StaticBatch       batches[STATIC_BATCH_MAX];
+    StaticBatchHandle draws[STATIC_BATCH_MAX];
+    u32               draw_count;
+} StaticBatchContext;
+
+/* ---- Async asset loads (asset_load.c) ----
+ * Loads in flight: each has its handle reserved and its file decoding on a
+ * background job. Finished decodes are uploaded at the start of a frame. */
+
+typedef struct AssetLoad AssetLoad;
+
+typedef struct {
+    AssetLoad **loads;             /* in flight, oldest first */
+    u32         count;
+    u32         capacity;
+    MeshHandle  placeholder_mesh;  /* geometry pending model handles draw */
+} AssetLoadContext;
+
+/* ---- Resource tables (resource_table.c) ----
+ * Mesh and texture handles hold the table slot in the low 16 bits and the
+ * slot's generation in the high 16 bits, so a handle kept past an unload
+ * stops resolving instead of reaching whatever reuses the slot. Unloaded
+ * resources stay intact until every frame that could draw them has
+ * retired; then their slots and buffer ranges go back to the free lists. */
+
+#define HANDLE_SLOT_BITS 16
+#define HANDLE_SLOT_MASK ((1u << HANDLE_SLOT_BITS) - 1)
+#define HANDLE_SLOT(h)   ((u32)(h) & HANDLE_SLOT_MASK)
+#define HANDLE_SLOT_NONE 0xFFFFFFFFu
+
+typedef struct {
+    u32 first;
+    u32 count;
+} BufferRange;
+
+/* First-fit allocator over one shared buffer, in elements (vertices or
+ * indices). Free ranges are sorted and merged with their neighbours. */
+typedef struct {
+    BufferRange *free;
+    u32          free_count;
+    u32          free_capacity;
+    u32          capacity;
+    u32          used;
+} RangeAllocator;
+
+typedef struct {
+    u16 *generation;  /* bumped on unload */
+    u8  *live;        /* slot holds a resource (possibly still loading) */
+    u32 *free;        /* released slots, reused before new ones */
+    u32  free_count;
+} HandleTable;
+
+/* An unloaded mesh or texture some in-flight frame may still read */
+typedef struct {
+    bool texture;       /* false = mesh */
+    u32  slot;
+    u64  retire_frame;  /* frame_number when it was unloaded */
+} RetiredResource;
+
+/* ---- Light uniforms ----
+ * std140 mirror of LightUBO in mesh3d.frag (set 1, binding 0). Written once
+ * per frame at end_frame into that frame's region of light_ring. */
+
+typedef struct {
+    f32 direction[4];     /* xyz, FROM the light */
+    f32 color[4];
+    f32 ambient[4];
+    f32 view_pos[4];      /* camera position */
+    f32 shininess[4];     /* x = specular exponent */
+    f32 cascade_vp[SHADOW_CASCADES][16];
+    f32 cascade_splits[4];  /* far view depth of each cascade */
+    f32 cascade_texel[4];   /* world size of one shadow texel per cascade */
+    f32 view_dir[4];        /* camera forward, cascades are picked by depth along it */
+    f32 shadow_params[4];   /* x = shadows on (0/1), y = 1 / map size */
+    f32 cluster_vp[16];     /* camera view-projection the light grid was binned in */
+    f32 cluster_params[4];  /* x = near plane, y = slices / ln(far / near), z = lights on (0/1) */
+} LightUniforms;
+
+/* ---- Cascaded shadow maps (shadow.c) ----
+ * One D32 array image with a layer per cascade, drawn by depth-only variants
+ * of the 3D and skinned pipelines before the scene pass and sampled through
+ * a comparison sampler by mesh3d.frag. The map is a transient image of the
+ * render graph: it is redrawn every shadowed frame, so its memory is free
+ * for later passes once the scene pass has sampled it. The cascades split
+ * the camera view out to max_distance; each is a light-space ortho box
+ * around the bounding sphere of its slice, snapped to whole texels so edges
+ * don't shimmer as the camera moves. 3D draws are culled against every
+ * cascade on submission and go into that cascade's own draw list, which is
+ * sorted, merged and drawn indirect the same way as draw_list_3d. */
+
+#define SHADOW_DEFAULT_DISTANCE 50.0f
+
+typedef struct {
+    RgResource     map;                   /* D32, SHADOW_CASCADES layers */
+    VkImageView    array_view;            /* sampled as sampler2DArrayShadow */
+    VkImageView    layer_views[SHADOW_CASCADES];
+    VkFramebuffer  framebuffers[SHADOW_CASCADES];
+    VkSampler      sampler;               /* linear compare: 2x2 PCF per tap */
+    VkRenderPass   render_pass;           /* depth only, layouts left to the graph */
+    VkPipeline     pipeline_3d;           /* mesh3d.vert, no fragment stage */
+    VkPipeline     skinned_pipeline;      /* skinned3d.vert, no fragment stage */
+    u32            size;                  /* texels per side (1 if unavailable) */
+
+    /* Casters queued this frame, per cascade (texture dropped, so they merge
+     * across textures). Instances live in instance_ring_3d. */
+    DrawList       draw_lists[SHADOW_CASCADES];
+    u32            indirect_first[SHADOW_CASCADES]; /* first record in indirect_ring_3d */
+
+    /* Fitted by shadow_fit_cascades to the last 3D camera and light */
+    Camera3D       camera;
+    f32            aspect;
+    bool           has_camera;
+    f32            vp[SHADOW_CASCADES][16];
+    f32            planes[SHADOW_CASCADES][6][4];
+    f32            splits[SHADOW_CASCADES];
+    f32            texel_world[SHADOW_CASCADES];
+    f32            view_dir[3];
+    u64            fitted_frame;          /* frame_number the cascades belong to */
+
+    f32            max_distance;          /* view depth the last cascade ends at */
+    bool           available;             /* RendererConfig.shadow_map_size > 0 */
+    bool           enabled;
+} ShadowContext;
+
+/* ---- Clustered point and spot lights (light_cluster.c) ----
+ * Lights queued this frame go into a per-frame SSBO ring. Before the scene
+ * pass light_cluster.comp bins them into a froxel grid over the 3D camera's
+ * view: LIGHT_CLUSTER_X x LIGHT_CLUSTER_Y screen tiles by LIGHT_CLUSTER_Z
+ * depth slices spaced exponentially from near to far. Each cluster record is
+ * a count followed by up to LIGHT_CLUSTER_MAX_LIGHTS light indices, so
+ * mesh3d.frag shades only the lights whose sphere touches its froxel. The
+ * ring region and the cluster buffer are bindings 2 and 3 of set 1. */
+
+#define LIGHT_CLUSTER_X          16
+#define LIGHT_CLUSTER_Y          9
+#define LIGHT_CLUSTER_Z          24
+#define LIGHT_CLUSTER_COUNT      (LIGHT_CLUSTER_X * LIGHT_CLUSTER_Y * LIGHT_CLUSTER_Z)
+#define LIGHT_CLUSTER_MAX_LIGHTS 63   /* indices per cluster record */
+
+/* std430 mirror of Light in light_cluster.comp and mesh3d.frag */
+typedef struct {
+    f32 position[3];
+    f32 radius;
+    f32 color[3];      /* premultiplied by intensity */
+    f32 spot_scale;    /* cone = saturate(cos_angle * spot_scale + spot_offset) */
+    f32 direction[3];
+    f32 spot_offset;   /* point lights: scale 0, offset 1 */
+} GpuLight;            /* 48 bytes */
+
+typedef struct {
+    FrameRing             light_ring;       /* GpuLight[RENDERER_MAX_LIGHTS] per frame */
+    VkBuffer              clusters;         /* u32[LIGHT_CLUSTER_COUNT * (1 + MAX_LIGHTS)] per frame */
+    GpuAllocation         clusters_memory;
+    VkDeviceSize          cluster_frame_size; /* one frame's region, offset-aligned */
+
+    VkDescriptorSetLayout desc_set_layout;  /* lights + clusters (both dynamic), compute */
+    VkPipelineLayout      pipeline_layout;
+    VkPipeline            pipeline;
+    VkDescriptorPool      desc_pool;
+    VkDescriptorSet       desc_set;
+
+    u32                   count;            /* lights queued this frame */
+    bool                  overflow_warned;
+
+    /* Last 3D camera, the grid is binned in its view */
+    f32                   view[16];
+    f32                   vp[16];
+    f32                   near_plane;
+    f32                   far_plane;
+    f32                   tan_half_fov;
+    f32                   aspect;
+    u64                   camera_frame;     /* frame_number it was set in */
+
+    bool                  supported;        /* graphics queue can dispatch compute */
+} LightClusterContext;
+
+/* ---- Frame pacing (frame_pacing.c) ----
+ * After each present, end_frame optionally waits for the previous frame to
+ * reach the display (VK_KHR_present_wait, presents tagged through
+ * VK_KHR_present_id) and then sleeps out the rest of the frame-rate cap, so
+ * the game samples input right before it builds the next frame. */
+
+typedef struct {
+    bool                    present_wait;     /* requested, and both extensions enabled */
+    PFN_vkWaitForPresentKHR wait_for_present;
+    u64                     present_id;       /* last id presented on the current swapchain */
+    u64                     interval_ns;      /* 1 / max_fps, 0 = uncapped */
+    u64                     deadline_ns;      /* when the last capped frame was released */
+} FramePacing;
+
+/* ---- Async compute (async_compute.c) ----
+ * With a compute-only queue family (and timeline semaphores), compute
+ * skinning, GPU particle simulation and light binning are recorded into a
+ * command buffer of their own and submitted to that queue ahead of the
+ * frame's graphics work, so they overlap the previous frame's rendering.
+ * The graphics submit waits on `done` only at the stages that consume their
+ * output; each compute submit waits on `graphics_timeline` for the last
+ * frame that still reads what it overwrites. Buffers with storage usage are
+ * created concurrent between the two families. */
+
+typedef struct {
+    bool            enabled;           /* separate compute family in use */
+    VkQueue         queue;
+    u32             family;
+    VkCommandPool   command_pool;
+    VkCommandBuffer command_buffers[MAX_FRAMES_IN_FLIGHT];
+    VkSemaphore     done[MAX_FRAMES_IN_FLIGHT];   /* binary, compute -> graphics */
+    VkSemaphore     graphics_timeline; /* frame n's graphics submit signals n + 1 */
+    bool            recorded;          /* this frame's command buffer holds work */
+    bool            submitted;         /* ...and went to the queue: graphics waits */
+} AsyncComputeContext;
+
+/* ---- GPU timestamp profiler ----
+ * Each frame slot owns GPU_QUERIES_PER_FRAME timestamps: frame begin, scene
+ * end, frame end, then a begin/end pair per GpuPass. A slot is reset at the
+ * top of its command buffer and read back after its fence has signaled, so
+ * results arrive frames_in_flight frames late but never stall. */
+
+#define GPU_QUERY_FRAME_BEGIN  0
+#define GPU_QUERY_SCENE_END    1
+#define GPU_QUERY_FRAME_END    2
+#define GPU_QUERY_PASS_FIRST   3
+#define GPU_QUERIES_PER_FRAME  (GPU_QUERY_PASS_FIRST + 2 * GPU_PASS_COUNT)
+
+typedef struct {
+    VkQueryPool           pool;             /* NULL if the graphics queue can't timestamp */
+    f32                   period_ns;        /* ns per tick */
+    u64                   mask;             /* timestampValidBits as a mask */
+    bool                  pending[MAX_FRAMES_IN_FLIGHT];
+    u64                   frame_numbers[MAX_FRAMES_IN_FLIGHT];
+    GpuTimings            timings;          /* latest read back */
+} GpuProfiler;
+
+/* ---- Sprite atlas + batcher ----
+ * Sprites are packed into shared atlas pages (one texture each). Loading a
+ * sprite only decodes it; pending sprites are packed and their pages
+ * uploaded by the next build. Built pages are immutable, so later sprites
+ * open new pages. Sprite draws are collected per page and queued as one
+ * instanced 2D draw per page when the batch is flushed. */
+
+#define SPRITE_MAX          4096
+#define SPRITE_MAX_PAGES    32
+#define SPRITE_PAGE_SIZE    2048    /* page width; height shrinks to what is used */
+#define SPRITE_PADDING      1       /* edge texels extruded around each sprite */
+#define SPRITE_PAGE_PENDING 0xFFFFu
+
+typedef struct {
+    u16            page;            /* SPRITE_PAGE_PENDING until built */
+    u16            filter;          /* TextureFilter; pages never mix filters */
+    u32            width;           /* pixels */
+    u32            height;
+    f32            uv_offset[2];    /* sub-rect within the page */
+    f32            uv_scale[2];
+    u8            *pixels;          /* RGBA8 while pending, NULL once built */
+} SpriteSlot;
+
+typedef struct {
+    TextureHandle  texture;
+    InstanceData  *instances;       /* this frame's batch (CPU, grows) */
+    u32            instance_count;
+    u32            instance_capacity;
+} SpritePage;
+
+typedef struct {
+    SpriteSlot     sprites[SPRITE_MAX];
+    u32            sprite_count;
+    u32            pending_count;
+    SpritePage     pages[SPRITE_MAX_PAGES];
+    u32            page_count;
+    MeshHandle     quad_mesh;       /* unit quad, uv (0,0)-(1,1) */
+} SpriteContext;
+
 /* ---- Main Vulkan context ---- */
 
 typedef struct VulkanContext {
@@ -127,14 +778,27 @@ typedef struct VulkanContext {
     VkDevice                 device;
     VkSurfaceKHR             surface;
 
+    /* Device memory sub-allocator (all buffers and images) */
+    GpuAllocator             allocator;
+
     /* Queue handles */
     VkQueue                  graphics_queue;
     VkQueue                  present_queue;
     u32                      graphics_family;
     u32                      present_family;
+    VkQueue                  transfer_queue;     /* dedicated copy queue (if has_transfer_queue) */
+    u32                      transfer_family;
+    bool                     has_transfer_queue;
+    VkQueue                  compute_queue;      /* compute-only queue (if has_compute_queue) */
+    u32                      compute_family;
+    bool                     has_compute_queue;
+    bool                     timeline_semaphores; /* Vulkan 1.2 timelineSemaphore enabled */
+    bool                     memory_budget;       /* VK_EXT_memory_budget enabled */
 
     /* Swapchain */
     VkSwapchainKHR           swapchain;
+    PresentMode              present_mode_request; /* RendererConfig.present_mode */
+    VkPresentModeKHR         present_mode;         /* what the swapchain got */
     VkFormat                 swapchain_format;
     VkExtent2D               swapchain_extent;
     u32                      swapchain_image_count;
@@ -142,39 +806,52 @@ typedef struct VulkanContext {
     VkImageView             *swapchain_image_views;
 
     /* Render pass & pipeline */
+    VkPipelineCache          pipeline_cache;  /* shared by all pipelines, persisted */
     VkRenderPass             render_pass;
     VkPipelineLayout         pipeline_layout;
     VkPipeline               graphics_pipeline;
 
     /* Depth buffer (single image shared across all swapchain images) */
     VkImage                  depth_image;
-    VkDeviceMemory           depth_memory;
+    GpuAllocation            depth_memory;
     VkImageView              depth_image_view;
 
     /* Framebuffers (one per swapchain image) */
     VkFramebuffer           *framebuffers;
 
-    /* Shared vertex buffer (all meshes packed sequentially, GPU-local) */
+    /* Shared vertex buffer (2D meshes, GPU-local) */
     VkBuffer                 vertex_buffer;
-    VkDeviceMemory           vertex_buffer_memory;
-    u32                      vertex_total;       /* total vertices across all meshes */
+    GpuAllocation            vertex_buffer_memory;
+    RangeAllocator           vertex_ranges;
 
-    /* Mesh table */
+    /* Mesh table (mesh_count = slots ever used; unloaded ones are reused) */
     MeshSlot                 meshes[MAX_MESHES];
     u32                      mesh_count;
+    HandleTable              mesh_handles;
 
     /* Texture table (loaded textures) */
     VulkanTexture            textures[MAX_TEXTURES];
-    VkDescriptorSet          texture_desc_sets[MAX_TEXTURES]; /* one desc set per texture */
     u32                      texture_count;
+    HandleTable              texture_handles;
 
-    /* Geometry descriptor set layout + pool (for texture sampling) */
+    /* Bindless texture table: set 0 is one sampler2D array over every
+     * texture, indexed by the texture_index push constant. Slot 0 is the
+     * dummy texture, texture handle h lives in slot h + 1. With
+     * update-after-bind one set is shared and new slots are written while
+     * older frames are pending; without it each frame has its own set,
+     * caught up before recording once that frame's fence has signalled. */
     VkDescriptorSetLayout    geo_desc_set_layout;
     VkDescriptorPool         geo_desc_pool;
+    VkDescriptorSet          texture_table[MAX_FRAMES_IN_FLIGHT];
+    u32                      texture_table_written[MAX_FRAMES_IN_FLIGHT]; /* slots up to date */
+    u32                      texture_slots;      /* array size (device limit, <= MAX_TEXTURES + 1) */
+    u8                       texture_stale[MAX_TEXTURES]; /* sets whose slot is out of date, bit per set */
+    u32                      texture_table_stale; /* textures with texture_stale bits set */
+    bool                     texture_update_after_bind;
 
-    /* 1x1 white dummy texture — bound for untextured draws to satisfy descriptor set 0 */
+    /* 1x1 white dummy texture — fills slot 0 (and every unused slot without
+     * partially-bound descriptors) */
     VulkanTexture            dummy_texture;
-    VkDescriptorSet          dummy_desc_set;
 
     /* Clear color (set by game, used in render pass begin) */
     float                    clear_color[4]; /* r, g, b, a */
@@ -182,16 +859,20 @@ typedef struct VulkanContext {
     /* Camera VP matrix (pushed as push constant for geometry pipeline) */
     float                    vp_matrix[16]; /* mat4, column-major */
 
-    /* Instance buffer (per-frame, CPU-visible, persistently mapped) */
-    VkBuffer                 instance_buffer;
-    VkDeviceMemory           instance_buffer_memory;
-    void                    *instance_mapped;
+    /* Frustum planes of the current 3D camera (ax + by + cz + d >= 0 inside).
+     * Only valid while a 3D camera is active; 3D draws cull against it. */
+    float                    frustum_planes[6][4];
+    bool                     frustum_valid;
+    /* 1 / tan(fov_y / 2) of the same camera, for mesh LOD screen size */
+    float                    lod_projection_scale;
+
+    /* Instance buffer (per-frame ring, CPU-visible, persistently mapped) */
+    FrameRing                instance_ring;
     u32                      instance_count;     /* total instances queued this frame */
-    u32                      instance_capacity;  /* max instances */
+    u32                      instance_capacity;  /* max instances per frame */
 
     /* Draw command list (filled by renderer_draw_mesh, consumed by record_command_buffer) */
-    DrawCommand              draw_commands[MAX_DRAW_COMMANDS];
-    u32                      draw_command_count;
+    DrawList                 draw_list;
 
     /* Text rendering */
     VkPipelineLayout         text_pipeline_layout;
@@ -200,11 +881,13 @@ typedef struct VulkanContext {
     VkDescriptorPool         text_desc_pool;
     VkDescriptorSet          text_desc_set;
     VulkanTexture            font_atlas;
-    VkBuffer                 text_vertex_buffer;
-    VkDeviceMemory           text_vertex_buffer_memory;
-    void                    *text_vertex_mapped;   /* persistently mapped pointer */
+    FrameRing                text_vertex_ring;     /* per-frame ring, persistently mapped */
     u32                      text_vertex_count;
-    u32                      text_vertex_capacity;
+    u32                      text_vertex_capacity; /* max vertices per frame */
+    u32                      text_draw_count;      /* draws recorded this frame, cached runs included */
+    u32                      text_drawn_vertices;
+    VkBuffer                 text_cache_buffer;    /* retained text runs (GPU-local) */
+    GpuAllocation            text_cache_memory;
 
     /* ---- 3D rendering ---- */
 
@@ -212,34 +895,53 @@ typedef struct VulkanContext {
     VkPipelineLayout         pipeline_layout_3d;
     VkPipeline               graphics_pipeline_3d;
 
+    /* 3D and skinned vertex buffers hold PackedVertex3D / PackedSkinnedVertex3D
+     * instead of the f32 formats (fixed at renderer creation) */
+    bool                     packed_vertices;
+
+    /* What the 3D and skinned instance rings hold (fixed at renderer creation) */
+    InstanceFormat3D         instance_format_3d;
+
+    /* 3D meshes get simplified index LODs at upload; 3D draws pick one per
+     * instance from projected size (fixed at renderer creation) */
+    bool                     mesh_lods;
+
     /* 3D vertex buffer (separate from 2D, GPU-local) */
     VkBuffer                 vertex_buffer_3d;
-    VkDeviceMemory           vertex_buffer_3d_memory;
-    u32                      vertex_3d_total;
+    GpuAllocation            vertex_buffer_3d_memory;
+    RangeAllocator           vertex_3d_ranges;
 
     /* Index buffer (shared, GPU-local, for 3D meshes) */
     VkBuffer                 index_buffer;
-    VkDeviceMemory           index_buffer_memory;
-    u32                      index_total;
+    GpuAllocation            index_buffer_memory;
+    RangeAllocator           index_ranges;
 
-    /* 3D instance buffer (CPU-visible, persistently mapped) */
-    VkBuffer                 instance_buffer_3d;
-    VkDeviceMemory           instance_buffer_3d_memory;
-    void                    *instance_3d_mapped;
+    /* 3D instance buffer (per-frame ring, CPU-visible, persistently mapped) */
+    FrameRing                instance_ring_3d;
     u32                      instance_3d_count;
-    u32                      instance_3d_capacity;
+    u32                      instance_3d_capacity; /* max instances per frame */
 
-    /* Light UBO (single directional light) */
-    VkBuffer                 light_ubo;
-    VkDeviceMemory           light_ubo_memory;
-    void                    *light_ubo_mapped;
+    /* Light UBO (LightUniforms, per-frame ring). Set 1 holds this frame's
+     * region (binding 0), the shadow map (binding 1), this frame's region of
+     * light_cluster.light_ring (binding 2) and the light clusters (binding 3),
+     * one set per frame. */
+    DirectionalLight         light;
+    FrameRing                light_ring;
     VkDescriptorSetLayout    light_desc_set_layout;
     VkDescriptorPool         light_desc_pool;
-    VkDescriptorSet          light_desc_set;
+    VkDescriptorSet          light_desc_sets[MAX_FRAMES_IN_FLIGHT];
 
     /* 3D draw commands */
-    DrawCommand              draw_commands_3d[MAX_DRAW_COMMANDS];
-    u32                      draw_command_3d_count;
+    DrawList                 draw_list_3d;
+
+    /* Indirect draw records for draw_list_3d (per-frame ring, one
+     * VkDrawIndexedIndirectCommand per draw, parallel to draw_list_3d.items),
+     * followed by the shadow cascades' lists */
+    FrameRing                indirect_ring_3d;
+    u32                      indirect_3d_capacity;   /* records per frame */
+    u32                      indirect_3d_count;      /* records needed this frame (+ shadow lists) */
+    bool                     multi_draw_indirect;    /* device feature enabled */
+    u32                      max_draw_indirect_count;
 
     /* ---- Skinned 3D rendering (skeletal animation) ---- */
 
@@ -249,31 +951,39 @@ typedef struct VulkanContext {
 
     /* Skinned vertex buffer (GPU-local, separate from Vertex3D buffer) */
     VkBuffer                 vertex_buffer_skinned;
-    VkDeviceMemory           vertex_buffer_skinned_memory;
-    u32                      vertex_skinned_total;
+    GpuAllocation            vertex_buffer_skinned_memory;
+    RangeAllocator           vertex_skinned_ranges;
 
-    /* Skinned instance buffer (CPU-visible, reuses InstanceData3D layout) */
-    VkBuffer                 instance_buffer_skinned;
-    VkDeviceMemory           instance_buffer_skinned_memory;
-    void                    *instance_skinned_mapped;
+    /* Skinned instance buffer (per-frame ring, reuses InstanceData3D layout) */
+    FrameRing                instance_ring_skinned;
     u32                      instance_skinned_count;
-    u32                      instance_skinned_capacity;
+    u32                      instance_skinned_capacity; /* max instances per frame */
 
-    /* Joint matrix SSBO (CPU-visible, persistently mapped) */
-    VkBuffer                 joint_ssbo;
-    VkDeviceMemory           joint_ssbo_memory;
-    void                    *joint_ssbo_mapped;
+    /* Joint matrix SSBO (per-frame ring, bound with a dynamic offset) */
+    FrameRing                joint_ring;
     u32                      joint_ssbo_used_bytes;  /* bytes used this frame */
-    u32                      joint_ssbo_capacity;    /* total bytes */
+    u32                      joint_ssbo_capacity;    /* bytes per frame region */
 
-    /* Joint SSBO descriptor */
+    /* Joint SSBO descriptor (STORAGE_BUFFER_DYNAMIC, range = one frame region) */
     VkDescriptorSetLayout    joint_desc_set_layout;
     VkDescriptorPool         joint_desc_pool;
     VkDescriptorSet          joint_desc_set;
 
     /* Skinned draw commands */
-    SkinnedDrawCommand       draw_commands_skinned[MAX_SKINNED_DRAW_COMMANDS];
-    u32                      draw_command_skinned_count;
+    SkinnedDrawList          draw_list_skinned;
+
+    /* Frame arena: backs the draw lists, reset every begin_frame */
+    Arena                    frame_arena;
+
+    /* Grown ring buffers still referenced by in-flight frames */
+    RetiredRing              retired_rings[MAX_RETIRED_RINGS];
+    u32                      retired_ring_count;
+
+    /* Unloaded meshes and textures awaiting release (resource_table.c);
+     * grown on demand, a burst of unloads never forces a device wait */
+    RetiredResource         *retired_resources;
+    u32                      retired_resource_count;
+    u32                      retired_resource_capacity;
 
     /* Cached camera position (for specular lighting) */
     float                    view_position[3];
@@ -281,16 +991,59 @@ typedef struct VulkanContext {
     /* Bloom post-processing */
     BloomContext             bloom;
 
+    /* Compute skinning pre-pass (optional) */
+    SkinComputeContext       skin_compute;
+
+    /* GPU-simulated particle systems */
+    GpuParticleContext       gpu_particles;
+
+    /* Persistent 3D instance batches */
+    StaticBatchContext       static_batches;
+
+    /* Cascaded shadow maps of the directional light */
+    ShadowContext            shadow;
+
+    /* Clustered point and spot lights */
+    LightClusterContext      light_cluster;
+
+    /* Sprite atlas pages and per-page draw batches */
+    SpriteContext            sprites;
+
+    /* Staging uploads for meshes and textures */
+    UploadContext            upload;
+
+    /* Background model / texture loads */
+    AssetLoadContext         asset_loads;
+
     /* Command pool & buffers */
     VkCommandPool            command_pool;
     VkCommandBuffer          command_buffers[MAX_FRAMES_IN_FLIGHT];
+    SecondaryPool            secondary_pools[MAX_FRAMES_IN_FLIGHT][JOBS_MAX_THREADS];
 
     /* Synchronization */
     VkSemaphore              image_available[MAX_FRAMES_IN_FLIGHT];
     VkSemaphore              render_finished[MAX_FRAMES_IN_FLIGHT];
     VkFence                  in_flight[MAX_FRAMES_IN_FLIGHT];
 
+    /* GPU timestamp queries */
+    GpuProfiler              gpu_profiler;
+
+    /* Last submitted frame's counters and ring usage (render_stats.c) */
+    RendererStats            stats;
+    u64                      stats_staged_bytes; /* upload.bytes_staged at the last collect */
+
+    /* Latency control: present wait and frame-rate cap */
+    FramePacing              pacing;
+
+    /* Compute passes on a separate queue */
+    AsyncComputeContext      compute;
+
+    /* Pass order, barriers and transient images of the frame */
+    RenderGraph              graph;
+
+    u32                      frames_in_flight; /* 1..MAX_FRAMES_IN_FLIGHT, fixed at creation */
     u32                      current_frame;
+    u64                      frame_number;  /* total frames submitted */
 } VulkanContext;
 
 #endif /* ENGINE_VK_TYPES_H */
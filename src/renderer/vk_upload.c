@@ -0,0 +1,584 @@
+#include "renderer/vk_upload.h"
+#include "renderer/vk_buffer.h"
+#include "core/log.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define UPLOAD_ALIGN 16 /* satisfies buffer-image copy offset rules for all our formats */
+
+static VkDeviceSize align_up(VkDeviceSize v, VkDeviceSize a) {
+    return (v + a - 1) & ~(a - 1);
+}
+
+static bool on_graphics_queue(const VulkanContext *ctx) {
+    return ctx->upload.queue == ctx->graphics_queue;
+}
+
+/* --------------------------------------------------------------------------
+ * Init / shutdown
+ * ------------------------------------------------------------------------ */
+
+EngineResult vk_upload_init(VulkanContext *ctx, VkDeviceSize staging_size) {
+    UploadContext *up = &ctx->upload;
+    memset(up, 0, sizeof(*up));
+
+    /* A separate DMA queue only helps if completion can be signaled to the
+     * graphics queue without the CPU waiting, i.e. with timeline semaphores */
+    bool use_transfer = ctx->has_transfer_queue && ctx->timeline_semaphores &&
+                        ctx->transfer_family != ctx->graphics_family;
+    u32 family = use_transfer ? ctx->transfer_family : ctx->graphics_family;
+    up->queue      = use_transfer ? ctx->transfer_queue : ctx->graphics_queue;
+    up->concurrent = use_transfer;
+
+    EngineResult res = vk_create_buffer(ctx, staging_size,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        &up->staging, &up->staging_memory);
+    if (res != ENGINE_SUCCESS) {
+        LOG_FATAL("Failed to create upload staging buffer");
+        return res;
+    }
+
+    up->staging_mapped = up->staging_memory.mapped;
+    up->staging_size   = staging_size;
+
+    VkCommandPoolCreateInfo pool_info = {
+        .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+        .queueFamilyIndex = family,
+    };
+    if (vkCreateCommandPool(ctx->device, &pool_info, NULL, &up->command_pool) != VK_SUCCESS) {
+        LOG_FATAL("Failed to create upload command pool");
+        return ENGINE_ERROR_VULKAN_INIT;
+    }
+
+    VkCommandBuffer cmds[UPLOAD_MAX_BATCHES];
+    VkCommandBufferAllocateInfo alloc_info = {
+        .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .commandPool        = up->command_pool,
+        .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = UPLOAD_MAX_BATCHES,
+    };
+    if (vkAllocateCommandBuffers(ctx->device, &alloc_info, cmds) != VK_SUCCESS) {
+        LOG_FATAL("Failed to allocate upload command buffers");
+        return ENGINE_ERROR_VULKAN_INIT;
+    }
+    for (u32 i = 0; i < UPLOAD_MAX_BATCHES; i++) {
+        up->batches[i].cmd = cmds[i];
+    }
+
+    if (ctx->timeline_semaphores) {
+        VkSemaphoreTypeCreateInfo type_info = {
+            .sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+            .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+            .initialValue  = 0,
+        };
+        VkSemaphoreCreateInfo sem_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+            .pNext = &type_info,
+        };
+        if (vkCreateSemaphore(ctx->device, &sem_info, NULL, &up->timeline) != VK_SUCCESS) {
+            LOG_FATAL("Failed to create upload timeline semaphore");
+            return ENGINE_ERROR_VULKAN_INIT;
+        }
+    }
+
+    LOG_INFO("Upload manager: %llu KB staging ring on %s queue%s",
+             (unsigned long long)(staging_size / 1024),
+             use_transfer ? "transfer" : "graphics",
+             up->timeline ? " (timeline semaphore)" : "");
+    return ENGINE_SUCCESS;
+}
+
+void vk_upload_shutdown(VulkanContext *ctx) {
+    UploadContext *up = &ctx->upload;
+    if (!up->command_pool && !up->staging) return;
+
+    if (up->command_pool) vk_upload_wait_idle(ctx);
+
+    if (up->timeline) vkDestroySemaphore(ctx->device, up->timeline, NULL);
+    if (up->command_pool) vkDestroyCommandPool(ctx->device, up->command_pool, NULL);
+    vk_destroy_buffer(ctx, &up->staging, &up->staging_memory);
+    memset(up, 0, sizeof(*up));
+}
+
+/* --------------------------------------------------------------------------
+ * Batch tracking
+ * ------------------------------------------------------------------------ */
+
+/* Retire batches the GPU has finished, releasing their staging bytes. With
+ * wait_oldest, block until at least the oldest in-flight batch is done. */
+static void retire_batches(VulkanContext *ctx, bool wait_oldest) {
+    UploadContext *up = &ctx->upload;
+
+    /* Without a timeline every submit was already waited on */
+    u64 done = up->submitted;
+    if (up->timeline) {
+        vkGetSemaphoreCounterValue(ctx->device, up->timeline, &done);
+
+        if (wait_oldest && up->batch_count > 0 &&
+            up->batches[up->batch_first].value > done) {
+            u64 value = up->batches[up->batch_first].value;
+            VkSemaphoreWaitInfo wait_info = {
+                .sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+                .semaphoreCount = 1,
+                .pSemaphores    = &up->timeline,
+                .pValues        = &value,
+            };
+            vkWaitSemaphores(ctx->device, &wait_info, UINT64_MAX);
+            done = value;
+        }
+    }
+
+    while (up->batch_count > 0 && up->batches[up->batch_first].value <= done) {
+        up->tail = up->batches[up->batch_first].end;
+        up->batch_first = (up->batch_first + 1) % UPLOAD_MAX_BATCHES;
+        up->batch_count--;
+    }
+
+    /* Nothing owned any more: restart at the front to avoid needless wraps */
+    if (up->batch_count == 0 && up->open_copies == 0) {
+        up->head = 0;
+        up->tail = 0;
+    }
+}
+
+/* Reserve `size` bytes of staging. The used region is [tail, head) modulo
+ * the ring size; a wrapped head never catches up with tail, so head == tail
+ * always means empty. Flushes and waits when the ring is full. */
+static EngineResult staging_alloc(VulkanContext *ctx, VkDeviceSize size, VkDeviceSize *out_offset) {
+    UploadContext *up = &ctx->upload;
+
+    if (size > up->staging_size) {
+        LOG_ERROR("Upload of %llu bytes exceeds staging ring (%llu bytes)",
+                  (unsigned long long)size, (unsigned long long)up->staging_size);
+        return ENGINE_ERROR_OUT_OF_MEMORY;
+    }
+
+    VkDeviceSize off;
+    for (;;) {
+        retire_batches(ctx, false);
+
+        off = align_up(up->head, UPLOAD_ALIGN);
+        if (up->head >= up->tail) {
+            if (off + size <= up->staging_size) break;
+            if (size < up->tail) { off = 0; break; } /* wrap to the front */
+        } else if (off + size < up->tail) {
+            break;
+        }
+
+        /* Full: push out what we have recorded, then wait for the oldest batch */
+        if (up->open_copies > 0) {
+            EngineResult res = vk_upload_flush(ctx);
+            if (res != ENGINE_SUCCESS) return res;
+            continue;
+        }
+        retire_batches(ctx, true);
+    }
+
+    *out_offset = off;
+    up->head = off + size;
+    up->bytes_staged += size;
+    return ENGINE_SUCCESS;
+}
+
+/* Command buffer of the open batch, beginning a new batch if needed. */
+static VkCommandBuffer open_batch(VulkanContext *ctx) {
+    UploadContext *up = &ctx->upload;
+    if (up->open) {
+        return up->batches[(up->batch_first + up->batch_count) % UPLOAD_MAX_BATCHES].cmd;
+    }
+
+    /* Every slot in flight: the open batch needs one of them back */
+    while (up->batch_count >= UPLOAD_MAX_BATCHES) {
+        retire_batches(ctx, true);
+    }
+
+    VkCommandBuffer cmd = up->batches[(up->batch_first + up->batch_count) % UPLOAD_MAX_BATCHES].cmd;
+    vkResetCommandBuffer(cmd, 0);
+
+    VkCommandBufferBeginInfo begin_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    };
+    vkBeginCommandBuffer(cmd, &begin_info);
+
+    up->open = true;
+    up->open_copies = 0;
+    return cmd;
+}
+
+/* --------------------------------------------------------------------------
+ * Public API
+ * ------------------------------------------------------------------------ */
+
+EngineResult vk_upload_buffer(VulkanContext *ctx, VkBuffer dst, VkDeviceSize dst_offset,
+                              const void *data, VkDeviceSize size) {
+    UploadContext *up = &ctx->upload;
+    const u8 *src = data;
+
+    /* Larger than the ring: split into ring-sized copies */
+    while (size > 0) {
+        VkDeviceSize chunk = (size < up->staging_size) ? size : up->staging_size;
+
+        VkDeviceSize staging_offset;
+        EngineResult res = staging_alloc(ctx, chunk, &staging_offset);
+        if (res != ENGINE_SUCCESS) return res;
+        memcpy(up->staging_mapped + staging_offset, src, (size_t)chunk);
+
+        VkCommandBuffer cmd = open_batch(ctx);
+        VkBufferCopy region = {
+            .srcOffset = staging_offset,
+            .dstOffset = dst_offset,
+            .size      = chunk,
+        };
+        vkCmdCopyBuffer(cmd, up->staging, dst, 1, &region);
+        up->open_copies++;
+
+        src        += chunk;
+        dst_offset += chunk;
+        size       -= chunk;
+    }
+    return ENGINE_SUCCESS;
+}
+
+static void image_barrier(VkCommandBuffer cmd, VkImage image, u32 base_level, u32 level_count,
+                          VkImageLayout old_layout, VkImageLayout new_layout,
+                          VkAccessFlags src_access, VkAccessFlags dst_access,
+                          VkPipelineStageFlags src_stage, VkPipelineStageFlags dst_stage) {
+    VkImageMemoryBarrier barrier = {
+        .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask       = src_access,
+        .dstAccessMask       = dst_access,
+        .oldLayout           = old_layout,
+        .newLayout           = new_layout,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image               = image,
+        .subresourceRange    = {
+            .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel   = base_level,
+            .levelCount     = level_count,
+            .baseArrayLayer = 0,
+            .layerCount     = 1,
+        },
+    };
+    vkCmdPipelineBarrier(cmd, src_stage, dst_stage, 0, 0, NULL, 0, NULL, 1, &barrier);
+}
+
+static u32 mip_dim(u32 size, u32 level) {
+    u32 d = size >> level;
+    return d ? d : 1;
+}
+
+/* Copy one tightly packed level (rows of block_dim x block_dim blocks) from
+ * staging, in ring-sized bands of block rows; usually a single copy */
+static EngineResult copy_level(VulkanContext *ctx, VkImage image, u32 level,
+                               u32 width, u32 height, u32 block_dim, u32 block_bytes,
+                               const void *data) {
+    UploadContext *up = &ctx->upload;
+    u32 block_rows = (height + block_dim - 1) / block_dim;
+    VkDeviceSize row_bytes = (VkDeviceSize)((width + block_dim - 1) / block_dim) * block_bytes;
+    if (row_bytes > up->staging_size) {
+        LOG_ERROR("Image row of %llu bytes exceeds staging ring", (unsigned long long)row_bytes);
+        return ENGINE_ERROR_OUT_OF_MEMORY;
+    }
+
+    u32 rows_per_chunk = (u32)(up->staging_size / row_bytes);
+    const u8 *src = data;
+    for (u32 row = 0; row < block_rows; ) {
+        u32 rows = block_rows - row;
+        if (rows > rows_per_chunk) rows = rows_per_chunk;
+        VkDeviceSize chunk = row_bytes * rows;
+
+        VkDeviceSize staging_offset;
+        EngineResult res = staging_alloc(ctx, chunk, &staging_offset);
+        if (res != ENGINE_SUCCESS) return res;
+        memcpy(up->staging_mapped + staging_offset, src, (size_t)chunk);
+
+        /* The last band of a block-compressed level may end past the
+         * texel height; the extent is clamped to the real size */
+        u32 y = row * block_dim;
+        u32 texel_rows = rows * block_dim;
+        if (y + texel_rows > height) texel_rows = height - y;
+
+        VkBufferImageCopy region = {
+            .bufferOffset     = staging_offset,
+            .imageSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel   = level,
+                .layerCount = 1,
+            },
+            .imageOffset = { 0, (i32)y, 0 },
+            .imageExtent = { width, texel_rows, 1 },
+        };
+        vkCmdCopyBufferToImage(open_batch(ctx), up->staging, image,
+                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+        up->open_copies++;
+
+        src += chunk;
+        row += rows;
+    }
+    return ENGINE_SUCCESS;
+}
+
+/* Every level in TRANSFER_DST -> SHADER_READ_ONLY. A transfer-only queue
+ * cannot name shader stages; there the frame's semaphore wait provides
+ * visibility instead. */
+static void finish_image(VulkanContext *ctx, VkImage image, u32 base_level, u32 level_count) {
+    bool graphics = on_graphics_queue(ctx);
+    image_barrier(open_batch(ctx), image, base_level, level_count,
+                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                  VK_ACCESS_TRANSFER_WRITE_BIT, graphics ? VK_ACCESS_SHADER_READ_BIT : 0,
+                  VK_PIPELINE_STAGE_TRANSFER_BIT,
+                  graphics ? VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
+                           : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+}
+
+/* --------------------------------------------------------------------------
+ * Mip generation
+ *
+ * Blitting needs a graphics-capable queue and a format with linear blit
+ * support. Uploads on the dedicated transfer queue (or formats without it)
+ * build the chain on the CPU with a 2x2 box filter instead and copy every
+ * level, which works on any queue.
+ * ------------------------------------------------------------------------ */
+
+static bool can_blit_mips(const VulkanContext *ctx, VkFormat format) {
+    if (!on_graphics_queue(ctx)) return false;
+
+    VkFormatProperties props;
+    vkGetPhysicalDeviceFormatProperties(ctx->physical_device, format, &props);
+    VkFormatFeatureFlags needed = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                  VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    return (props.optimalTilingFeatures & needed) == needed;
+}
+
+/* Level 0 is already in TRANSFER_DST: each level becomes a blit source,
+ * fills the next, then is released for sampling */
+static void blit_mips(VulkanContext *ctx, VkImage image, u32 width, u32 height, u32 mip_levels) {
+    VkCommandBuffer cmd = open_batch(ctx);
+
+    for (u32 level = 1; level < mip_levels; level++) {
+        image_barrier(cmd, image, level - 1, 1,
+                      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                      VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                      VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+        VkImageBlit blit = {
+            .srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1 },
+            .srcOffsets     = { { 0, 0, 0 },
+                                { (i32)mip_dim(width, level - 1), (i32)mip_dim(height, level - 1), 1 } },
+            .dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 },
+            .dstOffsets     = { { 0, 0, 0 },
+                                { (i32)mip_dim(width, level), (i32)mip_dim(height, level), 1 } },
+        };
+        vkCmdBlitImage(cmd, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+        ctx->upload.open_copies++;
+
+        image_barrier(cmd, image, level - 1, 1,
+                      VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                      VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT,
+                      VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    }
+    finish_image(ctx, image, mip_levels - 1, 1);
+}
+
+/* sRGB texels are averaged in linear space, as a blit of an sRGB format
+ * does; alpha is always linear */
+static f32 s_srgb_to_linear[256];
+static bool s_srgb_table_ready = false;
+
+static void init_srgb_table(void) {
+    if (s_srgb_table_ready) return;
+    for (u32 i = 0; i < 256; i++) {
+        f32 c = (f32)i / 255.0f;
+        s_srgb_to_linear[i] = (c <= 0.04045f) ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+    }
+    s_srgb_table_ready = true;
+}
+
+static u8 linear_to_srgb8(f32 l) {
+    f32 c = (l <= 0.0031308f) ? l * 12.92f : 1.055f * powf(l, 1.0f / 2.4f) - 0.055f;
+    return (u8)(ENGINE_CLAMP(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+static bool format_is_srgb(VkFormat format) {
+    return format == VK_FORMAT_R8G8B8A8_SRGB || format == VK_FORMAT_B8G8R8A8_SRGB;
+}
+
+/* 2x2 box filter of an 8-bit level into the next (odd edges clamp). With
+ * srgb, the first three channels of 4-byte pixels are sRGB encoded. */
+static void downsample_level(const u8 *src, u32 sw, u32 sh, u8 *dst, u32 dw, u32 dh,
+                             u32 pixel_size, bool srgb) {
+    for (u32 y = 0; y < dh; y++) {
+        u32 y0 = ENGINE_MIN(y * 2, sh - 1), y1 = ENGINE_MIN(y * 2 + 1, sh - 1);
+        for (u32 x = 0; x < dw; x++) {
+            u32 x0 = ENGINE_MIN(x * 2, sw - 1), x1 = ENGINE_MIN(x * 2 + 1, sw - 1);
+            for (u32 c = 0; c < pixel_size; c++) {
+                u8 a = src[((size_t)y0 * sw + x0) * pixel_size + c];
+                u8 b = src[((size_t)y0 * sw + x1) * pixel_size + c];
+                u8 d = src[((size_t)y1 * sw + x0) * pixel_size + c];
+                u8 e = src[((size_t)y1 * sw + x1) * pixel_size + c];
+                u8 *out = &dst[((size_t)y * dw + x) * pixel_size + c];
+                if (srgb && c < 3) {
+                    *out = linear_to_srgb8(0.25f * (s_srgb_to_linear[a] + s_srgb_to_linear[b] +
+                                                    s_srgb_to_linear[d] + s_srgb_to_linear[e]));
+                } else {
+                    *out = (u8)(((u32)a + b + d + e + 2) / 4);
+                }
+            }
+        }
+    }
+}
+
+static EngineResult cpu_mips(VulkanContext *ctx, VkImage image, VkFormat format,
+                             u32 width, u32 height, u32 pixel_size, u32 mip_levels,
+                             const u8 *pixels) {
+    bool srgb = pixel_size == 4 && format_is_srgb(format);
+    if (srgb) init_srgb_table();
+
+    /* Two scratch levels, ping-ponged: level 1 is the largest generated one */
+    size_t level1 = (size_t)mip_dim(width, 1) * mip_dim(height, 1) * pixel_size;
+    u8 *scratch = malloc(level1 * 2);
+    if (!scratch) return ENGINE_ERROR_OUT_OF_MEMORY;
+
+    const u8 *src = pixels;
+    u8 *dst = scratch;
+    EngineResult res = ENGINE_SUCCESS;
+    for (u32 level = 1; level < mip_levels && res == ENGINE_SUCCESS; level++) {
+        u32 sw = mip_dim(width, level - 1), sh = mip_dim(height, level - 1);
+        u32 dw = mip_dim(width, level),     dh = mip_dim(height, level);
+        downsample_level(src, sw, sh, dst, dw, dh, pixel_size, srgb);
+        res = copy_level(ctx, image, level, dw, dh, 1, pixel_size, dst);
+
+        /* copy_level staged dst, so the other half can be overwritten next */
+        src = dst;
+        dst = (dst == scratch) ? scratch + level1 : scratch;
+    }
+    free(scratch);
+    if (res == ENGINE_SUCCESS) finish_image(ctx, image, 0, mip_levels);
+    return res;
+}
+
+EngineResult vk_upload_image(VulkanContext *ctx, VkImage image, VkFormat format,
+                             u32 width, u32 height, u32 pixel_size,
+                             u32 mip_levels, const void *pixels) {
+    if (mip_levels == 0) mip_levels = 1;
+
+    image_barrier(open_batch(ctx), image, 0, mip_levels,
+                  VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                  0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                  VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    ctx->upload.open_copies++;
+
+    EngineResult res = copy_level(ctx, image, 0, width, height, 1, pixel_size, pixels);
+    if (res != ENGINE_SUCCESS) return res;
+
+    if (mip_levels == 1) {
+        finish_image(ctx, image, 0, 1);
+    } else if (can_blit_mips(ctx, format)) {
+        blit_mips(ctx, image, width, height, mip_levels);
+    } else {
+        res = cpu_mips(ctx, image, format, width, height, pixel_size, mip_levels, pixels);
+    }
+    return res;
+}
+
+EngineResult vk_upload_image_levels(VulkanContext *ctx, VkImage image,
+                                    u32 width, u32 height, u32 block_dim, u32 block_bytes,
+                                    u32 level_count, const void *const *levels) {
+    image_barrier(open_batch(ctx), image, 0, level_count,
+                  VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                  0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                  VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    ctx->upload.open_copies++;
+
+    for (u32 level = 0; level < level_count; level++) {
+        EngineResult res = copy_level(ctx, image, level, mip_dim(width, level),
+                                      mip_dim(height, level), block_dim, block_bytes,
+                                      levels[level]);
+        if (res != ENGINE_SUCCESS) return res;
+    }
+    finish_image(ctx, image, 0, level_count);
+    return ENGINE_SUCCESS;
+}
+
+EngineResult vk_upload_flush(VulkanContext *ctx) {
+    UploadContext *up = &ctx->upload;
+    if (!up->open) return ENGINE_SUCCESS;
+
+    UploadBatch *batch = &up->batches[(up->batch_first + up->batch_count) % UPLOAD_MAX_BATCHES];
+
+    /* On the graphics queue, make buffer copies visible to vertex input and
+     * shaders of later submissions */
+    if (on_graphics_queue(ctx)) {
+        VkMemoryBarrier barrier = {
+            .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+                             VK_ACCESS_SHADER_READ_BIT,
+        };
+        vkCmdPipelineBarrier(batch->cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+                             VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0, 1, &barrier, 0, NULL, 0, NULL);
+    }
+
+    vkEndCommandBuffer(batch->cmd);
+    up->open = false;
+
+    if (up->open_copies == 0) return ENGINE_SUCCESS;
+    up->open_copies = 0;
+
+    batch->end   = up->head;
+    batch->value = up->submitted + 1;
+
+    VkTimelineSemaphoreSubmitInfo timeline_info = {
+        .sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .signalSemaphoreValueCount = 1,
+        .pSignalSemaphoreValues    = &batch->value,
+    };
+    VkSubmitInfo submit = {
+        .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext                = up->timeline ? &timeline_info : NULL,
+        .commandBufferCount   = 1,
+        .pCommandBuffers      = &batch->cmd,
+        .signalSemaphoreCount = up->timeline ? 1 : 0,
+        .pSignalSemaphores    = &up->timeline,
+    };
+
+    if (vkQueueSubmit(up->queue, 1, &submit, VK_NULL_HANDLE) != VK_SUCCESS) {
+        LOG_ERROR("Failed to submit upload batch");
+        return ENGINE_ERROR_VULKAN_INIT;
+    }
+    if (!up->timeline) {
+        vkQueueWaitIdle(up->queue);
+    }
+
+    up->submitted = batch->value;
+    up->batch_count++;
+    return ENGINE_SUCCESS;
+}
+
+void vk_upload_wait_idle(VulkanContext *ctx) {
+    vk_upload_flush(ctx);
+    while (ctx->upload.batch_count > 0) {
+        retire_batches(ctx, true);
+    }
+}
+
+bool vk_upload_frame_wait(const VulkanContext *ctx, VkSemaphore *out_sem, u64 *out_value) {
+    const UploadContext *up = &ctx->upload;
+    if (!up->timeline || up->submitted == 0) return false;
+
+    /* Waited on by every frame, not just the first after a batch: a semaphore
+     * wait only orders the submit it belongs to */
+    *out_sem   = up->timeline;
+    *out_value = up->submitted;
+    return true;
+}
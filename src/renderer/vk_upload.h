@@ -0,0 +1,50 @@
+#ifndef ENGINE_VK_UPLOAD_H
+#define ENGINE_VK_UPLOAD_H
+
+#include "renderer/vk_types.h"
+#include "core/common.h"
+
+/* Create the staging ring and upload command buffers. Uses the dedicated
+ * transfer queue when the device has one and timeline semaphores are
+ * enabled; otherwise uploads go through the graphics queue. Call after the
+ * logical device exists and before creating any upload target buffers. */
+EngineResult vk_upload_init(VulkanContext *ctx, VkDeviceSize staging_size);
+
+/* Wait for outstanding uploads and destroy the upload manager. */
+void vk_upload_shutdown(VulkanContext *ctx);
+
+/* Stage `size` bytes and record a copy into dst at dst_offset. The copy runs
+ * at the next vk_upload_flush (or earlier if the staging ring fills up). */
+EngineResult vk_upload_buffer(VulkanContext *ctx, VkBuffer dst, VkDeviceSize dst_offset,
+                              const void *data, VkDeviceSize size);
+
+/* Stage tightly packed pixels for mip 0 of a freshly created image and record
+ * the copy. With mip_levels > 1 the rest of the chain is generated: by a
+ * vkCmdBlitImage chain when uploads run on the graphics queue and the format
+ * supports linear blits (the image then needs TRANSFER_SRC usage), otherwise
+ * by a CPU box filter (8-bit formats; sRGB color is averaged in linear
+ * space, as the blit does). Every level ends up in
+ * SHADER_READ_ONLY_OPTIMAL. */
+EngineResult vk_upload_image(VulkanContext *ctx, VkImage image, VkFormat format,
+                             u32 width, u32 height, u32 pixel_size,
+                             u32 mip_levels, const void *pixels);
+
+/* Stage pre-built mip levels (level 0 first), e.g. BC7 data from a KTX2
+ * file. Each level is tightly packed rows of block_dim x block_dim texel
+ * blocks of block_bytes each (block_dim 1 = uncompressed pixels). */
+EngineResult vk_upload_image_levels(VulkanContext *ctx, VkImage image,
+                                    u32 width, u32 height, u32 block_dim, u32 block_bytes,
+                                    u32 level_count, const void *const *levels);
+
+/* Submit the open batch without waiting for it. */
+EngineResult vk_upload_flush(VulkanContext *ctx);
+
+/* Flush, then block until every submitted upload has completed. */
+void vk_upload_wait_idle(VulkanContext *ctx);
+
+/* Semaphore + value the next graphics submit must wait on before reading
+ * uploaded data. Returns false when no wait is needed (no timeline support:
+ * batches are already complete when flush returns). */
+bool vk_upload_frame_wait(const VulkanContext *ctx, VkSemaphore *out_sem, u64 *out_value);
+
+#endif /* ENGINE_VK_UPLOAD_H */